@@ -52,9 +52,13 @@
 #include <cugl/assets/CULoader.h>
 #include <typeinfo>
 #include <atomic>
+#include <thread>
 
 
 namespace cugl {
+
+/** Forward reference to a compiled asset directory */
+class AssetManifest;
     
 /**
  * This class is loader/manager for handling a wide variety of assets.
@@ -73,6 +77,12 @@ namespace cugl {
  * make asset managers a singleton, because different player modes may want 
  * different asset managers.
  *
+ * Asset directories may be compiled ahead of time into an {@link AssetManifest}.
+ * If {@link setUsesManifests} is enabled, a directory loaded by path uses
+ * the compiled manifest next to the JSON file (if there is one), as it can be
+ * loaded with no JSON parsing. The JSON directory is used otherwise, including
+ * when the JSON or widget files have changed since the manifest was compiled.
+ *
  * Disposing an asset manager unloads all of the assets.  However, assets may
  * still be used after an asset manager is destroyed, provided that they still
  * have a smart pointer referencing them.
@@ -97,6 +107,108 @@ protected:
     
     /** Wait variable to create a load barrier for directories. */
     std::atomic<bool> _wait;
+    
+    /** Whether to prefer compiled manifests when loading directories by path */
+    bool _manifests;
+    
+    /** The memory budget for evictable assets in bytes (0 for no budget) */
+    size_t _budget;
+    
+    /** The thread that initialized this manager (the main thread) */
+    std::thread::id _thread;
+    
+    /**
+     * Returns the type hash for the given asset category.
+     *
+     * The asset categories are the top level keys of an asset directory,
+     * such as "textures" or "scene2s".  This method returns 0 if the
+     * category is not supported.
+     *
+     * @param category  The asset category
+     *
+     * @return the type hash for the given asset category.
+     */
+    size_t getCategoryHash(const std::string& category) const;
+    
+    /**
+     * Returns a callback that enforces the memory budget after loading.
+     *
+     * The callback returned calls the given callback (if any) and then calls
+     * {@link reclaim}.  It is used for asynchronous loading, as the asset
+     * is not added to its loader until the callback is invoked.
+     *
+     * @param callback  An optional callback for asynchronous loading
+     *
+     * @return a callback that enforces the memory budget after loading.
+     */
+    LoaderCallback budgeted(LoaderCallback callback) {
+        return [this,callback](const std::string& key, bool success) {
+            if (callback) {
+                callback(key,success);
+            }
+            reclaim();
+        };
+    }
+    
+    /**
+     * Restores the evicted asset for the given key, returning true on success.
+     *
+     * Restoring an asset may need the OpenGL context (to create a texture or
+     * a font atlas), so the asset is only restored immediately on the main
+     * thread.  On any other thread, the restore is scheduled for the main
+     * thread with {@link Application#schedule}, and this method returns false.
+     * If there is no running application, nothing is scheduled.
+     *
+     * @param loader    The loader for the asset
+     * @param key       The key to identify the asset
+     *
+     * @return true if the asset was restored
+     */
+    bool restore(const std::shared_ptr<BaseLoader>& loader, const std::string& key) const;
+
+    /**
+     * Returns the compiled manifest for the given directory, if it is usable.
+     *
+     * This method returns nullptr if compiled manifests are disabled, if
+     * there is no manifest for the directory, if it is the wrong version,
+     * or if it is stale (see {@link AssetManifest#isCurrent}).  Checking for
+     * a stale manifest reads the source files, so this should be called
+     * from a worker thread when loading asynchronously.
+     *
+     * @param directory The path to the JSON asset directory
+     * @param enabled   Whether compiled manifests are enabled
+     *
+     * @return the compiled manifest for the given directory, if it is usable.
+     */
+    static std::shared_ptr<AssetManifest> readManifest(const std::string& directory, bool enabled);
+
+    /**
+     * Synchronously reads the scene graphs of a compiled manifest.
+     *
+     * The scenes are built directly from the manifest if the scene loader is
+     * a {@link Scene2Loader}.  Otherwise, the loader is given the (expanded)
+     * JSON of each scene.
+     *
+     * @param manifest  The compiled manifest
+     * @param category  The position of the scene category in the manifest
+     *
+     * @return true if all scenes were successfully loaded.
+     */
+    bool readScenes(const std::shared_ptr<AssetManifest>& manifest, size_t category);
+    
+    /**
+     * Asynchronously reads the scene graphs of a compiled manifest.
+     *
+     * The scenes are built directly from the manifest if the scene loader is
+     * a {@link Scene2Loader}.  Otherwise, the loader is given the (expanded)
+     * JSON of each scene.
+     *
+     * @param manifest  The compiled manifest
+     * @param category  The position of the scene category in the manifest
+     * @param callback  An optional callback after each asset is loaded
+     */
+    void readScenes(const std::shared_ptr<AssetManifest>& manifest, size_t category,
+                    LoaderCallback callback);
 
     /**
      * Synchronously reads an asset category from a JSON file
@@ -210,7 +322,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an asset 
      * manager on the heap, use one of the static constructors instead.
      */
-    AssetManager() : _preload(false), _wait(false) {}
+    AssetManager() : _preload(false), _wait(false), _manifests(false), _budget(0) {}
     
     /**
      * Deletes this asset manager, disposing of all resources.
@@ -461,6 +573,11 @@ public:
      * the method is parameterized by the type, it is safe to reuse keys for
      * different types.  However, this is not recommended.
      *
+     * If the asset was evicted to save memory, it is restored.  On the main
+     * thread, the asset is restored immediately (blocking until it is
+     * loaded).  On any other thread, this method returns nullptr, and the
+     * asset is restored on the main thread at the next animation frame.
+     *
      * @param  key  The key to identify the given asset
      *
      * @return the asset for the given key.
@@ -475,7 +592,11 @@ public:
         }
         
         std::shared_ptr<Loader<T>> loader = std::dynamic_pointer_cast<Loader<T>>(it->second);
-        return loader->get(key);
+        std::shared_ptr<T> result = loader->get(key);
+        if (result == nullptr && restore(it->second,key)) {
+            result = loader->get(key);
+        }
+        return result;
     }
     
     /**
@@ -519,7 +640,9 @@ public:
         auto it = _handlers.find(hash);
         if (it != _handlers.end()) {
             std::shared_ptr<Loader<T>> loader = std::dynamic_pointer_cast<Loader<T>>(it->second);
-            return loader->load(key,source);
+            bool success = loader->load(key,source);
+            reclaim();
+            return success;
         }
         
         CUAssertLog(false, "No loader assigned for given type");
@@ -627,7 +750,7 @@ public:
         size_t hash = typeid(T).hash_code();
         auto it = _handlers.find(hash);
         if (it != _handlers.end()) {
-            it->second->loadAsync(key,source,callback);
+            it->second->loadAsync(key,source,budgeted(callback));
             return;
         }
         
@@ -830,6 +953,10 @@ public:
      * can.  If any asset fails to load, it will return false.  However, some
      * assets may still be loaded and safe to access.
      *
+     * If there is a compiled manifest for this directory (see
+     * {@link AssetManifest#getCompiledPath}), and compiled manifests are
+     * enabled, this method loads the manifest instead of the JSON.
+     *
      * @param directory The path to the JSON asset directory
      *
      * @return true if all assets specified in the directory were successfully loaded.
@@ -928,6 +1055,10 @@ public:
      * to load, the callback function will be given the asset category name
      * (e.g. "soundfx") as the asset key.
      *
+     * If there is a compiled manifest for this directory (see
+     * {@link AssetManifest#getCompiledPath}), and compiled manifests are
+     * enabled, this method loads the manifest instead of the JSON.
+     *
      * @param directory The path to the JSON asset directory
      * @param callback  An optional callback after each asset is loaded
      */
@@ -989,6 +1120,10 @@ public:
      * still may remain in memory. However, the rest of the program can no
      * longer access these assets.
      *
+     * If there is a compiled manifest for this directory, and compiled
+     * manifests are enabled, this method reads the manifest instead of the
+     * JSON.
+     *
      * @param directory The path to the JSON asset directory
      */
     bool unloadDirectory(const std::string& directory);
@@ -1007,6 +1142,211 @@ public:
         return unloadDirectory(std::string(directory));
     }
 
+#pragma mark -
+#pragma mark Compiled Manifests
+    /**
+     * Returns true if directories loaded by path prefer compiled manifests.
+     *
+     * If this value is true, loading a directory by path will load the
+     * compiled manifest next to the JSON file, if there is one.  Otherwise,
+     * the JSON file is always used.  A manifest is ignored if its source
+     * files (the JSON directories and widget files) have changed since it
+     * was compiled, so an edited JSON file always wins over a stale manifest.
+     * This value is false by default.
+     *
+     * @return true if directories loaded by path prefer compiled manifests.
+     */
+    bool usesManifests() const { return _manifests; }
+    
+    /**
+     * Sets whether directories loaded by path prefer compiled manifests.
+     *
+     * If this value is true, loading a directory by path will load the
+     * compiled manifest next to the JSON file, if there is one.  Otherwise,
+     * the JSON file is always used.  A manifest is ignored if its source
+     * files (the JSON directories and widget files) have changed since it
+     * was compiled, so an edited JSON file always wins over a stale manifest.
+     * This value is false by default.
+     *
+     * @param value Whether directories loaded by path prefer compiled manifests
+     */
+    void setUsesManifests(bool value) { _manifests = value; }
+    
+    /**
+     * Synchronously loads all assets in the given compiled manifest.
+     *
+     * This method is the same as {@link loadDirectory}, except that the
+     * directory has been compiled.  The asset entries are rebuilt from the
+     * manifest with no JSON parsing, and the scene graphs are built using
+     * the precomputed creation order of the manifest.
+     *
+     * This method will try to load as many assets from the manifest as it
+     * can.  If any asset fails to load, it will return false.  However, some
+     * assets may still be loaded and safe to access.
+     *
+     * @param manifest  The compiled manifest
+     *
+     * @return true if all assets specified in the manifest were successfully loaded.
+     */
+    bool loadManifest(const std::shared_ptr<AssetManifest>& manifest);
+    
+    /**
+     * Asynchronously loads all assets in the given compiled manifest.
+     *
+     * This method is the same as {@link loadDirectoryAsync}, except that the
+     * directory has been compiled.  The asset entries are rebuilt from the
+     * manifest with no JSON parsing, and the scene graphs are built using
+     * the precomputed creation order of the manifest.
+     *
+     * The optional callback function will be called each time an individual
+     * asset loads or fails to load.  However, if the entire category fails
+     * to load, the callback function will be given the asset category name
+     * (e.g. "soundfx") as the asset key.
+     *
+     * @param manifest  The compiled manifest
+     * @param callback  An optional callback after each asset is loaded
+     */
+    void loadManifestAsync(const std::shared_ptr<AssetManifest>& manifest, LoaderCallback callback);
+    
+    /**
+     * Unloads all assets for the given compiled manifest.
+     *
+     * This method unloads only those assets associated with the given manifest.
+     * If there are active smart pointers still referencing the assets, they
+     * still may remain in memory. However, the rest of the program can no
+     * longer access these assets.
+     *
+     * @param manifest  The compiled manifest
+     *
+     * @return true if all assets were successfully unloaded
+     */
+    bool unloadManifest(const std::shared_ptr<AssetManifest>& manifest);
+    
+#pragma mark -
+#pragma mark Memory Residency
+    /**
+     * Returns the memory budget for evictable assets in bytes.
+     *
+     * Whenever an asset finishes loading, the asset manager evicts the least
+     * recently used assets until the total footprint fits in this budget.
+     * Only assets that are not in use may be evicted; an asset is in use if
+     * anything other than its loader holds a reference to it (such as a
+     * scene graph that is currently displayed).  Evicted assets are restored
+     * on demand by {@link get}.
+     *
+     * A budget of 0 means that the memory is not budgeted, and assets are
+     * only evicted by explicit calls to {@link trim}.  This is the default.
+     *
+     * @return the memory budget for evictable assets in bytes.
+     */
+    size_t getMemoryBudget() const { return _budget; }
+    
+    /**
+     * Sets the memory budget for evictable assets in bytes.
+     *
+     * Whenever an asset finishes loading, the asset manager evicts the least
+     * recently used assets until the total footprint fits in this budget.
+     * Only assets that are not in use may be evicted; an asset is in use if
+     * anything other than its loader holds a reference to it (such as a
+     * scene graph that is currently displayed).  Evicted assets are restored
+     * on demand by {@link get}.
+     *
+     * A budget of 0 means that the memory is not budgeted, and assets are
+     * only evicted by explicit calls to {@link trim}.  Changing the budget
+     * does not evict anything until the next call to {@link reclaim}.
+     *
+     * @param bytes The memory budget for evictable assets in bytes.
+     */
+    void setMemoryBudget(size_t bytes) { _budget = bytes; }
+    
+    /**
+     * Returns the memory footprint of all loaded assets in bytes.
+     *
+     * The footprint is an estimate of the memory used by texture data, the
+     * decoded audio samples, and the font atlases.  Other assets, such as
+     * JSON values and scene graphs, are not counted.
+     *
+     * The value returned is the sum of the footprints of all attached loaders.
+     *
+     * @return the memory footprint of all loaded assets in bytes.
+     */
+    size_t getFootprint() const;
+    
+    /**
+     * Returns the memory footprint of all loaded assets of type T in bytes.
+     *
+     * The footprint is an estimate of the memory (either CPU or GPU) that
+     * would be freed if every asset of this type were released.
+     *
+     * @return the memory footprint of all loaded assets of type T in bytes.
+     */
+    template<typename T>
+    size_t getFootprint() const {
+        size_t hash = typeid(T).hash_code();
+        auto it = _handlers.find(hash);
+        return (it == _handlers.end() ? 0 : it->second->getFootprint());
+    }
+    
+    /**
+     * Returns the memory footprint of the given asset in bytes.
+     *
+     * This method returns 0 if the asset is not loaded (or was evicted).
+     *
+     * @param  key  the key referencing the asset
+     *
+     * @return the memory footprint of the given asset in bytes.
+     */
+    template<typename T>
+    size_t getFootprint(const std::string& key) const {
+        size_t hash = typeid(T).hash_code();
+        auto it = _handlers.find(hash);
+        return (it == _handlers.end() ? 0 : it->second->getFootprint(key));
+    }
+    
+    /**
+     * Returns true if the given asset was evicted to save memory.
+     *
+     * Evicted assets are not lost.  They are restored the next time they
+     * are accessed with {@link get}.
+     *
+     * @param  key  the key referencing the asset
+     *
+     * @return true if the given asset was evicted to save memory.
+     */
+    template<typename T>
+    bool isEvicted(const std::string& key) const {
+        size_t hash = typeid(T).hash_code();
+        auto it = _handlers.find(hash);
+        return (it != _handlers.end() && it->second->isEvicted(key));
+    }
+    
+    /**
+     * Evicts the least recently used assets until the footprint fits the target.
+     *
+     * Assets are evicted across all loaders, in order of their last access
+     * with {@link get}.  Assets that are in use are never evicted, so the
+     * footprint may remain above the target.  A target of 0 evicts every
+     * asset that is not in use, which is appropriate when the application
+     * is running out of memory.
+     *
+     * @param target    The target footprint in bytes
+     *
+     * @return the number of bytes freed
+     */
+    size_t trim(size_t target);
+    
+    /**
+     * Evicts the least recently used assets until the footprint fits the budget.
+     *
+     * This method does nothing if there is no memory budget.  It is called
+     * automatically whenever an asset finishes loading.
+     *
+     * @return the number of bytes freed
+     */
+    size_t reclaim() {
+        return (_budget == 0 ? 0 : trim(_budget));
+    }
+
 };
 
 }
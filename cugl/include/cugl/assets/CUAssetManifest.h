@@ -0,0 +1,514 @@
+//
+//  CUAssetManifest.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a compiled (binary) version of a JSON asset directory.
+//  An asset directory is compiled offline, so that the asset manager does not
+//  need to parse JSON when the application starts.  The compiled manifest
+//  has all widgets in the scene graphs already expanded, the widget files
+//  inlined, all strings interned, a precomputed creation order for every
+//  scene graph, and the asset dependencies of each scene graph.
+//
+//  The JSON directory remains the source of truth.  The manifest is simply
+//  a cache of it, and the asset manager falls back to the JSON directory if
+//  there is no compiled manifest, if it is the wrong version, or if its JSON
+//  sources have changed since it was compiled.
+//
+//  The binary format is a sequence of fixed-size little-endian records, so
+//  that it can be used in place (e.g. memory mapped) with no decoding.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_ASSET_MANIFEST_H__
+#define __CU_ASSET_MANIFEST_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <functional>
+#include <vector>
+#include <string>
+
+namespace cugl {
+
+/**
+ * This class is a compiled version of a JSON asset directory.
+ *
+ * A manifest is created from a JSON directory (together with the other
+ * directories loaded by the application) with the method {@link init}.  This
+ * is done offline by the asset compiler, which saves the manifest next to
+ * the JSON directory using {@link getCompiledPath}.  At runtime, the manifest
+ * is read with {@link initWithAsset}.  The manifest data is used in place,
+ * so reading a manifest is a single file read with no parsing.
+ *
+ * The manifest stores a JSON tree for the directory as a flat array of nodes.
+ * The children of a node are contiguous, so any subtree can be turned back
+ * into a {@link JsonValue} with {@link getJson} for the asset loaders.  This
+ * tree differs from the source directory in two ways.  The widget files are
+ * inlined into the "widgets" category, and every widget in the scene graphs
+ * is replaced by its expansion.
+ *
+ * In addition, each scene graph has a list of {@link Entry} records, one for
+ * each scene graph node in creation order (so every parent comes before its
+ * children), and a list of the assets (textures and fonts) it depends on.
+ *
+ * Finally, a manifest may record the size and hash of the source files
+ * (the JSON directories and widget files) it was compiled from.  The method
+ * {@link isCurrent} uses these to detect a manifest that is older than its
+ * JSON, so that the asset manager can read the JSON instead.
+ *
+ * All strings are interned in a string table, and are referenced by index.
+ */
+class AssetManifest {
+public:
+    /** The version of the binary format (increment when the format changes) */
+    static const Uint32 VERSION;
+    /** The index for a missing node or string */
+    static const Uint32 NONE;
+
+    /**
+     * This class is a scene graph node in creation order.
+     *
+     * The strings and JSON nodes are referenced by index.  Any of these
+     * may be {@link NONE} if the attribute is missing.
+     */
+    class Entry {
+    public:
+        /** The entry of the parent node (NONE if this is the root) */
+        Uint32 parent;
+        /** The name of this node (a string index) */
+        Uint32 name;
+        /** The lower case node type (a string index) */
+        Uint32 type;
+        /** The "data" attribute of this node (a JSON node index) */
+        Uint32 data;
+        /** The "format" attribute of this node (a JSON node index) */
+        Uint32 format;
+        /** The "layout" attribute of this node (a JSON node index) */
+        Uint32 layout;
+    };
+
+    /**
+     * This class is an asset dependency of a scene graph.
+     */
+    class Dependency {
+    public:
+        /** The asset category, like "textures" (a string index) */
+        Uint32 category;
+        /** The asset key (a string index) */
+        Uint32 key;
+    };
+
+    /**
+     * A function to read the JSON file at a path relative to the asset directory.
+     *
+     * The function should return nullptr if the file cannot be read.
+     */
+    typedef std::function<std::shared_ptr<JsonValue>(const std::string& path)> Reader;
+
+private:
+    /** The manifest data (which may be mapped or read from a file) */
+    std::vector<Uint8> _data;
+
+    /** The number of interned strings */
+    Uint32 _scount;
+    /** The number of JSON nodes */
+    Uint32 _ncount;
+    /** The number of scene graphs */
+    Uint32 _gcount;
+    /** The number of source files */
+    Uint32 _rcount;
+
+    /** The string offsets into the character data (one more than the strings) */
+    const Uint32* _offsets;
+    /** The character data of the interned strings */
+    const char* _chars;
+    /** The JSON nodes, with node 0 the directory root */
+    const void* _nodes;
+    /** The scene graph records */
+    const void* _scenes;
+    /** The creation order entries of all scene graphs */
+    const Entry* _entries;
+    /** The dependencies of all scene graphs */
+    const Dependency* _depends;
+    /** The source files the manifest was compiled from */
+    const void* _sources;
+
+    /**
+     * Returns true if the data is a valid manifest, and initializes the tables.
+     *
+     * @return true if the data is a valid manifest, and initializes the tables.
+     */
+    bool validate();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates an empty manifest.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AssetManifest();
+
+    /**
+     * Deletes this manifest, disposing all resources
+     */
+    ~AssetManifest() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this manifest.
+     *
+     * A disposed manifest can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes a manifest by compiling the given JSON directory.
+     *
+     * The context is the list of other JSON directories loaded by the
+     * application.  Widgets used by the scene graphs may be declared in any
+     * of these directories, and the dependencies of a scene graph may be
+     * any texture or font declared in them.  The reader is used to read
+     * the widget files.
+     *
+     * This method fails if a widget cannot be found.
+     *
+     * @param directory The JSON directory to compile
+     * @param context   The other JSON directories loaded by the application
+     * @param reader    The function to read widget files
+     *
+     * @return true if the directory was compiled successfully
+     */
+    bool init(const std::shared_ptr<JsonValue>& directory,
+              const std::vector<std::shared_ptr<JsonValue>>& context,
+              const Reader& reader);
+
+    /**
+     * Initializes a manifest by compiling the given JSON directory.
+     *
+     * This version of the initializer records the source files of the manifest,
+     * so that a stale manifest can be detected with {@link isCurrent}.  The
+     * sources are the paths of the JSON directories (relative to root) that
+     * the manifest depends on.  The widget files read with the reader are
+     * added to the sources automatically.
+     *
+     * This method fails if a widget or a source file cannot be read.
+     *
+     * @param directory The JSON directory to compile
+     * @param context   The other JSON directories loaded by the application
+     * @param reader    The function to read widget files
+     * @param root      The asset root of the source paths
+     * @param sources   The paths of the JSON directories relative to root
+     *
+     * @return true if the directory was compiled successfully
+     */
+    bool init(const std::shared_ptr<JsonValue>& directory,
+              const std::vector<std::shared_ptr<JsonValue>>& context,
+              const Reader& reader, const std::string& root,
+              const std::vector<std::string>& sources);
+
+    /**
+     * Initializes a manifest from the given binary data.
+     *
+     * This method fails if the data is not a manifest of the current
+     * {@link VERSION}.
+     *
+     * @param data  The manifest data
+     *
+     * @return true if the manifest was initialized successfully
+     */
+    bool initWithData(std::vector<Uint8>&& data);
+
+    /**
+     * Initializes a manifest from the given file.
+     *
+     * This method fails if the file does not exist or is not a manifest of
+     * the current {@link VERSION}.
+     *
+     * @param file  The absolute path to the file
+     *
+     * @return true if the manifest was initialized successfully
+     */
+    bool initWithFile(const std::string& file);
+
+    /**
+     * Initializes a manifest from the given asset file.
+     *
+     * The path is relative to the application asset directory. This method
+     * fails if the file does not exist or is not a manifest of the current
+     * {@link VERSION}.
+     *
+     * @param file  The path to the file relative to the asset directory
+     *
+     * @return true if the manifest was initialized successfully
+     */
+    bool initWithAsset(const std::string& file);
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated manifest compiled from the given JSON directory.
+     *
+     * The context is the list of other JSON directories loaded by the
+     * application.  Widgets used by the scene graphs may be declared in any
+     * of these directories, and the dependencies of a scene graph may be
+     * any texture or font declared in them.  The reader is used to read
+     * the widget files.
+     *
+     * This method fails if a widget cannot be found.
+     *
+     * @param directory The JSON directory to compile
+     * @param context   The other JSON directories loaded by the application
+     * @param reader    The function to read widget files
+     *
+     * @return a newly allocated manifest compiled from the given JSON directory.
+     */
+    static std::shared_ptr<AssetManifest> alloc(const std::shared_ptr<JsonValue>& directory,
+                                                const std::vector<std::shared_ptr<JsonValue>>& context,
+                                                const Reader& reader) {
+        std::shared_ptr<AssetManifest> result = std::make_shared<AssetManifest>();
+        return (result->init(directory,context,reader) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated manifest compiled from the given JSON directory.
+     *
+     * This version of the allocator records the source files of the manifest,
+     * so that a stale manifest can be detected with {@link isCurrent}.  The
+     * sources are the paths of the JSON directories (relative to root) that
+     * the manifest depends on.  The widget files read with the reader are
+     * added to the sources automatically.
+     *
+     * This method fails if a widget or a source file cannot be read.
+     *
+     * @param directory The JSON directory to compile
+     * @param context   The other JSON directories loaded by the application
+     * @param reader    The function to read widget files
+     * @param root      The asset root of the source paths
+     * @param sources   The paths of the JSON directories relative to root
+     *
+     * @return a newly allocated manifest compiled from the given JSON directory.
+     */
+    static std::shared_ptr<AssetManifest> alloc(const std::shared_ptr<JsonValue>& directory,
+                                                const std::vector<std::shared_ptr<JsonValue>>& context,
+                                                const Reader& reader, const std::string& root,
+                                                const std::vector<std::string>& sources) {
+        std::shared_ptr<AssetManifest> result = std::make_shared<AssetManifest>();
+        return (result->init(directory,context,reader,root,sources) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated manifest from the given binary data.
+     *
+     * This method fails if the data is not a manifest of the current
+     * {@link VERSION}.
+     *
+     * @param data  The manifest data
+     *
+     * @return a newly allocated manifest from the given binary data.
+     */
+    static std::shared_ptr<AssetManifest> allocWithData(std::vector<Uint8>&& data) {
+        std::shared_ptr<AssetManifest> result = std::make_shared<AssetManifest>();
+        return (result->initWithData(std::move(data)) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated manifest from the given file.
+     *
+     * This method fails if the file does not exist or is not a manifest of
+     * the current {@link VERSION}.
+     *
+     * @param file  The absolute path to the file
+     *
+     * @return a newly allocated manifest from the given file.
+     */
+    static std::shared_ptr<AssetManifest> allocWithFile(const std::string& file) {
+        std::shared_ptr<AssetManifest> result = std::make_shared<AssetManifest>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated manifest from the given asset file.
+     *
+     * The path is relative to the application asset directory. This method
+     * fails if the file does not exist or is not a manifest of the current
+     * {@link VERSION}.
+     *
+     * @param file  The path to the file relative to the asset directory
+     *
+     * @return a newly allocated manifest from the given asset file.
+     */
+    static std::shared_ptr<AssetManifest> allocWithAsset(const std::string& file) {
+        std::shared_ptr<AssetManifest> result = std::make_shared<AssetManifest>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns the path of the compiled manifest for a JSON directory.
+     *
+     * The compiled manifest has the same path as the directory, but with
+     * the extension ".cuam" instead of ".json".
+     *
+     * @param directory The path to the JSON directory
+     *
+     * @return the path of the compiled manifest for a JSON directory.
+     */
+    static std::string getCompiledPath(const std::string& directory);
+
+    /**
+     * Returns true if the source files of this manifest are unchanged.
+     *
+     * Each source file recorded when the manifest was compiled is read (but
+     * not parsed) relative to the given root, and its size and hash are
+     * compared to the recorded values.  If any source file has changed, the
+     * manifest is stale and the JSON should be read instead.
+     *
+     * A source file that cannot be read is skipped, as there is no JSON to
+     * fall back to.  A manifest compiled without sources is always current.
+     *
+     * @param root  The asset root of the source paths
+     *
+     * @return true if the source files of this manifest are unchanged.
+     */
+    bool isCurrent(const std::string& root) const;
+
+#pragma mark Serialization
+    /**
+     * Returns the binary data of this manifest.
+     *
+     * @return the binary data of this manifest.
+     */
+    const std::vector<Uint8>& getData() const { return _data; }
+
+    /**
+     * Saves this manifest to the given file.
+     *
+     * @param file  The absolute path to the file
+     *
+     * @return true if the manifest was saved successfully
+     */
+    bool save(const std::string& file) const;
+
+#pragma mark Directory Access
+    /**
+     * Returns the string with the given index.
+     *
+     * @param index The string index
+     *
+     * @return the string with the given index.
+     */
+    std::string getString(Uint32 index) const;
+
+    /**
+     * Returns a newly allocated JSON tree for the given node.
+     *
+     * Node 0 is the root of the directory.  The tree is built directly from
+     * the manifest records, with no parsing.
+     *
+     * @param index The JSON node index
+     *
+     * @return a newly allocated JSON tree for the given node.
+     */
+    std::shared_ptr<JsonValue> getJson(Uint32 index) const;
+
+    /**
+     * Returns the number of asset categories in the directory.
+     *
+     * @return the number of asset categories in the directory.
+     */
+    size_t getCategoryCount() const;
+
+    /**
+     * Returns the name of the given asset category.
+     *
+     * @param category  The category position in the directory
+     *
+     * @return the name of the given asset category.
+     */
+    std::string getCategory(size_t category) const;
+
+    /**
+     * Returns the JSON node index of the given asset category.
+     *
+     * @param category  The category position in the directory
+     *
+     * @return the JSON node index of the given asset category.
+     */
+    Uint32 getCategoryNode(size_t category) const;
+
+#pragma mark Scene Graph Access
+    /**
+     * Returns the number of scene graphs in the directory.
+     *
+     * @return the number of scene graphs in the directory.
+     */
+    size_t getSceneCount() const { return _gcount; }
+
+    /**
+     * Returns the key of the given scene graph.
+     *
+     * @param scene The scene graph position
+     *
+     * @return the key of the given scene graph.
+     */
+    std::string getSceneKey(size_t scene) const;
+
+    /**
+     * Returns the nodes of the given scene graph in creation order.
+     *
+     * The first entry is the root of the scene graph.  Every parent comes
+     * before its children, and the children of a node are in the order of
+     * the source JSON.
+     *
+     * @param scene The scene graph position
+     * @param count The variable to store the number of entries
+     *
+     * @return the nodes of the given scene graph in creation order.
+     */
+    const Entry* getSceneEntries(size_t scene, size_t& count) const;
+
+    /**
+     * Returns the assets that the given scene graph depends on.
+     *
+     * These are the textures and fonts referenced by the data of the
+     * scene graph nodes.
+     *
+     * @param scene The scene graph position
+     * @param count The variable to store the number of dependencies
+     *
+     * @return the assets that the given scene graph depends on.
+     */
+    const Dependency* getSceneDependencies(size_t scene, size_t& count) const;
+};
+
+}
+
+#endif /* __CU_ASSET_MANIFEST_H__ */
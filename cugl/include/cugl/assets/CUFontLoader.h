@@ -66,6 +66,12 @@ namespace cugl {
  * {@link Application#schedule}.  This is a good template for asset loaders in
  * general.
  *
+ * Rasterizing an atlas is expensive, so this loader first looks for a font
+ * baked offline (see {@link Font#bake}).  The baked file for a font of size
+ * n is the TrueType file with the extension ".n.font" (or ".font" for a
+ * distance field that serves every size).  If neither exists, the loader
+ * rasterizes the TrueType file as usual.
+ *
  * As with all of our loaders, this loader is designed to be attached to an
  * asset manager. Use the method {@link getHook()} to get the appropriate
  * pointer for attaching the loader.
@@ -80,6 +86,8 @@ protected:
     int _fontsize;
     /** The default atlas character set ("" for ASCII) */
     std::string _charset;
+    /** Whether to look for baked fonts before rasterizing */
+    bool _baked;
     
 #pragma mark Asset Loading
     /**
@@ -90,13 +98,37 @@ protected:
      * Hence this method does the maximum amount of work that can be done in 
      * asynchronous font loading.
      *
+     * If there is a baked font for this asset, it is read instead of the
+     * TrueType file, and the character set is ignored.
+     *
      * @param source    The pathname to the asset
      * @param charset   The atlas character set
      * @param size      The font size
+     * @param baked     The pathname to the baked font ("" to search)
      *
      * @return the font asset with no generated atlas
      */
-    std::shared_ptr<Font> preload(const std::string& source, const std::string& charset, int size);
+    std::shared_ptr<Font> preload(const std::string& source, const std::string& charset,
+                                  int size, const std::string& baked="");
+    
+    /**
+     * Returns the baked font for this asset, if it exists.
+     *
+     * If baked is empty, this method looks for the TrueType file with the
+     * extension ".n.font", where n is the font size, and then with the
+     * extension ".font".  The latter is only accepted if it has the same
+     * size or is a distance field.  This method returns nullptr if baked
+     * fonts are disabled or no baked font was found.
+     *
+     * This method is safe to call outside of the main thread.
+     *
+     * @param source    The pathname to the asset
+     * @param size      The font size
+     * @param baked     The pathname to the baked font ("" to search)
+     *
+     * @return the baked font for this asset (or nullptr)
+     */
+    std::shared_ptr<Font> preloadBaked(const std::string& source, int size, const std::string& baked);
     
     /**
      * Creates an atlas for the font asset, and assigns it the given key.
@@ -179,6 +211,7 @@ protected:
      *      "file":         The path to the asset
      *      "size":         This font size (int)
      *      "charset":      The set of characters for the font atlas (string)
+     *      "baked":        The path to a baked font, if not next to the file
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
@@ -188,6 +221,18 @@ protected:
      */
     bool read(const std::shared_ptr<JsonValue>& json, LoaderCallback callback, bool async) override;
     
+    /**
+     * Returns the memory footprint of the given font in bytes.
+     *
+     * This is the size of the font atlas texture.  Fonts without an atlas
+     * have a footprint of 0.
+     *
+     * @param asset The font to measure
+     *
+     * @return the memory footprint of the given font in bytes.
+     */
+    size_t measure(const std::shared_ptr<Font>& asset) const override;
+    
     
 public:
 #pragma mark -
@@ -487,6 +532,28 @@ public:
      * @param charset   The default atlas character set
      */
     void setCharacterSet(const std::string& charset) { _charset = charset; }
+    
+    /**
+     * Returns true if this loader prefers baked fonts.
+     *
+     * If this value is true, the loader reads a baked font (see
+     * {@link Font#bake}) instead of rasterizing the TrueType file, whenever
+     * one exists.  This value is true by default.
+     *
+     * @return true if this loader prefers baked fonts.
+     */
+    bool usesBaked() const { return _baked; }
+    
+    /**
+     * Sets whether this loader prefers baked fonts.
+     *
+     * If this value is true, the loader reads a baked font (see
+     * {@link Font#bake}) instead of rasterizing the TrueType file, whenever
+     * one exists.  This value is true by default.
+     *
+     * @param flag  Whether this loader prefers baked fonts.
+     */
+    void setUsesBaked(bool flag) { _baked = flag; }
 };
 
 }
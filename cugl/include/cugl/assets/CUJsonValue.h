@@ -4,8 +4,9 @@
 //
 //  This module a modern C++ alternative to the cJSON interface for reading
 //  JSON files.  In particular, this gives us better type-checking and memory
-//  management.  With that said, it still uses cJSON as the underlying parsing
-//  engine.
+//  management.  JSON strings are parsed in a single pass directly into the
+//  tree, with the nodes allocated from an arena owned by the document.  It
+//  still uses cJSON to encode the tree as a string.
 //
 //  This class uses our standard shared-pointer architecture.
 //
@@ -62,9 +63,13 @@ namespace cugl {
  * if the node is an object type.  Hence the main usage of this feature is to
  * "cast" object nodes to arrays.
  *
- * This class uses cJSON as the underlying parsing engine.  However, it manages
- * memory automatically so that the user does not need to worry about deleting
- * or allocating memory beyond the initial node itself.
+ * JSON strings are parsed in a single pass, without an intermediate cJSON
+ * tree.  The nodes of a parsed document are allocated from an arena owned by
+ * the document, and this memory is released when the last node is deleted.
+ * Large objects keep a small hash index of their keys, so that lookups by key
+ * do not need to compare every child.  The class manages memory automatically
+ * so that the user does not need to worry about deleting or allocating memory
+ * beyond the initial node itself.
  */
 class JsonValue {
 public:
@@ -96,8 +101,10 @@ public:
     
     /** A weak reference to the parent of this node (nullptr if root). */
     JsonValue* _parent;
-    /** The key indexing this node with respect to its parent (maybe "") */
-    std::string _key;
+    /** The key indexing this node with respect to its parent (never nullptr, maybe "") */
+    const std::string* _key;
+    /** The storage for the key if it is not interned by a document (maybe nullptr) */
+    std::unique_ptr<std::string> _ownKey;
     
     /** The string data stored in this node (only defined if StringType) */
     std::string _stringValue;
@@ -108,49 +115,83 @@ public:
     
     /** The children of this node (only non-empty if array or object) */
     std::vector<std::shared_ptr<JsonValue>> _children;
+    
+    /** The hash of the key, cached for lookups in the parent */
+    Uint32 _hash;
+    /** The hash index of the children (key hash and position+1, or 0 if empty) */
+    std::vector<Uint64> _index;
 
 #pragma mark -
 #pragma mark cJSON Conversions
     /**
-     * Returns a newly allocated JsonValue equivalent to the cJSON node
+     * Returns a newly allocated cJSON node equivalent to value
      *
-     * This allocator recursively allocates child nodes as necessary. These
-     * nodes will be owned by the parent node and deleted when it is deleted
-     * (provided there are no other references).
+     * This method recursively allocates child nodes as necessary. These
+     * nodes will be owned by the parent node and deleted when it is deleted.
+     * However, the returned cJSON node is not stored in a smart pointer, so
+     * it must be manually deleted (with {@link cJSON_Delete}) when it is no
+     * longer necessary.
+     *
+     * @param value The JsonValue to convert
+     */
+    static cJSON* toCJSON(const JsonValue* value);
+    
+#pragma mark -
+#pragma mark Key Index
+    /**
+     * Returns the hash of the given key.
      *
-     * This method does not delete the cJSON node when done.
+     * This is the hash used by the key index of an object.
      *
-     * @param node  The cJSON node to convert
+     * @param key   The key to hash
+     * @param len   The length of the key in bytes
      *
-     * @return a newly allocated JsonValue equivalent to the cJSON node
+     * @return the hash of the given key.
      */
-    static std::shared_ptr<JsonValue> toJsonValue(const cJSON* node);
-
+    static Uint32 hashKey(const char* key, size_t len);
+    
     /**
-     * Modifies value so that it is equivalent to the cJSON node
+     * Assigns the given key to this node, without reindexing the parent.
      *
-     * This allocator recursively allocates child nodes as necessary. These
-     * nodes will be owned by the parent node value and deleted when it is
-     * deleted (provided there are no other references).
+     * Keys parsed from a JSON string are interned by the document, so that
+     * each distinct key is stored once.  This method instead gives this node
+     * its own copy of the key.  It also updates the cached hash.
      *
-     * This method does not delete the cJSON node when done.
+     * @param key   The key for this node
+     */
+    void assignKey(const std::string& key);
+    
+    /**
+     * Rebuilds the key index of this node from scratch.
      *
-     * @param node  The cJSON node to convert
+     * Only objects with enough children have an index.  For all other nodes,
+     * this method releases the index.  This method must be called whenever
+     * the children are reordered or their keys change.
      */
-    static void toJsonValue(JsonValue* value, const cJSON* node);
+    void reindex();
     
     /**
-     * Returns a newly allocated cJSON node equivalent to value
+     * Adds the child at the given position to the key index of this node.
      *
-     * This method recursively allocates child nodes as necessary. These
-     * nodes will be owned by the parent node and deleted when it is deleted.
-     * However, the returned cJSON node is not stored in a smart pointer, so
-     * it must be manually deleted (with {@link cJSON_Delete}) when it is no
-     * longer necessary.
+     * This method is an optimization of {@link reindex} when a child is
+     * appended to the end of the children.  It rebuilds the index if the
+     * index is too full.
      *
-     * @param value The JsonValue to convert
+     * @param pos   The position of the child to index
      */
-    static cJSON* toCJSON(const JsonValue* value);
+    void indexChild(size_t pos);
+    
+    /**
+     * Returns the position of the child with the given key.
+     *
+     * If there is more than one child with this key, this method returns the
+     * first one.  If there is no child with this key, it returns -1.
+     *
+     * @param key   The key identifying the child
+     *
+     * @return the position of the child with the given key.
+     */
+    int lookup(const std::string& key) const;
     
 #pragma mark -
 #pragma mark Constructors
@@ -277,13 +318,15 @@ public:
      * If there is a parsing error, this  method will return false.  Detailed 
      * information about the parsing error will be passed to an assert.  Hence
      * error messages are suppressed if asserts are turned off.
+     * JSON nested more than 1000 deep is not parsed.  As this is a limit,
+     * and not a syntax error, it is logged as an error instead of an assert.
      *
      * @param json  The JSON string to parse.
      *
      * @return  true if the JSON node is initialized properly, false otherwise.
      */
     bool initWithJson(const std::string& json) {
-        return initWithJson(json.c_str());
+        return initWithJson(json.c_str(),json.size());
     }
     
     /**
@@ -297,12 +340,39 @@ public:
      * If there is a parsing error, this method will return false.  Detailed
      * information about the parsing error will be passed to an assert.  Hence
      * error messages are suppressed if asserts are turned off.
+     * JSON nested more than 1000 deep is not parsed.  As this is a limit,
+     * and not a syntax error, it is logged as an error instead of an assert.
      *
      * @param json  The JSON string to parse.
      *
      * @return  true if the JSON node is initialized properly, false otherwise.
      */
     bool initWithJson(const char* json);
+    
+    /**
+     * Initializes a new JsonValue from the given JSON string.
+     *
+     * This initializer will parse the JSON string and construct a full JSON
+     * tree for the string, if possible. The children are all owned by this
+     * node will be deleted when this node is deleted (provided there are
+     * no other references).
+     *
+     * The string is bounded by its length, and need not be null-terminated.
+     * Hence this initializer can parse a JSON string in place, such as from
+     * a {@link MappedFile}.
+     *
+     * If there is a parsing error, this method will return false.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.
+     * JSON nested more than 1000 deep is not parsed.  As this is a limit,
+     * and not a syntax error, it is logged as an error instead of an assert.
+     *
+     * @param json      The JSON string to parse.
+     * @param length    The length of the JSON string in bytes.
+     *
+     * @return  true if the JSON node is initialized properly, false otherwise.
+     */
+    bool initWithJson(const char* json, size_t length);
 
     
 #pragma mark -
@@ -471,6 +541,32 @@ public:
         return (result->initWithJson(json) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated JsonValue from the given JSON string.
+     *
+     * This initializer will parse the JSON string and construct a full JSON
+     * tree for the string, if possible. The children are all owned by this
+     * node will be deleted when this node is deleted (provided there are
+     * no other references).
+     *
+     * The string is bounded by its length, and need not be null-terminated.
+     * Hence this allocator can parse a JSON string in place, such as from
+     * a {@link MappedFile}.
+     *
+     * If there is a parsing error, this  method will return nullptr.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.
+     *
+     * @param json      The JSON string to parse.
+     * @param length    The length of the JSON string in bytes.
+     *
+     * @return a newly allocated JsonValue from the given JSON string.
+     */
+    static std::shared_ptr<JsonValue> allocWithJson(const char* json, size_t length) {
+        std::shared_ptr<JsonValue> result = std::make_shared<JsonValue>();
+        return (result->initWithJson(json,length) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Type
@@ -22,6 +22,10 @@
 //  and a pure polymorphic class, only a header file is necessary.  There is no
 //  associated CPP file with this header.
 //
+//  The loaders also track the memory residency of their assets. Each loader
+//  remembers how an asset was loaded, so that an asset that is not in use
+//  may be evicted to save memory and transparently restored later.
+//
 //
 //  CUGL MIT License:
 //      This software is provided 'as-is', without any express or implied
@@ -51,6 +55,9 @@
 #include <functional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <mutex>
 #include <cugl/assets/CUJsonValue.h>
 #include <cugl/util/CUThreadPool.h>
 
@@ -111,6 +118,69 @@ protected:
      */
     AssetManager* _manager;
     
+    /** The source files of the loaded assets, for restoring evicted assets */
+    std::unordered_map<std::string, std::string> _sources;
+    
+    /** The directory entries of the loaded assets, for restoring evicted assets */
+    std::unordered_map<std::string, std::shared_ptr<JsonValue>> _entries;
+    
+    /** The keys of the assets evicted from this loader to save memory */
+    std::unordered_set<std::string> _evicted;
+    
+    /**
+     * Records the source file for the asset with the given key.
+     *
+     * This information allows the asset to be restored should it be evicted.
+     *
+     * @param key       The key to access the asset after loading
+     * @param source    The pathname to the asset
+     */
+    void remember(const std::string& key, const std::string& source) {
+        _entries.erase(key);
+        _evicted.erase(key);
+        _sources[key] = source;
+    }
+    
+    /**
+     * Records the directory entry for the asset with the given key.
+     *
+     * This information allows the asset to be restored should it be evicted.
+     *
+     * @param json      The directory entry for the asset
+     */
+    void remember(const std::shared_ptr<JsonValue>& json) {
+        _sources.erase(json->key());
+        _evicted.erase(json->key());
+        _entries[json->key()] = json;
+    }
+    
+    /**
+     * Forgets the load information for the asset with the given key.
+     *
+     * Once this method is called, the asset can no longer be restored.
+     *
+     * @param key       The key associated with the asset
+     */
+    void forget(const std::string& key) {
+        _sources.erase(key);
+        _entries.erase(key);
+        _evicted.erase(key);
+    }
+    
+    /**
+     * Returns the next timestamp for least-recently-used tracking.
+     *
+     * The timestamps are shared by all loaders, so that assets of different
+     * types may be compared to each other.  Unlike the rest of this class,
+     * this method is thread-safe, as assets may be accessed from any thread.
+     *
+     * @return the next timestamp for least-recently-used tracking.
+     */
+    static Uint64 tick() {
+        static std::atomic<Uint64> clock(0);
+        return clock.fetch_add(1,std::memory_order_relaxed)+1;
+    }
+    
     /**
      * Internal method to support asset loading.
      *
@@ -368,6 +438,7 @@ public:
      * @return true if the asset was successfully loaded
      */
     bool load(const std::string& key, const std::string& source) {
+        remember(key,source);
         return read(key,source,nullptr,false);
     }
 
@@ -388,7 +459,7 @@ public:
      * @return true if the asset was successfully loaded
      */
     bool load(const char* key, const std::string& source) {
-        return read(std::string(key),source,nullptr,false);
+        return load(std::string(key),source);
     }
 
     /**
@@ -408,7 +479,7 @@ public:
      * @return true if the asset was successfully loaded
      */
     bool load(const std::string& key, const char* source) {
-        return read(key,std::string(source),nullptr,false);
+        return load(key,std::string(source));
     }
     
     /**
@@ -428,7 +499,7 @@ public:
      * @return true if the asset was successfully loaded
      */
     bool load(const char* key, const char* source) {
-        return read(std::string(key),std::string(source),nullptr,false);
+        return load(std::string(key),std::string(source));
     }
 
     /**
@@ -453,6 +524,7 @@ public:
      * @return true if the asset was successfully loaded
      */
     bool load(const std::shared_ptr<JsonValue>& json) {
+        remember(json);
         return read(json,nullptr,false);
     }
     
@@ -476,6 +548,7 @@ public:
      * @param callback  An optional callback for asynchronous loading
      */
     void loadAsync(const std::string& key, const std::string& source, LoaderCallback callback) {
+        remember(key,source);
         read(key, source, callback,true);
     }
 
@@ -499,7 +572,7 @@ public:
      * @param callback  An optional callback for asynchronous loading
      */
     void loadAsync(const char* key, const std::string& source, LoaderCallback callback) {
-        read(std::string(key), source, callback,true);
+        loadAsync(std::string(key), source, callback);
     }
 
     /**
@@ -522,7 +595,7 @@ public:
      * @param callback  An optional callback for asynchronous loading
      */
     void loadAsync(const std::string& key, const char* source, LoaderCallback callback) {
-        read(key, std::string(source), callback,true);
+        loadAsync(key, std::string(source), callback);
     }
 
     /**
@@ -545,7 +618,7 @@ public:
      * @param callback  An optional callback for asynchronous loading
      */
     void loadAsync(const char* key, const char* source, LoaderCallback callback) {
-        read(std::string(key), std::string(source), callback,true);
+        loadAsync(std::string(key), std::string(source), callback);
     }
 
     /**
@@ -573,6 +646,7 @@ public:
      * @param callback  An optional callback for asynchronous loading
      */
     void loadAsync(const std::shared_ptr<JsonValue>& json, LoaderCallback callback) {
+        remember(json);
         read(json, callback,true);
     }
 
@@ -590,6 +664,7 @@ public:
      * @return true if the asset was successfully unloaded
      */
     bool unload(const std::string& key) {
+        forget(key);
         return purge(key);
     }
 
@@ -607,7 +682,7 @@ public:
      * @return true if the asset was successfully unloaded
      */
     bool unload(const char* key) {
-        return purge(key);
+        return unload(std::string(key));
     }
     
 	/**
@@ -624,6 +699,7 @@ public:
      * @return true if the asset was successfully unloaded
      */
     bool unload(const std::shared_ptr<JsonValue>& json) {
+        forget(json->key());
         return purge(json);
     }
     
@@ -725,6 +801,129 @@ public:
         return (size == 0 ? 0.0f : ((float)loadCount())/size);
     }
     
+
+#pragma mark Memory Residency
+    /**
+     * A loaded asset that may be evicted to save memory.
+     *
+     * The timestamp records the last time the asset was accessed through the
+     * loader.  Assets with smaller timestamps were used less recently.
+     */
+    struct Resident {
+        /** The key associated with the asset */
+        std::string key;
+        /** The memory footprint of the asset in bytes */
+        size_t bytes;
+        /** The last time the asset was accessed */
+        Uint64 stamp;
+    };
+    
+    /**
+     * Returns the memory footprint of all loaded assets in bytes.
+     *
+     * The footprint is an estimate of the memory (either CPU or GPU) that
+     * would be freed if every asset were released.  Assets whose size is
+     * not known count as 0 bytes.
+     *
+     * This method is abstract and should be overridden in child classes to
+     * support the appropriate asset type.
+     *
+     * @return the memory footprint of all loaded assets in bytes.
+     */
+    virtual size_t getFootprint() const { return 0; }
+    
+    /**
+     * Returns the memory footprint of the given asset in bytes.
+     *
+     * This method returns 0 if the key does not map to a loaded asset.
+     *
+     * This method is abstract and should be overridden in child classes to
+     * support the appropriate asset type.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return the memory footprint of the given asset in bytes.
+     */
+    virtual size_t getFootprint(const std::string& key) const { return 0; }
+    
+    /**
+     * Appends the assets that may be evicted to the given vector.
+     *
+     * An asset may only be evicted if this loader holds the only reference
+     * to it, and if this loader knows how to restore it.  Assets that are
+     * in use (such as a texture attached to a visible scene graph) are never
+     * evicted.
+     *
+     * This method is abstract and should be overridden in child classes to
+     * support the appropriate asset type.
+     *
+     * @param residents The vector to store the evictable assets
+     */
+    virtual void getResidents(std::vector<Resident>& residents) const {}
+    
+    /**
+     * Evicts the asset for the given key, returning true on success.
+     *
+     * An evicted asset is released by this loader, but it is not forgotten.
+     * It may be reloaded with {@link restore}.  This method fails if the
+     * asset is currently in use or still in flight, or if the loader does
+     * not know how to restore it.
+     *
+     * This method is abstract and should be overridden in child classes to
+     * support the appropriate asset type.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return true if the asset was evicted
+     */
+    virtual bool evict(const std::string& key) { return false; }
+    
+    /**
+     * Returns true if the asset for the given key was evicted.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return true if the asset for the given key was evicted.
+     */
+    bool isEvicted(const std::string& key) const {
+        return _evicted.find(key) != _evicted.end();
+    }
+    
+    /**
+     * Synchronously restores the evicted asset for the given key.
+     *
+     * The asset is reloaded exactly as it was originally loaded, which means
+     * the main CUGL thread will block until loading is complete.  This method
+     * returns false if the asset was not evicted.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return true if the asset was successfully restored
+     */
+    bool restore(const std::string& key) {
+        if (!isEvicted(key)) {
+            return false;
+        }
+        
+        bool success = false;
+        auto entry = _entries.find(key);
+        if (entry != _entries.end()) {
+            std::shared_ptr<JsonValue> json = entry->second;
+            success = read(json,nullptr,false);
+        } else {
+            auto source = _sources.find(key);
+            if (source != _sources.end()) {
+                std::string path = source->second;
+                success = read(key,path,nullptr,false);
+            }
+        }
+        
+        if (success) {
+            _evicted.erase(key);
+        }
+        return success;
+    }
+    
 };
 
 
@@ -753,6 +952,28 @@ protected:
     
     /** The assets we are expecting that are not yet loaded */
     std::unordered_set<std::string> _queue;
+    
+    /** The last time each asset was accessed, for least-recently-used eviction */
+    mutable std::unordered_map<std::string, Uint64> _stamps;
+    /** The mutex for the access times, as {@link get} may be called from any thread */
+    mutable std::mutex _stampMutex;
+    
+    /**
+     * Returns the memory footprint of the given asset in bytes.
+     *
+     * This value should estimate the memory (either CPU or GPU) that would
+     * be freed if the asset were released.  It should be 0 for any asset
+     * whose memory is shared with another asset.  Assets with a footprint
+     * of 0 are never evicted.
+     *
+     * By default, this method returns 0.  It should be overridden by any
+     * loader for large assets.
+     *
+     * @param asset The asset to measure
+     *
+     * @return the memory footprint of the given asset in bytes.
+     */
+    virtual size_t measure(const std::shared_ptr<T>& asset) const { return 0; }
 
     /**
      * Unloads the asset for the given key
@@ -772,6 +993,8 @@ protected:
         auto it = _assets.find(key);
         if (it != _assets.end()) {
             _assets.erase(it);
+            std::lock_guard<std::mutex> lock(_stampMutex);
+            _stamps.erase(key);
             return true;
         }
         return false;
@@ -810,13 +1033,23 @@ public:
      * If the key is valid, the asset is guaranteed not to be null.  Otherwise,
      * this method returns nullptr
      *
+     * Accessing an asset records the access time for {@link getResidents}.
+     * That record is guarded by a mutex, so (like any const method) this
+     * method may be called from several threads at once.
+     *
      * @param key   The key associated with the asset
      *
      * @return the asset pointer for the given key
      */
     std::shared_ptr<T> get(const std::string& key) const {
         auto it = _assets.find(key);
-        return (it == _assets.end() ? nullptr : it->second);
+        if (it == _assets.end()) {
+            return nullptr;
+        }
+        Uint64 stamp = tick();
+        std::lock_guard<std::mutex> lock(_stampMutex);
+        _stamps[key] = stamp;
+        return it->second;
     }
 
     /**
@@ -830,8 +1063,7 @@ public:
      * @return the asset pointer for the given key
      */
     std::shared_ptr<T> get(const char* key) const {
-        auto it = _assets.find(std::string(key));
-        return (it == _assets.end() ? nullptr : it->second);
+        return get(std::string(key));
     }
     
     /**
@@ -892,6 +1124,105 @@ public:
      */
     void unloadAll() override {
         _assets.clear();
+        {
+            std::lock_guard<std::mutex> lock(_stampMutex);
+            _stamps.clear();
+        }
+        _sources.clear();
+        _entries.clear();
+        _evicted.clear();
+    }
+    
+    
+#pragma mark Memory Residency
+    /**
+     * Returns the memory footprint of all loaded assets in bytes.
+     *
+     * The footprint is an estimate of the memory (either CPU or GPU) that
+     * would be freed if every asset were released.  Assets whose size is
+     * not known count as 0 bytes.
+     *
+     * @return the memory footprint of all loaded assets in bytes.
+     */
+    size_t getFootprint() const override {
+        size_t total = 0;
+        for(auto it = _assets.begin(); it != _assets.end(); ++it) {
+            total += measure(it->second);
+        }
+        return total;
+    }
+    
+    /**
+     * Returns the memory footprint of the given asset in bytes.
+     *
+     * This method returns 0 if the key does not map to a loaded asset.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return the memory footprint of the given asset in bytes.
+     */
+    size_t getFootprint(const std::string& key) const override {
+        auto it = _assets.find(key);
+        return (it == _assets.end() ? 0 : measure(it->second));
+    }
+    
+    /**
+     * Appends the assets that may be evicted to the given vector.
+     *
+     * An asset may only be evicted if this loader holds the only reference
+     * to it, and if this loader knows how to restore it.  Assets that are
+     * in use (such as a texture attached to a visible scene graph) are never
+     * evicted.  Neither are assets that are still in flight (such as an asset
+     * whose load callback is running), as they are still in the queue.
+     *
+     * @param residents The vector to store the evictable assets
+     */
+    void getResidents(std::vector<Resident>& residents) const override {
+        std::lock_guard<std::mutex> lock(_stampMutex);
+        for(auto it = _assets.begin(); it != _assets.end(); ++it) {
+            if (it->second.use_count() > 1 || _queue.find(it->first) != _queue.end()) {
+                continue;
+            } else if (_sources.find(it->first) == _sources.end() &&
+                       _entries.find(it->first) == _entries.end()) {
+                continue;
+            }
+            
+            size_t bytes = measure(it->second);
+            if (bytes > 0) {
+                auto jt = _stamps.find(it->first);
+                residents.push_back({it->first, bytes, jt == _stamps.end() ? 0 : jt->second});
+            }
+        }
+    }
+    
+    /**
+     * Evicts the asset for the given key, returning true on success.
+     *
+     * An evicted asset is released by this loader, but it is not forgotten.
+     * It may be reloaded with {@link restore}.  This method fails if the
+     * asset is currently in use or still in flight, or if the loader does
+     * not know how to restore it.
+     *
+     * @param  key  the key associated with the asset
+     *
+     * @return true if the asset was evicted
+     */
+    bool evict(const std::string& key) override {
+        auto it = _assets.find(key);
+        if (it == _assets.end() || it->second.use_count() > 1 || _queue.find(key) != _queue.end()) {
+            return false;
+        } else if (_sources.find(key) == _sources.end() &&
+                   _entries.find(key) == _entries.end()) {
+            return false;
+        }
+        
+        _assets.erase(it);
+        {
+            std::lock_guard<std::mutex> lock(_stampMutex);
+            _stamps.erase(key);
+        }
+        _evicted.insert(key);
+        return true;
     }
 };
 
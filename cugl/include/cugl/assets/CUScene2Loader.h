@@ -56,6 +56,7 @@
 namespace cugl {
     
 class AssetManager;
+class AssetManifest;
 
 /**
  * This class is a specific implementation of Loader<Node>
@@ -100,6 +101,8 @@ protected:
         WIRE,
         /** An animation node type */
         ANIMATE,
+        /** An animation node streamed from a filmstrip */
+        STREAM,
         /** A nine-patch type */
         NINE,
         /** A text label (uneditable) type */
@@ -112,6 +115,8 @@ protected:
         SLIDER,
         /** A single-line text field type */
         TEXTFIELD,
+        /** A node that caches its subtree offscreen */
+        CACHED,
 		/** A Node implied by an imported file */
 		EXTERNAL_IMPORT,
         /** An unsupported type */
@@ -141,6 +146,12 @@ protected:
     
     /** The type map for managing layout */
     std::unordered_map<std::string,Form> _forms;
+
+    /** An incremental build of a single scene (defined in the implementation) */
+    class Builder;
+    
+    /** The time to spend building scenes each animation frame (in microseconds) */
+    Uint32 _budget;
     
     /**
      * Records the given Node with this loader, so that it may be unloaded later.
@@ -214,6 +225,41 @@ protected:
      */
     virtual bool read(const std::shared_ptr<JsonValue>& json,
                       LoaderCallback callback, bool async) override;
+    
+    /**
+     * Internal method to support loading from a compiled manifest.
+     *
+     * This method supports either synchronous or asynchronous loading, as
+     * specified by the given parameter.  If the loading is asynchronous,
+     * the user may specify an optional callback function.
+     *
+     * This method is like the traditional read method except that the scene
+     * is built from a compiled manifest.  The scene is stored using its key
+     * in the manifest.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     * @param callback  An optional callback for asynchronous loading
+     * @param async     Whether the asset was loaded asynchronously
+     *
+     * @return true if the asset was successfully loaded
+     */
+    bool read(const std::shared_ptr<AssetManifest>& manifest, size_t scene,
+              LoaderCallback callback, bool async);
+    
+    /**
+     * Returns true if all of the dependencies of the given scene are loaded.
+     *
+     * This method logs a warning for every texture or font of the scene that
+     * is not yet loaded.  Such a scene can still be built, but those nodes
+     * will be missing their images or fonts.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     *
+     * @return true if all of the dependencies of the given scene are loaded.
+     */
+    bool verify(const std::shared_ptr<AssetManifest>& manifest, size_t scene) const;
     /**
      * Unloads the asset for the given directory entry
      *
@@ -257,6 +303,48 @@ protected:
 	 */
 	std::shared_ptr<JsonValue> getWidgetJson(const std::shared_ptr<JsonValue>& json) const;
     
+    /**
+     * Returns a newly allocated scene graph node of the given type.
+     *
+     * The node is initialized with the given data.  If the node has no content
+     * size after initialization, it is anchored at the bottom left and given
+     * the size of the display.  This method does not support widgets, which
+     * must be expanded first.
+     *
+     * @param type  The node type
+     * @param data  The node-specific data (may be nullptr)
+     *
+     * @return a newly allocated scene graph node of the given type.
+     */
+    std::shared_ptr<scene2::SceneNode> createNode(Widget type, const std::shared_ptr<JsonValue>& data) const;
+    
+    /**
+     * Returns a newly allocated layout manager for the given format.
+     *
+     * This method returns nullptr if the format is missing, or if it specifies
+     * absolute positioning.
+     *
+     * @param form  The "format" attribute of a scene graph node (may be nullptr)
+     *
+     * @return a newly allocated layout manager for the given format.
+     */
+    std::shared_ptr<scene2::Layout> createLayout(const std::shared_ptr<JsonValue>& form) const;
+    
+    /**
+     * Runs the given builder on the main thread until it is finished.
+     *
+     * The builder is advanced once every animation frame, for at most the
+     * given number of microseconds (0 finishes it in a single frame).  When
+     * it is finished, the scene is laid out and passed to the callback.  The
+     * callback receives nullptr if the scene could not be built.
+     *
+     * @param builder   The scene builder
+     * @param budget    The time to spend each frame (in microseconds)
+     * @param callback  The callback for the finished scene
+     */
+    void schedule(const std::shared_ptr<Builder>& builder, Uint32 budget,
+                  std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback);
+    
 public:
 #pragma mark -
 #pragma mark Constructors
@@ -266,7 +354,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a loader on
      * the heap, use one of the static constructors instead.
      */
-    Scene2Loader() {}
+    Scene2Loader() : _budget(0) {}
     
     /**
      * Initializes a new asset loader.
@@ -320,6 +408,7 @@ public:
         _loader = nullptr;
         _types.clear();
         _forms.clear();
+        _budget = 0;
     }
     
     /**
@@ -386,6 +475,141 @@ public:
      */
     std::shared_ptr<scene2::SceneNode> build(const std::string& key, const std::shared_ptr<JsonValue>& json) const;
     
+    /**
+     * Builds the given scene from a compiled manifest.
+     *
+     * This method is the compiled version of {@link build}.  The manifest has
+     * already expanded all widgets, and lists the scene graph nodes in creation
+     * order (so every parent is created before its children).  Hence this
+     * method is not recursive and parses no JSON.  The node data is rebuilt
+     * directly from the manifest records.
+     *
+     * The key of the scene is assigned as the name of the root Node.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     *
+     * @return the root of the scene graph
+     */
+    std::shared_ptr<scene2::SceneNode> build(const std::shared_ptr<AssetManifest>& manifest, size_t scene) const;
+    
+#pragma mark -
+#pragma mark Incremental Construction
+    /**
+     * Returns the time to spend building scenes each animation frame.
+     *
+     * If this value is positive, asynchronous loads build their scenes on the
+     * main thread, a few nodes at a time, spending at most this many
+     * microseconds each frame.  Only the file is read on the loader thread.
+     * This keeps large scenes from causing a hitch, and guarantees that any
+     * node that creates OpenGL resources does so on the main thread.
+     *
+     * If this value is 0 (the default), asynchronous loads build the entire
+     * scene on the loader thread.  Synchronous loads always build the entire
+     * scene immediately.
+     *
+     * @return the time to spend building scenes each animation frame.
+     */
+    Uint32 getBuildBudget() const { return _budget; }
+    
+    /**
+     * Sets the time to spend building scenes each animation frame.
+     *
+     * If this value is positive, asynchronous loads build their scenes on the
+     * main thread, a few nodes at a time, spending at most this many
+     * microseconds each frame.  Only the file is read on the loader thread.
+     * This keeps large scenes from causing a hitch, and guarantees that any
+     * node that creates OpenGL resources does so on the main thread.
+     *
+     * If this value is 0 (the default), asynchronous loads build the entire
+     * scene on the loader thread.  Synchronous loads always build the entire
+     * scene immediately.
+     *
+     * @param micros    The time to spend building scenes each animation frame
+     */
+    void setBuildBudget(Uint32 micros) { _budget = micros; }
+    
+    /**
+     * Incrementally builds a new scene from the given JSON tree.
+     *
+     * The scene is built on the main thread, a few nodes at a time, spending
+     * at most budget microseconds each animation frame.  A budget of 0 builds
+     * the entire scene in the next frame.  This method returns immediately.
+     *
+     * Once the scene is built, it is laid out and passed to the callback.
+     * The callback receives nullptr if the scene could not be built. The
+     * scene is not added to the asset manager, so each call produces a new
+     * copy of the scene. The key is assigned as the name of the root Node.
+     *
+     * The JSON tree has the same format as a scene file.  In particular, any
+     * widgets it uses must already be loaded.
+     *
+     * @param key       The name of the root node
+     * @param json      The JSON object defining the scene
+     * @param budget    The time to spend each frame (in microseconds)
+     * @param callback  The callback for the finished scene
+     */
+    void instantiate(const std::string& key, const std::shared_ptr<JsonValue>& json, Uint32 budget,
+                     std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback);
+    
+    /**
+     * Incrementally builds a new scene from a compiled manifest.
+     *
+     * The scene is built on the main thread, a few nodes at a time, spending
+     * at most budget microseconds each animation frame.  A budget of 0 builds
+     * the entire scene in the next frame.  This method returns immediately.
+     *
+     * Once the scene is built, it is laid out and passed to the callback.
+     * The callback receives nullptr if the scene could not be built. The
+     * scene is not added to the asset manager, so each call produces a new
+     * copy of the scene. The key of the scene in the manifest is assigned as
+     * the name of the root Node.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     * @param budget    The time to spend each frame (in microseconds)
+     * @param callback  The callback for the finished scene
+     */
+    void instantiate(const std::shared_ptr<AssetManifest>& manifest, size_t scene, Uint32 budget,
+                     std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback);
+    
+#pragma mark -
+#pragma mark Compiled Manifests
+    /**
+     * Loads the given scene from a compiled manifest.
+     *
+     * The scene is assigned the key it has in the manifest.  As with the
+     * JSON scenes, all of its textures and fonts should be loaded first.
+     * This method logs a warning for any that are missing.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     *
+     * @return true if the scene was successfully loaded
+     */
+    bool loadScene(const std::shared_ptr<AssetManifest>& manifest, size_t scene) {
+        return read(manifest, scene, nullptr, false);
+    }
+    
+    /**
+     * Asynchronously loads the given scene from a compiled manifest.
+     *
+     * The scene is assigned the key it has in the manifest.  As with the
+     * JSON scenes, all of its textures and fonts should be loaded first.
+     * This method logs a warning for any that are missing.
+     *
+     * The optional callback function will be called once the scene has
+     * loaded or failed to load.
+     *
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     * @param callback  An optional callback for asynchronous loading
+     */
+    void loadSceneAsync(const std::shared_ptr<AssetManifest>& manifest, size_t scene,
+                        LoaderCallback callback) {
+        read(manifest, scene, callback, true);
+    }
+    
 };
     
 }
@@ -132,6 +132,7 @@ protected:
      *
      *      "file":         The path to the asset
      *      "volume":       This default sound volume (float)
+     *      "format":       The in-memory sample format ("float", "int16", "adpcm")
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
@@ -142,6 +143,18 @@ protected:
     virtual bool read(const std::shared_ptr<JsonValue>& json,
                       LoaderCallback callback, bool async) override;
     
+    /**
+     * Returns the memory footprint of the given sound in bytes.
+     *
+     * This is the size of the decoded samples of an {@link AudioSample}.
+     * Streamed samples and generated sounds have a footprint of 0.
+     *
+     * @param asset The sound to measure
+     *
+     * @return the memory footprint of the given sound in bytes.
+     */
+    size_t measure(const std::shared_ptr<Sound>& asset) const override;
+    
     
 public:
 #pragma mark -
@@ -47,6 +47,7 @@
 #define __CU_TEXTURE_LOADER_H__
 #include <cugl/assets/CULoader.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CUCompressedImage.h>
 
 namespace cugl {
 
@@ -66,6 +67,19 @@ namespace cugl {
  * remainder of asset loading using {@link Application#schedule}.  This is a
  * good template for asset loaders in general.
  *
+ * If a texture has a cooked counterpart (a KTX file with the same name as
+ * the image file), this loader will upload the compressed data directly
+ * instead of decoding the image.  It falls back to the original image if
+ * the KTX file is missing or the GPU does not support its format.  See the
+ * texture cooker in the tools directory for how to produce these files.
+ *
+ * A JSON texture entry may also list reduced resolution variants of the
+ * texture, keyed by their scale relative to the full resolution image.  The
+ * loader picks the smallest variant that still meets the resolution of the
+ * display (see {@link #setReferenceWidth}).  Variants report the size of the
+ * full resolution image, so atlas regions and filmstrip frames are always
+ * specified in full resolution pixels.
+ *
  * As with all of our loaders, this loader is designed to be attached to an
  * asset manager. Use the method {@link getHook()} to get the appropriate
  * pointer for attaching the loader.
@@ -86,6 +100,12 @@ protected:
     GLuint _wrapt;
     /** The default support for mipmaps */
     bool _mipmaps;
+    /** Whether to prefer cooked (compressed) textures when available */
+    bool _compressed;
+    /** The requested resolution for texture variants (0 if automatic) */
+    float _resolution;
+    /** The display width matched by the full resolution textures (0 if none) */
+    float _reference;
     
 #pragma mark Asset Loading
     /**
@@ -114,6 +134,56 @@ protected:
      * @return the SDL_Surface with the texture information
      */
     SDL_Surface* preload(const std::string& source);
+
+    /**
+     * Loads the cooked counterpart of this asset, if it exists.
+     *
+     * The cooked counterpart is the KTX file with the same path as the source,
+     * but with the extension ".ktx".  This method returns nullptr if compressed
+     * textures are disabled, the file does not exist, or the GPU does not
+     * support its format.  It also returns nullptr if mipmaps are required
+     * but the file does not include them, as compressed textures cannot
+     * generate their own mipmaps.
+     *
+     * This method is safe to call outside of the main thread, provided that
+     * {@link CompressedImage#isSupported} has been called at least once in
+     * the main thread.
+     *
+     * @param source    The pathname to the asset
+     * @param mipmaps   Whether the texture requires mipmaps
+     *
+     * @return the compressed image for this asset (or nullptr)
+     */
+    std::shared_ptr<CompressedImage> preloadCompressed(const std::string& source, bool mipmaps);
+
+    /**
+     * Returns the source file for the best resolution variant of this asset.
+     *
+     * A texture directory entry may have a "variants" attribute, which maps
+     * the scale of each variant (as a string) to its source file.  This method
+     * picks the smallest variant with a scale no less than {@link #getResolution}.
+     * If there is no such variant, it returns the "file" attribute, which has
+     * scale 1.
+     *
+     * @param json          The directory entry for the asset
+     * @param resolution    Stores the scale of the chosen variant
+     *
+     * @return the source file for the best resolution variant of this asset.
+     */
+    std::string selectVariant(const std::shared_ptr<JsonValue>& json, float& resolution) const;
+
+    /**
+     * Assigns the variant resolution to a newly loaded texture.
+     *
+     * This method logs an error if the variant does not scale evenly to the
+     * full resolution size, as any atlas regions or filmstrip frames would
+     * then be misaligned.
+     *
+     * @param texture       The loaded texture
+     * @param key           The key of the texture asset
+     * @param resolution    The scale of the variant
+     */
+    void applyVariant(const std::shared_ptr<Texture>& texture, const std::string& key, float resolution);
     
     /**
      * Creates an OpenGL texture from the SDL_Surface, and assigns it the given key.
@@ -128,11 +198,16 @@ protected:
      * This method supports an optional callback function which reports whether
      * the asset was successfully materialized.
      *
+     * If the compressed image is not nullptr, it is used in place of the
+     * surface.
+     *
      * @param key       The key to access the asset after loading
      * @param surface   The SDL_Surface to convert
+     * @param image     The compressed image to upload (or nullptr)
      * @param callback  An optional callback for asynchronous loading
      */
-    void materialize(const std::string& key, SDL_Surface* surface, LoaderCallback callback);
+    void materialize(const std::string& key, SDL_Surface* surface,
+                     const std::shared_ptr<CompressedImage>& image, LoaderCallback callback);
     
     /**
      * Creates an OpenGL texture from the SDL_Surface accoring to the directory entry.
@@ -152,17 +227,28 @@ protected:
      *      "magfilter":    The name of the min filter ("nearest" or "linear")
      *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
      *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+     *      "variants":     An object mapping scales (e.g. "0.5") to reduced variants
      *
      * The asset key is the key for the JSON directory entry
      *
      * This method supports an optional callback function which reports whether
      * the asset was successfully materialized.
      *
-     * @param json      The asset directory entry
-     * @param surface   The SDL_Surface to convert
-     * @param callback  An optional callback for asynchronous loading
+     * If the compressed image is not nullptr, it is used in place of the
+     * surface.
+     *
+     * The resolution is the scale of the chosen variant, as returned by
+     * {@link #selectVariant}.
+     *
+     * @param json          The asset directory entry
+     * @param surface       The SDL_Surface to convert
+     * @param image         The compressed image to upload (or nullptr)
+     * @param resolution    The scale of the chosen variant
+     * @param callback      An optional callback for asynchronous loading
      */
-    void materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback);
+    void materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface,
+                     const std::shared_ptr<CompressedImage>& image, float resolution,
+                     LoaderCallback callback);
     
 
     /**
@@ -208,6 +294,7 @@ protected:
      *      "magfilter":    The name of the min filter ("nearest" or "linear")
      *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
      *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+     *      "variants":     An object mapping scales (e.g. "0.5") to reduced variants
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
@@ -236,6 +323,20 @@ protected:
      */
     virtual bool purge(const std::shared_ptr<JsonValue>& json) override;
     
+    /**
+     * Returns the memory footprint of the given texture in bytes.
+     *
+     * This is the size of the texture data on the GPU, including any mipmaps.
+     * Subtextures share the memory of their parent, so their footprint is 0.
+     * As a result, a texture with an atlas is never evicted while any of its
+     * subtextures remain loaded.
+     *
+     * @param asset The texture to measure
+     *
+     * @return the memory footprint of the given texture in bytes.
+     */
+    size_t measure(const std::shared_ptr<Texture>& asset) const override;
+    
 public:
 #pragma mark -
 #pragma mark Constructors
@@ -405,6 +506,84 @@ public:
      */
     void setMipMaps(bool flag) { _mipmaps = flag; }
 
+    /**
+     * Returns true if this loader prefers cooked (compressed) textures.
+     *
+     * If this value is true, the loader looks for a KTX file next to each
+     * image file, and uploads its compressed data directly.  The loader
+     * falls back to the image file if the KTX file is missing or its format
+     * is not supported by the GPU.  The default is true.
+     *
+     * @return true if this loader prefers cooked (compressed) textures.
+     */
+    bool usesCompressed() const { return _compressed; }
+
+    /**
+     * Sets whether this loader prefers cooked (compressed) textures.
+     *
+     * If this value is true, the loader looks for a KTX file next to each
+     * image file, and uploads its compressed data directly.  The loader
+     * falls back to the image file if the KTX file is missing or its format
+     * is not supported by the GPU.  The default is true.
+     *
+     * @param flag  Whether this loader prefers cooked (compressed) textures.
+     */
+    void setUsesCompressed(bool flag) { _compressed = flag; }
+
+    /**
+     * Returns the resolution requested for texture variants.
+     *
+     * This is the minimum scale (relative to the full resolution image) of
+     * any variant chosen by this loader.  If it has not been set explicitly,
+     * it is computed from the display width and the {@link #getReferenceWidth}.
+     * Devices with little memory never request more than half resolution.
+     * The result is never more than 1.
+     *
+     * @return the resolution requested for texture variants.
+     */
+    float getResolution() const;
+
+    /**
+     * Sets the resolution requested for texture variants.
+     *
+     * This is the minimum scale (relative to the full resolution image) of
+     * any variant chosen by this loader.  If the value is 0, the resolution
+     * is computed from the display width and the {@link #getReferenceWidth}.
+     * Devices with little memory never request more than half resolution.
+     * The default is 0.
+     *
+     * Changing this value does not affect textures that are already loaded.
+     *
+     * @param resolution    The resolution requested for texture variants.
+     */
+    void setResolution(float resolution) { _resolution = resolution; }
+
+    /**
+     * Returns the display width matched by the full resolution textures.
+     *
+     * If the display is narrower than this width, the loader will choose
+     * reduced resolution variants where available.  For example, if the
+     * reference width is 1024 and the display is 540 pixels wide, any
+     * variant of scale 0.5 or more is sufficient.  If this value is 0, only
+     * the device memory affects the choice of variant.  The default is 0.
+     *
+     * @return the display width matched by the full resolution textures.
+     */
+    float getReferenceWidth() const { return _reference; }
+
+    /**
+     * Sets the display width matched by the full resolution textures.
+     *
+     * If the display is narrower than this width, the loader will choose
+     * reduced resolution variants where available.  For example, if the
+     * reference width is 1024 and the display is 540 pixels wide, any
+     * variant of scale 0.5 or more is sufficient.  If this value is 0, only
+     * the device memory affects the choice of variant.  The default is 0.
+     *
+     * @param width The display width matched by the full resolution textures.
+     */
+    void setReferenceWidth(float width) { _reference = width; }
+
 };
 
 }
@@ -116,7 +116,9 @@ protected:
      *
      * This version of read provides support for JSON directories. A json
      * directory entry is just a key with a string value for the
-     * path to the asset.
+     * path to the asset. If the entry is an object instead, it is the
+     * widget definition itself (this is how compiled manifests store
+     * widgets).
      *
      * @param json      The directory entry for the asset
      * @param callback  An optional callback for asynchronous loading
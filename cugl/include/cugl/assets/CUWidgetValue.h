@@ -122,6 +122,23 @@ public:
 	const std::shared_ptr<JsonValue> getJson() const {
 		return json;
 	}
+
+    /**
+     * Returns the JSON of the node encoded by this widget for the given instance.
+     *
+     * The instance is a scene graph entry of type "Widget".  The values in its
+     * "variables" object replace the exposed variables of this widget, and its
+     * "layout" replaces the layout of the widget contents.  The result is a new
+     * copy of the widget contents.
+     *
+     * If the contents are themselves a widget, this method does not expand
+     * them.  That is the responsibility of the caller.
+     *
+     * @param instance  The JSON entry using this widget
+     *
+     * @return the JSON of the node encoded by this widget for the given instance.
+     */
+    std::shared_ptr<JsonValue> substitute(const std::shared_ptr<JsonValue>& instance) const;
 };
 
 }
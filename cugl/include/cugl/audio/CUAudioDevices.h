@@ -36,10 +36,12 @@
 #ifndef __CU_AUDIO_DEVICES_H__
 #define __CU_AUDIO_DEVICES_H__
 #include <SDL/SDL.h>
+#include <cugl/audio/graph/CUAudioRing.h>
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 namespace cugl {
 
@@ -52,9 +54,12 @@ namespace cugl {
      */
     namespace audio {
 	    /** Forward references to some graph nodes */
+        class AudioNode;
         class AudioOutput;
         class AudioInput;
+        class AudioReadAhead;
     }
+    class ThreadPool;
 
 /**
  * Class providing a singleton audio device manager
@@ -96,6 +101,36 @@ private:
     /** The list of all active input devices */
     std::unordered_map<std::string, std::shared_ptr<audio::AudioInput>>  _inputs;
 
+    /** A mutex for the list of streams (never locked by the audio thread) */
+    std::mutex _streamMutex;
+    /** The streams decoded ahead by the background worker */
+    std::vector<std::shared_ptr<audio::AudioReadAhead>> _streams;
+    /** The background worker for decoding streams */
+    std::shared_ptr<ThreadPool> _streamer;
+    /** Whether the background worker should continue to run */
+    std::atomic<bool> _streaming;
+
+    /** A callback event posted by the audio thread */
+    class Event {
+    public:
+        /** The node whose callback should be invoked */
+        std::shared_ptr<audio::AudioNode> source;
+        /** The node passed to the callback */
+        std::shared_ptr<audio::AudioNode> node;
+        /** The action passed to the callback (an AudioNode::Action) */
+        int action;
+
+        /** Creates an empty event */
+        Event() : action(0) {}
+    };
+
+    /** The callback events waiting for the main thread */
+    audio::AudioRing<Event> _events;
+    /** The identifier of the scheduled function draining the events */
+    Uint32 _drainer;
+    /** The number of dropped events reported so far */
+    Uint64 _reported;
+
 #pragma mark -
 #pragma mark Constructors (Private)
     /**
@@ -139,6 +174,15 @@ private:
      */
     void dispose();
 
+    /**
+     * Decodes all registered streams until the manager is disposed.
+     *
+     * This is the task of the background worker.  It repeatedly fills the
+     * read-ahead buffer of each stream, and removes streams that have been
+     * retired.  It sleeps briefly whenever there is no work to do.
+     */
+    void decodeStreams();
+
 
 #pragma mark -
 #pragma mark Static Attributes
@@ -344,6 +388,55 @@ public:
      */
     void reset();
 
+#pragma mark -
+#pragma mark Stream Decoding
+    /**
+     * Registers a stream to be decoded ahead by the background worker.
+     *
+     * The worker is started the first time this method is called.  The
+     * worker keeps a reference to the stream until it is retired with
+     * {@link audio::AudioReadAhead#retire}.  Hence the stream is always
+     * deleted on the worker, and never on the audio thread.
+     *
+     * @param stream    The stream to decode
+     */
+    void addStream(const std::shared_ptr<audio::AudioReadAhead>& stream);
+
+#pragma mark -
+#pragma mark Callback Events
+    /**
+     * Posts a callback event for the main thread.
+     *
+     * AUDIO THREAD SAFE: This is how audio nodes report an action to their
+     * callback function.  The event is added to a preallocated lock-free ring,
+     * so this method never locks a mutex or allocates memory.  The callback
+     * of source is invoked with node and action the next time the events are
+     * drained by {@link flushEvents}.
+     *
+     * If the ring is full, the event is dropped and this method returns false.
+     *
+     * @param source    The node whose callback should be invoked
+     * @param node      The node to pass to the callback
+     * @param action    The action to pass to the callback
+     *
+     * @return true if the event was posted
+     */
+    bool postEvent(const std::shared_ptr<audio::AudioNode>& source,
+                   const std::shared_ptr<audio::AudioNode>& node, int action);
+
+    /**
+     * Invokes the callbacks for all events posted by the audio thread.
+     *
+     * If the manager is started while an {@link Application} is running, this
+     * method is scheduled to run every animation frame.  Otherwise, it must be
+     * called by hand from the main thread.
+     *
+     * The callback function of a node is read when the event is drained (and
+     * not when it is posted).  So if the callback changes in the meantime, the
+     * new callback is the one invoked.
+     */
+    void flushEvents();
+
 
 #pragma mark -
 #pragma mark Output Devices
@@ -42,6 +42,7 @@
 #include <cugl/audio/CUAudioDevices.h>
 #include <cugl/audio/CUSound.h>
 #include <cugl/util/CUTimestamp.h>
+#include <cugl/math/CUVec2.h>
 #include <unordered_map>
 #include <functional>
 #include <vector>
@@ -54,6 +55,12 @@
 /** The default number of slots */
 #define DEFAULT_SLOTSIZE    16
 
+/** The maximum number of idle players kept for each sound asset */
+#define MAX_POOLED_PLAYERS  4
+
+/** The default number of voices for positional sound effects */
+#define DEFAULT_SPATIAL_VOICES  4
+
 namespace cugl {
     /**
      * The audio graph classes.
@@ -69,6 +76,7 @@ namespace cugl {
         class AudioMixer;
         class AudioFader;
         class AudioPanner;
+        class AudioResampler;
     }
 
     /** AudioQueue for music support */
@@ -149,13 +157,110 @@ private:
     
     /** Map keys to identifiers */
     std::unordered_map<std::string,std::shared_ptr<audio::AudioFader>> _actives;
-    /** A queue for slot eviction if necessary */
-    std::deque<std::string> _evicts;
 
+    /**
+     * The voice assigned to a sound effect slot.
+     *
+     * Voices are allocated once (one per slot) when the engine starts. The
+     * fader is nullptr when the slot is free.
+     */
+    class Voice {
+    public:
+        /** The fader currently playing in this slot */
+        std::shared_ptr<audio::AudioFader> fader;
+        /** The priority of the sound effect in this slot */
+        int priority;
+        /** The order in which this voice was started (for stealing) */
+        Uint64 stamp;
+    };
+
+    /** The voices for each sound effect slot */
+    std::vector<Voice> _voices;
+    /** The stack of free sound effect slots */
+    std::vector<Uint32> _freeVoices;
+    /** The number of voices started so far */
+    Uint64 _voiceStamp;
+
+    /**
+     * A rate limit for a sound effect key.
+     *
+     * A key with a rate limit can be played at most once per interval.
+     * Additional requests in that interval are coalesced into the sound
+     * that is already playing.
+     */
+    class RateLimit {
+    public:
+        /** The minimum time between two plays, in microseconds */
+        Uint64 interval;
+        /** The time of the last play */
+        Timestamp last;
+        /** Whether the key has been played yet */
+        bool primed;
+    };
+
+    /** The rate limits for sound effect keys */
+    std::unordered_map<std::string,RateLimit> _limits;
+
+    /**
+     * A positional sound effect.
+     *
+     * Positional effects share a small number of voices.  An effect that
+     * cannot get a voice is either merged into a playing effect of the same
+     * group, or culled.  An emitter may stand for several merged effects.
+     */
+    class Emitter {
+    public:
+        /** The group of this effect (the key passed to playAt) */
+        std::string group;
+        /** The reference key of the voice playing this effect */
+        std::string key;
+        /** The position of this effect (weighted by gain if merged) */
+        Vec2 position;
+        /** The gain of this effect, including distance attenuation */
+        float gain;
+        /** The priority of this effect */
+        int priority;
+        /** The time this effect started */
+        Timestamp start;
+        /** The duration of this effect in microseconds */
+        Uint64 duration;
+    };
+
+    /** The positional sound effects currently playing */
+    std::vector<Emitter> _emitters;
+    /** The maximum number of positional sound effects to play at once */
+    Uint32 _spatialVoices;
+    /** The number of positional sound effects started so far (for keys) */
+    Uint64 _spatialStamp;
+    /** The listener position for positional sound effects */
+    Vec2 _listener;
+    /** The horizontal distance from the listener for a full pan */
+    float _spatialWidth;
+    /** The distance from the listener at which sound is inaudible */
+    float _spatialRange;
+
+    /**
+     * A pool of reusable players for a single sound asset.
+     *
+     * The asset is tracked with a weak pointer, as the address alone may
+     * be reused by another asset once this one is deleted.
+     */
+    class PlayerPool {
+    public:
+        /** The sound asset for these players */
+        std::weak_ptr<Sound> sound;
+        /** The players ready to be reused */
+        std::vector<std::shared_ptr<audio::AudioNode>> nodes;
+    };
+
+    /** An object pool of players for each sound asset */
+    std::unordered_map<const Sound*,PlayerPool> _playerPool;
     /** An object pool of faders for individual sound instances */
     std::deque<std::shared_ptr<audio::AudioFader>>  _fadePool;
     /** An object pool of panners for panning sound assets */
     std::deque<std::shared_ptr<audio::AudioPanner>> _panPool;
+    /** An object pool of resamplers for sounds not at the engine rate */
+    std::deque<std::shared_ptr<audio::AudioResampler>> _samplePool;
 
     /**
      * Callback function for the sound effects
@@ -222,6 +327,74 @@ private:
      */
     void removeKey(const std::string key);
 
+    /**
+     * Returns a free sound effect slot, or -1 if there is none.
+     *
+     * Free slots are kept on a stack, so this is a constant time lookup in
+     * the typical case. If there are no free slots, this method will reuse
+     * any slot whose sound is fading out. Otherwise, if `force` is true, it
+     * steals the slot of the oldest sound with the lowest priority, as long
+     * as that priority is no greater than the one given.
+     *
+     * @param priority  The priority of the new sound effect
+     * @param force     Whether to force another sound to stop.
+     *
+     * @return a free sound effect slot, or -1 if there is none.
+     */
+    int acquireVoice(int priority, bool force);
+
+    /**
+     * Starts the given audio instance in a sound effect slot.
+     *
+     * This method wraps the instance, and associates it with the given key
+     * and slot. The slot should have been acquired by {@link acquireVoice}.
+     *
+     * @param  key      The reference key for the sound effect
+     * @param  slot     The sound effect slot
+     * @param  instance The audio instance to play
+     * @param  loop     Whether to loop the sound effect continuously
+     * @param  volume   The sound volume
+     * @param  priority The priority of the sound effect
+     */
+    void startVoice(const std::string key, Uint32 slot,
+                    const std::shared_ptr<audio::AudioNode>& instance,
+                    bool loop, float volume, int priority);
+
+    /**
+     * Returns true if a play request for this key should be coalesced.
+     *
+     * A request is coalesced if the key has a rate limit, and the key was
+     * last played less than that limit ago. Otherwise, this method records
+     * the request as the last play of this key.
+     *
+     * @param  key  The reference key for the sound effect
+     *
+     * @return true if a play request for this key should be coalesced.
+     */
+    bool coalesce(const std::string key);
+
+    /**
+     * Returns a playback node for the given sound asset.
+     *
+     * This method reuses a player from a previous play of this asset if
+     * possible. Otherwise, it allocates a new one.
+     *
+     * @param sound The sound asset
+     *
+     * @return a playback node for the given sound asset.
+     */
+    std::shared_ptr<audio::AudioNode> acquirePlayer(const std::shared_ptr<Sound>& sound);
+
+    /**
+     * Recycles a playback node created by {@link acquirePlayer}.
+     *
+     * Only players for in-memory samples are recycled. Streamed samples
+     * hold a file handle open, and so are released instead.
+     *
+     * @param node  The playback node
+     */
+    void recyclePlayer(const std::shared_ptr<audio::AudioNode>& node);
+
     /**
      * Returns a playable audio node for a given audio instance
      *
@@ -231,10 +404,9 @@ private:
      * arbitrary audio subgraphs. This method uses the object pools to simplify
      * this process.
      *
-     * This method will also allocated an {@link AudioResampler} if the sample
-     * rate is not consistent with the engine.  However, these are extremely
-     * heavy-weight and cannot be easily reused, and this is to be avoided if
-     * at all possible.
+     * This method will also attach an {@link AudioResampler} if the sample
+     * rate is not consistent with the engine.  These are heavy-weight, so
+     * they are pooled as well.  But it is better to avoid them entirely.
      *
      * @param instance  The audio instance
      *
@@ -270,6 +442,20 @@ private:
      */
     std::shared_ptr<audio::AudioNode> disposeWrapper(const std::shared_ptr<audio::AudioNode>& node);
 
+    /**
+     * Returns the current audibility of a positional sound effect.
+     *
+     * The audibility is the gain of the effect scaled by the fraction of
+     * the effect left to play.  An effect that is nearly done is less
+     * important than one that just started.
+     *
+     * @param emitter   The positional sound effect
+     * @param now       The current time
+     *
+     * @return the current audibility of a positional sound effect.
+     */
+    float getAudibility(const Emitter& emitter, const Timestamp& now) const;
+
     /**
      * Callback function for when a sound effect channel finishes
      *
@@ -440,18 +626,24 @@ public:
      * There are a limited number of slots available for sounds. If you go
      * over the number available, the sound will not play unless `force` is
      * true. In that case, it will grab the channel from the longest playing
-     * sound effect.
+     * sound effect with the lowest priority. It will never grab the channel
+     * of a sound with a higher priority than this one.
+     *
+     * If the key has a rate limit (see {@link setRateLimit}) and was played
+     * too recently, this request is coalesced into the existing sound. The
+     * method returns true, but nothing new is played.
      *
      * @param  key      The reference key for the sound effect
      * @param  sound    The sound effect to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The music volume (relative to the default asset volume)
      * @param  force    Whether to force another sound to stop.
+     * @param  priority The priority for keeping this sound over others
      *
      * @return true if there was an available channel for the sound
      */
     bool play(const std::string key, const std::shared_ptr<Sound>& sound,
-              bool loop=false, float volume=1.0f, bool force=false);
+              bool loop=false, float volume=1.0f, bool force=false, int priority=0);
 
     /**
      * Plays the given audio node, and associates it with the specified key.
@@ -473,18 +665,175 @@ public:
      * There are a limited number of slots available for sounds. If you go
      * over the number available, the sound will not play unless `force` is
      * true. In that case, it will grab the channel from the longest playing
-     * sound effect.
+     * sound effect with the lowest priority. It will never grab the channel
+     * of a sound with a higher priority than this one.
+     *
+     * If the key has a rate limit (see {@link setRateLimit}) and was played
+     * too recently, this request is coalesced into the existing sound. The
+     * method returns true, but nothing new is played.
      *
      * @param  key      The reference key for the sound effect
      * @param  graph    The audio graph to play
      * @param  loop     Whether to loop the sound effect continuously
      * @param  volume   The music volume (relative to the default instance volume)
      * @param  force    Whether to force another sound to stop.
+     * @param  priority The priority for keeping this sound over others
      *
      * @return true if there was an available channel for the sound
      */
     bool play(const std::string key, const std::shared_ptr<audio::AudioNode>& graph,
-              bool loop=false, float volume=1.0f, bool force=false);
+              bool loop=false, float volume=1.0f, bool force=false, int priority=0);
+
+    /**
+     * Sets the minimum time between two plays of the given key.
+     *
+     * Some sound effects (such as collisions) may be requested every frame.
+     * Restarting the sound each time wastes a voice and is rarely audible.
+     * With a rate limit, any request to play this key within the given
+     * number of seconds of the last play is coalesced into the sound that
+     * is already playing.
+     *
+     * A limit of 0 (or less) removes the rate limit for this key.
+     *
+     * @param  key      The reference key for the sound effect
+     * @param  seconds  The minimum time between two plays of this key
+     */
+    void setRateLimit(const std::string key, float seconds);
+
+    /**
+     * Returns the minimum time between two plays of the given key.
+     *
+     * If the key has no rate limit, this method returns 0.
+     *
+     * @param  key  The reference key for the sound effect
+     *
+     * @return the minimum time between two plays of the given key.
+     */
+    float getRateLimit(const std::string key) const;
+
+#pragma mark -
+#pragma mark Positional Effects
+    /**
+     * Plays the given sound at a position in the world.
+     *
+     * This method is a lightweight 2d positional version of {@link play}. The
+     * stereo pan of the sound is derived from the horizontal offset of the
+     * position from the listener, and the gain is attenuated with distance.
+     * See {@link setSpatialListener} for the details.
+     *
+     * Positional effects are fire-and-forget, and are never looped. The key
+     * names a group of effects (such as collisions) rather than a single
+     * sound.  At most {@link getSpatialVoices} positional effects play at once,
+     * regardless of how many are requested. This keeps the cost of a large
+     * burst of events constant.  When every positional voice is in use, a new
+     * effect takes the voice of the least audible effect if it is louder (or
+     * of higher priority).  Otherwise, it is merged into the loudest playing
+     * effect of the same group, which moves toward the new position.  The
+     * merged effect plays at the larger of the two volumes, so a burst of
+     * merged effects is never louder than its loudest member.  If neither is
+     * possible, the effect is culled. Effects too far from the listener to be
+     * heard are always culled.
+     *
+     * @param  key      The group key for the sound effect
+     * @param  sound    The sound effect to play
+     * @param  position The position of the sound effect in the world
+     * @param  volume   The sound volume (relative to the default asset volume)
+     * @param  priority The priority for keeping this sound over others
+     *
+     * @return true if the sound was played or merged into another sound
+     */
+    bool playAt(const std::string key, const std::shared_ptr<Sound>& sound,
+                const Vec2& position, float volume=1.0f, int priority=0);
+
+    /**
+     * Sets the listener for positional sound effects.
+     *
+     * The listener is typically the center of the screen. An effect that is
+     * `width` units to the left (right) of the listener is panned completely
+     * to the left (right) channel.  The gain of an effect falls off with the
+     * square of its distance from the listener, and reaches 0 at a distance
+     * of `range`. A width or range of 0 (the default) disables panning or
+     * attenuation, respectively.
+     *
+     * @param  position The listener position
+     * @param  width    The horizontal distance from the listener for a full pan
+     * @param  range    The distance from the listener at which sound is inaudible
+     */
+    void setSpatialListener(const Vec2& position, float width, float range);
+
+    /**
+     * Returns the listener position for positional sound effects.
+     *
+     * @return the listener position for positional sound effects.
+     */
+    const Vec2& getSpatialListener() const { return _listener; }
+
+    /**
+     * Returns the maximum number of positional sound effects that play at once.
+     *
+     * Positional sound effects also need a free slot (see {@link
+     * getAvailableSlots}), so fewer may play if the slots are in use.  The
+     * default is {@link DEFAULT_SPATIAL_VOICES}.
+     *
+     * @return the maximum number of positional sound effects that play at once.
+     */
+    Uint32 getSpatialVoices() const { return _spatialVoices; }
+
+    /**
+     * Sets the maximum number of positional sound effects that play at once.
+     *
+     * Positional sound effects also need a free slot (see {@link
+     * getAvailableSlots}), so fewer may play if the slots are in use.  If
+     * more effects are playing than this value, the least audible ones are
+     * stopped.
+     *
+     * @param voices    The maximum number of positional sound effects
+     */
+    void setSpatialVoices(Uint32 voices);
+
+    /**
+     * Returns the number of positional sound effects currently playing.
+     *
+     * @return the number of positional sound effects currently playing.
+     */
+    size_t getSpatialCount() const { return _emitters.size(); }
+
+    /**
+     * Returns the volume of the loudest positional effect in the given group.
+     *
+     * The volume includes distance attenuation.  If several effects were
+     * merged into one voice, this is the volume of that voice.  This method
+     * returns 0 if no effect in the group is playing.
+     *
+     * @param  key  The group key for the sound effects
+     *
+     * @return the volume of the loudest positional effect in the given group.
+     */
+    float getSpatialVolume(const std::string key) const;
+
+    /**
+     * Returns the stereo pan for a sound effect at the given position.
+     *
+     * The value is in the range -1 (left) to 1 (right), as described in
+     * {@link setSpatialListener}.
+     *
+     * @param  position The position of the sound effect in the world
+     *
+     * @return the stereo pan for a sound effect at the given position.
+     */
+    float getSpatialPan(const Vec2& position) const;
+
+    /**
+     * Returns the distance attenuation for a sound effect at the given position.
+     *
+     * The value is in the range 0 (inaudible) to 1 (at the listener), as
+     * described in {@link setSpatialListener}.
+     *
+     * @param  position The position of the sound effect in the world
+     *
+     * @return the distance attenuation for a sound effect at the given position.
+     */
+    float getSpatialGain(const Vec2& position) const;
     
     /**
      * Returns the number of slots available for sound effects.
@@ -498,7 +847,7 @@ public:
      * @return the number of slots available for sound effects.
      */
     size_t getAvailableSlots() const {
-        return _capacity-_actives.size();
+        return _freeVoices.size();
     }
 
     /**
@@ -68,8 +68,11 @@ namespace  cugl {
  * MP3, Ogg (Vorbis), and Flac.  As a general rule, we prefer WAV for sound 
  * effects and Ogg for music.
  *
- * All audio samples consist of float-formated PCM data. We assume channels are
- * interleaved.  We support up to 32 channels, though it is unlikely for that
+ * Audio samples are played back as float-formated PCM data. We assume channels
+ * are interleaved. However, in-memory samples may be stored in a more compact
+ * {@link Format} and converted to float during playback.  This is ideal for
+ * short sound effects, where 16-bit PCM halves the memory and IMA ADPCM cuts
+ * it by a factor of seven.  We support up to 32 channels, though it is unlikely for that
  * many channels to be encoded in a sound file.  SDL itself only supports 8
  * channels for (7.1 surround) playback.
  */
@@ -98,6 +101,22 @@ public:
         IN_MEMORY = 4
     };
 
+#pragma mark Sample Formats
+    /**
+     * This enum represents the storage format of an in-memory sample.
+     *
+     * The format only affects how the samples are stored. Playback always
+     * converts the samples to float.  Streamed samples are always FLOAT.
+     */
+    enum class Format : int {
+        /** 32-bit float PCM (4 bytes a sample, no conversion cost) */
+        FLOAT  = 0,
+        /** 16-bit integer PCM (2 bytes a sample, lossless for 16-bit files) */
+        INT16  = 1,
+        /** IMA ADPCM (about 4 bits a sample, lossy) */
+        ADPCM  = 2
+    };
+
 protected:
     /** The number of frames in this audio sample */
     Uint64 _frames;
@@ -110,6 +129,32 @@ protected:
 
     /** The in-memory sound buffer for this sound source (OPTIONAL) */
     float* _buffer;
+    /** The in-memory 16-bit sound buffer for this sound source (OPTIONAL) */
+    Sint16* _pcm16;
+    /** The in-memory ADPCM blocks for this sound source (OPTIONAL) */
+    Uint8* _adpcm;
+    /** The storage format of the in-memory samples */
+    Format _format;
+
+    /**
+     * Encodes the float buffer as IMA ADPCM blocks.
+     *
+     * The blocks are stored in {@link _adpcm}. The float buffer is not
+     * modified or released.
+     */
+    void encodeADPCM();
+
+    /**
+     * Decodes the given frames from the ADPCM blocks into the buffer.
+     *
+     * Each block stores its own predictor state, so decoding starts from
+     * the beginning of the block containing the first frame.
+     *
+     * @param buffer    The buffer to store the results
+     * @param frame     The first frame to decode
+     * @param frames    The number of frames to decode
+     */
+    void decodeADPCM(float* buffer, Uint64 frame, Uint32 frames) const;
     
 public:
 #pragma mark Constructors
@@ -133,12 +178,16 @@ public:
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
      * this initializer will allocate memory to read the asset into memory.
      *
+     * In-memory samples are stored in the given format. The format is
+     * ignored if the sample is streamed.
+     *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param format    The storage format for in-memory samples
      *
      * @return true if the sound source was initialized successfully
      */
-    bool init(const char* file, bool stream=false);
+    bool init(const char* file, bool stream=false, Format format=Format::FLOAT);
     
     /**
      * Initializes a new audio sample for the given file.
@@ -147,13 +196,17 @@ public:
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
      * this initializer will allocate memory to read the asset into memory.
      *
+     * In-memory samples are stored in the given format. The format is
+     * ignored if the sample is streamed.
+     *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param format    The storage format for in-memory samples
      *
      * @return true if the sound source was initialized successfully
      */
-    bool init(const std::string& file, bool stream=false) {
-        return init(file.c_str(),stream);
+    bool init(const std::string& file, bool stream=false, Format format=Format::FLOAT) {
+        return init(file.c_str(),stream,format);
     }
     
     /**
@@ -204,6 +257,18 @@ public:
     static Type guessType(const std::string& file) {
         return guessType(file.c_str());
     }
+
+    /**
+     * Returns the sample format for the given name
+     *
+     * The name should be one of "float", "int16", or "adpcm" (case does not
+     * matter). Any other name is FLOAT.
+     *
+     * @param name  The format name
+     *
+     * @return the sample format for the given name
+     */
+    static Format parseFormat(const std::string& name);
     
 #pragma mark Static Constructors
     /**
@@ -213,14 +278,19 @@ public:
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
      * this initializer will allocate memory to read the asset into memory.
      *
+     * In-memory samples are stored in the given format. The format is
+     * ignored if the sample is streamed.
+     *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param format    The storage format for in-memory samples
      *
      * @return a newly allocated audio sample for the given file.
      */
-    static std::shared_ptr<AudioSample> alloc(const char* file, bool stream=false) {
+    static std::shared_ptr<AudioSample> alloc(const char* file, bool stream=false,
+                                              Format format=Format::FLOAT) {
         std::shared_ptr<AudioSample> result = std::make_shared<AudioSample>();
-        return (result->init(file,stream) ? result : nullptr);
+        return (result->init(file,stream,format) ? result : nullptr);
     }
     
     /**
@@ -230,13 +300,18 @@ public:
      * If the file is streamed, it will not be loaded into memory.  Otherwise,
      * this initializer will allocate memory to read the asset into memory.
      *
+     * In-memory samples are stored in the given format. The format is
+     * ignored if the sample is streamed.
+     *
      * @param file      The source file for the audio sample
      * @param stream    Wether to stream the audio from the file.
+     * @param format    The storage format for in-memory samples
      *
      * @return a newly allocated audio sample for the given file.
      */
-    static std::shared_ptr<AudioSample> alloc(const std::string& file, bool stream=false) {
-        return alloc(file.c_str(), stream);
+    static std::shared_ptr<AudioSample> alloc(const std::string& file, bool stream=false,
+                                              Format format=Format::FLOAT) {
+        return alloc(file.c_str(), stream, format);
     }
     
     /**
@@ -267,10 +342,12 @@ public:
      *      "file":     The path to the source, relative to the asset directory
      *      "stream":   A boolean, indicating whether to stream the sample
      *      "volume":   A float, representing the volume
+     *      "format":   One of "float", "int16", or "adpcm" (in-memory only)
      *
      * All attributes are optional.  There are no required attributes. By default,
      * audio samples are not streamed, meaning they are fully loaded into memory.
-     * This is recommended for sound effects, but not for music.
+     * This is recommended for sound effects, but not for music. In-memory
+     * samples are stored as float unless another format is given.
      *
      * @param data      The JSON object specifying the audio sample
      *
@@ -315,18 +392,67 @@ public:
      * @return the length of this audio sample in seconds.
      */
     virtual double getDuration() const override { return (double)_frames/(double)_rate; }
+
+    /**
+     * Returns the storage format of this audio sample.
+     *
+     * Streamed samples are always FLOAT.
+     *
+     * @return the storage format of this audio sample.
+     */
+    Format getFormat() const { return _format; }
+
+    /**
+     * Converts this in-memory sample to the given storage format.
+     *
+     * Converting to a compact format discards the float buffer.  Converting
+     * back to FLOAT restores it, though any precision lost by the compact
+     * format is not recovered. This method does nothing for a streamed sample.
+     *
+     * This method should never be called while the sample is playing.
+     *
+     * @param format    The new storage format
+     *
+     * @return true if the sample was converted
+     */
+    bool setFormat(Format format);
+
+    /**
+     * Returns the number of bytes used to store the in-memory samples.
+     *
+     * This value is 0 for a streamed sample.
+     *
+     * @return the number of bytes used to store the in-memory samples.
+     */
+    size_t getFootprint() const;
     
 #pragma mark Playback Support
     /**
      * Returns the underlying PCM data buffer.
      *
-     * This pointer will be null if the sample is streamed.  Otherwise, the
-     * the buffer will contain channels * frames many elements. It is okay to
-     * write data to the buffer, but it cannot be resized or reassigned.
+     * This pointer will be null if the sample is streamed, or if it is not
+     * stored as FLOAT. Otherwise, the buffer will contain channels * frames
+     * many elements. It is okay to write data to the buffer, but it cannot be
+     * resized or reassigned.
      *
      * @return the underlying PCM data buffer.
      */
     float* getBuffer() { return _buffer; }
+
+    /**
+     * Reads frames from an in-memory sample into the given buffer.
+     *
+     * The buffer should have enough room to store frames * channels elements.
+     * The samples are converted to float as necessary. This method does not
+     * allocate memory, and so it is safe to call in the audio thread.
+     *
+     * @param buffer    The buffer to store the results
+     * @param frame     The first frame to read
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    Uint32 read(float* buffer, Uint64 frame, Uint32 frames) const;
         
     /**
      * Returns a new decoder for this audio sample
@@ -0,0 +1,289 @@
+//
+//  CUAudioReadAhead.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an asynchronous read-ahead buffer for a streaming
+//  audio decoder.  Decoding a compressed stream (OGG, MP3, FLAC) requires
+//  both file I/O and a lot of computation.  Doing this in the audio thread
+//  competes with the deadline of the audio callback.  Instead, this class
+//  decodes the stream on a background worker (owned by AudioDevices) into
+//  a lock-free ring buffer.  The audio thread only copies from that buffer.
+//
+//  To support glitch-free looping, this class also keeps a decoded copy of
+//  the start of the stream.  A rewind plays from that copy while the worker
+//  refills the ring buffer.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_READ_AHEAD_H__
+#define __CU_AUDIO_READ_AHEAD_H__
+#include <SDL/SDL.h>
+#include "CUAudioDecoder.h"
+#include <atomic>
+#include <memory>
+
+namespace cugl {
+
+    /**
+     * The audio graph classes.
+     *
+     * This internal namespace is for the audio graph clases.  It was chosen
+     * to distinguish this graph from other graph class collections, such as the
+     * scene graph collections in {@link scene2}.
+     */
+    namespace audio {
+
+/**
+ * This class decodes an audio stream ahead of the audio thread.
+ *
+ * This class is used by {@link AudioPlayer} for streamed samples.  It has
+ * three threads of access. The main thread creates it and registers it with
+ * {@link AudioDevices#addStream}. The background worker of the device
+ * manager calls {@link fill} to decode the stream into a ring buffer. The
+ * audio thread calls {@link read} and {@link seek}.  Neither read nor seek
+ * will lock, allocate, or touch the decoder.
+ *
+ * The ring buffer holds a few hundred milliseconds of audio.  In addition,
+ * the same amount of audio from the start of the stream is decoded once at
+ * initialization.  A seek to the start of the stream (such as a loop) plays
+ * from this copy while the worker seeks the decoder and refills the ring.
+ * Seeks to other positions are serviced by the worker. If a seek is within
+ * the data already buffered, no decoding is necessary.
+ *
+ * If the audio thread ever asks for data that is not yet decoded, the read
+ * comes up short. This is an underrun, and is tracked by {@link getUnderruns}.
+ *
+ * To dispose of this object, call {@link retire} and release any references.
+ * The worker releases its reference on the next pass.  That way, the memory
+ * is never freed on the audio thread.
+ */
+class AudioReadAhead {
+private:
+    /** The decoder for this stream (WORKER ONLY after initialization) */
+    std::shared_ptr<AudioDecoder> _decoder;
+    /** The number of channels in the stream */
+    Uint32 _channels;
+    /** The length of the stream in frames */
+    Uint64 _length;
+
+    /** The decoded start of the stream */
+    float* _head;
+    /** The number of frames in the decoded start of the stream */
+    Uint64 _headsize;
+
+    /** The ring buffer of decoded audio */
+    float* _ring;
+    /** The capacity of the ring buffer in frames */
+    Uint32 _capacity;
+    /** The absolute frame position of the next frame to read */
+    std::atomic<Uint64> _readpos;
+    /** The absolute frame position of the next frame to write */
+    std::atomic<Uint64> _writepos;
+
+    /** The absolute frame position of the last seek request */
+    std::atomic<Uint64> _seekpos;
+    /** The generation of the last seek request (written by the audio thread) */
+    std::atomic<Uint32> _seekgen;
+    /** The generation of the seek last serviced (written by the worker) */
+    std::atomic<Uint32> _readygen;
+    /** The generation the worker is currently decoding (WORKER ONLY) */
+    Uint32 _workgen;
+
+    /** The absolute frame position of the audio thread (AUDIO THREAD ONLY) */
+    Uint64 _cursor;
+
+    /** The most recently decoded page (WORKER ONLY) */
+    float* _page;
+    /** The number of frames in the decoded page (WORKER ONLY) */
+    Uint32 _pagelimit;
+    /** The number of frames in the decoded page already written (WORKER ONLY) */
+    Uint32 _pagelast;
+
+    /** The number of reads that came up short */
+    std::atomic<Uint64> _underruns;
+    /** Whether this stream is no longer in use */
+    std::atomic<bool> _retired;
+
+public:
+#pragma mark Constructors
+    /** The default amount of audio to decode ahead, in seconds */
+    static const double DEFAULT_LOOKAHEAD;
+
+    /**
+     * Creates a degenerate read-ahead buffer with no decoder.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioReadAhead();
+
+    /**
+     * Deletes this read-ahead buffer, disposing of all resources.
+     */
+    ~AudioReadAhead() { dispose(); }
+
+    /**
+     * Initializes a read-ahead buffer for the given decoder.
+     *
+     * The lookahead is the amount of audio (in seconds) to keep decoded
+     * ahead of the audio thread.  The same amount of audio is decoded from
+     * the start of the stream immediately, on the calling thread.
+     *
+     * Once this method is called, the decoder should not be accessed by
+     * anything other than this object.
+     *
+     * @param decoder   The stream decoder
+     * @param lookahead The amount of audio to decode ahead, in seconds
+     *
+     * @return true if initialization was successful
+     */
+    bool init(const std::shared_ptr<AudioDecoder>& decoder, double lookahead=DEFAULT_LOOKAHEAD);
+
+    /**
+     * Disposes any resources allocated for this read-ahead buffer.
+     *
+     * This method should only be called when no other thread holds a
+     * reference to this object.
+     */
+    void dispose();
+
+    /**
+     * Returns a newly allocated read-ahead buffer for the given decoder.
+     *
+     * The lookahead is the amount of audio (in seconds) to keep decoded
+     * ahead of the audio thread.  The same amount of audio is decoded from
+     * the start of the stream immediately, on the calling thread.
+     *
+     * Once this method is called, the decoder should not be accessed by
+     * anything other than this object.
+     *
+     * @param decoder   The stream decoder
+     * @param lookahead The amount of audio to decode ahead, in seconds
+     *
+     * @return a newly allocated read-ahead buffer for the given decoder.
+     */
+    static std::shared_ptr<AudioReadAhead> alloc(const std::shared_ptr<AudioDecoder>& decoder,
+                                                 double lookahead=DEFAULT_LOOKAHEAD) {
+        std::shared_ptr<AudioReadAhead> result = std::make_shared<AudioReadAhead>();
+        return (result->init(decoder,lookahead) ? result : nullptr);
+    }
+
+#pragma mark Attributes
+    /**
+     * Returns the number of channels in the stream.
+     *
+     * @return the number of channels in the stream.
+     */
+    Uint32 getChannels() const { return _channels; }
+
+    /**
+     * Returns the length of the stream in frames.
+     *
+     * @return the length of the stream in frames.
+     */
+    Uint64 getLength() const { return _length; }
+
+    /**
+     * Returns the capacity of the ring buffer in frames.
+     *
+     * @return the capacity of the ring buffer in frames.
+     */
+    Uint32 getCapacity() const { return _capacity; }
+
+    /**
+     * Returns the number of reads that came up short.
+     *
+     * A read comes up short when the worker has not decoded far enough
+     * ahead. This is heard as a brief gap in the audio.
+     *
+     * @return the number of reads that came up short.
+     */
+    Uint64 getUnderruns() const { return _underruns.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns true if this stream is no longer in use.
+     *
+     * @return true if this stream is no longer in use.
+     */
+    bool isRetired() const { return _retired.load(std::memory_order_relaxed); }
+
+    /**
+     * Marks this stream as no longer in use.
+     *
+     * The worker will stop decoding this stream and release its reference.
+     * This method is safe to call from any thread.
+     */
+    void retire() { _retired.store(true,std::memory_order_relaxed); }
+
+#pragma mark Audio Thread Methods
+    /**
+     * Reads up to the specified number of frames into the given buffer
+     *
+     * AUDIO THREAD ONLY: This method only copies decoded data.  It never
+     * locks, allocates, or touches the decoder.
+     *
+     * The buffer should have enough room to store frames * channels elements.
+     * The channels are interleaved into the output buffer.  If fewer frames
+     * are available than requested, the remainder of the buffer is filled
+     * with 0s.  If this happens before the end of the stream, it is counted
+     * as an underrun.
+     *
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    Uint32 read(float* buffer, Uint32 frames);
+
+    /**
+     * Moves the read position to the given absolute frame.
+     *
+     * AUDIO THREAD ONLY: This method never blocks.  The actual decoder seek
+     * is performed by the worker.
+     *
+     * If the frame is in the decoded start of the stream, or in the part of
+     * the ring buffer already decoded, reads will continue without a gap.
+     *
+     * @param frame     The absolute frame position
+     */
+    void seek(Uint64 frame);
+
+#pragma mark Worker Methods
+    /**
+     * Decodes the stream until the ring buffer is full.
+     *
+     * WORKER ONLY: This method should only be called by the background
+     * worker of {@link AudioDevices}.
+     *
+     * This method services any pending seek before decoding.  It returns
+     * false if there was no work to do.
+     *
+     * @return true if any audio was decoded
+     */
+    bool fill();
+};
+
+    }
+}
+
+#endif /* __CU_AUDIO_READ_AHEAD_H__ */
@@ -36,5 +36,6 @@
 #include "CUWAVDecoder.h"
 #include "CUOGGDecoder.h"
 #include "CUFLACDecoder.h"
+#include "CUAudioReadAhead.h"
 
 #endif /* __AU_CODECS_H__ */
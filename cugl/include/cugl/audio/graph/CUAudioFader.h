@@ -39,7 +39,7 @@
 #define __CU_AUDIO_FADER_H__
 #include <SDL/SDL.h>
 #include "CUAudioNode.h"
-#include <mutex>
+#include <atomic>
 
 namespace cugl {
 
@@ -78,38 +78,79 @@ protected:
     /** The audio input node */
     std::shared_ptr<AudioNode> _input;
 
-    /** This class needs a proper lock guard; too many race conditions */
-    std::mutex _mutex;
-    
+    /**
+     * The fade requests waiting for the audio thread.
+     *
+     * The main thread never modifies the fade state directly, as that would
+     * require a lock in {@link read}.  Instead, it sets the parameters of a
+     * request and then sets the request bit.  The audio thread applies all
+     * requests at the start of the next read.
+     */
+    std::atomic<Uint32> _requests;
+    /** The requested fade-in length in frames; -1 to cancel */
+    std::atomic<Sint64> _inreq;
+    /** The requested fade-out length in frames; -1 to cancel */
+    std::atomic<Sint64> _outreq;
+    /** Whether the requested fade-out persists on a reset */
+    std::atomic<bool>   _keepreq;
+    /** The requested fade-dip pause length in frames; -1 to cancel */
+    std::atomic<Sint64> _dipreq;
+    /** The requested fade-dip resume length in frames */
+    std::atomic<Uint64> _stopreq;
+
     // Fade-in: For softer starts
     /** The final frame of the current fade-in; -1 if no active fade-in */
-    Sint64 _inmark;
+    std::atomic<Sint64> _inmark;
     /** The current fade-in in frames; 0 if no active fade-in */
     Uint64 _fadein;
     
     // Fade-out: For smooth stopping
     /** The final frame of the current fade-out; -1 if no active fade-out */
-    Sint64 _outmark;
+    std::atomic<Sint64> _outmark;
     /** The current fade-out in frames; 0 if no active fade-out */
-    Uint64 _fadeout;
+    std::atomic<Uint64> _fadeout;
     /** Whether we have completed this node due to a fadeout */
-    bool   _outdone;
+    std::atomic<bool>   _outdone;
     /** Whether to persist fade-out on a reset */
-    bool   _outkeep;
+    std::atomic<bool>   _outkeep;
     
     // Fade-dip: For smooth pausing
     /** The current fade-dip in frames; 0 if no active fade-dip */
     Uint64 _fadedip;
     /** The middle (pause) frame of the fade-dip; -1 if no active fade-dip */
-    Sint64 _dipmark;
+    std::atomic<Sint64> _dipmark;
     /** The final (resume) frame of the fade-dip; 0 if no active fade-dip */
     Uint64 _dipstop;
     /** Whether we have completed the first half of a fade-dip */
-    bool   _diphalf;
-    /** To prevent a race condition on pausing */
-    bool   _dipstart;
+    std::atomic<bool>   _diphalf;
+
+    /**
+     * Replaces the pending fade requests.
+     *
+     * The requests in clear are withdrawn and the requests in set are added,
+     * in a single atomic step.  The audio thread applies the requests at the
+     * start of the next read.
+     *
+     * @param clear The requests to withdraw
+     * @param set   The requests to add
+     */
+    void request(Uint32 clear, Uint32 set);
+
+    /**
+     * Applies the pending fade requests.
+     *
+     * This method is called by {@link read} before any audio is processed.
+     * Cancellations are applied before new fades, so a fade requested after
+     * a cancellation is not lost.
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     * The only exception is when the user needs to create a custom subclass
+     * of this AudioNode.
+     *
+     * @param requests  The requests to apply
+     */
+    void applyRequests(Uint32 requests);
 
-    
     /**
      * Performs a fade-in.
      *
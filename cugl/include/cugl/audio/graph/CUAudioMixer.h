@@ -36,7 +36,9 @@
 #ifndef __CU_AUDIO_MIXER_H__
 #define __CU_AUDIO_MIXER_H__
 #include "CUAudioNode.h"
+#include "CUAudioSnapshot.h"
 #include <mutex>
+#include <vector>
 
 namespace cugl {
 
@@ -65,12 +67,31 @@ namespace cugl {
  * The audio graph should only be accessed in the main thread.  In addition,
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the user.
  *
+ * The {@link read} method never locks or allocates. The inputs are stored
+ * in an {@link AudioSnapshot}, and changing them (via {@link attach},
+ * {@link detach}, or {@link setWidth}) publishes a new snapshot instead of
+ * modifying the one the audio thread is reading.
+ *
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioMixer : public AudioNode {
 private:
+    /**
+     * An immutable set of mixer inputs.
+     *
+     * The audio thread reads the inputs from a snapshot, while the main
+     * thread replaces the snapshot whenever the inputs change.  The shared
+     * pointers keep the input nodes alive until the snapshot is reclaimed on
+     * the main thread.
+     */
+    class Inputs {
+    public:
+        /** The input nodes to be mixed (one per slot) */
+        std::vector<std::shared_ptr<AudioNode>> nodes;
+    };
+
     /** The input nodes to be mixed */
-    std::shared_ptr<AudioNode>* _inputs;
+    AudioSnapshot<Inputs> _inputs;
     /** The number of input nodes supported by this mixer */
     Uint8 _width;
 
@@ -82,13 +103,27 @@ private:
     /** The knee value for clamping */
     std::atomic<float>  _knee;
 
-    /** This class needs a proper lock guard; too many race conditions */
-    std::mutex _mutex;
+    /** Serializes the control methods (this is never locked by the audio thread) */
+    mutable std::mutex _mutex;
     /** The current read position */
     std::atomic<Uint64> _offset;
     /** The last marked position (starts at 0) */
     std::atomic<Uint64> _marked;
 
+    /**
+     * Replaces the input node at the given slot, returning the previous one.
+     *
+     * This method copies the current inputs into a new snapshot and publishes
+     * it. The audio thread continues to read the old snapshot until its next
+     * call to {@link read}.
+     *
+     * @param slot  The slot for the input node
+     * @param input The input node to attach (may be nullptr)
+     *
+     * @return the input node previously at the given slot
+     */
+    std::shared_ptr<AudioNode> swap(Uint8 slot, const std::shared_ptr<AudioNode>& input);
+
 public:
 #pragma mark Constructors
     /** The default number of inputs supported (typically 8) */
@@ -279,13 +314,16 @@ public:
     /**
      * Sets the width of this mixer.
      *
-     * The width is the number of supported input slots. This method will only
-     * succeed if the mixer is paused.  Otherwise, it will fail.
+     * The width is the number of supported input slots. It is safe to call
+     * this method while the mixer is playing, as the new slots are swapped
+     * in atomically.
      *
      * Once the width is adjusted, the children will be reassigned in order.
      * If the new width is less than the old width, children at the end of
      * the mixer will be dropped.
      *
+     * @param width The number of input slots
+     *
      * @return true if the mixer width was reset
      */
     bool setWidth(Uint8 width);
@@ -196,6 +196,9 @@ protected:
      * might change during that delay.  This is a wrapper to ensure that this
      * potential race condition happens gracefully and does not have any
      * unexpected side effects.
+     *
+     * The event is posted to {@link AudioDevices#postEvent}, which never locks
+     * or allocates.  So this method is safe to call from the audio thread.
      */
     void notify(const std::shared_ptr<AudioNode>& node, Action action);
     
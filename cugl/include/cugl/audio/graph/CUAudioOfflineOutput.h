@@ -0,0 +1,383 @@
+//
+//  CUAudioOfflineOutput.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an output node that is not attached to any audio
+//  device.  Instead of waiting on an SDL callback, it pulls the audio graph
+//  on demand.  It can render as fast as possible on the calling thread, or
+//  at a simulated real-time rate on a thread of its own.  The rendered audio
+//  can be captured in memory and saved as a WAV file.
+//
+//  This node is for profiling and debugging.  Every render call is timed,
+//  so it is possible to measure the CPU cost of an audio graph (and find
+//  the worst-case callback) without any audio hardware.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_OFFLINE_OUTPUT_H__
+#define __CU_AUDIO_OFFLINE_OUTPUT_H__
+#include "CUAudioOutput.h"
+#include <atomic>
+#include <thread>
+#include <string>
+
+namespace cugl {
+
+    /**
+     * The audio graph classes.
+     *
+     * This internal namespace is for the audio graph clases.  It was chosen
+     * to distinguish this graph from other graph class collections, such as the
+     * scene graph collections in {@link scene2}.
+     */
+    namespace audio {
+/**
+ * This class is an output node that renders without an audio device.
+ *
+ * This node can be used anywhere an {@link AudioOutput} is expected, such as
+ * {@link AudioEngine#start}.  However, it never opens an SDL audio device.
+ * Instead, the audio graph is pulled in one of two ways.
+ *
+ * The method {@link render} pulls the given number of frames on the calling
+ * thread, as fast as possible. This is ideal for benchmarks and for bouncing
+ * a graph to a file. As the calling thread is also the main thread, any main
+ * thread work (such as {@link Application#step}) must be interleaved with
+ * the calls to render.
+ *
+ * The method {@link start} creates a thread that pulls the graph at a
+ * simulated real-time rate, one buffer at a time, exactly like an audio
+ * device would.  This is ideal for reproducing glitches that depend on the
+ * interaction between the main thread and the audio thread.
+ *
+ * Every buffer is timed. The statistics {@link getCallbacks}, {@link
+ * getAverageCost}, {@link getWorstCost} and {@link getLoad} summarize these
+ * timings.  In addition, the node can capture the rendered audio in a buffer
+ * preallocated by {@link setCapture}. The capture may be saved as a 32 bit
+ * float WAV file with {@link saveCapture}.
+ *
+ * Unlike {@link AudioOutput}, this node is not managed by {@link AudioDevices}.
+ * It is created with its own static constructor. However, the device manager
+ * must still be active, as it is needed to allocate most audio nodes.
+ */
+class AudioOfflineOutput : public AudioOutput {
+private:
+    /** The simulated audio thread (nullptr if not running) */
+    std::thread* _thread;
+    /** Whether the simulated audio thread should keep running */
+    std::atomic<bool> _running;
+
+    /** The capture buffer (nullptr if not capturing) */
+    float* _capture;
+    /** The capacity of the capture buffer in frames */
+    Uint64 _capacity;
+    /** The number of frames captured so far */
+    std::atomic<Uint64> _captured;
+
+    /** The number of buffers rendered since the statistics were reset */
+    std::atomic<Uint64> _callbacks;
+    /** The total render time of those buffers, in microseconds */
+    std::atomic<Uint64> _totalCost;
+    /** The longest render time of a single buffer, in microseconds */
+    std::atomic<Uint64> _worstCost;
+
+    /**
+     * Pulls the simulated audio thread until it is stopped.
+     *
+     * This is the body of the thread created by {@link start}.  It renders
+     * one buffer and then sleeps until that buffer would have finished
+     * playing on a real device.
+     */
+    void runLoop();
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a degenerate offline output node.
+     *
+     * The node has not been initialized, so it cannot render.  The node
+     * must be initialized to be used.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a node on
+     * the heap, use one of the static constructors instead.
+     */
+    AudioOfflineOutput();
+
+    /**
+     * Deletes the offline output node, disposing of all resources
+     */
+    ~AudioOfflineOutput() { dispose(); }
+
+    /**
+     * Initializes an offline output node with 2 channels at 48000 Hz.
+     *
+     * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+     * frames, just like the default output device.
+     *
+     * The node is initialized unpaused.  It does not render anything until
+     * either {@link render} or {@link start} is called.
+     *
+     * @return true if initialization was successful
+     */
+    virtual bool init() override;
+
+    /**
+     * Initializes an offline output node with the given channels and sample rate.
+     *
+     * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+     * frames, just like the default output device.
+     *
+     * The node is initialized unpaused.  It does not render anything until
+     * either {@link render} or {@link start} is called.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     *
+     * @return true if initialization was successful
+     */
+    virtual bool init(Uint8 channels, Uint32 rate) override;
+
+    /**
+     * Initializes an offline output node with the given channels and sample rate.
+     *
+     * The buffer value is the number of frames rendered by each call to
+     * {@link read}. It should match the buffer size of the device being
+     * simulated.
+     *
+     * The node is initialized unpaused.  It does not render anything until
+     * either {@link render} or {@link start} is called.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     * @param buffer    The number of frames in each render call
+     *
+     * @return true if initialization was successful
+     */
+    bool init(Uint8 channels, Uint32 rate, Uint32 buffer);
+
+    /**
+     * Disposes any resources allocated for this offline output node.
+     *
+     * This method stops the simulated audio thread if it is running.  The
+     * state of the node is reset to that of an uninitialized constructor.
+     * Unlike the destructor, this method allows the node to be reinitialized.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Returns a newly allocated offline output node with 2 channels at 48000 Hz.
+     *
+     * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+     * frames, just like the default output device.
+     *
+     * @return a newly allocated offline output node.
+     */
+    static std::shared_ptr<AudioOfflineOutput> alloc() {
+        std::shared_ptr<AudioOfflineOutput> result = std::make_shared<AudioOfflineOutput>();
+        return (result->init() ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated offline output node with the given channels and sample rate.
+     *
+     * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+     * frames, just like the default output device.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     *
+     * @return a newly allocated offline output node.
+     */
+    static std::shared_ptr<AudioOfflineOutput> alloc(Uint8 channels, Uint32 rate) {
+        std::shared_ptr<AudioOfflineOutput> result = std::make_shared<AudioOfflineOutput>();
+        return (result->init(channels,rate) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated offline output node with the given channels and sample rate.
+     *
+     * The buffer value is the number of frames rendered by each call to
+     * {@link read}. It should match the buffer size of the device being
+     * simulated.
+     *
+     * @param channels  The number of audio channels
+     * @param rate      The sample rate (frequency) in Hz
+     * @param buffer    The number of frames in each render call
+     *
+     * @return a newly allocated offline output node.
+     */
+    static std::shared_ptr<AudioOfflineOutput> alloc(Uint8 channels, Uint32 rate, Uint32 buffer) {
+        std::shared_ptr<AudioOfflineOutput> result = std::make_shared<AudioOfflineOutput>();
+        return (result->init(channels,rate,buffer) ? result : nullptr);
+    }
+
+#pragma mark Rendering
+    /**
+     * Renders the given number of frames on the calling thread.
+     *
+     * The graph is pulled one buffer at a time, as fast as possible.  The
+     * number of frames is rounded up to a whole number of buffers.  This
+     * method does nothing if the simulated audio thread is running.
+     *
+     * @param frames    The number of frames to render
+     *
+     * @return the number of frames rendered
+     */
+    Uint64 render(Uint64 frames);
+
+    /**
+     * Starts the simulated audio thread.
+     *
+     * The thread pulls one buffer at a time, at the rate a real device with
+     * this buffer size and sample rate would.  If a render call takes longer
+     * than the duration of its buffer, the thread does not sleep before the
+     * next one. That call is counted in {@link getUnderruns}.
+     *
+     * @return true if the thread was started
+     */
+    bool start();
+
+    /**
+     * Stops the simulated audio thread.
+     *
+     * This method blocks until the thread has finished its current buffer.
+     * It does nothing if the thread is not running.
+     */
+    void stop();
+
+    /**
+     * Returns true if the simulated audio thread is running.
+     *
+     * @return true if the simulated audio thread is running.
+     */
+    bool isRunning() const { return _running.load(std::memory_order_relaxed); }
+
+    /**
+     * Reads up to the specified number of frames into the given buffer
+     *
+     * AUDIO THREAD ONLY: Users should never access this method directly.
+     * Use {@link render} or {@link start} instead.
+     *
+     * This method pulls the graph exactly like {@link AudioOutput#read}.  In
+     * addition, it records the time of the call and appends the result to the
+     * capture buffer (if there is room).
+     *
+     * @param buffer    The read buffer to store the results
+     * @param frames    The maximum number of frames to read
+     *
+     * @return the actual number of frames read
+     */
+    virtual Uint32 read(float* buffer, Uint32 frames) override;
+
+#pragma mark Capture
+    /**
+     * Sets the capacity of the capture buffer in frames.
+     *
+     * Rendered audio is copied into the capture buffer until it is full.
+     * Later audio is rendered, but not captured.  The buffer is allocated
+     * by this method, and never by the render calls.  Setting the capacity
+     * to 0 disables capture.  Any previous capture is discarded.
+     *
+     * This method should not be called while the simulated audio thread
+     * is running.
+     *
+     * @param frames    The capacity of the capture buffer in frames
+     */
+    void setCapture(Uint64 frames);
+
+    /**
+     * Returns the capture buffer.
+     *
+     * The buffer has {@link getCaptured} frames of interleaved audio. It is
+     * nullptr if capture is disabled.
+     *
+     * @return the capture buffer.
+     */
+    const float* getCapture() const { return _capture; }
+
+    /**
+     * Returns the number of frames captured so far.
+     *
+     * @return the number of frames captured so far.
+     */
+    Uint64 getCaptured() const { return _captured.load(std::memory_order_acquire); }
+
+    /**
+     * Saves the captured audio as a WAV file.
+     *
+     * The file uses 32 bit IEEE float samples at the rate and channels of
+     * this node.  If the file is a relative path, it is saved in the
+     * application save directory {@see Application#getSaveDirectory()}.
+     *
+     * @param file  The path (absolute or relative) to the file
+     *
+     * @return true if the file was written successfully
+     */
+    bool saveCapture(const std::string& file) const;
+
+#pragma mark Statistics
+    /**
+     * Returns the number of buffers rendered since the last reset.
+     *
+     * @return the number of buffers rendered since the last reset.
+     */
+    Uint64 getCallbacks() const { return _callbacks.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the average render time of a buffer in microseconds.
+     *
+     * @return the average render time of a buffer in microseconds.
+     */
+    double getAverageCost() const;
+
+    /**
+     * Returns the longest render time of a single buffer in microseconds.
+     *
+     * This is the worst-case callback. On a real device, this is the call
+     * most likely to produce a pop or a stutter.
+     *
+     * @return the longest render time of a single buffer in microseconds.
+     */
+    Uint64 getWorstCost() const { return _worstCost.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the average render time as a fraction of the buffer duration.
+     *
+     * A load of 1 means that the graph takes as long to render as it takes
+     * to play.  A real device will start to underrun well before that.
+     *
+     * @return the average render time as a fraction of the buffer duration.
+     */
+    double getLoad() const;
+
+    /**
+     * Resets the render statistics.
+     *
+     * This method also resets the underrun count of {@link AudioOutput}.
+     */
+    void resetStatistics();
+};
+
+    }
+}
+
+#endif /* __CU_AUDIO_OFFLINE_OUTPUT_H__ */
@@ -113,12 +113,14 @@ namespace cugl {
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioOutput : public AudioNode {
-private:
+protected:
     /** The device name for this output node.  Empty string for default */
     std::string _dvname;
     
     /** The processing time required for this device */
     std::atomic<Uint64> _overhd;
+    /** The number of render calls that took longer than the buffer duration */
+    std::atomic<Uint64> _underruns;
 
     /** The audio device in use */
     SDL_AudioDeviceID _device;
@@ -483,6 +485,18 @@ public:
      * @return the number of microseconds needed to render the last audio frame.
      */
     Uint64 getOverhead() const;
+
+    /**
+     * Returns the number of underruns since this node was created.
+     *
+     * An underrun is a render call that took longer than the duration of the
+     * audio it produced.  When that happens, the device runs out of data and
+     * the listener hears a pop or a stutter.  This method is primarily for
+     * debugging and stress testing.
+     *
+     * @return the number of underruns since this node was created.
+     */
+    Uint64 getUnderruns() const;
     
 #pragma mark -
 #pragma mark Optional Methods
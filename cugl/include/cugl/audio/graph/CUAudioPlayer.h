@@ -40,6 +40,7 @@
 #define __CU_AUDIO_PLAYER_H__
 #include <SDL/SDL.h>
 #include <cugl/audio/CUAudioSample.h>
+#include <cugl/audio/codecs/CUAudioReadAhead.h>
 #include "CUAudioNode.h"
 #include <functional>
 #include <string>
@@ -71,7 +72,10 @@ namespace  cugl {
  * you should combine this node with {@link AudioScheduler}.
  *
  * This class is medium-weight, and has a lot of buffers to support stream
- * decoding (when appropriate).  In practice, it may be best to create a
+ * decoding (when appropriate). If the {@link AudioDevices} manager is running,
+ * a streamed sample is decoded ahead by its background worker (see
+ * {@link AudioReadAhead}), so the audio thread never decodes or reads a file.
+ * Otherwise, the stream is decoded in the audio thread as needed.  In practice, it may be best to create a
  * memory pool of preallocated players (which are reinitialized) than to
  * construct them on the fly.
  *
@@ -97,9 +101,6 @@ protected:
     /** The last marked position (starts at 0) */
     std::atomic<Uint64> _marked;
     
-    /** A reference to the underlying data buffer (IN-MEMORY ACCESS) */
-    float* _buffer;
-    
     // Streaming support
     /** A buffer for storing each chunk as we need it */
     float* _chunker;
@@ -109,6 +110,8 @@ protected:
     Uint32 _chklimt;
     /** The number of the last read frame in the chunk */
     Uint32 _chklast;
+    /** The read-ahead buffer (if decoding in the background) */
+    std::shared_ptr<AudioReadAhead> _readahead;
         
     /** Whether or not we need to reposition (STREAMING ACCESS) */
     std::atomic<bool> _dirty;
@@ -170,6 +173,20 @@ public:
      */
     std::shared_ptr<AudioSample> getSource() { return _source; }
 
+    /**
+     * Returns the number of underruns for this player.
+     *
+     * An underrun is a read of a streamed sample that came up short because
+     * the background worker had not decoded far enough ahead. This value is
+     * always 0 for in-memory samples, or for streams decoded in the audio
+     * thread.
+     *
+     * @return the number of underruns for this player.
+     */
+    Uint64 getUnderruns() const {
+        return _readahead == nullptr ? 0 : _readahead->getUnderruns();
+    }
+
 #pragma mark Overriden Methods
     /**
      * Reads up to the specified number of frames into the given buffer
@@ -3,8 +3,8 @@
 //  Cornell University Game Library (CUGL)
 //
 //  This module provides a graph node for converting from one sample rate to
-//  another.  It uses SDL_AudioStream to perform continuous resampling on a
-//  potentially infinite audio stream.  This is is necessary for cross-platform
+//  another.  It uses a polyphase windowed-sinc filter to perform continuous
+//  resampling on a potentially infinite audio stream.  This is is necessary for cross-platform
 //  reasons as iPhones are very stubborn about delivering any requested sampling
 //  rates other than 48000.
 //
@@ -34,8 +34,8 @@
 #ifndef __CU_AUDIO_RESAMPLER_H__
 #define __CU_AUDIO_RESAMPLER_H__
 #include <cugl/audio/graph/CUAudioNode.h>
+#include <cugl/audio/graph/CUAudioSnapshot.h>
 #include <SDL/SDL.h>
-#include <mutex>
 #include <atomic>
 
 namespace cugl {
@@ -51,8 +51,8 @@ namespace cugl {
 /**
  * This class provides a graph node for converting from one sample rate to another.
  *
- * The node uses SDL_AudioStream to perform continuous resampling on a
- * potentially infinite audio stream.  This is is necessary for cross-platform
+ * The node uses a polyphase windowed-sinc filter to perform continuous
+ * resampling on a potentially infinite audio stream.  This is is necessary for cross-platform
  * reasons as iPhones are very stubborn about delivering any requested sampling
  * rates other than 48000.
  *
@@ -64,24 +64,91 @@ namespace cugl {
  * no methods marked as AUDIO THREAD ONLY should ever be accessed by the
  * user.
  *
+ * The {@link read} method never locks or allocates.  Each call to
+ * {@link attach} creates a fresh conversion filter and swaps it in with an
+ * {@link AudioSnapshot}.  The previous filter is freed on the main thread.
+ * The filter taps are applied with the vectorized {@link dsp::DSPMath#dot}.
+ *
  * This class does not support any actions for the {@link AudioNode#setCallback}.
  */
 class AudioResampler : public AudioNode {
 private:
-    /** Mutex to protect more sophisticated synchronization */
-    mutable std::mutex _buffmtex;
+    /**
+     * The conversion state for a single input node.
+     *
+     * The audio thread reads this state from a snapshot.  Attaching a new
+     * input builds a new conversion state on the main thread, instead of
+     * modifying the one the audio thread is using.  The conversion state
+     * owns its filter and buffers, and frees them when deleted.
+     *
+     * The filter has one set of taps for each phase.  If the output rate
+     * is L/M times the input rate (in lowest terms), there are L phases,
+     * and each output frame advances the phase by M.  The input history is
+     * stored one channel per row, so that each output sample is a single
+     * contiguous dot product.
+     */
+    class Converter {
+    public:
+        /** The input node to resample from */
+        std::shared_ptr<AudioNode> input;
+        /** The intermediate (interleaved) sampling buffer */
+        float* buffer;
+        /** The capacity of the intermediate buffer in frames */
+        Uint32 capacity;
+        /** The conversion ratio */
+        float ratio;
+
+        /** The filter coefficients, with taps elements per phase (if needed) */
+        float* filter;
+        /** The number of filter taps for each phase */
+        Uint32 taps;
+        /** The number of filter phases (L) */
+        Uint32 phases;
+        /** The phase increment for each output frame (M) */
+        Uint32 step;
+
+        /** The input history, with one row for each channel */
+        float* history;
+        /** The length of a single history row in frames */
+        Uint32 rowsize;
+        /** The number of frames in the history (AUDIO THREAD ONLY) */
+        Uint32 length;
+        /** The history frame of the next output frame (AUDIO THREAD ONLY) */
+        Uint32 cursor;
+        /** The filter phase of the next output frame (AUDIO THREAD ONLY) */
+        Uint32 phase;
+
+        /**
+         * Creates an empty conversion state
+         */
+        Converter() : buffer(nullptr), capacity(0), ratio(1.0f),
+        filter(nullptr), taps(0), phases(1), step(1),
+        history(nullptr), rowsize(0), length(0), cursor(0), phase(0) {}
+
+        /**
+         * Deletes this conversion state, freeing the filter and buffers
+         */
+        ~Converter();
+
+        /**
+         * Builds the polyphase filter for the given rates.
+         *
+         * The filter is a Blackman-windowed sinc.  When downsampling, the
+         * cutoff is lowered to the output Nyquist frequency, and the filter
+         * is widened to match.  Each phase is normalized to unit gain.
+         *
+         * @param inrate    The input sampling rate
+         * @param outrate   The output sampling rate
+         */
+        void buildFilter(Uint32 inrate, Uint32 outrate);
+    };
 
     /** The input node to resample from */
     std::shared_ptr<AudioNode> _input;
-    
-    /** Conversion resampler (if needed) */
-    SDL_AudioStream* _resampler;
+    /** The conversion state read by the audio thread */
+    AudioSnapshot<Converter> _converter;
     /** The currently support input sample rate */
     Uint32 _inputrate;
-    /** The intermediate sampling buffer */
-    float* _cvtbuffer;
-    /** The capacity of the sampling buffer */
-    size_t _capacity;
     /** The conversion ratio */
     std::atomic<float>  _cvtratio;
     
@@ -173,10 +240,10 @@ public:
     /**
      * Attaches an audio node to this resampler.
      *
-     * This method will reset the resampler stream if the input has a different
-     * rate than the previous input value (and is not the same rate as the
-     * output).  It will fail if the input does not have the same number of
-     * channels as this resampler.
+     * This method will create a new conversion filter for the input (unless the
+     * input has the same rate as the output).  The new filter is swapped in
+     * atomically, so the audio thread never waits on this method.  It will fail
+     * if the input does not have the same number of channels as this resampler.
      *
      * @param node  The audio node to resample
      *
@@ -188,7 +255,7 @@ public:
      * Detaches an audio node from this resampler.
      *
      * If the method succeeds, it returns the audio node that was removed.
-     * This method will not automatically reset the sampling stream.
+     * The sampling stream for the input is released as well.
      *
      * @return  The audio node to detach (or null if failed)
      */
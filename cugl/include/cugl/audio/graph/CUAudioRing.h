@@ -0,0 +1,181 @@
+//
+//  CUAudioRing.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a bounded, preallocated queue for passing messages
+//  from the audio thread to the main thread.  Pushing to the queue never
+//  locks a mutex or allocates memory, so it is safe in an audio callback.
+//  This is how the audio graph reports events (such as a completed fade)
+//  without scheduling a callback from the audio thread.
+//
+//  This class is header only, as it is a template.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_RING_H__
+#define __CU_AUDIO_RING_H__
+#include <SDL/SDL.h>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace cugl {
+    namespace audio {
+/**
+ * This class is a bounded, lock-free queue of messages.
+ *
+ * A ring has a single consumer (the main thread).  It usually has a single
+ * producer (the audio thread), but it is safe to push from more than one
+ * producer.  That happens when there is more than one output device, as
+ * each device has its own audio thread.
+ *
+ * All of the slots are allocated when the ring is created.  Hence {@link push}
+ * never allocates memory or locks a mutex.  If the ring is full, the message
+ * is dropped and push returns false.
+ *
+ * The consumer moves each message out of its slot, leaving the slot in its
+ * default state.  So if a message holds a shared pointer, the producer only
+ * ever copies into an empty slot.  The reference is released by the consumer,
+ * and the audio thread never runs the destructor of an audio node.
+ *
+ * Each slot carries a sequence number, which is how a producer and the
+ * consumer agree on whether the slot is full.  This is the bounded queue
+ * design of Dmitry Vyukov.
+ */
+template <typename T>
+class AudioRing {
+private:
+    /** A single message slot */
+    class Slot {
+    public:
+        /** The sequence number of this slot */
+        std::atomic<Uint64> sequence;
+        /** The message value */
+        T value;
+    };
+
+    /** The slots of this ring */
+    std::unique_ptr<Slot[]> _slots;
+    /** The capacity minus one (the capacity is a power of two) */
+    Uint64 _mask;
+    /** The next position to push */
+    std::atomic<Uint64> _head;
+    /** The next position to pop (CONSUMER ONLY) */
+    Uint64 _tail;
+    /** The number of messages dropped because the ring was full */
+    std::atomic<Uint64> _dropped;
+
+public:
+    /**
+     * Creates a ring with (at least) the given capacity.
+     *
+     * The capacity is rounded up to the nearest power of two.
+     *
+     * @param capacity  The number of messages the ring can hold
+     */
+    AudioRing(Uint32 capacity) : _head(0), _tail(0), _dropped(0) {
+        Uint64 size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _mask = size-1;
+        _slots = std::unique_ptr<Slot[]>(new Slot[size]);
+        for(Uint64 ii = 0; ii < size; ii++) {
+            _slots[ii].sequence.store(ii,std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Returns the number of messages this ring can hold.
+     *
+     * @return the number of messages this ring can hold.
+     */
+    Uint64 capacity() const { return _mask+1; }
+
+    /**
+     * Returns the number of messages dropped because the ring was full.
+     *
+     * @return the number of messages dropped because the ring was full.
+     */
+    Uint64 dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Adds a message to the ring, returning false if it is full.
+     *
+     * This method is lock-free, and never allocates memory.  It may be
+     * called from any thread.
+     *
+     * @param value The message to add
+     *
+     * @return true if the message was added
+     */
+    bool push(const T& value) {
+        Uint64 pos = _head.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &_slots[pos & _mask];
+            Uint64 seq = slot->sequence.load(std::memory_order_acquire);
+            Sint64 diff = (Sint64)seq-(Sint64)pos;
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                _dropped.fetch_add(1,std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = value;
+        slot->sequence.store(pos+1,std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest message from the ring, returning false if empty.
+     *
+     * CONSUMER ONLY: This method should only be called by the main thread.
+     *
+     * @param value The variable to store the message
+     *
+     * @return true if a message was removed
+     */
+    bool pop(T& value) {
+        Slot* slot = &_slots[_tail & _mask];
+        Uint64 seq = slot->sequence.load(std::memory_order_acquire);
+        if (seq != _tail+1) {
+            return false;
+        }
+        value = std::move(slot->value);
+        slot->value = T();
+        slot->sequence.store(_tail+_mask+1,std::memory_order_release);
+        _tail++;
+        return true;
+    }
+};
+
+    }
+}
+
+#endif /* __CU_AUDIO_RING_H__ */
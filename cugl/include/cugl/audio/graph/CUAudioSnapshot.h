@@ -0,0 +1,202 @@
+//
+//  CUAudioSnapshot.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a wait-free way to share state between the main
+//  thread and the audio thread.  The main thread never modifies state that
+//  the audio thread might be reading.  Instead, it builds a new immutable
+//  snapshot and swaps it in atomically.  The old snapshot is retired, and is
+//  only deleted (on the main thread) once the audio thread has provably
+//  stopped reading it.  This is a simple form of read-copy-update (RCU).
+//
+//  This means that the audio thread never locks a mutex, allocates memory,
+//  or frees memory when it reads a snapshot.  That is important, as any of
+//  these can cause the audio thread to miss its deadline, which is heard as
+//  a pop or a stutter.
+//
+//  This class is header only, as it is a template.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_AUDIO_SNAPSHOT_H__
+#define __CU_AUDIO_SNAPSHOT_H__
+#include <SDL/SDL.h>
+#include <atomic>
+#include <vector>
+#include <utility>
+
+namespace cugl {
+    namespace audio {
+/**
+ * This class is an atomically swappable snapshot of audio graph state.
+ *
+ * A snapshot has exactly one reader (the audio thread) and one writer (the
+ * main thread).  The reader brackets each access with {@link acquire} and
+ * {@link release}.  The writer never modifies a snapshot in place.  Instead,
+ * it allocates a new value and calls {@link publish}.  This swaps in the new
+ * value and retires the old one.
+ *
+ * Retired values are deleted on the writer thread, and only when the reader
+ * is known to be done with them.  The reader increments an epoch counter on
+ * both acquire and release, so the counter is odd exactly when the reader is
+ * inside a read.  A value retired at an even epoch was never visible to a
+ * reader.  A value retired at an odd epoch may be deleted as soon as that
+ * epoch has passed.
+ *
+ * As a result, {@link acquire} and {@link release} are wait-free.  They never
+ * lock, allocate, or free memory.  This is what makes the class safe to use
+ * in an audio callback.  All of the bookkeeping cost is paid by the writer.
+ *
+ * The values of a snapshot should be treated as immutable once published.
+ * If the value holds shared pointers, those pointers are kept alive until
+ * the value is deleted on the writer thread.  Hence the audio thread never
+ * runs the destructor of an audio node.
+ */
+template <typename T>
+class AudioSnapshot {
+private:
+    /** The current snapshot value (may be nullptr) */
+    std::atomic<T*> _current;
+    /** The reader epoch; this is odd while the reader is active */
+    std::atomic<Uint64> _epoch;
+    /** The retired values, paired with the epoch at retirement (WRITER ONLY) */
+    std::vector<std::pair<T*,Uint64>> _retired;
+
+public:
+    /**
+     * Creates an empty snapshot.
+     */
+    AudioSnapshot() : _current(nullptr), _epoch(0) {}
+
+    /**
+     * Deletes this snapshot, disposing of all values
+     */
+    ~AudioSnapshot() { clear(); }
+
+    /**
+     * Starts a read of the current value, returning it.
+     *
+     * AUDIO THREAD ONLY: This method should only be called by the reader.
+     *
+     * The value returned is guaranteed to be valid until the matching call
+     * to {@link release}. It may be nullptr if nothing has been published.
+     * This method is wait-free.
+     *
+     * @return the current value
+     */
+    T* acquire() {
+        _epoch.fetch_add(1);
+        return _current.load();
+    }
+
+    /**
+     * Ends a read started by {@link acquire}.
+     *
+     * AUDIO THREAD ONLY: This method should only be called by the reader.
+     *
+     * Once this method is called, the value returned by acquire may be
+     * deleted at any time.  This method is wait-free.
+     */
+    void release() {
+        _epoch.fetch_add(1);
+    }
+
+    /**
+     * Returns the current value.
+     *
+     * WRITER ONLY: The value is only safe to use on the writer thread, since
+     * only that thread can delete it.  It may be nullptr if nothing has been
+     * published.
+     *
+     * @return the current value
+     */
+    T* get() const {
+        return _current.load();
+    }
+
+    /**
+     * Swaps in the given value, retiring the previous one.
+     *
+     * WRITER ONLY: This method should only be called by the writer thread.
+     *
+     * The snapshot takes ownership of the value, which should not be modified
+     * once published.  This method will also delete any retired values the
+     * reader is done with.
+     *
+     * @param value The value to publish
+     */
+    void publish(T* value) {
+        T* prev = _current.exchange(value);
+        if (prev != nullptr) {
+            _retired.push_back(std::make_pair(prev,_epoch.load()));
+        }
+        reclaim();
+    }
+
+    /**
+     * Deletes all retired values that the reader is done with.
+     *
+     * WRITER ONLY: This method should only be called by the writer thread.
+     *
+     * This method is called automatically by {@link publish}. However, it
+     * may also be called periodically to release memory sooner.
+     */
+    void reclaim() {
+        if (_retired.empty()) {
+            return;
+        }
+        Uint64 epoch = _epoch.load();
+        size_t kept = 0;
+        for(size_t ii = 0; ii < _retired.size(); ii++) {
+            Uint64 stamp = _retired[ii].second;
+            if ((stamp & 1) == 0 || stamp != epoch) {
+                delete _retired[ii].first;
+            } else {
+                _retired[kept++] = _retired[ii];
+            }
+        }
+        _retired.resize(kept);
+    }
+
+    /**
+     * Deletes the current value and all retired values.
+     *
+     * WRITER ONLY: This method is only safe if the reader is not active,
+     * such as when the audio node is being disposed.
+     */
+    void clear() {
+        T* prev = _current.exchange(nullptr);
+        if (prev != nullptr) {
+            delete prev;
+        }
+        for(auto it = _retired.begin(); it != _retired.end(); ++it) {
+            delete it->first;
+        }
+        _retired.clear();
+    }
+};
+
+    }
+}
+
+#endif /* __CU_AUDIO_SNAPSHOT_H__ */
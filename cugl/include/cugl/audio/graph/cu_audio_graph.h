@@ -31,7 +31,10 @@
 #define __CU_AUDIO_GRAPH_PKG_H__
 
 #include "CUAudioNode.h"
+#include "CUAudioSnapshot.h"
+#include "CUAudioRing.h"
 #include "CUAudioOutput.h"
+#include "CUAudioOfflineOutput.h"
 #include "CUAudioInput.h"
 #include "CUAudioResampler.h"
 #include "CUAudioPlayer.h"
@@ -39,6 +42,7 @@
 #include "CUAudioScheduler.h"
 #include "CUAudioMixer.h"
 #include "CUAudioPanner.h"
+#include "CUAudioConvolver.h"
 #include "CUAudioSpinner.h"
 #include "CUAudioSynchronizer.h"
 
@@ -155,6 +155,8 @@ protected:
     bool _highdpi;
 	/** Whether this application supports multisampling */
 	bool _multisamp;
+    /** Whether this application runs without a window or OpenGL context */
+    bool _headless;
     
     /** The target FPS of this application */
     float _fps;
@@ -176,6 +178,15 @@ private:
     Timestamp _start;
     /** The timestamp for the end of an animation frame */
     Timestamp _finish;
+
+    /** Whether the update loop uses a fixed timestep */
+    bool _fixed;
+    /** The length of a fixed timestep in microseconds */
+    Uint64 _fixedStep;
+    /** The elapsed time not yet consumed by a fixed timestep */
+    Uint64 _fixedRemainder;
+    /** The maximum number of fixed timesteps in a single frame */
+    Uint32 _fixedLimit;
     
     /** Counter to assign unique keys to callbacks */
     Uint32 _funcid;
@@ -324,6 +335,52 @@ public:
      */
     virtual void update(float timestep) { }
 
+    /**
+     * The method called to prepare the application data for simulation.
+     *
+     * This method is only called if the application is deterministic (see
+     * {@link #setDeterministic}).  It is called once per frame, before any
+     * call to {@link #fixedUpdate}.  It should handle anything that is tied
+     * to the animation frame rather than the simulation, such as input and
+     * menus.
+     *
+     * When overriding this method, you do not need to call the parent method
+     * at all. The default implmentation does nothing.
+     *
+     * @param timestep  The amount of time (in seconds) since the last frame
+     */
+    virtual void preUpdate(float timestep) { }
+
+    /**
+     * The method called to advance the simulation by a single fixed timestep.
+     *
+     * This method is only called if the application is deterministic (see
+     * {@link #setDeterministic}).  It is called zero or more times per frame,
+     * once for each fixed timestep that has elapsed.  The length of each
+     * timestep is always {@link #getFixedStep}, no matter the frame rate.
+     * So any timer counted in calls to this method is measured in timesteps.
+     *
+     * When overriding this method, you do not need to call the parent method
+     * at all. The default implmentation does nothing.
+     */
+    virtual void fixedUpdate() { }
+
+    /**
+     * The method called to finish the application data for drawing.
+     *
+     * This method is only called if the application is deterministic (see
+     * {@link #setDeterministic}).  It is called once per frame, after all
+     * calls to {@link #fixedUpdate}.  The value {@link #getFixedRemainder}
+     * is the time since the last fixed timestep, which should be used to
+     * interpolate the simulation state for drawing.
+     *
+     * When overriding this method, you do not need to call the parent method
+     * at all. The default implmentation does nothing.
+     *
+     * @param timestep  The amount of time (in seconds) since the last frame
+     */
+    virtual void postUpdate(float timestep) { }
+
     /**
      * The method called to draw the application to the screen.
      *
@@ -354,6 +411,8 @@ public:
      *
      * This method processes the input, calls the update method, and then
      * draws it.  It also updates any running statics, like the average FPS.
+     * If the application is deterministic, the update method is replaced by
+     * the methods preUpdate, fixedUpdate, and postUpdate.
      *
      * @return false if the application should quit next frame
      */
@@ -622,6 +681,33 @@ public:
 	 */
 	bool isMultiSampled() const { return _multisamp; }
 
+    /**
+     * Sets whether this application runs without a window or OpenGL context.
+     *
+     * A headless application has the normal update-draw loop, but all of
+     * its rendering is redirected to the {@link RenderRecorder}. Nothing
+     * is drawn, but the draw calls, vertices, and uploads are counted. This
+     * allows render tests to run on build machines without a graphics card.
+     *
+     * This value must be set before the application is initialized. By
+     * default, it is false.
+     *
+     * @param flag  Whether this application runs without a window or OpenGL context.
+     */
+    void setHeadless(bool flag);
+
+    /**
+     * Returns true if this application runs without a window or OpenGL context.
+     *
+     * A headless application has the normal update-draw loop, but all of
+     * its rendering is redirected to the {@link RenderRecorder}. Nothing
+     * is drawn, but the draw calls, vertices, and uploads are counted. This
+     * allows render tests to run on build machines without a graphics card.
+     *
+     * @return true if this application runs without a window or OpenGL context.
+     */
+    bool isHeadless() const { return _headless; }
+
 #pragma mark -
 #pragma mark Runtime Attributes
 
@@ -744,6 +830,99 @@ public:
      * @return the average frames per second over the last 10 frames.
      */
     float getAverageFPS() const;
+
+    /**
+     * Sets whether this application uses a fixed timestep for simulation.
+     *
+     * A deterministic application does not call {@link #update}.  Instead,
+     * each frame calls {@link #preUpdate}, then {@link #fixedUpdate} once
+     * for each fixed timestep that has elapsed, and then {@link #postUpdate}.
+     * Hence the simulation advances at the same rate no matter the frame
+     * rate, and the frame rate can match the display refresh rate.
+     *
+     * This method may be safely changed at any time while the application
+     * is running.
+     *
+     * By default, this value is false.
+     *
+     * @param value Whether this application uses a fixed timestep
+     */
+    void setDeterministic(bool value);
+
+    /**
+     * Returns true if this application uses a fixed timestep for simulation.
+     *
+     * See {@link #setDeterministic} for a description of the fixed timestep.
+     *
+     * By default, this value is false.
+     *
+     * @return true if this application uses a fixed timestep for simulation.
+     */
+    bool isDeterministic() const { return _fixed; }
+
+    /**
+     * Sets the length of the fixed timestep in microseconds.
+     *
+     * The fixed timestep is independent of the frame rate.  If the frame
+     * rate is higher, some frames will have no call to {@link #fixedUpdate}.
+     * If it is lower, some frames will have several.
+     *
+     * This method may be safely changed at any time while the application
+     * is running.
+     *
+     * By default, this value is 16667 (60 timesteps per second).
+     *
+     * @param step  The length of the fixed timestep in microseconds
+     */
+    void setFixedStep(Uint64 step);
+
+    /**
+     * Returns the length of the fixed timestep in microseconds.
+     *
+     * By default, this value is 16667 (60 timesteps per second).
+     *
+     * @return the length of the fixed timestep in microseconds.
+     */
+    Uint64 getFixedStep() const { return _fixedStep; }
+
+    /**
+     * Returns the time since the last fixed timestep in microseconds.
+     *
+     * This value is always less than {@link #getFixedStep}.  Divide it by
+     * the fixed timestep to get the fraction to interpolate the simulation
+     * state by in {@link #postUpdate}.
+     *
+     * @return the time since the last fixed timestep in microseconds.
+     */
+    Uint64 getFixedRemainder() const { return _fixedRemainder; }
+
+    /**
+     * Sets the maximum number of fixed timesteps in a single frame.
+     *
+     * If a frame takes too long, such as when the application is returning
+     * from the background, the time that does not fit in this many steps is
+     * discarded.  This keeps a slow simulation from falling further and
+     * further behind.
+     *
+     * This method may be safely changed at any time while the application
+     * is running.
+     *
+     * By default, this value is 5.
+     *
+     * @param steps The maximum number of fixed timesteps in a single frame
+     */
+    void setMaxFixedSteps(Uint32 steps) { _fixedLimit = (steps == 0 ? 1 : steps); }
+
+    /**
+     * Returns the maximum number of fixed timesteps in a single frame.
+     *
+     * See {@link #setMaxFixedSteps} for a description of this limit.
+     *
+     * By default, this value is 5.
+     *
+     * @return the maximum number of fixed timesteps in a single frame.
+     */
+    Uint32 getMaxFixedSteps() const { return _fixedLimit; }
     
     /**
      * Sets the clear color of this application
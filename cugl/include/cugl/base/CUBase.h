@@ -31,6 +31,7 @@
 
 #include <memory>
 #include <string>
+#include <cstring>
 #include <SDL/SDL.h>
 
 // The platforms
@@ -117,6 +118,13 @@
 	#include <GL/glu.h>	
 	/** The current OpenGL platform */
 	#define CU_GL_PLATFORM   CU_GL_OPENGL
+#elif defined (__LINUX__)
+    // Desktop Linux is only used to build the tools and tests
+    #define GL_GLEXT_PROTOTYPES 1
+    #include <GL/gl.h>
+    #include <GL/glext.h>
+    /** The current OpenGL platform */
+    #define CU_GL_PLATFORM   CU_GL_OPENGL
 #endif
 
 #ifdef _MSC_VER 
@@ -177,6 +177,8 @@ public:
     static Uint32 INIT_MULTISAMPLED;
     /** Whether this display should be centered (on windowed screens) */
     static Uint32 INIT_CENTERED;
+    /** Whether this display should have no window or OpenGL context */
+    static Uint32 INIT_HEADLESS;
     
 #pragma mark Values
 protected:
@@ -366,6 +368,18 @@ public:
      */
     void hide();
 
+    /**
+     * Returns true if this display is headless.
+     *
+     * A headless display has no window and no OpenGL context. All rendering
+     * classes are redirected to the {@link RenderRecorder}, which counts
+     * the commands that would have been sent to OpenGL. This is intended
+     * for running render tests on machines with no graphics card.
+     *
+     * @return true if this display is headless.
+     */
+    bool isHeadless() const;
+
 #pragma mark -
 #pragma mark Attributes
     /**
@@ -449,6 +463,17 @@ public:
      */
     Vec2 getPixelDensity() const { return _scale;    }
     
+    /**
+     * Returns the refresh rate of this display in hertz.
+     *
+     * This is the rate of the monitor showing the window, which may be
+     * higher than 60 on recent phones and gaming monitors.  The value is
+     * 0 if the rate is unknown, such as for a headless display.
+     *
+     * @return the refresh rate of this display in hertz.
+     */
+    int getRefreshRate() const;
+    
     /**
      * Returns true if this device has a landscape orientation
      *
@@ -683,6 +708,20 @@ public:
     void queryRenderTarget();
     
 private:
+    /**
+     * Initializes the display without a window or OpenGL context.
+     *
+     * The display bounds are set to the given bounds, with a pixel density
+     * of 1. The orientation is inferred from the aspect ratio of the bounds.
+     * No video subsystem is required.
+     *
+     * @param title     The window/display title
+     * @param bounds    The window/display bounds
+     *
+     * @return true if initialization was successful.
+     */
+    bool initHeadless(std::string title, Rect bounds);
+
     /**
      * Assign the default settings for OpenGL
      *
@@ -53,6 +53,7 @@
 #ifndef __CU_BINARY_READER_H__
 #define __CU_BINARY_READER_H__
 #include <cugl/base/CUBase.h>
+#include <cugl/io/CUMappedFile.h>
 #include <SDL/SDL.h>
 #include <string>
 
@@ -69,6 +70,13 @@ namespace cugl {
  * long, etc.  Those types are NOT cross-platform.  For example, a long is
  * 8 bytes on Unix/OS X, but 4 bytes on Win32 platforms.
  *
+ * By default, this reader reads the file in chunks through an SDL_RWops
+ * stream.  Alternatively, it can read directly from a {@link MappedFile}
+ * (see {@link initWithMapping}).  In that case there is no intermediate
+ * buffer, and {@link peek} exposes the remainder of the file as a single
+ * contiguous span.  Binary formats can use this to decode their data in
+ * place.
+ *
  * By default, this class (and every class in the io package) accesses the
  * application save directory {@see Application#getSaveDirectory()}.  If you
  * want to access another directory, you will need to specify an absolute path
@@ -95,6 +103,8 @@ protected:
     Uint32      _bufsize;
     /** The current offset in the read buffer */
     Sint32      _bufoff;
+    /** The file mapping (nullptr if this reader uses a stream) */
+    std::shared_ptr<MappedFile> _mapping;
     
 #pragma mark -
 #pragma mark Internal Methods
@@ -190,6 +200,18 @@ public:
      */
     bool initWithAsset(const std::string file, unsigned int capacity);
     
+    /**
+     * Initializes a reader for the given file mapping.
+     *
+     * The reader reads directly from the mapping, with no intermediate buffer.
+     * It retains a reference to the mapping until it is closed.
+     *
+     * @param mapping   the file mapping
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMapping(const std::shared_ptr<MappedFile>& mapping);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -268,6 +290,21 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
     
+    /**
+     * Returns a newly allocated reader for the given file mapping.
+     *
+     * The reader reads directly from the mapping, with no intermediate buffer.
+     * It retains a reference to the mapping until it is closed.
+     *
+     * @param mapping   the file mapping
+     *
+     * @return a newly allocated reader for the given file mapping.
+     */
+    static std::shared_ptr<BinaryReader> allocWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+        std::shared_ptr<BinaryReader> result = std::make_shared<BinaryReader>();
+        return (result->initWithMapping(mapping) ? result : nullptr);
+    }
+    
     
 #pragma mark -
 #pragma mark Stream Management
@@ -299,6 +336,40 @@ public:
      */
     bool ready(unsigned int bytes=1) const;
     
+    /**
+     * Returns true if this reader reads directly from a file mapping.
+     *
+     * @return true if this reader reads directly from a file mapping.
+     */
+    bool isMapped() const { return _mapping != nullptr; }
+    
+    /**
+     * Returns the unread bytes as a contiguous span.
+     *
+     * If this reader uses a file mapping, the span is the remainder of the
+     * file.  Otherwise, it is the unread portion of the read buffer, which
+     * is refilled to capacity first.  The span is only valid until the next
+     * read.  This method does not advance the read head; use {@link advance}
+     * for that.
+     *
+     * The bytes are not marshalled in any way.
+     *
+     * @param length    the number of bytes in the span
+     *
+     * @return the unread bytes as a contiguous span.
+     */
+    const Uint8* peek(size_t& length);
+    
+    /**
+     * Advances the read head by the given number of bytes.
+     *
+     * The number of bytes must not exceed the length of the last span
+     * returned by {@link peek}.
+     *
+     * @param length    the number of bytes to advance
+     */
+    void advance(size_t length);
+    
     
 #pragma mark -
 #pragma mark Single Element Reads
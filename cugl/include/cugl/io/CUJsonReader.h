@@ -60,6 +60,10 @@ namespace  cugl {
  * can read a JSON string embedded in a larger text file.  This allows for
  * maximum flexibility in encoding/decoding JSON data.
  *
+ * If this reader is initialized with a {@link MappedFile}, then {@link readJson}
+ * parses the JSON straight from the file mapping, without copying it into a
+ * string first.  This is the preferred way to read large JSON assets.
+ *
  * By default, this class (and every class in the io package) accesses the
  * application save directory {@see Application#getSaveDirectory()}.  If you
  * want to access another directory, you will need to specify an absolute path
@@ -68,6 +72,20 @@ namespace  cugl {
  * confine all files to either the asset or the save directory.
  */
 class JsonReader : public TextReader {
+protected:
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Returns the length of the JSON string at the read head
+     *
+     * The JSON string is the text up to (and including) the brace matching
+     * the one at the read head.  This method only searches the current span
+     * (see {@link peek}), so it is only reliable for file mappings.  It
+     * returns 0 if there is no matching brace in the span.
+     *
+     * @return the length of the JSON string at the read head
+     */
+    size_t match() const;
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -147,6 +165,23 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
     
+    /**
+     * Returns a newly allocated reader for the given file mapping.
+     *
+     * The reader reads directly from the mapping, with no intermediate buffer.
+     * It retains a reference to the mapping until it is closed.  Unlike the
+     * stream initializers, the file contents are read as-is.  In particular,
+     * Windows-style line feeds are not converted on any platform.
+     *
+     * @param mapping   the file mapping
+     *
+     * @return a newly allocated reader for the given file mapping.
+     */
+    static std::shared_ptr<JsonReader> allocWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+        std::shared_ptr<JsonReader> result = std::make_shared<JsonReader>();
+        return (result->initWithMapping(mapping) ? result : nullptr);
+    }
+    
     
 #pragma mark -
 #pragma mark Read Methods
@@ -169,7 +204,9 @@ public:
      * Returns a newly allocated JsonValue for the next available JSON string.
      * 
      * This method uses {@link readJsonString()} to extract the next available
-     * JSON string and constructs a JsonValue from that.
+     * JSON string and constructs a JsonValue from that.  If this reader uses
+     * a file mapping, the JsonValue is parsed directly from the mapping
+     * instead, and no string is constructed.
      *
      * If there is a parsing error, this  method will return nullptr.  Detailed
      * information about the parsing error will be passed to an assert.  Hence
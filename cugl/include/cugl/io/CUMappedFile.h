@@ -0,0 +1,245 @@
+//
+//  CUMappedFile.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides read-only access to the contents of a file as a
+//  single contiguous block of memory.  Whenever possible, the file is mapped
+//  into memory (with mmap or its Windows equivalent), so that the contents
+//  are paged in on demand and never copied.  If the file cannot be mapped,
+//  such as an asset packaged inside an Android APK, the contents are read
+//  through SDL_RWops in a single pass instead.
+//
+//  This allows readers and parsers to work directly on the file contents,
+//  rather than copying every byte through an intermediate buffer.  See
+//  the mapped modes of TextReader, JsonReader, and BinaryReader.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_MAPPED_FILE_H__
+#define __CU_MAPPED_FILE_H__
+#include <cugl/base/CUBase.h>
+#include <SDL/SDL.h>
+#include <string>
+#include <memory>
+
+namespace cugl {
+
+/**
+ * Read-only view of the contents of a file as contiguous memory.
+ *
+ * When possible, the file is memory mapped.  This means that the contents
+ * are paged in by the operating system as they are accessed, and that they
+ * do not count against the heap.  Reading from the mapping is zero-copy.
+ *
+ * If the file cannot be mapped, the contents are read into a heap buffer
+ * through SDL_RWops.  This is always the case for assets on Android, as
+ * they are packaged in the APK and are not files on the file system.  The
+ * interface is the same in either case; use {@link isMapped()} to tell the
+ * two apart.
+ *
+ * The contents are NOT null-terminated.  Always use {@link size()} to bound
+ * any access to {@link data()}.  The data is valid until this object is
+ * closed or deleted, so any reader working on the data should retain a
+ * reference to this object.
+ *
+ * By default, this class (and every class in the io package) accesses the
+ * application save directory {@see Application#getSaveDirectory()}.  If you
+ * want to access another directory, you will need to specify an absolute path
+ * for the file name.  Keep in mind that absolute paths are very dangerous on
+ * mobile devices, because they do not have proper file systems.  You should
+ * confine all files to either the asset or the save directory.
+ */
+class MappedFile {
+protected:
+    /** The (full) path for the file */
+    std::string _name;
+    /** The file contents */
+    const char* _data;
+    /** The size of the file contents in bytes */
+    size_t _size;
+    /** The heap copy of the contents, if the file could not be mapped */
+    char* _buffer;
+
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Returns true if the file could be memory mapped.
+     *
+     * This method does not print any errors, as the caller is expected to
+     * fall back to {@link read()} on failure.
+     *
+     * @return true if the file could be memory mapped.
+     */
+    bool map();
+
+    /**
+     * Returns true if the file could be read through SDL_RWops.
+     *
+     * This method is the fallback for files that cannot be memory mapped.
+     * It reads the file in a single pass into a heap buffer of exactly
+     * the file size.
+     *
+     * @return true if the file could be read through SDL_RWops.
+     */
+    bool read();
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a mapped file with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    MappedFile() : _name(""), _data(nullptr), _size(0), _buffer(nullptr) {}
+
+    /**
+     * Deletes this mapped file and all of its resources.
+     *
+     * Calls to the destructor will close the file if it is not already closed.
+     */
+    ~MappedFile() { close(); }
+
+    /**
+     * Initializes a view of the given file.
+     *
+     * If the file is a relative path, this object will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool init(const std::string file);
+
+    /**
+     * Initializes a view of the given asset file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return true if the file is initialized properly, false otherwise.
+     */
+    bool initWithAsset(const std::string file);
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated view of the given file.
+     *
+     * If the file is a relative path, this object will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated view of the given file.
+     */
+    static std::shared_ptr<MappedFile> alloc(const std::string file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated view of the given asset file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated view of the given asset file.
+     */
+    static std::shared_ptr<MappedFile> allocWithAsset(const std::string file) {
+        std::shared_ptr<MappedFile> result = std::make_shared<MappedFile>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Accessors
+    /**
+     * Releases the file contents.
+     *
+     * Any pointers previously returned by {@link data()} are invalid after
+     * this method is called.  Calling this method on a previously closed
+     * file has no effect.
+     */
+    void close();
+
+    /**
+     * Returns the (full) path of this file.
+     *
+     * @return the (full) path of this file.
+     */
+    const std::string& getName() const { return _name; }
+
+    /**
+     * Returns the contents of this file.
+     *
+     * The contents are not null-terminated.  Use {@link size()} to bound
+     * all access.  This value is nullptr if the file is closed.
+     *
+     * @return the contents of this file.
+     */
+    const char* data() const { return _data; }
+
+    /**
+     * Returns the size of this file in bytes.
+     *
+     * @return the size of this file in bytes.
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * Returns true if the contents are memory mapped.
+     *
+     * If this value is false, the contents were read into a heap buffer
+     * instead.  This is the case for empty files, as well as any file that
+     * the platform cannot map.
+     *
+     * @return true if the contents are memory mapped.
+     */
+    bool isMapped() const { return _data != nullptr && _buffer == nullptr && _size > 0; }
+
+};
+
+}
+#endif /* __CU_MAPPED_FILE_H__ */
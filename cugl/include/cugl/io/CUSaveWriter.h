@@ -0,0 +1,260 @@
+//
+//  CUSaveWriter.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an asynchronous writer for save files.  The contents
+//  of the file are captured on the calling thread, and are written on a
+//  background thread.  Each write goes to a temporary file that is synced to
+//  storage and then renamed over the original, so the save file is never
+//  left half-written.  If the file is saved several times before the worker
+//  gets to it, only the most recent contents are written.
+//
+//  This is the writer to use for any state saved when the application is
+//  suspended.  Mobile platforms give the application very little time to
+//  suspend, and a slow write on the main thread can get it killed.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_SAVE_WRITER_H__
+#define __CU_SAVE_WRITER_H__
+#include <cugl/assets/CUJsonValue.h>
+#include <cugl/util/CUThreadPool.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+namespace cugl {
+
+/**
+ * Asynchronous, atomic writer for a single save file.
+ *
+ * Calls to {@link #save} capture the file contents immediately and return
+ * without touching the file system.  A background thread writes the contents
+ * to a temporary file beside the save file, syncs it to storage, and renames
+ * it over the save file.  Hence the save file always holds either the old or
+ * the new contents, even if the application is killed mid-write.
+ *
+ * Saves are coalesced.  If the file is saved again while an earlier save is
+ * still waiting, the earlier contents are discarded, and only the most
+ * recent contents are written.  So it is safe to save on every change.
+ *
+ * Use {@link #flush(Uint32)} to wait for the pending save, such as when the
+ * application is suspended.  The wait is bounded, so the application never
+ * misses a platform deadline because of slow storage.
+ *
+ * By default, this class (and every class in the io package) accesses the
+ * application save directory {@see Application#getSaveDirectory()}.  If you
+ * want to access another directory, you will need to specify an absolute path
+ * for the file name.  Keep in mind that absolute paths are very dangerous on
+ * mobile devices, because they do not have proper file systems.  You should
+ * confine all files to either the asset or the save directory.
+ */
+class SaveWriter {
+protected:
+    /** The (full) path for the file */
+    std::string _name;
+    /** The worker thread for writing the file */
+    std::shared_ptr<ThreadPool> _worker;
+
+    /** The mutex guarding the save state */
+    std::mutex _mutex;
+    /** The condition signalled when the worker goes idle */
+    std::condition_variable _idle;
+    /** The most recent contents not yet picked up by the worker */
+    std::string _contents;
+    /** Whether there are contents not yet picked up by the worker */
+    bool _dirty;
+    /** Whether the worker has a save queued or in progress */
+    bool _busy;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates a save writer with no assigned file.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    SaveWriter() : _name(""), _dirty(false), _busy(false) {}
+
+    /**
+     * Deletes this writer and all of its resources.
+     *
+     * This destructor blocks until any pending save is written.
+     */
+    ~SaveWriter() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this writer.
+     *
+     * This method blocks until any pending save is written. A disposed
+     * writer can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes a writer for the given file.
+     *
+     * This method does not open or create the file.  The file is not
+     * touched until the first save.
+     *
+     * If the file is a relative path, this writer will place the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return true if the writer is initialized properly, false otherwise.
+     */
+    bool init(const std::string file);
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated writer for the given file.
+     *
+     * This method does not open or create the file.  The file is not
+     * touched until the first save.
+     *
+     * If the file is a relative path, this writer will place the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to write a file in any other directory, you must provide
+     * an absolute path. Be warned, however, that write priviledges are
+     * heavily restricted on mobile platforms.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated writer for the given file.
+     */
+    static std::shared_ptr<SaveWriter> alloc(const std::string file) {
+        std::shared_ptr<SaveWriter> result = std::make_shared<SaveWriter>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Save Methods
+    /**
+     * Saves the given JSON value to the file.
+     *
+     * The JSON value is converted to a string immediately, so it is safe to
+     * modify it as soon as this method returns.  The string is written on
+     * the background thread, replacing any earlier save not yet written.
+     *
+     * The JSON may either be pretty-printed or condensed depending on the
+     * value of format.  By default, we pretty-print all JSON strings.
+     *
+     * @param json      The JSON value to save
+     * @param format    Whether to pretty-print the JSON string
+     */
+    void save(const std::shared_ptr<JsonValue>& json, bool format=true);
+
+    /**
+     * Saves the given string to the file.
+     *
+     * The string is written on the background thread, replacing any earlier
+     * save not yet written.  The file will contain exactly this string.
+     *
+     * @param contents  The file contents
+     */
+    void save(const std::string& contents);
+
+    /**
+     * Returns true if there is a save not yet written to the file.
+     *
+     * @return true if there is a save not yet written to the file.
+     */
+    bool isPending();
+
+    /**
+     * Blocks until every save has been written to the file.
+     *
+     * This method has no time limit.  Use {@link #flush(Uint32)} when there
+     * is a platform deadline, such as when the application is suspended.
+     */
+    void flush();
+
+    /**
+     * Returns true if every save has been written to the file.
+     *
+     * This method blocks until the pending save is written, or until the
+     * given number of milliseconds has passed.  If it times out, the save
+     * continues on the background thread.
+     *
+     * @param millis    The maximum time to wait in milliseconds
+     *
+     * @return true if every save has been written to the file.
+     */
+    bool flush(Uint32 millis);
+
+    /**
+     * Returns the path to the save file.
+     *
+     * @return the path to the save file.
+     */
+    const std::string getFile() const { return _name; }
+
+#pragma mark -
+#pragma mark Internal Helpers
+private:
+    /**
+     * Writes the pending contents until there are none left.
+     *
+     * This method is executed on the worker thread.
+     */
+    void drain();
+
+    /**
+     * Returns true if the contents were atomically written to the file.
+     *
+     * This method writes the contents to a temporary file, syncs it to
+     * storage, and renames it over the save file.  On POSIX platforms, it
+     * then syncs the parent directory, as the rename is not durable until
+     * the directory entry is on storage.  It is executed on the worker thread.
+     *
+     * @param contents  The file contents
+     *
+     * @return true if the contents were atomically written to the file.
+     */
+    bool commit(const std::string& contents);
+};
+
+}
+
+#endif /* __CU_SAVE_WRITER_H__ */
@@ -49,6 +49,7 @@
 #ifndef __CU_TEXT_READER_H__
 #define __CU_TEXT_READER_H__
 #include <cugl/base/CUBase.h>
+#include <cugl/io/CUMappedFile.h>
 #include <SDL/SDL.h>
 #include <string>
 
@@ -64,6 +65,12 @@ namespace  cugl {
  * It supports both ASCII and UTF8 encoding. No other encodings are supported
  * (nor should they be since they are not cross-platform).
  *
+ * By default, this reader reads the file in chunks through an SDL_RWops
+ * stream.  Alternatively, it can read directly from a {@link MappedFile}
+ * (see {@link initWithMapping}).  In that case there is no intermediate
+ * buffer, and {@link peek} exposes the remainder of the file as a single
+ * contiguous span.
+ *
  * By default, this class (and every class in the io package) accesses the
  * application save directory {@see Application#getSaveDirectory()}.  If you
  * want to access another directory, you will need to specify an absolute path 
@@ -91,6 +98,13 @@ protected:
     /** The current offset in the read buffer */
     Sint32      _bufoff;
 
+    /** The file mapping (nullptr if this reader uses a stream) */
+    std::shared_ptr<MappedFile> _mapping;
+    /** The characters available to read (the read buffer or the mapping) */
+    const char* _window;
+    /** The number of characters in the window */
+    Uint32      _winsize;
+
 #pragma mark -
 #pragma mark Internal Methods
     /**
@@ -111,7 +125,8 @@ public:
      * the heap, use one of the static constructors instead.
      */
     TextReader() : _name(""), _stream(nullptr), _ssize(-1), _scursor(-1),
-                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1) {}
+                   _sbuffer(""), _cbuffer(nullptr), _capacity(0), _bufoff(-1),
+                   _window(nullptr), _winsize(0) {}
     
     /**
      * Deletes this reader and all of its resources.
@@ -183,6 +198,20 @@ public:
      */
     bool initWithAsset(const std::string file, unsigned int capacity);
     
+    /**
+     * Initializes a reader for the given file mapping.
+     *
+     * The reader reads directly from the mapping, with no intermediate buffer.
+     * It retains a reference to the mapping until it is closed.  Unlike the
+     * stream initializers, the file contents are read as-is.  In particular,
+     * Windows-style line feeds are not converted on any platform.
+     *
+     * @param mapping   the file mapping
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithMapping(const std::shared_ptr<MappedFile>& mapping);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -261,6 +290,23 @@ public:
         return (result->initWithAsset(file,capacity) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated reader for the given file mapping.
+     *
+     * The reader reads directly from the mapping, with no intermediate buffer.
+     * It retains a reference to the mapping until it is closed.  Unlike the
+     * stream initializers, the file contents are read as-is.  In particular,
+     * Windows-style line feeds are not converted on any platform.
+     *
+     * @param mapping   the file mapping
+     *
+     * @return a newly allocated reader for the given file mapping.
+     */
+    static std::shared_ptr<TextReader> allocWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+        std::shared_ptr<TextReader> result = std::make_shared<TextReader>();
+        return (result->initWithMapping(mapping) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Stream Management
@@ -287,7 +333,39 @@ public:
      *
      * @return true if there is still data to read
      */
-    bool ready() const { return _bufoff < _sbuffer.size() || _scursor < _ssize; }
+    bool ready() const { return (Uint32)_bufoff < _winsize || _scursor < _ssize; }
+    
+    /**
+     * Returns true if this reader reads directly from a file mapping.
+     *
+     * @return true if this reader reads directly from a file mapping.
+     */
+    bool isMapped() const { return _mapping != nullptr; }
+    
+    /**
+     * Returns the unread characters as a contiguous span.
+     *
+     * If this reader uses a file mapping, the span is the remainder of the
+     * file.  Otherwise, it is the unread portion of the read buffer, which
+     * is refilled first if it is empty.  The span is not null-terminated and
+     * is only valid until the next read.  This method does not advance the
+     * read head; use {@link advance} for that.
+     *
+     * @param length    the number of characters in the span
+     *
+     * @return the unread characters as a contiguous span.
+     */
+    const char* peek(size_t& length);
+    
+    /**
+     * Advances the read head by the given number of characters.
+     *
+     * The number of characters must not exceed the length of the last span
+     * returned by {@link peek}.
+     *
+     * @param length    the number of characters to advance
+     */
+    void advance(size_t length);
     
     
 #pragma mark -
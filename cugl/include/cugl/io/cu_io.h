@@ -28,10 +28,12 @@
 #ifndef __CU_IO_PKG_H__
 #define __CU_IO_PKG_H__
 
+#include "CUMappedFile.h"
 #include "CUTextReader.h"
 #include "CUTextWriter.h"
 #include "CUJsonReader.h"
 #include "CUJsonWriter.h"
+#include "CUSaveWriter.h"
 #include "CUBinaryReader.h"
 #include "CUBinaryWriter.h"
 
@@ -1056,6 +1056,30 @@ public:
      */
     static float* transform(const Affine2& aff, float const* input, float* output, size_t size);
 
+    /**
+     * Transforms the point array, and stores the result in output.
+     *
+     * The stride is the distance in bytes between consecutive points, and it
+     * is shared by both arrays. This allows the method to transform the
+     * positions of an interleaved vertex array (such as {@link SpriteVertex3})
+     * in place. The default stride is a tightly packed array of {@link Vec2}.
+     * The input and output may be the same array, but they may not otherwise
+     * overlap.
+     *
+     * This method is vectorized when SSE or NEON support is available, and
+     * is much faster than transforming each point individually.
+     *
+     * @param aff       The transform matrix.
+     * @param input     The array of points to transform.
+     * @param output    The array to store the transformed points.
+     * @param size      The number of points to transform.
+     * @param stride    The distance in bytes between consecutive points.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec2* transform(const Affine2& aff, Vec2 const* input, Vec2* output, size_t size,
+                           size_t stride=sizeof(Vec2));
+
     /**
      * Transforms the rectangle and stores the result in dst.
      *
@@ -1639,6 +1639,34 @@ public:
      */
     static float* transform(const float* mat, float const* input, float* output, size_t size);
 
+    /**
+     * Transforms the point array by the given matrix, and stores the result in output.
+     *
+     * Each element is treated as a point, which means that translation is
+     * applied to the result (as with {@link #transform(const Mat4&, const Vec3, Vec3*)}).
+     * The homogenous component is not divided out.
+     *
+     * The stride is the distance in bytes between consecutive points, and it
+     * is shared by both arrays. This allows the method to transform the
+     * positions of an interleaved vertex array (such as {@link SpriteVertex3})
+     * in place. The default stride is a tightly packed array of {@link Vec3}.
+     * The input and output may be the same array, but they may not otherwise
+     * overlap.
+     *
+     * This method is vectorized when SSE or NEON support is available, and
+     * is much faster than transforming each point individually.
+     *
+     * @param mat       The transform matrix.
+     * @param input     The array of points to transform.
+     * @param output    The array to store the transformed points.
+     * @param size      The number of points to transform.
+     * @param stride    The distance in bytes between consecutive points.
+     *
+     * @return A reference to output for chaining
+     */
+    static Vec3* transform(const Mat4& mat, Vec3 const* input, Vec3* output, size_t size,
+                           size_t stride=sizeof(Vec3));
+
 
 #pragma mark -
 #pragma mark Vector Operations
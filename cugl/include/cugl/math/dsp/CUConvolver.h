@@ -0,0 +1,358 @@
+//
+//  CUConvolver.h
+//  Cornell University Game Library (CUGL)
+//
+//  This class is represents a uniformly partitioned FFT convolution. It
+//  computes the same result as a FIR filter, but it is designed for very
+//  long impulse responses (reverbs, room tones, long EQ curves).  A direct
+//  form FIR filter costs O(taps) per sample.  This class only computes the
+//  first partition of the impulse response directly.  The remaining taps
+//  are applied as products in the frequency domain, so the cost per sample
+//  grows much more slowly than the number of taps.
+//
+//  The first partition also hides the latency of the block FFT.  Hence the
+//  output is not delayed, and this class can be used as a drop-in
+//  replacement for the direct form. Indeed, FIRFilter switches to this
+//  class automatically for long filters.
+//
+//  This class supports vector optimizations for SSE and Neon 64 in the
+//  frequency domain multiplication, which is the bulk of the work.
+//
+//  This class is NOT THREAD SAFE.  This is by design, for performance reasons.
+//  External locking may be required when the filter is shared between multiple
+//  threads (such as between an audio thread and the main thread).
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_CONVOLVER_H__
+#define __CU_CONVOLVER_H__
+
+#include <cugl/math/CUMathBase.h>
+#include <cugl/util/CUAligned.h>
+#include <vector>
+#include <memory>
+
+namespace cugl {
+    namespace dsp {
+
+/**
+ * This class implements a uniformly partitioned FFT convolution.
+ *
+ * This class computes the standard difference equation of a FIR filter:
+ *
+ *      y[n] = h[0]*x[n] + ... + h[N-1]*x[n-N+1]
+ *
+ * where h is the impulse response, y is the output and x in the input.
+ *
+ * The impulse response is split into partitions of B taps, where B is the
+ * block size.  The first partition is applied directly, exactly like
+ * {@link FIRFilter}, when B is small.  Otherwise it is applied by another
+ * convolution with a quarter of the block size. Hence large blocks do not
+ * make the direct work expensive.  Each remaining partition is transformed once (when
+ * the impulse response is set) into a spectrum of B+1 bins. Every B frames
+ * the latest two blocks of input are transformed as well, and the output
+ * of all remaining partitions is the inverse transform of a sum of spectral
+ * products.  This is the overlap-save method.
+ *
+ * The spectral products for a block are only needed B frames later, as the
+ * first partition covers the most recent B frames of input.  Hence this
+ * class has no latency, and the output is identical (up to rounding) to
+ * that of the direct form.  The input does not need to be a multiple of B
+ * in size.
+ *
+ * The block size balances the two halves of the work.  The first partition
+ * costs O(log B) per frame, while the spectral products cost O(N/B) per frame.
+ * By default the block size grows with the square root of N, up to a limit
+ * that keeps the work of a single block small enough for an audio callback.
+ *
+ * The same impulse response is applied to every channel. The channels are
+ * filtered independently.
+ *
+ * This class is not thread safe.  External locking may be required when
+ * the filter is shared between multiple threads (such as between an audio
+ * thread and the main thread).
+ */
+class Convolver {
+private:
+    /** The number of channels to support */
+    unsigned _channels;
+    /** The impulse response, in the order given */
+    std::vector<float> _impulse;
+    /** The partition (block) size; this is a power of two */
+    size_t _block;
+    /** The number of partitions after the first one */
+    size_t _parts;
+    /** The stride of a spectrum array (the B+1 bins, rounded to a multiple of 4) */
+    size_t _stride;
+
+    /** The first partition of the impulse response, reversed */
+    cugl::Aligned<float> _head;
+    /** The convolution of the first partition, if it is too long for the direct form */
+    std::unique_ptr<Convolver> _child;
+    /** The spectra of the remaining partitions (real then imaginary) */
+    cugl::Aligned<float> _spectra;
+
+    /** The cosine table of the complex FFT of size B */
+    cugl::Aligned<float> _cosines;
+    /** The sine table of the complex FFT of size B */
+    cugl::Aligned<float> _sines;
+    /** The cosine table to split a complex FFT into a real FFT of size 2B */
+    cugl::Aligned<float> _rcosines;
+    /** The sine table to split a complex FFT into a real FFT of size 2B */
+    cugl::Aligned<float> _rsines;
+    /** The bit reversal permutation of the complex FFT of size B */
+    std::vector<Uint32> _reverse;
+
+    /** The last two blocks of input for each channel */
+    cugl::Aligned<float> _inputs;
+    /** The spectra of recent input blocks for each channel (a ring buffer) */
+    cugl::Aligned<float> _history;
+    /** The output of the remaining partitions for the current block */
+    cugl::Aligned<float> _tails;
+    /** The scratch space for the transforms */
+    cugl::Aligned<float> _scratch;
+    /** The position in the current block */
+    size_t _cursor;
+    /** The ring buffer position of the most recent input spectrum */
+    size_t _slot;
+
+    /**
+     * Resets the caching data structures for this filter
+     *
+     * This must be called if the number of channels or the impulse change.
+     */
+    void reset();
+
+    /**
+     * Performs an in-place complex FFT of size B on split arrays.
+     *
+     * This is the forward transform.  The inverse transform (without the
+     * 1/B scale) is obtained by swapping the real and imaginary arrays.
+     *
+     * @param real  The real components
+     * @param imag  The imaginary components
+     */
+    void transform(float* real, float* imag) const;
+
+    /**
+     * Computes the spectrum of 2B real samples.
+     *
+     * The spectrum has B+1 bins, as the rest are determined by symmetry.
+     *
+     * @param input     The 2B real samples
+     * @param real      The real components of the spectrum
+     * @param imag      The imaginary components of the spectrum
+     */
+    void forward(const float* input, float* real, float* imag);
+
+    /**
+     * Computes the 2B real samples for the given spectrum.
+     *
+     * The spectrum has B+1 bins. The result is not scaled by 1/B, as that
+     * factor is applied to the partition spectra instead.
+     *
+     * @param real      The real components of the spectrum
+     * @param imag      The imaginary components of the spectrum
+     * @param output    The array to store the 2B real samples
+     */
+    void inverse(const float* real, const float* imag, float* output);
+
+    /**
+     * Processes a completed block of input for the given channel.
+     *
+     * This method computes the output of the remaining partitions for the
+     * next B frames.
+     *
+     * @param channel   The channel to process
+     */
+    void process(unsigned channel);
+
+public:
+    /** Whether to use a vectorization algorithm (Default is true) */
+    static bool VECTORIZE;
+
+#pragma mark Constructors
+    /**
+     * Creates a pass-through convolution for a single channel.
+     */
+    Convolver();
+
+    /**
+     * Creates a pass-through convolution for the given number of channels.
+     *
+     * @param channels  The number of channels
+     */
+    Convolver(unsigned channels);
+
+    /**
+     * Creates a convolution with the given impulse response.
+     *
+     * If the block size is 0, it is chosen from the length of the impulse
+     * with {@link getDefaultBlock}.  Otherwise it is rounded up to a power
+     * of two.
+     *
+     * @param channels  The number of channels
+     * @param impulse   The impulse response
+     * @param block     The partition size
+     */
+    Convolver(unsigned channels, const std::vector<float>& impulse, size_t block=0);
+
+    /**
+     * Creates a copy of the given filter.
+     *
+     * The copy has the same impulse response, but its data buffers are
+     * cleared.
+     *
+     * @param copy  The filter to copy
+     */
+    Convolver(const Convolver& copy);
+
+    /**
+     * Creates a filter with the resources of the original.
+     *
+     * @param filter    The filter to acquire
+     */
+    Convolver(Convolver&& filter) = default;
+
+    /**
+     * Destroys the filter, releasing all resources.
+     */
+    ~Convolver() {}
+
+    /**
+     * Returns the default block size for an impulse response of the given length.
+     *
+     * This value balances the direct and spectral halves of the work.
+     *
+     * @param length    The number of taps in the impulse response
+     *
+     * @return the default block size for an impulse response of the given length.
+     */
+    static size_t getDefaultBlock(size_t length);
+
+#pragma mark Attributes
+    /**
+     * Returns the number of channels for this filter
+     *
+     * The data buffers depend on the number of channels.  Changing this value
+     * will reset the data buffers to 0.
+     *
+     * @return the number of channels for this filter
+     */
+    unsigned getChannels() const { return _channels; }
+
+    /**
+     * Sets the number of channels for this filter
+     *
+     * The data buffers depend on the number of channels.  Changing this value
+     * will reset the data buffers to 0.
+     *
+     * @param channels  The number of channels for this filter
+     */
+    void setChannels(unsigned channels);
+
+    /**
+     * Returns the impulse response of this filter.
+     *
+     * @return the impulse response of this filter.
+     */
+    const std::vector<float>& getImpulse() const { return _impulse; }
+
+    /**
+     * Sets the impulse response of this filter.
+     *
+     * If the block size is 0, it is chosen from the length of the impulse
+     * with {@link getDefaultBlock}.  Otherwise it is rounded up to a power
+     * of two.  This method resets the data buffers to 0.
+     *
+     * @param impulse   The impulse response
+     * @param block     The partition size
+     */
+    void setImpulse(const std::vector<float>& impulse, size_t block=0);
+
+    /**
+     * Returns the number of taps in the impulse response.
+     *
+     * @return the number of taps in the impulse response.
+     */
+    size_t getLength() const { return _impulse.size(); }
+
+    /**
+     * Returns the partition (block) size of this filter.
+     *
+     * @return the partition (block) size of this filter.
+     */
+    size_t getBlockSize() const { return _block; }
+
+#pragma mark Filter Methods
+    /**
+     * Performs a filter of single frame of data.
+     *
+     * The output is written to the given output array, which should be the
+     * same size as the input array. The size should be the number of channels.
+     * The gain parameter is applied at the filter input, but does not affect
+     * the filter coefficients.
+     *
+     * @param gain      The input gain factor
+     * @param input     The input frame
+     * @param output    The frame to receive the output
+     */
+    void step(float gain, const float* input, float* output);
+
+    /**
+     * Performs a filter of interleaved input data.
+     *
+     * The output is written to the given output array, which should be the
+     * same size as the input array. The size is the number of frames, not
+     * samples.  Hence the arrays must be size times the number of channels
+     * in size.  The input and output may be the same array.
+     *
+     * There is no delay in the output.  The gain parameter is applied at the
+     * filter input, but does not affect the filter coefficients.
+     *
+     * @param gain      The input gain factor
+     * @param input     The array of input samples
+     * @param output    The array to write the sample output
+     * @param size      The input size in frames
+     */
+    void calculate(float gain, const float* input, float* output, size_t size);
+
+    /**
+     * Clears the filter buffer of any cached inputs
+     */
+    void clear();
+
+    /**
+     * Flushes any delayed outputs to the provided array.
+     *
+     * As this filter has no delayed terms, this method will write nothing. It
+     * is only here to standardize the filter signature.
+     *
+     * This method will also clear the buffer.
+     *
+     * @return The number of frames (not samples) written
+     */
+    size_t flush(float* output);
+};
+    }
+}
+#endif /* __CU_CONVOLVER_H__ */
@@ -125,6 +125,61 @@ public:
      */
     static size_t scale_add(float* input1, float* input2, float scalar, float* output, size_t size);
     
+    /**
+     * Returns the dot product of two input signals
+     *
+     * This is the inner loop of an FIR filter, such as the polyphase filter
+     * in {@link audio::AudioResampler}.
+     *
+     * @param input1    The first input buffer
+     * @param input2    The second input buffer
+     * @param size      The number of elements to multiply
+     *
+     * @return the dot product of two input signals
+     */
+    static float dot(const float* input1, const float* input2, size_t size);
+
+#pragma mark Conversion Methods
+    /**
+     * Converts a 16-bit integer signal to float, storing the result in output
+     *
+     * Each element is multiplied by the scalar after conversion. A scalar of
+     * 1/32768 converts 16-bit PCM data to the range [-1,1].
+     *
+     * The input and output buffers may not overlap.
+     *
+     * @param input     The input buffer
+     * @param scalar    The scalar to mutliply by
+     * @param output    The output buffer
+     * @param size      The number of elements to convert
+     *
+     * @return the number of elements successfully converted
+     */
+    static size_t convert(const Sint16* input, float scalar, float* output, size_t size);
+
+#pragma mark Panning Methods
+    /**
+     * Maps an interleaved signal onto a new set of channels, storing the result in output
+     *
+     * The matrix has field x channels elements. The value at position
+     * `i*channels+j` is the gain of input channel i in output channel j.
+     * The output has channels * frames elements, and is overwritten.
+     *
+     * The common cases of mono to stereo and stereo to stereo are vectorized.
+     * The input and output buffers may not overlap.
+     *
+     * @param input     The input buffer
+     * @param field     The number of input channels
+     * @param matrix    The channel gain matrix
+     * @param channels  The number of output channels
+     * @param output    The output buffer
+     * @param frames    The number of frames to map
+     *
+     * @return the number of frames successfully mapped
+     */
+    static size_t pan(const float* input, Uint32 field, const float* matrix,
+                      Uint32 channels, float* output, size_t frames);
+
 #pragma mark Fade-In/Out Methods
     /**
      * Scales an input signal, storing the result in output
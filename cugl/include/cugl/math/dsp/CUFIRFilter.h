@@ -50,10 +50,12 @@
 #define __CU_FIR_FILTER_H__
 
 #include <cugl/math/dsp/CUIIRFilter.h>
+#include <cugl/math/dsp/CUConvolver.h>
 #include <cugl/math/CUMathBase.h>
 #include <cugl/util/CUAligned.h>
 #include <cstring>
 #include <vector>
+#include <memory>
 
 namespace cugl {
     namespace dsp {
@@ -80,6 +82,12 @@ namespace cugl {
  * limited to 128-bit words as 256-bit (e.g. AVX) and higher show no significant
  * increase in performance.
  *
+ * The direct form costs O(nb) per frame, which is too expensive for long
+ * impulse responses (reverbs, long EQ curves).  When the number of 
+ * coefficients exceeds {@link FFT_THRESHOLD}, this class delegates to a
+ * {@link Convolver} instead. That class computes the same output (up to 
+ * rounding) with a partitioned FFT convolution.
+ *
  * For performance reasons, this class does not have a (virtualized) subclass
  * relationship with other IIR or FIR filters.  However, the signature of the
  * the calculation and coefficient methods has been standardized so that it
@@ -100,6 +108,8 @@ private:
     cugl::Aligned<float> _bval;
     /** The previously recieved input matching the upper coefficients */
     cugl::Aligned<float> _inns;
+    /** The FFT convolution for long filters (nullptr if using the direct form) */
+    std::unique_ptr<Convolver> _convolver;
     
     /**
      * Resets the caching data structures for this filter
@@ -270,6 +280,8 @@ private:
 public:
     /** Whether to use a vectorization algorithm (Access not thread safe) */
     static bool VECTORIZE;
+    /** The number of coefficients after which to use an FFT convolution (Access not thread safe) */
+    static size_t FFT_THRESHOLD;
 
 #pragma mark Constructors
     /**
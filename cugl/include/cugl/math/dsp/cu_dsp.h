@@ -30,6 +30,7 @@
 
 #include "CUDSPMath.h"
 #include "CUFIRFilter.h"
+#include "CUConvolver.h"
 #include "CUIIRFilter.h"
 #include "CUOneZeroFIR.h"
 #include "CUTwoZeroFIR.h"
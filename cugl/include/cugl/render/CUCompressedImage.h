@@ -0,0 +1,366 @@
+//
+//  CUCompressedImage.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for GPU-compressed texture data stored in
+//  KTX (version 1.1) containers.  Compressed textures are uploaded to the
+//  GPU as-is, so they require no decoding at load time and use a fraction
+//  of the video memory of an RGBA texture.
+//
+//  This module can also encode RGBA images as ETC2, which is supported by
+//  every OpenGLES 3 device.  This encoder is meant for offline use (see the
+//  texture cooker in the tools directory), as it is far too slow to run when
+//  loading assets.  The KTX reader accepts ASTC data as well, but ASTC data
+//  must be produced by an external encoder.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_COMPRESSED_IMAGE_H__
+#define __CU_COMPRESSED_IMAGE_H__
+#include <cugl/math/CUMathBase.h>
+#include <cugl/io/CUMappedFile.h>
+#include <vector>
+
+namespace cugl {
+
+/**
+ * This class represents GPU-compressed image data with an optional mip chain.
+ *
+ * A compressed image is read from (or saved to) a KTX file.  The data for
+ * each mipmap level is stored exactly as it is uploaded to the GPU.  When
+ * the image is read from a file, the file is memory mapped, so the data
+ * is never copied before it is uploaded.  See {@link Texture#initWithImage}.
+ *
+ * A compressed image may also be created from RGBA pixels, in which case
+ * the pixels are encoded as ETC2.  The encoder emits the individual,
+ * differential and planar block modes, and EAC for the alpha channel.
+ * Images of any size are supported, as partial blocks are padded by
+ * repeating the edge pixels.
+ *
+ * This class does not use OpenGL, with the exception of the method
+ * {@link isSupported}.  Hence it is safe to create compressed images
+ * outside of the main thread.
+ */
+class CompressedImage {
+#pragma mark Values
+public:
+    /**
+     * This enum lists the supported compression formats.
+     *
+     * The values are the OpenGL internal formats.  The ETC2 formats may be
+     * both encoded and decoded by this class.  The ASTC formats may only
+     * be read from and written to a KTX file.
+     */
+    enum class Format : GLenum {
+        /** Unknown or unsupported compression format */
+        UNKNOWN = 0,
+        /** ETC2 RGB with no alpha (4 bits per pixel) */
+        ETC2_RGB  = 0x9274,
+        /** ETC2 RGB with EAC alpha (8 bits per pixel) */
+        ETC2_RGBA = 0x9278,
+        /** ASTC with 4x4 blocks (8 bits per pixel) */
+        ASTC_4x4 = 0x93B0,
+        /** ASTC with 5x5 blocks (5.12 bits per pixel) */
+        ASTC_5x5 = 0x93B2,
+        /** ASTC with 6x6 blocks (3.56 bits per pixel) */
+        ASTC_6x6 = 0x93B4,
+        /** ASTC with 8x8 blocks (2 bits per pixel) */
+        ASTC_8x8 = 0x93B7
+    };
+
+protected:
+    /** The compression format */
+    Format _format;
+    /** The width of the base level in pixels */
+    Uint32 _width;
+    /** The height of the base level in pixels */
+    Uint32 _height;
+    /** The memory mapped KTX file, if read from a file */
+    std::shared_ptr<MappedFile> _mapping;
+    /** The image data, if encoded in memory */
+    std::vector<Uint8> _storage;
+    /** The start of the image data (either in the mapping or the storage) */
+    const Uint8* _data;
+    /** The offset and size of each mipmap level in the data */
+    std::vector<std::pair<size_t,size_t>> _levels;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an empty compressed image.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    CompressedImage() : _format(Format::UNKNOWN), _width(0), _height(0), _data(nullptr) {}
+
+    /**
+     * Deletes this compressed image, disposing all resources
+     */
+    ~CompressedImage() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this image.
+     *
+     * A disposed image can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes a compressed image from the given KTX file.
+     *
+     * The KTX file must contain a single 2D image (no arrays or cube maps)
+     * in one of the formats of {@link Format}.  The file is memory mapped,
+     * and the image data is not copied.
+     *
+     * @param file  The path to the KTX file
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithFile(const std::string file);
+
+    /**
+     * Initializes a compressed image from the given KTX file contents.
+     *
+     * The KTX file must contain a single 2D image (no arrays or cube maps)
+     * in one of the formats of {@link Format}.  The image data is not copied,
+     * and this image retains a reference to the mapping.
+     *
+     * @param mapping   The contents of a KTX file
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithMapping(const std::shared_ptr<MappedFile>& mapping);
+
+    /**
+     * Initializes a compressed image by encoding the given RGBA pixels.
+     *
+     * The pixels must be stored row by row, with four bytes per pixel in
+     * the order red, green, blue, and alpha.  The format must be either
+     * {@link Format#ETC2_RGB} or {@link Format#ETC2_RGBA}.  If the format
+     * is ETC2_RGB, the alpha channel is ignored.
+     *
+     * If mipmaps is true, this method will compute the full mip chain with
+     * a box filter, and encode every level.
+     *
+     * @param pixels    The RGBA pixels to encode
+     * @param width     The image width in pixels
+     * @param height    The image height in pixels
+     * @param format    The compression format
+     * @param mipmaps   Whether to compute and encode the mip chain
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithPixels(const Uint8* pixels, Uint32 width, Uint32 height,
+                        Format format, bool mipmaps);
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated compressed image from the given KTX file.
+     *
+     * The KTX file must contain a single 2D image (no arrays or cube maps)
+     * in one of the formats of {@link Format}.  The file is memory mapped,
+     * and the image data is not copied.
+     *
+     * @param file  The path to the KTX file
+     *
+     * @return a newly allocated compressed image from the given KTX file.
+     */
+    static std::shared_ptr<CompressedImage> allocWithFile(const std::string file) {
+        std::shared_ptr<CompressedImage> result = std::make_shared<CompressedImage>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated compressed image from the given KTX file contents.
+     *
+     * The KTX file must contain a single 2D image (no arrays or cube maps)
+     * in one of the formats of {@link Format}.  The image data is not copied,
+     * and this image retains a reference to the mapping.
+     *
+     * @param mapping   The contents of a KTX file
+     *
+     * @return a newly allocated compressed image from the given KTX file contents.
+     */
+    static std::shared_ptr<CompressedImage> allocWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+        std::shared_ptr<CompressedImage> result = std::make_shared<CompressedImage>();
+        return (result->initWithMapping(mapping) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated compressed image encoding the given RGBA pixels.
+     *
+     * The pixels must be stored row by row, with four bytes per pixel in
+     * the order red, green, blue, and alpha.  The format must be either
+     * {@link Format#ETC2_RGB} or {@link Format#ETC2_RGBA}.  If the format
+     * is ETC2_RGB, the alpha channel is ignored.
+     *
+     * If mipmaps is true, this method will compute the full mip chain with
+     * a box filter, and encode every level.
+     *
+     * @param pixels    The RGBA pixels to encode
+     * @param width     The image width in pixels
+     * @param height    The image height in pixels
+     * @param format    The compression format
+     * @param mipmaps   Whether to compute and encode the mip chain
+     *
+     * @return a newly allocated compressed image encoding the given RGBA pixels.
+     */
+    static std::shared_ptr<CompressedImage> allocWithPixels(const Uint8* pixels, Uint32 width, Uint32 height,
+                                                            Format format, bool mipmaps) {
+        std::shared_ptr<CompressedImage> result = std::make_shared<CompressedImage>();
+        return (result->initWithPixels(pixels,width,height,format,mipmaps) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the compression format of this image.
+     *
+     * @return the compression format of this image.
+     */
+    Format getFormat() const { return _format; }
+
+    /**
+     * Returns the width of the base level in pixels.
+     *
+     * @return the width of the base level in pixels.
+     */
+    Uint32 getWidth() const { return _width; }
+
+    /**
+     * Returns the height of the base level in pixels.
+     *
+     * @return the height of the base level in pixels.
+     */
+    Uint32 getHeight() const { return _height; }
+
+    /**
+     * Returns the number of mipmap levels, including the base level.
+     *
+     * @return the number of mipmap levels, including the base level.
+     */
+    size_t getLevelCount() const { return _levels.size(); }
+
+    /**
+     * Returns the compressed data for the given mipmap level.
+     *
+     * The data is exactly what should be passed to glCompressedTexImage2D.
+     * This method returns nullptr if the level does not exist.
+     *
+     * @param level The mipmap level
+     * @param size  Stores the size of the data in bytes
+     *
+     * @return the compressed data for the given mipmap level.
+     */
+    const Uint8* getLevel(size_t level, size_t& size) const;
+
+    /**
+     * Returns the total size of the compressed data in bytes.
+     *
+     * This is the amount of video memory used by the texture for this image.
+     *
+     * @return the total size of the compressed data in bytes.
+     */
+    size_t getByteSize() const;
+
+    /**
+     * Returns true if the compression format has an alpha channel.
+     *
+     * @return true if the compression format has an alpha channel.
+     */
+    bool hasAlpha() const { return _format != Format::ETC2_RGB; }
+
+    /**
+     * Returns true if the given format is supported by the current GPU.
+     *
+     * The supported formats are queried from OpenGL the first time this
+     * method is called, so it must be called in the main thread.  ETC2 is
+     * always supported in OpenGLES 3, but is not available on macOS.  ASTC
+     * is only supported on recent mobile devices.
+     *
+     * @param format    The compression format
+     *
+     * @return true if the given format is supported by the current GPU.
+     */
+    static bool isSupported(Format format);
+
+    /**
+     * Returns the size of the compressed data for an image of the given size.
+     *
+     * This method returns 0 if the format is unknown.
+     *
+     * @param format    The compression format
+     * @param width     The image width in pixels
+     * @param height    The image height in pixels
+     *
+     * @return the size of the compressed data for an image of the given size.
+     */
+    static size_t getDataSize(Format format, Uint32 width, Uint32 height);
+
+#pragma mark -
+#pragma mark Conversion
+    /**
+     * Decodes the given mipmap level into RGBA pixels.
+     *
+     * The pixels are stored row by row, with four bytes per pixel in the
+     * order red, green, blue, and alpha.  Only the ETC2 formats may be
+     * decoded.  All of the ETC2 block modes are supported, and not just
+     * the ones produced by the encoder.
+     *
+     * @param level     The mipmap level
+     * @param pixels    The vector to store the decoded pixels
+     *
+     * @return true if the level could be decoded.
+     */
+    bool decode(size_t level, std::vector<Uint8>& pixels) const;
+
+    /**
+     * Saves this image to the given file as a KTX file.
+     *
+     * The file should have the extension ".ktx".  This method returns false
+     * if the file could not be written.
+     *
+     * @param file  The path to the KTX file
+     *
+     * @return true if the file was saved successfully.
+     */
+    bool save(const std::string file) const;
+
+};
+
+}
+
+#endif /* __CU_COMPRESSED_IMAGE_H__ */
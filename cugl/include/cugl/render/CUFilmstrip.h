@@ -0,0 +1,357 @@
+//
+//  CUFilmstrip.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for long animations stored as a stream of
+//  compressed frames.  A sprite sheet must keep every frame of an animation
+//  resident in video memory.  A filmstrip only stores the differences between
+//  consecutive frames, and it is decoded one frame at a time.  This makes it
+//  suitable for long background animations, where only the current frame
+//  needs to be on the GPU.  See {@link scene2::StreamedAnimationNode}.
+//
+//  The frames are encoded as runs of skipped, copied, and filled pixels.
+//  Key frames (which do not depend on the previous frame) are inserted at a
+//  regular interval so that the decoder can seek.  The encoder is meant for
+//  offline use (see the texture cooker in the tools directory).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_FILMSTRIP_H__
+#define __CU_FILMSTRIP_H__
+#include <cugl/math/CUMathBase.h>
+#include <cugl/io/CUMappedFile.h>
+#include <vector>
+
+namespace cugl {
+
+/**
+ * This class represents an animation stored as a stream of delta frames.
+ *
+ * A filmstrip is read from (or saved to) a file with the extension ".film".
+ * When the filmstrip is read from a file, the file is memory mapped, so only
+ * the frames that are actually decoded are paged into memory.
+ *
+ * Each frame is stored as a sequence of runs.  A run either skips pixels
+ * (leaving the previous frame unchanged), copies new pixels, or fills pixels
+ * with a single color.  Key frames do not skip any pixels, and so may be
+ * decoded without the previous frame.  The first frame is always a key frame.
+ *
+ * Frames are always decoded to RGBA pixels, even if the filmstrip has no
+ * alpha channel.  The decoder only requires a canvas the size of a single
+ * frame, and so the memory used by an animation does not depend on its
+ * length.
+ *
+ * This class does not use OpenGL.  Hence it is safe to decode (or encode)
+ * a filmstrip outside of the main thread.  As {@link decode} is a const
+ * method, several threads may decode the same filmstrip at once, provided
+ * that each has its own canvas.
+ */
+class Filmstrip {
+protected:
+    /** The width of each frame in pixels */
+    Uint32 _width;
+    /** The height of each frame in pixels */
+    Uint32 _height;
+    /** Whether the frames have an alpha channel */
+    bool _alpha;
+    /** The number of frames between key frames (0 for only the first frame) */
+    Uint32 _interval;
+    /** The largest per-channel difference the encoder treats as unchanged */
+    Uint8 _tolerance;
+    /** The memory mapped filmstrip file, if read from a file */
+    std::shared_ptr<MappedFile> _mapping;
+    /** The frame data, if encoded in memory */
+    std::vector<Uint8> _storage;
+    /** The start of the frame data (either in the mapping or the storage) */
+    const Uint8* _data;
+    /** The offset and size of each frame in the data */
+    std::vector<std::pair<size_t,size_t>> _frames;
+    /** The frame reconstructed by the decoder, for encoding the next delta */
+    std::vector<Uint8> _canvas;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an empty filmstrip.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    Filmstrip() : _width(0), _height(0), _alpha(false), _interval(0),
+    _tolerance(0), _data(nullptr) {}
+
+    /**
+     * Deletes this filmstrip, disposing all resources
+     */
+    ~Filmstrip() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this filmstrip.
+     *
+     * A disposed filmstrip can be safely reinitialized.
+     */
+    void dispose();
+
+    /**
+     * Initializes an empty filmstrip for encoding frames.
+     *
+     * Frames are added to this filmstrip with {@link append}.  A key frame is
+     * inserted every interval frames.  If interval is 0, only the first frame
+     * is a key frame.  Shorter intervals make seeking faster, at the cost of
+     * a larger filmstrip.
+     *
+     * If tolerance is positive, the encoder is lossy.  A pixel whose channels
+     * differ by at most tolerance from the previous frame is left unchanged,
+     * and a run of pixels that differ by at most tolerance from each other is
+     * filled with a single color.  The encoder compares against the frames
+     * that the decoder will actually produce, so errors never accumulate
+     * beyond the tolerance.
+     *
+     * @param width     The frame width in pixels
+     * @param height    The frame height in pixels
+     * @param alpha     Whether to store the alpha channel
+     * @param interval  The number of frames between key frames
+     * @param tolerance The largest per-channel difference to ignore
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(Uint32 width, Uint32 height, bool alpha, Uint32 interval, Uint8 tolerance=0);
+
+    /**
+     * Initializes a filmstrip from the given file.
+     *
+     * The file is memory mapped, and the frame data is not copied.
+     *
+     * @param file  The path to the filmstrip file
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithFile(const std::string file);
+
+    /**
+     * Initializes a filmstrip from the given file contents.
+     *
+     * The frame data is not copied, and this filmstrip retains a reference to
+     * the mapping.
+     *
+     * @param mapping   The contents of a filmstrip file
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithMapping(const std::shared_ptr<MappedFile>& mapping);
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated empty filmstrip for encoding frames.
+     *
+     * Frames are added to this filmstrip with {@link append}.  A key frame is
+     * inserted every interval frames.  If interval is 0, only the first frame
+     * is a key frame.  Shorter intervals make seeking faster, at the cost of
+     * a larger filmstrip.
+     *
+     * If tolerance is positive, the encoder is lossy.  A pixel whose channels
+     * differ by at most tolerance from the previous frame is left unchanged,
+     * and a run of pixels that differ by at most tolerance from each other is
+     * filled with a single color.  The encoder compares against the frames
+     * that the decoder will actually produce, so errors never accumulate
+     * beyond the tolerance.
+     *
+     * @param width     The frame width in pixels
+     * @param height    The frame height in pixels
+     * @param alpha     Whether to store the alpha channel
+     * @param interval  The number of frames between key frames
+     * @param tolerance The largest per-channel difference to ignore
+     *
+     * @return a newly allocated empty filmstrip for encoding frames.
+     */
+    static std::shared_ptr<Filmstrip> alloc(Uint32 width, Uint32 height, bool alpha,
+                                            Uint32 interval, Uint8 tolerance=0) {
+        std::shared_ptr<Filmstrip> result = std::make_shared<Filmstrip>();
+        return (result->init(width,height,alpha,interval,tolerance) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated filmstrip from the given file.
+     *
+     * The file is memory mapped, and the frame data is not copied.
+     *
+     * @param file  The path to the filmstrip file
+     *
+     * @return a newly allocated filmstrip from the given file.
+     */
+    static std::shared_ptr<Filmstrip> allocWithFile(const std::string file) {
+        std::shared_ptr<Filmstrip> result = std::make_shared<Filmstrip>();
+        return (result->initWithFile(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated filmstrip from the given file contents.
+     *
+     * The frame data is not copied, and this filmstrip retains a reference to
+     * the mapping.
+     *
+     * @param mapping   The contents of a filmstrip file
+     *
+     * @return a newly allocated filmstrip from the given file contents.
+     */
+    static std::shared_ptr<Filmstrip> allocWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+        std::shared_ptr<Filmstrip> result = std::make_shared<Filmstrip>();
+        return (result->initWithMapping(mapping) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the width of each frame in pixels.
+     *
+     * @return the width of each frame in pixels.
+     */
+    Uint32 getWidth() const { return _width; }
+
+    /**
+     * Returns the height of each frame in pixels.
+     *
+     * @return the height of each frame in pixels.
+     */
+    Uint32 getHeight() const { return _height; }
+
+    /**
+     * Returns true if the frames have an alpha channel.
+     *
+     * Frames without an alpha channel are decoded as opaque RGBA pixels.
+     *
+     * @return true if the frames have an alpha channel.
+     */
+    bool hasAlpha() const { return _alpha; }
+
+    /**
+     * Returns the number of frames in this filmstrip.
+     *
+     * @return the number of frames in this filmstrip.
+     */
+    Uint32 getFrameCount() const { return (Uint32)_frames.size(); }
+
+    /**
+     * Returns the number of frames between key frames.
+     *
+     * If this value is 0, only the first frame is a key frame.
+     *
+     * @return the number of frames between key frames.
+     */
+    Uint32 getInterval() const { return _interval; }
+
+    /**
+     * Returns true if the given frame is a key frame.
+     *
+     * A key frame may be decoded without the previous frame.
+     *
+     * @param frame The frame index
+     *
+     * @return true if the given frame is a key frame.
+     */
+    bool isKeyFrame(Uint32 frame) const;
+
+    /**
+     * Returns the total size of the encoded frames in bytes.
+     *
+     * @return the total size of the encoded frames in bytes.
+     */
+    size_t getByteSize() const;
+
+    /**
+     * Returns the size of a single decoded frame in bytes.
+     *
+     * This is the size of the canvas required by {@link decode}.
+     *
+     * @return the size of a single decoded frame in bytes.
+     */
+    size_t getFrameSize() const { return 4*(size_t)_width*_height; }
+
+#pragma mark -
+#pragma mark Conversion
+    /**
+     * Appends a frame to the end of this filmstrip.
+     *
+     * The pixels must be stored row by row, with four bytes per pixel in
+     * the order red, green, blue, and alpha.  If this filmstrip has no alpha
+     * channel, the alpha values are ignored.  The frame is encoded as the
+     * difference from the previous frame, unless it is a key frame.
+     *
+     * This method may only be used on a filmstrip created with {@link init}.
+     *
+     * @param pixels    The RGBA pixels of the frame
+     *
+     * @return true if the frame was encoded.
+     */
+    bool append(const Uint8* pixels);
+
+    /**
+     * Decodes the given frame into the canvas.
+     *
+     * The canvas holds the RGBA pixels of the frame current, and this method
+     * advances it to the given frame.  If frame is after current, and there
+     * is no key frame in between, this method only decodes the frames after
+     * current.  Otherwise, it decodes from the last key frame at or before
+     * frame.  Hence it is most efficient to decode frames in order.
+     *
+     * If current is negative, the canvas is assumed to be uninitialized, and
+     * it will be resized to {@link getFrameSize}.  On success, current is set
+     * to frame.  On failure, current is set to -1.
+     *
+     * @param frame     The frame to decode
+     * @param canvas    The RGBA pixels of the current frame
+     * @param current   The frame currently stored in canvas
+     *
+     * @return true if the frame could be decoded.
+     */
+    bool decode(Uint32 frame, std::vector<Uint8>& canvas, Sint32& current) const;
+
+    /**
+     * Saves this filmstrip to the given file.
+     *
+     * The file should have the extension ".film".  This method returns false
+     * if the file could not be written.
+     *
+     * @param file  The path to the filmstrip file
+     *
+     * @return true if the file was saved successfully.
+     */
+    bool save(const std::string file) const;
+
+};
+
+}
+
+#endif /* __CU_FILMSTRIP_H__ */
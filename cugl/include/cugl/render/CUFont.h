@@ -55,6 +55,7 @@
 #include <cugl/render/CUTexture.h>
 #include <cugl/render/CUSpriteVertex.h>
 #include <cugl/render/CUMesh.h>
+#include <cugl/io/CUMappedFile.h>
 #include <SDL/SDL_ttf.h>
 
 namespace cugl {
@@ -96,6 +97,12 @@ namespace cugl {
  * that you explicitly specify a character set for the atlas.  Indeed, a 
  * character set is the only way to get unicode support; the basic atlas only 
  * includes ASCII characters.
+ *
+ * Finally, an atlas may be baked offline with {@link bake}, and read back with
+ * {@link initWithBaked}. A baked font has no TrueType data, so it skips glyph
+ * rasterization (and kerning computation) at load time.  If the atlas is
+ * baked as a signed distance field, a single bake may be loaded at any size,
+ * and drawn with {@link SpriteBatch#setDistanceField}.
  */
 class Font {
 #pragma mark Inner Classes
@@ -270,6 +277,10 @@ protected:
     std::shared_ptr<Texture> _texture;
     /** A (temporary) SDL surface for computing the atlas texture */
     SDL_Surface* _surface;
+    /** Whether the atlas stores a signed distance field instead of coverage */
+    bool _distance;
+    /** The number of atlas pixels per font pixel (1 unless a scaled bake) */
+    float _atlasScale;
 
     
 public:
@@ -312,6 +323,46 @@ public:
      */
     bool init(const std::string file, int size);
     
+    /**
+     * Initializes a font from the given baked font file.
+     *
+     * A baked font file is produced by {@link bake}, and contains the atlas,
+     * the glyph metrics, and the kerning of a font.  The font is ready to
+     * draw once {@link getAtlas()} is called in the main thread.  There is no
+     * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+     * and resolution cannot be changed.
+     *
+     * If size is 0, the font has the size at which it was baked.  Otherwise,
+     * the bake must either have that size, or be a distance field.  A distance
+     * field is scaled to the requested size.
+     *
+     * @param file  The path to the baked font file
+     * @param size  The font size in points (0 for the baked size)
+     *
+     * @return true if initialization is successful.
+     */
+    bool initWithBaked(const std::string file, int size=0);
+    
+    /**
+     * Initializes a font from the given baked font contents.
+     *
+     * A baked font file is produced by {@link bake}, and contains the atlas,
+     * the glyph metrics, and the kerning of a font.  The font is ready to
+     * draw once {@link getAtlas()} is called in the main thread.  There is no
+     * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+     * and resolution cannot be changed.
+     *
+     * If size is 0, the font has the size at which it was baked.  Otherwise,
+     * the bake must either have that size, or be a distance field.  A distance
+     * field is scaled to the requested size.
+     *
+     * @param mapping   The contents of a baked font file
+     * @param size      The font size in points (0 for the baked size)
+     *
+     * @return true if initialization is successful.
+     */
+    bool initWithBaked(const std::shared_ptr<MappedFile>& mapping, int size=0);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -332,6 +383,52 @@ public:
         return (result->init(file,size) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated font from the given baked font file.
+     *
+     * A baked font file is produced by {@link bake}, and contains the atlas,
+     * the glyph metrics, and the kerning of a font.  The font is ready to
+     * draw once {@link getAtlas()} is called in the main thread.  There is no
+     * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+     * and resolution cannot be changed.
+     *
+     * If size is 0, the font has the size at which it was baked.  Otherwise,
+     * the bake must either have that size, or be a distance field.  A distance
+     * field is scaled to the requested size.
+     *
+     * @param file  The path to the baked font file
+     * @param size  The font size in points (0 for the baked size)
+     *
+     * @return a newly allocated font from the given baked font file.
+     */
+    static std::shared_ptr<Font> allocWithBaked(const std::string file, int size=0) {
+        std::shared_ptr<Font> result = std::make_shared<Font>();
+        return (result->initWithBaked(file,size) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated font from the given baked font contents.
+     *
+     * A baked font file is produced by {@link bake}, and contains the atlas,
+     * the glyph metrics, and the kerning of a font.  The font is ready to
+     * draw once {@link getAtlas()} is called in the main thread.  There is no
+     * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+     * and resolution cannot be changed.
+     *
+     * If size is 0, the font has the size at which it was baked.  Otherwise,
+     * the bake must either have that size, or be a distance field.  A distance
+     * field is scaled to the requested size.
+     *
+     * @param mapping   The contents of a baked font file
+     * @param size      The font size in points (0 for the baked size)
+     *
+     * @return a newly allocated font from the given baked font contents.
+     */
+    static std::shared_ptr<Font> allocWithBaked(const std::shared_ptr<MappedFile>& mapping, int size=0) {
+        std::shared_ptr<Font> result = std::make_shared<Font>();
+        return (result->initWithBaked(mapping,size) ? result : nullptr);
+    }
+
 
 #pragma mark -
 #pragma mark Attributes
@@ -495,7 +592,7 @@ public:
      * Sets the style for this font.
      *
      * Changing this value will delete any atlas that is present.  The atlas
-     * must be regenerated.
+     * must be regenerated.  This value cannot be changed on a baked font.
      *
      * With the exception of normal style (which is an absent of any style), all
      * of the styles may be combined.  So it is possible to have a bold, italic,
@@ -521,7 +618,7 @@ public:
      * Sets the rasterization hints
      *
      * Changing this value will delete any atlas that is present.  The atlas
-     * must be regenerated.
+     * must be regenerated.  This value cannot be changed on a baked font.
      *
      * Hinting is used to align the font to a rasterized grid. At low screen
      * resolutions, hinting is critical for producing clear, legible text
@@ -547,7 +644,7 @@ public:
      * Sets the rendering resolution for this font.
      *
      * Changing this value will delete any atlas that is present.  The atlas
-     * must be regenerated.
+     * must be regenerated.  This value cannot be changed on a baked font.
      *
      * The option SOLID is only useful for the case where there is no atlas.
      * The preferred value for atlases and high quality fonts is BLENDED.
@@ -556,7 +653,9 @@ public:
      *
      * @param resolution    The rendering resolution for this font.
      */
-    void setResolution(Resolution resolution) { clearAtlas(); _render = resolution; }
+    void setResolution(Resolution resolution) {
+        if (!isBaked()) { clearAtlas(); _render = resolution; }
+    }
 
 
     
@@ -695,6 +794,9 @@ public:
      * Deletes the current atlas
      * 
      * The font will use direct rendering until a new atlas is created.
+     *
+     * A baked font cannot render without its atlas, so this method does
+     * nothing if the font was baked.
      */
     void clearAtlas();
 
@@ -803,6 +905,48 @@ public:
      */
     bool hasAtlas() const { return _hasAtlas; }
     
+    /**
+     * Returns true if this font was read from a baked font file.
+     *
+     * A baked font has no TrueType data.  It always has an atlas, and its
+     * style, hinting, and resolution are fixed.
+     *
+     * @return true if this font was read from a baked font file.
+     */
+    bool isBaked() const { return _hasAtlas && _data == nullptr; }
+    
+    /**
+     * Returns true if the atlas stores a signed distance field.
+     *
+     * A distance field atlas must be drawn with the distance field mode of
+     * {@link SpriteBatch}.  Otherwise the glyphs will appear as soft blobs.
+     * Only baked fonts may have a distance field atlas.
+     *
+     * @return true if the atlas stores a signed distance field.
+     */
+    bool isDistanceField() const { return _distance; }
+    
+    /**
+     * Saves the atlas, glyph metrics, and kerning of this font to a file.
+     *
+     * The file can be read with {@link initWithBaked}.  It should have the
+     * extension ".font".  This method must be called after one of the methods
+     * {@link buildAtlasAsync} and before {@link getAtlas}, as the atlas pixels
+     * cannot be read back from the OpenGL texture.  This method does not use
+     * OpenGL, and so is safe for offline tools.
+     *
+     * If spread is positive, the atlas is saved as a signed distance field.
+     * The spread is the distance (in atlas pixels) at which the field is
+     * clamped.  A distance field should be baked at a large size with no
+     * hinting, so that it can be scaled to any size when loaded.
+     *
+     * @param file      The path to the baked font file
+     * @param spread    The distance field spread (0 for a coverage atlas)
+     *
+     * @return true if the file was saved successfully.
+     */
+    bool bake(const std::string file, Uint32 spread=0) const;
+    
 #pragma mark -
 #pragma mark Rendering
     /**
@@ -1382,6 +1526,9 @@ protected:
     
     /**
      * Gathers the kerning information for the atlas.
+     *
+     * Only the pairs with nonzero kerning are stored.  Use the method
+     * {@link getAtlasKerning} to look up a pair.
      */
     void prepareAtlasKerning();
 
@@ -1403,6 +1550,19 @@ protected:
      * @return the kerning between the two characters if available.
      */
     int computeKerning(Uint32 a, Uint32 b) const;
+    
+    /**
+     * Returns the kerning between the two characters in the atlas.
+     *
+     * The atlas only stores pairs with nonzero kerning, so this method
+     * returns 0 for any pair that is missing.
+     *
+     * @param a     The first character in the pair
+     * @param b     The second character in the pair
+     *
+     * @return the kerning between the two characters in the atlas.
+     */
+    int getAtlasKerning(Uint32 a, Uint32 b) const;
 
     /**
      * Computes the size of the atlas texture
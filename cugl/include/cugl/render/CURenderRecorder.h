@@ -0,0 +1,375 @@
+//
+//  CURenderRecorder.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorder for the OpenGL command stream. Every
+//  rendering class (SpriteBatch, VertexBuffer, Shader, Texture, RenderTarget)
+//  reports its draw calls, uploads, and binds to this recorder. This allows
+//  us to measure the cost of a frame (in draw calls and bytes) independent
+//  of the speed of the GPU.
+//
+//  In addition, the recorder can be put in headless mode. In this mode, the
+//  rendering classes record their commands but never touch OpenGL. Handles
+//  and bindings are simulated by the recorder instead. This allows the
+//  render paths to run on machines with no graphics card (or no display).
+//
+//  This class is a collection of static methods. It should never be
+//  instantiated.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+#ifndef __CU_RENDER_RECORDER_H__
+#define __CU_RENDER_RECORDER_H__
+#include <cugl/base/CUBase.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace cugl {
+
+/**
+ * This class records the OpenGL command stream of the rendering classes.
+ *
+ * The rendering classes report every draw call, buffer upload, state change,
+ * texture bind, shader bind, and render target switch to this class. These
+ * are accumulated in a set of {@link Counts}, which can be read (and reset)
+ * at any time. For example, a regression test can reset the counts, render
+ * a single frame of a scene, and compare the result to known good values.
+ * Counting is always on, as it is only a handful of integer additions per
+ * draw call.
+ *
+ * If capturing is enabled, the recorder also keeps the full command stream
+ * as a list of {@link Entry} values. This is useful for diffing two frames,
+ * but it allocates memory, so it is off by default.
+ *
+ * Finally, the recorder can be made headless. In headless mode, the rendering
+ * classes never call OpenGL. Instead, they allocate handles from this class
+ * and store their bindings here. Queries like {@link Shader#isBound} read
+ * this simulated state instead of the OpenGL context. Headless mode must be
+ * chosen before any graphics objects are created, and it cannot be changed
+ * once they exist. Typically it is chosen via {@link Application#setHeadless}.
+ */
+class RenderRecorder {
+public:
+    /**
+     * The types of commands recorded in the command stream.
+     */
+    enum class Command : unsigned int {
+        /** A draw call (the value is the number of indices) */
+        DRAW,
+        /** A buffer or texture upload (the value is the number of bytes) */
+        UPLOAD,
+        /** A pipeline state change (the value is the OpenGL state enum) */
+        STATE,
+        /** A texture bind (the value is the texture handle) */
+        TEXTURE,
+        /** A shader bind (the value is the program handle) */
+        SHADER,
+        /** A render target switch (the value is the framebuffer handle) */
+        TARGET
+    };
+
+    /**
+     * A single entry in the captured command stream.
+     */
+    class Entry {
+    public:
+        /** The command type */
+        Command type;
+        /** The OpenGL enum associated with the command (e.g. draw mode) */
+        GLenum mode;
+        /** The command value (see {@link Command} for the meaning) */
+        Uint64 value;
+    };
+
+    /**
+     * The accumulated command counts.
+     *
+     * These values accumulate until {@link RenderRecorder#reset} is called.
+     */
+    class Counts {
+    public:
+        /** The number of draw calls */
+        Uint64 drawCalls;
+        /** The number of indices drawn */
+        Uint64 indices;
+        /** The number of vertices uploaded */
+        Uint64 vertices;
+        /** The number of bytes uploaded to vertex, index, uniform, and texture buffers */
+        Uint64 bytesUploaded;
+        /** The number of pipeline state changes (blending, depth, uniforms) */
+        Uint64 stateChanges;
+        /** The number of texture binds */
+        Uint64 textureBinds;
+        /** The number of shader binds */
+        Uint64 shaderBinds;
+        /** The number of render target switches */
+        Uint64 targetSwitches;
+
+        /**
+         * Creates a set of counts with all values 0.
+         */
+        Counts() { clear(); }
+
+        /**
+         * Sets all of the counts to 0.
+         */
+        void clear();
+
+        /**
+         * Returns a string representation of these counts for debugging.
+         *
+         * @return a string representation of these counts for debugging.
+         */
+        std::string toString() const;
+    };
+
+#pragma mark Values
+private:
+    /** Whether the recorder is headless */
+    static bool _headless;
+    /** Whether the recorder is capturing the command stream */
+    static bool _capturing;
+    /** The accumulated counts */
+    static Counts _counts;
+    /** The captured command stream */
+    static std::vector<Entry> _commands;
+    /** The next available simulated handle */
+    static GLuint _nexthandle;
+    /** The simulated bindings, keyed by target and index (headless only) */
+    static std::unordered_map<Uint64,GLuint> _bindings;
+    /** The simulated viewport (headless only) */
+    static GLint _viewport[4];
+
+    /**
+     * Appends a command to the command stream if capturing.
+     *
+     * @param type  The command type
+     * @param mode  The OpenGL enum for the command
+     * @param value The command value
+     */
+    static void capture(Command type, GLenum mode, Uint64 value);
+
+public:
+#pragma mark -
+#pragma mark Headless Mode
+    /**
+     * Returns true if the rendering classes are headless.
+     *
+     * In headless mode, no rendering class will make an OpenGL call.
+     *
+     * @return true if the rendering classes are headless.
+     */
+    static bool isHeadless() { return _headless; }
+
+    /**
+     * Sets whether the rendering classes are headless.
+     *
+     * In headless mode, no rendering class will make an OpenGL call. This
+     * value must be set before any graphics objects are allocated. Objects
+     * allocated in one mode cannot be used in the other.
+     *
+     * @param value Whether the rendering classes are headless.
+     */
+    static void setHeadless(bool value);
+
+    /**
+     * Returns a new simulated OpenGL handle.
+     *
+     * Handles are never 0, and they are never reused. This method should
+     * only be used in headless mode.
+     *
+     * @return a new simulated OpenGL handle.
+     */
+    static GLuint genHandle() { return _nexthandle++; }
+
+    /**
+     * Returns the simulated binding for the given target.
+     *
+     * The target should be the OpenGL query enum for that binding, such as
+     * GL_CURRENT_PROGRAM or GL_VERTEX_ARRAY_BINDING. Indexed targets (like
+     * GL_TEXTURE_BINDING_2D) use the bind point as the index. If nothing is
+     * bound, this returns 0.
+     *
+     * @param target    The binding target
+     * @param index     The binding index
+     *
+     * @return the simulated binding for the given target.
+     */
+    static GLuint getBinding(GLenum target, GLuint index=0);
+
+    /**
+     * Sets the simulated binding for the given target.
+     *
+     * The target should be the OpenGL query enum for that binding, such as
+     * GL_CURRENT_PROGRAM or GL_VERTEX_ARRAY_BINDING. Indexed targets (like
+     * GL_TEXTURE_BINDING_2D) use the bind point as the index.
+     *
+     * @param target    The binding target
+     * @param handle    The handle to bind (0 to unbind)
+     * @param index     The binding index
+     */
+    static void setBinding(GLenum target, GLuint handle, GLuint index=0) {
+        _bindings[((Uint64)target << 32) | index] = handle;
+    }
+
+    /**
+     * Stores the simulated viewport in the given array.
+     *
+     * The array must have room for 4 values, which are stored in the same
+     * order as the GL_VIEWPORT query.
+     *
+     * @param viewport  The array to store the viewport
+     */
+    static void getViewport(GLint* viewport);
+
+    /**
+     * Sets the simulated viewport.
+     *
+     * @param x         The viewport left
+     * @param y         The viewport bottom
+     * @param width     The viewport width
+     * @param height    The viewport height
+     */
+    static void setViewport(GLint x, GLint y, GLint width, GLint height);
+
+#pragma mark -
+#pragma mark Command Stream
+    /**
+     * Returns the command counts accumulated since the last reset.
+     *
+     * @return the command counts accumulated since the last reset.
+     */
+    static const Counts& getCounts() { return _counts; }
+
+    /**
+     * Resets the command counts and clears the captured command stream.
+     */
+    static void reset();
+
+    /**
+     * Returns true if the recorder is capturing the command stream.
+     *
+     * @return true if the recorder is capturing the command stream.
+     */
+    static bool isCapturing() { return _capturing; }
+
+    /**
+     * Sets whether the recorder is capturing the command stream.
+     *
+     * Disabling capture does not clear the commands captured so far.
+     *
+     * @param value Whether the recorder is capturing the command stream.
+     */
+    static void setCapturing(bool value) { _capturing = value; }
+
+    /**
+     * Returns the command stream captured since the last reset.
+     *
+     * @return the command stream captured since the last reset.
+     */
+    static const std::vector<Entry>& getCommands() { return _commands; }
+
+#pragma mark -
+#pragma mark Recording
+    /**
+     * Records a single draw call.
+     *
+     * @param mode      The OpenGL drawing mode
+     * @param count     The number of indices drawn
+     * @param instances The number of instances drawn
+     */
+    static void recordDraw(GLenum mode, GLsizei count, GLsizei instances=1) {
+        _counts.drawCalls++;
+        _counts.indices += count*instances;
+        if (_capturing) capture(Command::DRAW, mode, count*instances);
+    }
+
+    /**
+     * Records an upload of vertex data.
+     *
+     * @param count     The number of vertices
+     * @param bytes     The total number of bytes
+     */
+    static void recordVertices(GLsizei count, size_t bytes) {
+        _counts.vertices += count;
+        recordUpload(GL_ARRAY_BUFFER, bytes);
+    }
+
+    /**
+     * Records a buffer or texture upload.
+     *
+     * @param target    The OpenGL buffer target
+     * @param bytes     The number of bytes
+     */
+    static void recordUpload(GLenum target, size_t bytes) {
+        _counts.bytesUploaded += bytes;
+        if (_capturing) capture(Command::UPLOAD, target, bytes);
+    }
+
+    /**
+     * Records a pipeline state change
+     *
+     * @param state     The OpenGL state changed
+     */
+    static void recordState(GLenum state) {
+        _counts.stateChanges++;
+        if (_capturing) capture(Command::STATE, state, state);
+    }
+
+    /**
+     * Records a texture bind
+     *
+     * @param handle    The texture handle
+     */
+    static void recordTexture(GLuint handle) {
+        _counts.textureBinds++;
+        if (_capturing) capture(Command::TEXTURE, GL_TEXTURE_2D, handle);
+    }
+
+    /**
+     * Records a shader bind
+     *
+     * @param handle    The program handle
+     */
+    static void recordShader(GLuint handle) {
+        _counts.shaderBinds++;
+        if (_capturing) capture(Command::SHADER, GL_CURRENT_PROGRAM, handle);
+    }
+
+    /**
+     * Records a render target switch
+     *
+     * @param handle    The framebuffer handle
+     */
+    static void recordTarget(GLuint handle) {
+        _counts.targetSwitches++;
+        if (_capturing) capture(Command::TARGET, GL_FRAMEBUFFER, handle);
+    }
+
+private:
+    /** This class is a static collection and cannot be instantiated */
+    RenderRecorder() {}
+};
+
+}
+
+#endif /* __CU_RENDER_RECORDER_H__ */
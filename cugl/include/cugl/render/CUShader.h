@@ -116,6 +116,11 @@ namespace cugl {
  * multiple output targets, then these must be explicitly managed inside the shader 
  * with the layout keyword.  Otherwise, the output bind points from the appropriate
  * query methods.
+ *
+ * If the {@link RenderRecorder} is headless, the shader is never compiled. It
+ * has a simulated program handle and every location query returns -1. Hence
+ * the named uniform setters do nothing, and the positional setters should
+ * only be passed locations that were queried from this shader.
  */
 class Shader {
 #pragma mark Values
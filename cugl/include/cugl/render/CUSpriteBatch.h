@@ -110,6 +110,14 @@ class Poly2;
  * texture, and drawing type (type 0).  Support for gradients and scissors
  * occur via a uniform block that is provides the data in the order scissor
  * then gradient.  See SpriteShader.frag for more information.
+ *
+ * A sprite batch may also be deferred (see {@link #allocDeferred}). A deferred
+ * sprite batch has no shader or OpenGL buffers. Instead of drawing, each flush
+ * records the vertices, indices, uniform blocks, and drawing contexts so that
+ * they can be appended to a normal sprite batch later with {@link #replay}.
+ * As a deferred sprite batch never touches OpenGL, it may be used on any
+ * thread. This allows independent parts of a scene to generate their vertices
+ * in parallel while all drawing remains on the OpenGL thread.
  */
 class SpriteBatch {
 #pragma mark Values
@@ -156,6 +164,10 @@ private:
         GLenum srcFactor;
         /** The stored destination factor */
         GLenum dstFactor;
+        /** The stored source factor for the alpha channel */
+        GLenum srcAlpha;
+        /** The stored destination factor for the alpha channel */
+        GLenum dstAlpha;
         /** The stored depth testing support */
         GLenum depthFunc;
         /** The stored perspective matrix */
@@ -170,6 +182,25 @@ private:
         GLuint dirty;
     };
 
+    /**
+     * A class storing a single recorded flush of a deferred sprite batch.
+     *
+     * The indices are relative to the vertices of this flush, and the
+     * context positions are relative to the indices. The block pointers
+     * of the contexts are relative to the recorded uniform blocks.
+     */
+    class Recording {
+    public:
+        /** The recorded vertices */
+        std::vector<SpriteVertex3> vertices;
+        /** The recorded indices */
+        std::vector<GLuint> indices;
+        /** The recorded uniform blocks (40 floats per block) */
+        std::vector<float> blocks;
+        /** The recorded drawing contexts, in order */
+        std::vector<Context> contexts;
+    };
+
     /** Whether this sprite batch has been initialized yet */
     bool _initialized;
     /** Whether this sprite batch is currently active */
@@ -196,6 +227,13 @@ private:
     /** The number of indices in the current mesh */
     unsigned int _indxSize;
     
+    /** The batch index of each source vertex in a chunked mesh */
+    std::vector<Uint32> _remapIndex;
+    /** The generation of each entry in the remap table */
+    std::vector<Uint32> _remapStamp;
+    /** The current remap generation (older entries are stale) */
+    Uint32 _remapGen;
+    
     /** The active drawing context */
     Context* _context;
     /** Whether the current context has been used. */
@@ -213,6 +251,15 @@ private:
     /** The active scissor mask */
     std::shared_ptr<Scissor>  _scissor;
 
+    /** Whether this sprite batch records its flushes instead of drawing */
+    bool _deferred;
+    /** The uniform block data for a deferred sprite batch */
+    std::vector<float> _blockData;
+    /** The recorded flushes of a deferred sprite batch */
+    std::vector<Recording> _recording;
+    /** The number of recorded flushes in use (the rest are kept for reuse) */
+    size_t _recordSize;
+
     // Monitoring values
     /** The number of vertices drawn in this pass (so far) */
     unsigned int _vertTotal;
@@ -337,6 +384,25 @@ public:
      */
     bool init(unsigned int capacity, const std::shared_ptr<Shader>& shader);
     
+    /**
+     * Initializes a deferred sprite batch with the given vertex capacity.
+     *
+     * A deferred sprite batch has no shader and allocates no OpenGL
+     * resources. Instead of drawing, every flush records its vertices and
+     * drawing contexts. These recordings are drawn by passing this batch
+     * to {@link #replay} on a normal sprite batch. As it never touches
+     * OpenGL, a deferred sprite batch may be used on any thread.
+     *
+     * The capacity (and uniform block capacity) follow the same rules as
+     * a normal sprite batch. The capacity may not be larger than that of
+     * the sprite batch that replays it.
+     *
+     * @param capacity The vertex capacity of this spritebatch
+     *
+     * @return true if initialization was successful.
+     */
+    bool initDeferred(unsigned int capacity = DEFAULT_CAPACITY);
+    
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -445,6 +511,28 @@ public:
         return (result->init(capacity,shader) ? result : nullptr);
     }
 
+    /**
+     * Returns a new deferred sprite batch with the given vertex capacity.
+     *
+     * A deferred sprite batch has no shader and allocates no OpenGL
+     * resources. Instead of drawing, every flush records its vertices and
+     * drawing contexts. These recordings are drawn by passing this batch
+     * to {@link #replay} on a normal sprite batch. As it never touches
+     * OpenGL, a deferred sprite batch may be used on any thread.
+     *
+     * The capacity (and uniform block capacity) follow the same rules as
+     * a normal sprite batch. The capacity may not be larger than that of
+     * the sprite batch that replays it.
+     *
+     * @param capacity The vertex capacity of this spritebatch
+     *
+     * @return a new deferred sprite batch with the given vertex capacity.
+     */
+    static std::shared_ptr<SpriteBatch> allocDeferred(unsigned int capacity = DEFAULT_CAPACITY) {
+        std::shared_ptr<SpriteBatch> result = std::make_shared<SpriteBatch>();
+        return (result->initDeferred(capacity) ? result : nullptr);
+    }
+
 #pragma mark -
 #pragma mark Attributes
     /**
@@ -464,6 +552,26 @@ public:
      */
     bool isDrawing() const { return _active; }
 
+    /**
+     * Returns true if this sprite batch is deferred.
+     *
+     * A deferred sprite batch records its flushes instead of drawing them.
+     * The recordings are drawn by passing this batch to {@link #replay} on
+     * a normal sprite batch.
+     *
+     * @return true if this sprite batch is deferred.
+     */
+    bool isDeferred() const { return _deferred; }
+    
+    /**
+     * Returns the vertex capacity of this sprite batch.
+     *
+     * The sprite batch will flush whenever it has more vertices than this.
+     *
+     * @return the vertex capacity of this sprite batch.
+     */
+    unsigned int getCapacity() const { return _vertMax; }
+
     /**
      * Returns the number of vertices drawn in the latest pass (so far).
      *
@@ -664,6 +772,25 @@ public:
      * @param dstFactor Specifies how the destination blending factors are computed.
      */
     void setBlendFunc(GLenum srcFactor, GLenum dstFactor);
+
+    /**
+     * Sets separate blending functions for the color and alpha channels
+     *
+     * The enums are the standard ones supported by OpenGL.  See
+     *
+     *      https://www.opengl.org/sdk/docs/man/html/glBlendFuncSeparate.xhtml
+     *
+     * However, this setter does not do any error checking to verify that
+     * the enums are valid. This is necessary to draw into a render target
+     * with premultiplied alpha, as the alpha channel should be blended with
+     * GL_ONE and GL_ONE_MINUS_SRC_ALPHA.
+     *
+     * @param srcRGB    Specifies how the source color factors are computed
+     * @param dstRGB    Specifies how the destination color factors are computed
+     * @param srcAlpha  Specifies how the source alpha factor is computed
+     * @param dstAlpha  Specifies how the destination alpha factor is computed
+     */
+    void setBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
     
     /** 
      * Returns the source blending factor
@@ -686,6 +813,26 @@ public:
      * @return the destination blending factor
      */
     GLenum getDestinationBlendFactor() const { return _context->dstFactor; }
+
+    /**
+     * Returns the source blending factor for the alpha channel
+     *
+     * This value is the same as {@link getSourceBlendFactor} unless it was
+     * set with {@link setBlendFuncSeparate}.
+     *
+     * @return the source blending factor for the alpha channel
+     */
+    GLenum getSourceAlphaFactor() const { return _context->srcAlpha; }
+
+    /**
+     * Returns the destination blending factor for the alpha channel
+     *
+     * This value is the same as {@link getDestinationBlendFactor} unless it
+     * was set with {@link setBlendFuncSeparate}.
+     *
+     * @return the destination blending factor for the alpha channel
+     */
+    GLenum getDestinationAlphaFactor() const { return _context->dstAlpha; }
     
     /**
      * Sets the blending equation for this sprite batch
@@ -805,6 +952,36 @@ public:
      */
     GLuint getBlurStep() const { return _context->blurstep; }
     
+    /**
+     * Sets whether textures are drawn as signed distance fields.
+     *
+     * A distance field texture stores the distance to a shape edge in its
+     * alpha channel, with the edge at one half.  In this mode, the alpha
+     * value is replaced by a smooth step across that edge, so the shape
+     * stays sharp at any scale. This is how {@link Font} draws an atlas
+     * that was baked as a distance field.
+     *
+     * This value is false by default.
+     *
+     * @param flag  Whether textures are drawn as signed distance fields
+     */
+    void setDistanceField(bool flag);
+    
+    /**
+     * Returns true if textures are drawn as signed distance fields.
+     *
+     * A distance field texture stores the distance to a shape edge in its
+     * alpha channel, with the edge at one half.  In this mode, the alpha
+     * value is replaced by a smooth step across that edge, so the shape
+     * stays sharp at any scale. This is how {@link Font} draws an atlas
+     * that was baked as a distance field.
+     *
+     * This value is false by default.
+     *
+     * @return true if textures are drawn as signed distance fields.
+     */
+    bool isDistanceField() const;
+    
 
 #pragma mark -
 #pragma mark Rendering
@@ -851,6 +1028,26 @@ public:
      */
     void flush();
 
+    /**
+     * Appends the recordings of a deferred sprite batch to this one.
+     *
+     * The vertices, uniform blocks, and drawing contexts recorded by the
+     * deferred batch (since its last call to {@link #begin}) are copied into
+     * this sprite batch in order. They are uploaded together with any other
+     * vertices at the next flush, so several deferred batches share a single
+     * vertex upload (though each adds at least one draw call). This sprite
+     * batch will only flush early if the recordings do not fit in its buffers.
+     *
+     * The state of this sprite batch (color, texture, blending, and so on)
+     * is unchanged by this method. This sprite batch must be active and
+     * must not itself be deferred. The deferred batch must have finished
+     * recording (e.g. {@link #end} was called) and may not have a larger
+     * capacity than this one.
+     *
+     * @param batch The deferred sprite batch to replay
+     */
+    void replay(const std::shared_ptr<SpriteBatch>& batch);
+
     
 #pragma mark -
 #pragma mark Solid Shapes
@@ -1900,6 +2097,15 @@ private:
      */
     void unwind();
     
+    /**
+     * Stores the current vertices and contexts as a new recording.
+     *
+     * This method is the flush of a deferred sprite batch. It copies the
+     * vertices, indices, uniform blocks, and contexts into the next recording
+     * slot (reusing its memory if possible) and then resets the batch.
+     */
+    void store();
+    
     /**
      * Sets the active uniform block to agree with the gradient and stroke.
      *
@@ -1924,6 +2130,34 @@ private:
      */
     void blurTexture(const std::shared_ptr<Texture>& texture, GLuint step);
 
+    /**
+     * Transforms the positions of a range of batched vertices in place.
+     *
+     * This method uses the vectorized array transforms in {@link Mat4}. If
+     * the matrix is a planar (2d) transform, which is the case for almost
+     * all scene graph drawing, it uses the cheaper {@link Affine2} transform
+     * instead. If the matrix is the identity, this method does nothing.
+     *
+     * @param start The index of the first vertex to transform
+     * @param size  The number of vertices to transform
+     * @param mat   The transform to apply to the vertices
+     */
+    void transformVertices(unsigned int start, unsigned int size, const Mat4& mat);
+
+    /**
+     * Invalidates the remap table used by {@link #chunkify}.
+     *
+     * The remap table maps each source vertex of a chunked mesh to its
+     * position in the current batch, so that shared vertices are only
+     * copied once per flush. Rather than clearing the table, this method
+     * advances the generation counter, which makes all existing entries
+     * stale in constant time. The table only grows (and so allocates) when
+     * a mesh is larger than any mesh chunked so far.
+     *
+     * @param size  The number of source vertices in the mesh
+     */
+    void resetRemap(size_t size);
+
     /**
      * Returns the number of vertices added to the drawing buffer.
      *
@@ -2019,10 +2253,12 @@ private:
      * Returns the number of vertices added to the drawing buffer.
      *
      * This method is an alternate version of {@link #prepare} for the same
-     * arguments.  It runs slower (e.g. the compiler cannot easily optimize
-     * the loops) but it is guaranteed to work on any size polygon.  This
-     * is important for avoiding memory corruption.  Unlike the perpare methods,
-     * this method is guaranteed to flush, draining the vertex buffer.
+     * arguments.  It streams the polygon through the batch one primitive
+     * at a time, flushing whenever the next primitive would not fit. Hence
+     * it works on any size polygon, and a primitive is never split across
+     * two flushes. Vertices shared between primitives are only copied once
+     * per flush, and this method does not allocate memory (except to grow
+     * the remap table the first time it sees a larger polygon).
      *
      * All vertices will be uniformly transformed by the transform matrix.
      * If depth testing is on, all vertices will use the current sprite
@@ -2058,10 +2294,12 @@ private:
      * Returns the number of vertices added to the drawing buffer.
      *
      * This method is an alternate version of {@link #prepare} for the same
-     * arguments.  It runs slower (e.g. the compiler cannot easily optimize
-     * the loops) but it is guaranteed to work on any size array.  This
-     * is important for avoiding memory corruption.  Unlike the perpare methods,
-     * this method is guaranteed to flush, draining the vertex buffer.
+     * arguments.  It streams the mesh through the batch one primitive at
+     * a time, flushing whenever the next primitive would not fit. Hence
+     * it works on any size mesh, and a primitive is never split across
+     * two flushes. Vertices shared between primitives are only copied once
+     * per flush, and this method does not allocate memory (except to grow
+     * the remap table the first time it sees a larger mesh).
      *
      * If depth testing is on, all vertices will use the current sprite
      * batch depth.
@@ -2094,10 +2332,12 @@ private:
      * Returns the number of vertices added to the drawing buffer.
      *
      * This method is an alternate version of {@link #prepare} for the same
-     * arguments.  It runs slower (e.g. the compiler cannot easily optimize
-     * the loops) but it is guaranteed to work on any size array.  This
-     * is important for avoiding memory corruption.  Unlike the perpare methods,
-     * this method is guaranteed to flush, draining the vertex buffer.
+     * arguments.  It streams the mesh through the batch one primitive at
+     * a time, flushing whenever the next primitive would not fit. Hence
+     * it works on any size mesh, and a primitive is never split across
+     * two flushes. Vertices shared between primitives are only copied once
+     * per flush, and this method does not allocate memory (except to grow
+     * the remap table the first time it sees a larger mesh).
      *
      * @param mesh  The mesh to add to the buffer
      * @param mat   The transform to apply to the vertices
@@ -49,6 +49,9 @@
 
 namespace cugl {
 
+/** Forward reference to GPU-compressed image data */
+class CompressedImage;
+
 /**
  * This is a class representing an OpenGL texture.
  *
@@ -175,6 +178,15 @@ private:
     /** Whether or not the texture has mip maps */
     bool _hasMipmaps;
 
+    /** The compressed internal format (0 if the texture is not compressed) */
+    GLenum _compression;
+
+    /** The size of the compressed data in bytes (0 if not compressed) */
+    size_t _compressedSize;
+
+    /** The number of pixels per logical unit (1 unless a reduced variant) */
+    float _resolution;
+
     /** An all purpose blank texture for coloring */
     static std::shared_ptr<Texture> _blank;
 
@@ -274,6 +286,9 @@ public:
      * The texture will be stored in RGBA format, even if it is a file format
      * that does not support transparency (e.g. JPEG).
      *
+     * If the file has the extension ".ktx", it is read as a compressed image
+     * instead.  See {@link #initWithImage} for the details.
+     *
      * IMPORTANT: In CUGL, relative path names always refer to the asset
      * directory. If you wish to load a texture from somewhere else, you must
      * use an absolute pathname.
@@ -284,6 +299,25 @@ public:
      */
     bool initWithFile(const std::string filename);
 
+    /**
+     * Initializes a texture with the given compressed image.
+     *
+     * Initializing a texture requires the use of the binding point at 0. Any 
+     * texture bound to that point will be unbound. In addition, once 
+     * initialization is done, this texture will not longer be bound as well.
+     *
+     * The compressed data is uploaded to the GPU as-is, including any mipmap
+     * levels in the image.  The image format must be supported by the GPU
+     * (see {@link CompressedImage#isSupported}).  The pixel format of a
+     * compressed texture is RGBA (or RGB if the image has no alpha), but its
+     * contents cannot be changed with {@link #set}.
+     *
+     * @param image     The compressed image
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithImage(const std::shared_ptr<CompressedImage>& image);
+
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -344,6 +378,9 @@ public:
      * The texture will be stored in RGBA format, even if it is a file format
      * that does not support transparency (e.g. JPEG).
      *
+     * If the file has the extension ".ktx", it is read as a compressed image
+     * instead.  See {@link #allocWithImage} for the details.
+     *
      * @param filename  The file supporting the texture file.
      *
      * @return a new texture with the given data
@@ -352,6 +389,28 @@ public:
         std::shared_ptr<Texture> result = std::make_shared<Texture>();
         return (result->initWithFile(filename) ? result : nullptr);
     }
+
+    /**
+     * Returns a new texture with the given compressed image.
+     *
+     * Allocating a texture requires the use of the binding point at 0. Any 
+     * texture bound to that point will be unbound. In addition, once 
+     * allocation is done, this texture will not longer be bound as well.
+     *
+     * The compressed data is uploaded to the GPU as-is, including any mipmap
+     * levels in the image.  The image format must be supported by the GPU
+     * (see {@link CompressedImage#isSupported}).  The pixel format of a
+     * compressed texture is RGBA (or RGB if the image has no alpha), but its
+     * contents cannot be changed with {@link #set}.
+     *
+     * @param image     The compressed image
+     *
+     * @return a new texture with the given compressed image
+     */
+    static std::shared_ptr<Texture> allocWithImage(const std::shared_ptr<CompressedImage>& image) {
+        std::shared_ptr<Texture> result = std::make_shared<Texture>();
+        return (result->initWithImage(image) ? result : nullptr);
+    }
     
     /**
      * Returns a blank texture that can be used to make solid shapes.
@@ -437,25 +496,79 @@ public:
     bool isReady() const { return _buffer != 0; }
     
     /**
-     * Returns the width of this texture in pixels.
+     * Returns the width of this texture in logical units.
+     *
+     * This is the width in pixels, unless the texture is a reduced
+     * resolution variant.  See {@link #getResolution}.
      *
-     * @return the width of this texture in pixels.
+     * @return the width of this texture in logical units.
      */
-    unsigned int getWidth()  const { return _width;  }
+    unsigned int getWidth()  const { return (unsigned int)(_width/getResolution()+0.5f);  }
     
     /**
-     * Returns the height of this texture in pixels.
+     * Returns the height of this texture in logical units.
+     *
+     * This is the height in pixels, unless the texture is a reduced
+     * resolution variant.  See {@link #getResolution}.
      *
-     * @return the height of this texture in pixels.
+     * @return the height of this texture in logical units.
      */
-    unsigned int getHeight() const { return _height; }
+    unsigned int getHeight() const { return (unsigned int)(_height/getResolution()+0.5f); }
     
+    /**
+     * Returns the size of this texture in logical units.
+     *
+     * This is the size in pixels, unless the texture is a reduced
+     * resolution variant.  See {@link #getResolution}.
+     *
+     * @return the size of this texture in logical units.
+     */
+    Size getSize() { return Size((float)getWidth(),(float)getHeight()); }
+
     /**
      * Returns the size of this texture in pixels.
      *
+     * This is the size of the texture data on the GPU.  It only differs
+     * from {@link #getSize} if the texture is a reduced resolution variant.
+     *
      * @return the size of this texture in pixels.
      */
-    Size getSize() { return Size((float)_width,(float)_height); }
+    Size getPixelSize() const { return Size((float)_width,(float)_height); }
+
+    /**
+     * Returns the number of pixels per logical unit.
+     *
+     * A texture may be loaded at a reduced resolution to save memory on
+     * small displays (see {@link TextureLoader}).  In that case the pixel
+     * data is smaller, but the texture reports the size of the full
+     * resolution image.  This keeps any sizes derived from the texture,
+     * such as atlas regions, filmstrip frames, and node content sizes,
+     * the same across all resolutions.
+     *
+     * If this texture is a subtexture, this is the resolution of its parent.
+     *
+     * @return the number of pixels per logical unit.
+     */
+    float getResolution() const {
+        return (_parent != nullptr ? _parent->getResolution() : _resolution);
+    }
+
+    /**
+     * Sets the number of pixels per logical unit.
+     *
+     * A texture may be loaded at a reduced resolution to save memory on
+     * small displays (see {@link TextureLoader}).  In that case the pixel
+     * data is smaller, but the texture reports the size of the full
+     * resolution image.  This keeps any sizes derived from the texture,
+     * such as atlas regions, filmstrip frames, and node content sizes,
+     * the same across all resolutions.
+     *
+     * This method may not be called on a subtexture.  It has to be set on
+     * the parent texture.
+     *
+     * @param resolution    The number of pixels per logical unit.
+     */
+    void setResolution(float resolution);
     
     /**
      * Returns the number of bytes in a single pixel of this texture.
@@ -474,6 +587,30 @@ public:
      */
     PixelFormat getFormat() const { return _pixelFormat; }
 
+    /**
+     * Returns true if this texture stores GPU-compressed data.
+     *
+     * A compressed texture cannot be modified with {@link #set}, and it can
+     * only have mipmaps if they were present in the compressed image.
+     *
+     * @return true if this texture stores GPU-compressed data.
+     */
+    bool isCompressed() const {
+        return (_parent != nullptr ? _parent->isCompressed() : _compression != 0);
+    }
+
+    /**
+     * Returns the (approximate) video memory used by this texture in bytes.
+     *
+     * For an uncompressed texture this is the size of the pixel data, plus
+     * a third for the mipmaps (if any).  For a compressed texture it is the
+     * exact size of the compressed data.  A subtexture shares the memory of
+     * its parent, so its footprint is 0.
+     *
+     * @return the (approximate) video memory used by this texture in bytes.
+     */
+    size_t getFootprint() const;
+
     /**
      * Returns whether this texture has generated mipmaps.
      *
@@ -493,6 +630,9 @@ public:
      * texture can have mipmaps. In addition, mipmaps can only be built if the
      * texture size is a power of two.
      *
+     * This method has no effect on a compressed texture, as its mipmaps
+     * (if any) are part of the compressed image.
+     *
      * This method is only successful if the texture is currently active.
      */
     void buildMipMaps();
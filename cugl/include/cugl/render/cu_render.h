@@ -30,6 +30,8 @@
 
 #include "CUSpriteVertex.h"
 #include "CUTexture.h"
+#include "CUCompressedImage.h"
+#include "CUFilmstrip.h"
 #include "CUFont.h"
 #include "CUMesh.h"
 #include "CUScissor.h"
@@ -37,6 +39,7 @@
 #include "CUShader.h"
 #include "CUUniformBuffer.h"
 #include "CURenderTarget.h"
+#include "CURenderRecorder.h"
 #include "CUSpriteBatch.h"
 #include "CUCamera.h"
 #include "CUOrthographicCamera.h"
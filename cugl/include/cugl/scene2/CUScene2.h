@@ -48,6 +48,9 @@
 #include <cugl/render/CUOrthographicCamera.h>
 
 namespace cugl {
+
+/** Forward references */
+class ThreadPool;
     
 /**
  * This class provides the root node of a two-dimensional scene graph.
@@ -91,6 +94,13 @@ protected:
 
     /** Whether or note this scene is still active */
     bool _active;
+    
+    /** Whether to record the top-level children in parallel */
+    bool _parallel;
+    /** The worker threads for parallel recording */
+    std::shared_ptr<ThreadPool> _workers;
+    /** The deferred sprite batches, one for each top-level child */
+    std::vector<std::shared_ptr<SpriteBatch>> _recorders;
 
 #pragma mark -
 #pragma mark Constructors
@@ -912,6 +922,37 @@ public:
      */
     virtual void reset() {}
     
+    /**
+     * Returns true if this scene records its top-level children in parallel.
+     *
+     * See {@link #setParallel} for a description of parallel recording.
+     *
+     * @return true if this scene records its top-level children in parallel.
+     */
+    bool isParallel() const { return _parallel; }
+    
+    /**
+     * Sets whether this scene records its top-level children in parallel.
+     *
+     * When parallel recording is on, each top-level child of this scene is
+     * rendered into its own deferred {@link SpriteBatch}. The children are
+     * recorded on worker threads (and on the calling thread). Afterwards
+     * their recordings are replayed in order into the sprite batch passed
+     * to {@link #render}. All OpenGL calls stay on the calling thread, and
+     * the draw order is the same as serial rendering.
+     *
+     * The top-level children must be independent. In particular, their
+     * draw methods may not modify anything outside of their own subtree.
+     * All of the scene graph classes in this library are safe to record
+     * in parallel. A {@link scene2::CachedNode} still uses its cache when
+     * recorded in parallel. But a stale cache is only redrawn at the start of
+     * the next pass, as that requires the OpenGL thread. Until then, the
+     * subtree is recorded directly.
+     *
+     * @param value Whether to record the top-level children in parallel
+     */
+    void setParallel(bool value);
+    
     /**
      * Draws all of the children in this scene with the given SpriteBatch.
      *
@@ -930,6 +971,16 @@ public:
 private:
 #pragma mark -
 #pragma mark Internal Helpers
+    /**
+     * Records the top-level children in parallel and replays them into batch.
+     *
+     * The sprite batch must be actively drawing. This method blocks until
+     * all of the children have been recorded.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     */
+    void renderParallel(const std::shared_ptr<SpriteBatch>& batch);
+    
     /**
      * Sets whether the children of this Scene needs resorting.
      *
@@ -36,7 +36,9 @@
 #include "graph/CUWireNode.h"
 #include "graph/CUPathNode.h"
 #include "graph/CUAnimationNode.h"
+#include "graph/CUStreamedAnimationNode.h"
 #include "graph/CUOrderedNode.h"
+#include "graph/CUCachedNode.h"
 #include "ui/CUButton.h"
 #include "ui/CULabel.h"
 #include "ui/CUProgressBar.h"
@@ -281,7 +281,7 @@ public:
      *
      * @param frame the index to make the active frame
      */
-    void setFrame(int frame);
+    virtual void setFrame(int frame);
  
 };
     }
@@ -0,0 +1,507 @@
+//
+//  CUCachedNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that caches the rendering of its
+//  subtree in an offscreen texture. Most UI elements (menu panels, HUD
+//  decorations) only change in response to game state. There is no reason
+//  to tessellate and submit them to the sprite batch every animation frame.
+//  This node renders its children once, and then draws them as a single
+//  textured quad until one of its descendants changes.
+//
+//  Offscreen textures are a limited resource, particularly on mobile devices.
+//  Therefore all cached nodes share a single memory budget. When that budget
+//  is exceeded, the least recently drawn caches are evicted.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+#ifndef __CU_CACHED_NODE_H__
+#define __CU_CACHED_NODE_H__
+#include <cugl/scene2/graph/CUSceneNode.h>
+#include <cugl/render/CURenderTarget.h>
+#include <list>
+#include <vector>
+#include <mutex>
+
+/** The default memory budget (in bytes) shared by all cached nodes */
+#define CU_CACHED_NODE_BUDGET   16777216
+/** The maximum texture dimension of a single cached node */
+#define CU_CACHED_NODE_MAXSIZE  4096
+
+namespace cugl {
+    namespace scene2 {
+/**
+ * This is a scene graph node that caches the rendering of its subtree.
+ *
+ * The first time that this node is rendered, it draws all of its descendants
+ * into an offscreen {@link RenderTarget}. On subsequent passes, it draws that
+ * texture as a single quad. This replaces the vertex generation and draw
+ * calls of the entire subtree with four vertices and (at most) one texture
+ * switch.
+ *
+ * The cache is discarded whenever a descendant of this node changes. All of
+ * the setters in the scene graph classes notify their ancestors through
+ * {@link SceneNode#markDirty}, so this normally happens automatically. If you
+ * have a custom node whose appearance depends on other state, that node
+ * should call {@link SceneNode#markDirty} itself. A subtree that changes
+ * every frame (such as one with an active {@link AnimationNode}) gains
+ * nothing from this class and should not be cached.
+ *
+ * Changes to this node itself do not invalidate the cache. The cache is
+ * drawn with the transform and color of this node, so you can move, scale,
+ * rotate, or fade a cached subtree for free. The only exception is a scale
+ * change large enough to alter the texture resolution. The offscreen image
+ * is drawn with the tint of this node, rather than passing that tint down to
+ * the children. Hence descendants that do not have a relative color will
+ * still be tinted by this node.
+ *
+ * The offscreen image is the size of the content bounds of this node, at the
+ * resolution of the screen. Any descendant content that falls outside of
+ * these bounds is clipped. The image stores premultiplied color, and is
+ * composited with premultiplied blending. Translucent descendants that
+ * overlap one another may have a slightly different alpha than they would
+ * if drawn directly.
+ *
+ * All cached nodes share a single memory budget, set by the static method
+ * {@link #setMemoryBudget}. If allocating a new cache would exceed this
+ * budget, the caches of other nodes are evicted in least-recently-drawn
+ * order. If there is still not enough room, this node renders its children
+ * directly, exactly like a {@link SceneNode}.
+ *
+ * A cached node may be recorded into a deferred {@link SpriteBatch}, such as
+ * when {@link Scene2#setParallel} is on. A valid cache is recorded as a single
+ * quad, just as in a normal batch. However, a cache can only be redrawn on
+ * the OpenGL thread. So a stale cache renders its children directly into the
+ * deferred batch, and is queued to be redrawn by {@link #refreshPending}. The
+ * method {@link Scene2#render} does this before each parallel pass, so the
+ * cache is used again from the next frame on.
+ *
+ * Cached nodes are not reentrant. A cached node that is a descendant of
+ * another cached node is rendered directly when its ancestor refreshes. In
+ * addition, a cached node should not be used inside of a {@link Scene2Texture},
+ * or as a descendant of an {@link OrderedNode} with a non-default order.
+ */
+class CachedNode : public SceneNode {
+#pragma mark Values
+protected:
+    /** The offscreen buffer storing the subtree (nullptr if not resident) */
+    std::shared_ptr<RenderTarget> _target;
+    /** Whether the offscreen buffer must be redrawn before use */
+    bool _cacheDirty;
+    /** Whether caching is enabled for this node */
+    bool _caching;
+    /** The world scale of this node when the cache was last drawn */
+    float _cacheScale;
+    /** The number of bytes used by the offscreen buffer */
+    size_t _footprint;
+    /** The position of this node in the residency list (if resident) */
+    std::list<CachedNode*>::iterator _residency;
+    /** Whether a descendant ignores the color of its parent (so the cache is tinted) */
+    bool _absolute;
+    /** The tint passed to the children when the cache was last drawn */
+    Color4 _cacheTint;
+    /** Whether this node is waiting to be redrawn on the OpenGL thread */
+    bool _pending;
+    /** The world scale at which to redraw a pending cache */
+    float _pendingScale;
+    /** The tint at which to redraw a pending cache */
+    Color4 _pendingTint;
+
+    /** The memory budget for all cached nodes */
+    static size_t _budget;
+    /** The memory currently used by all cached nodes */
+    static size_t _usage;
+    /** The number of cached nodes currently drawing to an offscreen buffer */
+    static int _capturing;
+    /** The resident caches, ordered from most to least recently drawn */
+    static std::list<CachedNode*> _residents;
+    /** The caches recorded stale into a deferred batch */
+    static std::vector<CachedNode*> _stale;
+    /** A mutex for the memory usage, residency and stale lists */
+    static std::mutex _mutex;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Creates an uninitialized cached node.
+     *
+     * You must initialize this CachedNode before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a CachedNode
+     * on the heap, use one of the static constructors instead.
+     */
+    CachedNode();
+
+    /**
+     * Deletes this node, disposing all resources
+     */
+    ~CachedNode() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed CachedNode can be safely reinitialized. Any children owned by
+     * this node will be released. They will be deleted if no other object owns
+     * them. The offscreen buffer is released immediately.
+     *
+     * It is unsafe to call this on a CachedNode that is still currently inside
+     * of a scene graph.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Initializes a node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}. This JSON format supports all
+     * of the attribute values of its parent class. In addition, it supports
+     * the following additional attributes:
+     *
+     *      "caching":  A boolean indicating whether to cache the subtree
+     *
+     * All attributes are optional. There are no required attributes.
+     *
+     * @param loader    The scene loader passing this JSON file
+     * @param data      The JSON object specifying the node
+     *
+     * @return true if initialization was successful.
+     */
+    virtual bool initWithData(const Scene2Loader* loader, const std::shared_ptr<JsonValue>& data) override;
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated cached node with the given size.
+     *
+     * The size defines the content size, and hence the size of the cache.
+     * The bounding box of the node is (0,0,width,height). Hence the node is
+     * anchored in the center and has position (width/2,height/2) in the
+     * parent space. The node origin is the (0,0) at the bottom left corner
+     * of the bounding box.
+     *
+     * @param size  The size of the node in parent space
+     *
+     * @return a newly allocated cached node with the given size.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(const Size size) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(size) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given size.
+     *
+     * The size defines the content size, and hence the size of the cache.
+     * The bounding box of the node is (0,0,width,height). Hence the node is
+     * anchored in the center and has position (width/2,height/2) in the
+     * parent space. The node origin is the (0,0) at the bottom left corner
+     * of the bounding box.
+     *
+     * @param width     The width of the node in parent space
+     * @param height    The height of the node in parent space
+     *
+     * @return a newly allocated cached node with the given size.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(float width, float height) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(width,height) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given bounds.
+     *
+     * The rectangle origin is the bottom left corner of the node in parent
+     * space, and corresponds to the origin of the Node space. The size defines
+     * its content width and height, and hence the size of the cache. The node
+     * is anchored in the center and has position origin-(width/2,height/2) in
+     * parent space.
+     *
+     * @param rect  The bounds of the node in parent space
+     *
+     * @return a newly allocated cached node with the given bounds.
+     */
+    static std::shared_ptr<CachedNode> allocWithBounds(const Rect rect) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithBounds(rect) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated cached node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}. This JSON format supports all
+     * of the attribute values of its parent class. In addition, it supports
+     * the following additional attributes:
+     *
+     *      "caching":  A boolean indicating whether to cache the subtree
+     *
+     * All attributes are optional. There are no required attributes.
+     *
+     * @param loader    The scene loader passing this JSON file
+     * @param data      The JSON object specifying the node
+     *
+     * @return a newly allocated cached node with the given JSON specificaton.
+     */
+    static std::shared_ptr<CachedNode> allocWithData(const Scene2Loader* loader,
+                                                     const std::shared_ptr<JsonValue>& data) {
+        std::shared_ptr<CachedNode> result = std::make_shared<CachedNode>();
+        return (result->initWithData(loader,data) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the class name of this node.
+     *
+     * This method is to help us speed up subclass-based polymorphism on the
+     * scene graphs.
+     *
+     * @return the class name of this node.
+     */
+    virtual const std::string getClassName() const override { return "CachedNode"; }
+
+    /**
+     * Returns true if this node caches the rendering of its subtree.
+     *
+     * If this value is false, this node behaves exactly like a
+     * {@link SceneNode}. This value is true by default.
+     *
+     * @return true if this node caches the rendering of its subtree.
+     */
+    bool isCaching() const { return _caching; }
+
+    /**
+     * Sets whether this node caches the rendering of its subtree.
+     *
+     * If this value is false, this node behaves exactly like a
+     * {@link SceneNode}. Disabling the cache immediately releases the
+     * offscreen buffer. This value is true by default.
+     *
+     * @param value Whether this node caches the rendering of its subtree.
+     */
+    void setCaching(bool value);
+
+    /**
+     * Returns true if the cache must be redrawn on the next render pass.
+     *
+     * This is true if the cache has never been drawn, if it was evicted, or
+     * if a descendant has changed since the cache was last drawn.
+     *
+     * @return true if the cache must be redrawn on the next render pass.
+     */
+    bool isCacheDirty() const { return _cacheDirty || _target == nullptr; }
+
+    /**
+     * Returns true if the offscreen buffer of this node is resident.
+     *
+     * A resident buffer counts against the memory budget, even if it is
+     * currently dirty.
+     *
+     * @return true if the offscreen buffer of this node is resident.
+     */
+    bool isResident() const { return _target != nullptr; }
+
+    /**
+     * Releases the offscreen buffer of this node.
+     *
+     * The subtree will be redrawn (and a new buffer allocated) the next
+     * time this node is rendered. You may want to call this when a cached
+     * node is removed from the scene but not deleted.
+     */
+    void releaseCache();
+
+    /**
+     * Sets the untransformed size of the node.
+     *
+     * The content size is also the size of the offscreen buffer. Changing
+     * the size of this node will invalidate the current cache.
+     *
+     * @param size  The untransformed size of the node.
+     */
+    virtual void setContentSize(const Size size) override;
+
+    /**
+     * Sets the untransformed size of the node.
+     *
+     * The content size is also the size of the offscreen buffer. Changing
+     * the size of this node will invalidate the current cache.
+     *
+     * @param width     The untransformed width of the node.
+     * @param height    The untransformed height of the node.
+     */
+    virtual void setContentSize(float width, float height) override {
+        setContentSize(Size(width, height));
+    }
+
+#pragma mark -
+#pragma mark Memory Budget
+    /**
+     * Returns the memory budget (in bytes) shared by all cached nodes.
+     *
+     * The default budget is {@link CU_CACHED_NODE_BUDGET}.
+     *
+     * @return the memory budget (in bytes) shared by all cached nodes.
+     */
+    static size_t getMemoryBudget() { return _budget; }
+
+    /**
+     * Sets the memory budget (in bytes) shared by all cached nodes.
+     *
+     * If the current memory usage exceeds the new budget, the least recently
+     * drawn caches are evicted immediately.
+     *
+     * @param bytes The memory budget (in bytes) shared by all cached nodes.
+     */
+    static void setMemoryBudget(size_t bytes);
+
+    /**
+     * Returns the memory (in bytes) currently used by all cached nodes.
+     *
+     * This includes both the color and depth/stencil attachments of each
+     * resident offscreen buffer.
+     *
+     * @return the memory (in bytes) currently used by all cached nodes.
+     */
+    static size_t getMemoryUsage() { return _usage; }
+
+    /**
+     * Releases the offscreen buffers of all cached nodes.
+     *
+     * This is the appropriate response to a low-memory warning. Each node
+     * will redraw its cache the next time that it is rendered.
+     */
+    static void purgeAll();
+
+#pragma mark -
+#pragma mark Rendering
+    /**
+     * Draws this node and all of its children with the given SpriteBatch.
+     *
+     * If the cache is valid, this draws the cached texture as a single quad.
+     * Otherwise, it redraws the subtree into the cache first. If the cache
+     * cannot be allocated within the memory budget, this method renders
+     * the children directly, like {@link SceneNode#render}.
+     *
+     * A deferred sprite batch records a valid cache as a single quad. But
+     * the cache can only be redrawn on the OpenGL thread. So if the cache is
+     * stale, this method renders the children directly into the deferred
+     * batch, and queues this node for {@link #refreshPending}.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the node color.
+     */
+    virtual void render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) override;
+
+    /**
+     * Draws this node and all of its children with the given SpriteBatch.
+     *
+     * If the cache is valid, this draws the cached texture as a single quad.
+     * Otherwise, it redraws the subtree into the cache first. If the cache
+     * cannot be allocated within the memory budget, this method renders
+     * the children directly, like {@link SceneNode#render}.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     */
+    virtual void render(const std::shared_ptr<SpriteBatch>& batch) override {
+        render(batch,Mat4::IDENTITY,Color4::WHITE);
+    }
+
+    /**
+     * Redraws the caches that were recorded stale into a deferred batch.
+     *
+     * A deferred batch cannot redraw a cache, so stale caches are queued
+     * until the OpenGL thread calls this method. {@link Scene2#render} calls
+     * it before each parallel pass, so most applications do not need to
+     * call it directly.
+     *
+     * This method must be called on the OpenGL thread in the middle of a
+     * sprite batch pass, and not while any deferred batch is recording.
+     *
+     * @param batch The SpriteBatch to draw with.
+     */
+    static void refreshPending(const std::shared_ptr<SpriteBatch>& batch);
+
+protected:
+    /**
+     * Records that a descendant of this node has changed its appearance.
+     *
+     * This invalidates the cache and passes the notification on to the
+     * ancestors of this node (which may be cached as well).
+     */
+    virtual void setChildDirty() override;
+
+    /**
+     * Redraws the subtree of this node into the offscreen buffer.
+     *
+     * The buffer is sized to match the screen resolution at the given world
+     * scale. This method will (re)allocate the buffer if necessary, evicting
+     * other caches to stay within the memory budget. It returns false if
+     * the buffer could not be allocated.
+     *
+     * The children are normally drawn untinted, and the cache is tinted when
+     * it is drawn. But if a descendant ignores the color of its parent, that
+     * would tint the descendant. In that case the children are drawn with the
+     * given tint instead, and the cache is stale whenever the tint changes.
+     *
+     * This method must be called in the middle of a sprite batch pass. It
+     * will end that pass and restart it when done.
+     *
+     * @param batch The SpriteBatch to draw with.
+     * @param scale The world scale of this node
+     * @param tint  The tint passed to the children of this node
+     *
+     * @return true if the cache was successfully redrawn.
+     */
+    bool refresh(const std::shared_ptr<SpriteBatch>& batch, float scale, Color4 tint);
+
+    /**
+     * Evicts least recently drawn caches until the given bytes will fit.
+     *
+     * This method never evicts the cache of the given node. It returns
+     * false if the bytes will not fit even after all evictions.
+     *
+     * @param bytes     The number of bytes to make room for
+     * @param keep      A node whose cache should not be evicted
+     *
+     * @return true if the given bytes fit within the budget
+     */
+    static bool reserve(size_t bytes, const CachedNode* keep);
+
+    /** This macro disables the copy constructor (not allowed on scene graphs) */
+    CU_DISALLOW_COPY_AND_ASSIGN(CachedNode);
+};
+    }
+
+}
+#endif /* __CU_CACHED_NODE_H__ */
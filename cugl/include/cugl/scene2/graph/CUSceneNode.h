@@ -980,7 +980,7 @@ public:
      *
      * @param color the color tinting this node.
      */
-    virtual void setColor(Color4 color) { _tintColor = color; }
+    virtual void setColor(Color4 color) { _tintColor = color; markDirty(); }
 
     /**
      * Returns the absolute color tinting this node.
@@ -1013,7 +1013,9 @@ public:
      *
      * @param visible   true if the node is visible.
      */
-    void setVisible(bool visible) { _isVisible = visible; }
+    void setVisible(bool visible) {
+        if (_isVisible != visible) { _isVisible = visible; markDirty(); }
+    }
     
     /**
      * Returns true if this node is tinted by its parent.
@@ -1035,7 +1037,7 @@ public:
      *
      * @param flag  Whether this node is tinted by its parent.
      */
-    void setRelativeColor(bool flag) { _hasParentColor = flag; }
+    void setRelativeColor(bool flag) { _hasParentColor = flag; markDirty(); }
     
     /**
      * Returns the scissor associated with this node.
@@ -1091,7 +1093,7 @@ public:
      *
      * @param scissor   The scissor associated with this node.
      */
-    void setScissor(const std::shared_ptr<Scissor>& scissor) { _scissor = scissor;}
+    void setScissor(const std::shared_ptr<Scissor>& scissor) { _scissor = scissor; markDirty(); }
 
     /**
      * Sets a content-bounded scissor associated with this node.
@@ -1115,7 +1117,7 @@ public:
      * of the same orientation. The rule for this intersection will
      * be the same as {@link Scissor#intersect}.
      */
-    void setScissor() { _scissor = Scissor::alloc(getContentSize());}
+    void setScissor() { _scissor = Scissor::alloc(getContentSize()); markDirty(); }
 
     
 #pragma mark -
@@ -1983,6 +1985,25 @@ public:
      */
     virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {}
     
+    /**
+     * Marks the appearance of this node as changed.
+     *
+     * This method notifies every ancestor of this node that a descendant
+     * has changed. It has no effect on a normal scene graph. However, any
+     * {@link CachedNode} ancestor will discard its offscreen image and
+     * redraw its subtree on the next render pass.
+     *
+     * All of the setters in the scene graph classes that alter the
+     * appearance of a node call this method automatically. You only need
+     * to call it if you write a custom node whose draw method depends on
+     * state that it does not expose through those setters.
+     */
+    void markDirty() {
+        if (_parent != nullptr) {
+            _parent->setChildDirty();
+        }
+    }
+    
     
 #pragma mark -
 #pragma mark Layout Automation
@@ -2024,6 +2045,21 @@ public:
      */
     virtual void doLayout();
 
+protected:
+    /**
+     * Records that a descendant of this node has changed its appearance.
+     *
+     * The default implementation simply passes the notification on to the
+     * parent of this node. Subclasses that cache the rendering of their
+     * children (such as {@link CachedNode}) should override this method to
+     * invalidate that cache, and then call the parent version.
+     */
+    virtual void setChildDirty() {
+        if (_parent != nullptr) {
+            _parent->setChildDirty();
+        }
+    }
+
 private:
 #pragma mark -
 #pragma mark Internal Helpers
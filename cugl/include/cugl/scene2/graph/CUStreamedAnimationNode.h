@@ -0,0 +1,399 @@
+//
+//  CUStreamedAnimationNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a filmstrip node for long animations.  Instead of
+//  keeping every frame resident in a single sprite sheet, this node decodes
+//  frames from a {@link Filmstrip} on a worker thread, and uploads them into
+//  a small ring of textures just before they are shown.  Hence the memory
+//  used by the animation depends on the size of the ring, and not on the
+//  number of frames.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#ifndef __CU_STREAMED_ANIMATION_NODE_H__
+#define __CU_STREAMED_ANIMATION_NODE_H__
+
+#include <cugl/scene2/graph/CUAnimationNode.h>
+#include <cugl/render/CUFilmstrip.h>
+#include <cugl/util/CUThreadPool.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+/** The default number of frames decoded ahead of the active frame */
+#define STREAM_RING_SIZE    3
+
+namespace cugl {
+
+    /**
+     * The classes to construct an 2-d scene graph.
+     *
+     * This namespace was chosen to future-proof the game engine. We will
+     * eventually want to add 3-d scene graphs as well, and this namespace
+     * will prevent any collisions with those scene graph nodes.
+     */
+    namespace scene2 {
+
+#pragma mark -
+#pragma mark StreamedAnimationNode
+
+/**
+ * Class to support film strip animation streamed from a {@link Filmstrip}.
+ *
+ * This class has the same interface as {@link AnimationNode}, so it can be
+ * used anywhere that an animation node is expected.  The difference is that
+ * the frames do not come from a sprite sheet.  Instead, a worker thread
+ * decodes the frames that follow the active one into a ring of buffers.
+ * When {@link setFrame} is called, the buffer for that frame is uploaded to
+ * the next texture in a ring of textures, and the worker starts on the next
+ * frame in its place.  Only one frame is uploaded per call.
+ *
+ * The decoder assumes that the frames are played in order (wrapping around
+ * at the end).  Setting any other frame restarts the decoder at that frame.
+ * If the worker has not finished the requested frame when it is set, this
+ * node continues to show the previous frame.  Hence a slow decoder drops
+ * frames rather than stalling the game.
+ *
+ * If this node is not given a filmstrip, it behaves exactly like its parent
+ * class, treating its texture as a sprite sheet.
+ *
+ * This node has a single rectangular polygon the size of a frame.  Do NOT
+ * change the polygon, as that will interfere with the animation.
+ */
+class StreamedAnimationNode : public AnimationNode {
+#pragma mark Values
+protected:
+    /** A decoded frame waiting to be uploaded */
+    class Buffer {
+    public:
+        /** The RGBA pixels of the frame */
+        std::vector<Uint8> pixels;
+        /** The decoder generation and frame stored in pixels (written last) */
+        std::atomic<Uint64> tag;
+    };
+
+    /** The filmstrip to stream (nullptr if this is a sprite sheet) */
+    std::shared_ptr<Filmstrip> _filmstrip;
+    /** The worker thread decoding the frames */
+    std::shared_ptr<ThreadPool> _decoder;
+    /** The ring of textures receiving the decoded frames */
+    std::vector<std::shared_ptr<Texture>> _textures;
+    /** The ring of buffers for the frames being decoded */
+    std::unique_ptr<Buffer[]> _buffers;
+    /** The number of buffers (and textures) in the ring */
+    size_t _ring;
+    /** The texture showing the displayed frame */
+    size_t _current;
+    /** The frame currently shown by this node */
+    int _displayed;
+    /** The frames being decoded, in order, with their buffers */
+    std::deque<std::pair<int,size_t>> _pending;
+    /** The decoder generation, incremented whenever the decoder restarts */
+    std::atomic<Uint32> _generation;
+
+    /** The frame most recently decoded by the worker (worker only) */
+    std::vector<Uint8> _canvas;
+    /** The frame stored in the canvas (worker only) */
+    Sint32 _decoded;
+
+#pragma mark -
+#pragma mark Constructors
+public:
+    /**
+     * Constructs a StreamedAnimationNode with no filmstrip
+     *
+     * You must initialize this object before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    StreamedAnimationNode();
+
+    /**
+     * Releases all resources allocated with this node.
+     *
+     * This will stop the decoder, and release the ring of textures.
+     */
+    ~StreamedAnimationNode() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed StreamedAnimationNode can be safely reinitialized. This
+     * method blocks until the worker thread has finished its current frame.
+     *
+     * It is unsafe to call this on a node that is still currently inside of
+     * a scene graph.
+     */
+    virtual void dispose() override;
+
+    /** Sprite sheet initializers from {@link AnimationNode} */
+    using AnimationNode::initWithFilmstrip;
+
+    /**
+     * Initializes the node to stream the given filmstrip.
+     *
+     * The ring size is the number of frames decoded ahead of the active frame.
+     * This node allocates that many textures and decode buffers, each the size
+     * of a single frame.  A ring of 2 or 3 is enough when the frames are
+     * played in order.
+     *
+     * The size of the node is equal to the size of a single frame. To resize
+     * the node, scale it up or down.
+     *
+     * @param filmstrip The filmstrip to stream
+     * @param ring      The number of frames to decode ahead
+     *
+     * @return true if the node is initialized properly, false otherwise.
+     */
+    bool initWithFilmstrip(const std::shared_ptr<Filmstrip>& filmstrip, int ring=STREAM_RING_SIZE) {
+        return initWithFilmstrip(filmstrip, ring, 0);
+    }
+
+    /**
+     * Initializes the node to stream the given filmstrip.
+     *
+     * The ring size is the number of frames decoded ahead of the active frame.
+     * This node allocates that many textures and decode buffers, each the size
+     * of a single frame.  A ring of 2 or 3 is enough when the frames are
+     * played in order.
+     *
+     * The initial frame is decoded immediately, on the calling thread.
+     *
+     * The size of the node is equal to the size of a single frame. To resize
+     * the node, scale it up or down.
+     *
+     * @param filmstrip The filmstrip to stream
+     * @param ring      The number of frames to decode ahead
+     * @param frame     The initial frame
+     *
+     * @return true if the node is initialized properly, false otherwise.
+     */
+    bool initWithFilmstrip(const std::shared_ptr<Filmstrip>& filmstrip, int ring, int frame);
+
+    /**
+     * Initializes a node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}.  This JSON format supports all
+     * of the attribute values of its parent class.  In addition, it supports
+     * the following additional attributes:
+     *
+     *      "source":   The path to the filmstrip, relative to the asset directory
+     *      "ring":     The number of frames to decode ahead
+     *      "fallback": The path to a sprite sheet, relative to the asset directory
+     *
+     * If there is no source, or the source cannot be read, this node falls
+     * back to the sprite sheet attributes of {@link AnimationNode}.  If there
+     * is a fallback, that sprite sheet is loaded in place of the "texture"
+     * attribute.  As it is only loaded when the filmstrip fails, it does not
+     * need to be kept in the asset manager.  The attribute "frame" is supported
+     * in both cases.
+     *
+     * @param loader    The scene loader passing this JSON file
+     * @param data      The JSON object specifying the node
+     *
+     * @return true if initialization was successful.
+     */
+    virtual bool initWithData(const Scene2Loader* loader, const std::shared_ptr<JsonValue>& data) override;
+
+
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated node streaming the given filmstrip.
+     *
+     * The ring size is the number of frames decoded ahead of the active frame.
+     * This node allocates that many textures and decode buffers, each the size
+     * of a single frame.  A ring of 2 or 3 is enough when the frames are
+     * played in order.
+     *
+     * The size of the node is equal to the size of a single frame. To resize
+     * the node, scale it up or down.
+     *
+     * @param filmstrip The filmstrip to stream
+     * @param ring      The number of frames to decode ahead
+     *
+     * @return a newly allocated node streaming the given filmstrip.
+     */
+    static std::shared_ptr<StreamedAnimationNode> alloc(const std::shared_ptr<Filmstrip>& filmstrip,
+                                                        int ring=STREAM_RING_SIZE) {
+        std::shared_ptr<StreamedAnimationNode> node = std::make_shared<StreamedAnimationNode>();
+        return (node->initWithFilmstrip(filmstrip,ring) ? node : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated node with the given JSON specificaton.
+     *
+     * This initializer is designed to receive the "data" object from the
+     * JSON passed to {@link Scene2Loader}.  This JSON format supports all
+     * of the attribute values of its parent class.  In addition, it supports
+     * the following additional attributes:
+     *
+     *      "source":   The path to the filmstrip, relative to the asset directory
+     *      "ring":     The number of frames to decode ahead
+     *      "fallback": The path to a sprite sheet, relative to the asset directory
+     *
+     * If there is no source, or the source cannot be read, this node falls
+     * back to the sprite sheet attributes of {@link AnimationNode}.  If there
+     * is a fallback, that sprite sheet is loaded in place of the "texture"
+     * attribute.  As it is only loaded when the filmstrip fails, it does not
+     * need to be kept in the asset manager.  The attribute "frame" is supported
+     * in both cases.
+     *
+     * @param loader    The scene loader passing this JSON file
+     * @param data      The JSON object specifying the node
+     *
+     * @return a newly allocated node with the given JSON specificaton.
+     */
+    static std::shared_ptr<SceneNode> allocWithData(const Scene2Loader* loader,
+                                                    const std::shared_ptr<JsonValue>& data) {
+        std::shared_ptr<StreamedAnimationNode> result = std::make_shared<StreamedAnimationNode>();
+        if (!result->initWithData(loader,data)) { result = nullptr; }
+        return std::dynamic_pointer_cast<SceneNode>(result);
+    }
+
+
+#pragma mark -
+#pragma mark Attribute Accessors
+    /**
+     * Returns the filmstrip streamed by this node.
+     *
+     * This method returns nullptr if this node is animating a sprite sheet.
+     *
+     * @return the filmstrip streamed by this node.
+     */
+    const std::shared_ptr<Filmstrip>& getFilmstrip() const { return _filmstrip; }
+
+    /**
+     * Returns the number of frames decoded ahead of the active frame.
+     *
+     * @return the number of frames decoded ahead of the active frame.
+     */
+    size_t getRingSize() const { return _ring; }
+
+    /**
+     * Returns the frame currently shown by this node.
+     *
+     * This is the same as {@link getFrame} unless the decoder has fallen
+     * behind, in which case it is an earlier frame.
+     *
+     * @return the frame currently shown by this node.
+     */
+    int getDisplayedFrame() const;
+
+    /**
+     * Sets the active frame as the given index.
+     *
+     * If the frame has been decoded, it is uploaded to the next texture in
+     * the ring, and the decoder starts on the next frame in its place. If
+     * not, this node keeps showing the previous frame.  If the frame is not
+     * one of the frames being decoded, the decoder restarts at this frame.
+     *
+     * If the frame index is invalid, an error is raised.  However, if this
+     * node has fallen back to a sprite sheet, the index is clamped to the
+     * frames of that sheet instead.
+     *
+     * @param frame the index to make the active frame
+     */
+    virtual void setFrame(int frame) override;
+
+#pragma mark -
+#pragma mark Internal Helpers
+protected:
+    /**
+     * Returns the tag identifying the given frame in the current generation.
+     *
+     * @param frame The frame index
+     *
+     * @return the tag identifying the given frame in the current generation.
+     */
+    Uint64 tagFrame(int frame) const {
+        return ((Uint64)_generation.load() << 32) | (Uint32)frame;
+    }
+
+    /**
+     * Allocates the texture ring and starts decoding the given filmstrip.
+     *
+     * The initial frame is decoded immediately and uploaded to the first
+     * texture.  This method does not set the texture or polygon of this node.
+     *
+     * @param filmstrip The filmstrip to stream
+     * @param ring      The number of frames to decode ahead
+     * @param frame     The initial frame
+     *
+     * @return true if the initial frame was decoded.
+     */
+    bool startStream(const std::shared_ptr<Filmstrip>& filmstrip, int ring, int frame);
+
+    /**
+     * Asks the worker thread to decode the given frame into the given buffer.
+     *
+     * @param frame     The frame to decode
+     * @param buffer    The index of the buffer to receive the frame
+     */
+    void request(int frame, size_t buffer);
+
+    /**
+     * Decodes the given frame into the given buffer.
+     *
+     * This method is executed on the worker thread.  It does nothing if the
+     * decoder has restarted since the frame was requested.
+     *
+     * @param frame     The frame to decode
+     * @param buffer    The index of the buffer to receive the frame
+     * @param tag       The tag of the frame when it was requested
+     */
+    void decode(int frame, size_t buffer, Uint64 tag);
+
+    /**
+     * Restarts the decoder at the given frame.
+     *
+     * Any frames previously requested are discarded.
+     *
+     * @param frame The frame to decode first
+     */
+    void restart(int frame);
+
+    /**
+     * Uploads the next pending frame if it is the active frame and is ready.
+     *
+     * @return true if the frame was uploaded
+     */
+    bool upload();
+};
+    }
+}
+
+#endif /* __CU_STREAMED_ANIMATION_NODE_H__ */
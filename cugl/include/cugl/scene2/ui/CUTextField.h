@@ -115,8 +115,10 @@ protected:
 #pragma mark Values
     /** The current cursor rectangle, */
     Rect _cursor;
-    /** Timer for blinking the cursor. */
-    int _cursorBlink;
+    /** Whether the blinking cursor is currently shown */
+    bool _cursorShown;
+    /** The scheduled callback that blinks the cursor (0 if none) */
+    Uint32 _blinkKey;
     /** Cursor position indexed from the end of text. 0 means the end. */
     int _cursorIndex;
     /** Actual length of text, used to accelerate cursor placement. */
@@ -612,6 +614,20 @@ protected:
      */
     void updateCursor();
 
+    /**
+     * Shows the cursor and restarts the blink timer.
+     *
+     * The cursor blinks on a timer scheduled with the {@link Application},
+     * not in {@link draw}.  That way this node is only marked dirty when the
+     * cursor actually changes, and it still blinks inside a cached subtree.
+     */
+    void restartBlink();
+
+    /**
+     * Hides the cursor and stops the blink timer.
+     */
+    void stopBlink();
+
     /**
      * Moves the cursor one word forward or backward.
      *
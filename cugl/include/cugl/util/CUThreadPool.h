@@ -6,6 +6,13 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  The pool is a work-stealing scheduler.  Each worker has its own task deque,
+//  and idle workers steal from the others, so fine-grained tasks do not all
+//  contend for a single lock.  Tasks are stored without heap allocation when
+//  they are small enough.  Tasks may be collected in a group, which can be
+//  waited on, or which can start other tasks when it finishes.  A thread that
+//  waits on a group executes tasks while it waits.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -39,7 +46,14 @@
 #include <condition_variable>
 #include <functional>
 #include <stdio.h>
-#include <queue>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <thread>
 
@@ -50,55 +64,314 @@
 
 namespace cugl {
 
+#pragma mark -
+#pragma mark Task
+/**
+ * A void function with no parameters, stored without a heap allocation.
+ *
+ * This class is like std::function<void()>, except that it can only be
+ * moved, and it stores any function object of at most {@link CAPACITY}
+ * bytes (such as a lambda with a few captures) inside the task itself.
+ * Only larger function objects are copied to the heap.
+ */
+class Task {
+public:
+    /** The largest function object stored without a heap allocation */
+    static const size_t CAPACITY = 48;
+
+private:
+    /** The storage for the function object (or a pointer to it) */
+    alignas(std::max_align_t) unsigned char _data[CAPACITY];
+    /** Calls the stored function object */
+    void (*_invoke)(void* data);
+    /** Moves the stored function object to dst (or destroys it if dst is nullptr) */
+    void (*_manage)(void* dst, void* src);
+
+    /** The operations for a function object stored in the task */
+    template <typename F>
+    struct Local {
+        static void invoke(void* data) {
+            (*reinterpret_cast<F*>(data))();
+        }
+        static void manage(void* dst, void* src) {
+            F* func = reinterpret_cast<F*>(src);
+            if (dst != nullptr) {
+                new (dst) F(std::move(*func));
+            }
+            func->~F();
+        }
+    };
+
+    /** The operations for a function object stored on the heap */
+    template <typename F>
+    struct Remote {
+        static void invoke(void* data) {
+            (**reinterpret_cast<F**>(data))();
+        }
+        static void manage(void* dst, void* src) {
+            F** func = reinterpret_cast<F**>(src);
+            if (dst != nullptr) {
+                *reinterpret_cast<F**>(dst) = *func;
+            } else {
+                delete *func;
+            }
+        }
+    };
+
+    /**
+     * Moves the function of the given task into this one.
+     *
+     * This task must be empty.  The given task is empty afterwards.
+     *
+     * @param other The task to move
+     */
+    void take(Task& other) {
+        _invoke = other._invoke;
+        _manage = other._manage;
+        if (_manage != nullptr) {
+            _manage(_data, other._data);
+        }
+        other._invoke = nullptr;
+        other._manage = nullptr;
+    }
+
+public:
+    /**
+     * Creates an empty task.
+     */
+    Task() : _invoke(nullptr), _manage(nullptr) {}
+
+    /**
+     * Creates a task for the given function object.
+     *
+     * The function object is stored in the task if it is at most
+     * {@link CAPACITY} bytes, and on the heap otherwise.
+     *
+     * @param func  The function object
+     */
+    template <typename F, typename = typename std::enable_if<
+              !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F&& func) {
+        typedef typename std::decay<F>::type Func;
+        if constexpr (sizeof(Func) <= CAPACITY && alignof(Func) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible<Func>::value) {
+            new (_data) Func(std::forward<F>(func));
+            _invoke = &Local<Func>::invoke;
+            _manage = &Local<Func>::manage;
+        } else {
+            *reinterpret_cast<Func**>(_data) = new Func(std::forward<F>(func));
+            _invoke = &Remote<Func>::invoke;
+            _manage = &Remote<Func>::manage;
+        }
+    }
+
+    /**
+     * Creates a task with the function of the given task.
+     *
+     * The given task is empty afterwards.
+     *
+     * @param other The task to move
+     */
+    Task(Task&& other) noexcept { take(other); }
+
+    /**
+     * Deletes this task and its function object.
+     */
+    ~Task() { reset(); }
+
+    /**
+     * Assigns this task the function of the given task.
+     *
+     * The given task is empty afterwards.
+     *
+     * @param other The task to move
+     *
+     * @return this task, after assignment
+     */
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    /**
+     * Deletes the function object, making this task empty.
+     */
+    void reset() {
+        if (_manage != nullptr) {
+            _manage(nullptr, _data);
+        }
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    /**
+     * Returns true if this task has a function.
+     *
+     * @return true if this task has a function.
+     */
+    explicit operator bool() const { return _invoke != nullptr; }
+
+    /**
+     * Calls the function of this task.
+     *
+     * The task must not be empty.
+     */
+    void operator()() { _invoke(_data); }
+
+    /** Tasks cannot be copied */
+    Task(const Task&) = delete;
+    /** Tasks cannot be copied */
+    Task& operator=(const Task&) = delete;
+};
+
+#pragma mark -
+#pragma mark Task Group
+class ThreadPool;
+
+/**
+ * A counter of the unfinished tasks added to a thread pool.
+ *
+ * Tasks are added to a group with {@link ThreadPool#addTask(TaskGroup&,Task)}.
+ * A group is done when all of its tasks have finished.  Use the method
+ * {@link ThreadPool#wait} to block until a group is done, and the method
+ * {@link ThreadPool#after} to start a task once a group is done.  Hence a
+ * group acts as the dependency counter for its successors.
+ *
+ * A group may be reused once it is done.  It must not be deleted while it
+ * has unfinished tasks or successors.  Call {@link ThreadPool#wait} before
+ * deleting a group, even if {@link #isDone} is already true, as the last
+ * task may still be releasing the group.
+ */
+class TaskGroup {
+private:
+    /** The number of unfinished tasks (plus unstarted successors) */
+    std::atomic<Uint32> _pending;
+    /** A mutex lock for the successors */
+    std::mutex _mutex;
+    /** The tasks to start when this group is done, with their groups */
+    std::vector<std::pair<Task,TaskGroup*>> _successors;
+
+    friend class ThreadPool;
+
+public:
+    /**
+     * Creates a group with no tasks.
+     */
+    TaskGroup() : _pending(0) {}
+
+    /**
+     * Returns true if every task in this group has finished.
+     *
+     * @return true if every task in this group has finished.
+     */
+    bool isDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * Returns the number of unfinished tasks in this group.
+     *
+     * A task added with {@link ThreadPool#after} counts as unfinished in its
+     * group as soon as it is added, even though it has not started.
+     *
+     * @return the number of unfinished tasks in this group.
+     */
+    Uint32 getPending() const { return _pending.load(std::memory_order_acquire); }
+
+    /** Groups cannot be copied */
+    TaskGroup(const TaskGroup&) = delete;
+    /** Groups cannot be copied */
+    TaskGroup& operator=(const TaskGroup&) = delete;
+};
+
 #pragma mark -
 #pragma mark Thread Pool
 
 /**
  *  Class to providing a collection of worker threads.
  *
- *  This is a general purpose class for performing tasks asynchronously.  There 
- *  is no notification process for when a task is complete.  Instead, your task 
- *  should either set a flag, or execute a callback when it is done.
+ *  This is a general purpose class for performing tasks asynchronously.  A
+ *  task added on its own has no notification for when it is complete.  Your
+ *  task should either set a flag, or execute a callback when it is done.
+ *  Alternatively, add the task to a {@link TaskGroup} and wait on the group.
+ *
+ *  The pool is a work-stealing scheduler.  Each worker has its own deque of
+ *  tasks.  A task in a {@link TaskGroup} added by a worker goes on the back
+ *  of its own deque, and the worker takes its next task from the back as
+ *  well, so related tasks run together while their data is still in cache.
+ *  Every other task (one added by another thread, or one added without a
+ *  group) goes on a shared queue, which is processed in order.  A worker
+ *  with no tasks of its own takes from the shared queue, and then steals
+ *  from the front of the other deques.  Hence a pool with a single worker
+ *  runs the tasks added without a group in the order they are added, even
+ *  when a task adds more tasks.
+ *
+ *  A thread that calls {@link #wait} or {@link #parallel_for} executes tasks
+ *  of this pool while it waits, instead of sleeping.  So the caller counts
+ *  as an extra worker, and waiting from inside a task cannot deadlock.
  *
  *  There are some important safety considerations for using this class over
- *  direct thread objects. For example, stopping a thread pool does not shut it 
- *  down immediately; it just marks it for shutdown.  Because of mutex locks, 
- *  it is not safe to delete a thread pool until it is completely shutdown.
+ *  direct thread objects. For example, stopping a thread pool discards any
+ *  task that has not started, and blocks until the running tasks finish.  It
+ *  is not safe to delete a thread pool until it is completely shutdown.
  *
  *  More importantly, we do not allow for detached threads. This makes no sense
- *  in this application, because the threads share a resource (_taskQueue) with 
- *  the main thread that will be deleted.  It is therefore unsafe for the 
+ *  in this application, because the threads share a resource (the task deques)
+ *  with the main thread that will be deleted.  It is therefore unsafe for the
  *  threads to ever detach.
  *
- *  See the class {@link AssetManager} for an example of how to use a thread 
+ *  See the class {@link AssetManager} for an example of how to use a thread
  *  pool.
  */
 class ThreadPool {
 private:
+    /** A task waiting in a deque, with the group it belongs to */
+    struct Job {
+        /** The task to execute */
+        Task task;
+        /** The group of the task (or nullptr) */
+        TaskGroup* group;
+    };
+
+    /** A task deque, guarded by its own lock */
+    struct Queue {
+        /** A mutex lock for the deque */
+        std::mutex mutex;
+        /** The tasks waiting to be executed */
+        std::deque<Job> jobs;
+    };
+
     /** The individual worker threads for this thread pool */
 #ifdef CU_SDL_THREADS
     std::vector<SDL_Thread*> _workers;
 #else
     std::vector<std::thread> _workers;
 #endif
-    
-    /** Tasks waiting to be assigned to a thread */
-    std::queue< std::function<void()> > _taskQueue;
-    
-    /** A mutex lock for the task queue */
-    std::mutex _queueMutex;
-    /** A condition variable to manage tasks waiting for a worker */
+
+    /** The worker deques, followed by the shared queue for other threads */
+    std::vector<std::unique_ptr<Queue>> _queues;
+    /** The number of tasks waiting in all of the deques */
+    std::atomic<Uint32> _queued;
+
+    /** A mutex lock for sleeping threads */
+    std::mutex _sleepMutex;
+    /** A condition variable to wake threads waiting for a task or a group */
     std::condition_variable _taskCondition;
-    
+    /** The number of threads sleeping on the condition variable */
+    std::atomic<Uint32> _sleeping;
+
     /** Whether or not the thread pool has been marked for shutdown */
-    bool _stop;
+    std::atomic<bool> _stop;
+    /** The number of child threads that have claimed a worker position */
+    std::atomic<int> _started;
     /** The number of child threads that are completed */
-    int _complete;
-    
+    std::atomic<int> _complete;
+
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.  
+     * This function pulls tasks from the deques until the pool is stopped.
      *
      * This implementation is safe to use with std::thread.
      */
@@ -107,13 +380,84 @@ private:
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.
+     * This function pulls tasks from the deques until the pool is stopped.
      *
      * This static implementation uses the SDL thread API.  It should be used
      * on Android and Windows, which have special thread requirements.
      */
     static int sdlThreadFunc(void* ptr);
-    
+
+    /**
+     * Adds the given task to the appropriate deque.
+     *
+     * A task in a group goes to the worker deque if the calling thread is a
+     * worker of this pool.  All other tasks go to the shared queue, so that
+     * they keep their order.  The group must already count the task.
+     *
+     * @param task      The task to add
+     * @param group     The group of the task (or nullptr)
+     */
+    void push(Task&& task, TaskGroup* group);
+
+    /**
+     * Returns true if a task was found and executed.
+     *
+     * This method looks first at the deque of the given worker, then at the
+     * shared queue, and then steals from the other workers.
+     *
+     * @param index The worker position (or the number of workers for another thread)
+     *
+     * @return true if a task was found and executed.
+     */
+    bool runOne(size_t index);
+
+    /**
+     * Marks one task of the group as finished.
+     *
+     * If this was the last task, the successors of the group are started,
+     * and any thread waiting on the group is woken up.
+     *
+     * @param group     The group of the finished task
+     */
+    void finish(TaskGroup* group);
+
+    /**
+     * Returns the worker position of the calling thread.
+     *
+     * If the calling thread is not a worker of this pool, this method
+     * returns the position of the shared queue.
+     *
+     * @return the worker position of the calling thread.
+     */
+    size_t getIndex() const;
+
+    /**
+     * Executes the given function for every index in the range [begin,end).
+     *
+     * While the range is larger than the grain, this method adds its upper
+     * half as a new task, which splits itself in turn.  It then executes
+     * what is left on the calling thread.  Hence idle workers steal large
+     * ranges, and only the thread adding the tasks touches its own deque.
+     *
+     * @param group     the group of the new tasks
+     * @param begin     the first index
+     * @param end       the index after the last
+     * @param grain     the largest range executed without splitting
+     * @param func      the function to call with each index
+     */
+    template <typename F>
+    void split(TaskGroup& group, size_t begin, size_t end, size_t grain, const F& func) {
+        while (end-begin > grain) {
+            size_t mid = begin+(end-begin)/2;
+            addTask(group, [this, &group, mid, end, grain, &func](void) {
+                this->split(group, mid, end, grain, func);
+            });
+            end = mid;
+        }
+        for(size_t ii = begin; ii < end; ii++) {
+            func(ii);
+        }
+    }
 
 #pragma mark Constructors
 public:
@@ -122,45 +466,48 @@ public:
      *
      * You must initialize this thread pool before use.
      *
-     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool 
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool
      * on the heap, use one of the static constructors instead.
      */
-    ThreadPool() :_stop(false), _complete(0) { }
-    
+    ThreadPool() : _queued(0), _sleeping(0), _stop(false), _started(0), _complete(0) { }
+
     /**
      * Deletes this thread pool, destroying all resources.
      *
      * It is a bad idea to destroy the thread pool if the pool is not yet shut
-     * down. The task queue is shared by the child threads, so we cannot delete
-     * it until all the threads complete.  This destructor will block unti 
-     * showndown.
+     * down. The task deques are shared by the child threads, so we cannot
+     * delete them until all the threads complete.  This destructor will block
+     * until shutdown.
      */
     ~ThreadPool() { dispose(); }
-    
+
     /**
      * Disposes this thread pool, releasing all memory.
      *
-     * A disposed thread pool can be safely reinitialized. However, it is a bad 
-     * idea to destroy the thread pool if the pool is not yet shut down. The 
-     * task queue is shared by the child threads, so we cannot delete it until 
-     * all the threads complete.  This destructor will block unti showndown.
+     * A disposed thread pool can be safely reinitialized. However, it is a bad
+     * idea to destroy the thread pool if the pool is not yet shut down. The
+     * task deques are shared by the child threads, so we cannot delete them
+     * until all the threads complete.  This method will block until shutdown.
      */
     void dispose();
-    
+
     /**
      * Initializes a thread pool with the given number of threads.
      *
-     * You can specify the number of simultaneous worker threads. We find that 
+     * You can specify the number of simultaneous worker threads. We find that
      * 4 is generally a good number, even if you have a lot of tasks.  Much
      * more than the number of cores on a machine is counter-productive.
      *
+     * A pool with no threads is allowed.  Its tasks are only executed by
+     * threads that wait on the pool.
+     *
      * @param threads   the number of threads in this pool
      *
      * @return true if the threed pool is initialized properly, false otherwise.
      */
     virtual bool init(int threads = 4);
 
-    
+
 #pragma mark Static Constructors
     /**
      * Returns a newly allocated thread pool with the given number of threads.
@@ -177,41 +524,115 @@ public:
         std::shared_ptr<ThreadPool> result = std::make_shared<ThreadPool>();
         return (result->init(threads) ? result : nullptr);
     }
-    
-    
+
+
 #pragma mark Task Management
     /**
      * Adds a task to the thread pool.
      *
-     * A task is a void returning function with no parameters.  If you need 
-     * state in the task, you should use a method call for the state.  The task 
-     * will not be executed immediately, but must wait for the first available 
+     * A task is a void returning function with no parameters.  If you need
+     * state in the task, you should use a method call for the state.  The task
+     * will not be executed immediately, but must wait for the first available
      * worker.
      *
+     * Tasks added with this method start in the order they are added, even
+     * if they are added from inside another task.
+     *
      * @param  task     the task function to add to the thread pool
      */
-    void addTask(const std::function<void()> &task);
-    
+    void addTask(Task task);
+
+    /**
+     * Adds a task in the given group to the thread pool.
+     *
+     * The group counts the task as unfinished until it returns.  The task
+     * will not be executed immediately, but must wait for the first available
+     * worker (or a thread waiting on the pool).
+     *
+     * @param group     the group of the task
+     * @param task      the task function to add to the thread pool
+     */
+    void addTask(TaskGroup& group, Task task);
+
+    /**
+     * Adds a task to the thread pool once the given group is done.
+     *
+     * If the group is already done, the task is added immediately.  If the
+     * optional successor group is given, the task counts as unfinished in
+     * that group from this point on.  Hence tasks can be chained into a
+     * dependency graph, and waiting on the last group waits on the graph.
+     *
+     * @param group     the group to finish first
+     * @param task      the task function to add to the thread pool
+     * @param next      the group of the task (or nullptr)
+     */
+    void after(TaskGroup& group, Task task, TaskGroup* next=nullptr);
+
+    /**
+     * Blocks until every task of the given group has finished.
+     *
+     * The calling thread executes tasks of this pool while it waits, so it
+     * is safe to call this method from inside a task.  Those tasks are not
+     * necessarily from the given group.  If the pool is stopped, the tasks
+     * that have not started are discarded, and count as finished.
+     *
+     * @param group     the group to wait on
+     */
+    void wait(TaskGroup& group);
+
+    /**
+     * Executes the given function for every index in the range [begin,end).
+     *
+     * The range is split into chunks of at most grain indices, and each
+     * chunk is a separate task.  The calling thread executes chunks as well,
+     * and this method returns once every index has been processed.  Choose a
+     * grain large enough that each chunk does at least several microseconds
+     * of work.  The function may be called from several threads at once, and
+     * must be safe to do so.
+     *
+     * @param begin     the first index
+     * @param end       the index after the last
+     * @param grain     the number of indices in each task
+     * @param func      the function to call with each index
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, const F& func) {
+        if (end <= begin) {
+            return;
+        }
+        TaskGroup group;
+        split(group, begin, end, (grain == 0 ? 1 : grain), func);
+        wait(group);
+    }
+
+    /**
+     * Returns the number of worker threads in this pool.
+     *
+     * @return the number of worker threads in this pool.
+     */
+    size_t getThreadCount() const { return _workers.size(); }
+
     /**
      * Stop the thread pool, marking it for shut down.
      *
-     * A stopped thread pool is marked for shutdown, but it shutdown has not 
-     * necessarily completed.  Shutdown will be complete when the current child 
-     * threads have finished with their tasks.
+     * Any task that has not started is discarded, and counts as finished
+     * in its group.  So does any task added after the pool is stopped.  This
+     * method blocks until the current child threads have finished with their
+     * tasks.  Stopping a pool a second time has no effect.
      */
     void stop();
-    
+
     /**
      * Returns whether the thread pool has been stopped.
      *
      * A stopped thread pool is marked for shutdown, but it shutdown has not
-     * necessarily completed.  Shutdown will be complete when the current child 
+     * necessarily completed.  Shutdown will be complete when the current child
      * threads have finished with their tasks.
      *
      * @return whether the thread pool has been stopped.
      */
-    bool isStopped() const { return _stop; }
-    
+    bool isStopped() const { return _stop.load(); }
+
     /**
      * Returns whether the thread pool has been shut down.
      *
@@ -219,9 +640,9 @@ public:
      *
      * @return whether the thread pool has been shut down.
      */
-    bool isShutdown() const { return _workers.size() == _complete; }
-  
-private:  
+    bool isShutdown() const { return _workers.size() == (size_t)_complete.load(); }
+
+private:
     /** Copying is only allowed via shared pointer. */
     CU_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
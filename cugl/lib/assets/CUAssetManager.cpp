@@ -46,6 +46,7 @@
 //  Version: 5/20/19
 //
 #include <cugl/cugl.h>
+#include <algorithm>
 
 using namespace cugl;
 
@@ -65,6 +66,7 @@ using namespace cugl;
  */
 bool AssetManager::init() {
     _workers = ThreadPool::alloc(1);
+    _thread = std::this_thread::get_id();
     return true;
 }
 
@@ -120,6 +122,7 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
         success = loader->load(child) && success;
+        reclaim();
     }
     
     return success;
@@ -161,7 +164,7 @@ bool AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
 void AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& json,
                                 LoaderCallback callback) {
     auto it = _handlers.find(hash);
-    std::shared_ptr<BaseLoader> loader = it->second;
+    std::shared_ptr<BaseLoader> loader = (it == _handlers.end() ? nullptr : it->second);
     if (loader == nullptr) {
         if (callback) {
             Application::get()->schedule([=] {
@@ -172,9 +175,10 @@ void AssetManager::readCategory(size_t hash, const std::shared_ptr<JsonValue>& j
         return;
     }
     
+    LoaderCallback hook = budgeted(callback);
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
-        loader->loadAsync(child, callback);
+        loader->loadAsync(child, hook);
     }
 }
 
@@ -211,6 +215,155 @@ bool AssetManager::purgeCategory(size_t hash, const std::shared_ptr<JsonValue>&
     return success;
 }
 
+/**
+ * Returns the type hash for the given asset category.
+ *
+ * The asset categories are the top level keys of an asset directory,
+ * such as "textures" or "scene2s".  This method returns 0 if the
+ * category is not supported.
+ *
+ * @param category  The asset category
+ *
+ * @return the type hash for the given asset category.
+ */
+size_t AssetManager::getCategoryHash(const std::string& category) const {
+    if (category == "textures") {
+        return typeid(Texture).hash_code();
+    } else if (category == "sounds") {
+        return typeid(Sound).hash_code();
+    } else if (category == "fonts") {
+        return typeid(Font).hash_code();
+    } else if (category == "jsons") {
+        return typeid(JsonValue).hash_code();
+    } else if (category == "widgets") {
+        return typeid(WidgetValue).hash_code();
+    } else if (category == "scene2s") {
+        return typeid(scene2::SceneNode).hash_code();
+    }
+    return 0;
+}
+
+/**
+ * Restores the evicted asset for the given key, returning true on success.
+ *
+ * Restoring an asset may need the OpenGL context (to create a texture or
+ * a font atlas), so the asset is only restored immediately on the main
+ * thread.  On any other thread, the restore is scheduled for the main
+ * thread with {@link Application#schedule}, and this method returns false.
+ * If there is no running application, nothing is scheduled.
+ *
+ * @param loader    The loader for the asset
+ * @param key       The key to identify the asset
+ *
+ * @return true if the asset was restored
+ */
+bool AssetManager::restore(const std::shared_ptr<BaseLoader>& loader, const std::string& key) const {
+    if (!loader->isEvicted(key)) {
+        return false;
+    } else if (std::this_thread::get_id() == _thread) {
+        return loader->restore(key);
+    } else if (Application::get() == nullptr) {
+        return false;
+    }
+    
+    std::weak_ptr<BaseLoader> weak = loader;
+    Application::get()->schedule([=](void) {
+        std::shared_ptr<BaseLoader> source = weak.lock();
+        if (source != nullptr) {
+            source->restore(key);
+        }
+        return false;
+    });
+    return false;
+}
+
+/**
+ * Returns the compiled manifest for the given directory, if it is usable.
+ *
+ * This method returns nullptr if compiled manifests are disabled, if
+ * there is no manifest for the directory, if it is the wrong version,
+ * or if it is stale (see {@link AssetManifest#isCurrent}).  Checking for
+ * a stale manifest reads the source files, so this should be called
+ * from a worker thread when loading asynchronously.
+ *
+ * @param directory The path to the JSON asset directory
+ * @param enabled   Whether compiled manifests are enabled
+ *
+ * @return the compiled manifest for the given directory, if it is usable.
+ */
+std::shared_ptr<AssetManifest> AssetManager::readManifest(const std::string& directory, bool enabled) {
+    if (!enabled) {
+        return nullptr;
+    }
+    std::string path = AssetManifest::getCompiledPath(directory);
+    std::shared_ptr<AssetManifest> manifest = AssetManifest::allocWithAsset(path);
+    if (manifest != nullptr && !manifest->isCurrent(Application::get()->getAssetDirectory())) {
+        CUWarn("The manifest '%s' is stale; reading '%s' instead",path.c_str(),directory.c_str());
+        return nullptr;
+    }
+    return manifest;
+}
+
+/**
+ * Synchronously reads the scene graphs of a compiled manifest.
+ *
+ * The scenes are built directly from the manifest if the scene loader is
+ * a {@link Scene2Loader}.  Otherwise, the loader is given the (expanded)
+ * JSON of each scene.
+ *
+ * @param manifest  The compiled manifest
+ * @param category  The position of the scene category in the manifest
+ *
+ * @return true if all scenes were successfully loaded.
+ */
+bool AssetManager::readScenes(const std::shared_ptr<AssetManifest>& manifest, size_t category) {
+    size_t hash = typeid(scene2::SceneNode).hash_code();
+    auto it = _handlers.find(hash);
+    if (it == _handlers.end()) {
+        return false;
+    }
+    
+    std::shared_ptr<Scene2Loader> loader = std::dynamic_pointer_cast<Scene2Loader>(it->second);
+    if (loader == nullptr) {
+        return readCategory(hash,manifest->getJson(manifest->getCategoryNode(category)));
+    }
+    
+    bool success = true;
+    for(size_t ii = 0; ii < manifest->getSceneCount(); ii++) {
+        success = loader->loadScene(manifest,ii) && success;
+    }
+    return success;
+}
+
+/**
+ * Asynchronously reads the scene graphs of a compiled manifest.
+ *
+ * The scenes are built directly from the manifest if the scene loader is
+ * a {@link Scene2Loader}.  Otherwise, the loader is given the (expanded)
+ * JSON of each scene.
+ *
+ * @param manifest  The compiled manifest
+ * @param category  The position of the scene category in the manifest
+ * @param callback  An optional callback after each asset is loaded
+ */
+void AssetManager::readScenes(const std::shared_ptr<AssetManifest>& manifest, size_t category,
+                              LoaderCallback callback) {
+    size_t hash = typeid(scene2::SceneNode).hash_code();
+    auto it = _handlers.find(hash);
+    std::shared_ptr<Scene2Loader> loader = nullptr;
+    if (it != _handlers.end()) {
+        loader = std::dynamic_pointer_cast<Scene2Loader>(it->second);
+    }
+    if (loader == nullptr) {
+        readCategory(hash,manifest->getJson(manifest->getCategoryNode(category)),callback);
+        return;
+    }
+    
+    for(size_t ii = 0; ii < manifest->getSceneCount(); ii++) {
+        loader->loadSceneAsync(manifest,ii,callback);
+    }
+}
+
 /**
  * Synchronizes the asset manager to wait until all assets have finished.
  *
@@ -288,18 +441,9 @@ bool AssetManager::loadDirectory(const std::shared_ptr<JsonValue>& json) {
     bool success = true;
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
-        if (child->key() == "textures") {
-            success = readCategory(typeid(Texture).hash_code(),child) && success;
-        } else if (child->key() == "sounds") {
-            success = readCategory(typeid(Sound).hash_code(),child) && success;
-        } else if (child->key() == "fonts") {
-            success = readCategory(typeid(Font).hash_code(),child) && success;
-		} else if (child->key() == "jsons") {
-			success = readCategory(typeid(JsonValue).hash_code(), child) && success;
-		} else if (child->key() == "widgets") {
-			success = readCategory(typeid(WidgetValue).hash_code(), child) && success;
-        } else if (child->key() == "scene2s") {
-            success = readCategory(typeid(scene2::SceneNode).hash_code(),child) && success;
+        size_t hash = getCategoryHash(child->key());
+        if (hash) {
+            success = readCategory(hash,child) && success;
         } else {
             CULogError("Unknown asset category '%s'",child->key().c_str());
             success = false;
@@ -334,7 +478,12 @@ bool AssetManager::loadDirectory(const std::shared_ptr<JsonValue>& json) {
  * @return true if all assets specified in the directory were successfully loaded.
  */
 bool AssetManager::loadDirectory(const std::string& directory) {
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
+    std::shared_ptr<AssetManifest> manifest = readManifest(directory,_manifests);
+    if (manifest != nullptr) {
+        return loadManifest(manifest);
+    }
+    
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(directory));
     if (reader == nullptr) {
         CULogError("No asset directory located at '%s'",directory.c_str());
         return false;
@@ -379,18 +528,11 @@ bool AssetManager::loadDirectory(const std::string& directory) {
 void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, LoaderCallback callback) {
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
-        if (child->key() == "textures") {
-            readCategory(typeid(Texture).hash_code(),child,callback);
-        } else if (child->key() == "sounds") {
-            readCategory(typeid(Sound).hash_code(),child,callback);
-        } else if (child->key() == "fonts") {
-            readCategory(typeid(Font).hash_code(),child,callback);
-        } else if (child->key() == "jsons") {
-            readCategory(typeid(JsonValue).hash_code(),child,callback);
-        } else if (child->key() == "widgets") {
-            readCategory(typeid(WidgetValue).hash_code(),child,callback);
-        } else if (child->key() != "scene2s") {
+        size_t hash = getCategoryHash(child->key());
+        if (hash == 0) {
             CULogError("Unknown asset category '%s'",child->key().c_str());
+        } else if (child->key() != "scene2s") {
+            readCategory(hash,child,callback);
         }
     }
     
@@ -437,15 +579,29 @@ void AssetManager::loadDirectoryAsync(const std::shared_ptr<JsonValue>& json, Lo
 void AssetManager::loadDirectoryAsync(const std::string& directory, LoaderCallback callback) {
     _preload = true;
     
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
-    if (reader == nullptr && callback != nullptr) {
-        callback("",false);
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(directory));
+    if (reader == nullptr && !_manifests) {
+        if (callback != nullptr) {
+            callback("",false);
+        }
+        _preload = false;
         return;
     }
     
+    bool manifests = _manifests;
     _workers->addTask([=](void) {
-        std::shared_ptr<JsonValue> json = reader->readJson();
-        loadDirectoryAsync(json,callback);
+        std::shared_ptr<AssetManifest> manifest = readManifest(directory,manifests);
+        if (manifest != nullptr) {
+            loadManifestAsync(manifest,callback);
+        } else if (reader != nullptr) {
+            std::shared_ptr<JsonValue> json = reader->readJson();
+            loadDirectoryAsync(json,callback);
+        } else if (callback != nullptr) {
+            Application::get()->schedule([=](void) {
+                callback("",false);
+                return false;
+            });
+        }
         _preload = false;
     });
 }
@@ -464,18 +620,9 @@ bool AssetManager::unloadDirectory(const std::shared_ptr<JsonValue>& json) {
     bool success = true;
     for(int ii = 0; ii < json->size(); ii++) {
         std::shared_ptr<JsonValue> child = json->get(ii);
-        if (child->key() == "textures") {
-            success = purgeCategory(typeid(Texture).hash_code(),child) && success;
-        } else if (child->key() == "sounds") {
-            success = purgeCategory(typeid(Sound).hash_code(),child) && success;
-        } else if (child->key() == "fonts") {
-            success = purgeCategory(typeid(Font).hash_code(),child) && success;
-        } else if (child->key() == "jsons") {
-            success = purgeCategory(typeid(JsonValue).hash_code(),child) && success;
-        } else if (child->key() == "widgets") {
-            success = purgeCategory(typeid(WidgetValue).hash_code(),child) && success;
-        } else if (child->key() == "scene2s") {
-            success = purgeCategory(typeid(scene2::SceneNode).hash_code(),child) && success;
+        size_t hash = getCategoryHash(child->key());
+        if (hash) {
+            success = purgeCategory(hash,child) && success;
         } else {
             CULogError("Unknown asset category '%s'",child->key().c_str());
             success = false;
@@ -496,7 +643,12 @@ bool AssetManager::unloadDirectory(const std::shared_ptr<JsonValue>& json) {
  * @param directory The path to the JSON asset directory
  */
 bool AssetManager::unloadDirectory(const std::string& directory) {
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(directory);
+    std::shared_ptr<AssetManifest> manifest = readManifest(directory,_manifests);
+    if (manifest != nullptr) {
+        return unloadManifest(manifest);
+    }
+    
+    std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(directory));
     if (reader == nullptr) {
         CULogError("No asset directory located at '%s'",directory.c_str());
         return false;
@@ -506,6 +658,108 @@ bool AssetManager::unloadDirectory(const std::string& directory) {
     return unloadDirectory(json);
 }
 
+#pragma mark -
+#pragma mark Compiled Manifests
+/**
+ * Synchronously loads all assets in the given compiled manifest.
+ *
+ * This method is the same as {@link loadDirectory}, except that the
+ * directory has been compiled.  The asset entries are rebuilt from the
+ * manifest with no JSON parsing, and the scene graphs are built using
+ * the precomputed creation order of the manifest.
+ *
+ * This method will try to load as many assets from the manifest as it
+ * can.  If any asset fails to load, it will return false.  However, some
+ * assets may still be loaded and safe to access.
+ *
+ * @param manifest  The compiled manifest
+ *
+ * @return true if all assets specified in the manifest were successfully loaded.
+ */
+bool AssetManager::loadManifest(const std::shared_ptr<AssetManifest>& manifest) {
+    bool success = true;
+    for(size_t ii = 0; ii < manifest->getCategoryCount(); ii++) {
+        std::string category = manifest->getCategory(ii);
+        size_t hash = getCategoryHash(category);
+        if (hash == 0) {
+            CULogError("Unknown asset category '%s'",category.c_str());
+            success = false;
+        } else if (category == "scene2s") {
+            success = readScenes(manifest,ii) && success;
+        } else {
+            std::shared_ptr<JsonValue> json = manifest->getJson(manifest->getCategoryNode(ii));
+            success = readCategory(hash,json) && success;
+        }
+    }
+    return success;
+}
+
+/**
+ * Asynchronously loads all assets in the given compiled manifest.
+ *
+ * This method is the same as {@link loadDirectoryAsync}, except that the
+ * directory has been compiled.  The asset entries are rebuilt from the
+ * manifest with no JSON parsing, and the scene graphs are built using
+ * the precomputed creation order of the manifest.
+ *
+ * The optional callback function will be called each time an individual
+ * asset loads or fails to load.  However, if the entire category fails
+ * to load, the callback function will be given the asset category name
+ * (e.g. "soundfx") as the asset key.
+ *
+ * @param manifest  The compiled manifest
+ * @param callback  An optional callback after each asset is loaded
+ */
+void AssetManager::loadManifestAsync(const std::shared_ptr<AssetManifest>& manifest, LoaderCallback callback) {
+    size_t scenes = manifest->getCategoryCount();
+    for(size_t ii = 0; ii < manifest->getCategoryCount(); ii++) {
+        std::string category = manifest->getCategory(ii);
+        size_t hash = getCategoryHash(category);
+        if (hash == 0) {
+            CULogError("Unknown asset category '%s'",category.c_str());
+        } else if (category == "scene2s") {
+            scenes = ii;
+        } else {
+            std::shared_ptr<JsonValue> json = manifest->getJson(manifest->getCategoryNode(ii));
+            readCategory(hash,json,callback);
+        }
+    }
+    
+    // Scenes are read after everything else.
+    sync();
+    if (scenes < manifest->getCategoryCount()) {
+        readScenes(manifest,scenes,callback);
+    }
+}
+
+/**
+ * Unloads all assets for the given compiled manifest.
+ *
+ * This method unloads only those assets associated with the given manifest.
+ * If there are active smart pointers still referencing the assets, they
+ * still may remain in memory. However, the rest of the program can no
+ * longer access these assets.
+ *
+ * @param manifest  The compiled manifest
+ *
+ * @return true if all assets were successfully unloaded
+ */
+bool AssetManager::unloadManifest(const std::shared_ptr<AssetManifest>& manifest) {
+    bool success = true;
+    for(size_t ii = 0; ii < manifest->getCategoryCount(); ii++) {
+        std::string category = manifest->getCategory(ii);
+        size_t hash = getCategoryHash(category);
+        if (hash) {
+            std::shared_ptr<JsonValue> json = manifest->getJson(manifest->getCategoryNode(ii));
+            success = purgeCategory(hash,json) && success;
+        } else {
+            CULogError("Unknown asset category '%s'",category.c_str());
+            success = false;
+        }
+    }
+    return success;
+}
+
 #pragma mark -
 #pragma mark Progress Monitoring
 /**
@@ -548,3 +802,68 @@ size_t AssetManager::waitCount() const {
     }
     return _preload ? result+1 : result;
 }
+
+#pragma mark -
+#pragma mark Memory Residency
+/**
+ * Returns the memory footprint of all loaded assets in bytes.
+ *
+ * The footprint is an estimate of the memory used by texture data, the
+ * decoded audio samples, and the font atlases.  Other assets, such as
+ * JSON values and scene graphs, are not counted.
+ *
+ * The value returned is the sum of the footprints of all attached loaders.
+ *
+ * @return the memory footprint of all loaded assets in bytes.
+ */
+size_t AssetManager::getFootprint() const {
+    size_t result = 0;
+    for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+        result += it->second->getFootprint();
+    }
+    return result;
+}
+
+/**
+ * Evicts the least recently used assets until the footprint fits the target.
+ *
+ * Assets are evicted across all loaders, in order of their last access
+ * with {@link get}.  Assets that are in use are never evicted, so the
+ * footprint may remain above the target.  A target of 0 evicts every
+ * asset that is not in use, which is appropriate when the application
+ * is running out of memory.
+ *
+ * @param target    The target footprint in bytes
+ *
+ * @return the number of bytes freed
+ */
+size_t AssetManager::trim(size_t target) {
+    size_t footprint = getFootprint();
+    if (footprint <= target) {
+        return 0;
+    }
+    
+    // Gather the candidates from every loader so types compete fairly
+    std::vector<std::pair<BaseLoader*,BaseLoader::Resident>> candidates;
+    std::vector<BaseLoader::Resident> residents;
+    for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+        residents.clear();
+        it->second->getResidents(residents);
+        for(auto jt = residents.begin(); jt != residents.end(); ++jt) {
+            candidates.push_back(std::make_pair(it->second.get(),*jt));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<BaseLoader*,BaseLoader::Resident>& a,
+                 const std::pair<BaseLoader*,BaseLoader::Resident>& b) {
+        return a.second.stamp < b.second.stamp;
+    });
+    
+    size_t freed = 0;
+    for(auto it = candidates.begin(); it != candidates.end() && footprint-freed > target; ++it) {
+        if (it->first->evict(it->second.key)) {
+            freed += it->second.bytes;
+        }
+    }
+    return freed;
+}
@@ -0,0 +1,1289 @@
+//
+//  CUAssetManifest.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a compiled (binary) version of a JSON asset directory.
+//  An asset directory is compiled offline, so that the asset manager does not
+//  need to parse JSON when the application starts.  The compiled manifest
+//  has all widgets in the scene graphs already expanded, the widget files
+//  inlined, all strings interned, a precomputed creation order for every
+//  scene graph, and the asset dependencies of each scene graph.
+//
+//  The JSON directory remains the source of truth.  The manifest is simply
+//  a cache of it, and the asset manager falls back to the JSON directory if
+//  there is no compiled manifest, if it is the wrong version, or if its JSON
+//  sources have changed since it was compiled.
+//
+//  The binary format is a sequence of fixed-size little-endian records, so
+//  that it can be used in place (e.g. memory mapped) with no decoding.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/assets/CUAssetManifest.h>
+#include <cugl/assets/CUWidgetValue.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUStrings.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+using namespace cugl;
+
+/** The magic number at the start of every manifest */
+#define MANIFEST_MAGIC  "CUAM"
+/** The maximum depth of nested widgets (to catch widgets that use themselves) */
+#define WIDGET_DEPTH    32
+/** If the type is unknown */
+#define UNKNOWN_STR     "<unknown>"
+/** The block size for hashing a source file */
+#define STAMP_BLOCK     4096
+/** The FNV-1a offset basis (64 bit) */
+#define FNV_OFFSET      0xcbf29ce484222325ULL
+/** The FNV-1a prime (64 bit) */
+#define FNV_PRIME       0x100000001b3ULL
+
+/** The version of the binary format (increment when the format changes) */
+const Uint32 AssetManifest::VERSION = 2;
+/** The index for a missing node or string */
+const Uint32 AssetManifest::NONE = 0xFFFFFFFF;
+
+#pragma mark -
+#pragma mark Binary Records
+/**
+ * The header at the start of a manifest.
+ *
+ * The header is followed by the string offsets, the string characters, the
+ * JSON nodes, the scene graphs, the entries, the dependencies and the source
+ * files, in that order.  Each section starts on an 8 byte boundary.
+ */
+typedef struct {
+    /** The magic number (MANIFEST_MAGIC) */
+    char   magic[4];
+    /** The format version */
+    Uint32 version;
+    /** The number of interned strings */
+    Uint32 strings;
+    /** The number of JSON nodes */
+    Uint32 nodes;
+    /** The number of scene graphs */
+    Uint32 scenes;
+    /** The number of scene graph entries */
+    Uint32 entries;
+    /** The number of dependencies */
+    Uint32 edges;
+    /** The number of bytes in the string characters */
+    Uint32 chars;
+    /** The number of source files */
+    Uint32 sources;
+} ManifestHeader;
+
+/**
+ * A JSON node in a manifest.
+ *
+ * The children of a container are the nodes first to first+count-1. For
+ * a string, first is the string index. Booleans and numbers are stored in
+ * the number attribute.
+ */
+typedef struct {
+    /** The JsonValue::Type of this node */
+    Uint32 type;
+    /** The key of this node (a string index) */
+    Uint32 key;
+    /** The first child (or the string index) */
+    Uint32 first;
+    /** The number of children */
+    Uint32 count;
+    /** The boolean or numeric value */
+    double number;
+} ManifestNode;
+
+/**
+ * A scene graph in a manifest.
+ *
+ * The entries and dependencies are ranges in the global arrays.  The
+ * parent of an entry is relative to the first entry of its scene.
+ */
+typedef struct {
+    /** The scene key (a string index) */
+    Uint32 key;
+    /** The JSON node of the scene */
+    Uint32 root;
+    /** The first entry of this scene */
+    Uint32 first;
+    /** The number of entries of this scene */
+    Uint32 count;
+    /** The first dependency of this scene */
+    Uint32 edge;
+    /** The number of dependencies of this scene */
+    Uint32 edges;
+} ManifestScene;
+
+/**
+ * A source file of a manifest.
+ *
+ * These are the JSON directories and widget files that the manifest was
+ * compiled from.  They are used to detect a stale manifest.
+ */
+typedef struct {
+    /** The path relative to the asset root (a string index) */
+    Uint32 path;
+    /** Unused padding */
+    Uint32 unused;
+    /** The size of the file in bytes */
+    Uint64 size;
+    /** The FNV-1a hash of the file contents */
+    Uint64 hash;
+} ManifestSource;
+
+/**
+ * Returns the value rounded up to a multiple of 8
+ *
+ * @param value The value to round
+ *
+ * @return the value rounded up to a multiple of 8
+ */
+static size_t align8(size_t value) {
+    return (value+7) & ~((size_t)7);
+}
+
+/**
+ * Computes the size and FNV-1a hash of the given file.
+ *
+ * The file is read in blocks, and is never parsed.  This method returns
+ * false if the file cannot be read.
+ *
+ * @param path  The absolute path to the file
+ * @param size  The variable to store the file size
+ * @param hash  The variable to store the file hash
+ *
+ * @return true if the file was read successfully
+ */
+static bool stamp_file(const std::string& path, Uint64& size, Uint64& hash) {
+    SDL_RWops* stream = SDL_RWFromFile(filetool::normalize_path(path).c_str(), "rb");
+    if (!stream) {
+        return false;
+    }
+
+    Uint8 block[STAMP_BLOCK];
+    size = 0;
+    hash = FNV_OFFSET;
+    size_t amt = 0;
+    while ((amt = SDL_RWread(stream, block, 1, STAMP_BLOCK)) > 0) {
+        for(size_t ii = 0; ii < amt; ii++) {
+            hash = (hash ^ block[ii])*FNV_PRIME;
+        }
+        size += amt;
+    }
+    SDL_RWclose(stream);
+    return true;
+}
+
+#pragma mark -
+#pragma mark Manifest Compiler
+namespace cugl {
+
+/**
+ * This class compiles a JSON asset directory into manifest data.
+ *
+ * This is a single-use class that only exists while a manifest is being
+ * initialized.  The JSON directory is never modified.  The scene graphs
+ * are cloned before their widgets are expanded.
+ */
+class ManifestCompiler {
+private:
+    /** The widgets available to the scene graphs */
+    std::unordered_map<std::string,std::shared_ptr<WidgetValue>> _widgets;
+    /** The widgets declared by the compiled directory (in order) */
+    std::vector<std::pair<std::string,std::shared_ptr<JsonValue>>> _locals;
+    /** The texture keys available to the scene graphs */
+    std::unordered_set<std::string> _textures;
+    /** The font keys available to the scene graphs */
+    std::unordered_set<std::string> _fonts;
+
+    /** The interned strings */
+    std::vector<std::string> _strings;
+    /** The index of each interned string */
+    std::unordered_map<std::string,Uint32> _interned;
+
+    /** The JSON nodes in breadth-first order */
+    std::vector<ManifestNode> _nodes;
+    /** The index of each flattened JSON value */
+    std::unordered_map<const JsonValue*,Uint32> _positions;
+    /** The expanded scene graphs (kept alive until the compile completes) */
+    std::vector<std::pair<std::string,std::shared_ptr<JsonValue>>> _trees;
+
+    /** The scene graph records */
+    std::vector<ManifestScene> _scenes;
+    /** The scene graph entries */
+    std::vector<AssetManifest::Entry> _entries;
+    /** The scene graph dependencies */
+    std::vector<AssetManifest::Dependency> _depends;
+    /** The widget files read by the compiler (in order) */
+    std::vector<std::string> _files;
+    /** The source file records */
+    std::vector<ManifestSource> _sources;
+
+    /**
+     * Returns the index of the given string, interning it if necessary.
+     *
+     * @param value The string to intern
+     *
+     * @return the index of the given string, interning it if necessary.
+     */
+    Uint32 intern(const std::string& value) {
+        auto it = _interned.find(value);
+        if (it != _interned.end()) {
+            return it->second;
+        }
+        Uint32 index = (Uint32)_strings.size();
+        _strings.push_back(value);
+        _interned.emplace(value,index);
+        return index;
+    }
+
+    /**
+     * Returns the node index of the given JSON value.
+     *
+     * @param json  The JSON value (may be nullptr)
+     *
+     * @return the node index of the given JSON value.
+     */
+    Uint32 position(const std::shared_ptr<JsonValue>& json) const {
+        if (json == nullptr) {
+            return AssetManifest::NONE;
+        }
+        auto it = _positions.find(json.get());
+        return it == _positions.end() ? AssetManifest::NONE : it->second;
+    }
+
+    /**
+     * Returns a deep copy of the given JSON value.
+     *
+     * @param json  The JSON value to copy
+     *
+     * @return a deep copy of the given JSON value.
+     */
+    static std::shared_ptr<JsonValue> clone(const std::shared_ptr<JsonValue>& json) {
+        std::shared_ptr<JsonValue> result = JsonValue::alloc(json->type());
+        result->_stringValue = json->_stringValue;
+        result->_longValue   = json->_longValue;
+        result->_doubleValue = json->_doubleValue;
+        for(auto it = json->_children.begin(); it != json->_children.end(); ++it) {
+            if (json->isObject()) {
+                result->appendChild((*it)->key(),clone(*it));
+            } else {
+                result->appendChild(clone(*it));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Collects the widgets, textures and fonts of the given directory.
+     *
+     * Widgets declared by file are read with the reader.  If local is true,
+     * the widgets are also recorded to be inlined in the manifest.
+     *
+     * @param directory The JSON directory
+     * @param reader    The function to read widget files
+     * @param local     Whether this is the directory being compiled
+     *
+     * @return true if all widgets were read successfully
+     */
+    bool gather(const std::shared_ptr<JsonValue>& directory,
+                const AssetManifest::Reader& reader, bool local) {
+        std::shared_ptr<JsonValue> textures = directory->get("textures");
+        if (textures != nullptr) {
+            for(auto it = textures->_children.begin(); it != textures->_children.end(); ++it) {
+                _textures.emplace((*it)->key());
+            }
+        }
+        std::shared_ptr<JsonValue> fonts = directory->get("fonts");
+        if (fonts != nullptr) {
+            for(auto it = fonts->_children.begin(); it != fonts->_children.end(); ++it) {
+                _fonts.emplace((*it)->key());
+            }
+        }
+
+        std::shared_ptr<JsonValue> widgets = directory->get("widgets");
+        if (widgets == nullptr) {
+            return true;
+        }
+
+        bool success = true;
+        for(auto it = widgets->_children.begin(); it != widgets->_children.end(); ++it) {
+            const std::string& key = (*it)->key();
+            std::shared_ptr<JsonValue> json = *it;
+            if (json->isString()) {
+                const std::string& file = json->asString();
+                if (std::find(_files.begin(),_files.end(),file) == _files.end()) {
+                    _files.push_back(file);
+                }
+                json = reader ? reader(file) : nullptr;
+            }
+            if (json == nullptr || !json->isObject()) {
+                CULogError("Could not read widget '%s'",key.c_str());
+                success = false;
+                continue;
+            }
+            if (local) {
+                _locals.push_back(std::make_pair(key,json));
+            }
+            if (_widgets.find(key) == _widgets.end()) {
+                _widgets.emplace(key,WidgetValue::alloc(json));
+            }
+        }
+        return success;
+    }
+
+    /**
+     * Returns the given scene graph node with all widgets expanded.
+     *
+     * If the node is a widget, the result is the expansion of that widget.
+     * Otherwise the result is the node itself, with its children replaced by
+     * their expansions. The node must be owned by the compiler, as it may be
+     * modified.
+     *
+     * @param json  The scene graph node
+     * @param depth The current widget nesting depth
+     *
+     * @return the given scene graph node with all widgets expanded.
+     */
+    std::shared_ptr<JsonValue> expand(const std::shared_ptr<JsonValue>& json, int depth) {
+        std::shared_ptr<JsonValue> node = json;
+        while (node->isObject() && strtool::tolower(node->getString("type",UNKNOWN_STR)) == "widget") {
+            std::shared_ptr<JsonValue> data = node->get("data");
+            std::string source = (data == nullptr ? "" : data->getString("key",""));
+            auto it = _widgets.find(source);
+            if (it == _widgets.end()) {
+                CULogError("No widget found with name '%s'",source.c_str());
+                return nullptr;
+            } else if (depth++ > WIDGET_DEPTH) {
+                CULogError("Widget '%s' is nested too deeply",source.c_str());
+                return nullptr;
+            }
+            node = it->second->substitute(node);
+        }
+
+        std::shared_ptr<JsonValue> children = node->isObject() ? node->get("children") : nullptr;
+        if (children == nullptr) {
+            return node;
+        }
+        for(unsigned int ii = 0; ii < children->size(); ii++) {
+            std::shared_ptr<JsonValue> child = children->get(ii);
+            if (child->key() == "comment") {
+                continue;
+            }
+            std::shared_ptr<JsonValue> result = expand(child,depth);
+            if (result == nullptr) {
+                return nullptr;
+            } else if (result != child) {
+                std::string key = child->key();
+                children->removeChild(ii);
+                children->insertChild(ii,key,result);
+            }
+        }
+        return node;
+    }
+
+    /**
+     * Flattens the directory tree into JSON nodes in breadth-first order.
+     *
+     * The root of the tree is implicit, and has the given categories as its
+     * children.  As the tree is breadth-first, the children of every node
+     * are contiguous.
+     *
+     * @param categories    The categories of the directory
+     */
+    void flatten(const std::vector<std::pair<std::string,std::shared_ptr<JsonValue>>>& categories) {
+        std::vector<std::pair<Uint32,const JsonValue*>> order;
+        order.reserve(categories.size()+1);
+        order.push_back(std::make_pair(intern(""),nullptr));
+        for(auto it = categories.begin(); it != categories.end(); ++it) {
+            order.push_back(std::make_pair(intern(it->first),it->second.get()));
+        }
+
+        _nodes.reserve(order.size());
+        for(size_t ii = 0; ii < order.size(); ii++) {
+            const JsonValue* json = order[ii].second;
+            ManifestNode node;
+            node.key = order[ii].first;
+            node.first = 0;
+            node.count = 0;
+            node.number = 0;
+            if (json == nullptr) {
+                node.type  = (Uint32)JsonValue::Type::ObjectType;
+                node.first = 1;
+                node.count = (Uint32)categories.size();
+                _nodes.push_back(node);
+                continue;
+            }
+
+            _positions[json] = (Uint32)ii;
+            node.type = (Uint32)json->type();
+            switch (json->type()) {
+                case JsonValue::Type::NullType:
+                    break;
+                case JsonValue::Type::BoolType:
+                    node.number = json->_longValue ? 1 : 0;
+                    break;
+                case JsonValue::Type::NumberType:
+                    node.number = json->_doubleValue;
+                    break;
+                case JsonValue::Type::StringType:
+                    node.first = intern(json->_stringValue);
+                    break;
+                case JsonValue::Type::ArrayType:
+                case JsonValue::Type::ObjectType:
+                    node.first = (Uint32)order.size();
+                    node.count = (Uint32)json->_children.size();
+                    for(auto it = json->_children.begin(); it != json->_children.end(); ++it) {
+                        order.push_back(std::make_pair(intern((*it)->key()),it->get()));
+                    }
+                    break;
+            }
+            _nodes.push_back(node);
+        }
+    }
+
+    /**
+     * Records the entries of a scene graph node and its descendants.
+     *
+     * The entries are in preorder, so every parent comes before its children.
+     * This method also records the dependencies of the node data.
+     *
+     * @param name      The name of the scene graph node
+     * @param json      The (expanded) scene graph node
+     * @param parent    The entry of the parent, relative to the scene
+     * @param base      The first entry of the scene
+     * @param seen      The dependencies already recorded for this scene
+     */
+    void record(const std::string& name, const std::shared_ptr<JsonValue>& json,
+                Uint32 parent, size_t base, std::unordered_set<Uint64>& seen) {
+        Uint32 local = (Uint32)(_entries.size()-base);
+        AssetManifest::Entry entry;
+        entry.parent = parent;
+        entry.name   = intern(name);
+        entry.type   = intern(strtool::tolower(json->getString("type",UNKNOWN_STR)));
+        entry.data   = position(json->get("data"));
+        entry.format = position(json->get("format"));
+        entry.layout = position(json->get("layout"));
+        _entries.push_back(entry);
+
+        std::shared_ptr<JsonValue> data = json->get("data");
+        if (data != nullptr) {
+            depend(data.get(),seen);
+        }
+
+        std::shared_ptr<JsonValue> children = json->get("children");
+        if (children == nullptr) {
+            return;
+        }
+        for(auto it = children->_children.begin(); it != children->_children.end(); ++it) {
+            if ((*it)->key() != "comment") {
+                record((*it)->key(),*it,local,base,seen);
+            }
+        }
+    }
+
+    /**
+     * Adds the dependencies referenced by the given JSON value.
+     *
+     * Any string in the JSON tree that is the key of a texture or font
+     * is a dependency.
+     *
+     * @param json  The JSON value to search
+     * @param seen  The dependencies already recorded for this scene
+     */
+    void depend(const JsonValue* json, std::unordered_set<Uint64>& seen) {
+        if (json->isString()) {
+            const std::string& key = json->_stringValue;
+            const char* categories[2] = { "textures", "fonts" };
+            bool found[2] = { _textures.find(key) != _textures.end(),
+                              _fonts.find(key) != _fonts.end() };
+            for(int ii = 0; ii < 2; ii++) {
+                if (found[ii]) {
+                    AssetManifest::Dependency edge;
+                    edge.category = intern(categories[ii]);
+                    edge.key = intern(key);
+                    if (seen.emplace(((Uint64)edge.category << 32) | edge.key).second) {
+                        _depends.push_back(edge);
+                    }
+                }
+            }
+        }
+        for(auto it = json->_children.begin(); it != json->_children.end(); ++it) {
+            depend(it->get(),seen);
+        }
+    }
+
+public:
+    /**
+     * Compiles the given directory.
+     *
+     * @param directory The JSON directory to compile
+     * @param context   The other JSON directories loaded by the application
+     * @param reader    The function to read widget files
+     *
+     * @return true if the directory was compiled successfully
+     */
+    bool compile(const std::shared_ptr<JsonValue>& directory,
+                 const std::vector<std::shared_ptr<JsonValue>>& context,
+                 const AssetManifest::Reader& reader) {
+        bool success = gather(directory,reader,true);
+        for(auto it = context.begin(); it != context.end(); ++it) {
+            if (*it != nullptr && *it != directory) {
+                success = gather(*it,reader,false) && success;
+            }
+        }
+        if (!success) {
+            return false;
+        }
+
+        // Replace the widget files and scene graphs; keep everything else
+        std::vector<std::pair<std::string,std::shared_ptr<JsonValue>>> categories;
+        for(auto it = directory->_children.begin(); it != directory->_children.end(); ++it) {
+            const std::string& key = (*it)->key();
+            if (key == "widgets") {
+                std::shared_ptr<JsonValue> widgets = JsonValue::allocObject();
+                for(auto jt = _locals.begin(); jt != _locals.end(); ++jt) {
+                    widgets->appendChild(jt->first,clone(jt->second));
+                }
+                categories.push_back(std::make_pair(key,widgets));
+            } else if (key == "scene2s") {
+                std::shared_ptr<JsonValue> scenes = JsonValue::allocObject();
+                for(auto jt = (*it)->_children.begin(); jt != (*it)->_children.end(); ++jt) {
+                    std::shared_ptr<JsonValue> tree = expand(clone(*jt),0);
+                    if (tree == nullptr) {
+                        CULogError("Could not expand scene '%s'",(*jt)->key().c_str());
+                        return false;
+                    }
+                    scenes->appendChild((*jt)->key(),tree);
+                    _trees.push_back(std::make_pair((*jt)->key(),tree));
+                }
+                categories.push_back(std::make_pair(key,scenes));
+            } else {
+                categories.push_back(std::make_pair(key,*it));
+            }
+        }
+        flatten(categories);
+
+        for(auto it = _trees.begin(); it != _trees.end(); ++it) {
+            ManifestScene scene;
+            std::unordered_set<Uint64> seen;
+            scene.key   = intern(it->first);
+            scene.root  = position(it->second);
+            scene.first = (Uint32)_entries.size();
+            scene.edge  = (Uint32)_depends.size();
+            record(it->first,it->second,AssetManifest::NONE,scene.first,seen);
+            scene.count = (Uint32)(_entries.size()-scene.first);
+            scene.edges = (Uint32)(_depends.size()-scene.edge);
+            _scenes.push_back(scene);
+        }
+        return true;
+    }
+
+    /**
+     * Returns the widget files read by the compiler.
+     *
+     * These are the paths given to the reader, in the order first read.
+     *
+     * @return the widget files read by the compiler.
+     */
+    const std::vector<std::string>& getFiles() const {
+        return _files;
+    }
+
+    /**
+     * Records a source file of the compiled manifest.
+     *
+     * This must be called after {@link compile} and before {@link write}.
+     *
+     * @param path  The path relative to the asset root
+     * @param size  The size of the file in bytes
+     * @param hash  The FNV-1a hash of the file contents
+     */
+    void addSource(const std::string& path, Uint64 size, Uint64 hash) {
+        ManifestSource source;
+        source.path = intern(path);
+        source.unused = 0;
+        source.size = size;
+        source.hash = hash;
+        _sources.push_back(source);
+    }
+
+    /**
+     * Writes the compiled manifest to the given buffer.
+     *
+     * @param data  The buffer to store the manifest
+     */
+    void write(std::vector<Uint8>& data) const {
+        Uint32 chars = 0;
+        std::vector<Uint32> offsets;
+        offsets.reserve(_strings.size()+1);
+        for(auto it = _strings.begin(); it != _strings.end(); ++it) {
+            offsets.push_back(chars);
+            chars += (Uint32)it->size();
+        }
+        offsets.push_back(chars);
+
+        ManifestHeader header;
+        std::memcpy(header.magic,MANIFEST_MAGIC,4);
+        header.version = AssetManifest::VERSION;
+        header.strings = (Uint32)_strings.size();
+        header.nodes   = (Uint32)_nodes.size();
+        header.scenes  = (Uint32)_scenes.size();
+        header.entries = (Uint32)_entries.size();
+        header.edges   = (Uint32)_depends.size();
+        header.chars   = chars;
+        header.sources = (Uint32)_sources.size();
+
+        size_t pos = 0;
+        size_t size = align8(sizeof(ManifestHeader));
+        size += align8(offsets.size()*sizeof(Uint32));
+        size += align8(chars);
+        size += _nodes.size()*sizeof(ManifestNode);
+        size += _scenes.size()*sizeof(ManifestScene);
+        size += _entries.size()*sizeof(AssetManifest::Entry);
+        size += _depends.size()*sizeof(AssetManifest::Dependency);
+        size += _sources.size()*sizeof(ManifestSource);
+        data.assign(size,0);
+
+        std::memcpy(data.data(),&header,sizeof(ManifestHeader));
+        pos = align8(sizeof(ManifestHeader));
+        std::memcpy(data.data()+pos,offsets.data(),offsets.size()*sizeof(Uint32));
+        pos += align8(offsets.size()*sizeof(Uint32));
+        for(auto it = _strings.begin(); it != _strings.end(); ++it) {
+            std::memcpy(data.data()+pos,it->data(),it->size());
+            pos += it->size();
+        }
+        pos = pos-chars+align8(chars);
+        if (!_nodes.empty()) {
+            std::memcpy(data.data()+pos,_nodes.data(),_nodes.size()*sizeof(ManifestNode));
+            pos += _nodes.size()*sizeof(ManifestNode);
+        }
+        if (!_scenes.empty()) {
+            std::memcpy(data.data()+pos,_scenes.data(),_scenes.size()*sizeof(ManifestScene));
+            pos += _scenes.size()*sizeof(ManifestScene);
+        }
+        if (!_entries.empty()) {
+            std::memcpy(data.data()+pos,_entries.data(),_entries.size()*sizeof(AssetManifest::Entry));
+            pos += _entries.size()*sizeof(AssetManifest::Entry);
+        }
+        if (!_depends.empty()) {
+            std::memcpy(data.data()+pos,_depends.data(),_depends.size()*sizeof(AssetManifest::Dependency));
+            pos += _depends.size()*sizeof(AssetManifest::Dependency);
+        }
+        if (!_sources.empty()) {
+            std::memcpy(data.data()+pos,_sources.data(),_sources.size()*sizeof(ManifestSource));
+        }
+    }
+};
+
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an empty manifest.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AssetManifest::AssetManifest() :
+_scount(0),
+_ncount(0),
+_gcount(0),
+_rcount(0),
+_offsets(nullptr),
+_chars(nullptr),
+_nodes(nullptr),
+_scenes(nullptr),
+_entries(nullptr),
+_depends(nullptr),
+_sources(nullptr) {
+}
+
+/**
+ * Disposes all of the resources used by this manifest.
+ *
+ * A disposed manifest can be safely reinitialized.
+ */
+void AssetManifest::dispose() {
+    _data.clear();
+    _scount = 0;
+    _ncount = 0;
+    _gcount = 0;
+    _rcount = 0;
+    _offsets = nullptr;
+    _chars   = nullptr;
+    _nodes   = nullptr;
+    _scenes  = nullptr;
+    _entries = nullptr;
+    _depends = nullptr;
+    _sources = nullptr;
+}
+
+/**
+ * Initializes a manifest by compiling the given JSON directory.
+ *
+ * The context is the list of other JSON directories loaded by the
+ * application.  Widgets used by the scene graphs may be declared in any
+ * of these directories, and the dependencies of a scene graph may be
+ * any texture or font declared in them.  The reader is used to read
+ * the widget files.
+ *
+ * This method fails if a widget cannot be found.
+ *
+ * @param directory The JSON directory to compile
+ * @param context   The other JSON directories loaded by the application
+ * @param reader    The function to read widget files
+ *
+ * @return true if the directory was compiled successfully
+ */
+bool AssetManifest::init(const std::shared_ptr<JsonValue>& directory,
+                         const std::vector<std::shared_ptr<JsonValue>>& context,
+                         const Reader& reader) {
+    if (!_data.empty()) {
+        CUAssertLog(false, "Manifest is already initialized");
+        return false;
+    } else if (directory == nullptr || !directory->isObject()) {
+        CULogError("The asset directory is not a JSON object");
+        return false;
+    }
+
+    std::vector<Uint8> data;
+    {
+        // Release the compiler tables before validation
+        ManifestCompiler compiler;
+        if (!compiler.compile(directory,context,reader)) {
+            return false;
+        }
+        compiler.write(data);
+    }
+    return initWithData(std::move(data));
+}
+
+/**
+ * Initializes a manifest by compiling the given JSON directory.
+ *
+ * This version of the initializer records the source files of the manifest,
+ * so that a stale manifest can be detected with {@link isCurrent}.  The
+ * sources are the paths of the JSON directories (relative to root) that
+ * the manifest depends on.  The widget files read with the reader are
+ * added to the sources automatically.
+ *
+ * This method fails if a widget or a source file cannot be read.
+ *
+ * @param directory The JSON directory to compile
+ * @param context   The other JSON directories loaded by the application
+ * @param reader    The function to read widget files
+ * @param root      The asset root of the source paths
+ * @param sources   The paths of the JSON directories relative to root
+ *
+ * @return true if the directory was compiled successfully
+ */
+bool AssetManifest::init(const std::shared_ptr<JsonValue>& directory,
+                         const std::vector<std::shared_ptr<JsonValue>>& context,
+                         const Reader& reader, const std::string& root,
+                         const std::vector<std::string>& sources) {
+    if (!_data.empty()) {
+        CUAssertLog(false, "Manifest is already initialized");
+        return false;
+    } else if (directory == nullptr || !directory->isObject()) {
+        CULogError("The asset directory is not a JSON object");
+        return false;
+    }
+
+    std::vector<Uint8> data;
+    {
+        // Release the compiler tables before validation
+        ManifestCompiler compiler;
+        if (!compiler.compile(directory,context,reader)) {
+            return false;
+        }
+
+        std::vector<std::string> files = sources;
+        for(auto it = compiler.getFiles().begin(); it != compiler.getFiles().end(); ++it) {
+            if (std::find(files.begin(),files.end(),*it) == files.end()) {
+                files.push_back(*it);
+            }
+        }
+        for(auto it = files.begin(); it != files.end(); ++it) {
+            Uint64 size = 0;
+            Uint64 hash = 0;
+            if (!stamp_file(root+*it,size,hash)) {
+                CULogError("Could not read the source file '%s'",it->c_str());
+                return false;
+            }
+            compiler.addSource(*it,size,hash);
+        }
+        compiler.write(data);
+    }
+    return initWithData(std::move(data));
+}
+
+/**
+ * Initializes a manifest from the given binary data.
+ *
+ * This method fails if the data is not a manifest of the current
+ * {@link VERSION}.
+ *
+ * @param data  The manifest data
+ *
+ * @return true if the manifest was initialized successfully
+ */
+bool AssetManifest::initWithData(std::vector<Uint8>&& data) {
+    if (!_data.empty()) {
+        CUAssertLog(false, "Manifest is already initialized");
+        return false;
+    }
+    _data = std::move(data);
+    if (!validate()) {
+        dispose();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Initializes a manifest from the given file.
+ *
+ * This method fails if the file does not exist or is not a manifest of
+ * the current {@link VERSION}.
+ *
+ * @param file  The absolute path to the file
+ *
+ * @return true if the manifest was initialized successfully
+ */
+bool AssetManifest::initWithFile(const std::string& file) {
+    std::string path = filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "rb");
+    if (!stream) {
+        return false;
+    }
+
+    Sint64 size = SDL_RWsize(stream);
+    std::vector<Uint8> data;
+    if (size > 0) {
+        data.resize((size_t)size);
+        size_t total = 0;
+        while (total < data.size()) {
+            size_t amt = SDL_RWread(stream, data.data()+total, 1, data.size()-total);
+            if (amt == 0) {
+                break;
+            }
+            total += amt;
+        }
+        data.resize(total);
+    }
+    SDL_RWclose(stream);
+    return initWithData(std::move(data));
+}
+
+/**
+ * Initializes a manifest from the given asset file.
+ *
+ * The path is relative to the application asset directory. This method
+ * fails if the file does not exist or is not a manifest of the current
+ * {@link VERSION}.
+ *
+ * @param file  The path to the file relative to the asset directory
+ *
+ * @return true if the manifest was initialized successfully
+ */
+bool AssetManifest::initWithAsset(const std::string& file) {
+    bool absolute = filetool::is_absolute(file);
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+
+    std::string path = Application::get()->getAssetDirectory();
+    path.append(file);
+    return initWithFile(path);
+}
+
+/**
+ * Returns the path of the compiled manifest for a JSON directory.
+ *
+ * The compiled manifest has the same path as the directory, but with
+ * the extension ".cuam" instead of ".json".
+ *
+ * @param directory The path to the JSON directory
+ *
+ * @return the path of the compiled manifest for a JSON directory.
+ */
+std::string AssetManifest::getCompiledPath(const std::string& directory) {
+    size_t dot = directory.find_last_of('.');
+    size_t sep = directory.find_last_of("/\\");
+    if (dot == std::string::npos || (sep != std::string::npos && dot < sep)) {
+        return directory+".cuam";
+    }
+    return directory.substr(0,dot)+".cuam";
+}
+
+/**
+ * Returns true if the data is a valid manifest, and initializes the tables.
+ *
+ * @return true if the data is a valid manifest, and initializes the tables.
+ */
+bool AssetManifest::validate() {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    CULogError("Compiled manifests are not supported on big endian platforms");
+    return false;
+#else
+    if (_data.size() < sizeof(ManifestHeader)) {
+        return false;
+    }
+    const ManifestHeader* header = (const ManifestHeader*)_data.data();
+    if (std::memcmp(header->magic,MANIFEST_MAGIC,4) || header->version != VERSION) {
+        return false;
+    }
+
+    // Check the size before the contents (with 64 bits to avoid overflow)
+    Uint64 size = align8(sizeof(ManifestHeader));
+    size += align8(((Uint64)header->strings+1)*sizeof(Uint32));
+    size += align8(header->chars);
+    size += (Uint64)header->nodes*sizeof(ManifestNode);
+    size += (Uint64)header->scenes*sizeof(ManifestScene);
+    size += (Uint64)header->entries*sizeof(Entry);
+    size += (Uint64)header->edges*sizeof(Dependency);
+    size += (Uint64)header->sources*sizeof(ManifestSource);
+    if (size != _data.size() || header->nodes == 0) {
+        return false;
+    }
+
+    size_t pos = align8(sizeof(ManifestHeader));
+    const Uint32* offsets = (const Uint32*)(_data.data()+pos);
+    pos += align8((header->strings+1)*sizeof(Uint32));
+    const char* chars = (const char*)(_data.data()+pos);
+    pos += align8(header->chars);
+    const ManifestNode* nodes = (const ManifestNode*)(_data.data()+pos);
+    pos += header->nodes*sizeof(ManifestNode);
+    const ManifestScene* scenes = (const ManifestScene*)(_data.data()+pos);
+    pos += header->scenes*sizeof(ManifestScene);
+    const Entry* entries = (const Entry*)(_data.data()+pos);
+    pos += header->entries*sizeof(Entry);
+    const Dependency* depends = (const Dependency*)(_data.data()+pos);
+    pos += header->edges*sizeof(Dependency);
+    const ManifestSource* sources = (const ManifestSource*)(_data.data()+pos);
+
+    // The strings must be in order
+    if (offsets[0] != 0 || offsets[header->strings] != header->chars) {
+        return false;
+    }
+    for(Uint32 ii = 0; ii < header->strings; ii++) {
+        if (offsets[ii] > offsets[ii+1]) {
+            return false;
+        }
+    }
+
+    // Children must come after their parents, so there are no cycles
+    Uint32 strings = header->strings;
+    if (nodes[0].type != (Uint32)JsonValue::Type::ObjectType) {
+        return false;
+    }
+    for(Uint32 ii = 0; ii < header->nodes; ii++) {
+        const ManifestNode& node = nodes[ii];
+        if (node.type > (Uint32)JsonValue::Type::ObjectType || node.key >= strings) {
+            return false;
+        } else if (node.type == (Uint32)JsonValue::Type::StringType && node.first >= strings) {
+            return false;
+        } else if (node.type >= (Uint32)JsonValue::Type::ArrayType && node.count &&
+                   (node.first <= ii || (Uint64)node.first+node.count > header->nodes)) {
+            return false;
+        }
+    }
+
+    for(Uint32 ii = 0; ii < header->scenes; ii++) {
+        const ManifestScene& scene = scenes[ii];
+        if (scene.key >= strings || scene.root >= header->nodes || scene.count == 0 ||
+            (Uint64)scene.first+scene.count > header->entries ||
+            (Uint64)scene.edge+scene.edges > header->edges) {
+            return false;
+        }
+        for(Uint32 jj = 0; jj < scene.count; jj++) {
+            const Entry& entry = entries[scene.first+jj];
+            if ((jj == 0) != (entry.parent == NONE) || (jj && entry.parent >= jj)) {
+                return false;
+            } else if (entry.name >= strings || entry.type >= strings) {
+                return false;
+            } else if ((entry.data != NONE && entry.data >= header->nodes) ||
+                       (entry.format != NONE && entry.format >= header->nodes) ||
+                       (entry.layout != NONE && entry.layout >= header->nodes)) {
+                return false;
+            }
+        }
+    }
+    for(Uint32 ii = 0; ii < header->edges; ii++) {
+        if (depends[ii].category >= strings || depends[ii].key >= strings) {
+            return false;
+        }
+    }
+    for(Uint32 ii = 0; ii < header->sources; ii++) {
+        if (sources[ii].path >= strings) {
+            return false;
+        }
+    }
+
+    _scount  = header->strings;
+    _ncount  = header->nodes;
+    _gcount  = header->scenes;
+    _rcount  = header->sources;
+    _offsets = offsets;
+    _chars   = chars;
+    _nodes   = nodes;
+    _scenes  = scenes;
+    _entries = entries;
+    _depends = depends;
+    _sources = sources;
+    return true;
+#endif
+}
+
+/**
+ * Returns true if the source files of this manifest are unchanged.
+ *
+ * Each source file recorded when the manifest was compiled is read (but
+ * not parsed) relative to the given root, and its size and hash are
+ * compared to the recorded values.  If any source file has changed, the
+ * manifest is stale and the JSON should be read instead.
+ *
+ * A source file that cannot be read is skipped, as there is no JSON to
+ * fall back to.  A manifest compiled without sources is always current.
+ *
+ * @param root  The asset root of the source paths
+ *
+ * @return true if the source files of this manifest are unchanged.
+ */
+bool AssetManifest::isCurrent(const std::string& root) const {
+    for(Uint32 ii = 0; ii < _rcount; ii++) {
+        const ManifestSource* source = (const ManifestSource*)_sources+ii;
+        Uint64 size = 0;
+        Uint64 hash = 0;
+        if (stamp_file(root+getString(source->path),size,hash) &&
+            (size != source->size || hash != source->hash)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#pragma mark -
+#pragma mark Serialization
+/**
+ * Saves this manifest to the given file.
+ *
+ * @param file  The absolute path to the file
+ *
+ * @return true if the manifest was saved successfully
+ */
+bool AssetManifest::save(const std::string& file) const {
+    if (_data.empty()) {
+        return false;
+    }
+
+    std::string path = filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "wb");
+    if (!stream) {
+        CULogError("Could not open '%s' for writing",path.c_str());
+        return false;
+    }
+    size_t amt = SDL_RWwrite(stream, _data.data(), 1, _data.size());
+    SDL_RWclose(stream);
+    return amt == _data.size();
+}
+
+#pragma mark -
+#pragma mark Directory Access
+/**
+ * Returns the string with the given index.
+ *
+ * @param index The string index
+ *
+ * @return the string with the given index.
+ */
+std::string AssetManifest::getString(Uint32 index) const {
+    if (index >= _scount) {
+        return "";
+    }
+    return std::string(_chars+_offsets[index],_offsets[index+1]-_offsets[index]);
+}
+
+/**
+ * Returns a newly allocated JSON tree for the given node.
+ *
+ * Node 0 is the root of the directory.  The tree is built directly from
+ * the manifest records, with no parsing.
+ *
+ * @param index The JSON node index
+ *
+ * @return a newly allocated JSON tree for the given node.
+ */
+std::shared_ptr<JsonValue> AssetManifest::getJson(Uint32 index) const {
+    if (index >= _ncount) {
+        return nullptr;
+    }
+
+    const ManifestNode* node = (const ManifestNode*)_nodes+index;
+    std::shared_ptr<JsonValue> result = JsonValue::alloc((JsonValue::Type)node->type);
+    result->assignKey(getString(node->key));
+    switch (result->_type) {
+        case JsonValue::Type::NullType:
+            break;
+        case JsonValue::Type::BoolType:
+            result->_longValue = node->number != 0;
+            break;
+        case JsonValue::Type::NumberType:
+            // Match the parser conversion
+            result->_doubleValue = node->number;
+            if (node->number >= (double)LONG_MAX) {
+                result->_longValue = LONG_MAX;
+            } else if (node->number <= (double)LONG_MIN) {
+                result->_longValue = LONG_MIN;
+            } else {
+                result->_longValue = (long)node->number;
+            }
+            break;
+        case JsonValue::Type::StringType:
+            result->_stringValue = getString(node->first);
+            break;
+        case JsonValue::Type::ArrayType:
+        case JsonValue::Type::ObjectType:
+            result->_children.reserve(node->count);
+            for(Uint32 ii = 0; ii < node->count; ii++) {
+                std::shared_ptr<JsonValue> child = getJson(node->first+ii);
+                child->_parent = result.get();
+                result->_children.push_back(child);
+            }
+            result->reindex();
+            break;
+    }
+    return result;
+}
+
+/**
+ * Returns the number of asset categories in the directory.
+ *
+ * @return the number of asset categories in the directory.
+ */
+size_t AssetManifest::getCategoryCount() const {
+    return _ncount ? ((const ManifestNode*)_nodes)->count : 0;
+}
+
+/**
+ * Returns the name of the given asset category.
+ *
+ * @param category  The category position in the directory
+ *
+ * @return the name of the given asset category.
+ */
+std::string AssetManifest::getCategory(size_t category) const {
+    Uint32 index = getCategoryNode(category);
+    return index == NONE ? "" : getString(((const ManifestNode*)_nodes+index)->key);
+}
+
+/**
+ * Returns the JSON node index of the given asset category.
+ *
+ * @param category  The category position in the directory
+ *
+ * @return the JSON node index of the given asset category.
+ */
+Uint32 AssetManifest::getCategoryNode(size_t category) const {
+    if (category >= getCategoryCount()) {
+        return NONE;
+    }
+    return ((const ManifestNode*)_nodes)->first+(Uint32)category;
+}
+
+#pragma mark -
+#pragma mark Scene Graph Access
+/**
+ * Returns the key of the given scene graph.
+ *
+ * @param scene The scene graph position
+ *
+ * @return the key of the given scene graph.
+ */
+std::string AssetManifest::getSceneKey(size_t scene) const {
+    if (scene >= _gcount) {
+        return "";
+    }
+    return getString(((const ManifestScene*)_scenes+scene)->key);
+}
+
+/**
+ * Returns the nodes of the given scene graph in creation order.
+ *
+ * The first entry is the root of the scene graph.  Every parent comes
+ * before its children, and the children of a node are in the order of
+ * the source JSON.
+ *
+ * @param scene The scene graph position
+ * @param count The variable to store the number of entries
+ *
+ * @return the nodes of the given scene graph in creation order.
+ */
+const AssetManifest::Entry* AssetManifest::getSceneEntries(size_t scene, size_t& count) const {
+    if (scene >= _gcount) {
+        count = 0;
+        return nullptr;
+    }
+    const ManifestScene* record = (const ManifestScene*)_scenes+scene;
+    count = record->count;
+    return _entries+record->first;
+}
+
+/**
+ * Returns the assets that the given scene graph depends on.
+ *
+ * These are the textures and fonts referenced by the data of the
+ * scene graph nodes.
+ *
+ * @param scene The scene graph position
+ * @param count The variable to store the number of dependencies
+ *
+ * @return the assets that the given scene graph depends on.
+ */
+const AssetManifest::Dependency* AssetManifest::getSceneDependencies(size_t scene, size_t& count) const {
+    if (scene >= _gcount) {
+        count = 0;
+        return nullptr;
+    }
+    const ManifestScene* record = (const ManifestScene*)_scenes+scene;
+    count = record->edges;
+    return _depends+record->edge;
+}
@@ -45,6 +45,8 @@
 //
 #include <cugl/assets/CUFontLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/io/CUMappedFile.h>
+#include <cugl/util/CUFiletools.h>
 #include <SDL/SDL_ttf.h>
 
 using namespace cugl;
@@ -67,7 +69,8 @@ using namespace cugl;
  */
 FontLoader::FontLoader() : Loader<Font>(),
 _fontsize(UNKNOWN_SIZE),
-_charset(UNKNOWN_CHARS) {
+_charset(UNKNOWN_CHARS),
+_baked(true) {
 }
 
 
@@ -81,13 +84,18 @@ _charset(UNKNOWN_CHARS) {
  * Hence this method does the maximum amount of work that can be done in
  * asynchronous font loading.
  *
+ * If there is a baked font for this asset, it is read instead of the
+ * TrueType file, and the character set is ignored.
+ *
  * @param source    The pathname to the asset
  * @param charset   The atlas character set
- * @param charset   The font size
+ * @param size      The font size
+ * @param baked     The pathname to the baked font ("" to search)
  *
  * @return the font asset with no generated atlas
  */
-std::shared_ptr<Font> FontLoader::preload(const std::string& source, const std::string& charset, int size) {
+std::shared_ptr<Font> FontLoader::preload(const std::string& source, const std::string& charset,
+                                          int size, const std::string& baked) {
     // Make sure we reference the asset directory
 #if defined (__WINDOWS__)
     bool absolute = (bool)strstr(source.c_str(),":") || source[0] == '\\';
@@ -96,9 +104,14 @@ std::shared_ptr<Font> FontLoader::preload(const std::string& source, const std::
 #endif
     CUAssertLog(!absolute, "This loader does not accept absolute paths for assets");
     
+    std::shared_ptr<Font> result = preloadBaked(source, size, baked);
+    if (result != nullptr) {
+        return result;
+    }
+    
     std::string path = Application::get()->getAssetDirectory();
     path.append(source);
-    std::shared_ptr<Font> result = Font::alloc(path.c_str(),size);
+    result = Font::alloc(path.c_str(),size);
     if (result == nullptr) {
         return result;
     }
@@ -112,6 +125,48 @@ std::shared_ptr<Font> FontLoader::preload(const std::string& source, const std::
     return result;
 }
 
+/**
+ * Returns the baked font for this asset, if it exists.
+ *
+ * If baked is empty, this method looks for the TrueType file with the
+ * extension ".n.font", where n is the font size, and then with the
+ * extension ".font".  The latter is only accepted if it has the same
+ * size or is a distance field.  This method returns nullptr if baked
+ * fonts are disabled or no baked font was found.
+ *
+ * This method is safe to call outside of the main thread.
+ *
+ * @param source    The pathname to the asset
+ * @param size      The font size
+ * @param baked     The pathname to the baked font ("" to search)
+ *
+ * @return the baked font for this asset (or nullptr)
+ */
+std::shared_ptr<Font> FontLoader::preloadBaked(const std::string& source, int size, const std::string& baked) {
+    if (!_baked) {
+        return nullptr;
+    }
+    
+    std::vector<std::string> candidates;
+    if (baked.empty()) {
+        candidates.push_back(filetool::set_suffix(source, std::to_string(size)+".font"));
+        candidates.push_back(filetool::set_suffix(source, "font"));
+    } else {
+        candidates.push_back(baked);
+    }
+    
+    for(auto it = candidates.begin(); it != candidates.end(); ++it) {
+        std::shared_ptr<MappedFile> mapping = MappedFile::allocWithAsset(*it);
+        if (mapping != nullptr) {
+            std::shared_ptr<Font> result = Font::allocWithBaked(mapping, size);
+            if (result != nullptr) {
+                return result;
+            }
+        }
+    }
+    return nullptr;
+}
+
 /**
  * Creates an an atlas for the font asset, and assigns it the given key.
  *
@@ -209,6 +264,7 @@ bool FontLoader::read(const std::string& key, const std::string& source, int siz
  *      "file":         The path to the asset
  *      "size":         This font size (int)
  *      "charset":      The set of characters for the font atlas (string)
+ *      "baked":        The path to a baked font, if not next to the file
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -225,11 +281,12 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     
     std::string source  = json->getString("file",UNKNOWN_SOURCE);
     std::string charset = json->getString("charset",UNKNOWN_CHARS);
+    std::string baked   = json->getString("baked","");
     int size = json->getInt("size",UNKNOWN_SIZE);
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<Font> font = preload(source,charset,size);
+        std::shared_ptr<Font> font = preload(source,charset,size,baked);
         if (font != nullptr) {
             success = true;
             materialize(key,font,callback);
@@ -238,7 +295,7 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
         }
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<Font> font = this->preload(source,charset,size);
+            std::shared_ptr<Font> font = this->preload(source,charset,size,baked);
             Application::get()->schedule([=](void){
                 this->materialize(key,font,callback);
                 return false;
@@ -248,3 +305,24 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     
     return success;
 }
+
+/**
+ * Returns the memory footprint of the given font in bytes.
+ *
+ * This is the size of the font atlas texture.  Fonts without an atlas
+ * have a footprint of 0.
+ *
+ * @param asset The font to measure
+ *
+ * @return the memory footprint of the given font in bytes.
+ */
+size_t FontLoader::measure(const std::shared_ptr<Font>& asset) const {
+    if (asset == nullptr || !asset->hasAtlas()) {
+        return 0;
+    }
+    const std::shared_ptr<Texture>& atlas = asset->getAtlas();
+    if (atlas == nullptr) {
+        return 0;
+    }
+    return (size_t)atlas->getWidth()*atlas->getHeight()*atlas->getByteSize();
+}
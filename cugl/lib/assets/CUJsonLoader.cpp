@@ -104,13 +104,13 @@ bool JsonLoader::read(const std::string& key, const std::string& source, LoaderC
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+        std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         success = (json != nullptr);
         materialize(key,json,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
             Application::get()->schedule([=](void) {
                 this->materialize(key,json,callback);
@@ -155,13 +155,13 @@ bool JsonLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+        std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         success = (json != nullptr);
         materialize(key,json,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
             Application::get()->schedule([=](void) {
                 this->materialize(key,json,callback);
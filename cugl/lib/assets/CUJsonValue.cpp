@@ -4,8 +4,9 @@
 //
 //  This module a modern C++ alternative to the cJSON interface for reading
 //  JSON files.  In particular, this gives us better type-checking and memory
-//  management.  With that said, it still uses cJSON as the underlying parsing
-//  engine.
+//  management.  JSON strings are parsed in a single pass directly into the
+//  tree, with the nodes allocated from an arena owned by the document.  It
+//  still uses cJSON to encode the tree as a string.
 //
 //  This class uses our standard shared-pointer architecture.
 //
@@ -44,6 +45,11 @@
 #include <cugl/assets/CUJsonValue.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUStrings.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdlib>
+#include <unordered_set>
 
 using namespace cugl;
 
@@ -55,12 +61,13 @@ using namespace cugl;
  * first line of the error.  It also indicates (via the reference variable) the line on which the error occurred.
  *
  * @param data      The JSON value being parsed
+ * @param end       The end of the JSON value being parsed
  * @param error     The tail of the JSON after encountering an error
  * @param lineno    The variable to store the line number
  *
  * @return the line of JSON with the offending error.
  */
-std::string isolate_error(const char* data, const char* error, int& lineno) {
+std::string isolate_error(const char* data, const char* end, const char* error, int& lineno) {
     lineno = 1;
     const char* pos = data;
     while (pos != error) {
@@ -72,7 +79,7 @@ std::string isolate_error(const char* data, const char* error, int& lineno) {
     size_t len = 0;
     bool goon = true;
     pos = error;
-    while (*pos && goon) {
+    while (pos < end && *pos && goon) {
         if (*pos == '\n') {
             goon = false;
         } else {
@@ -85,34 +92,6 @@ std::string isolate_error(const char* data, const char* error, int& lineno) {
 
 #pragma mark -
 #pragma mark JSON Conversions
-/**
- * Returns the JsonValue::Type appropriate for this cJSON node
- *
- * cJSON types are slightly different from JsonValue ones, particular for
- * boolean and strings.  We need this function to convert.
- *
- * @param node  The cJSON node
- *
- * @return the JsonValue::Type appropriate for this cJSON node
- */
-JsonValue::Type JsonValueType(const cJSON* node) {
-    if (node->type & cJSON_False || node->type & cJSON_True) {
-        return JsonValue::Type::BoolType;
-    } else if (node->type & cJSON_Number) {
-        return JsonValue::Type::NumberType;
-    } else if (node->type & cJSON_String) {
-        return JsonValue::Type::StringType;
-    } else if (node->type & cJSON_NULL) {
-        return JsonValue::Type::NullType;
-    } else if (node->type & cJSON_Array) {
-        return JsonValue::Type::ArrayType;
-    } else if (node->type & cJSON_Object) {
-        return JsonValue::Type::ObjectType;
-    }
-    CUAssertLog(false,"Unknown JSON type %d",node->type);
-	return JsonValue::Type::NullType;
-}
-
 /**
  * Returns the cJSON type appropriate for this JsonValue
  *
@@ -142,87 +121,6 @@ int cJsonType(const JsonValue* value) {
 	return cJSON_NULL;
 }
 
-/**
- * Returns a newly allocated JsonValue equivalent to the cJSON node
- *
- * This allocator recursively allocates child nodes as necessary. These
- * nodes will be owned by the parent node and deleted when it is deleted
- * (provided there are no other references).
- *
- * This method does not delete the cJSON node when done.
- *
- * @param node  The cJSON node to convert
- *
- * @return a newly allocated JsonValue equivalent to the cJSON node
- */
-std::shared_ptr<JsonValue> JsonValue::toJsonValue(const cJSON* node) {
-    std::shared_ptr<JsonValue> result = JsonValue::alloc(JsonValueType(node));
-
-    if (result->_type == Type::BoolType) {
-        result->_longValue = node->type & cJSON_True;
-    } else {
-        result->_longValue = node->valueint;
-    }
-    result->_doubleValue = node->valuedouble;
-    if (node->valuestring) {
-        result->_stringValue = node->valuestring;
-    }
-    if (node->string) {
-        result->_key = node->string;
-    }
-    
-    std::vector<std::shared_ptr<JsonValue>> items;
-    if (node->child) {
-        cJSON* current = node->child;
-        while (current) {
-            items.push_back(toJsonValue(current));
-            items.back()->_parent = result.get();
-            current = current->next;
-        }
-    }
-    result->_children.assign(items.begin(),items.end());
-    
-    return result;
-}
-
-/**
- * Modifies value so that it is equivalent to the cJSON node
- *
- * This allocator recursively allocates child nodes as necessary. These
- * nodes will be owned by the parent node value and deleted when it is
- * deleted (provided there are no other references).
- *
- * This method does not delete the cJSON node when done.
- *
- * @param node  The cJSON node to convert
- */
-void JsonValue::toJsonValue(JsonValue* value, const cJSON* node) {
-    value->_type = JsonValueType(node);
-    if (value->_type == Type::BoolType) {
-        value->_longValue = node->type & cJSON_True;
-    } else {
-        value->_longValue = node->valueint;
-    }
-    value->_doubleValue = node->valuedouble;
-    if (node->valuestring) {
-        value->_stringValue = node->valuestring;
-    }
-    if (node->string) {
-        value->_key = node->string;
-    }
-    
-    std::vector<std::shared_ptr<JsonValue>> items;
-    if (node->child) {
-        cJSON* current = node->child;
-        while (current) {
-            items.push_back(toJsonValue(current));
-            items.back()->_parent = value;
-            current = current->next;
-        }
-    }
-    value->_children.assign(items.begin(),items.end());
-}
-
 /**
  * Returns a newly allocated cJSON node equivalent to value
  *
@@ -259,7 +157,7 @@ cJSON* JsonValue::toCJSON(const JsonValue* value) {
             CUAssertLog(false,"Unknown JSON type %d",value->type());
     }
     result->type = result->type | cJSON_StringIsConst;
-    result->string = (char*)(value->_key.c_str()); // Unsafe, but StringIsConst makes okay.
+    result->string = (char*)(value->_key->c_str()); // Unsafe, but StringIsConst makes okay.
     
     bool first = true;
     cJSON* prev  = nullptr;
@@ -278,6 +176,836 @@ cJSON* JsonValue::toCJSON(const JsonValue* value) {
     return result;
 }
 
+#pragma mark -
+#pragma mark Document Arena
+/** The smallest object that keeps a hash index of its keys */
+#define INDEX_THRESHOLD     16
+/** The multiplier for the start of a key hash */
+#define HASH_PRIME_HEAD     0x9E3779B97F4A7C15ull
+/** The multiplier for the end of a key hash */
+#define HASH_PRIME_TAIL     0xC2B2AE3D27D4EB4Full
+/** The smallest block allocated by a document arena */
+#define ARENA_MIN_BLOCK     4096
+/** The largest block allocated by a document arena */
+#define ARENA_MAX_BLOCK     1048576
+/** The deepest nesting of arrays and objects allowed (the cJSON limit) */
+#define MAX_JSON_DEPTH      1000
+
+namespace cugl {
+
+/** The key shared by all nodes without one */
+static const std::string JSON_NO_KEY;
+
+/**
+ * This class is a bump allocator for the nodes of a single document.
+ *
+ * The arena allocates memory in large blocks and never frees individual
+ * allocations.  All blocks are released when the arena is deleted, which
+ * happens when the last node of the document is deleted.  Nodes allocated
+ * from the arena are never moved, so they can be detached from the document
+ * and attached to another tree safely.
+ *
+ * The arena also interns the keys of the document, so that nodes with the
+ * same key share a single string.
+ *
+ * Allocation is not thread safe, but it only happens while parsing.
+ */
+class JsonArena {
+private:
+    /** The blocks allocated so far */
+    std::vector<std::unique_ptr<char[]>> _blocks;
+    /** The next free byte in the current block */
+    char* _next;
+    /** The number of free bytes in the current block */
+    size_t _left;
+    /** The size of the next block to allocate */
+    size_t _size;
+    /** The distinct keys of the document */
+    std::unordered_set<std::string> _keys;
+
+public:
+    /**
+     * Creates an arena with the given initial block size
+     *
+     * @param size  The size of the first block
+     */
+    JsonArena(size_t size) : _next(nullptr), _left(0), _size(size) {}
+
+    /**
+     * Returns a pointer to the given number of bytes
+     *
+     * @param bytes The number of bytes to allocate
+     * @param align The alignment of the allocation (a power of two)
+     *
+     * @return a pointer to the given number of bytes
+     */
+    void* allocate(size_t bytes, size_t align) {
+        size_t pad = (align-((uintptr_t)_next & (align-1))) & (align-1);
+        if (pad+bytes > _left) {
+            size_t size = std::max(_size,bytes+align);
+            _blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+            _next = _blocks.back().get();
+            _left = size;
+            _size = std::min(2*_size,(size_t)ARENA_MAX_BLOCK);
+            pad = (align-((uintptr_t)_next & (align-1))) & (align-1);
+        }
+        void* result = _next+pad;
+        _next += pad+bytes;
+        _left -= pad+bytes;
+        return result;
+    }
+
+    /**
+     * Returns the interned copy of the given key
+     *
+     * Each distinct key is stored once per document, and all nodes with
+     * that key share the copy.  The copy lives as long as the arena.
+     *
+     * @param key   The key to intern
+     *
+     * @return the interned copy of the given key
+     */
+    const std::string* intern(const std::string& key) {
+        return &*_keys.insert(key).first;
+    }
+};
+
+/**
+ * This class is an STL allocator for a document arena.
+ *
+ * The allocator keeps the arena alive.  As {@link std::allocate_shared}
+ * stores a copy of the allocator with each node, the arena lives as long
+ * as any node of the document.
+ */
+template <typename T>
+class JsonAllocator {
+public:
+    /** The allocated type */
+    typedef T value_type;
+    /** The document arena */
+    std::shared_ptr<JsonArena> arena;
+
+    /**
+     * Creates an allocator for the given arena
+     *
+     * @param arena The document arena
+     */
+    JsonAllocator(const std::shared_ptr<JsonArena>& arena) : arena(arena) {}
+
+    /**
+     * Creates a copy of an allocator for another type
+     *
+     * @param other The allocator to copy
+     */
+    template <typename U>
+    JsonAllocator(const JsonAllocator<U>& other) : arena(other.arena) {}
+
+    /**
+     * Returns storage for n objects of type T
+     *
+     * @param n The number of objects
+     *
+     * @return storage for n objects of type T
+     */
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(n*sizeof(T),alignof(T)));
+    }
+
+    /**
+     * Releases storage for n objects of type T
+     *
+     * This method does nothing, as the arena frees all storage at once.
+     *
+     * @param p The storage to release
+     * @param n The number of objects
+     */
+    void deallocate(T* p, size_t n) {}
+
+    /** Returns true if the allocators share an arena */
+    template <typename U>
+    bool operator==(const JsonAllocator<U>& other) const { return arena == other.arena; }
+    /** Returns true if the allocators do not share an arena */
+    template <typename U>
+    bool operator!=(const JsonAllocator<U>& other) const { return arena != other.arena; }
+};
+
+#pragma mark -
+#pragma mark JSON Parser
+/**
+ * This class is a single-pass parser for JSON strings.
+ *
+ * The parser builds the {@link JsonValue} tree directly from the string,
+ * with no intermediate representation.  The nodes are allocated from a
+ * {@link JsonArena} owned by the document.  The children of each array or
+ * object are gathered on a shared stack, so that each child vector is
+ * allocated once at its exact size.  Keys are interned and hashed as they
+ * are parsed, and large objects are indexed by key when they are complete.
+ *
+ * The grammar accepted is the same as cJSON.  In particular, any text after
+ * the first JSON value is ignored.  The string is bounded by its length, and
+ * need not be null-terminated.  This allows the parser to work directly on
+ * a {@link MappedFile}.  A null character ends the string early, as in cJSON.
+ *
+ * As in cJSON, arrays and objects may only be nested 1000 deep.  Deeper
+ * nesting fails the parse, so that a hostile file cannot overflow the
+ * stack of this recursive parser.
+ */
+class JsonParser {
+private:
+    /** The next character to parse */
+    const char* _pos;
+    /** The end of the JSON string */
+    const char* _end;
+    /** The position of the parsing error (nullptr if none) */
+    const char* _error;
+    /** The number of arrays and objects enclosing the parse position */
+    size_t _depth;
+    /** Whether the parse failed because the nesting was too deep */
+    bool _deep;
+    /** The size of the first arena block */
+    size_t _block;
+    /** The document arena (created on demand) */
+    std::shared_ptr<JsonArena> _arena;
+    /** The children of the arrays and objects being parsed */
+    std::vector<std::shared_ptr<JsonValue>> _stack;
+    /** The buffer for the key being parsed */
+    std::string _scratch;
+
+    /**
+     * Skips over any whitespace (and control characters)
+     */
+    void skip() {
+        while (_pos < _end && *_pos && (unsigned char)*_pos <= 32) {
+            _pos++;
+        }
+    }
+
+    /**
+     * Returns the character at the given offset from the parse position
+     *
+     * This method returns the null character if the offset is past the end
+     * of the string.
+     *
+     * @param offset    The offset from the parse position
+     *
+     * @return the character at the given offset from the parse position
+     */
+    char peek(size_t offset=0) const {
+        return (offset < (size_t)(_end-_pos) ? _pos[offset] : '\0');
+    }
+
+    /**
+     * Returns true if the given word is at the parse position
+     *
+     * @param word  The word to match
+     * @param len   The length of the word
+     *
+     * @return true if the given word is at the parse position
+     */
+    bool match(const char* word, size_t len) const {
+        return (size_t)(_end-_pos) >= len && strncmp(_pos,word,len) == 0;
+    }
+
+    /**
+     * Returns a new child node of parent, allocated from the arena
+     *
+     * The node is pushed on to the stack of children.
+     *
+     * @param parent    The parent node
+     *
+     * @return a new child node of parent, allocated from the arena
+     */
+    JsonValue* push(JsonValue* parent) {
+        if (_arena == nullptr) {
+            _arena = std::make_shared<JsonArena>(_block);
+        }
+        _stack.push_back(std::allocate_shared<JsonValue>(JsonAllocator<JsonValue>(_arena)));
+        JsonValue* result = _stack.back().get();
+        result->_parent = parent;
+        return result;
+    }
+
+    /**
+     * Moves the children from the given stack position to the node
+     *
+     * @param node  The array or object node
+     * @param base  The stack position of the first child
+     */
+    void adopt(JsonValue* node, size_t base) {
+        node->_children.assign(std::make_move_iterator(_stack.begin()+base),
+                               std::make_move_iterator(_stack.end()));
+        _stack.erase(_stack.begin()+base,_stack.end());
+        node->reindex();
+    }
+
+    /**
+     * Returns the value of four hexadecimal digits (or 0 if invalid)
+     *
+     * @param str   The digits to parse
+     *
+     * @return the value of four hexadecimal digits (or 0 if invalid)
+     */
+    static Uint32 parseHex(const char* str) {
+        Uint32 result = 0;
+        for(int ii = 0; ii < 4; ii++) {
+            char c = str[ii];
+            result <<= 4;
+            if (c >= '0' && c <= '9') {
+                result += c-'0';
+            } else if (c >= 'A' && c <= 'F') {
+                result += 10+c-'A';
+            } else if (c >= 'a' && c <= 'f') {
+                result += 10+c-'a';
+            } else {
+                return 0;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Appends the UTF8 encoding of the code point to the string
+     *
+     * @param code  The unicode code point
+     * @param out   The string to append to
+     */
+    static void appendUTF8(Uint32 code, std::string& out) {
+        if (code < 0x80) {
+            out.push_back((char)code);
+        } else if (code < 0x800) {
+            out.push_back((char)(0xC0 | (code >> 6)));
+            out.push_back((char)(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back((char)(0xE0 | (code >> 12)));
+            out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back((char)(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back((char)(0xF0 | (code >> 18)));
+            out.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back((char)(0x80 | (code & 0x3F)));
+        }
+    }
+
+    /**
+     * Parses a string literal into the given string
+     *
+     * The parser must be positioned at the opening quote.
+     *
+     * @param out   The string to store the result
+     *
+     * @return true if the string was parsed successfully
+     */
+    bool parseString(std::string& out) {
+        const char* start = _pos+1;
+        const char* end = start;
+        bool escaped = false;
+        while (end < _end && *end != '\"') {
+            if (*end == '\0') {
+                break;
+            } else if (*end == '\\') {
+                escaped = true;
+                end++;
+                if (end == _end || *end == '\0') {
+                    break;
+                }
+            }
+            end++;
+        }
+        if (end == _end || *end != '\"') {
+            _error = _pos;
+            return false;
+        }
+
+        if (!escaped) {
+            out.assign(start,end-start);
+            _pos = end+1;
+            return true;
+        }
+
+        out.clear();
+        out.reserve(end-start);
+        for(const char* ptr = start; ptr < end; ptr++) {
+            if (*ptr != '\\') {
+                out.push_back(*ptr);
+                continue;
+            }
+            ptr++;
+            switch (*ptr) {
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    // Transcode UTF16 to UTF8 (see RFC2781 and RFC3629)
+                    if (ptr+4 >= end) {
+                        _error = _pos;
+                        return false;
+                    }
+                    Uint32 code = parseHex(ptr+1);
+                    ptr += 4;
+                    if ((code >= 0xDC00 && code <= 0xDFFF) || code == 0) {
+                        _error = _pos;
+                        return false;
+                    } else if (code >= 0xD800 && code <= 0xDBFF) {
+                        if (ptr+6 >= end || ptr[1] != '\\' || ptr[2] != 'u') {
+                            _error = _pos;
+                            return false;
+                        }
+                        Uint32 low = parseHex(ptr+3);
+                        ptr += 6;
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            _error = _pos;
+                            return false;
+                        }
+                        code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+                    }
+                    appendUTF8(code,out);
+                }
+                    break;
+                default:
+                    out.push_back(*ptr);
+                    break;
+            }
+        }
+        _pos = end+1;
+        return true;
+    }
+
+    /**
+     * Returns the number of digits at the given offset from the parse position
+     *
+     * @param offset    The offset from the parse position
+     *
+     * @return the number of digits at the given offset from the parse position
+     */
+    size_t digits(size_t offset) const {
+        size_t len = 0;
+        while (peek(offset+len) >= '0' && peek(offset+len) <= '9') {
+            len++;
+        }
+        return len;
+    }
+
+    /**
+     * Parses a number into the given node
+     *
+     * The number must match the JSON grammar exactly: an optional minus sign,
+     * an integer part with no leading zeroes, and an optional fraction and
+     * exponent, each with at least one digit.  The validated span is then
+     * converted with strtod, so that the value is correctly rounded.
+     *
+     * @param node  The node to store the result
+     *
+     * @return true if the number was parsed successfully
+     */
+    bool parseNumber(JsonValue* node) {
+        size_t len = (peek() == '-' ? 1 : 0);
+        size_t count = digits(len);
+        if (count == 0 || (peek(len) == '0' && count > 1)) {
+            _error = _pos+len;
+            return false;
+        }
+        len += count;
+        if (peek(len) == '.') {
+            count = digits(len+1);
+            if (count == 0) {
+                _error = _pos+len;
+                return false;
+            }
+            len += count+1;
+        }
+        if (peek(len) == 'e' || peek(len) == 'E') {
+            size_t offset = len+1;
+            if (peek(offset) == '+' || peek(offset) == '-') {
+                offset++;
+            }
+            count = digits(offset);
+            if (count == 0) {
+                _error = _pos+len;
+                return false;
+            }
+            len = offset+count;
+        }
+
+        // The JSON string need not be null terminated, so convert a copy
+        char buffer[64];
+        std::string copy;
+        const char* text = buffer;
+        if (len < sizeof(buffer)) {
+            memcpy(buffer, _pos, len);
+            buffer[len] = '\0';
+        } else {
+            copy.assign(_pos, len);
+            text = copy.c_str();
+        }
+        double value = strtod(text, nullptr);
+        _pos += len;
+
+        node->_type = JsonValue::Type::NumberType;
+        node->_doubleValue = value;
+        if (value >= (double)LONG_MAX) {
+            node->_longValue = LONG_MAX;
+        } else if (value <= (double)LONG_MIN) {
+            node->_longValue = LONG_MIN;
+        } else {
+            node->_longValue = (long)value;
+        }
+        return true;
+    }
+
+    /**
+     * Parses an array into the given node
+     *
+     * The parser must be positioned at the opening bracket.
+     *
+     * @param node  The node to store the result
+     *
+     * @return true if the array was parsed successfully
+     */
+    bool parseArray(JsonValue* node) {
+        node->_type = JsonValue::Type::ArrayType;
+        _pos++;
+        skip();
+        if (peek() == ']') {
+            _pos++;
+            return true;
+        }
+
+        size_t base = _stack.size();
+        while (true) {
+            JsonValue* child = push(node);
+            if (!parseValue(child)) {
+                return false;
+            }
+            skip();
+            if (peek() == ',') {
+                _pos++;
+                skip();
+            } else if (peek() == ']') {
+                _pos++;
+                break;
+            } else {
+                _error = _pos;
+                return false;
+            }
+        }
+        adopt(node,base);
+        return true;
+    }
+
+    /**
+     * Parses an object into the given node
+     *
+     * The parser must be positioned at the opening brace.
+     *
+     * @param node  The node to store the result
+     *
+     * @return true if the object was parsed successfully
+     */
+    bool parseObject(JsonValue* node) {
+        node->_type = JsonValue::Type::ObjectType;
+        _pos++;
+        skip();
+        if (peek() == '}') {
+            _pos++;
+            return true;
+        }
+
+        size_t base = _stack.size();
+        while (true) {
+            if (peek() != '\"') {
+                _error = _pos;
+                return false;
+            }
+            JsonValue* child = push(node);
+            if (!parseString(_scratch)) {
+                return false;
+            }
+            child->_key  = _arena->intern(_scratch);
+            child->_hash = JsonValue::hashKey(_scratch.data(),_scratch.size());
+            skip();
+            if (peek() != ':') {
+                _error = _pos;
+                return false;
+            }
+            _pos++;
+            skip();
+            if (!parseValue(child)) {
+                return false;
+            }
+            skip();
+            if (peek() == ',') {
+                _pos++;
+                skip();
+            } else if (peek() == '}') {
+                _pos++;
+                break;
+            } else {
+                _error = _pos;
+                return false;
+            }
+        }
+        adopt(node,base);
+        return true;
+    }
+
+    /**
+     * Parses any JSON value into the given node
+     *
+     * The parser must be positioned at the start of the value.
+     *
+     * @param node  The node to store the result
+     *
+     * @return true if the value was parsed successfully
+     */
+    bool parseValue(JsonValue* node) {
+        switch (peek()) {
+            case 'n':
+                if (match("null",4)) {
+                    node->_type = JsonValue::Type::NullType;
+                    _pos += 4;
+                    return true;
+                }
+                break;
+            case 'f':
+                if (match("false",5)) {
+                    node->_type = JsonValue::Type::BoolType;
+                    node->_longValue = 0;
+                    _pos += 5;
+                    return true;
+                }
+                break;
+            case 't':
+                if (match("true",4)) {
+                    node->_type = JsonValue::Type::BoolType;
+                    node->_longValue = 1;
+                    _pos += 4;
+                    return true;
+                }
+                break;
+            case '\"':
+                node->_type = JsonValue::Type::StringType;
+                return parseString(node->_stringValue);
+            case '[':
+            case '{':
+                if (_depth < MAX_JSON_DEPTH) {
+                    _depth++;
+                    bool success = (peek() == '[' ? parseArray(node) : parseObject(node));
+                    _depth--;
+                    return success;
+                }
+                _deep = true;
+                break;
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                return parseNumber(node);
+            default:
+                break;
+        }
+        _error = _pos;
+        return false;
+    }
+
+public:
+    /**
+     * Creates a parser for the given JSON string
+     *
+     * @param json      The JSON string to parse
+     * @param length    The length of the JSON string
+     */
+    JsonParser(const char* json, size_t length) : _pos(json), _end(json+length), _error(nullptr), _depth(0), _deep(false) {
+        // A node takes several times the space of its JSON text
+        size_t size = 4*length;
+        _block = std::max((size_t)ARENA_MIN_BLOCK,std::min(size,(size_t)ARENA_MAX_BLOCK));
+    }
+
+    /**
+     * Parses the JSON string into the given root node
+     *
+     * The root node is not allocated from the arena, as it is typically
+     * allocated by the caller.  Its descendants are.
+     *
+     * @param root  The node to store the result
+     *
+     * @return true if the JSON string was parsed successfully
+     */
+    bool parse(JsonValue* root) {
+        skip();
+        return parseValue(root);
+    }
+
+    /**
+     * Returns the position of the parsing error (nullptr if none)
+     *
+     * @return the position of the parsing error (nullptr if none)
+     */
+    const char* getError() const { return _error; }
+
+    /**
+     * Returns true if the parse failed because the nesting was too deep
+     *
+     * @return true if the parse failed because the nesting was too deep
+     */
+    bool isTooDeep() const { return _deep; }
+};
+
+}
+
+#pragma mark -
+#pragma mark Key Index
+/**
+ * Returns the hash of the given key.
+ *
+ * This is the hash used by the key index of an object.
+ *
+ * @param key   The key to hash
+ * @param len   The length of the key in bytes
+ *
+ * @return the hash of the given key.
+ */
+Uint32 JsonValue::hashKey(const char* key, size_t len) {
+    // Only hash the first and last eight bytes, as keys rarely differ in the
+    // middle.  Collisions are resolved by comparing the keys anyway.
+    Uint64 head = 0;
+    Uint64 tail = 0;
+    if (len >= 8) {
+        std::memcpy(&head,key,8);
+        std::memcpy(&tail,key+len-8,8);
+    } else {
+        std::memcpy(&head,key,len);
+    }
+    Uint64 hash = (head*HASH_PRIME_HEAD) ^ (tail*HASH_PRIME_TAIL) ^ len;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_HEAD;
+    return (Uint32)(hash >> 32);
+}
+
+/**
+ * Assigns the given key to this node, without reindexing the parent.
+ *
+ * Keys parsed from a JSON string are interned by the document, so that
+ * each distinct key is stored once.  This method instead gives this node
+ * its own copy of the key.  It also updates the cached hash.
+ *
+ * @param key   The key for this node
+ */
+void JsonValue::assignKey(const std::string& key) {
+    if (_ownKey == nullptr) {
+        _ownKey = std::unique_ptr<std::string>(new std::string(key));
+    } else {
+        _ownKey->assign(key);
+    }
+    _key  = _ownKey.get();
+    _hash = hashKey(key.data(),key.size());
+}
+
+/**
+ * Rebuilds the key index of this node from scratch.
+ *
+ * Only objects with enough children have an index.  For all other nodes,
+ * this method releases the index.  This method must be called whenever
+ * the children are reordered or their keys change.
+ */
+void JsonValue::reindex() {
+    size_t size = _children.size();
+    if (_type != Type::ObjectType || size < INDEX_THRESHOLD) {
+        _index.clear();
+        return;
+    }
+
+    // Keep the load factor at most 1/2 so probes stay short
+    size_t capacity = 2*INDEX_THRESHOLD;
+    while (capacity < 2*size) {
+        capacity *= 2;
+    }
+    _index.assign(capacity,0);
+    size_t mask = capacity-1;
+    for(size_t ii = 0; ii < size; ii++) {
+        Uint32 hash = _children[ii]->_hash;
+        size_t slot = hash & mask;
+        while (_index[slot]) {
+            slot = (slot+1) & mask;
+        }
+        _index[slot] = ((Uint64)hash << 32) | (ii+1);
+    }
+}
+
+/**
+ * Adds the child at the given position to the key index of this node.
+ *
+ * This method is an optimization of {@link reindex} when a child is
+ * appended to the end of the children.  It rebuilds the index if the
+ * index is too full.
+ *
+ * @param pos   The position of the child to index
+ */
+void JsonValue::indexChild(size_t pos) {
+    if (_type != Type::ObjectType) {
+        return;
+    } else if (_index.empty() || 2*_children.size() > _index.size()) {
+        reindex();
+        return;
+    }
+
+    Uint32 hash = _children[pos]->_hash;
+    size_t mask = _index.size()-1;
+    size_t slot = hash & mask;
+    while (_index[slot]) {
+        slot = (slot+1) & mask;
+    }
+    _index[slot] = ((Uint64)hash << 32) | (pos+1);
+}
+
+/**
+ * Returns the position of the child with the given key.
+ *
+ * If there is more than one child with this key, this method returns the
+ * first one.  If there is no child with this key, it returns -1.
+ *
+ * @param key   The key identifying the child
+ *
+ * @return the position of the child with the given key.
+ */
+int JsonValue::lookup(const std::string& key) const {
+    // Small objects are faster to scan than to hash
+    if (_index.empty()) {
+        for(auto it = _children.begin(); it != _children.end(); it++) {
+            if (*(*it)->_key == key) {
+                return (int)(it-_children.begin());
+            }
+        }
+        return -1;
+    }
+
+    Uint32 hash = hashKey(key.data(),key.size());
+    size_t mask = _index.size()-1;
+    for(size_t slot = hash & mask; _index[slot]; slot = (slot+1) & mask) {
+        // Only compare keys when the hashes match
+        Uint64 entry = _index[slot];
+        if ((Uint32)(entry >> 32) == hash) {
+            int pos = (int)(entry & 0xFFFFFFFF)-1;
+            if (*_children[pos]->_key == key) {
+                return pos;
+            }
+        }
+    }
+    return -1;
+}
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -289,10 +1017,11 @@ cJSON* JsonValue::toCJSON(const JsonValue* value) {
 JsonValue::JsonValue() :
 _type(Type::NullType),
 _parent(nullptr),
-_key(""),
+_key(&JSON_NO_KEY),
 _stringValue(""),
 _longValue(0L),
-_doubleValue(0.0) {
+_doubleValue(0.0),
+_hash(0) /* The hash of the empty key */ {
 }
 
 /**
@@ -303,6 +1032,7 @@ _doubleValue(0.0) {
  */
 JsonValue::~JsonValue() {
     _children.clear();
+    _index.clear();
     _parent = nullptr;
     _type = Type::NullType;
 }
@@ -394,22 +1124,58 @@ bool JsonValue::init(double value) {
  * If there is a parsing error, this  method will return false.  Detailed
  * information about the parsing error will be passed to an assert.  Hence
  * error messages are suppressed if asserts are turned off.
+ * JSON nested more than 1000 deep is not parsed.  As this is a limit,
+ * and not a syntax error, it is logged as an error instead of an assert.
  *
  * @param json  The JSON string to parse.
  *
  * @return  true if the JSON node is initialized properly, false otherwise.
  */
 bool JsonValue::initWithJson(const char* json) {
-    const char *error = NULL;
-    cJSON* node = cJSON_ParseWithOpts(json, &error, 0);
-    if (node) {
-        toJsonValue(this,node);
-        cJSON_Delete(node);
+    return initWithJson(json,strlen(json));
+}
+
+/**
+ * Initializes a new JsonValue from the given JSON string.
+ *
+ * This initializer will parse the JSON string and construct a full JSON
+ * tree for the string, if possible. The children are all owned by this
+ * node will be deleted when this node is deleted (provided there are
+ * no other references).
+ *
+ * The string is bounded by its length, and need not be null-terminated.
+ * Hence this initializer can parse a JSON string in place, such as from
+ * a {@link MappedFile}.
+ *
+ * If there is a parsing error, this method will return false.  Detailed
+ * information about the parsing error will be passed to an assert.  Hence
+ * error messages are suppressed if asserts are turned off.
+ * JSON nested more than 1000 deep is not parsed.  As this is a limit,
+ * and not a syntax error, it is logged as an error instead of an assert.
+ *
+ * @param json      The JSON string to parse.
+ * @param length    The length of the JSON string in bytes.
+ *
+ * @return  true if the JSON node is initialized properly, false otherwise.
+ */
+bool JsonValue::initWithJson(const char* json, size_t length) {
+    JsonParser parser(json,length);
+    if (parser.parse(this)) {
         return true;
     }
-    if (error) {
+    
+    // Do not leave a partial tree behind
+    _type = Type::NullType;
+    _children.clear();
+    _index.clear();
+    
+    // Deep nesting is valid JSON, so this is a limit and not an assert
+    const char* error = parser.getError();
+    if (parser.isTooDeep()) {
+        CULogError("JSON is nested more than %d deep",MAX_JSON_DEPTH);
+    } else if (error) {
         int line = 0;
-        std::string source = isolate_error(json,error,line);
+        std::string source = isolate_error(json,json+length,error,line);
         CUAssertLog(false, "Invalid token at line %d:\n  %s",line,source.c_str());
     } else {
         CUAssertLog(false, "Invalid JSON");
@@ -793,7 +1559,7 @@ void JsonValue::setNull() {
  */
 const std::string& JsonValue::key() const {
     //TODO: CUAssertLog(_parent, "This node is not part of an object");
-    return _key;
+    return *_key;
 }
 
 /**
@@ -808,7 +1574,8 @@ void JsonValue::setKey(const std::string& key) {
     CUAssertLog(_parent, "This node is not part of an object");
     if (_parent) {
         CUAssertLog(!_parent->has(key), "The key %s is already in use", key.c_str());
-        _key = key;
+        assignKey(key);
+        _parent->reindex();
     }
 }
 
@@ -842,12 +1609,7 @@ const int JsonValue::index() const {
  */
 bool JsonValue::has(const std::string& key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return true;
-        }
-    }
-    return false;
+    return lookup(key) >= 0;
 }
 
 /**
@@ -896,12 +1658,8 @@ const std::shared_ptr<JsonValue> JsonValue::get(int index) const {
  */
 std::shared_ptr<JsonValue> JsonValue::get(const std::string& key) {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = lookup(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 /**
@@ -918,12 +1676,8 @@ std::shared_ptr<JsonValue> JsonValue::get(const std::string& key) {
  */
 const std::shared_ptr<JsonValue> JsonValue::get(const std::string& key) const {
     CUAssertLog(isObject(), "Node is not an object type");
-    for(auto it = _children.begin(); it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            return *it;
-        }
-    }
-    return nullptr;
+    int pos = lookup(key);
+    return pos < 0 ? nullptr : _children[pos];
 }
 
 #pragma mark -
@@ -1061,6 +1815,7 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
     std::shared_ptr<JsonValue> result = _children[index];
     _children.erase(_children.begin() + index);
     result->_parent = nullptr;
+    reindex();
     return result;
 }
 
@@ -1077,16 +1832,12 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(int index) {
  * Returns the child with the specified key and removes it from this node.
  */
 std::shared_ptr<JsonValue> JsonValue::removeChild(const std::string& key) {
-    auto jt = _children.end();
-    for(auto it = _children.begin(); jt == _children.end() && it != _children.end(); it++) {
-        if ((*it)->_key == key) {
-            jt = it;
-        }
-    }
-    if (jt != _children.end()) {
-        std::shared_ptr<JsonValue> result = *jt;
-        _children.erase(jt);
+    int pos = lookup(key);
+    if (pos >= 0) {
+        std::shared_ptr<JsonValue> result = _children[pos];
+        _children.erase(_children.begin() + pos);
         result->_parent = nullptr;
+        reindex();
         return result;
     }
     return nullptr;
@@ -1103,10 +1854,12 @@ std::shared_ptr<JsonValue> JsonValue::removeChild(const std::string& key) {
  */
 void JsonValue::merge(std::shared_ptr<JsonValue>& node) {
     CUAssertLog(_parent != nullptr, "You cannot merge with the root node");
-    node->_parent = _parent;
-    node->_key = _key;
-    _parent->removeChild(_key);
-    node->_parent->_children.push_back(node);
+    JsonValue* parent = _parent;
+    node->_parent = parent;
+    node->assignKey(*_key);
+    parent->removeChild(*node->_key);
+    parent->_children.push_back(node);
+    parent->indexChild(parent->_children.size()-1);
 }
 
 
@@ -1132,6 +1885,7 @@ void JsonValue::appendChild(const std::shared_ptr<JsonValue>& child) {
                 "The key %s is already in use", child->key().c_str());
     _children.push_back(child);
     child->_parent = this;
+    indexChild(_children.size()-1);
 }
 
 /**
@@ -1154,9 +1908,10 @@ void JsonValue::appendChild(const std::string& key, const std::shared_ptr<JsonVa
     CUAssertLog(!child->_parent, "This child already has a parent");
     CUAssertLog(isObject(), "Node is not an object type");
     CUAssertLog(!has(key), "The key %s is already in use", key.c_str());
-    child->_key = key;
+    child->assignKey(key);
     _children.push_back(child);
     child->_parent = this;
+    indexChild(_children.size()-1);
 }
 
 /**
@@ -1181,6 +1936,7 @@ void JsonValue::insertChild(unsigned int index, const std::shared_ptr<JsonValue>
     CUAssertLog(isArray() || isObject(), "This node is a value type");
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    reindex();
 }
 
 /**
@@ -1207,9 +1963,10 @@ void JsonValue::insertChild(unsigned int index, const std::string& key,
     CUAssertLog(!child->_parent, "This child already has a parent");
     CUAssertLog(isObject(), "Node is not an object type");
     CUAssertLog(!has(key), "The key %s is already in use", key.c_str());
-    child->_key = key;
+    child->assignKey(key);
     _children.insert(_children.begin()+index,child);
     child->_parent = this;
+    reindex();
 }
 
 
@@ -50,19 +50,250 @@
 
 #include <cugl/assets/CUAssetManager.h>
 #include <cugl/assets/CUScene2Loader.h>
+#include <cugl/assets/CUAssetManifest.h>
 #include <cugl/assets/CUWidgetValue.h>
 #include <cugl/base/CUApplication.h>
 #include <cugl/io/CUJsonReader.h>
+#include <cugl/render/CUTexture.h>
+#include <cugl/render/CUFont.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/util/CUTimestamp.h>
 #include <cugl/scene2/cu_scene2.h>
 #include <locale>
 #include <algorithm>
+#include <deque>
 
 using namespace cugl;
 
 /** If the type is unknown */
 #define UNKNOWN_STR  "<unknown>"
 
+#pragma mark -
+#pragma mark Scene Builder
+/**
+ * An incremental build of a single scene graph.
+ *
+ * A builder creates the nodes of a scene one at a time, with every parent
+ * created before its children.  Hence it can be stopped after any node and
+ * resumed later, which allows a scene to be built across several animation
+ * frames.  Nodes are created in breadth-first order, so siblings are added
+ * to their parent in the order they appear in the scene.
+ *
+ * A builder reads either a JSON tree or a compiled manifest.  Widgets in a
+ * JSON tree are expanded as they are reached.  A builder does not lay out
+ * the scene once it is done.
+ */
+class Scene2Loader::Builder {
+private:
+    /** A node in a JSON tree waiting to be built */
+    struct Pending {
+        /** The name of the node */
+        std::string key;
+        /** The JSON defining the node */
+        std::shared_ptr<JsonValue> json;
+        /** The position of the parent node (or -1 for the root) */
+        int parent;
+    };
+    
+    /** The loader building the scene */
+    const Scene2Loader* _loader;
+    /** The JSON nodes waiting to be built */
+    std::deque<Pending> _pending;
+    /** The compiled manifest (nullptr for a JSON tree) */
+    std::shared_ptr<AssetManifest> _manifest;
+    /** The manifest records of the scene */
+    const AssetManifest::Entry* _entries;
+    /** The number of manifest records */
+    size_t _count;
+    
+    /** The nodes built so far (nullptr if a node failed) */
+    std::vector<std::shared_ptr<scene2::SceneNode>> _nodes;
+    /** The layout managers of the nodes built so far */
+    std::vector<std::shared_ptr<scene2::Layout>> _layouts;
+    /** Whether the nodes built so far are solids (so children ignore their color) */
+    std::vector<bool> _nonrelative;
+    
+    /**
+     * Creates the node for the given type and data, and attaches it to its parent.
+     *
+     * A node with an invalid parent is recorded as a failure, as is a
+     * node that could not be created.
+     *
+     * @param type      The node type
+     * @param name      The name of the node
+     * @param data      The node-specific data (may be nullptr)
+     * @param format    The layout manager for the children (may be nullptr)
+     * @param layout    The placement in the parent layout (may be nullptr)
+     * @param parent    The position of the parent node (or -1 for the root)
+     *
+     * @return the position of the new node
+     */
+    int append(Widget type, const std::string& name, const std::shared_ptr<JsonValue>& data,
+               const std::shared_ptr<JsonValue>& format, const std::shared_ptr<JsonValue>& layout,
+               int parent) {
+        std::shared_ptr<scene2::SceneNode> node = nullptr;
+        std::shared_ptr<scene2::Layout> manager = nullptr;
+        if (parent < 0 || _nodes[parent] != nullptr) {
+            node = _loader->createNode(type,data);
+        }
+        if (node != nullptr) {
+            manager = _loader->createLayout(format);
+            node->setLayout(manager);
+            node->setName(name);
+            if (parent >= 0) {
+                if (_nonrelative[parent]) {
+                    node->setRelativeColor(false);
+                }
+                _nodes[parent]->addChild(node);
+                if (_layouts[parent] != nullptr && layout != nullptr) {
+                    _layouts[parent]->add(name, layout);
+                }
+            }
+        }
+        _nodes.push_back(node);
+        _layouts.push_back(manager);
+        _nonrelative.push_back(node != nullptr && type == Widget::SOLID);
+        return (int)_nodes.size()-1;
+    }
+    
+    /**
+     * Builds the next node of a JSON tree.
+     *
+     * The children of the node are queued behind any nodes already waiting.
+     */
+    void stepJson() {
+        Pending item = _pending.front();
+        _pending.pop_front();
+        
+        std::shared_ptr<JsonValue> json = item.json;
+        if (item.parent >= 0 && json->has("type") && json->getString("type") == "Widget") {
+            json = _loader->getWidgetJson(json);
+        }
+        std::shared_ptr<JsonValue> layout = json->get("layout");
+        
+        std::string type = json->getString("type",UNKNOWN_STR);
+        auto it = _loader->_types.find(cugl::strtool::tolower(type));
+        while (it != _loader->_types.end() && it->second == Widget::EXTERNAL_IMPORT) {
+            json = _loader->getWidgetJson(json);
+            type = json->getString("type",UNKNOWN_STR);
+            it = _loader->_types.find(cugl::strtool::tolower(type));
+        }
+        
+        Widget widget = (it == _loader->_types.end() ? Widget::UNKNOWN : it->second);
+        int index = append(widget, item.key, json->get("data"), json->get("format"), layout, item.parent);
+        if (_nodes[index] == nullptr) {
+            return;
+        }
+        
+        std::shared_ptr<JsonValue> children = json->get("children");
+        if (children != nullptr) {
+            for (int ii = 0; ii < children->size(); ii++) {
+                std::shared_ptr<JsonValue> child = children->get(ii);
+                if (child->key() != "comment") {
+                    _pending.push_back({child->key(), child, index});
+                }
+            }
+        }
+    }
+    
+    /**
+     * Builds the next node of a compiled manifest.
+     */
+    void stepManifest() {
+        const AssetManifest::Entry& entry = _entries[_nodes.size()];
+        auto it = _loader->_types.find(_manifest->getString(entry.type));
+        Widget widget = (it == _loader->_types.end() ? Widget::UNKNOWN : it->second);
+        int parent = (entry.parent == AssetManifest::NONE ? -1 : (int)entry.parent);
+        append(widget, _manifest->getString(entry.name), _manifest->getJson(entry.data),
+               _manifest->getJson(entry.format), _manifest->getJson(entry.layout), parent);
+    }
+    
+public:
+    /**
+     * Creates a builder for the given JSON tree.
+     *
+     * @param loader    The loader building the scene
+     * @param key       The name of the root node
+     * @param json      The JSON object defining the scene (may be nullptr)
+     */
+    Builder(const Scene2Loader* loader, const std::string& key, const std::shared_ptr<JsonValue>& json) :
+    _loader(loader), _entries(nullptr), _count(0) {
+        if (json != nullptr) {
+            _pending.push_back({key, json, -1});
+        }
+    }
+    
+    /**
+     * Creates a builder for a scene in the given compiled manifest.
+     *
+     * @param loader    The loader building the scene
+     * @param manifest  The compiled manifest
+     * @param scene     The scene position in the manifest
+     */
+    Builder(const Scene2Loader* loader, const std::shared_ptr<AssetManifest>& manifest, size_t scene) :
+    _loader(loader), _manifest(manifest), _count(0) {
+        _entries = manifest->getSceneEntries(scene,_count);
+        _nodes.reserve(_count);
+        _layouts.reserve(_count);
+        _nonrelative.reserve(_count);
+    }
+    
+    /**
+     * Returns true if every node of the scene has been built.
+     *
+     * A scene whose root failed is finished immediately.
+     *
+     * @return true if every node of the scene has been built.
+     */
+    bool isDone() const {
+        if (!_nodes.empty() && _nodes[0] == nullptr) {
+            return true;
+        }
+        return (_manifest == nullptr ? _pending.empty() : _nodes.size() >= _count);
+    }
+    
+    /**
+     * Builds nodes until the scene is done or the time runs out.
+     *
+     * At least one node is built on each call, so the build always makes
+     * progress.  A budget of 0 builds the remainder of the scene.
+     *
+     * @param budget    The time to spend (in microseconds)
+     *
+     * @return true if every node of the scene has been built.
+     */
+    bool advance(Uint32 budget) {
+        Timestamp start;
+        Timestamp now;
+        while (!isDone()) {
+            if (_manifest == nullptr) {
+                stepJson();
+            } else {
+                stepManifest();
+            }
+            if (budget > 0) {
+                now.mark();
+                if (Timestamp::ellapsedMicros(start,now) >= budget) {
+                    break;
+                }
+            }
+        }
+        return isDone();
+    }
+    
+    /**
+     * Returns the root of the scene (or nullptr if it failed).
+     *
+     * The scene is incomplete if this builder is not done.
+     *
+     * @return the root of the scene (or nullptr if it failed).
+     */
+    std::shared_ptr<scene2::SceneNode> getRoot() const {
+        return _nodes.empty() ? nullptr : _nodes[0];
+    }
+};
+
+
 /**
  * Initializes a new asset loader.
  *
@@ -88,6 +319,7 @@ bool Scene2Loader::init(const std::shared_ptr<ThreadPool>& threads) {
     _types["path"] = Widget::PATH;
     _types["wireframe"] = Widget::WIRE;
     _types["animation"] = Widget::ANIMATE;
+    _types["streamed animation"] = Widget::STREAM;
     _types["ninepatch"] = Widget::NINE;
     _types["label"] = Widget::LABEL;
     _types["button"] = Widget::BUTTON;
@@ -95,6 +327,7 @@ bool Scene2Loader::init(const std::shared_ptr<ThreadPool>& threads) {
     _types["slider"] = Widget::SLIDER;
     _types["textfield"] = Widget::TEXTFIELD;
     _types["text field"] = Widget::TEXTFIELD;
+    _types["cached"] = Widget::CACHED;
 	_types["widget"] = Widget::EXTERNAL_IMPORT;
 
     // Define the supported layouts
@@ -138,26 +371,61 @@ bool Scene2Loader::init(const std::shared_ptr<ThreadPool>& threads) {
  */
 std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string& key,
                                                       const std::shared_ptr<JsonValue>& json) const {
-    std::string type = json->getString("type",UNKNOWN_STR);
-    auto it = _types.find(cugl::strtool::tolower(type));
-    if (it == _types.end()) {
-        return nullptr;
-    }
+    Builder builder(this,key,json);
+    builder.advance(0);
     
-    bool nonrelative = false;
-    std::shared_ptr<JsonValue> data = json->get("data");
+    // Do not perform layout yet.
+    return builder.getRoot();
+}
+
+
+/**
+ * Builds the given scene from a compiled manifest.
+ *
+ * This method is the compiled version of {@link build}.  The manifest has
+ * already expanded all widgets, and lists the scene graph nodes in creation
+ * order (so every parent is created before its children).  Hence this
+ * method is not recursive and parses no JSON.  The node data is rebuilt
+ * directly from the manifest records.
+ *
+ * The key of the scene is assigned as the name of the root Node.
+ *
+ * @param manifest  The compiled manifest
+ * @param scene     The scene position in the manifest
+ *
+ * @return the root of the scene graph
+ */
+std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::shared_ptr<AssetManifest>& manifest,
+                                                      size_t scene) const {
+    Builder builder(this,manifest,scene);
+    builder.advance(0);
+    
+    // Do not perform layout yet.
+    return builder.getRoot();
+}
+
+/**
+ * Returns a newly allocated scene graph node of the given type.
+ *
+ * The node is initialized with the given data.  If the node has no content
+ * size after initialization, it is anchored at the bottom left and given
+ * the size of the display.  This method does not support widgets, which
+ * must be expanded first.
+ *
+ * @param type  The node type
+ * @param data  The node-specific data (may be nullptr)
+ *
+ * @return a newly allocated scene graph node of the given type.
+ */
+std::shared_ptr<scene2::SceneNode> Scene2Loader::createNode(Widget type,
+                                                           const std::shared_ptr<JsonValue>& data) const {
     std::shared_ptr<scene2::SceneNode> node = nullptr;
-    switch (it->second) {
+    switch (type) {
     case Widget::NODE:
         node = scene2::SceneNode::allocWithData(this,data);
         break;
     case Widget::IMAGE:
-        node = scene2::PolygonNode::allocWithData(this,data);
-        break;
     case Widget::SOLID:
-        node = scene2::PolygonNode::allocWithData(this,data);
-        nonrelative = true;
-        break;
     case Widget::POLY:
         node = scene2::PolygonNode::allocWithData(this,data);
         break;
@@ -170,6 +438,9 @@ std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string& key,
     case Widget::ANIMATE:
         node = scene2::AnimationNode::allocWithData(this,data);
         break;
+    case Widget::STREAM:
+        node = scene2::StreamedAnimationNode::allocWithData(this,data);
+        break;
     case Widget::NINE:
         node = scene2::NinePatch::allocWithData(this,data);
         break;
@@ -188,26 +459,32 @@ std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string& key,
     case Widget::TEXTFIELD:
         node = scene2::TextField::allocWithData(this,data);
         break;
-	case Widget::EXTERNAL_IMPORT: 
-	{
-		const std::shared_ptr<JsonValue> widgetJson = getWidgetJson(json);
-		return build(key, widgetJson);
-	}
+    case Widget::CACHED:
+        node = scene2::CachedNode::allocWithData(this,data);
+        break;
+    case Widget::EXTERNAL_IMPORT:
     case Widget::UNKNOWN:
         break;
     }
     
-    if (node == nullptr) {
-        return nullptr;
-    }
-    
-    if (node->getContentSize() == Size::ZERO) {
+    if (node != nullptr && node->getContentSize() == Size::ZERO) {
         node->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
         node->setContentSize(Application::get()->getDisplaySize());
     }
-    
-    
-    std::shared_ptr<JsonValue> form = json->get("format");
+    return node;
+}
+
+/**
+ * Returns a newly allocated layout manager for the given format.
+ *
+ * This method returns nullptr if the format is missing, or if it specifies
+ * absolute positioning.
+ *
+ * @param form  The "format" attribute of a scene graph node (may be nullptr)
+ *
+ * @return a newly allocated layout manager for the given format.
+ */
+std::shared_ptr<scene2::Layout> Scene2Loader::createLayout(const std::shared_ptr<JsonValue>& form) const {
     std::string ftype =  (form == nullptr ? UNKNOWN_STR : form->getString("type",UNKNOWN_STR));
     auto jt = _forms.find(cugl::strtool::tolower(ftype));
     
@@ -228,39 +505,9 @@ std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string& key,
             break;
         }
     }
-    node->setLayout(layout);
-    
-    std::shared_ptr<JsonValue> children = json->get("children");
-	if (children != nullptr) {
-		for (int ii = 0; ii < children->size(); ii++) {
-			std::shared_ptr<JsonValue> item = children->get(ii);
-			std::string key = item->key();
-			if (key != "comment") {
-				// If this is a widget, use the loaded widget json instead
-				if (item->has("type") && item->getString("type") == "Widget") {
-					item = getWidgetJson(item);
-				}
-
-				std::shared_ptr<scene2::SceneNode> kid = build(key, item);
-                if (nonrelative) {
-                    kid->setRelativeColor(false);
-                }
-				node->addChild(kid);
-
-				if (layout != nullptr && item->has("layout")) {
-					std::shared_ptr<JsonValue> posit = item->get("layout");
-					layout->add(key, posit);
-				}
-			}
-		}
-	}
-    
-    // Do not perform layout yet.
-    node->setName(key);
-    return node;
+    return layout;
 }
 
-
 /**
  * Translates the JSON of a widget to the JSON of the node that it encodes.
  *
@@ -273,54 +520,11 @@ std::shared_ptr<scene2::SceneNode> Scene2Loader::build(const std::string& key,
 std::shared_ptr<JsonValue> Scene2Loader::getWidgetJson(const std::shared_ptr<JsonValue>& json) const {
 	std::shared_ptr<JsonValue> data = json->get("data");
 	std::string widgetSource = data->getString("key");
-	std::shared_ptr<JsonValue> widgetVars = data->get("variables");
-	std::shared_ptr<JsonValue> layout = json->get("layout");
-
 	const std::shared_ptr<WidgetValue> widget = _manager->get<WidgetValue>(widgetSource);
 
 	CUAssertLog(widget != nullptr, "No widget found with name %s", widgetSource.c_str());
 
-	const std::shared_ptr<JsonValue> widgetJson = widget->getJson();
-
-	std::shared_ptr<JsonValue> variables = widgetJson->get("variables");
-	std::shared_ptr<JsonValue> contents = widgetJson->get("contents");
-	std::string contentString = contents->toString();
-	std::shared_ptr<JsonValue> contentCopy = JsonValue::allocWithJson(contentString);
-    if (widgetVars) {
-        for (int ii = 0; ii < widgetVars->size(); ii++) {
-            auto child = widgetVars->get(ii);
-            if (variables->has(child->key())) {
-                bool found = true;
-                std::shared_ptr<JsonValue> address = variables->get(child->key());
-                std::shared_ptr<JsonValue> spotToChange = contentCopy;
-                std::vector<std::string> sAry = address->asStringArray();
-                for (std::string s : sAry) {
-                    if (spotToChange->has(s)) {
-                        spotToChange = spotToChange->get(s);
-                    }
-                    else {
-                        found = false;
-                    }
-                }
-                if (found) {
-                    spotToChange->merge(child);
-                } else {
-                    std::string err = "No variable found within widget " + widgetSource + " matching name " + child->key();
-                    CULogError("%s",err.c_str());
-                }
-            }
-        }
-	}
-
-	// reassign the layout if it exists
-	if (layout != nullptr) {
-		std::shared_ptr<JsonValue> contentsLayout = contentCopy->get("layout");
-		if (contentsLayout == nullptr) {
-			contentCopy->appendChild("layout", std::make_shared<JsonValue>());
-			contentsLayout = contentCopy->get("layout");
-		}
-		contentsLayout->merge(layout);
-	}
+	std::shared_ptr<JsonValue> contentCopy = widget->substitute(json);
 
 	// now recursively check to see if this was a widget
 	if (contentCopy->has("type") && contentCopy->getString("type") == "Widget") {
@@ -389,19 +593,37 @@ bool Scene2Loader::read(const std::string& key, const std::string& source,
 
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+        std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
-        node->doLayout();
         if (node != nullptr) {
+            node->doLayout();
             success = true;
             materialize(node,callback);
         } else {
             _queue.erase(key);
         }
+    } else if (_budget > 0) {
+        // Only parse on the loader thread; build in slices on the main thread
+        Uint32 budget = _budget;
+        _loader->addTask([=](void) {
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
+            std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
+            this->schedule(std::make_shared<Builder>(this,key,json), budget,
+                           [=](const std::shared_ptr<scene2::SceneNode>& node) {
+                if (node == nullptr) {
+                    this->_queue.erase(key);
+                    if (callback != nullptr) {
+                        callback(key,false);
+                    }
+                } else {
+                    this->materialize(node,callback);
+                }
+            });
+        });
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
             node->doLayout();
@@ -458,13 +680,26 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     bool success = false;
     if (_loader == nullptr || !async) {
         std::shared_ptr<scene2::SceneNode> node = build(key,json);
-        node->doLayout();
         if (node != nullptr) {
+            node->doLayout();
             success = true;
             materialize(node,callback);
         } else {
             _queue.erase(key);
         }
+    } else if (_budget > 0) {
+        // The JSON is already parsed, so there is nothing for the loader thread
+        schedule(std::make_shared<Builder>(this,key,json), _budget,
+                 [=](const std::shared_ptr<scene2::SceneNode>& node) {
+            if (node == nullptr) {
+                this->_queue.erase(key);
+                if (callback != nullptr) {
+                    callback(key,false);
+                }
+            } else {
+                this->materialize(node,callback);
+            }
+        });
     } else {
         _loader->addTask([=](void) {
             std::shared_ptr<scene2::SceneNode> node = build(key,json);
@@ -479,6 +714,195 @@ bool Scene2Loader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
     return success;
 }
 
+/**
+ * Internal method to support loading from a compiled manifest.
+ *
+ * This method supports either synchronous or asynchronous loading, as
+ * specified by the given parameter.  If the loading is asynchronous,
+ * the user may specify an optional callback function.
+ *
+ * This method is like the traditional read method except that the scene
+ * is built from a compiled manifest.  The scene is stored using its key
+ * in the manifest.
+ *
+ * @param manifest  The compiled manifest
+ * @param scene     The scene position in the manifest
+ * @param callback  An optional callback for asynchronous loading
+ * @param async     Whether the asset was loaded asynchronously
+ *
+ * @return true if the asset was successfully loaded
+ */
+bool Scene2Loader::read(const std::shared_ptr<AssetManifest>& manifest, size_t scene,
+                        LoaderCallback callback, bool async) {
+    std::string key = manifest->getSceneKey(scene);
+    if (_assets.find(key) != _assets.end() || _queue.find(key) != _queue.end()) {
+        return false;
+    }
+    _queue.emplace(key);
+    
+    bool success = false;
+    if (_loader == nullptr || !async) {
+        verify(manifest,scene);
+        std::shared_ptr<scene2::SceneNode> node = build(manifest,scene);
+        if (node != nullptr) {
+            node->doLayout();
+            success = true;
+            materialize(node,callback);
+        } else {
+            _queue.erase(key);
+        }
+    } else if (_budget > 0) {
+        // The manifest is already in memory, so there is nothing for the loader thread
+        verify(manifest,scene);
+        schedule(std::make_shared<Builder>(this,manifest,scene), _budget,
+                 [=](const std::shared_ptr<scene2::SceneNode>& node) {
+            if (node == nullptr) {
+                this->_queue.erase(key);
+                if (callback != nullptr) {
+                    callback(key,false);
+                }
+            } else {
+                this->materialize(node,callback);
+            }
+        });
+    } else {
+        _loader->addTask([=](void) {
+            verify(manifest,scene);
+            std::shared_ptr<scene2::SceneNode> node = build(manifest,scene);
+            if (node != nullptr) {
+                node->doLayout();
+            }
+            Application::get()->schedule([=](void) {
+                if (node == nullptr) {
+                    this->_queue.erase(key);
+                    if (callback != nullptr) {
+                        callback(key,false);
+                    }
+                } else {
+                    this->materialize(node,callback);
+                }
+                return false;
+            });
+        });
+    }
+    
+    return success;
+}
+
+/**
+ * Runs the given builder on the main thread until it is finished.
+ *
+ * The builder is advanced once every animation frame, for at most the
+ * given number of microseconds (0 finishes it in a single frame).  When
+ * it is finished, the scene is laid out and passed to the callback.  The
+ * callback receives nullptr if the scene could not be built.
+ *
+ * @param builder   The scene builder
+ * @param budget    The time to spend each frame (in microseconds)
+ * @param callback  The callback for the finished scene
+ */
+void Scene2Loader::schedule(const std::shared_ptr<Builder>& builder, Uint32 budget,
+                            std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback) {
+    Application::get()->schedule([=](void) {
+        if (!builder->advance(budget)) {
+            return true;
+        }
+        std::shared_ptr<scene2::SceneNode> scene = builder->getRoot();
+        if (scene != nullptr) {
+            scene->doLayout();
+        }
+        callback(scene);
+        return false;
+    });
+}
+
+/**
+ * Incrementally builds a new scene from the given JSON tree.
+ *
+ * The scene is built on the main thread, a few nodes at a time, spending
+ * at most budget microseconds each animation frame.  A budget of 0 builds
+ * the entire scene in the next frame.  This method returns immediately.
+ *
+ * Once the scene is built, it is laid out and passed to the callback.
+ * The callback receives nullptr if the scene could not be built. The
+ * scene is not added to the asset manager, so each call produces a new
+ * copy of the scene. The key is assigned as the name of the root Node.
+ *
+ * The JSON tree has the same format as a scene file.  In particular, any
+ * widgets it uses must already be loaded.
+ *
+ * @param key       The name of the root node
+ * @param json      The JSON object defining the scene
+ * @param budget    The time to spend each frame (in microseconds)
+ * @param callback  The callback for the finished scene
+ */
+void Scene2Loader::instantiate(const std::string& key, const std::shared_ptr<JsonValue>& json, Uint32 budget,
+                               std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback) {
+    schedule(std::make_shared<Builder>(this,key,json), budget, callback);
+}
+
+/**
+ * Incrementally builds a new scene from a compiled manifest.
+ *
+ * The scene is built on the main thread, a few nodes at a time, spending
+ * at most budget microseconds each animation frame.  A budget of 0 builds
+ * the entire scene in the next frame.  This method returns immediately.
+ *
+ * Once the scene is built, it is laid out and passed to the callback.
+ * The callback receives nullptr if the scene could not be built. The
+ * scene is not added to the asset manager, so each call produces a new
+ * copy of the scene. The key of the scene in the manifest is assigned as
+ * the name of the root Node.
+ *
+ * @param manifest  The compiled manifest
+ * @param scene     The scene position in the manifest
+ * @param budget    The time to spend each frame (in microseconds)
+ * @param callback  The callback for the finished scene
+ */
+void Scene2Loader::instantiate(const std::shared_ptr<AssetManifest>& manifest, size_t scene, Uint32 budget,
+                               std::function<void(const std::shared_ptr<scene2::SceneNode>& scene)> callback) {
+    verify(manifest,scene);
+    schedule(std::make_shared<Builder>(this,manifest,scene), budget, callback);
+}
+
+/**
+ * Returns true if all of the dependencies of the given scene are loaded.
+ *
+ * This method logs a warning for every texture or font of the scene that
+ * is not yet loaded.  Such a scene can still be built, but those nodes
+ * will be missing their images or fonts.
+ *
+ * @param manifest  The compiled manifest
+ * @param scene     The scene position in the manifest
+ *
+ * @return true if all of the dependencies of the given scene are loaded.
+ */
+bool Scene2Loader::verify(const std::shared_ptr<AssetManifest>& manifest, size_t scene) const {
+    if (_manager == nullptr) {
+        return true;
+    }
+    
+    size_t count = 0;
+    const AssetManifest::Dependency* depends = manifest->getSceneDependencies(scene,count);
+    bool success = true;
+    for(size_t ii = 0; ii < count; ii++) {
+        std::string category = manifest->getString(depends[ii].category);
+        std::string key = manifest->getString(depends[ii].key);
+        bool missing = false;
+        if (category == "textures" && _manager->isAttached<Texture>()) {
+            missing = (_manager->get<Texture>(key) == nullptr);
+        } else if (category == "fonts" && _manager->isAttached<Font>()) {
+            missing = (_manager->get<Font>(key) == nullptr);
+        }
+        if (missing) {
+            CUWarn("Scene '%s' requires %s '%s', which is not loaded",
+                   manifest->getSceneKey(scene).c_str(), category.c_str(), key.c_str());
+            success = false;
+        }
+    }
+    return success;
+}
+
 /**
  * Unloads the asset for the given directory entry
  *
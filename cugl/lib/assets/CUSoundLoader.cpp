@@ -187,6 +187,7 @@ bool SoundLoader::read(const std::string& key, const std::string& source, Loader
  *
  *      "file":         The path to the asset
  *      "volume":       This default sound volume (float)
+ *      "format":       The in-memory sample format ("float", "int16", "adpcm")
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -237,3 +238,18 @@ bool SoundLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback ca
     
     return success;
 }
+
+/**
+ * Returns the memory footprint of the given sound in bytes.
+ *
+ * This is the size of the decoded samples of an {@link AudioSample}.
+ * Streamed samples and generated sounds have a footprint of 0.
+ *
+ * @param asset The sound to measure
+ *
+ * @return the memory footprint of the given sound in bytes.
+ */
+size_t SoundLoader::measure(const std::shared_ptr<Sound>& asset) const {
+    std::shared_ptr<AudioSample> sample = std::dynamic_pointer_cast<AudioSample>(asset);
+    return sample == nullptr ? 0 : sample->getFootprint();
+}
@@ -45,7 +45,10 @@
 //
 #include <cugl/assets/CUTextureLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/util/CUFiletools.h>
 #include <SDL/SDL_image.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace cugl;
 
@@ -58,6 +61,8 @@ using namespace cugl;
 #define UNKNOWN_MAGFLT  "linear"
 /** The default wrap rule */
 #define UNKNOWN_WRAP    "clamp"
+/** Devices with at most this much memory (in MB) load at most half resolution */
+#define LOW_MEMORY_RAM  2048
 
 /**
  * Returns the OpenGL enum for the given min filter name
@@ -138,7 +143,10 @@ _minfilter(GL_LINEAR),
 _magfilter(GL_LINEAR),
 _wraps(GL_CLAMP_TO_EDGE),
 _wrapt(GL_CLAMP_TO_EDGE),
-_mipmaps(false) {
+_mipmaps(false),
+_compressed(true),
+_resolution(0),
+_reference(0) {
 }
 
 
@@ -182,6 +190,103 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
     return normal;
 }
 
+/**
+ * Loads the cooked counterpart of this asset, if it exists.
+ *
+ * The cooked counterpart is the KTX file with the same path as the source,
+ * but with the extension ".ktx".  This method returns nullptr if compressed
+ * textures are disabled, the file does not exist, or the GPU does not
+ * support its format.  It also returns nullptr if mipmaps are required
+ * but the file does not include them, as compressed textures cannot
+ * generate their own mipmaps.
+ *
+ * This method is safe to call outside of the main thread, provided that
+ * {@link CompressedImage#isSupported} has been called at least once in
+ * the main thread.
+ *
+ * @param source    The pathname to the asset
+ * @param mipmaps   Whether the texture requires mipmaps
+ *
+ * @return the compressed image for this asset (or nullptr)
+ */
+std::shared_ptr<CompressedImage> TextureLoader::preloadCompressed(const std::string& source, bool mipmaps) {
+    if (!_compressed) {
+        return nullptr;
+    }
+    
+    std::string path = Application::get()->getAssetDirectory();
+    path.append(filetool::set_suffix(source,"ktx"));
+    std::shared_ptr<CompressedImage> image = CompressedImage::allocWithFile(path);
+    if (image == nullptr || !CompressedImage::isSupported(image->getFormat())) {
+        return nullptr;
+    } else if (mipmaps && image->getLevelCount() == 1) {
+        return nullptr;
+    }
+    return image;
+}
+
+/**
+ * Returns the source file for the best resolution variant of this asset.
+ *
+ * A texture directory entry may have a "variants" attribute, which maps
+ * the scale of each variant (as a string) to its source file.  This method
+ * picks the smallest variant with a scale no less than {@link #getResolution}.
+ * If there is no such variant, it returns the "file" attribute, which has
+ * scale 1.
+ *
+ * @param json          The directory entry for the asset
+ * @param resolution    Stores the scale of the chosen variant
+ *
+ * @return the source file for the best resolution variant of this asset.
+ */
+std::string TextureLoader::selectVariant(const std::shared_ptr<JsonValue>& json, float& resolution) const {
+    std::string source = json->getString("file",UNKNOWN_SOURCE);
+    resolution = 1;
+    
+    JsonValue* variants = json->get("variants").get();
+    if (variants == nullptr) {
+        return source;
+    }
+    
+    float target = getResolution();
+    for(unsigned int ii = 0; ii < variants->size(); ii++) {
+        JsonValue* item = variants->get(ii).get();
+        float scale = (float)atof(item->key().c_str());
+        if (scale <= 0 || scale > 1) {
+            CULogError("Texture '%s' has an invalid variant scale '%s'",
+                       json->key().c_str(), item->key().c_str());
+        } else if (scale >= target && scale < resolution) {
+            resolution = scale;
+            source = item->asString();
+        }
+    }
+    return source;
+}
+
+/**
+ * Assigns the variant resolution to a newly loaded texture.
+ *
+ * This method logs an error if the variant does not scale evenly to the
+ * full resolution size, as any atlas regions or filmstrip frames would
+ * then be misaligned.
+ *
+ * @param texture       The loaded texture
+ * @param key           The key of the texture asset
+ * @param resolution    The scale of the variant
+ */
+void TextureLoader::applyVariant(const std::shared_ptr<Texture>& texture, const std::string& key, float resolution) {
+    if (resolution == 1) {
+        return;
+    }
+    texture->setResolution(resolution);
+    Size pixels = texture->getPixelSize();
+    float width  = pixels.width/resolution;
+    float height = pixels.height/resolution;
+    if (fabsf(width-roundf(width)) > 0.01f || fabsf(height-roundf(height)) > 0.01f) {
+        CULogError("Texture '%s' does not scale evenly by %g", key.c_str(), resolution);
+    }
+}
+
 /**
  * Creates an OpenGL texture from the SDL_Surface, and assigns it the given key.
  *
@@ -195,12 +300,22 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
  * This method supports an optional callback function which reports whether
  * the asset was successfully materialized.
  *
+ * If the compressed image is not nullptr, it is used in place of the
+ * surface.
+ *
  * @param key       The key to access the asset after loading
  * @param surface   The SDL_Surface to convert
+ * @param image     The compressed image to upload (or nullptr)
  * @param callback  An optional callback for asynchronous loading
  */
-void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+void TextureLoader::materialize(const std::string& key, SDL_Surface* surface,
+                                const std::shared_ptr<CompressedImage>& image, LoaderCallback callback) {
+    std::shared_ptr<Texture> texture = nullptr;
+    if (image != nullptr) {
+        texture = Texture::allocWithImage(image);
+    } else if (surface != nullptr) {
+        texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+    }
     
     bool success = false;
     if (texture != nullptr) {
@@ -218,7 +333,9 @@ void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, Lo
     if (callback != nullptr) {
         callback(key,success);
     }
-    SDL_FreeSurface(surface);
+    if (surface != nullptr) {
+        SDL_FreeSurface(surface);
+    }
     _queue.erase(key);
 }
                                 
@@ -240,18 +357,34 @@ void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, Lo
  *      "magfilter":    The name of the min filter ("nearest" or "linear")
  *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
  *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+ *      "variants":     An object mapping scales (e.g. "0.5") to reduced variants
  *
  * The asset key is the key for the JSON directory entry
  *
  * This method supports an optional callback function which reports whether
  * the asset was successfully materialized.
  *
- * @param json      The asset directory entry
- * @param surface   The SDL_Surface to convert
- * @param callback  An optional callback for asynchronous loading
+ * If the compressed image is not nullptr, it is used in place of the
+ * surface.
+ *
+ * The resolution is the scale of the chosen variant, as returned by
+ * {@link #selectVariant}.
+ *
+ * @param json          The asset directory entry
+ * @param surface       The SDL_Surface to convert
+ * @param image         The compressed image to upload (or nullptr)
+ * @param resolution    The scale of the chosen variant
+ * @param callback      An optional callback for asynchronous loading
  */
-void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback) {
-    std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface,
+                                const std::shared_ptr<CompressedImage>& image, float resolution,
+                                LoaderCallback callback) {
+    std::shared_ptr<Texture> texture = nullptr;
+    if (image != nullptr) {
+        texture = Texture::allocWithImage(image);
+    } else if (surface != nullptr) {
+        texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
+    }
     std::string key = json->key();
 
     bool success = false;
@@ -263,6 +396,7 @@ void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surf
         bool mipmaps = json->getBool("mipmaps",false);
 
         _assets[key] = texture;
+        applyVariant(texture, key, resolution);
         texture->bind();
         if (mipmaps) { texture->buildMipMaps(); }
         texture->setMinFilter(minflt);
@@ -278,7 +412,9 @@ void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surf
     if (callback != nullptr) {
         callback(key,success);
     }
-    SDL_FreeSurface(surface);
+    if (surface != nullptr) {
+        SDL_FreeSurface(surface);
+    }
     _queue.erase(key);
 }
 
@@ -308,17 +444,27 @@ bool TextureLoader::read(const std::string& key, const std::string& source, Load
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
+        std::shared_ptr<CompressedImage> image = preloadCompressed(source,_mipmaps);
+        std::shared_ptr<Texture> texture;
+        if (image != nullptr) {
+            texture = Texture::allocWithImage(image);
+        } else {
+            texture = Texture::allocWithFile(source);
+        }
         success = (texture != nullptr);
         if (success) { 
 			_assets[key] = texture;
 		}
         _queue.erase(key);
     } else {
+        // Query the GPU formats in the main thread
+        bool mipmaps = _mipmaps;
+        CompressedImage::isSupported(CompressedImage::Format::ETC2_RGBA);
         _loader->addTask([=](void) {
-            SDL_Surface* surface = this->preload(source);
+            std::shared_ptr<CompressedImage> image = this->preloadCompressed(source,mipmaps);
+            SDL_Surface* surface = image == nullptr ? this->preload(source) : nullptr;
             Application::get()->schedule([=](void){
-                this->materialize(key,surface,callback);
+                this->materialize(key,surface,image,callback);
                 return false;
             });
         });
@@ -360,6 +506,7 @@ bool TextureLoader::read(const std::string& key, const std::string& source, Load
  *      "magfilter":    The name of the min filter ("nearest" or "linear")
  *      "wrapS":        The s-coord wrap rule ("clamp", "repeat", or "mirrored")
  *      "wrapT":        The t-coord wrap rule ("clamp", "repeat", or "mirrored")
+ *      "variants":     An object mapping scales (e.g. "0.5") to reduced variants
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -374,20 +521,31 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
     }
     _queue.emplace(key);
     
-    std::string source = json->getString("file",UNKNOWN_SOURCE);
+    float resolution;
+    std::string source = selectVariant(json,resolution);
+    bool mipmaps = json->getBool("mipmaps",false);
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<Texture> texture = Texture::allocWithFile(source);
+        std::shared_ptr<CompressedImage> image = preloadCompressed(source,mipmaps);
+        std::shared_ptr<Texture> texture;
+        if (image != nullptr) {
+            texture = Texture::allocWithImage(image);
+        } else {
+            texture = Texture::allocWithFile(source);
+        }
         success = (texture != nullptr);
         if (success) { 
 			_assets[key] = texture;
 		}
         _queue.erase(key);
     } else {
+        // Query the GPU formats in the main thread
+        CompressedImage::isSupported(CompressedImage::Format::ETC2_RGBA);
         _loader->addTask([=](void) {
-            SDL_Surface* surface = this->preload(source);
+            std::shared_ptr<CompressedImage> image = this->preloadCompressed(source,mipmaps);
+            SDL_Surface* surface = image == nullptr ? this->preload(source) : nullptr;
             Application::get()->schedule([=](void){
-                this->materialize(json,surface,callback);
+                this->materialize(json,surface,image,resolution,callback);
                 return false;
             });
         });
@@ -399,9 +557,9 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
         GLuint magflt = decodeMinFilter(json->getString("magfilter",UNKNOWN_MAGFLT));
         GLuint wrapS = decodeWrap(json->getString("wrapS",UNKNOWN_WRAP));
         GLuint wrapT = decodeWrap(json->getString("wrapT",UNKNOWN_WRAP));
-        bool mipmaps = json->getBool("mipmaps",false);
         
         std::shared_ptr<Texture> texture = get(key);
+        applyVariant(texture, key, resolution);
         texture->bind();
         if (mipmaps) { texture->buildMipMaps(); }
         texture->setMinFilter(minflt);
@@ -456,6 +614,51 @@ bool TextureLoader::purge(const std::shared_ptr<JsonValue>& json) {
     return success;
 }
 
+/**
+ * Returns the memory footprint of the given texture in bytes.
+ *
+ * This is the size of the texture data on the GPU, including any mipmaps.
+ * Subtextures share the memory of their parent, so their footprint is 0.
+ * As a result, a texture with an atlas is never evicted while any of its
+ * subtextures remain loaded.
+ *
+ * @param asset The texture to measure
+ *
+ * @return the memory footprint of the given texture in bytes.
+ */
+size_t TextureLoader::measure(const std::shared_ptr<Texture>& asset) const {
+    return asset == nullptr ? 0 : asset->getFootprint();
+}
+
+#pragma mark -
+#pragma mark Properties
+/**
+ * Returns the resolution requested for texture variants.
+ *
+ * This is the minimum scale (relative to the full resolution image) of
+ * any variant chosen by this loader.  If it has not been set explicitly,
+ * it is computed from the display width and the {@link #getReferenceWidth}.
+ * Devices with little memory never request more than half resolution.
+ * The result is never more than 1.
+ *
+ * @return the resolution requested for texture variants.
+ */
+float TextureLoader::getResolution() const {
+    if (_resolution > 0) {
+        return std::min(_resolution,1.0f);
+    }
+    
+    float result = 1;
+    Application* app = Application::get();
+    if (app != nullptr && _reference > 0) {
+        result = std::min(result,app->getDisplaySize().width/_reference);
+    }
+    if (SDL_GetSystemRAM() <= LOW_MEMORY_RAM) {
+        result = std::min(result,0.5f);
+    }
+    return result;
+}
+
 #pragma mark -
 #pragma mark Atlas Support
 /**
@@ -111,14 +111,14 @@ bool WidgetLoader::read(const std::string& key, const std::string& source, Loade
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+        std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=](void) {
@@ -143,7 +143,9 @@ bool WidgetLoader::read(const std::string& key, const std::string& source, Loade
  * loading is safe.
  *
  * This version of read provides support for JSON directories. A widget
- * directory entry is comprised of a single named string attribute.
+ * directory entry is comprised of a single named string attribute. If the
+ * entry is an object instead, it is the widget definition itself (this is
+ * how compiled manifests store widgets).
  *
  * @param json      The directory entry for the asset
  * @param callback  An optional callback for asynchronous loading
@@ -157,18 +159,32 @@ bool WidgetLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback c
         return false;
     }
     _queue.emplace(key);
+    
+    // Compiled manifests inline the widget instead of naming its file
+    if (json->isObject()) {
+        std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
+        if (_loader == nullptr || !async) {
+            materialize(key,widget,callback);
+        } else {
+            Application::get()->schedule([=](void) {
+                this->materialize(key,widget,callback);
+                return false;
+            });
+        }
+        return widget != nullptr;
+    }
     std::string source = json->asString(UNKNOWN_SOURCE);
     
     bool success = false;
     if (_loader == nullptr || !async) {
-        std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+        std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
         std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 		std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
         success = (widget != nullptr);
         materialize(key,widget,callback);
     } else {
         _loader->addTask([=](void) {
-            std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(source);
+            std::shared_ptr<JsonReader> reader = JsonReader::allocWithMapping(MappedFile::allocWithAsset(source));
             std::shared_ptr<JsonValue> json = (reader == nullptr ? nullptr : reader->readJson());
 			std::shared_ptr<WidgetValue> widget = WidgetValue::alloc(json);
             Application::get()->schedule([=](void) {
@@ -0,0 +1,109 @@
+//
+//  CUWidgetValue.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for externally defined widgets in the scene
+//  graph JSON.  A widget is a JSON tree with exposed variables, and a scene
+//  entry of type "Widget" is replaced by a copy of that tree with the
+//  variables set.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/assets/CUWidgetValue.h>
+#include <cugl/util/CUDebug.h>
+
+using namespace cugl;
+
+/**
+ * Returns the JSON of the node encoded by this widget for the given instance.
+ *
+ * The instance is a scene graph entry of type "Widget".  The values in its
+ * "variables" object replace the exposed variables of this widget, and its
+ * "layout" replaces the layout of the widget contents.  The result is a new
+ * copy of the widget contents.
+ *
+ * If the contents are themselves a widget, this method does not expand
+ * them.  That is the responsibility of the caller.
+ *
+ * @param instance  The JSON entry using this widget
+ *
+ * @return the JSON of the node encoded by this widget for the given instance.
+ */
+std::shared_ptr<JsonValue> WidgetValue::substitute(const std::shared_ptr<JsonValue>& instance) const {
+	std::shared_ptr<JsonValue> data = instance->get("data");
+	std::string widgetSource = data->getString("key");
+	std::shared_ptr<JsonValue> widgetVars = data->get("variables");
+	std::shared_ptr<JsonValue> layout = instance->get("layout");
+
+	std::shared_ptr<JsonValue> variables = json->get("variables");
+	std::shared_ptr<JsonValue> contents = json->get("contents");
+	std::string contentString = contents->toString();
+	std::shared_ptr<JsonValue> contentCopy = JsonValue::allocWithJson(contentString);
+    if (widgetVars) {
+        for (unsigned int ii = 0; ii < widgetVars->size(); ii++) {
+            auto child = widgetVars->get(ii);
+            if (variables->has(child->key())) {
+                bool found = true;
+                std::shared_ptr<JsonValue> address = variables->get(child->key());
+                std::shared_ptr<JsonValue> spotToChange = contentCopy;
+                std::vector<std::string> sAry = address->asStringArray();
+                for (std::string s : sAry) {
+                    if (spotToChange->has(s)) {
+                        spotToChange = spotToChange->get(s);
+                    }
+                    else {
+                        found = false;
+                    }
+                }
+                if (found) {
+                    spotToChange->merge(child);
+                } else {
+                    std::string err = "No variable found within widget " + widgetSource + " matching name " + child->key();
+                    CULogError("%s",err.c_str());
+                }
+            }
+        }
+	}
+
+	// reassign the layout if it exists
+	if (layout != nullptr) {
+		std::shared_ptr<JsonValue> contentsLayout = contentCopy->get("layout");
+		if (contentsLayout == nullptr) {
+			contentCopy->appendChild("layout", std::make_shared<JsonValue>());
+			contentsLayout = contentCopy->get("layout");
+		}
+		contentsLayout->merge(layout);
+	}
+	return contentCopy;
+}
@@ -36,7 +36,12 @@
 #include <cugl/audio/CUAudioDevices.h>
 #include <cugl/audio/graph/CUAudioOutput.h>
 #include <cugl/audio/graph/CUAudioInput.h>
+#include <cugl/audio/graph/CUAudioNode.h>
+#include <cugl/audio/codecs/CUAudioReadAhead.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUThreadPool.h>
 #include <cugl/util/CUDebug.h>
+#include <algorithm>
 
 using namespace cugl;
 
@@ -83,6 +88,9 @@ const Uint32 AudioDevices::DEFAULT_OUTPUT_BUFFER = 1024;
 /** The default input buffer size for each audio node */
 const Uint32 AudioDevices::DEFAULT_INPUT_BUFFER = 1024;
 
+/** The number of callback events that may be waiting for the main thread */
+#define EVENT_CAPACITY  1024
+
 /**
  * Creates, but does not initialize the singleton device manager
  *
@@ -91,7 +99,11 @@ const Uint32 AudioDevices::DEFAULT_INPUT_BUFFER = 1024;
 AudioDevices::AudioDevices() :
 _active(false),
 _output(0),
-_input(0) {
+_input(0),
+_streaming(false),
+_events(EVENT_CAPACITY),
+_drainer(0),
+_reported(0) {
 }
 
 /**
@@ -117,6 +129,12 @@ bool AudioDevices::init(Uint32 output, Uint32 input) {
 #endif
         _output = output;
         _input  = input;
+        if (Application::get() != nullptr) {
+            _drainer = Application::get()->schedule([this](void) {
+                this->flushEvents();
+                return true;
+            }, 0, 0);
+        }
         return true;
     }
     return false;
@@ -135,6 +153,21 @@ void AudioDevices::dispose() {
         _outputs.clear();
         _inputs.clear();
 
+        // Stop the worker before releasing the streams
+        _streaming.store(false);
+        if (_streamer != nullptr) {
+            _streamer->stop();
+            _streamer = nullptr;
+        }
+        _streams.clear();
+
+        // The devices are closed, so no more events can arrive
+        if (_drainer && Application::get() != nullptr) {
+            Application::get()->unschedule(_drainer);
+        }
+        _drainer = 0;
+        flushEvents();
+
 #if CU_PLATFORM == CU_PLATFORM_MACOS
         AudioObjectRemovePropertyListener(kAudioObjectSystemObject, &test_address, device_unplugged, this);
 #endif
@@ -374,6 +407,116 @@ void AudioDevices::reset() {
     }
 }
 
+#pragma mark -
+#pragma mark Stream Decoding
+/**
+ * Registers a stream to be decoded ahead by the background worker.
+ *
+ * The worker is started the first time this method is called.  The
+ * worker keeps a reference to the stream until it is retired with
+ * {@link audio::AudioReadAhead#retire}.  Hence the stream is always
+ * deleted on the worker, and never on the audio thread.
+ *
+ * @param stream    The stream to decode
+ */
+void AudioDevices::addStream(const std::shared_ptr<audio::AudioReadAhead>& stream) {
+    std::unique_lock<std::mutex> lock(_streamMutex);
+    _streams.push_back(stream);
+    if (_streamer == nullptr) {
+        _streaming.store(true);
+        _streamer = ThreadPool::alloc(1);
+        _streamer->addTask([this](void) { this->decodeStreams(); });
+    }
+}
+
+/**
+ * Decodes all registered streams until the manager is disposed.
+ *
+ * This is the task of the background worker.  It repeatedly fills the
+ * read-ahead buffer of each stream, and removes streams that have been
+ * retired.  It sleeps briefly whenever there is no work to do.
+ */
+void AudioDevices::decodeStreams() {
+    std::vector<std::shared_ptr<audio::AudioReadAhead>> active;
+    while (_streaming.load()) {
+        {
+            std::unique_lock<std::mutex> lock(_streamMutex);
+            _streams.erase(std::remove_if(_streams.begin(), _streams.end(),
+                                          [](const std::shared_ptr<audio::AudioReadAhead>& stream) {
+                                              return stream->isRetired();
+                                          }), _streams.end());
+            active = _streams;
+        }
+
+        bool work = false;
+        for(auto it = active.begin(); it != active.end(); ++it) {
+            work = (*it)->fill() || work;
+        }
+        active.clear();
+        if (!work) {
+            SDL_Delay(2);
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Callback Events
+/**
+ * Posts a callback event for the main thread.
+ *
+ * AUDIO THREAD SAFE: This is how audio nodes report an action to their
+ * callback function.  The event is added to a preallocated lock-free ring,
+ * so this method never locks a mutex or allocates memory.  The callback
+ * of source is invoked with node and action the next time the events are
+ * drained by {@link flushEvents}.
+ *
+ * If the ring is full, the event is dropped and this method returns false.
+ *
+ * @param source    The node whose callback should be invoked
+ * @param node      The node to pass to the callback
+ * @param action    The action to pass to the callback
+ *
+ * @return true if the event was posted
+ */
+bool AudioDevices::postEvent(const std::shared_ptr<audio::AudioNode>& source,
+                             const std::shared_ptr<audio::AudioNode>& node, int action) {
+    Event event;
+    event.source = source;
+    event.node = node;
+    event.action = action;
+    return _events.push(event);
+}
+
+/**
+ * Invokes the callbacks for all events posted by the audio thread.
+ *
+ * If the manager is started while an {@link Application} is running, this
+ * method is scheduled to run every animation frame.  Otherwise, it must be
+ * called by hand from the main thread.
+ *
+ * The callback function of a node is read when the event is drained (and
+ * not when it is posted).  So if the callback changes in the meantime, the
+ * new callback is the one invoked.
+ */
+void AudioDevices::flushEvents() {
+    Event event;
+    while (_events.pop(event)) {
+        audio::AudioNode::Callback callback = event.source->getCallback();
+        if (callback) {
+            callback(event.node,(audio::AudioNode::Action)event.action);
+        }
+    }
+    event.source = nullptr;
+    event.node = nullptr;
+
+    Uint64 dropped = _events.dropped();
+    if (dropped > _reported) {
+        CULogError("Audio event queue overflowed; %llu callbacks were lost",
+                   (unsigned long long)(dropped-_reported));
+        _reported = dropped;
+    }
+}
+
 #pragma mark -
 #pragma mark Output Devices
 /**
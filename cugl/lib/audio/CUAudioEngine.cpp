@@ -46,6 +46,9 @@ using namespace cugl::audio;
 /** Reference to the sound engine singleton */
 AudioEngine* AudioEngine::_gEngine = nullptr;
 
+/** The gain at which a positional sound effect is considered inaudible */
+#define SPATIAL_CUTOFF  0.001f
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -54,8 +57,13 @@ AudioEngine* AudioEngine::_gEngine = nullptr;
  * The engine must be initialized before is can be used.
  */
 AudioEngine::AudioEngine() :
+_primary(false),
 _capacity(0),
-_primary(false) {
+_voiceStamp(0),
+_spatialVoices(DEFAULT_SPATIAL_VOICES),
+_spatialStamp(0),
+_spatialWidth(0),
+_spatialRange(0) {
     _output = nullptr;
     _mixer  = nullptr;
 }
@@ -109,6 +117,15 @@ bool AudioEngine::init(const std::shared_ptr<AudioOutput>& device, Uint32 slots)
         }
     }
     
+    // Every effect slot has a preallocated voice, and all start free
+    _voices.resize(_capacity);
+    _freeVoices.reserve(_capacity);
+    for(size_t ii = _capacity; ii > 0; ii--) {
+        _voices[ii-1].priority = 0;
+        _voices[ii-1].stamp = 0;
+        _freeVoices.push_back((Uint32)(ii-1));
+    }
+
     // Pool needs a fader and panner for 2 times the number of slots
     for(int ii = 0; ii < 2*_capacity; ii++) {
         _fadePool.push_back(AudioFader::alloc(_mixer->getChannels(),_mixer->getRate()));
@@ -139,6 +156,14 @@ void AudioEngine::dispose() {
         
         _fadePool.clear();
         _panPool.clear();
+        _samplePool.clear();
+        _playerPool.clear();
+        _voices.clear();
+        _freeVoices.clear();
+        _limits.clear();
+        _emitters.clear();
+        _voiceStamp = 0;
+        _spatialStamp = 0;
         _capacity = 0;
         
 		_output = nullptr;
@@ -146,7 +171,6 @@ void AudioEngine::dispose() {
         
         _queues.clear();
 		_actives.clear();
-        _evicts.clear();
 	}
 }
 
@@ -163,14 +187,171 @@ void AudioEngine::dispose() {
  */
 void AudioEngine::removeKey(const std::string key) {
     _actives.erase(key);
-    for(auto it = _evicts.begin(); it != _evicts.end(); ) {
-        if (*it == key) {
-            it = _evicts.erase(it);
-            break;
-        } else {
-            it++;
+}
+
+/**
+ * Returns a free sound effect slot, or -1 if there is none.
+ *
+ * Free slots are kept on a stack, so this is a constant time lookup in
+ * the typical case. If there are no free slots, this method will reuse
+ * any slot whose sound is fading out. Otherwise, if `force` is true, it
+ * steals the slot of the oldest sound with the lowest priority, as long
+ * as that priority is no greater than the one given.
+ *
+ * @param priority  The priority of the new sound effect
+ * @param force     Whether to force another sound to stop.
+ *
+ * @return a free sound effect slot, or -1 if there is none.
+ */
+int AudioEngine::acquireVoice(int priority, bool force) {
+    if (!_freeVoices.empty()) {
+        Uint32 slot = _freeVoices.back();
+        _freeVoices.pop_back();
+        return (int)slot;
+    }
+
+    // Try again for soon to be deleted.
+    int victim = -1;
+    for(Uint32 ii = 0; ii < _voices.size(); ii++) {
+        const Voice& voice = _voices[ii];
+        if (voice.fader == nullptr) {
+            continue;
+        } else if (voice.fader->isFadeOut() && !_slots[ii]->getTailSize()) {
+            return (int)ii;
+        } else if (force && voice.priority <= priority) {
+            if (victim == -1 || voice.priority < _voices[victim].priority ||
+                (voice.priority == _voices[victim].priority && voice.stamp < _voices[victim].stamp)) {
+                victim = (int)ii;
+            }
+        }
+    }
+
+    if (victim != -1) {
+        std::string altkey = _voices[victim].fader->getName();
+        auto it = _actives.find(altkey);
+        if (it != _actives.end() && it->second == _voices[victim].fader) {
+            clear(altkey);
+        }
+    }
+    return victim;
+}
+
+/**
+ * Starts the given audio instance in a sound effect slot.
+ *
+ * This method wraps the instance, and associates it with the given key
+ * and slot. The slot should have been acquired by {@link acquireVoice}.
+ *
+ * @param  key      The reference key for the sound effect
+ * @param  slot     The sound effect slot
+ * @param  instance The audio instance to play
+ * @param  loop     Whether to loop the sound effect continuously
+ * @param  volume   The sound volume
+ * @param  priority The priority of the sound effect
+ */
+void AudioEngine::startVoice(const std::string key, Uint32 slot,
+                             const std::shared_ptr<audio::AudioNode>& instance,
+                             bool loop, float volume, int priority) {
+    std::shared_ptr<AudioFader> fader = wrapInstance(instance);
+    fader->setGain(volume);
+    fader->setTag(slot);
+    fader->setName(key);
+
+    Voice& voice = _voices[slot];
+    voice.fader = fader;
+    voice.priority = priority;
+    voice.stamp = _voiceStamp++;
+
+    _slots[slot]->play(fader, loop ? -1 : 0);
+    _actives[key] = fader;
+}
+
+/**
+ * Returns true if a play request for this key should be coalesced.
+ *
+ * A request is coalesced if the key has a rate limit, and the key was
+ * last played less than that limit ago. Otherwise, this method records
+ * the request as the last play of this key.
+ *
+ * @param  key  The reference key for the sound effect
+ *
+ * @return true if a play request for this key should be coalesced.
+ */
+bool AudioEngine::coalesce(const std::string key) {
+    auto it = _limits.find(key);
+    if (it == _limits.end()) {
+        return false;
+    }
+
+    Timestamp now;
+    RateLimit& limit = it->second;
+    if (limit.primed && isActive(key) &&
+        Timestamp::ellapsedMicros(limit.last,now) < limit.interval) {
+        return true;
+    }
+    limit.last = now;
+    limit.primed = true;
+    return false;
+}
+
+/**
+ * Returns a playback node for the given sound asset.
+ *
+ * This method reuses a player from a previous play of this asset if
+ * possible. Otherwise, it allocates a new one.
+ *
+ * @param sound The sound asset
+ *
+ * @return a playback node for the given sound asset.
+ */
+std::shared_ptr<audio::AudioNode> AudioEngine::acquirePlayer(const std::shared_ptr<Sound>& sound) {
+    auto it = _playerPool.find(sound.get());
+    if (it != _playerPool.end()) {
+        PlayerPool& pool = it->second;
+        if (pool.sound.lock() != sound) {
+            _playerPool.erase(it);
+        } else if (!pool.nodes.empty()) {
+            std::shared_ptr<audio::AudioNode> player = pool.nodes.back();
+            pool.nodes.pop_back();
+            player->unmark();
+            player->reset();
+            player->resume();
+            player->setGain(sound->getVolume());
+            return player;
         }
     }
+
+    std::shared_ptr<audio::AudioNode> player = sound->createNode();
+    player->setName("__engine_playback__");
+    return player;
+}
+
+/**
+ * Recycles a playback node created by {@link acquirePlayer}.
+ *
+ * Only players for in-memory samples are recycled. Streamed samples
+ * hold a file handle open, and so are released instead.
+ *
+ * @param node  The playback node
+ */
+void AudioEngine::recyclePlayer(const std::shared_ptr<audio::AudioNode>& node) {
+    std::shared_ptr<AudioPlayer> player = std::dynamic_pointer_cast<AudioPlayer>(node);
+    if (player == nullptr || player->getName() != "__engine_playback__") {
+        return;
+    }
+    std::shared_ptr<AudioSample> sample = player->getSource();
+    if (sample == nullptr || sample->isStreamed()) {
+        return;
+    }
+
+    PlayerPool& pool = _playerPool[sample.get()];
+    if (pool.sound.lock() != sample) {
+        pool.sound = sample;
+        pool.nodes.clear();
+    }
+    if (pool.nodes.size() < MAX_POOLED_PLAYERS) {
+        pool.nodes.push_back(node);
+    }
 }
 
 /**
@@ -182,10 +363,9 @@ void AudioEngine::removeKey(const std::string key) {
  * arbitrary audio subgraphs. This method uses the object pools to simplify
  * this process.
  *
- * This method will also allocated an {@link AudioResampler} if the sample
- * rate is not consistent with the engine.  However, these are extremely
- * heavy-weight and cannot be easily reused, and this is to be avoided if
- * at all possible.
+ * This method will also attach an {@link AudioResampler} if the sample
+ * rate is not consistent with the engine.  These are heavy-weight, so
+ * they are pooled as well.  But it is better to avoid them entirely.
  *
  * @param instance  The audio instance
  *
@@ -215,9 +395,17 @@ std::shared_ptr<audio::AudioFader> AudioEngine::wrapInstance(const std::shared_p
     if (instance->getRate() == panner->getRate()) {
         panner->attach(instance);
     } else {
-        std::shared_ptr<audio::AudioResampler> sampler;
-        sampler = audio::AudioResampler::alloc(instance->getChannels(),panner->getRate());
-        sampler->setName("__engine_resampler__");
+        std::shared_ptr<audio::AudioResampler> sampler = nullptr;
+        for(auto it = _samplePool.begin(); sampler == nullptr && it != _samplePool.end(); ++it) {
+            if ((*it)->getChannels() == instance->getChannels()) {
+                sampler = *it;
+                _samplePool.erase(it);
+            }
+        }
+        if (sampler == nullptr) {
+            sampler = audio::AudioResampler::alloc(instance->getChannels(),panner->getRate());
+            sampler->setName("__engine_resampler__");
+        }
         sampler->attach(instance);
         panner->attach(sampler);
     }
@@ -274,6 +462,7 @@ std::shared_ptr<audio::AudioNode> AudioEngine::disposeWrapper(const std::shared_
                 source = sampler->getInput();
                 sampler->detach();
                 sampler->reset();
+                _samplePool.push_back(sampler);
             }
 
             fader->detach();
@@ -290,6 +479,29 @@ std::shared_ptr<audio::AudioNode> AudioEngine::disposeWrapper(const std::shared_
     return nullptr;
 }
 
+/**
+ * Returns the current audibility of a positional sound effect.
+ *
+ * The audibility is the gain of the effect scaled by the fraction of
+ * the effect left to play.  An effect that is nearly done is less
+ * important than one that just started.
+ *
+ * @param emitter   The positional sound effect
+ * @param now       The current time
+ *
+ * @return the current audibility of a positional sound effect.
+ */
+float AudioEngine::getAudibility(const Emitter& emitter, const Timestamp& now) const {
+    if (emitter.duration == 0) {
+        return emitter.gain;
+    }
+    Uint64 elapsed = Timestamp::ellapsedMicros(emitter.start,now);
+    if (elapsed >= emitter.duration) {
+        return 0;
+    }
+    return emitter.gain*(1.0f-(float)elapsed/(float)emitter.duration);
+}
+
 /**
  * Callback function for when a sound effect channel finishes
  *
@@ -305,8 +517,25 @@ std::shared_ptr<audio::AudioNode> AudioEngine::disposeWrapper(const std::shared_
  */
 void AudioEngine::gcollect(const std::shared_ptr<audio::AudioNode>& sound, bool status) {
     std::string key = sound->getName();
-    disposeWrapper(sound);
-    removeKey(key);
+
+    // The slot and key may have already been given to a newer sound
+    Uint32 slot = sound->getTag();
+    if (slot < _voices.size() && _voices[slot].fader == sound) {
+        _voices[slot].fader = nullptr;
+        _freeVoices.push_back(slot);
+    }
+    auto it = _actives.find(key);
+    if (it != _actives.end() && it->second == sound) {
+        _actives.erase(it);
+    }
+    for(auto jt = _emitters.begin(); jt != _emitters.end(); ++jt) {
+        if (jt->key == key) {
+            _emitters.erase(jt);
+            break;
+        }
+    }
+
+    recyclePlayer(disposeWrapper(sound));
     if (_callback) {
         _callback(key,status);
     }
@@ -557,21 +786,29 @@ void AudioEngine::freeQueue(const std::shared_ptr<AudioQueue>& queue) {
  * There are a limited number of slots available for sounds. If you go
  * over the number available, the sound will not play unless `force` is
  * true. In that case, it will grab the channel from the longest playing
- * sound effect.
+ * sound effect with the lowest priority. It will never grab the channel
+ * of a sound with a higher priority than this one.
+ *
+ * If the key has a rate limit (see {@link setRateLimit}) and was played
+ * too recently, this request is coalesced into the existing sound. The
+ * method returns true, but nothing new is played.
  *
  * @param  key      The reference key for the sound effect
  * @param  sound    The sound effect to play
  * @param  loop     Whether to loop the sound effect continuously
  * @param  volume   The music volume (relative to the default asset volume)
  * @param  force    Whether to force another sound to stop.
+ * @param  priority The priority for keeping this sound over others
  *
  * @return true if there was an available channel for the sound
  */
 bool AudioEngine::play(const std::string key, const std::shared_ptr<Sound>& sound,
-                       bool loop, float volume, bool force) {
+                       bool loop, float volume, bool force, int priority) {
     CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
 
-    if (isActive(key)) {
+    if (coalesce(key)) {
+        return true;
+    } else if (isActive(key)) {
         if (force) {
             clear(key,0);
             removeKey(key);
@@ -581,46 +818,14 @@ bool AudioEngine::play(const std::string key, const std::shared_ptr<Sound>& soun
         }
     }
     
-    // Find an empty scheduler
-    int audioID = -1;
-    for(auto it = _slots.begin()+1; audioID == -1 && it != _slots.end(); ++it) {
-        if (!(*it)->isPlaying()) {
-            audioID = (*it)->getTag();
-        }
-    }
-    
-    // Try again for soon to be deleted.
-    for(auto it = _actives.begin(); audioID == -1 && it != _actives.end(); ++it) {
-        if (it->second->isFadeOut()) {
-            Uint32 tag = it->second->getTag();
-            if (!_slots[tag]->getTailSize()) {
-                audioID = tag;
-            }
-        }
-    }
-    
+    int audioID = acquireVoice(priority,force);
     if (audioID == -1) {
-        if (force) {
-            std::string altkey = _evicts.front();
-            audioID = _actives[altkey]->getTag();
-            clear(altkey);
-        } else {
-            // Fail if nothing available
-            CULogError("No available sound channels");
-            return false;
-        }
+        // Fail if nothing available
+        CULogError("No available sound channels");
+        return false;
     }
     
-    std::shared_ptr<audio::AudioNode> player = sound->createNode();
-    player->setName("__engine_playback__");
-
-    std::shared_ptr<AudioFader> fader = wrapInstance(player);
-    fader->setGain(volume);
-    fader->setTag(audioID);
-    fader->setName(key);
-    _slots[audioID]->play(fader, loop ? -1 : 0);
-    _actives.emplace(key,fader);
-    _evicts.push_back(key);
+    startVoice(key,audioID,acquirePlayer(sound),loop,volume,priority);
     return true;
 }
 
@@ -644,23 +849,31 @@ bool AudioEngine::play(const std::string key, const std::shared_ptr<Sound>& soun
  * There are a limited number of slots available for sounds. If you go
  * over the number available, the sound will not play unless `force` is
  * true. In that case, it will grab the channel from the longest playing
- * sound effect.
+ * sound effect with the lowest priority. It will never grab the channel
+ * of a sound with a higher priority than this one.
+ *
+ * If the key has a rate limit (see {@link setRateLimit}) and was played
+ * too recently, this request is coalesced into the existing sound. The
+ * method returns true, but nothing new is played.
  *
  * @param  key      The reference key for the sound effect
  * @param  graph    The audio graph to play
  * @param  loop     Whether to loop the sound effect continuously
  * @param  volume   The music volume (relative to the default instance volume)
  * @param  force    Whether to force another sound to stop.
+ * @param  priority The priority for keeping this sound over others
  *
  * @return true if there was an available channel for the sound
  */
 bool AudioEngine::play(const std::string key, const std::shared_ptr<audio::AudioNode>& graph,
-                       bool loop, float volume, bool force) {
+                       bool loop, float volume, bool force, int priority) {
     CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
     CUAssertLog(graph->getName() != "__engine_playback__",  "Audio node uses reserved name '__engine_playback__'");
     CUAssertLog(graph->getName() != "__engine_resampler__", "Audio node uses reserved name '__engine_resampler__'");
 
-    if (isActive(key)) {
+    if (coalesce(key)) {
+        return true;
+    } else if (isActive(key)) {
         if (force) {
             clear(key,0);
             removeKey(key);
@@ -670,46 +883,270 @@ bool AudioEngine::play(const std::string key, const std::shared_ptr<audio::Audio
         }
     }
     
-    // Find an empty scheduler
-    int audioID = -1;
-    for(auto it = _slots.begin()+1; audioID == -1 && it != _slots.end(); ++it) {
-        if (!(*it)->isPlaying()) {
-            audioID = (*it)->getTag();
+    int audioID = acquireVoice(priority,force);
+    if (audioID == -1) {
+        // Fail if nothing available
+        CULogError("No available sound channels");
+        return false;
+    }
+
+    startVoice(key,audioID,graph,loop,volume,priority);
+    return true;
+}
+
+/**
+ * Sets the minimum time between two plays of the given key.
+ *
+ * Some sound effects (such as collisions) may be requested every frame.
+ * Restarting the sound each time wastes a voice and is rarely audible.
+ * With a rate limit, any request to play this key within the given
+ * number of seconds of the last play is coalesced into the sound that
+ * is already playing.
+ *
+ * A limit of 0 (or less) removes the rate limit for this key.
+ *
+ * @param  key      The reference key for the sound effect
+ * @param  seconds  The minimum time between two plays of this key
+ */
+void AudioEngine::setRateLimit(const std::string key, float seconds) {
+    if (seconds <= 0) {
+        _limits.erase(key);
+        return;
+    }
+    RateLimit& limit = _limits[key];
+    limit.interval = (Uint64)(seconds*1000000);
+    limit.primed = false;
+}
+
+/**
+ * Returns the minimum time between two plays of the given key.
+ *
+ * If the key has no rate limit, this method returns 0.
+ *
+ * @param  key  The reference key for the sound effect
+ *
+ * @return the minimum time between two plays of the given key.
+ */
+float AudioEngine::getRateLimit(const std::string key) const {
+    auto it = _limits.find(key);
+    if (it == _limits.end()) {
+        return 0;
+    }
+    return it->second.interval/1000000.0f;
+}
+
+#pragma mark -
+#pragma mark Positional Effects
+/**
+ * Plays the given sound at a position in the world.
+ *
+ * This method is a lightweight 2d positional version of {@link play}. The
+ * stereo pan of the sound is derived from the horizontal offset of the
+ * position from the listener, and the gain is attenuated with distance.
+ * See {@link setSpatialListener} for the details.
+ *
+ * Positional effects are fire-and-forget, and are never looped. The key
+ * names a group of effects (such as collisions) rather than a single
+ * sound.  At most {@link getSpatialVoices} positional effects play at once,
+ * regardless of how many are requested. This keeps the cost of a large
+ * burst of events constant.  When every positional voice is in use, a new
+ * effect takes the voice of the least audible effect if it is louder (or
+ * of higher priority).  Otherwise, it is merged into the loudest playing
+ * effect of the same group, which moves toward the new position.  The
+ * merged effect plays at the larger of the two volumes, so a burst of
+ * merged effects is never louder than its loudest member.  If neither is
+ * possible, the effect is culled. Effects too far from the listener to be
+ * heard are always culled.
+ *
+ * @param  key      The group key for the sound effect
+ * @param  sound    The sound effect to play
+ * @param  position The position of the sound effect in the world
+ * @param  volume   The sound volume (relative to the default asset volume)
+ * @param  priority The priority for keeping this sound over others
+ *
+ * @return true if the sound was played or merged into another sound
+ */
+bool AudioEngine::playAt(const std::string key, const std::shared_ptr<Sound>& sound,
+                         const Vec2& position, float volume, int priority) {
+    CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
+    float gain = volume*getSpatialGain(position);
+    if (gain <= SPATIAL_CUTOFF) {
+        return false;
+    }
+
+    // Find the least audible effect, and the most audible one in this group
+    Timestamp now;
+    int weakest = -1;
+    int loudest = -1;
+    float weakLevel = 0;
+    float loudLevel = 0;
+    for(size_t ii = 0; ii < _emitters.size(); ii++) {
+        const Emitter& emitter = _emitters[ii];
+        float level = getAudibility(emitter,now);
+        if (weakest == -1 || emitter.priority < _emitters[weakest].priority ||
+            (emitter.priority == _emitters[weakest].priority && level < weakLevel)) {
+            weakest = (int)ii;
+            weakLevel = level;
+        }
+        if (emitter.group == key && (loudest == -1 || level > loudLevel)) {
+            loudest = (int)ii;
+            loudLevel = level;
         }
     }
-    
-    // Try again for soon to be deleted.
-    for(auto it = _actives.begin(); audioID == -1 && it != _actives.end(); ++it) {
-        if (it->second->isFadeOut()) {
-            Uint32 tag = it->second->getTag();
-            if (!_slots[tag]->getTailSize()) {
-                audioID = tag;
-            }
+
+    int slot = -1;
+    if (_emitters.size() < _spatialVoices) {
+        slot = acquireVoice(priority,false);
+    }
+    if (slot == -1 && weakest != -1 && (priority > _emitters[weakest].priority ||
+                                        (priority == _emitters[weakest].priority && gain > weakLevel))) {
+        // Fading the weakest effect frees its voice
+        std::string victim = _emitters[weakest].key;
+        _emitters.erase(_emitters.begin()+weakest);
+        if (loudest > weakest) {
+            loudest--;
+        } else if (loudest == weakest) {
+            loudest = -1;
         }
+        clear(victim);
+        slot = acquireVoice(priority,false);
     }
-    
-    if (audioID == -1) {
-        if (force) {
-            std::string altkey = _evicts.front();
-            audioID = _actives[altkey]->getTag();
-            clear(altkey);
-        } else {
-            // Fail if nothing available
-            CULogError("No available sound channels");
+
+    if (slot == -1) {
+        if (loudest == -1) {
             return false;
         }
+
+        // Merge into the loudest effect of this group
+        Emitter& emitter = _emitters[loudest];
+        emitter.position = (emitter.position*emitter.gain+position*gain)/(emitter.gain+gain);
+        emitter.gain = std::max(emitter.gain,gain);
+        setVolume(emitter.key,emitter.gain);
+        setPanFactor(emitter.key,getSpatialPan(emitter.position));
+        return true;
     }
 
-    std::shared_ptr<AudioFader> fader = wrapInstance(graph);
-    fader->setGain(volume);
-    fader->setTag(audioID);
-    fader->setName(key);
-    _slots[audioID]->play(fader, loop ? -1 : 0);
-    _actives.emplace(key,fader);
-    _evicts.push_back(key);
+    Emitter emitter;
+    emitter.group = key;
+    emitter.key = key+"@"+std::to_string(_spatialStamp++);
+    emitter.position = position;
+    emitter.gain = gain;
+    emitter.priority = priority;
+    emitter.start = now;
+    emitter.duration = sound->getDuration() > 0 ? (Uint64)(sound->getDuration()*1000000) : 0;
+    startVoice(emitter.key,slot,acquirePlayer(sound),false,gain,priority);
+    setPanFactor(emitter.key,getSpatialPan(position));
+    _emitters.push_back(emitter);
     return true;
 }
 
+/**
+ * Sets the listener for positional sound effects.
+ *
+ * The listener is typically the center of the screen. An effect that is
+ * `width` units to the left (right) of the listener is panned completely
+ * to the left (right) channel.  The gain of an effect falls off with the
+ * square of its distance from the listener, and reaches 0 at a distance
+ * of `range`. A width or range of 0 (the default) disables panning or
+ * attenuation, respectively.
+ *
+ * @param  position The listener position
+ * @param  width    The horizontal distance from the listener for a full pan
+ * @param  range    The distance from the listener at which sound is inaudible
+ */
+void AudioEngine::setSpatialListener(const Vec2& position, float width, float range) {
+    _listener = position;
+    _spatialWidth = width;
+    _spatialRange = range;
+}
+
+/**
+ * Sets the maximum number of positional sound effects that play at once.
+ *
+ * Positional sound effects also need a free slot (see {@link
+ * getAvailableSlots}), so fewer may play if the slots are in use.  If
+ * more effects are playing than this value, the least audible ones are
+ * stopped.
+ *
+ * @param voices    The maximum number of positional sound effects
+ */
+void AudioEngine::setSpatialVoices(Uint32 voices) {
+    _spatialVoices = voices;
+    Timestamp now;
+    while (_emitters.size() > _spatialVoices) {
+        size_t weakest = 0;
+        float weakLevel = getAudibility(_emitters[0],now);
+        for(size_t ii = 1; ii < _emitters.size(); ii++) {
+            float level = getAudibility(_emitters[ii],now);
+            if (_emitters[ii].priority < _emitters[weakest].priority ||
+                (_emitters[ii].priority == _emitters[weakest].priority && level < weakLevel)) {
+                weakest = ii;
+                weakLevel = level;
+            }
+        }
+        std::string victim = _emitters[weakest].key;
+        _emitters.erase(_emitters.begin()+weakest);
+        clear(victim);
+    }
+}
+
+/**
+ * Returns the volume of the loudest positional effect in the given group.
+ *
+ * The volume includes distance attenuation.  If several effects were
+ * merged into one voice, this is the volume of that voice.  This method
+ * returns 0 if no effect in the group is playing.
+ *
+ * @param  key  The group key for the sound effects
+ *
+ * @return the volume of the loudest positional effect in the given group.
+ */
+float AudioEngine::getSpatialVolume(const std::string key) const {
+    float result = 0;
+    for(auto it = _emitters.begin(); it != _emitters.end(); ++it) {
+        if (it->group == key) {
+            result = std::max(result,it->gain);
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the stereo pan for a sound effect at the given position.
+ *
+ * The value is in the range -1 (left) to 1 (right), as described in
+ * {@link setSpatialListener}.
+ *
+ * @param  position The position of the sound effect in the world
+ *
+ * @return the stereo pan for a sound effect at the given position.
+ */
+float AudioEngine::getSpatialPan(const Vec2& position) const {
+    if (_spatialWidth <= 0) {
+        return 0;
+    }
+    float pan = (position.x-_listener.x)/_spatialWidth;
+    return std::max(-1.0f,std::min(1.0f,pan));
+}
+
+/**
+ * Returns the distance attenuation for a sound effect at the given position.
+ *
+ * The value is in the range 0 (inaudible) to 1 (at the listener), as
+ * described in {@link setSpatialListener}.
+ *
+ * @param  position The position of the sound effect in the world
+ *
+ * @return the distance attenuation for a sound effect at the given position.
+ */
+float AudioEngine::getSpatialGain(const Vec2& position) const {
+    if (_spatialRange <= 0) {
+        return 1;
+    }
+    float fade = 1.0f-position.distance(_listener)/_spatialRange;
+    return fade <= 0 ? 0 : fade*fade;
+}
+
 
 /**
  * Returns the current state of the sound effect for the given key.
@@ -821,9 +1258,7 @@ void AudioEngine::setLoop(const std::string key, bool loop) {
 float AudioEngine::getVolume(const std::string key) const {
     CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
     if (_actives.find(key) != _actives.end()) {
-        Uint32 tag = _actives.at(key)->getTag();
-        std::shared_ptr<AudioNode> node = _slots[tag]->getCurrent();
-        return node->getGain();
+        return _actives.at(key)->getGain();
     }
     return 0;
 }
@@ -846,9 +1281,8 @@ float AudioEngine::getVolume(const std::string key) const {
 void AudioEngine::setVolume(const std::string key, float volume) {
     CUAssertLog(_output != nullptr, "Attempt to use an unintiatialized audio engine");
     if (_actives.find(key) != _actives.end()) {
-        Uint32 tag = _actives.at(key)->getTag();
-        std::shared_ptr<AudioNode> node = _slots[tag]->getCurrent();
-        node->setGain(volume);
+        // The slot may not have started the fader yet
+        _actives.at(key)->setGain(volume);
     }
 }
 
@@ -1149,7 +1583,6 @@ void AudioEngine::clearEffects(float fade) {
         it->second->fadeOut(fade);
     }
     _actives.clear();
-    _evicts.clear();
 }
 
 /**
@@ -40,9 +40,87 @@
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUFiletools.h>
 #include <cugl/audio/codecs/cu_codecs.h>
+#include <cugl/math/dsp/CUDSPMath.h>
+#include <cugl/util/CUStrings.h>
+#include <algorithm>
+#include <cstring>
 
 using namespace cugl;
 
+/** The number of frames in an ADPCM block (must be even) */
+#define ADPCM_BLOCK     128
+/** The number of header bytes for each channel of an ADPCM block */
+#define ADPCM_HEADER    4
+/** The largest number of channels supported by the ADPCM decoder */
+#define ADPCM_CHANNELS  32
+
+/** The change in step index for each IMA ADPCM nibble */
+static const int IMA_INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/** The quantizer step sizes for IMA ADPCM */
+static const int IMA_STEP_TABLE[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/**
+ * Returns the number of bytes in an ADPCM block for the given channels.
+ *
+ * @param channels  The number of audio channels
+ *
+ * @return the number of bytes in an ADPCM block for the given channels.
+ */
+static size_t adpcm_block_size(Uint32 channels) {
+    return channels*(ADPCM_HEADER+ADPCM_BLOCK/2);
+}
+
+/**
+ * Returns the 16-bit PCM value for the given float sample.
+ *
+ * @param value The float sample
+ *
+ * @return the 16-bit PCM value for the given float sample.
+ */
+static Sint16 float_to_pcm16(float value) {
+    float scaled = value*32768.0f;
+    scaled = scaled < -32768.0f ? -32768.0f : (scaled > 32767.0f ? 32767.0f : scaled);
+    return (Sint16)(scaled < 0 ? scaled-0.5f : scaled+0.5f);
+}
+
+/**
+ * Returns the new predictor after applying an ADPCM nibble.
+ *
+ * The step index is updated as a side effect.
+ *
+ * @param nibble    The ADPCM nibble
+ * @param predictor The current predictor
+ * @param index     The current step index
+ *
+ * @return the new predictor after applying an ADPCM nibble.
+ */
+static int ima_step(Uint8 nibble, int predictor, int& index) {
+    int step  = IMA_STEP_TABLE[index];
+    int delta = step >> 3;
+    if (nibble & 4) { delta += step; }
+    if (nibble & 2) { delta += step >> 1; }
+    if (nibble & 1) { delta += step >> 2; }
+    predictor += (nibble & 8) ? -delta : delta;
+    predictor = predictor < -32768 ? -32768 : (predictor > 32767 ? 32767 : predictor);
+    index += IMA_INDEX_TABLE[nibble];
+    index = index < 0 ? 0 : (index > 88 ? 88 : index);
+    return predictor;
+}
+
 #pragma mark Constructors
 
 /**
@@ -54,8 +132,11 @@ using namespace cugl;
 AudioSample::AudioSample() : Sound(),
 _frames(0),
 _stream(false),
-_buffer(nullptr) {
+_buffer(nullptr),
+_pcm16(nullptr),
+_adpcm(nullptr) {
     _type = Type::UNKNOWN;
+    _format = Format::FLOAT;
 }
 
 /**
@@ -65,12 +146,16 @@ _buffer(nullptr) {
  * If the file is streamed, it will not be loaded into memory.  Otherwise,
  * this initializer will allocate memory to read the asset into memory.
  *
+ * In-memory samples are stored in the given format. The format is
+ * ignored if the sample is streamed.
+ *
  * @param file      The source file for the audio sample
  * @param stream    Wether to stream the audio from the file.
+ * @param format    The storage format for in-memory samples
  *
  * @return true if the sound source was initialized successfully
  */
-bool AudioSample::init(const char* file, bool stream) {
+bool AudioSample::init(const char* file, bool stream, Format format) {
     CUAssertLog(filetool::file_exists(file), "Cannot find file %s",file);
     _file = file;
     _type = guessType(file);
@@ -88,7 +173,7 @@ bool AudioSample::init(const char* file, bool stream) {
     if (!_stream) {
         _buffer = (float*)SDL_malloc((size_t)(_frames*_channels*sizeof(float)));
         Sint64 size = decoder->decode(_buffer);
-        return size >= 0;
+        return size >= 0 && setFormat(format);
     }
     return true;
 }
@@ -126,10 +211,12 @@ bool AudioSample::init(Uint8 channels, Uint32 rate, Uint32 frames) {
  *      "file":     The path to the source, relative to the asset directory
  *      "stream":   A boolean, indicating whether to stream the sample
  *      "volume":   A float, representing the volume
+ *      "format":   One of "float", "int16", or "adpcm" (in-memory only)
  *
  * All attributes are optional.  There are no required attributes. By default,
  * audio samples are not streamed, meaning they are fully loaded into memory.
- * This is recommended for sound effects, but not for music.
+ * This is recommended for sound effects, but not for music. In-memory
+ * samples are stored as float unless another format is given.
  *
  * @param data      The JSON object specifying the audio sample
  *
@@ -147,7 +234,8 @@ std::shared_ptr<AudioSample> AudioSample::allocWithData(const std::shared_ptr<Js
     CUAssertLog(!absolute, "The asset directory should not referece absolute paths.");
     
     bool stream = data->getBool("stream",false);
-    return AudioSample::alloc(source,stream);
+    Format format = parseFormat(data->getString("format","float"));
+    return AudioSample::alloc(source,stream,format);
 }
 
 /**
@@ -165,7 +253,16 @@ void AudioSample::dispose() {
         SDL_free(_buffer);
         _buffer = nullptr;
     }
+    if (_pcm16 != nullptr) {
+        SDL_free(_pcm16);
+        _pcm16 = nullptr;
+    }
+    if (_adpcm != nullptr) {
+        SDL_free(_adpcm);
+        _adpcm = nullptr;
+    }
     _type = Type::UNKNOWN;
+    _format = Format::FLOAT;
 }
 
 #pragma mark -
@@ -220,6 +317,257 @@ AudioSample::Type AudioSample::guessType(const char* file) {
     return type;
 }
 
+/**
+ * Returns the sample format for the given name
+ *
+ * The name should be one of "float", "int16", or "adpcm" (case does not
+ * matter). Any other name is FLOAT.
+ *
+ * @param name  The format name
+ *
+ * @return the sample format for the given name
+ */
+AudioSample::Format AudioSample::parseFormat(const std::string& name) {
+    std::string format = strtool::tolower(name);
+    if (format == "int16" || format == "pcm16") {
+        return Format::INT16;
+    } else if (format == "adpcm" || format == "ima") {
+        return Format::ADPCM;
+    } else if (format != "float") {
+        CULogError("Unknown sample format '%s'",name.c_str());
+    }
+    return Format::FLOAT;
+}
+
+#pragma mark -
+#pragma mark Sample Formats
+/**
+ * Converts this in-memory sample to the given storage format.
+ *
+ * Converting to a compact format discards the float buffer.  Converting
+ * back to FLOAT restores it, though any precision lost by the compact
+ * format is not recovered. This method does nothing for a streamed sample.
+ *
+ * This method should never be called while the sample is playing.
+ *
+ * @param format    The new storage format
+ *
+ * @return true if the sample was converted
+ */
+bool AudioSample::setFormat(Format format) {
+    if (_stream) {
+        return format == Format::FLOAT;
+    } else if (format == _format) {
+        return true;
+    } else if (format == Format::ADPCM && _channels > ADPCM_CHANNELS) {
+        CULogError("ADPCM samples support at most %d channels",ADPCM_CHANNELS);
+        return false;
+    }
+
+    // Always go through float
+    size_t size = (size_t)(_frames*_channels);
+    if (_format != Format::FLOAT) {
+        _buffer = (float*)SDL_malloc(size*sizeof(float));
+        read(_buffer,0,(Uint32)_frames);
+        if (_pcm16 != nullptr) {
+            SDL_free(_pcm16);
+            _pcm16 = nullptr;
+        }
+        if (_adpcm != nullptr) {
+            SDL_free(_adpcm);
+            _adpcm = nullptr;
+        }
+        _format = Format::FLOAT;
+    }
+
+    switch (format) {
+        case Format::INT16:
+            _pcm16 = (Sint16*)SDL_malloc(size*sizeof(Sint16));
+            for(size_t ii = 0; ii < size; ii++) {
+                _pcm16[ii] = float_to_pcm16(_buffer[ii]);
+            }
+            break;
+        case Format::ADPCM:
+            encodeADPCM();
+            break;
+        case Format::FLOAT:
+            return true;
+    }
+
+    SDL_free(_buffer);
+    _buffer = nullptr;
+    _format = format;
+    return true;
+}
+
+/**
+ * Returns the number of bytes used to store the in-memory samples.
+ *
+ * This value is 0 for a streamed sample.
+ *
+ * @return the number of bytes used to store the in-memory samples.
+ */
+size_t AudioSample::getFootprint() const {
+    switch (_format) {
+        case Format::FLOAT:
+            return _buffer == nullptr ? 0 : (size_t)(_frames*_channels*sizeof(float));
+        case Format::INT16:
+            return (size_t)(_frames*_channels*sizeof(Sint16));
+        case Format::ADPCM:
+            return (size_t)((_frames+ADPCM_BLOCK-1)/ADPCM_BLOCK)*adpcm_block_size(_channels);
+    }
+    return 0;
+}
+
+/**
+ * Reads frames from an in-memory sample into the given buffer.
+ *
+ * The buffer should have enough room to store frames * channels elements.
+ * The samples are converted to float as necessary. This method does not
+ * allocate memory, and so it is safe to call in the audio thread.
+ *
+ * @param buffer    The buffer to store the results
+ * @param frame     The first frame to read
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioSample::read(float* buffer, Uint64 frame, Uint32 frames) const {
+    if (frame >= _frames) {
+        return 0;
+    }
+    Uint32 amt = (Uint32)std::min((Uint64)frames,_frames-frame);
+    switch (_format) {
+        case Format::FLOAT:
+            if (_buffer == nullptr) {
+                return 0;
+            }
+            std::memcpy(buffer,_buffer+frame*_channels,amt*_channels*sizeof(float));
+            break;
+        case Format::INT16:
+            dsp::DSPMath::convert(_pcm16+frame*_channels,1.0f/32768.0f,buffer,amt*_channels);
+            break;
+        case Format::ADPCM:
+            decodeADPCM(buffer,frame,amt);
+            break;
+    }
+    return amt;
+}
+
+/**
+ * Encodes the float buffer as IMA ADPCM blocks.
+ *
+ * The blocks are stored in {@link _adpcm}. The float buffer is not
+ * modified or released.
+ */
+void AudioSample::encodeADPCM() {
+    size_t blocksize = adpcm_block_size(_channels);
+    size_t blocks = (size_t)((_frames+ADPCM_BLOCK-1)/ADPCM_BLOCK);
+    _adpcm = (Uint8*)SDL_malloc(std::max(blocks*blocksize,(size_t)1));
+    std::memset(_adpcm,0,blocks*blocksize);
+
+    int index[ADPCM_CHANNELS];
+    for(Uint32 ch = 0; ch < _channels; ch++) {
+        index[ch] = 0;
+    }
+
+    for(size_t bb = 0; bb < blocks; bb++) {
+        Uint8* block = _adpcm+bb*blocksize;
+        Uint8* nibbles = block+_channels*ADPCM_HEADER;
+        Uint64 start = bb*ADPCM_BLOCK;
+        Uint32 limit = (Uint32)std::min((Uint64)ADPCM_BLOCK,_frames-start);
+
+        // The header seeds each channel with its first sample
+        int predictor[ADPCM_CHANNELS];
+        for(Uint32 ch = 0; ch < _channels; ch++) {
+            predictor[ch] = float_to_pcm16(_buffer[start*_channels+ch]);
+            Uint8* header = block+ch*ADPCM_HEADER;
+            header[0] = (Uint8)(predictor[ch] & 0xff);
+            header[1] = (Uint8)((predictor[ch] >> 8) & 0xff);
+            header[2] = (Uint8)index[ch];
+            header[3] = 0;
+        }
+
+        for(Uint32 ff = 0; ff < limit; ff++) {
+            for(Uint32 ch = 0; ch < _channels; ch++) {
+                int sample = float_to_pcm16(_buffer[(start+ff)*_channels+ch]);
+                int diff = sample-predictor[ch];
+                int step = IMA_STEP_TABLE[index[ch]];
+                Uint8 nibble = 0;
+                if (diff < 0) {
+                    nibble = 8;
+                    diff = -diff;
+                }
+                if (diff >= step) {
+                    nibble |= 4;
+                    diff -= step;
+                }
+                step >>= 1;
+                if (diff >= step) {
+                    nibble |= 2;
+                    diff -= step;
+                }
+                step >>= 1;
+                if (diff >= step) {
+                    nibble |= 1;
+                }
+
+                // Track the decoder exactly so errors do not accumulate
+                predictor[ch] = ima_step(nibble,predictor[ch],index[ch]);
+                size_t pos = ff*_channels+ch;
+                nibbles[pos >> 1] |= (pos & 1) ? (Uint8)(nibble << 4) : nibble;
+            }
+        }
+    }
+}
+
+/**
+ * Decodes the given frames from the ADPCM blocks into the buffer.
+ *
+ * Each block stores its own predictor state, so decoding starts from
+ * the beginning of the block containing the first frame.
+ *
+ * @param buffer    The buffer to store the results
+ * @param frame     The first frame to decode
+ * @param frames    The number of frames to decode
+ */
+void AudioSample::decodeADPCM(float* buffer, Uint64 frame, Uint32 frames) const {
+    const float scale = 1.0f/32768.0f;
+    size_t blocksize = adpcm_block_size(_channels);
+    Uint64 end = frame+frames;
+    int predictor[ADPCM_CHANNELS];
+    int index[ADPCM_CHANNELS];
+
+    while (frame < end) {
+        Uint64 bb = frame/ADPCM_BLOCK;
+        Uint32 first = (Uint32)(frame-bb*ADPCM_BLOCK);
+        Uint32 limit = (Uint32)std::min((Uint64)ADPCM_BLOCK,end-bb*ADPCM_BLOCK);
+
+        const Uint8* block = _adpcm+bb*blocksize;
+        const Uint8* nibbles = block+_channels*ADPCM_HEADER;
+        for(Uint32 ch = 0; ch < _channels; ch++) {
+            const Uint8* header = block+ch*ADPCM_HEADER;
+            predictor[ch] = (Sint16)(header[0] | (header[1] << 8));
+            index[ch] = header[2];
+        }
+
+        // ADPCM is inherently serial, so skip ahead to the first frame
+        for(Uint32 ff = 0; ff < limit; ff++) {
+            for(Uint32 ch = 0; ch < _channels; ch++) {
+                size_t pos = ff*_channels+ch;
+                Uint8 nibble = (nibbles[pos >> 1] >> ((pos & 1) << 2)) & 0x0f;
+                predictor[ch] = ima_step(nibble,predictor[ch],index[ch]);
+                if (ff >= first) {
+                    *buffer++ = predictor[ch]*scale;
+                }
+            }
+        }
+        frame = bb*ADPCM_BLOCK+limit;
+    }
+}
+
+#pragma mark -
+#pragma mark Playback Support
 /**
  * Returns a new decoder for this audio sample
  *
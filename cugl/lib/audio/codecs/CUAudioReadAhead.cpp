@@ -0,0 +1,327 @@
+//
+//  CUAudioReadAhead.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an asynchronous read-ahead buffer for a streaming
+//  audio decoder.  Decoding a compressed stream (OGG, MP3, FLAC) requires
+//  both file I/O and a lot of computation.  Doing this in the audio thread
+//  competes with the deadline of the audio callback.  Instead, this class
+//  decodes the stream on a background worker (owned by AudioDevices) into
+//  a lock-free ring buffer.  The audio thread only copies from that buffer.
+//
+//  To support glitch-free looping, this class also keeps a decoded copy of
+//  the start of the stream.  A rewind plays from that copy while the worker
+//  refills the ring buffer.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/audio/codecs/CUAudioReadAhead.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace cugl::audio;
+
+/** The default amount of audio to decode ahead, in seconds */
+const double AudioReadAhead::DEFAULT_LOOKAHEAD = 0.3;
+
+#pragma mark Constructors
+/**
+ * Creates a degenerate read-ahead buffer with no decoder.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+AudioReadAhead::AudioReadAhead() :
+_decoder(nullptr),
+_channels(0),
+_length(0),
+_head(nullptr),
+_headsize(0),
+_ring(nullptr),
+_capacity(0),
+_readpos(0),
+_writepos(0),
+_seekpos(0),
+_seekgen(0),
+_readygen(0),
+_workgen(0),
+_cursor(0),
+_page(nullptr),
+_pagelimit(0),
+_pagelast(0),
+_underruns(0),
+_retired(false) {
+}
+
+/**
+ * Initializes a read-ahead buffer for the given decoder.
+ *
+ * The lookahead is the amount of audio (in seconds) to keep decoded
+ * ahead of the audio thread.  The same amount of audio is decoded from
+ * the start of the stream immediately, on the calling thread.
+ *
+ * Once this method is called, the decoder should not be accessed by
+ * anything other than this object.
+ *
+ * @param decoder   The stream decoder
+ * @param lookahead The amount of audio to decode ahead, in seconds
+ *
+ * @return true if initialization was successful
+ */
+bool AudioReadAhead::init(const std::shared_ptr<AudioDecoder>& decoder, double lookahead) {
+    if (decoder == nullptr) {
+        CUAssertLog(false, "Read-ahead buffer requires a decoder");
+        return false;
+    } else if (_decoder != nullptr) {
+        CUAssertLog(false, "Read-ahead buffer is already initialized");
+        return false;
+    }
+
+    _decoder  = decoder;
+    _channels = decoder->getChannels();
+    _length   = decoder->getLength();
+
+    // Round the lookahead up to whole pages
+    Uint32 pagesize = decoder->getPageSize();
+    Uint64 ahead = (Uint64)std::ceil(lookahead*decoder->getSampleRate());
+    Uint64 pages = std::max((ahead+pagesize-1)/pagesize,(Uint64)1);
+    _page = (float*)malloc(pagesize*_channels*sizeof(float));
+
+    // Decode the start of the stream for fast rewinds
+    _headsize = std::min(pages*pagesize,_length);
+    _head = (float*)malloc(std::max(_headsize,(Uint64)1)*_channels*sizeof(float));
+    decoder->setPage(0);
+    Uint64 done = 0;
+    while (done < _headsize) {
+        Sint32 amt = decoder->pagein(_page);
+        if (amt <= 0) {
+            _headsize = done;
+            _pagelimit = 0;
+            _pagelast  = 0;
+        } else {
+            Uint64 take = std::min((Uint64)amt,_headsize-done);
+            std::memcpy(_head+done*_channels,_page,take*_channels*sizeof(float));
+            done += take;
+            _pagelimit = amt;
+            _pagelast  = (Uint32)take;
+        }
+    }
+
+    // The ring has one page of slack so the worker is never blocked mid-page
+    _capacity = (Uint32)((pages+1)*pagesize);
+    _ring = (float*)malloc(_capacity*_channels*sizeof(float));
+    std::memset(_ring,0,_capacity*_channels*sizeof(float));
+    _readpos.store(_headsize);
+    _writepos.store(_headsize);
+    _seekpos.store(_headsize);
+    return true;
+}
+
+/**
+ * Disposes any resources allocated for this read-ahead buffer.
+ *
+ * This method should only be called when no other thread holds a
+ * reference to this object.
+ */
+void AudioReadAhead::dispose() {
+    if (_decoder != nullptr) {
+        _decoder = nullptr;
+        free(_head);
+        free(_ring);
+        free(_page);
+        _head = nullptr;
+        _ring = nullptr;
+        _page = nullptr;
+        _headsize = 0;
+        _capacity = 0;
+        _channels = 0;
+        _length = 0;
+        _readpos.store(0);
+        _writepos.store(0);
+        _seekpos.store(0);
+        _seekgen.store(0);
+        _readygen.store(0);
+        _workgen = 0;
+        _cursor  = 0;
+        _pagelimit = 0;
+        _pagelast  = 0;
+        _underruns.store(0);
+        _retired.store(false);
+    }
+}
+
+#pragma mark -
+#pragma mark Audio Thread Methods
+/**
+ * Reads up to the specified number of frames into the given buffer
+ *
+ * AUDIO THREAD ONLY: This method only copies decoded data.  It never
+ * locks, allocates, or touches the decoder.
+ *
+ * The buffer should have enough room to store frames * channels elements.
+ * The channels are interleaved into the output buffer.  If fewer frames
+ * are available than requested, the remainder of the buffer is filled
+ * with 0s.  If this happens before the end of the stream, it is counted
+ * as an underrun.
+ *
+ * @param buffer    The read buffer to store the results
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioReadAhead::read(float* buffer, Uint32 frames) {
+    bool ready = _readygen.load(std::memory_order_acquire) == _seekgen.load(std::memory_order_relaxed);
+    Uint32 copied = 0;
+    while (copied < frames && _cursor < _length) {
+        Uint32 need = frames-copied;
+        Uint32 amt  = 0;
+        float* output = buffer+copied*_channels;
+        if (_cursor < _headsize) {
+            amt = (Uint32)std::min((Uint64)need,_headsize-_cursor);
+            std::memcpy(output,_head+_cursor*_channels,amt*_channels*sizeof(float));
+        } else if (ready) {
+            Uint64 read  = _readpos.load(std::memory_order_relaxed);
+            Uint64 avail = _writepos.load(std::memory_order_acquire)-read;
+            amt = (Uint32)std::min((Uint64)need,avail);
+
+            Uint32 slot  = (Uint32)(read % _capacity);
+            Uint32 first = std::min(amt,_capacity-slot);
+            std::memcpy(output,_ring+slot*_channels,first*_channels*sizeof(float));
+            if (first < amt) {
+                std::memcpy(output+first*_channels,_ring,(amt-first)*_channels*sizeof(float));
+            }
+            _readpos.store(read+amt,std::memory_order_release);
+        }
+
+        if (amt == 0) {
+            break;
+        }
+        copied  += amt;
+        _cursor += amt;
+    }
+
+    if (copied < frames) {
+        std::memset(buffer+copied*_channels,0,(frames-copied)*_channels*sizeof(float));
+        if (_cursor < _length) {
+            _underruns.fetch_add(1,std::memory_order_relaxed);
+        }
+    }
+    return copied;
+}
+
+/**
+ * Moves the read position to the given absolute frame.
+ *
+ * AUDIO THREAD ONLY: This method never blocks.  The actual decoder seek
+ * is performed by the worker.
+ *
+ * If the frame is in the decoded start of the stream, or in the part of
+ * the ring buffer already decoded, reads will continue without a gap.
+ *
+ * @param frame     The absolute frame position
+ */
+void AudioReadAhead::seek(Uint64 frame) {
+    frame = std::min(frame,_length);
+    _cursor = frame;
+
+    // The ring buffer always resumes where the decoded start ends
+    Uint64 start = std::max(frame,_headsize);
+    if (_readygen.load(std::memory_order_acquire) == _seekgen.load(std::memory_order_relaxed)) {
+        Uint64 read  = _readpos.load(std::memory_order_relaxed);
+        Uint64 write = _writepos.load(std::memory_order_acquire);
+        if (start >= read && start <= write) {
+            _readpos.store(start,std::memory_order_release);
+            return;
+        }
+    }
+
+    _seekpos.store(start,std::memory_order_relaxed);
+    _seekgen.fetch_add(1,std::memory_order_release);
+}
+
+#pragma mark -
+#pragma mark Worker Methods
+/**
+ * Decodes the stream until the ring buffer is full.
+ *
+ * WORKER ONLY: This method should only be called by the background
+ * worker of {@link AudioDevices}.
+ *
+ * This method services any pending seek before decoding.  It returns
+ * false if there was no work to do.
+ *
+ * @return true if any audio was decoded
+ */
+bool AudioReadAhead::fill() {
+    if (_ring == nullptr || isRetired()) {
+        return false;
+    }
+
+    bool work = false;
+    Uint32 gen = _seekgen.load(std::memory_order_acquire);
+    if (gen != _workgen) {
+        Uint64 frame = std::min(_seekpos.load(std::memory_order_relaxed),_length);
+        Uint32 pagesize = _decoder->getPageSize();
+        _decoder->setPage(frame/pagesize);
+        Sint32 amt = _decoder->pagein(_page);
+        _pagelimit = amt < 0 ? 0 : (Uint32)amt;
+        _pagelast  = std::min((Uint32)(frame % pagesize),_pagelimit);
+        _readpos.store(frame,std::memory_order_relaxed);
+        _writepos.store(frame,std::memory_order_relaxed);
+        _workgen = gen;
+        _readygen.store(gen,std::memory_order_release);
+        work = true;
+    }
+
+    Uint64 write = _writepos.load(std::memory_order_relaxed);
+    Uint64 read  = _readpos.load(std::memory_order_acquire);
+    while (write < _length && write-read < _capacity &&
+           _seekgen.load(std::memory_order_relaxed) == _workgen) {
+        if (_pagelast >= _pagelimit) {
+            Sint32 amt = _decoder->pagein(_page);
+            if (amt <= 0) {
+                break;
+            }
+            _pagelimit = (Uint32)amt;
+            _pagelast  = 0;
+        }
+
+        Uint64 amt = std::min((Uint64)(_pagelimit-_pagelast),_capacity-(write-read));
+        amt = std::min(amt,_length-write);
+        Uint32 slot  = (Uint32)(write % _capacity);
+        Uint32 first = (Uint32)std::min(amt,(Uint64)(_capacity-slot));
+        float* input = _page+_pagelast*_channels;
+        std::memcpy(_ring+slot*_channels,input,first*_channels*sizeof(float));
+        if (first < amt) {
+            std::memcpy(_ring,input+first*_channels,(amt-first)*_channels*sizeof(float));
+        }
+        _pagelast += (Uint32)amt;
+        write += amt;
+        _writepos.store(write,std::memory_order_release);
+        read = _readpos.load(std::memory_order_acquire);
+        work = true;
+    }
+    return work;
+}
@@ -0,0 +1,545 @@
+//
+//  CUAudioConvolver.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an audio node that applies a long impulse response
+//  (a reverb, a room tone, or a long EQ curve) to its input.  The impulse
+//  is applied with a partitioned FFT convolution, so the cost per frame
+//  grows slowly with the length of the impulse.  There is no added latency.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/audio/graph/CUAudioConvolver.h>
+#include <cugl/audio/CUAudioDevices.h>
+#include <cugl/audio/CUAudioSample.h>
+#include <cugl/math/dsp/CUDSPMath.h>
+#include <cugl/util/CUDebug.h>
+#include <cstring>
+
+using namespace cugl;
+using namespace cugl::audio;
+
+/**
+ * Creates a degenerate audio convolver
+ *
+ * The node has no channels, so read options will do nothing. The node must
+ * be initialized to be used.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a graph node on
+ * the heap, use one of the static constructors instead.
+ */
+AudioConvolver::AudioConvolver() : AudioNode(),
+_buffer(nullptr),
+_capacity(0),
+_wet(1.0f) {
+    _input = nullptr;
+    _classname = "AudioConvolver";
+}
+
+/**
+ * Initializes the node with default stereo settings
+ *
+ * The number of channels is two, for stereo output.  The sample rate is
+ * the modern standard of 48000 HZ.  The initial impulse response is a
+ * single unit tap, so the node is a pass-through.
+ *
+ * @return true if initialization was successful
+ */
+bool AudioConvolver::init() {
+    return init(DEFAULT_CHANNELS,DEFAULT_SAMPLING);
+}
+
+/**
+ * Initializes the node with the given number of channels and sample rate
+ *
+ * The initial impulse response is a single unit tap, so the node is a
+ * pass-through.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in HZ
+ *
+ * @return true if initialization was successful
+ */
+bool AudioConvolver::init(Uint8 channels, Uint32 rate) {
+    return init(channels,rate,std::vector<float>(1,1.0f));
+}
+
+/**
+ * Initializes the node with the given impulse response
+ *
+ * The impulse response is applied to each channel independently.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in HZ
+ * @param impulse   The impulse response
+ *
+ * @return true if initialization was successful
+ */
+bool AudioConvolver::init(Uint8 channels, Uint32 rate, const std::vector<float>& impulse) {
+    if (AudioNode::init(channels,rate)) {
+        _capacity = AudioDevices::get()->getReadSize();
+        _buffer = (float*)malloc(_capacity*_channels*sizeof(float));
+        _wet.store(1.0f,std::memory_order_relaxed);
+        setImpulse(impulse);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Disposes any resources allocated for this convolver
+ *
+ * The state of the node is reset to that of an uninitialized constructor.
+ * Unlike the destructor, this method allows the node to be reinitialized.
+ */
+void AudioConvolver::dispose() {
+    if (_booted) {
+        AudioNode::dispose();
+        _filter.clear();
+        _impulse.clear();
+        free(_buffer);
+        _buffer = nullptr;
+        _capacity = 0;
+        _input = nullptr;
+    }
+}
+
+#pragma mark -
+#pragma mark Audio Graph
+/**
+ * Attaches an audio node to this convolver.
+ *
+ * This method will fail if the channels or sample rate of the audio node
+ * do not agree with this convolver.
+ *
+ * @param node  The audio node to filter
+ *
+ * @return true if the attachment was successful
+ */
+bool AudioConvolver::attach(const std::shared_ptr<AudioNode>& node) {
+    if (!_booted) {
+        CUAssertLog(_booted, "Cannot attach to an uninitialized audio node");
+        return false;
+    } else if (node == nullptr) {
+        detach();
+        return true;
+    } else if (node->getChannels() != _channels) {
+        CUAssertLog(false,"Input node has wrong number of channels: %d", node->getChannels());
+        return false;
+    } else if (node->getRate() != _sampling) {
+        CUAssertLog(false,"Input node has wrong sample rate: %d", node->getRate());
+        return false;
+    }
+    
+    std::atomic_exchange_explicit(&_input,node,std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Detaches an audio node from this convolver.
+ *
+ * If the method succeeds, it returns the audio node that was removed.
+ *
+ * @return  The audio node to detach (or null if failed)
+ */
+std::shared_ptr<AudioNode> AudioConvolver::detach() {
+    if (!_booted) {
+        CUAssertLog(_booted, "Cannot detach from an uninitialized audio node");
+        return nullptr;
+    }
+    
+    std::shared_ptr<AudioNode> result = std::atomic_exchange_explicit(&_input,{},std::memory_order_relaxed);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Convolution
+/**
+ * Sets the impulse response of this convolver.
+ *
+ * The impulse response is applied to each channel independently.  The
+ * filter is built on the calling thread, and swapped in at the start
+ * of the next read.  This clears any sound still ringing in the old
+ * filter.
+ *
+ * @param impulse   The impulse response
+ */
+void AudioConvolver::setImpulse(const std::vector<float>& impulse) {
+    _impulse = impulse;
+    _filter.publish(new dsp::Convolver(_channels,impulse));
+}
+
+/**
+ * Sets the impulse response of this convolver to the given sample.
+ *
+ * The sample must be in memory (not streamed) and must agree with the
+ * sample rate of this node.  If the sample has more than one channel,
+ * the impulse response is the average of all of them. Otherwise this
+ * method will fail.
+ *
+ * @param sample    The impulse response
+ *
+ * @return true if the impulse response was successfully set
+ */
+bool AudioConvolver::setImpulse(const std::shared_ptr<AudioSample>& sample) {
+    if (sample == nullptr || sample->isStreamed()) {
+        CUAssertLog(false, "Impulse response must be an in-memory sample");
+        return false;
+    } else if (sample->getRate() != _sampling) {
+        CUAssertLog(false,"Impulse response has wrong sample rate: %d", sample->getRate());
+        return false;
+    }
+    
+    Uint32 channels = sample->getChannels();
+    Uint32 frames = (Uint32)sample->getLength();
+    std::vector<float> data(frames*channels);
+    frames = sample->read(data.data(), 0, frames);
+    
+    std::vector<float> impulse(frames,0.0f);
+    float scale = 1.0f/channels;
+    for(Uint32 ii = 0; ii < frames; ii++) {
+        for(Uint32 jj = 0; jj < channels; jj++) {
+            impulse[ii] += data[ii*channels+jj];
+        }
+        impulse[ii] *= scale;
+    }
+    setImpulse(impulse);
+    return true;
+}
+
+/**
+ * Returns the mix of the convolved (wet) signal in the output.
+ *
+ * A value of 1 means that the output is only the convolved signal,
+ * while a value of 0 means that the output is only the original (dry)
+ * signal.  Other values linearly interpolate the two.
+ *
+ * @return the mix of the convolved (wet) signal in the output.
+ */
+float AudioConvolver::getWet() const {
+    return _wet.load(std::memory_order_relaxed);
+}
+
+/**
+ * Sets the mix of the convolved (wet) signal in the output.
+ *
+ * A value of 1 means that the output is only the convolved signal,
+ * while a value of 0 means that the output is only the original (dry)
+ * signal.  Other values linearly interpolate the two.
+ *
+ * @param wet   The mix of the convolved (wet) signal in the output.
+ */
+void AudioConvolver::setWet(float wet) {
+    CUAssertLog(wet >= 0 && wet <= 1, "Wet mix %f is out of range",wet);
+    _wet.store(wet,std::memory_order_relaxed);
+}
+
+#pragma mark -
+#pragma mark Playback Control
+/**
+ * Returns true if this audio node has no more data.
+ *
+ * An audio node is typically completed if it return 0 (no frames read) on
+ * subsequent calls to {@link read()}.  However, for infinite-running
+ * audio threads, it is possible for this method to return true even when
+ * data can still be read; in that case the node is notifying that it
+ * should be shut down.
+ *
+ * @return true if this audio node has no more data.
+ */
+bool AudioConvolver::completed() {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    return (input == nullptr || input->completed());
+}
+
+/**
+ * Reads up to the specified number of frames into the given buffer
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ * The only exception is when the user needs to create a custom subclass
+ * of this AudioOutput.
+ *
+ * The buffer should have enough room to store frames * channels elements.
+ * The channels are interleaved into the output buffer.
+ *
+ * This method will always forward the read position.
+ *
+ * @param buffer    The read buffer to store the results
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioConvolver::read(float* buffer, Uint32 frames) {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
+        std::memset(buffer,0,frames*_channels*sizeof(float));
+        return frames;
+    }
+    
+    frames = std::min(frames,_capacity);
+    Uint32 amt = input->read(buffer, frames);
+    if (amt < frames) {
+        std::memset(buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
+    }
+    
+    dsp::Convolver* filter = _filter.acquire();
+    if (filter != nullptr) {
+        float wet = _wet.load(std::memory_order_relaxed);
+        if (wet >= 1.0f) {
+            filter->calculate(1.0f,buffer,buffer,frames);
+        } else {
+            filter->calculate(wet,buffer,_buffer,frames);
+            dsp::DSPMath::scale_add(buffer,_buffer,1.0f-wet,buffer,frames*_channels);
+        }
+    }
+    _filter.release();
+    return amt;
+}
+
+#pragma mark -
+#pragma mark Optional Methods
+/**
+ * Marks the current read position in the audio steam.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns false if there is no input node, indicating it is unsupported.
+ *
+ * This method is typically used by {@link reset()} to determine where to
+ * restore the read position. For some nodes (like {@link AudioInput}),
+ * this method may start recording data to a buffer, which will continue
+ * until {@link clear()} is called.
+ *
+ * It is possible for {@link reset()} to be supported even if this method
+ * is not.
+ *
+ * @return true if the read position was marked.
+ */
+bool AudioConvolver::mark() {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->mark();
+    }
+    return false;
+}
+
+/**
+ * Clears the current marked position.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns false if there is no input node, indicating it is unsupported.
+ *
+ * If the method {@link mark()} started recording to a buffer (such as
+ * with {@link AudioInput}), this method will stop recording and release
+ * the buffer.  When the mark is cleared, {@link reset()} may or may not
+ * work depending upon the specific node.
+ *
+ * @return true if the read position was marked.
+ */
+bool AudioConvolver::unmark() {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->unmark();
+    }
+    return false;
+}
+
+/**
+ * Resets the read position to the marked position of the audio stream.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns false if there is no input node, indicating it is unsupported.
+ *
+ * When no {@link mark()} is set, the result of this method is node
+ * dependent.  Some nodes (such as {@link AudioPlayer}) will reset to the
+ * beginning of the stream, while others (like {@link AudioInput}) only
+ * support a rest when a mark is set. Pay attention to the return value of
+ * this method to see if the call is successful.
+ *
+ * @return true if the read position was moved.
+ */
+bool AudioConvolver::reset() {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->reset();
+    }
+    return false;
+}
+
+/**
+ * Advances the stream by the given number of frames.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node, indicating it is unsupported.
+ *
+ * This method only advances the read position, it does not actually
+ * read data into a buffer. This method is generally not supported
+ * for nodes with real-time input like {@link AudioInput}.
+ *
+ * @param frames    The number of frames to advace
+ *
+ * @return the actual number of frames advanced; -1 if not supported
+ */
+Sint64 AudioConvolver::advance(Uint32 frames) {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->advance(frames);
+    }
+    return -1;
+}
+
+/**
+ * Returns the current frame position of this audio node
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node, indicating it is unsupported.
+ *
+ * In some nodes like {@link AudioInput}, this method is only supported
+ * if {@link mark()} is set.  In that case, the position will be the
+ * number of frames since the mark. Other nodes like {@link AudioPlayer}
+ * measure from the start of the stream.
+ *
+ * @return the current frame position of this audio node.
+ */
+Sint64 AudioConvolver::getPosition() const {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->getPosition();
+    }
+    return -1;
+}
+
+/**
+ * Sets the current frame position of this audio node.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node, indicating it is unsupported.
+ *
+ * In some nodes like {@link AudioInput}, this method is only supported
+ * if {@link mark()} is set.  In that case, the position will be the
+ * number of frames since the mark. Other nodes like {@link AudioPlayer}
+ * measure from the start of the stream.
+ *
+ * @param position  the current frame position of this audio node.
+ *
+ * @return the new frame position of this audio node.
+ */
+Sint64 AudioConvolver::setPosition(Uint32 position) {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->setPosition(position);
+    }
+    return -1;
+}
+
+/**
+ * Returns the elapsed time in seconds.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node, indicating it is unsupported.
+ *
+ * In some nodes like {@link AudioInput}, this method is only supported
+ * if {@link mark()} is set.  In that case, the times will be the
+ * number of seconds since the mark. Other nodes like {@link AudioPlayer}
+ * measure from the start of the stream.
+ *
+ * @return the elapsed time in seconds.
+ */
+double AudioConvolver::getElapsed() const {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->getElapsed();
+    }
+    return -1;
+}
+
+/**
+ * Sets the read position to the elapsed time in seconds.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node, indicating it is unsupported.
+ *
+ * In some nodes like {@link AudioInput}, this method is only supported
+ * if {@link mark()} is set.  In that case, the new time will be meaured
+ * from the mark. Other nodes like {@link AudioPlayer} measure from the
+ * start of the stream.
+ *
+ * @param time  The elapsed time in seconds.
+ *
+ * @return the new elapsed time in seconds.
+ */
+double AudioConvolver::setElapsed(double time) {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->setElapsed(time);
+    }
+    return -1;
+}
+
+/**
+ * Returns the remaining time in seconds.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node or if this method is unsupported
+ * in that node
+ *
+ * In some nodes like {@link AudioInput}, this method is only supported
+ * if {@link setRemaining()} has been called.  In that case, the node will
+ * be marked as completed after the given number of seconds.  This may or may
+ * not actually move the read head.  For example, in {@link AudioPlayer} it
+ * will skip to the end of the sample.  However, in {@link AudioInput} it
+ * will simply time out after the given time.
+ *
+ * @return the remaining time in seconds.
+ */
+double AudioConvolver::getRemaining() const {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->getRemaining();
+    }
+    return -1;
+}
+
+/**
+ * Sets the remaining time in seconds.
+ *
+ * DELEGATED METHOD: This method delegates its call to the input node.  It
+ * returns -1 if there is no input node or if this method is unsupported
+ * in that node
+ *
+ * If this method is supported, then the node will be marked as completed
+ * after the given number of seconds.  This may or may not actually move
+ * the read head.  For example, in {@link AudioPlayer} it will skip to the
+ * end of the sample.  However, in {@link AudioInput} it will simply time
+ * out after the given time.
+ *
+ * @param time  The remaining time in seconds.
+ *
+ * @return the new remaining time in seconds.
+ */
+double AudioConvolver::setRemaining(double time) {
+    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    if (input) {
+        return input->setRemaining(time);
+    }
+    return -1;
+}
@@ -43,6 +43,21 @@
 
 using namespace cugl::audio;
 
+/** A request to start a fade-in */
+#define REQUEST_FADE_IN     1
+/** A request to start a fade-out */
+#define REQUEST_FADE_OUT    2
+/** A request to start a fade-pause */
+#define REQUEST_FADE_DIP    4
+/** A request to end a fade-pause before it pauses */
+#define REQUEST_END_DIP     8
+/** A request to cancel all fades except a persistent fade-out */
+#define REQUEST_RESET       16
+/** A request to cancel all fades */
+#define REQUEST_CANCEL      32
+/** All of the requests that start a fade */
+#define REQUEST_FADES       (REQUEST_FADE_IN | REQUEST_FADE_OUT | REQUEST_FADE_DIP | REQUEST_END_DIP)
+
 /**
  * Creates a degenerate audio player with no associated source.
  *
@@ -50,15 +65,21 @@ using namespace cugl::audio;
  * The player must be initialized to be used.
  */
 AudioFader::AudioFader() :
+_requests(0),
+_inreq(-1),
+_outreq(-1),
+_keepreq(false),
+_dipreq(-1),
+_stopreq(0),
+_inmark(-1),
 _fadein(0),
+_outmark(-1),
 _fadeout(0),
+_outdone(false),
+_outkeep(false),
 _fadedip(0),
-_inmark(-1),
-_outmark(-1),
 _dipmark(-1),
 _dipstop(0),
-_outdone(false),
-_outkeep(false),
 _diphalf(false) {
     _classname = "AudioFader";
 }
@@ -132,11 +153,18 @@ bool AudioFader::init(const std::shared_ptr<AudioNode>& input) {
 void AudioFader::dispose() {
     if (_booted) {
         AudioNode::dispose();
+        _requests = 0;
+        _inreq = -1;
+        _outreq = -1;
+        _keepreq = false;
+        _dipreq = -1;
+        _stopreq = 0;
         _fadein = 0;
         _inmark = -1;
         _fadeout = 0;
         _outmark = -1;
         _outkeep = false;
+        _outdone = false;
         _fadedip = 0;
         _dipmark = -1;
         _dipstop = 0;
@@ -206,14 +234,8 @@ std::shared_ptr<AudioNode> AudioFader::detach() {
  * @param duration  The fade-in time in seconds
  */
 void AudioFader::fadeIn(double duration) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (duration <= 0) {
-        _inmark = -1;
-        _fadein = 0;
-    } else {
-        _inmark = (Sint64)(duration*getRate());
-        _fadein = 0;
-    }
+    _inreq.store(duration <= 0 ? -1 : (Sint64)(duration*getRate()),std::memory_order_relaxed);
+    request(0,REQUEST_FADE_IN);
 }
 
 /**
@@ -222,8 +244,13 @@ void AudioFader::fadeIn(double duration) {
  * @return true if this node is in an active fade-in.
  */
 bool AudioFader::isFadeIn() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _inmark >= 0;
+    Uint32 requests = _requests.load(std::memory_order_acquire);
+    if (requests & REQUEST_FADE_IN) {
+        return _inreq.load(std::memory_order_relaxed) >= 0;
+    } else if (requests & (REQUEST_RESET | REQUEST_CANCEL)) {
+        return false;
+    }
+    return _inmark.load(std::memory_order_relaxed) >= 0;
 }
 
 /**
@@ -246,16 +273,10 @@ bool AudioFader::isFadeIn() {
  * @param wrap      Whether to support a fade-out after reset
  */
 void AudioFader::fadeOut(double duration, bool wrap) {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (duration <= 0) {
-        _outmark = -1;
-        _fadeout = 0;
-    } else {
-        _outmark = (Sint64)(duration*getRate());
-        _fadeout = 0;
-    }
-    _outkeep = wrap;
-    _outdone = false;
+    _outreq.store(duration <= 0 ? -1 : (Sint64)(duration*getRate()),std::memory_order_relaxed);
+    _keepreq.store(wrap,std::memory_order_relaxed);
+    _outdone.store(false,std::memory_order_relaxed);
+    request(0,REQUEST_FADE_OUT);
 }
 
 /**
@@ -264,8 +285,15 @@ void AudioFader::fadeOut(double duration, bool wrap) {
  * @return true if this node is in an active fade-out.
  */
 bool AudioFader::isFadeOut() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _outmark >= 0;
+    Uint32 requests = _requests.load(std::memory_order_acquire);
+    if (requests & REQUEST_FADE_OUT) {
+        return _outreq.load(std::memory_order_relaxed) >= 0;
+    } else if (requests & REQUEST_CANCEL) {
+        return false;
+    } else if (requests & REQUEST_RESET) {
+        return _outkeep.load(std::memory_order_relaxed) && _outmark.load(std::memory_order_relaxed) >= 0;
+    }
+    return _outmark.load(std::memory_order_relaxed) >= 0;
 }
 
 /**
@@ -310,24 +338,20 @@ void AudioFader::fadePause(double duration) {
  * @param fadein   The fade-in time in seconds
  */
 void AudioFader::fadePause(double fadeout, double fadein) {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     // Do not pause twice
-    if (_dipmark >= 0) {
+    if (isFadePause()) {
         return;
     }
     
     // Now pause
     if (fadein < 0 || fadeout < 0) {
-        _dipmark = -1;
-        _fadedip = 0;
-        _dipstop = 0;
+        _dipreq.store(-1,std::memory_order_relaxed);
+        _stopreq.store(0,std::memory_order_relaxed);
     } else {
-        _dipmark = (Sint64)(fadeout*getRate());
-        _dipstop = (Uint64)(fadein*getRate());
-        _fadedip = 0;
+        _dipreq.store((Sint64)(fadeout*getRate()),std::memory_order_relaxed);
+        _stopreq.store((Uint64)(fadein*getRate()),std::memory_order_relaxed);
     }
-    _diphalf = false;
+    request(REQUEST_END_DIP,REQUEST_FADE_DIP);
 }
 
 /**
@@ -339,8 +363,85 @@ void AudioFader::fadePause(double fadeout, double fadein) {
  * @return true if this node is in an active fade-pause.
  */
 bool AudioFader::isFadePause() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _dipmark >= 0;
+    Uint32 requests = _requests.load(std::memory_order_acquire);
+    if (requests & REQUEST_FADE_DIP) {
+        return _dipreq.load(std::memory_order_relaxed) >= 0;
+    } else if (requests & (REQUEST_END_DIP | REQUEST_RESET | REQUEST_CANCEL)) {
+        return false;
+    }
+    return _dipmark.load(std::memory_order_relaxed) >= 0;
+}
+
+/**
+ * Replaces the pending fade requests.
+ *
+ * The requests in clear are withdrawn and the requests in set are added,
+ * in a single atomic step.  The audio thread applies the requests at the
+ * start of the next read.
+ *
+ * @param clear The requests to withdraw
+ * @param set   The requests to add
+ */
+void AudioFader::request(Uint32 clear, Uint32 set) {
+    Uint32 current = _requests.load(std::memory_order_relaxed);
+    while (!_requests.compare_exchange_weak(current, (current & ~clear) | set,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {}
+}
+
+/**
+ * Applies the pending fade requests.
+ *
+ * This method is called by {@link read} before any audio is processed.
+ * Cancellations are applied before new fades, so a fade requested after
+ * a cancellation is not lost.
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ * The only exception is when the user needs to create a custom subclass
+ * of this AudioNode.
+ *
+ * @param requests  The requests to apply
+ */
+void AudioFader::applyRequests(Uint32 requests) {
+    if (requests & (REQUEST_RESET | REQUEST_CANCEL)) {
+        _inmark.store(-1,std::memory_order_relaxed);
+        _fadein = 0;
+        if ((requests & REQUEST_CANCEL) || !_outkeep.load(std::memory_order_relaxed)) {
+            _outmark.store(-1,std::memory_order_relaxed);
+            _fadeout.store(0,std::memory_order_relaxed);
+        }
+        if (requests & REQUEST_CANCEL) {
+            _outkeep.store(false,std::memory_order_relaxed);
+        }
+        _outdone.store(false,std::memory_order_relaxed);
+        _dipmark.store(-1,std::memory_order_relaxed);
+        _fadedip = 0;
+        _dipstop = 0;
+        _diphalf.store(false,std::memory_order_relaxed);
+    }
+    if (requests & REQUEST_END_DIP) {
+        _dipmark.store(-1,std::memory_order_relaxed);
+        _fadedip = 0;
+        _dipstop = 0;
+        _diphalf.store(false,std::memory_order_relaxed);
+    }
+    if (requests & REQUEST_FADE_IN) {
+        _inmark.store(_inreq.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        _fadein = 0;
+    }
+    if (requests & REQUEST_FADE_OUT) {
+        _outmark.store(_outreq.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        _fadeout.store(0,std::memory_order_relaxed);
+        _outkeep.store(_keepreq.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        _outdone.store(false,std::memory_order_relaxed);
+    }
+    if ((requests & REQUEST_FADE_DIP) && _dipmark.load(std::memory_order_relaxed) < 0) {
+        Sint64 mark = _dipreq.load(std::memory_order_relaxed);
+        _dipmark.store(mark,std::memory_order_relaxed);
+        _dipstop = mark < 0 ? 0 : _stopreq.load(std::memory_order_relaxed);
+        _fadedip = 0;
+        _diphalf.store(false,std::memory_order_relaxed);
+    }
 }
 
 /**
@@ -363,14 +464,15 @@ bool AudioFader::isFadePause() {
  * @return the actual number of frames processed
  */
 Uint32 AudioFader::doFadeIn(float* buffer, Uint32 frames) {
-    if (_inmark >= 0) {
-        Uint32 left = std::min(frames,(Uint32)(_inmark-_fadein));
-        float start = (float)_fadein/(float)_inmark;
-        float ends  = (float)(left+_fadein)/(float)_inmark;
+    Sint64 inmark = _inmark.load(std::memory_order_relaxed);
+    if (inmark >= 0) {
+        Uint32 left = std::min(frames,(Uint32)(inmark-_fadein));
+        float start = (float)_fadein/(float)inmark;
+        float ends  = (float)(left+_fadein)/(float)inmark;
         dsp::DSPMath::slide(buffer,start,ends,buffer,left*_channels);
         _fadein += left;
-        if (_fadein >= _inmark) {
-            _inmark = -1;
+        if (_fadein >= (Uint64)inmark) {
+            _inmark.store(-1,std::memory_order_relaxed);
             _fadein = 0;
             if (_calling.load(std::memory_order_relaxed)) {
                 notify(shared_from_this(),Action::FADE_IN);
@@ -401,17 +503,20 @@ Uint32 AudioFader::doFadeIn(float* buffer, Uint32 frames) {
  */
 Uint32 AudioFader::doFadeOut(float* buffer, Uint32 frames) {
     Sint32 amt = frames;
-    if (_outmark >= 0) {
-        Sint32 left = std::max(std::min(amt,(Sint32)(_outmark-_fadeout)),0);
-        float start = (float)(_outmark-_fadeout)/(float)_outmark;
-        float ends  = (float)(_outmark-left-_fadeout)/(float)_outmark;
+    Sint64 outmark = _outmark.load(std::memory_order_relaxed);
+    if (outmark >= 0) {
+        Uint64 fadeout = _fadeout.load(std::memory_order_relaxed);
+        Sint32 left = std::max(std::min(amt,(Sint32)(outmark-fadeout)),0);
+        float start = (float)(outmark-fadeout)/(float)outmark;
+        float ends  = (float)(outmark-left-fadeout)/(float)outmark;
         dsp::DSPMath::slide(buffer,start,ends,buffer,left*_channels);
-        _fadeout += left;
-        if (_fadeout >= _outmark) {
-            _outmark = -1;
-            _fadeout = 0;
-            _outkeep = false;
-            _outdone = true;
+        fadeout += left;
+        _fadeout.store(fadeout,std::memory_order_relaxed);
+        if (fadeout >= (Uint64)outmark) {
+            _outmark.store(-1,std::memory_order_relaxed);
+            _fadeout.store(0,std::memory_order_relaxed);
+            _outkeep.store(false,std::memory_order_relaxed);
+            _outdone.store(true,std::memory_order_relaxed);
             if (_calling.load(std::memory_order_relaxed)) {
                 notify(shared_from_this(),Action::FADE_OUT);
             }
@@ -445,29 +550,30 @@ Uint32 AudioFader::doFadeOut(float* buffer, Uint32 frames) {
  */
 Uint32 AudioFader::doFadePause(float* buffer, Uint32 frames) {
     Uint32 amt = frames;
-    if (_dipmark >= 0) {
-        if (_diphalf) {
-            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(_dipmark+_dipstop-_fadedip),(Sint32)0));
-            float start = (float)(_fadedip-_dipmark)/(float)_dipstop;
-            float ends  = (float)(left+_fadedip-_dipmark)/(float)_dipstop;
+    Sint64 dipmark = _dipmark.load(std::memory_order_relaxed);
+    if (dipmark >= 0) {
+        if (_diphalf.load(std::memory_order_relaxed)) {
+            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(dipmark+_dipstop-_fadedip),(Sint32)0));
+            float start = (float)(_fadedip-dipmark)/(float)_dipstop;
+            float ends  = (float)(left+_fadedip-dipmark)/(float)_dipstop;
             dsp::DSPMath::slide(buffer,start,ends,buffer,left*_channels);
             _fadedip += left;
-            if (_fadedip >= _dipmark+_dipstop) {
-                _dipmark = -1;
+            if (_fadedip >= dipmark+_dipstop) {
+                _dipmark.store(-1,std::memory_order_relaxed);
                 _dipstop = 0;
                 _fadedip = 0;
-                _diphalf = false;
+                _diphalf.store(false,std::memory_order_relaxed);
             }
         } else {
-            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(_dipmark-_fadedip),(Sint32)0));
-            float start = (float)(_dipmark-_fadedip)/(float)_dipmark;
-            float ends  = (float)(_dipmark-left-_fadedip)/(float)_dipmark;
+            Uint32 left = std::min(amt,(Uint32)std::max((Sint32)(dipmark-_fadedip),(Sint32)0));
+            float start = (float)(dipmark-_fadedip)/(float)dipmark;
+            float ends  = (float)(dipmark-left-_fadedip)/(float)dipmark;
             dsp::DSPMath::slide(buffer,start,ends,buffer,left*_channels);
             _fadedip += left;
-            if (_fadedip >= _dipmark) {
+            if (_fadedip >= (Uint64)dipmark) {
                 _paused.store(true,std::memory_order_relaxed);
                 std::memset(buffer+left*_channels,0,(amt-left)*_channels*sizeof(float));
-                _diphalf = true;
+                _diphalf.store(true,std::memory_order_relaxed);
                 if (_calling.load(std::memory_order_relaxed)) {
                     notify(shared_from_this(),Action::FADE_DIP);
                 }
@@ -486,8 +592,7 @@ Uint32 AudioFader::doFadePause(float* buffer, Uint32 frames) {
  * @return true if this node is currently paused
  */
 bool AudioFader::isPaused() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    return _paused.load(std::memory_order_relaxed) || (_dipmark >= 0 && !_diphalf);
+    return _paused.load(std::memory_order_relaxed) || (isFadePause() && !_diphalf.load(std::memory_order_relaxed));
 }
 
 /**
@@ -499,8 +604,7 @@ bool AudioFader::isPaused() {
  * @return true if the node was successfully paused
  */
 bool AudioFader::pause() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_dipmark < 0 || _diphalf) {
+    if (!isFadePause() || _diphalf.load(std::memory_order_relaxed)) {
         return !_paused.exchange(true);
     }
     return false;
@@ -514,11 +618,8 @@ bool AudioFader::pause() {
  * @return true if the node was successfully resumed
  */
 bool AudioFader::resume() {
-    std::lock_guard<std::mutex> lock(_mutex);
-    if (_dipmark >= 0 && !_diphalf) {
-        _dipmark = -1;
-        _fadedip = 0;
-        _dipstart = 0;
+    if (isFadePause() && !_diphalf.load(std::memory_order_relaxed)) {
+        request(REQUEST_FADE_DIP,REQUEST_END_DIP);
         _paused.store(false,std::memory_order_relaxed);
         return true;
     }
@@ -544,13 +645,17 @@ bool AudioFader::resume() {
  * @return the actual number of frames read
  */
 Uint32 AudioFader::read(float* buffer, Uint32 frames) {
+    Uint32 requests = _requests.exchange(0,std::memory_order_acquire);
+    if (requests) {
+        applyRequests(requests);
+    }
+
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
         return frames;
     } else {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (!_outdone) {
+        if (!_outdone.load(std::memory_order_relaxed)) {
             Uint32 amt = input->read(buffer, frames);
             float gain = _ndgain.load(std::memory_order_relaxed);
             if (gain != 1) {
@@ -574,11 +679,7 @@ Uint32 AudioFader::read(float* buffer, Uint32 frames) {
  * @return true if this audio node has no more data.
  */
 bool AudioFader::completed() {
-    bool outdone = false;
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        outdone = _outdone;
-    }
+    bool outdone = _outdone.load(std::memory_order_relaxed);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     return (input == nullptr || input->completed() || outdone);
 }
@@ -626,26 +727,13 @@ bool AudioFader::unmark() {
  * @return true if the read position was moved.
  */
 bool AudioFader::reset() {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            if (!_outkeep) {
-                _outmark = -1;
-                _fadeout = 0;
-            }
-        }
-        _outdone = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
+    // A persistent fade-out survives a reset, even if it is not applied yet
+    Uint32 clear = REQUEST_FADES;
+    if (_keepreq.load(std::memory_order_relaxed)) {
+        clear &= ~REQUEST_FADE_OUT;
     }
+    _outdone.store(false,std::memory_order_relaxed);
+    request(clear,REQUEST_RESET);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->reset();
@@ -666,25 +754,8 @@ bool AudioFader::reset() {
  * @return the actual number of frames advanced; -1 if not supported
  */
 Sint64 AudioFader::advance(Uint32 frames) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    _outdone.store(false,std::memory_order_relaxed);
+    request(REQUEST_FADES,REQUEST_CANCEL);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->advance(frames);
@@ -721,25 +792,8 @@ Sint64 AudioFader::getPosition() const {
  * @return the new frame position of this audio node.
  */
 Sint64 AudioFader::setPosition(Uint32 position)  {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    _outdone.store(false,std::memory_order_relaxed);
+    request(REQUEST_FADES,REQUEST_CANCEL);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setPosition(position);
@@ -776,25 +830,8 @@ double AudioFader::getElapsed() const {
  * @return the new elapsed time in seconds.
  */
 double AudioFader::setElapsed(double time) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    _outdone.store(false,std::memory_order_relaxed);
+    request(REQUEST_FADES,REQUEST_CANCEL);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setElapsed(time);
@@ -812,8 +849,17 @@ double AudioFader::setElapsed(double time) {
  */
 double AudioFader::getRemaining() const  {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
-    if (_outmark >= 0) {
-        Sint64 temp =  std::max((Sint64)0,_outmark-(Sint64)_fadeout);
+    Sint64 outmark = _outmark.load(std::memory_order_relaxed);
+    Uint64 fadeout = _fadeout.load(std::memory_order_relaxed);
+    Uint32 requests = _requests.load(std::memory_order_acquire);
+    if (requests & REQUEST_FADE_OUT) {
+        outmark = _outreq.load(std::memory_order_relaxed);
+        fadeout = 0;
+    } else if (requests & REQUEST_CANCEL) {
+        outmark = -1;
+    }
+    if (outmark >= 0) {
+        Sint64 temp =  std::max((Sint64)0,outmark-(Sint64)fadeout);
         return ((double)temp)/_sampling;
     }
     if (input) {
@@ -835,25 +881,8 @@ double AudioFader::getRemaining() const  {
  * @return the new remaining time in seconds.
  */
 double AudioFader::setRemaining(double time) {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_inmark >= 0) {
-            _inmark = -1;
-            _fadein = 0;
-        }
-        if (_outmark >= 0) {
-            _outmark = -1;
-            _fadeout = 0;
-        }
-        _outdone = false;
-        _outkeep = false;
-        if (_dipmark >= 0) {
-            _dipmark = -1;
-            _fadedip = 0;
-            _dipstop = 0;
-        }
-        _diphalf = false;
-    }
+    _outdone.store(false,std::memory_order_relaxed);
+    request(REQUEST_FADES,REQUEST_CANCEL);
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
         return input->setRemaining(time);
@@ -60,9 +60,9 @@ AudioMixer::AudioMixer() :
 _width(0),
 _knee(-1),
 _capacity(0),
-_inputs(nullptr),
 _buffer(nullptr) {
     _classname = "AudioScheduler";
+    _inputs.publish(new Inputs());
 #if CU_PLATFORM == CU_PLATFORM_ANDROID
 	// Android handles clipping very badly.
 	_knee = AudioMixer::DEFAULT_KNEE;
@@ -145,10 +145,9 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
         _width = width;
         _knee  = -1;
         _capacity = AudioDevices::get()->getReadSize();
-        _inputs = new std::shared_ptr<AudioNode>[_width];
-        for (int ii = 0; ii < _width; ii++) {
-            _inputs[ii] = nullptr;
-        }
+        Inputs* inputs = new Inputs();
+        inputs->nodes.resize(_width);
+        _inputs.publish(inputs);
         _buffer = (float*)malloc(_capacity*_channels*sizeof(float));
         return true;
     }
@@ -164,9 +163,9 @@ bool AudioMixer::init(Uint8 width, Uint8 channels, Uint32 rate) {
 void AudioMixer::dispose() {
     if (_booted) {
         AudioNode::dispose();
-        delete[] _inputs;
+        _inputs.clear();
+        _inputs.publish(new Inputs());
         free(_buffer);
-        _inputs = nullptr;
         _buffer = nullptr;
         _width = 0;
         _knee  = -1;
@@ -203,7 +202,7 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
     }
     _marked.store(0,std::memory_order_relaxed);
     _offset.store(0,std::memory_order_relaxed);
-    return std::atomic_exchange_explicit(_inputs+slot,input,std::memory_order_relaxed);
+    return swap(slot,input);
 }
 
 /**
@@ -217,7 +216,32 @@ std::shared_ptr<AudioNode> AudioMixer::attach(Uint8 slot, const std::shared_ptr<
  */
 std::shared_ptr<AudioNode> AudioMixer::detach(Uint8 slot) {
     CUAssertLog(slot < _width, "Slot %d is out of range",slot);
-    return std::atomic_exchange_explicit(_inputs+slot,{},std::memory_order_relaxed);
+    return swap(slot,nullptr);
+}
+
+/**
+ * Replaces the input node at the given slot, returning the previous one.
+ *
+ * This method copies the current inputs into a new snapshot and publishes
+ * it. The audio thread continues to read the old snapshot until its next
+ * call to {@link read}.
+ *
+ * @param slot  The slot for the input node
+ * @param input The input node to attach (may be nullptr)
+ *
+ * @return the input node previously at the given slot
+ */
+std::shared_ptr<AudioNode> AudioMixer::swap(Uint8 slot, const std::shared_ptr<AudioNode>& input) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Inputs* current = _inputs.get();
+    if (current == nullptr || slot >= current->nodes.size()) {
+        return nullptr;
+    }
+    std::shared_ptr<AudioNode> result = current->nodes[slot];
+    Inputs* inputs = new Inputs(*current);
+    inputs->nodes[slot] = input;
+    _inputs.publish(inputs);
+    return result;
 }
 
 /**
@@ -243,20 +267,19 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
     frames = std::min(frames,_capacity);
     Uint32 actual = 0;
     if (!_paused.load(std::memory_order_relaxed)) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        std::shared_ptr<AudioNode> temp;
-        for(int ii = 0; ii < _width; ii++) {
-            temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+        // Accumulate with gain, so the mix is a single pass over each input
+        float gain = _ndgain.load(std::memory_order_relaxed);
+        Inputs* inputs = _inputs.acquire();
+        size_t width = inputs == nullptr ? 0 : inputs->nodes.size();
+        for(size_t ii = 0; ii < width; ii++) {
+            AudioNode* temp = inputs->nodes[ii].get();
             if (temp) {
                 Uint32 amt = temp->read(_buffer,frames);
                 actual = std::max(amt,actual);
-                if (amt < frames) {
-                    std::memset(_buffer+amt,0,(frames-amt)*_channels*sizeof(float));
-                }
-                dsp::DSPMath::add(_buffer,buffer,buffer,frames*_channels);
+                dsp::DSPMath::scale_add(_buffer,buffer,gain,buffer,amt*_channels);
             }
         }
-        dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,frames*_channels);
+        _inputs.release();
         float knee = _knee.load(std::memory_order_relaxed);
         if (knee == 1) {
             dsp::DSPMath::clamp(buffer,-1,1,frames*_channels);
@@ -276,27 +299,29 @@ Uint32 AudioMixer::read(float* buffer, Uint32 frames) {
 /**
  * Sets the width of this mixer.
  *
- * The width is the number of supported input slots. This method will only
- * succeed if the mixer is paused.  Otherwise, it will fail.
+ * The width is the number of supported input slots. It is safe to call
+ * this method while the mixer is playing, as the new slots are swapped
+ * in atomically.
  *
  * Once the width is adjusted, the children will be reassigned in order.
  * If the new width is less than the old width, children at the end of
  * the mixer will be dropped.
  *
+ * @param width The number of input slots
+ *
  * @return true if the mixer width was reset
  */
 bool AudioMixer::setWidth(Uint8 width) {
-    if (_paused.load(std::memory_order_relaxed)) {
-        std::shared_ptr<AudioNode>* replace = new std::shared_ptr<AudioNode>[width];
-        Uint32 min = width < _width ? width : _width;
-        for(int ii = 0; ii < width; ii++) {
-            replace[ii] = ii < min ? _inputs[ii] : nullptr;
-        }
-        delete[] _inputs;
-        _inputs = replace;
-        return true;
+    std::lock_guard<std::mutex> lock(_mutex);
+    Inputs* current = _inputs.get();
+    if (current == nullptr) {
+        return false;
     }
-    return false;
+    Inputs* inputs = new Inputs(*current);
+    inputs->nodes.resize(width);
+    _inputs.publish(inputs);
+    _width = width;
+    return true;
 }
 
 #pragma mark -
@@ -358,9 +383,9 @@ void AudioMixer::setKnee(float knee) {
 bool AudioMixer::mark() {
     std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             success = temp->mark() && success;
         }
@@ -391,9 +416,9 @@ bool AudioMixer::mark() {
 bool AudioMixer::unmark() {
     std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             success = temp->unmark() && success;
         }
@@ -419,9 +444,9 @@ bool AudioMixer::unmark() {
 bool AudioMixer::reset() {
     std::lock_guard<std::mutex> lock(_mutex);
     bool success = true;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             success = temp->reset() && success;
         }
@@ -450,9 +475,9 @@ Sint64 AudioMixer::advance(Uint32 frames) {
     std::lock_guard<std::mutex> lock(_mutex);
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             Sint64 amt = temp->advance(frames);
             actual = std::max(actual,amt);
@@ -504,9 +529,9 @@ Sint64 AudioMixer::setPosition(Uint32 position) {
     std::lock_guard<std::mutex> lock(_mutex);
     Sint64 actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             Sint64 amt = temp->setPosition(position);
             actual = std::max(actual,amt);
@@ -576,11 +601,12 @@ double AudioMixer::setElapsed(double time) {
  */
 double AudioMixer::getRemaining() const {
     // An unavoidable race condition has minor effects on accuracy
+    std::lock_guard<std::mutex> lock(_mutex);
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             double amt = temp->getRemaining();
             actual = std::max(actual,amt);
@@ -618,9 +644,9 @@ double AudioMixer::setRemaining(double time) {
     // Get longest time remaining
     double actual = 0;
     bool fail = false;
-    std::shared_ptr<AudioNode> temp;
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    Inputs* inputs = _inputs.get();
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             double amt = temp->getRemaining();
             actual = std::max(actual,amt);
@@ -631,8 +657,8 @@ double AudioMixer::setRemaining(double time) {
     Uint64 pos = _offset.load(std::memory_order_relaxed)+actual*getRate();
     
     // Now push forward
-    for(int ii = 0; ii < _width; ii++) {
-        temp = std::atomic_load_explicit(_inputs+ii,std::memory_order_relaxed);
+    for(auto it = inputs->nodes.begin(); it != inputs->nodes.end(); ++it) {
+        const std::shared_ptr<AudioNode>& temp = *it;
         if (temp) {
             Uint64 off = temp->setPosition((Uint32)pos);
             if (off < 0) {
@@ -43,7 +43,6 @@
 //
 #include <cugl/audio/graph/CUAudioNode.h>
 #include <cugl/audio/CUAudioDevices.h>
-#include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
 #include <sstream>
 
@@ -252,14 +251,15 @@ void AudioNode::setCallback(Callback callback) {
  * might change during that delay.  This is a wrapper to ensure that this
  * potential race condition happens gracefully and does not have any
  * unexpected side effects.
+ *
+ * The event is posted to {@link AudioDevices#postEvent}, which never locks
+ * or allocates.  So this method is safe to call from the audio thread.
  */
 void AudioNode::notify(const std::shared_ptr<AudioNode>& node, AudioNode::Action action) {
-    Application::get()->schedule([=] {
-        if (_callback) {
-            _callback(node,action);
-        }
-        return false;
-    });
+    AudioDevices* devices = AudioDevices::get();
+    if (devices != nullptr) {
+        devices->postEvent(shared_from_this(),node,action);
+    }
 }
 
 /**
@@ -0,0 +1,404 @@
+//
+//  CUAudioOfflineOutput.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an output node that is not attached to any audio
+//  device.  Instead of waiting on an SDL callback, it pulls the audio graph
+//  on demand.  It can render as fast as possible on the calling thread, or
+//  at a simulated real-time rate on a thread of its own.  The rendered audio
+//  can be captured in memory and saved as a WAV file.
+//
+//  This node is for profiling and debugging.  Every render call is timed,
+//  so it is possible to measure the CPU cost of an audio graph (and find
+//  the worst-case callback) without any audio hardware.
+//
+//  CUGL MIT License:
+//
+//     This software is provided 'as-is', without any express or implied
+//     warranty.  In no event will the authors be held liable for any damages
+//     arising from the use of this software.
+//
+//     Permission is granted to anyone to use this software for any purpose,
+//     including commercial applications, and to alter it and redistribute it
+//     freely, subject to the following restrictions:
+//
+//  1. The origin of this software must not be misrepresented; you must not
+//     claim that you wrote the original software. If you use this software
+//     in a product, an acknowledgment in the product documentation would be
+//     appreciated but is not required.
+//
+//  2. Altered source versions must be plainly marked as such, and must not
+//     be misrepresented as being the original software.
+//
+//  3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/audio/graph/CUAudioOfflineOutput.h>
+#include <cugl/audio/CUAudioDevices.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUTimestamp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace cugl::audio;
+
+/** The WAV format code for IEEE float samples */
+#define WAV_IEEE_FLOAT  0x0003
+
+#pragma mark Constructors
+/**
+ * Creates a degenerate offline output node.
+ *
+ * The node has not been initialized, so it cannot render.  The node
+ * must be initialized to be used.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a node on
+ * the heap, use one of the static constructors instead.
+ */
+AudioOfflineOutput::AudioOfflineOutput() : AudioOutput(),
+_thread(nullptr),
+_running(false),
+_capture(nullptr),
+_capacity(0),
+_captured(0),
+_callbacks(0),
+_totalCost(0),
+_worstCost(0) {
+    _classname = "AudioOfflineOutput";
+}
+
+/**
+ * Initializes an offline output node with 2 channels at 48000 Hz.
+ *
+ * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+ * frames, just like the default output device.
+ *
+ * The node is initialized unpaused.  It does not render anything until
+ * either {@link render} or {@link start} is called.
+ *
+ * @return true if initialization was successful
+ */
+bool AudioOfflineOutput::init() {
+    CUAssertLog(AudioDevices::get(),"Attempt to allocate a node without an active audio device manager");
+    return init(DEFAULT_CHANNELS,DEFAULT_SAMPLING,AudioDevices::get()->getReadSize());
+}
+
+/**
+ * Initializes an offline output node with the given channels and sample rate.
+ *
+ * Each call to {@link read} renders {@link AudioDevices#getReadSize()}
+ * frames, just like the default output device.
+ *
+ * The node is initialized unpaused.  It does not render anything until
+ * either {@link render} or {@link start} is called.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in Hz
+ *
+ * @return true if initialization was successful
+ */
+bool AudioOfflineOutput::init(Uint8 channels, Uint32 rate) {
+    CUAssertLog(AudioDevices::get(),"Attempt to allocate a node without an active audio device manager");
+    return init(channels,rate,AudioDevices::get()->getReadSize());
+}
+
+/**
+ * Initializes an offline output node with the given channels and sample rate.
+ *
+ * The buffer value is the number of frames rendered by each call to
+ * {@link read}. It should match the buffer size of the device being
+ * simulated.
+ *
+ * The node is initialized unpaused.  It does not render anything until
+ * either {@link render} or {@link start} is called.
+ *
+ * @param channels  The number of audio channels
+ * @param rate      The sample rate (frequency) in Hz
+ * @param buffer    The number of frames in each render call
+ *
+ * @return true if initialization was successful
+ */
+bool AudioOfflineOutput::init(Uint8 channels, Uint32 rate, Uint32 buffer) {
+    CUAssertLog(buffer, "Render buffer size is 0");
+    if (!AudioNode::init(channels,rate)) {
+        return false;
+    }
+
+    // There is no device, so the spec is exactly what was asked for
+    _dvname = "";
+    _device = 0;
+    std::memset(&_audiospec,0,sizeof(SDL_AudioSpec));
+    _audiospec.freq = rate;
+    _audiospec.channels = channels;
+    _audiospec.samples  = buffer;
+    _audiospec.format = AUDIO_F32SYS;
+    _bitrate = sizeof(float);
+
+    _active = false;
+    _paused = false;
+    resetStatistics();
+    return true;
+}
+
+/**
+ * Disposes any resources allocated for this offline output node.
+ *
+ * This method stops the simulated audio thread if it is running.  The
+ * state of the node is reset to that of an uninitialized constructor.
+ * Unlike the destructor, this method allows the node to be reinitialized.
+ */
+void AudioOfflineOutput::dispose() {
+    if (_booted) {
+        stop();
+        setCapture(0);
+        AudioOutput::dispose();
+    }
+}
+
+#pragma mark -
+#pragma mark Rendering
+/**
+ * Renders the given number of frames on the calling thread.
+ *
+ * The graph is pulled one buffer at a time, as fast as possible.  The
+ * number of frames is rounded up to a whole number of buffers.  This
+ * method does nothing if the simulated audio thread is running.
+ *
+ * @param frames    The number of frames to render
+ *
+ * @return the number of frames rendered
+ */
+Uint64 AudioOfflineOutput::render(Uint64 frames) {
+    if (!_booted || isRunning()) {
+        return 0;
+    }
+
+    Uint32 block = _audiospec.samples;
+    float* buffer = (float*)malloc(block*_channels*sizeof(float));
+    Uint64 total = 0;
+    while (total < frames) {
+        total += read(buffer,block);
+    }
+    free(buffer);
+    return total;
+}
+
+/**
+ * Starts the simulated audio thread.
+ *
+ * The thread pulls one buffer at a time, at the rate a real device with
+ * this buffer size and sample rate would.  If a render call takes longer
+ * than the duration of its buffer, the thread does not sleep before the
+ * next one. That call is counted in {@link getUnderruns}.
+ *
+ * @return true if the thread was started
+ */
+bool AudioOfflineOutput::start() {
+    if (!_booted || _thread != nullptr) {
+        return false;
+    }
+    _running.store(true);
+    _thread = new std::thread([this](void) { this->runLoop(); });
+    return true;
+}
+
+/**
+ * Stops the simulated audio thread.
+ *
+ * This method blocks until the thread has finished its current buffer.
+ * It does nothing if the thread is not running.
+ */
+void AudioOfflineOutput::stop() {
+    if (_thread != nullptr) {
+        _running.store(false);
+        _thread->join();
+        delete _thread;
+        _thread = nullptr;
+    }
+}
+
+/**
+ * Pulls the simulated audio thread until it is stopped.
+ *
+ * This is the body of the thread created by {@link start}.  It renders
+ * one buffer and then sleeps until that buffer would have finished
+ * playing on a real device.
+ */
+void AudioOfflineOutput::runLoop() {
+    Uint32 block = _audiospec.samples;
+    float* buffer = (float*)malloc(block*_channels*sizeof(float));
+
+    // Deadlines are absolute, so that sleep jitter does not accumulate
+    std::chrono::duration<double> period((double)block/_sampling);
+    auto deadline = std::chrono::steady_clock::now();
+    while (_running.load(std::memory_order_relaxed)) {
+        read(buffer,block);
+        deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        auto now = std::chrono::steady_clock::now();
+        if (now < deadline) {
+            std::this_thread::sleep_until(deadline);
+        } else {
+            deadline = now;
+        }
+    }
+    free(buffer);
+}
+
+/**
+ * Reads up to the specified number of frames into the given buffer
+ *
+ * AUDIO THREAD ONLY: Users should never access this method directly.
+ * Use {@link render} or {@link start} instead.
+ *
+ * This method pulls the graph exactly like {@link AudioOutput#read}.  In
+ * addition, it records the time of the call and appends the result to the
+ * capture buffer (if there is room).
+ *
+ * @param buffer    The read buffer to store the results
+ * @param frames    The maximum number of frames to read
+ *
+ * @return the actual number of frames read
+ */
+Uint32 AudioOfflineOutput::read(float* buffer, Uint32 frames) {
+    Uint32 result = AudioOutput::read(buffer,frames);
+    Uint64 cost = getOverhead();
+    _callbacks.fetch_add(1,std::memory_order_relaxed);
+    _totalCost.fetch_add(cost,std::memory_order_relaxed);
+    if (cost > _worstCost.load(std::memory_order_relaxed)) {
+        _worstCost.store(cost,std::memory_order_relaxed);
+    }
+
+    if (_capture != nullptr) {
+        Uint64 captured = _captured.load(std::memory_order_relaxed);
+        Uint64 amt = std::min((Uint64)result,_capacity-captured);
+        if (amt) {
+            std::memcpy(_capture+captured*_channels,buffer,amt*_channels*sizeof(float));
+            _captured.store(captured+amt,std::memory_order_release);
+        }
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Capture
+/**
+ * Sets the capacity of the capture buffer in frames.
+ *
+ * Rendered audio is copied into the capture buffer until it is full.
+ * Later audio is rendered, but not captured.  The buffer is allocated
+ * by this method, and never by the render calls.  Setting the capacity
+ * to 0 disables capture.  Any previous capture is discarded.
+ *
+ * This method should not be called while the simulated audio thread
+ * is running.
+ *
+ * @param frames    The capacity of the capture buffer in frames
+ */
+void AudioOfflineOutput::setCapture(Uint64 frames) {
+    CUAssertLog(!isRunning(), "Attempt to change the capture while rendering");
+    if (_capture != nullptr) {
+        free(_capture);
+        _capture = nullptr;
+    }
+    _capacity = frames;
+    _captured.store(0);
+    if (frames) {
+        _capture = (float*)malloc(frames*_channels*sizeof(float));
+    }
+}
+
+/**
+ * Saves the captured audio as a WAV file.
+ *
+ * The file uses 32 bit IEEE float samples at the rate and channels of
+ * this node.  If the file is a relative path, it is saved in the
+ * application save directory {@see Application#getSaveDirectory()}.
+ *
+ * @param file  The path (absolute or relative) to the file
+ *
+ * @return true if the file was written successfully
+ */
+bool AudioOfflineOutput::saveCapture(const std::string& file) const {
+    std::string path = cugl::filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "wb");
+    if (stream == NULL) {
+        CULogError("[AUDIO] %s", SDL_GetError());
+        return false;
+    }
+
+    Uint64 frames = getCaptured();
+    Uint32 align  = (Uint32)(_channels*sizeof(float));
+    Uint32 bytes  = (Uint32)(frames*align);
+
+    bool success = true;
+    success = success && SDL_RWwrite(stream, "RIFF", 4, 1) == 1;
+    success = success && SDL_WriteLE32(stream, 36+bytes);
+    success = success && SDL_RWwrite(stream, "WAVEfmt ", 8, 1) == 1;
+    success = success && SDL_WriteLE32(stream, 16);
+    success = success && SDL_WriteLE16(stream, WAV_IEEE_FLOAT);
+    success = success && SDL_WriteLE16(stream, _channels);
+    success = success && SDL_WriteLE32(stream, _sampling);
+    success = success && SDL_WriteLE32(stream, _sampling*align);
+    success = success && SDL_WriteLE16(stream, align);
+    success = success && SDL_WriteLE16(stream, 8*sizeof(float));
+    success = success && SDL_RWwrite(stream, "data", 4, 1) == 1;
+    success = success && SDL_WriteLE32(stream, bytes);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    success = success && (!frames || SDL_RWwrite(stream, _capture, align, frames) == frames);
+#else
+    for(Uint64 ii = 0; success && ii < frames*_channels; ii++) {
+        Uint32 bits;
+        std::memcpy(&bits,_capture+ii,sizeof(Uint32));
+        success = SDL_WriteLE32(stream, bits);
+    }
+#endif
+
+    SDL_RWclose(stream);
+    if (!success) {
+        CULogError("[AUDIO] Could not write '%s'", path.c_str());
+    }
+    return success;
+}
+
+#pragma mark -
+#pragma mark Statistics
+/**
+ * Returns the average render time of a buffer in microseconds.
+ *
+ * @return the average render time of a buffer in microseconds.
+ */
+double AudioOfflineOutput::getAverageCost() const {
+    Uint64 calls = _callbacks.load(std::memory_order_relaxed);
+    return calls ? (double)_totalCost.load(std::memory_order_relaxed)/calls : 0;
+}
+
+/**
+ * Returns the average render time as a fraction of the buffer duration.
+ *
+ * A load of 1 means that the graph takes as long to render as it takes
+ * to play.  A real device will start to underrun well before that.
+ *
+ * @return the average render time as a fraction of the buffer duration.
+ */
+double AudioOfflineOutput::getLoad() const {
+    if (!_sampling || !_audiospec.samples) {
+        return 0;
+    }
+    double duration = 1000000.0*_audiospec.samples/_sampling;
+    return getAverageCost()/duration;
+}
+
+/**
+ * Resets the render statistics.
+ *
+ * This method also resets the underrun count of {@link AudioOutput}.
+ */
+void AudioOfflineOutput::resetStatistics() {
+    _callbacks.store(0);
+    _totalCost.store(0);
+    _worstCost.store(0);
+    _underruns.store(0);
+}
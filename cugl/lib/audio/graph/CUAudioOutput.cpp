@@ -142,12 +142,14 @@ static int paddingSize(Uint32 inrate, Uint32 outrate) {
 AudioOutput::AudioOutput() : AudioNode(),
 _dvname(""),
 _overhd(0),
+_underruns(0),
 _cvtratio(1.0f),
 _cvtbuffer(nullptr),
 _input(nullptr) {
     _classname = "AudioOutput";
     _resampler = NULL;
     _bitrate = sizeof(float);
+    _device = 0;
 }
 
 /**
@@ -364,8 +366,11 @@ bool AudioOutput::init(const std::string& device, Uint8 channels, Uint32 rate, U
  */
 void AudioOutput::dispose() {
     if (_booted) {
-        SDL_PauseAudioDevice(_device, 1);
-        SDL_CloseAudioDevice(_device);
+        if (_device != 0) {
+            SDL_PauseAudioDevice(_device, 1);
+            SDL_CloseAudioDevice(_device);
+            _device = 0;
+        }
         detach();
         AudioNode::dispose();
         _active.store(false);
@@ -582,6 +587,9 @@ Uint32 AudioOutput::read(float* buffer, Uint32 frames) {
     Timestamp end;
     Uint64 micros = Timestamp::ellapsedMicros(start,end);
     _overhd.store(micros,std::memory_order_relaxed);
+    if (micros*_sampling > (Uint64)frames*1000000) {
+        _underruns.fetch_add(1,std::memory_order_relaxed);
+    }
     return frames;
 }
 
@@ -627,6 +635,20 @@ Uint64 AudioOutput::getOverhead() const {
     return _overhd.load(std::memory_order_relaxed);
 }
 
+/**
+ * Returns the number of underruns since this node was created.
+ *
+ * An underrun is a render call that took longer than the duration of the
+ * audio it produced.  When that happens, the device runs out of data and
+ * the listener hears a pop or a stutter.  This method is primarily for
+ * debugging and stress testing.
+ *
+ * @return the number of underruns since this node was created.
+ */
+Uint64 AudioOutput::getUnderruns() const {
+    return _underruns.load(std::memory_order_relaxed);
+}
+
 
 #pragma mark -
 #pragma mark Optional Methods
@@ -33,6 +33,7 @@
 //
 #include <cugl/audio/graph/CUAudioPanner.h>
 #include <cugl/audio/CUAudioDevices.h>
+#include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
 #include <cmath>
 
@@ -49,7 +50,10 @@ using namespace cugl::audio;
  */
 AudioPanner::AudioPanner() : AudioNode(),
 _field(0),
-_mapper(nullptr) {
+_buffer(nullptr),
+_capacity(0),
+_mapper(nullptr),
+_matrix(nullptr) {
     _input = nullptr;
     _classname = "AudioPanner";
 }
@@ -102,9 +106,8 @@ bool AudioPanner::init(Uint8 channels, Uint32 rate) {
  */
 bool AudioPanner::init(Uint8 channels, Uint8 field, Uint32 rate) {
     if (AudioNode::init(channels,rate)) {
-        setField(field);
         _capacity = AudioDevices::get()->getReadSize();
-        _buffer = (float*)malloc(_capacity*_field*sizeof(float));
+        setField(field);
         return true;
     }
     return false;
@@ -120,6 +123,9 @@ void AudioPanner::dispose() {
     if (_booted) {
         AudioNode::dispose();
         delete[] _mapper;
+        delete[] _matrix;
+        _mapper = nullptr;
+        _matrix = nullptr;
         free(_buffer);
         _buffer = nullptr;
         _capacity = 0;
@@ -196,7 +202,13 @@ bool AudioPanner::setField(Uint8 field) {
         return false;
     }
     
+    // Reallocate the buffers, as the field may be larger than before
+    delete[] _mapper;
+    delete[] _matrix;
+    free(_buffer);
     _field  = field;
+    _buffer = (float*)malloc(_capacity*_field*sizeof(float));
+    _matrix = new float[field*_channels];
     _mapper = new std::atomic<float>[field*_channels];
     for(int ii = 0; ii < field; ii++) {
         for(int jj = 0; jj < _channels; jj++) {
@@ -283,22 +295,13 @@ Uint32 AudioPanner::read(float* buffer, Uint32 frames) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
     } else {
         frames = std::min(frames,_capacity);
-        std::memset(buffer,0,frames*_channels*sizeof(float));
         Uint32 amt = input->read(_buffer, frames);
-        for(int ii = 0; ii < _field; ii++) {
-            for(int jj = 0; jj < _channels; jj++) {
-                float percent =  _mapper[ii*_channels+jj].load(std::memory_order_relaxed);
-                if (percent > 0) {
-                    float* output = buffer+jj;
-                    float* input  = _buffer+ii;
-                    Uint32 tmp = amt;
-                    while (tmp--) {
-                        *output += *input*percent;
-                        output += _channels;
-                        input += _field;
-                    }
-                }
-            }
+        for(int ii = 0; ii < _field*_channels; ii++) {
+            _matrix[ii] = _mapper[ii].load(std::memory_order_relaxed);
+        }
+        dsp::DSPMath::pan(_buffer,_field,_matrix,_channels,buffer,amt);
+        if (amt < frames) {
+            std::memset(buffer+amt*_channels,0,(frames-amt)*_channels*sizeof(float));
         }
         return amt;
     }
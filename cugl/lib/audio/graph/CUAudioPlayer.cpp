@@ -58,7 +58,6 @@ using namespace cugl;
 AudioPlayer::AudioPlayer() : AudioNode(),
 _offset(0),
 _marked(0),
-_buffer(nullptr),
 _decoder(nullptr),
 _source(nullptr),
 _chunker(nullptr),
@@ -82,12 +81,17 @@ _dirty(false) {
 bool AudioPlayer::init(const std::shared_ptr<AudioSample>& source) {
     if (AudioNode::init(source->getChannels(),source->getRate())) {
         _source = source;
-        _buffer = source->getBuffer();
         _dirty  = false;
         
-        // TODO: Require manager active and access buffer from it.
-        _decoder = source->getDecoder();
-        if (source->isStreamed() && _decoder != nullptr) {
+        // In-memory samples are read directly from the source
+        _decoder = source->isStreamed() ? source->getDecoder() : nullptr;
+        if (source->isStreamed() && _decoder != nullptr && AudioDevices::get() != nullptr) {
+            _readahead = AudioReadAhead::alloc(_decoder);
+            if (_readahead != nullptr) {
+                AudioDevices::get()->addStream(_readahead);
+            }
+        }
+        if (source->isStreamed() && _decoder != nullptr && _readahead == nullptr) {
             Uint32 channels = _decoder->getChannels();
             _chksize  = _decoder->getPageSize();
             _chklimt  = _chksize;
@@ -113,12 +117,16 @@ void AudioPlayer::dispose() {
         _decoder = nullptr;
         _offset.store(0);
         _marked.store(0);
-        _buffer  = nullptr;
         _calling.store(false);
         _callback = nullptr;
         _chksize = 0;
         _chklimt = 0;
         _chklast = 0;
+        if (_readahead) {
+            // The worker releases the last reference
+            _readahead->retire();
+            _readahead = nullptr;
+        }
         if (_chunker) {
             free(_chunker);
             _chunker = nullptr;
@@ -159,12 +167,20 @@ Uint32 AudioPlayer::read(float* buffer, Uint32 frames) {
     }
     
     Uint32 amt = frames;
-    if (_buffer) {
-        float* input  = _buffer;
-        input += off*_source->getChannels();
-    
-        amt = (Uint32)(off+amt > _source->getLength() ? _source->getLength()-off : amt);
-        std::memcpy(buffer,input,sizeof(float)*amt*_source->getChannels());
+    Uint32 result = frames;
+    if (!_source->isStreamed()) {
+        // Converts compact sample formats to float
+        amt = _source->read(buffer, off, frames);
+        result = amt;
+    } else if (_readahead) {
+        if (_dirty.load(std::memory_order_acquire)) {
+            _readahead->seek(off);
+            _dirty.store(false,std::memory_order_relaxed);
+        }
+        
+        // On an underrun, play silence without advancing the stream
+        amt = _readahead->read(buffer, frames);
+        result = (amt < frames && (Sint64)(off+amt) < _source->getLength()) ? frames : amt;
     } else {
         if (_dirty.load(std::memory_order_acquire)) {
             scan(off);
@@ -189,13 +205,13 @@ Uint32 AudioPlayer::read(float* buffer, Uint32 frames) {
             }
         }
         amt -= remnant;
+        result = amt;
     }
 
     dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,amt*_channels);
     _offset.store(off+amt,std::memory_order_release);
     _polling.store(false);
-    Timestamp end;
-    return amt;
+    return result;
 }
 
 /**
@@ -3,8 +3,8 @@
 //  Cornell University Game Library (CUGL)
 //
 //  This module provides a graph node for converting from one sample rate to
-//  another.  It uses SDL_AudioStream to perform continuous resampling on a
-//  potentially infinite audio stream.  This is is necessary for cross-platform
+//  another.  It uses a polyphase windowed-sinc filter to perform continuous
+//  resampling on a potentially infinite audio stream.  This is is necessary for cross-platform
 //  reasons as iPhones are very stubborn about delivering any requested sampling
 //  rates other than 48000.
 //
@@ -35,34 +35,33 @@
 #include <cugl/audio/CUAudioDevices.h>
 #include <cugl/math/dsp/CUDSPMath.h>
 #include <cugl/util/CUDebug.h>
+#include <algorithm>
 #include <cmath>
 
 using namespace cugl::audio;
 
-/** Constants taken from SDL */
-#define RESAMPLER_ZERO_CROSSINGS  5
-#define RESAMPLER_BITS_PER_SAMPLE 16
-#define RESAMPLER_SAMPLES_PER_ZERO_CROSSING  (1 << ((RESAMPLER_BITS_PER_SAMPLE / 2) + 1))
-#define RESAMPLER_FILTER_SIZE ((RESAMPLER_SAMPLES_PER_ZERO_CROSSING * RESAMPLER_ZERO_CROSSINGS) + 1)
+/** The number of filter taps per phase when upsampling (must be even) */
+#define RESAMPLER_TAPS      16
+/** The maximum number of filter taps per phase */
+#define RESAMPLER_MAX_TAPS  64
+/** The maximum number of filter phases */
+#define RESAMPLER_MAX_PHASES 1024
 
 /**
- * Returns the padding size necessary to go from one sample rate to another
+ * Returns the greatest common divisor of two sample rates
  *
- * This computation is done internally in SDL.  We needed to expose it so that we
- * can correcly "pre-fill" the buffer.
+ * @param a     The first sample rate
+ * @param b     The second sample rate
  *
- * @param inrate    The input sampling rate
- * @param outrate   The output sampling rate
- *
- * @return the padding size necessary to go from one sample rate to another
+ * @return the greatest common divisor of two sample rates
  */
-static int paddingSize(Uint32 inrate, Uint32 outrate) {
-    if (inrate == outrate) {
-        return 0;
-    } else if (inrate > outrate) {
-        return (int) SDL_ceil(((float) (RESAMPLER_SAMPLES_PER_ZERO_CROSSING * inrate) / ((float) outrate)));
+static Uint32 gcd(Uint32 a, Uint32 b) {
+    while (b) {
+        Uint32 t = a % b;
+        a = b;
+        b = t;
     }
-    return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+    return a;
 }
 
 #pragma mark -
@@ -79,14 +78,78 @@ static int paddingSize(Uint32 inrate, Uint32 outrate) {
  */
 AudioResampler::AudioResampler() : AudioNode(),
 _inputrate(0),
-_capacity(0),
-_cvtratio(1.0f),
-_cvtbuffer(nullptr),
-_resampler(nullptr) {
+_cvtratio(1.0f) {
     _input = nullptr;
     _classname = "AudioResampler";
 }
 
+/**
+ * Deletes this conversion state, freeing the filter and buffers
+ */
+AudioResampler::Converter::~Converter() {
+    if (filter != nullptr) {
+        free(filter);
+        filter = nullptr;
+    }
+    if (history != nullptr) {
+        free(history);
+        history = nullptr;
+    }
+    if (buffer != nullptr) {
+        free(buffer);
+        buffer = nullptr;
+    }
+    input = nullptr;
+}
+
+/**
+ * Builds the polyphase filter for the given rates.
+ *
+ * The filter is a Blackman-windowed sinc.  When downsampling, the cutoff
+ * is lowered to the output Nyquist frequency, and the filter is widened
+ * to match.  Each phase is normalized to unit gain.
+ *
+ * @param inrate    The input sampling rate
+ * @param outrate   The output sampling rate
+ */
+void AudioResampler::Converter::buildFilter(Uint32 inrate, Uint32 outrate) {
+    Uint32 div = gcd(inrate,outrate);
+    Uint32 phases = outrate/div;
+    Uint32 step   = inrate/div;
+    if (phases > RESAMPLER_MAX_PHASES) {
+        // Approximate the ratio; the pitch error is at most a few cents
+        step   = std::max((Uint32)std::lround((double)step*RESAMPLER_MAX_PHASES/phases),(Uint32)1);
+        phases = RESAMPLER_MAX_PHASES;
+    }
+
+    double cutoff = std::min(1.0,(double)outrate/(double)inrate);
+    Uint32 taps = (Uint32)std::ceil(RESAMPLER_TAPS/cutoff);
+    taps = std::min((taps+3) & ~3,(Uint32)RESAMPLER_MAX_TAPS);
+    double half = taps/2;
+
+    this->phases = phases;
+    this->step   = step;
+    this->taps   = taps;
+    filter = (float*)malloc(phases*taps*sizeof(float));
+    for(Uint32 pp = 0; pp < phases; pp++) {
+        float* coeffs = filter+pp*taps;
+        double frac = (double)pp/phases;
+        double total = 0;
+        for(Uint32 kk = 0; kk < taps; kk++) {
+            double dist = (double)kk-(half-1)-frac;
+            double x = M_PI*dist*cutoff;
+            double sinc = std::fabs(x) < 1e-9 ? 1.0 : std::sin(x)/x;
+            double w = M_PI*dist/half;
+            double window = std::fabs(dist) >= half ? 0 : 0.42+0.5*std::cos(w)+0.08*std::cos(2*w);
+            coeffs[kk] = (float)(sinc*window);
+            total += coeffs[kk];
+        }
+        for(Uint32 kk = 0; kk < taps; kk++) {
+            coeffs[kk] = (float)(coeffs[kk]/total);
+        }
+    }
+}
+
 /**
  * Initializes a resampler with 2 channels at 48000 Hz.
  *
@@ -114,10 +177,6 @@ bool AudioResampler::init() {
  */
 bool AudioResampler::init(Uint8 channels, Uint32 rate) {
     if (AudioNode::init(channels,rate)) {
-        _capacity = sizeof(float)*_channels*2*AudioDevices::get()->getReadSize();
-        _cvtbuffer = (float*)malloc(_capacity);
-        std::memset(_cvtbuffer,0,_capacity);
-        
         _inputrate = rate;
         return true;
     }
@@ -133,14 +192,7 @@ bool AudioResampler::init(Uint8 channels, Uint32 rate) {
 void AudioResampler::dispose() {
     if (_booted) {
         _input = nullptr;
-        if (_resampler != NULL) {
-            SDL_AudioStreamClear(_resampler);
-            SDL_FreeAudioStream(_resampler);
-            free(_cvtbuffer);
-            _resampler = NULL;
-            _cvtbuffer = nullptr;
-        }
-        _capacity  = 0;
+        _converter.clear();
         _cvtratio  = 1.0f;
         _inputrate = 0;
     }
@@ -151,10 +203,10 @@ void AudioResampler::dispose() {
 /**
  * Attaches an audio node to this resampler.
  *
- * This method will reset the resampler stream if the input has a different
- * rate than the previous input value (and is not the same rate as the
- * output).  It will fail if the input does not have the same number of
- * channels as this resampler.
+ * This method will create a new conversion filter for the input (unless the
+ * input has the same rate as the output).  The new filter is swapped in
+ * atomically, so the audio thread never waits on this method.  It will fail
+ * if the input does not have the same number of channels as this resampler.
  *
  * @param node  The audio node to resample
  *
@@ -177,49 +229,41 @@ bool AudioResampler::attach(const std::shared_ptr<AudioNode>& node) {
         detach();
     }
 
-    {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        if (node->getRate() != _inputrate) {
-            _inputrate = node->getRate();
-            _cvtratio  = ((float)_inputrate)/getRate();
-            size_t bsize = sizeof(float)*_channels*std::ceil(_cvtratio*AudioDevices::get()->getReadSize());
-            if (bsize > _capacity) {
-                free(_cvtbuffer);
-                _capacity  = bsize;
-                _cvtbuffer = (float*)malloc(_capacity);
-            }
-            if (_resampler != NULL) {
-                SDL_AudioStreamClear(_resampler);
-                SDL_FreeAudioStream(_resampler);
-            }
-            if (_inputrate != getRate()) {
-                _resampler = SDL_NewAudioStream(AUDIO_F32SYS, _channels, _inputrate,
-                                                AUDIO_F32SYS, _channels, getRate());
-                if (_resampler == NULL) {
-                    CULogError("[AUDIO] Could not create a resampler.");
-                    return false;
-                }
-            }
-        }
-        
-        // Initial 0s (else it will pop)
-        std::memset(_cvtbuffer,0,_capacity);
-        Uint32 padding = paddingSize(_inputrate, getRate())*_channels;
-        if (padding) {
-            SDL_AudioStreamPut(_resampler, _cvtbuffer, padding*sizeof(float));
-        }
-        
-        std::atomic_store_explicit(&_input,node,std::memory_order_relaxed);
-        return true;
+    // Build the new conversion state off the audio thread
+    Converter* converter = new Converter();
+    converter->input = node;
+    converter->ratio = ((float)node->getRate())/getRate();
+    
+    size_t frames = 2*AudioDevices::get()->getReadSize();
+    frames = std::max(frames,(size_t)std::ceil(converter->ratio*AudioDevices::get()->getReadSize()));
+    size_t bsize = sizeof(float)*_channels*frames;
+    converter->buffer = (float*)malloc(bsize);
+    converter->capacity = (Uint32)frames;
+    std::memset(converter->buffer,0,bsize);
+    
+    if (node->getRate() != getRate()) {
+        converter->buildFilter(node->getRate(),getRate());
+
+        // Prime with 0s so the first output is centered on the first input
+        converter->rowsize = converter->capacity+converter->taps;
+        size_t hsize = sizeof(float)*_channels*converter->rowsize;
+        converter->history = (float*)malloc(hsize);
+        std::memset(converter->history,0,hsize);
+        converter->length = converter->taps/2-1;
     }
-    return false;
+    
+    _inputrate = node->getRate();
+    _cvtratio.store(converter->ratio,std::memory_order_relaxed);
+    _converter.publish(converter);
+    std::atomic_store_explicit(&_input,node,std::memory_order_relaxed);
+    return true;
 }
 
 /**
  * Detaches an audio node from this resampler.
  *
  * If the method succeeds, it returns the audio node that was removed.
- * This method will not automatically reset the sampling stream.
+ * The sampling stream for the input is released as well.
  *
  * @return  The audio node to detach (or null if failed)
  */
@@ -230,6 +274,7 @@ std::shared_ptr<AudioNode> AudioResampler::detach() {
     }
     
     std::shared_ptr<AudioNode> result = std::atomic_exchange_explicit(&_input,{},std::memory_order_relaxed);
+    _converter.publish(nullptr);
     return result;
 }
 
@@ -269,43 +314,68 @@ bool AudioResampler::completed() {
  * @return the actual number of frames read
  */
 Uint32 AudioResampler::read(float* buffer, Uint32 frames) {
-    std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
+    Converter* converter = _converter.acquire();
+    AudioNode* input = converter == nullptr ? nullptr : converter->input.get();
     if (input == nullptr || _paused.load(std::memory_order_relaxed)) {
         std::memset(buffer,0,frames*_channels*sizeof(float));
-    } else {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        Sint32 take = 0;
-        if (_resampler != NULL) {
-            bool search = true;
-            while (take < frames && search) {
-                Sint32 amt = std::ceil(frames*_cvtratio);
-                amt = input->read(_cvtbuffer, amt);
-                if (SDL_AudioStreamPut(_resampler, _cvtbuffer, amt*sizeof(float)*_channels) < 0) {
-                    CULogError("[AUDIO] Resampling error.");
-                    std::memset(buffer+take*_channels,0,(frames-take)*_channels*sizeof(float));
-                    take = frames;
-                } else {
-                    amt  = SDL_AudioStreamGet(_resampler, buffer+take*_channels,
-                                              (int)((frames-take)*_channels*sizeof(float)));
-                    if (amt == -1) {
-                        CULogError("[AUDIO] Resampling error.");
-                        std::memset(buffer+take*_channels,0,(frames-take)*_channels*sizeof(float));
-                        take = frames;
-                    } else if (amt == 0) {
-                        search = false;
-                    } else {
-                        take += amt/sizeof(float)*_channels;
+        _converter.release();
+        return frames;
+    }
+    
+    Uint32 take = 0;
+    if (converter->filter != nullptr) {
+        Converter& cvt = *converter;
+        bool search = true;
+        while (take < frames && search) {
+            // Filter as many frames as the history allows
+            while (take < frames && cvt.cursor+cvt.taps <= cvt.length) {
+                const float* coeffs = cvt.filter+cvt.phase*cvt.taps;
+                float* output = buffer+take*_channels;
+                for(Uint32 ch = 0; ch < _channels; ch++) {
+                    const float* row = cvt.history+ch*cvt.rowsize+cvt.cursor;
+                    output[ch] = dsp::DSPMath::dot(row,coeffs,cvt.taps);
+                }
+                cvt.phase  += cvt.step;
+                cvt.cursor += cvt.phase/cvt.phases;
+                cvt.phase  %= cvt.phases;
+                take++;
+            }
+
+            if (take < frames) {
+                // Slide the unused history to the front of each row
+                Uint32 keep = cvt.cursor < cvt.length ? cvt.length-cvt.cursor : 0;
+                for(Uint32 ch = 0; ch < _channels && keep; ch++) {
+                    float* row = cvt.history+ch*cvt.rowsize;
+                    std::memmove(row,row+cvt.cursor,keep*sizeof(float));
+                }
+                cvt.cursor = cvt.cursor < cvt.length ? 0 : cvt.cursor-cvt.length;
+                cvt.length = keep;
+
+                // Read only as much input as we need
+                Uint32 need = (Uint32)std::ceil((frames-take)*cvt.ratio)+cvt.taps;
+                need = std::min(std::min(need,cvt.capacity),cvt.rowsize-cvt.length);
+                Uint32 amt = need ? input->read(cvt.buffer,need) : 0;
+                if (amt == 0) {
+                    search = false;
+                }
+                for(Uint32 ch = 0; ch < _channels; ch++) {
+                    float* row = cvt.history+ch*cvt.rowsize+cvt.length;
+                    const float* src = cvt.buffer+ch;
+                    for(Uint32 ff = 0; ff < amt; ff++) {
+                        row[ff] = *src;
+                        src += _channels;
                     }
                 }
+                cvt.length += amt;
             }
-        } else {
-            take = input->read(buffer, frames);
         }
-        
-        dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,take*_channels);
-        return take;
+    } else {
+        take = input->read(buffer, frames);
     }
-    return frames;
+    _converter.release();
+    
+    dsp::DSPMath::scale(buffer,_ndgain.load(std::memory_order_relaxed),buffer,take*_channels);
+    return take;
 }
 
 #pragma mark -
@@ -394,8 +464,7 @@ bool AudioResampler::reset() {
 Sint64 AudioResampler::advance(Uint32 frames) {
     std::shared_ptr<AudioNode> input = std::atomic_load_explicit(&_input,std::memory_order_relaxed);
     if (input) {
-        std::unique_lock<std::mutex> lk(_buffmtex);
-        return input->advance(std::ceil(frames*_cvtratio));
+        return input->advance(std::ceil(frames*_cvtratio.load(std::memory_order_relaxed)));
     }
     return -1;
 }
@@ -44,6 +44,10 @@
 #define DEFAULT_HEIGHT  576
 /** The default smoothing window for fps calculation */
 #define FPS_WINDOW      10
+/** The default fixed timestep in microseconds (60 per second) */
+#define DEFAULT_FIXED_STEP  16667
+/** The default maximum number of fixed timesteps in a frame */
+#define DEFAULT_FIXED_LIMIT 5
 
 using namespace cugl;
 
@@ -67,6 +71,11 @@ _assetdir(""),
 _state(State::NONE),
 _fullscreen(false),
 _highdpi(true),
+_headless(false),
+_fixed(false),
+_fixedStep(DEFAULT_FIXED_STEP),
+_fixedRemainder(0),
+_fixedLimit(DEFAULT_FIXED_LIMIT),
 _funcid(0),
 _clearColor(Color4f::CORNFLOWER) // Ah, XNA
 {
@@ -96,6 +105,10 @@ void Application::dispose() {
     _fullscreen = false;
     _highdpi = true;
     _fpswindow.clear();
+    _fixed = false;
+    _fixedStep = DEFAULT_FIXED_STEP;
+    _fixedRemainder = 0;
+    _fixedLimit = DEFAULT_FIXED_LIMIT;
     _clearColor = Color4f::CORNFLOWER;
     setFPS(60.0f);
 }
@@ -127,6 +140,9 @@ bool Application::init() {
     if (_multisamp) {
         flags |= Display::INIT_MULTISAMPLED;
     }
+    if (_headless) {
+        flags |= Display::INIT_HEADLESS;
+    }
     if (!Display::start(_name,_display, flags)) {
         return false;
     }
@@ -143,7 +159,9 @@ bool Application::init() {
     }
     
     _fpswindow.resize(FPS_WINDOW,1.0f/_fps);
-    SDL_GL_SetSwapInterval(1);
+    if (!_headless) {
+        SDL_GL_SetSwapInterval(1);
+    }
     Input::start();
     Texture::getBlank(); // Prevent this from happening in loading threads
     Application::_theapp = this;
@@ -271,10 +289,26 @@ bool Application::step() {
     bool running = getInput();
     if (running &&  _state == State::FOREGROUND) {
         processCallbacks(((Uint32)micros)/1000);
-        update(micros/1000000.0f);
+        if (_fixed) {
+            preUpdate(micros/1000000.0f);
+            _fixedRemainder += micros;
+            Uint32 steps = 0;
+            while (_fixedRemainder >= _fixedStep && steps < _fixedLimit) {
+                fixedUpdate();
+                _fixedRemainder -= _fixedStep;
+                steps++;
+            }
+            // Drop the time we could not catch up on
+            _fixedRemainder = (_fixedRemainder >= _fixedStep ? _fixedRemainder % _fixedStep : _fixedRemainder);
+            postUpdate(micros/1000000.0f);
+        } else {
+            update(micros/1000000.0f);
+        }
 
-        glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
-        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (!_headless) {
+            glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
+            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
         draw();
         Display::get()->refresh();
@@ -534,6 +568,24 @@ void Application::setMultiSampled(bool flag) {
 	_multisamp = flag;
 }
 
+/**
+ * Sets whether this application runs without a window or OpenGL context.
+ *
+ * A headless application has the normal update-draw loop, but all of
+ * its rendering is redirected to the {@link RenderRecorder}. Nothing
+ * is drawn, but the draw calls, vertices, and uploads are counted. This
+ * allows render tests to run on build machines without a graphics card.
+ *
+ * This value must be set before the application is initialized. By
+ * default, it is false.
+ *
+ * @param flag  Whether this application runs without a window or OpenGL context.
+ */
+void Application::setHeadless(bool flag) {
+    CUAssertLog(_state == State::NONE, "Cannot reset application display after initialization");
+    _headless = flag;
+}
+
 
 #pragma mark -
 #pragma mark Runtime Attributes
@@ -631,6 +683,46 @@ void Application::setFPS(float fps) {
     _delay = (int)(1000.0f/_fps);
 }
 
+/**
+ * Sets whether this application uses a fixed timestep for simulation.
+ *
+ * A deterministic application does not call {@link #update}.  Instead,
+ * each frame calls {@link #preUpdate}, then {@link #fixedUpdate} once
+ * for each fixed timestep that has elapsed, and then {@link #postUpdate}.
+ * Hence the simulation advances at the same rate no matter the frame
+ * rate, and the frame rate can match the display refresh rate.
+ *
+ * This method may be safely changed at any time while the application
+ * is running.
+ *
+ * By default, this value is false.
+ *
+ * @param value Whether this application uses a fixed timestep
+ */
+void Application::setDeterministic(bool value) {
+    _fixed = value;
+    _fixedRemainder = 0;
+}
+
+/**
+ * Sets the length of the fixed timestep in microseconds.
+ *
+ * The fixed timestep is independent of the frame rate.  If the frame
+ * rate is higher, some frames will have no call to {@link #fixedUpdate}.
+ * If it is lower, some frames will have several.
+ *
+ * This method may be safely changed at any time while the application
+ * is running.
+ *
+ * By default, this value is 16667 (60 timesteps per second).
+ *
+ * @param step  The length of the fixed timestep in microseconds
+ */
+void Application::setFixedStep(Uint64 step) {
+    _fixedStep = (step == 0 ? 1 : step);
+    _fixedRemainder = std::min(_fixedRemainder, _fixedStep-1);
+}
+
 /**
  * Returns the average frames per second over the last 10 frames.
  *
@@ -654,6 +746,9 @@ float Application::getAverageFPS() const {
  * @return the OpenGL description for this application
  */
 const std::string Application::getOpenGLDescription() const {
+    if (_headless) {
+        return "Headless";
+    }
     const char* glinfo = (const char*)glGetString(GL_VERSION);
     return std::string(glinfo);
 }
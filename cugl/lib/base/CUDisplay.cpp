@@ -39,6 +39,7 @@
 #include <cugl/util/CUDebug.h>
 #include "platform/CUDisplay-impl.h"
 #include <SDL/SDL_ttf.h>
+#include <cugl/render/CURenderRecorder.h>
 
 using namespace cugl;
 using namespace cugl::impl;
@@ -55,6 +56,8 @@ Uint32 Display::INIT_HIGH_DPI     = 2;
 Uint32 Display::INIT_MULTISAMPLED = 4;
 /** Whether this display should be centered (on windowed screens) */
 Uint32 Display::INIT_CENTERED     = 8;
+/** Whether this display should have no window or OpenGL context */
+Uint32 Display::INIT_HEADLESS     = 16;
 
 #pragma mark Constructors
 /**
@@ -96,6 +99,11 @@ _deviceOrientation(Orientation::UNKNOWN) {}
  * @return true if initialization was successful.
  */
 bool Display::init(std::string title, Rect bounds, Uint32 flags) {
+    RenderRecorder::setHeadless(flags & INIT_HEADLESS);
+    if (flags & INIT_HEADLESS) {
+        return initHeadless(title, bounds);
+    }
+
     if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
         CULogError("Could not initialize display: %s",SDL_GetError());
         return false;
@@ -262,7 +270,9 @@ void Display::setTitle(const char* title) {
  * This method does nothing if the window was not hidden.
  */
 void Display::show() {
-    SDL_ShowWindow(_window);
+    if (_window != nullptr) {
+        SDL_ShowWindow(_window);
+    }
 }
 
 /**
@@ -271,7 +281,23 @@ void Display::show() {
  * This method does nothing if the window was not visible.
  */
 void Display::hide() {
-    SDL_HideWindow(_window);
+    if (_window != nullptr) {
+        SDL_HideWindow(_window);
+    }
+}
+
+/**
+ * Returns true if this display is headless.
+ *
+ * A headless display has no window and no OpenGL context. All rendering
+ * classes are redirected to the {@link RenderRecorder}, which counts
+ * the commands that would have been sent to OpenGL. This is intended
+ * for running render tests on machines with no graphics card.
+ *
+ * @return true if this display is headless.
+ */
+bool Display::isHeadless() const {
+    return RenderRecorder::isHeadless();
 }
 
 #pragma mark -
@@ -294,6 +320,27 @@ bool Display::isPortrait() const {
     return _bounds.size.width < _bounds.size.height;
 }
 
+/**
+ * Returns the refresh rate of this display in hertz.
+ *
+ * This is the rate of the monitor showing the window, which may be
+ * higher than 60 on recent phones and gaming monitors.  The value is
+ * 0 if the rate is unknown, such as for a headless display.
+ *
+ * @return the refresh rate of this display in hertz.
+ */
+int Display::getRefreshRate() const {
+    if (_window == nullptr) {
+        return 0;
+    }
+    int index = SDL_GetWindowDisplayIndex(_window);
+    SDL_DisplayMode mode;
+    if (index < 0 || SDL_GetCurrentDisplayMode(index, &mode) != 0) {
+        return 0;
+    }
+    return mode.refresh_rate;
+}
+
 
 /**
  * Returns the usable full screen resolution for this display in points.
@@ -321,7 +368,7 @@ bool Display::isPortrait() const {
  * @return the usable full screen resolution for this display in points.
  */
 Rect Display::getSafeBounds(bool display) {
-    if (display) {
+    if (display || _window == nullptr) {
         return _usable;
     } else {
         Rect result = impl::DisplaySafeBounds(_window);
@@ -457,6 +504,10 @@ bool Display::removeOrientationListener() {
  * on iOS).
  */
 void Display::restoreRenderTarget() {
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_FRAMEBUFFER_BINDING, _framebuffer);
+        return;
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
     glBindRenderbuffer(GL_RENDERBUFFER, _rendbuffer);
 }
@@ -470,10 +521,58 @@ void Display::restoreRenderTarget() {
  * on iOS).
  */
 void Display::queryRenderTarget() {
+    if (RenderRecorder::isHeadless()) {
+        _framebuffer = RenderRecorder::getBinding(GL_FRAMEBUFFER_BINDING);
+        _rendbuffer  = 0;
+        return;
+    }
     glGetIntegerv(GL_FRAMEBUFFER_BINDING,  &_framebuffer);
     glGetIntegerv(GL_RENDERBUFFER_BINDING, &_rendbuffer);
 }
 
+/**
+ * Initializes the display without a window or OpenGL context.
+ *
+ * The display bounds are set to the given bounds, with a pixel density
+ * of 1. The orientation is inferred from the aspect ratio of the bounds.
+ * No video subsystem is required.
+ *
+ * @param title     The window/display title
+ * @param bounds    The window/display bounds
+ *
+ * @return true if initialization was successful.
+ */
+bool Display::initHeadless(std::string title, Rect bounds) {
+    // Audio is optional on a build machine
+    if (SDL_Init(SDL_INIT_EVERYTHING & ~SDL_INIT_VIDEO) < 0) {
+        CUWarn("Could not initialize audio: %s",SDL_GetError());
+        if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) {
+            CULogError("Could not initialize display: %s",SDL_GetError());
+            return false;
+        }
+    }
+    
+    if ( TTF_Init() < 0 ) {
+        CULogError("Could not initialize TTF: %s",SDL_GetError());
+        return false;
+    }
+    
+    _title   = title;
+    _bounds  = Rect(Vec2::ZERO,bounds.size);
+    _usable  = _bounds;
+    _scale   = Vec2::ONE;
+    _notched = false;
+    
+    _initialOrientation = isLandscape() ? Orientation::LANDSCAPE : Orientation::PORTRAIT;
+    _displayOrientation = _initialOrientation;
+    _deviceOrientation  = _initialOrientation;
+    _defaultOrientation = _initialOrientation;
+    
+    RenderRecorder::setViewport(0, 0, (int)bounds.size.width, (int)bounds.size.height);
+    queryRenderTarget();
+    return true;
+}
+
 /**
  * Assign the default settings for OpenGL
  *
@@ -567,6 +666,9 @@ bool Display::initOpenGL(bool multisample) {
  * necessary
  */
 void Display::refresh() {
+    if (_window == nullptr) {
+        return;
+    }
     SDL_GL_SwapWindow(_window);
     Orientation oldDisplay = _displayOrientation;
     Orientation oldDevice  = _deviceOrientation;
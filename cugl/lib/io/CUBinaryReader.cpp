@@ -167,6 +167,36 @@ bool BinaryReader::initWithAsset(const std::string file, unsigned int capacity)
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a reader for the given file mapping.
+ *
+ * The reader reads directly from the mapping, with no intermediate buffer.
+ * It retains a reference to the mapping until it is closed.
+ *
+ * @param mapping   the file mapping
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool BinaryReader::initWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+    if (mapping == nullptr || mapping->data() == nullptr) {
+        return false;
+    } else if (mapping->size() > (size_t)INT32_MAX) {
+        CUAssertLog(false, "File '%s' is too large to read", mapping->getName().c_str());
+        return false;
+    }
+    
+    // The buffer is never written to when mapped
+    _name = mapping->getName();
+    _mapping = mapping;
+    _ssize   = (Sint64)mapping->size();
+    _scursor = _ssize;
+    _capacity = (Uint32)mapping->size();
+    _buffer  = const_cast<char*>(mapping->data());
+    _bufsize = (Uint32)mapping->size();
+    _bufoff  = 0;
+    return true;
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -177,7 +207,10 @@ bool BinaryReader::initWithAsset(const std::string file, unsigned int capacity)
  * if the stream has been closed.
  */
 void BinaryReader::reset() {
-    if (_stream) {
+    if (_mapping) {
+        _bufoff = 0;
+        return;
+    } else if (_stream) {
         close();
     }
     _stream = SDL_RWFromFile(_name.c_str(), "rb");
@@ -200,7 +233,11 @@ void BinaryReader::close() {
         _stream  = nullptr;
         _scursor = 0;
     }
-    if (_buffer) {
+    if (_mapping) {
+        _mapping = nullptr;
+        _buffer  = nullptr;
+        _bufsize = 0;
+    } else if (_buffer) {
         delete[] _buffer;
         _buffer  = nullptr;
         _bufsize = 0;
@@ -241,7 +278,7 @@ void BinaryReader::fill(unsigned int bytes) {
     
     if (_bufoff == -1 || _bufoff+bytes > _bufsize) {
         if (_bufoff < _bufsize) {
-            memcpy(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
+            memmove(_buffer, &(_buffer[_bufoff]), _bufsize-_bufoff);
             _bufsize -= _bufoff;
         } else {
             _bufsize = 0;
@@ -254,6 +291,44 @@ void BinaryReader::fill(unsigned int bytes) {
     _scursor += amt;
 }
 
+/**
+ * Returns the unread bytes as a contiguous span.
+ *
+ * If this reader uses a file mapping, the span is the remainder of the
+ * file.  Otherwise, it is the unread portion of the read buffer, which
+ * is refilled to capacity first.  The span is only valid until the next
+ * read.  This method does not advance the read head; use {@link advance}
+ * for that.
+ *
+ * The bytes are not marshalled in any way.
+ *
+ * @param length    the number of bytes in the span
+ *
+ * @return the unread bytes as a contiguous span.
+ */
+const Uint8* BinaryReader::peek(size_t& length) {
+    fill(_capacity);
+    if (_buffer == nullptr || _bufoff < 0 || (Uint32)_bufoff >= _bufsize) {
+        length = 0;
+        return nullptr;
+    }
+    length = _bufsize-_bufoff;
+    return (const Uint8*)(_buffer+_bufoff);
+}
+
+/**
+ * Advances the read head by the given number of bytes.
+ *
+ * The number of bytes must not exceed the length of the last span
+ * returned by {@link peek}.
+ *
+ * @param length    the number of bytes to advance
+ */
+void BinaryReader::advance(size_t length) {
+    CUAssertLog(_bufoff >= 0 && _bufoff+length <= _bufsize, "Attempt to advance past the span");
+    _bufoff += (Sint32)length;
+}
+
 #pragma mark -
 #pragma mark Single Element Reads
 /**
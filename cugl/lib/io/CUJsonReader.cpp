@@ -51,6 +51,41 @@
 
 using namespace cugl;
 
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Returns the length of the JSON string at the read head
+ *
+ * The JSON string is the text up to (and including) the brace matching
+ * the one at the read head.  This method only searches the current span
+ * (see {@link peek}), so it is only reliable for file mappings.  It
+ * returns 0 if there is no matching brace in the span.
+ *
+ * @return the length of the JSON string at the read head
+ */
+size_t JsonReader::match() const {
+    if (_bufoff < 0 || (Uint32)_bufoff >= _winsize) {
+        return 0;
+    }
+    
+    int depth = 0;
+    const char* start = _window+_bufoff;
+    const char* end = _window+_winsize;
+    for(const char* it = start; it != end; ++it) {
+        if (*it == '{') {
+            depth++;
+        } else if (*it == '}') {
+            depth--;
+        }
+        if (depth == 0) {
+            return it+1-start;
+        }
+    }
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Read Methods
 /**
  * Returns the next available JSON string
  *
@@ -69,7 +104,7 @@ std::string JsonReader::readJsonString() {
     skip();
     
     // Make sure first character a bracket
-    CUAssertLog(_sbuffer[_bufoff] == '{', "JSON is missing initial {");
+    CUAssertLog(_window[_bufoff] == '{', "JSON is missing initial {");
     
     int depth = 0;
     std::string data;
@@ -77,21 +112,21 @@ std::string JsonReader::readJsonString() {
     while (ready()) {
         fill();
         int pos = 0;
-        for(auto it = _sbuffer.begin()+_bufoff; it != _sbuffer.end(); ++it) {
+        for(const char* it = _window+_bufoff; it != _window+_winsize; ++it) {
             if (*it == '{') {
                 depth++;
             } else if (*it == '}') {
                 depth--;
             }
             if (depth == 0) {
-                data.append(_sbuffer.begin()+_bufoff,it+1);
+                data.append(_window+_bufoff,it+1);
                 _bufoff += pos+1;
                 return data;
             }
             pos++;
         }
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff =  (int)_sbuffer.size();
+        data.append(_window+_bufoff,_window+_winsize);
+        _bufoff =  (int)_winsize;
     }
     CUAssertLog(false, "JSON is missing closing }");
     return "";
@@ -101,7 +136,9 @@ std::string JsonReader::readJsonString() {
  * Returns a newly allocated JsonValue for the next available JSON string.
  *
  * This method uses {@link readJsonString()} to extract the next available
- * JSON string and constructs a JsonValue from that.
+ * JSON string and constructs a JsonValue from that.  If this reader uses
+ * a file mapping, the JsonValue is parsed directly from the mapping
+ * instead, and no string is constructed.
  *
  * If there is a parsing error, this  method will return nullptr.  Detailed
  * information about the parsing error will be passed to an assert.  Hence
@@ -110,6 +147,22 @@ std::string JsonReader::readJsonString() {
  * @return a newly allocated JsonValue for the next available JSON string.
  */
 std::shared_ptr<JsonValue> JsonReader::readJson() {
+    if (isMapped()) {
+        CUAssertLog(ready(), "Attempt to read a finished stream");
+        skip();
+        CUAssertLog(_window[_bufoff] == '{', "JSON is missing initial {");
+        
+        // Parse in place, as the mapping outlives the parse
+        size_t length = match();
+        if (length == 0) {
+            CUAssertLog(false, "JSON is missing closing }");
+            return nullptr;
+        }
+        const char* json = _window+_bufoff;
+        _bufoff += (Sint32)length;
+        return JsonValue::allocWithJson(json,length);
+    }
+    
     std::string data = readJsonString();
     if (!data.empty()) {
         return JsonValue::allocWithJson(data);
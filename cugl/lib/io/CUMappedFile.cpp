@@ -0,0 +1,252 @@
+//
+//  CUMappedFile.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides read-only access to the contents of a file as a
+//  single contiguous block of memory.  Whenever possible, the file is mapped
+//  into memory (with mmap or its Windows equivalent), so that the contents
+//  are paged in on demand and never copied.  If the file cannot be mapped,
+//  such as an asset packaged inside an Android APK, the contents are read
+//  through SDL_RWops in a single pass instead.
+//
+//  This allows readers and parsers to work directly on the file contents,
+//  rather than copying every byte through an intermediate buffer.  See
+//  the mapped modes of TextReader, JsonReader, and BinaryReader.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/io/CUMappedFile.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFiletools.h>
+#include <cugl/base/CUApplication.h>
+
+#if defined (__WINDOWS__)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace cugl;
+
+/** The contents of an empty file (which cannot be mapped) */
+static const char EMPTY_FILE[] = "";
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Initializes a view of the given file.
+ *
+ * If the file is a relative path, this object will look for the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to read a file in any other directory, you must provide
+ * an absolute path.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the file is initialized properly, false otherwise.
+ */
+bool MappedFile::init(const std::string file) {
+    _name = filetool::normalize_path(file);
+    return map() || read();
+}
+
+/**
+ * Initializes a view of the given asset file.
+ *
+ * This initializer assumes that the file name is a relative path. It will
+ * search the application assert directory {@see Application#getAssetDirectory()}
+ * for the file and return false if it cannot find it there.
+ *
+ * @param file  the relative path to the file
+ *
+ * @return true if the file is initialized properly, false otherwise.
+ */
+bool MappedFile::initWithAsset(const std::string file) {
+    bool absolute = filetool::is_absolute(file);
+    CUAssertLog(!absolute, "This initializer does not accept absolute paths");
+
+    _name = Application::get()->getAssetDirectory();
+    _name.append(file);
+    _name = filetool::normalize_path(_name);
+
+    // Android assets live in the APK, so only SDL can read them
+    return map() || read();
+}
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Returns true if the file could be memory mapped.
+ *
+ * This method does not print any errors, as the caller is expected to
+ * fall back to {@link read()} on failure.
+ *
+ * @return true if the file could be memory mapped.
+ */
+bool MappedFile::map() {
+#if defined (__WINDOWS__)
+    HANDLE file = CreateFileA(_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || (Uint64)size.QuadPart > (Uint64)SIZE_MAX) {
+        CloseHandle(file);
+        return false;
+    } else if (size.QuadPart == 0) {
+        CloseHandle(file);
+        _data = EMPTY_FILE;
+        _size = 0;
+        return true;
+    }
+
+    // The view keeps the mapping alive, so we can close the handles
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) {
+        return false;
+    }
+    _data = (const char*)view;
+    _size = (size_t)size.QuadPart;
+    return true;
+#else
+    int fd = open(_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(fd);
+        return false;
+    } else if (status.st_size == 0) {
+        ::close(fd);
+        _data = EMPTY_FILE;
+        _size = 0;
+        return true;
+    }
+
+    // The mapping keeps the file alive, so we can close the descriptor
+    size_t size = (size_t)status.st_size;
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    madvise(view, size, MADV_SEQUENTIAL);
+    _data = (const char*)view;
+    _size = size;
+    return true;
+#endif
+}
+
+/**
+ * Returns true if the file could be read through SDL_RWops.
+ *
+ * This method is the fallback for files that cannot be memory mapped.
+ * It reads the file in a single pass into a heap buffer of exactly
+ * the file size.
+ *
+ * @return true if the file could be read through SDL_RWops.
+ */
+bool MappedFile::read() {
+    SDL_RWops* stream = SDL_RWFromFile(_name.c_str(), "rb");
+    if (!stream) {
+        return false;
+    }
+
+    Sint64 size = SDL_RWsize(stream);
+    if (size < 0) {
+        SDL_RWclose(stream);
+        return false;
+    } else if (size == 0) {
+        SDL_RWclose(stream);
+        _data = EMPTY_FILE;
+        _size = 0;
+        return true;
+    }
+
+    _buffer = new char[(size_t)size];
+    size_t total = 0;
+    while (total < (size_t)size) {
+        size_t amt = SDL_RWread(stream, _buffer+total, 1, (size_t)size-total);
+        if (amt == 0) {
+            break;
+        }
+        total += amt;
+    }
+    SDL_RWclose(stream);
+
+    if (total < (size_t)size) {
+        delete[] _buffer;
+        _buffer = nullptr;
+        return false;
+    }
+    _data = _buffer;
+    _size = total;
+    return true;
+}
+
+#pragma mark -
+#pragma mark Accessors
+/**
+ * Releases the file contents.
+ *
+ * Any pointers previously returned by {@link data()} are invalid after
+ * this method is called.  Calling this method on a previously closed
+ * file has no effect.
+ */
+void MappedFile::close() {
+    if (_buffer) {
+        delete[] _buffer;
+        _buffer = nullptr;
+    } else if (_data && _size > 0) {
+#if defined (__WINDOWS__)
+        UnmapViewOfFile(_data);
+#else
+        munmap((void*)_data, _size);
+#endif
+    }
+    _data = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,288 @@
+//
+//  CUSaveWriter.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an asynchronous writer for save files.  The contents
+//  of the file are captured on the calling thread, and are written on a
+//  background thread.  Each write goes to a temporary file that is synced to
+//  storage and then renamed over the original, so the save file is never
+//  left half-written.  If the file is saved several times before the worker
+//  gets to it, only the most recent contents are written.
+//
+//  This is the writer to use for any state saved when the application is
+//  suspended.  Mobile platforms give the application very little time to
+//  suspend, and a slow write on the main thread can get it killed.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/io/CUSaveWriter.h>
+#include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUDebug.h>
+#include <chrono>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+#if defined (__WINDOWS__)
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+#endif
+
+using namespace cugl;
+
+/** The suffix of the temporary file written before the rename */
+#define TEMP_SUFFIX ".tmp"
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this writer.
+ *
+ * This method blocks until any pending save is written. A disposed
+ * writer can be safely reinitialized.
+ */
+void SaveWriter::dispose() {
+    if (_worker == nullptr) {
+        return;
+    }
+    flush();
+    // The thread pool destructor joins the worker
+    _worker = nullptr;
+    _contents.clear();
+    _dirty = false;
+    _name = "";
+}
+
+/**
+ * Initializes a writer for the given file.
+ *
+ * This method does not open or create the file.  The file is not
+ * touched until the first save.
+ *
+ * If the file is a relative path, this writer will place the file in
+ * the application save directory {@see Application#getSaveDirectory()}.
+ * If you wish to write a file in any other directory, you must provide
+ * an absolute path. Be warned, however, that write priviledges are
+ * heavily restricted on mobile platforms.
+ *
+ * @param file  the path (absolute or relative) to the file
+ *
+ * @return true if the writer is initialized properly, false otherwise.
+ */
+bool SaveWriter::init(const std::string file) {
+    if (_worker != nullptr) {
+        CUAssertLog(false, "SaveWriter is already initialized");
+        return false;
+    }
+    _name = filetool::normalize_path(file);
+    _worker = ThreadPool::alloc(1);
+    return _worker != nullptr;
+}
+
+
+#pragma mark -
+#pragma mark Save Methods
+/**
+ * Saves the given JSON value to the file.
+ *
+ * The JSON value is converted to a string immediately, so it is safe to
+ * modify it as soon as this method returns.  The string is written on
+ * the background thread, replacing any earlier save not yet written.
+ *
+ * The JSON may either be pretty-printed or condensed depending on the
+ * value of format.  By default, we pretty-print all JSON strings.
+ *
+ * @param json      The JSON value to save
+ * @param format    Whether to pretty-print the JSON string
+ */
+void SaveWriter::save(const std::shared_ptr<JsonValue>& json, bool format) {
+    CUAssertLog(json, "Attempt to save a nullptr JSON");
+    // Match the trailing newline of JsonWriter
+    save(json->toString(format)+"\n");
+}
+
+/**
+ * Saves the given string to the file.
+ *
+ * The string is written on the background thread, replacing any earlier
+ * save not yet written.  The file will contain exactly this string.
+ *
+ * @param contents  The file contents
+ */
+void SaveWriter::save(const std::string& contents) {
+    CUAssertLog(_worker, "Attempt to save with an uninitialized writer");
+    std::lock_guard<std::mutex> lock(_mutex);
+    _contents = contents;
+    _dirty = true;
+    if (!_busy) {
+        // The worker picks up whatever is newest when it gets here
+        _busy = true;
+        _worker->addTask([this](void) { this->drain(); });
+    }
+}
+
+/**
+ * Returns true if there is a save not yet written to the file.
+ *
+ * @return true if there is a save not yet written to the file.
+ */
+bool SaveWriter::isPending() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _busy;
+}
+
+/**
+ * Blocks until every save has been written to the file.
+ *
+ * This method has no time limit.  Use {@link #flush(Uint32)} when there
+ * is a platform deadline, such as when the application is suspended.
+ */
+void SaveWriter::flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return !_busy; });
+}
+
+/**
+ * Returns true if every save has been written to the file.
+ *
+ * This method blocks until the pending save is written, or until the
+ * given number of milliseconds has passed.  If it times out, the save
+ * continues on the background thread.
+ *
+ * @param millis    The maximum time to wait in milliseconds
+ *
+ * @return true if every save has been written to the file.
+ */
+bool SaveWriter::flush(Uint32 millis) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _idle.wait_for(lock, std::chrono::milliseconds(millis), [this] { return !_busy; });
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Writes the pending contents until there are none left.
+ *
+ * This method is executed on the worker thread.
+ */
+void SaveWriter::drain() {
+    std::string contents;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_dirty) {
+                _busy = false;
+                _idle.notify_all();
+                return;
+            }
+            contents.swap(_contents);
+            _contents.clear();
+            _dirty = false;
+        }
+        if (!commit(contents)) {
+            CULogError("Could not save '%s'", _name.c_str());
+        }
+    }
+}
+
+/**
+ * Returns true if the contents were atomically written to the file.
+ *
+ * This method writes the contents to a temporary file, syncs it to
+ * storage, and renames it over the save file.  On POSIX platforms, it
+ * then syncs the parent directory, as the rename is not durable until
+ * the directory entry is on storage.  It is executed on the worker thread.
+ *
+ * @param contents  The file contents
+ *
+ * @return true if the contents were atomically written to the file.
+ */
+bool SaveWriter::commit(const std::string& contents) {
+    std::string temp = _name+TEMP_SUFFIX;
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (file == nullptr) {
+        CULogError("%s", strerror(errno));
+        return false;
+    }
+
+    bool success = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    success = success && fflush(file) == 0;
+#if defined (__WINDOWS__)
+    success = success && _commit(_fileno(file)) == 0;
+#else
+    success = success && fsync(fileno(file)) == 0;
+#endif
+    success = (fclose(file) == 0) && success;
+    if (!success) {
+        CULogError("%s", strerror(errno));
+        std::remove(temp.c_str());
+        return false;
+    }
+
+    // The rename is the commit point; the old file is intact until then
+#if defined (__WINDOWS__)
+    success = MoveFileExA(temp.c_str(), _name.c_str(),
+                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    success = std::rename(temp.c_str(), _name.c_str()) == 0;
+#endif
+    if (!success) {
+        CULogError("Could not replace '%s'", _name.c_str());
+        std::remove(temp.c_str());
+        return false;
+    }
+
+#if !defined (__WINDOWS__)
+    // A crash can still lose the rename unless the directory is synced
+    std::string parent = filetool::dir_name(_name);
+    if (parent.empty()) {
+        parent = (!_name.empty() && _name[0] == '/') ? "/" : ".";
+    }
+    int dir = open(parent.c_str(), O_RDONLY);
+    success = dir >= 0 && fsync(dir) == 0;
+    if (!success) {
+        CULogError("%s", strerror(errno));
+    }
+    if (dir >= 0) {
+        close(dir);
+    }
+#endif
+    return success;
+}
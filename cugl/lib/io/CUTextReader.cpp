@@ -164,6 +164,36 @@ bool TextReader::initWithAsset(const std::string file, unsigned int capacity) {
     return _ssize >= 0;
 }
 
+/**
+ * Initializes a reader for the given file mapping.
+ *
+ * The reader reads directly from the mapping, with no intermediate buffer.
+ * It retains a reference to the mapping until it is closed.  Unlike the
+ * stream initializers, the file contents are read as-is.  In particular,
+ * Windows-style line feeds are not converted on any platform.
+ *
+ * @param mapping   the file mapping
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool TextReader::initWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+    if (mapping == nullptr || mapping->data() == nullptr) {
+        return false;
+    } else if (mapping->size() > (size_t)INT32_MAX) {
+        CUAssertLog(false, "File '%s' is too large to read", mapping->getName().c_str());
+        return false;
+    }
+    
+    _name = mapping->getName();
+    _mapping = mapping;
+    _ssize   = (Sint64)mapping->size();
+    _scursor = _ssize;
+    _window  = mapping->data();
+    _winsize = (Uint32)mapping->size();
+    _bufoff  = 0;
+    return true;
+}
+
 
 #pragma mark -
 #pragma mark Stream Management
@@ -174,13 +204,18 @@ bool TextReader::initWithAsset(const std::string file, unsigned int capacity) {
  * if the stream has been closed.
  */
 void TextReader::reset() {
-    if (_stream) {
+    if (_mapping) {
+        _bufoff = 0;
+        return;
+    } else if (_stream) {
         close();
     }
     _stream = SDL_RWFromFile(_name.c_str(), "r");
     _ssize  = SDL_RWsize(_stream);
     _cbuffer = new char[_capacity];
     _sbuffer.clear();
+    _window  = _sbuffer.data();
+    _winsize = 0;
     _bufoff  = -1;
     _scursor = 0;
 }
@@ -201,6 +236,11 @@ void TextReader::close() {
         delete[] _cbuffer;
         _cbuffer = nullptr;
     }
+    if (_mapping) {
+        _mapping = nullptr;
+        _window  = nullptr;
+        _winsize = 0;
+    }
 }
 
 /**
@@ -220,6 +260,8 @@ void TextReader::fill() {
     size_t amt = SDL_RWread(_stream, _cbuffer, 1, _capacity-_sbuffer.size());
     _sbuffer.append(_cbuffer,amt);
     _scursor += amt;
+    _window  = _sbuffer.data();
+    _winsize = (Uint32)_sbuffer.size();
 }
 
 #pragma mark -
@@ -254,11 +296,11 @@ char TextReader::read() {
  */
 std::string& TextReader::read(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((Uint32)_bufoff >= _winsize) {
         fill();
     }
 
-    data.push_back(_sbuffer[_bufoff++]);
+    data.push_back(_window[_bufoff++]);
     return data;
 }
 
@@ -291,17 +333,16 @@ std::string TextReader::readUTF8() {
  */
 std::string& TextReader::readUTF8(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff+3 >= _sbuffer.size()) { // Need a full UTF8 sequence
+    if ((Uint32)_bufoff+3 >= _winsize) { // Need a full UTF8 sequence
         fill();
     }
     
-    size_t orig = data.size();
-    
-    std::string::iterator start = _sbuffer.begin()+_bufoff;
-    utf8::next(start,_sbuffer.end());
+    const char* start = _window+_bufoff;
+    const char* end = start;
+    utf8::next(end,_window+_winsize);
     
-    data.append(_sbuffer.begin()+_bufoff,start);
-    _bufoff += (Sint32)(data.size()-orig);
+    data.append(start,end);
+    _bufoff += (Sint32)(end-start);
     
     return data;
 }
@@ -340,20 +381,22 @@ std::string TextReader::readLine() {
  */
 std::string& TextReader::readLine(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((Uint32)_bufoff >= _winsize) {
         fill();
     }
     
     bool found = false;
     while (!found) {
-        size_t pos = _sbuffer.find('\n',_bufoff);
-        if (pos != std::string::npos) {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.begin()+pos);
-            _bufoff = (Sint32)(pos+1);
+        const char* start = _window+_bufoff;
+        const char* pos = (const char*)memchr(start,'\n',_winsize-_bufoff);
+        if (pos != nullptr) {
+            data.append(start,pos);
+            _bufoff = (Sint32)(pos+1-_window);
             found = true;
         } else {
-            data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-            _bufoff = (Sint32)_sbuffer.size();
+            data.append(start,_window+_winsize);
+            _bufoff = (Sint32)_winsize;
+            found = !ready();
             fill();
         }
     }
@@ -388,13 +431,13 @@ std::string TextReader::readAll() {
  */
 std::string& TextReader::readAll(std::string& data) {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((Uint32)_bufoff >= _winsize) {
         fill();
     }
     
     while (ready()) {
-        data.append(_sbuffer.begin()+_bufoff,_sbuffer.end());
-        _bufoff = (Sint32)_sbuffer.size();
+        data.append(_window+_bufoff,_window+_winsize);
+        _bufoff = (Sint32)_winsize;
         fill();
     }
     return data;
@@ -408,14 +451,14 @@ std::string& TextReader::readAll(std::string& data) {
  */
 void TextReader::skip() {
     CUAssertLog(ready(), "Attempt to read a finished stream");
-    if (_bufoff >= _sbuffer.size()) {
+    if ((Uint32)_bufoff >= _winsize) {
         fill();
     }
     
     bool found = false;
-    while (isspace(_sbuffer[_bufoff]) && !found) {
+    while (!found && isspace(_window[_bufoff])) {
         _bufoff++;
-        if (_bufoff >= _sbuffer.size()) {
+        if ((Uint32)_bufoff >= _winsize) {
             if (ready()) {
                 fill();
             } else {
@@ -425,3 +468,40 @@ void TextReader::skip() {
     }
 }
 
+/**
+ * Returns the unread characters as a contiguous span.
+ *
+ * If this reader uses a file mapping, the span is the remainder of the
+ * file.  Otherwise, it is the unread portion of the read buffer, which
+ * is refilled first if it is empty.  The span is not null-terminated and
+ * is only valid until the next read.  This method does not advance the
+ * read head; use {@link advance} for that.
+ *
+ * @param length    the number of characters in the span
+ *
+ * @return the unread characters as a contiguous span.
+ */
+const char* TextReader::peek(size_t& length) {
+    if (_bufoff < 0 || (Uint32)_bufoff >= _winsize) {
+        fill();
+    }
+    if (_window == nullptr || _bufoff < 0 || (Uint32)_bufoff >= _winsize) {
+        length = 0;
+        return nullptr;
+    }
+    length = _winsize-_bufoff;
+    return _window+_bufoff;
+}
+
+/**
+ * Advances the read head by the given number of characters.
+ *
+ * The number of characters must not exceed the length of the last span
+ * returned by {@link peek}.
+ *
+ * @param length    the number of characters to advance
+ */
+void TextReader::advance(size_t length) {
+    CUAssertLog(_bufoff >= 0 && _bufoff+length <= _winsize, "Attempt to advance past the span");
+    _bufoff += (Sint32)length;
+}
@@ -962,6 +962,71 @@ float* Affine2::transform(const Affine2& aff, float const* input, float* output,
     return output;
 }
 
+/**
+ * Transforms the point array, and stores the result in output.
+ *
+ * The stride is the distance in bytes between consecutive points, and it
+ * is shared by both arrays. This allows the method to transform the
+ * positions of an interleaved vertex array (such as {@link SpriteVertex3})
+ * in place. The default stride is a tightly packed array of {@link Vec2}.
+ * The input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * This method is vectorized when SSE or NEON support is available, and
+ * is much faster than transforming each point individually.
+ *
+ * @param aff       The transform matrix.
+ * @param input     The array of points to transform.
+ * @param output    The array to store the transformed points.
+ * @param size      The number of points to transform.
+ * @param stride    The distance in bytes between consecutive points.
+ *
+ * @return A reference to output for chaining
+ */
+Vec2* Affine2::transform(const Affine2& aff, Vec2 const* input, Vec2* output, size_t size, size_t stride) {
+    CUAssertLog(output, "Destination vector is null");
+    const Uint8* src = reinterpret_cast<const Uint8*>(input);
+    Uint8* dst = reinterpret_cast<Uint8*>(output);
+    size_t ii = 0;
+#if defined CU_MATH_VECTOR_SSE
+    // Two points per register: (x0,y0,x1,y1)
+    __m128 c0 = _mm_setr_ps(aff.m[0],aff.m[1],aff.m[0],aff.m[1]);
+    __m128 c1 = _mm_setr_ps(aff.m[2],aff.m[3],aff.m[2],aff.m[3]);
+    __m128 c2 = _mm_setr_ps(aff.m[4],aff.m[5],aff.m[4],aff.m[5]);
+    for(; ii+1 < size; ii += 2) {
+        const float* in0 = reinterpret_cast<const float*>(src+ii*stride);
+        const float* in1 = reinterpret_cast<const float*>(src+(ii+1)*stride);
+        __m128 unit = _mm_loadl_pi(_mm_setzero_ps(),(const __m64*)in0);
+        unit = _mm_loadh_pi(unit,(const __m64*)in1);
+        __m128 xx = _mm_shuffle_ps(unit,unit,_MM_SHUFFLE(2,2,0,0));
+        __m128 yy = _mm_shuffle_ps(unit,unit,_MM_SHUFFLE(3,3,1,1));
+        unit = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx,c0),_mm_mul_ps(yy,c1)),c2);
+        _mm_storel_pi((__m64*)(dst+ii*stride),unit);
+        _mm_storeh_pi((__m64*)(dst+(ii+1)*stride),unit);
+    }
+#elif defined CU_MATH_VECTOR_NEON64
+    float32x2_t c0 = vld1_f32(aff.m);
+    float32x2_t c1 = vld1_f32(aff.m+2);
+    float32x2_t c2 = vld1_f32(aff.m+4);
+    for(; ii < size; ii++) {
+        float32x2_t unit = vld1_f32(reinterpret_cast<const float*>(src+ii*stride));
+        float32x2_t result = vmla_lane_f32(c2,c0,unit,0);
+        result = vmla_lane_f32(result,c1,unit,1);
+        vst1_f32(reinterpret_cast<float*>(dst+ii*stride),result);
+    }
+#endif
+    // Scalar fallback (and SSE remainder)
+    for(; ii < size; ii++) {
+        const float* in = reinterpret_cast<const float*>(src+ii*stride);
+        float* out = reinterpret_cast<float*>(dst+ii*stride);
+        float x = aff.m[0]*in[0]+aff.m[2]*in[1]+aff.m[4];
+        float y = aff.m[1]*in[0]+aff.m[3]*in[1]+aff.m[5];
+        out[0] = x;
+        out[1] = y;
+    }
+    return output;
+}
+
 /**
  * Transforms the rectangle and stores the result in dst.
  *
@@ -2751,6 +2751,72 @@ float* Mat4::transform(const float* mat, float const* input, float* output, size
     return output;
 }
 
+/**
+ * Transforms the point array by the given matrix, and stores the result in output.
+ *
+ * Each element is treated as a point, which means that translation is
+ * applied to the result (as with {@link #transform(const Mat4&, const Vec3, Vec3*)}).
+ * The homogenous component is not divided out.
+ *
+ * The stride is the distance in bytes between consecutive points, and it
+ * is shared by both arrays. This allows the method to transform the
+ * positions of an interleaved vertex array (such as {@link SpriteVertex3})
+ * in place. The default stride is a tightly packed array of {@link Vec3}.
+ * The input and output may be the same array, but they may not otherwise
+ * overlap.
+ *
+ * This method is vectorized when SSE or NEON support is available, and
+ * is much faster than transforming each point individually.
+ *
+ * @param mat       The transform matrix.
+ * @param input     The array of points to transform.
+ * @param output    The array to store the transformed points.
+ * @param size      The number of points to transform.
+ * @param stride    The distance in bytes between consecutive points.
+ *
+ * @return A reference to output for chaining
+ */
+Vec3* Mat4::transform(const Mat4& mat, Vec3 const* input, Vec3* output, size_t size, size_t stride) {
+    CUAssertLog(output, "Destination vector is null");
+    const Uint8* src = reinterpret_cast<const Uint8*>(input);
+    Uint8* dst = reinterpret_cast<Uint8*>(output);
+#if defined CU_MATH_VECTOR_SSE
+    for(size_t ii = 0; ii < size; ii++) {
+        const float* in = reinterpret_cast<const float*>(src+ii*stride);
+        float* out = reinterpret_cast<float*>(dst+ii*stride);
+        __m128 unit = _mm_add_ps(_mm_mul_ps(mat.col[0],_mm_set1_ps(in[0])),mat.col[3]);
+        unit = _mm_add_ps(_mm_mul_ps(mat.col[1],_mm_set1_ps(in[1])),unit);
+        unit = _mm_add_ps(_mm_mul_ps(mat.col[2],_mm_set1_ps(in[2])),unit);
+        _mm_storel_pi((__m64*)out,unit);
+        _mm_store_ss(out+2,_mm_movehl_ps(unit,unit));
+    }
+#elif defined CU_MATH_VECTOR_NEON64
+    for(size_t ii = 0; ii < size; ii++) {
+        const float* in = reinterpret_cast<const float*>(src+ii*stride);
+        float* out = reinterpret_cast<float*>(dst+ii*stride);
+        float32x4_t unit = vmlaq_n_f32(mat.col[3],mat.col[0],in[0]);
+        unit = vmlaq_n_f32(unit,mat.col[1],in[1]);
+        unit = vmlaq_n_f32(unit,mat.col[2],in[2]);
+        vst1_f32(out,vget_low_f32(unit));
+        vst1q_lane_f32(out+2,unit,2);
+    }
+#else
+    for(size_t ii = 0; ii < size; ii++) {
+        const float* in = reinterpret_cast<const float*>(src+ii*stride);
+        float* out = reinterpret_cast<float*>(dst+ii*stride);
+        // Handle case where input == output.
+        float x = in[0] * mat.m[0] + in[1] * mat.m[4] + in[2] * mat.m[8]  + mat.m[12];
+        float y = in[0] * mat.m[1] + in[1] * mat.m[5] + in[2] * mat.m[9]  + mat.m[13];
+        float z = in[0] * mat.m[2] + in[1] * mat.m[6] + in[2] * mat.m[10] + mat.m[14];
+        
+        out[0] = x;
+        out[1] = y;
+        out[2] = z;
+    }
+#endif
+    return output;
+}
+
 #pragma mark -
 #pragma mark Conversion Methods
 
@@ -0,0 +1,563 @@
+//
+//  CUConvolver.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This class is represents a uniformly partitioned FFT convolution. It
+//  computes the same result as a FIR filter, but it is designed for very
+//  long impulse responses (reverbs, room tones, long EQ curves).  A direct
+//  form FIR filter costs O(taps) per sample.  This class only computes the
+//  first partition of the impulse response directly.  The remaining taps
+//  are applied as products in the frequency domain, so the cost per sample
+//  grows much more slowly than the number of taps.
+//
+//  The first partition also hides the latency of the block FFT.  Hence the
+//  output is not delayed, and this class can be used as a drop-in
+//  replacement for the direct form. Indeed, FIRFilter switches to this
+//  class automatically for long filters.
+//
+//  This class supports vector optimizations for SSE and Neon 64 in the
+//  frequency domain multiplication, which is the bulk of the work.
+//
+//  This class is NOT THREAD SAFE.  This is by design, for performance reasons.
+//  External locking may be required when the filter is shared between multiple
+//  threads (such as between an audio thread and the main thread).
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/math/dsp/CUConvolver.h>
+#include <cugl/math/dsp/CUDSPMath.h>
+#include <cugl/util/CUDebug.h>
+#include "cuDSP128.inl"
+#include <cmath>
+#include <cstring>
+
+using namespace cugl;
+using namespace cugl::dsp;
+
+/** The smallest partition size */
+#define MIN_BLOCK   16
+/** The largest partition size chosen by default */
+#define MAX_BLOCK   1024
+/** The largest first partition applied in direct form */
+#define MAX_DIRECT  64
+
+/** Whether to use a vectorization algorithm */
+bool Convolver::VECTORIZE = true;
+
+#pragma mark Constructors
+/**
+ * Creates a pass-through convolution for a single channel.
+ */
+Convolver::Convolver() :
+_channels(1),
+_block(0),
+_parts(0),
+_stride(0),
+_cursor(0),
+_slot(0) {
+    setImpulse(std::vector<float>(1,1.0f));
+}
+
+/**
+ * Creates a pass-through convolution for the given number of channels.
+ *
+ * @param channels  The number of channels
+ */
+Convolver::Convolver(unsigned channels) :
+_channels(channels),
+_block(0),
+_parts(0),
+_stride(0),
+_cursor(0),
+_slot(0) {
+    setImpulse(std::vector<float>(1,1.0f));
+}
+
+/**
+ * Creates a convolution with the given impulse response.
+ *
+ * If the block size is 0, it is chosen from the length of the impulse
+ * with {@link getDefaultBlock}.  Otherwise it is rounded up to a power
+ * of two.
+ *
+ * @param channels  The number of channels
+ * @param impulse   The impulse response
+ * @param block     The partition size
+ */
+Convolver::Convolver(unsigned channels, const std::vector<float>& impulse, size_t block) :
+_channels(channels),
+_block(0),
+_parts(0),
+_stride(0),
+_cursor(0),
+_slot(0) {
+    setImpulse(impulse,block);
+}
+
+/**
+ * Creates a copy of the given filter.
+ *
+ * The copy has the same impulse response, but its data buffers are
+ * cleared.
+ *
+ * @param copy  The filter to copy
+ */
+Convolver::Convolver(const Convolver& copy) :
+_channels(copy._channels),
+_block(0),
+_parts(0),
+_stride(0),
+_cursor(0),
+_slot(0) {
+    setImpulse(copy._impulse,copy._block);
+}
+
+/**
+ * Returns the default block size for an impulse response of the given length.
+ *
+ * This value balances the direct and spectral halves of the work.
+ *
+ * @param length    The number of taps in the impulse response
+ *
+ * @return the default block size for an impulse response of the given length.
+ */
+size_t Convolver::getDefaultBlock(size_t length) {
+    size_t target = (size_t)std::ceil(4*std::sqrt((double)length));
+    size_t block = MIN_BLOCK;
+    while (block < target && block < MAX_BLOCK) {
+        block <<= 1;
+    }
+    return block;
+}
+
+/**
+ * Resets the caching data structures for this filter
+ *
+ * This must be called if the number of channels or the impulse change.
+ */
+void Convolver::reset() {
+    _inputs.reset(_channels*2*_block,16);
+    _history.reset(_channels*_parts*2*_stride,16);
+    _tails.reset(_channels*_block,16);
+    clear();
+}
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Sets the number of channels for this filter
+ *
+ * The data buffers depend on the number of channels.  Changing this value
+ * will reset the data buffers to 0.
+ *
+ * @param channels  The number of channels for this filter
+ */
+void Convolver::setChannels(unsigned channels) {
+    CUAssertLog(channels > 0, "Channels %d must be non-zero.",channels);
+    _channels = channels;
+    if (_child != nullptr) {
+        _child->setChannels(channels);
+    }
+    reset();
+}
+
+/**
+ * Sets the impulse response of this filter.
+ *
+ * If the block size is 0, it is chosen from the length of the impulse
+ * with {@link getDefaultBlock}.  Otherwise it is rounded up to a power
+ * of two.  This method resets the data buffers to 0.
+ *
+ * @param impulse   The impulse response
+ * @param block     The partition size
+ */
+void Convolver::setImpulse(const std::vector<float>& impulse, size_t block) {
+    _impulse = impulse;
+    size_t length = impulse.size();
+    if (block == 0) {
+        block = getDefaultBlock(length);
+    }
+    _block = 4;
+    while (_block < block) {
+        _block <<= 1;
+    }
+    _parts  = length > _block ? (length-1)/_block : 0;
+    _stride = (_block+4) & ~((size_t)3);
+
+    // The first partition is applied directly if it is short enough
+    size_t first = std::min(length,_block);
+    if (_block > MAX_DIRECT) {
+        std::vector<float> head(impulse.begin(),impulse.begin()+first);
+        _child = std::unique_ptr<Convolver>(new Convolver(_channels,head,_block/4));
+        _head.reset(0,16);
+    } else {
+        _child = nullptr;
+        _head.reset(_block,16);
+        _head.clear();
+        for(size_t ii = 0; ii < first; ii++) {
+            _head[_block-ii-1] = impulse[ii];
+        }
+    }
+
+    // Transform tables
+    _cosines.reset(_block/2,16);
+    _sines.reset(_block/2,16);
+    for(size_t ii = 0; ii < _block/2; ii++) {
+        _cosines[ii] = (float)std::cos(2*M_PI*ii/_block);
+        _sines[ii]   = (float)std::sin(2*M_PI*ii/_block);
+    }
+    _rcosines.reset(_block+1,16);
+    _rsines.reset(_block+1,16);
+    for(size_t ii = 0; ii <= _block; ii++) {
+        _rcosines[ii] = (float)std::cos(M_PI*ii/_block);
+        _rsines[ii]   = (float)std::sin(M_PI*ii/_block);
+    }
+    _reverse.resize(_block);
+    size_t bits = 0;
+    while (((size_t)1 << bits) < _block) {
+        bits++;
+    }
+    for(size_t ii = 0; ii < _block; ii++) {
+        Uint32 rev = 0;
+        for(size_t jj = 0; jj < bits; jj++) {
+            rev |= ((ii >> jj) & 1) << (bits-jj-1);
+        }
+        _reverse[ii] = rev;
+    }
+    _scratch.reset(6*_block+2*_stride,16);
+
+    // The remaining partitions are applied in the frequency domain
+    _spectra.reset(_parts*2*_stride,16);
+    _spectra.clear();
+    float* time = _scratch+4*_block+2*_stride;
+    float scale = 1.0f/_block;
+    for(size_t pp = 0; pp < _parts; pp++) {
+        std::memset(time,0,2*_block*sizeof(float));
+        size_t start = (pp+1)*_block;
+        size_t end = std::min(start+_block,length);
+        for(size_t ii = start; ii < end; ii++) {
+            time[ii-start] = impulse[ii]*scale;
+        }
+        float* spectrum = _spectra+pp*2*_stride;
+        forward(time,spectrum,spectrum+_stride);
+    }
+    reset();
+}
+
+#pragma mark -
+#pragma mark Transforms
+/**
+ * Performs an in-place complex FFT of size B on split arrays.
+ *
+ * This is the forward transform.  The inverse transform (without the
+ * 1/B scale) is obtained by swapping the real and imaginary arrays.
+ *
+ * @param real  The real components
+ * @param imag  The imaginary components
+ */
+void Convolver::transform(float* real, float* imag) const {
+    size_t size = _block;
+    for(size_t ii = 0; ii < size; ii++) {
+        size_t jj = _reverse[ii];
+        if (jj > ii) {
+            std::swap(real[ii],real[jj]);
+            std::swap(imag[ii],imag[jj]);
+        }
+    }
+
+    for(size_t span = 2; span <= size; span <<= 1) {
+        size_t half = span >> 1;
+        size_t step = size/span;
+        for(size_t start = 0; start < size; start += span) {
+            for(size_t kk = 0; kk < half; kk++) {
+                float wr =  _cosines[kk*step];
+                float wi = -_sines[kk*step];
+                size_t a = start+kk;
+                size_t b = a+half;
+                float tr = wr*real[b]-wi*imag[b];
+                float ti = wr*imag[b]+wi*real[b];
+                real[b] = real[a]-tr;
+                imag[b] = imag[a]-ti;
+                real[a] += tr;
+                imag[a] += ti;
+            }
+        }
+    }
+}
+
+/**
+ * Computes the spectrum of 2B real samples.
+ *
+ * The spectrum has B+1 bins, as the rest are determined by symmetry.
+ *
+ * @param input     The 2B real samples
+ * @param real      The real components of the spectrum
+ * @param imag      The imaginary components of the spectrum
+ */
+void Convolver::forward(const float* input, float* real, float* imag) {
+    size_t size = _block;
+    float* zr = _scratch;
+    float* zi = zr+size;
+    for(size_t ii = 0; ii < size; ii++) {
+        zr[ii] = input[2*ii  ];
+        zi[ii] = input[2*ii+1];
+    }
+    transform(zr,zi);
+
+    // Split the even and odd samples back apart
+    for(size_t kk = 0; kk <= size; kk++) {
+        size_t ka = kk % size;
+        size_t kb = (size-kk) % size;
+        float evr = 0.5f*(zr[ka]+zr[kb]);
+        float evi = 0.5f*(zi[ka]-zi[kb]);
+        float odr = 0.5f*(zi[ka]+zi[kb]);
+        float odi = 0.5f*(zr[kb]-zr[ka]);
+        float c = _rcosines[kk];
+        float s = _rsines[kk];
+        real[kk] = evr+c*odr+s*odi;
+        imag[kk] = evi+c*odi-s*odr;
+    }
+}
+
+/**
+ * Computes the 2B real samples for the given spectrum.
+ *
+ * The spectrum has B+1 bins. The result is not scaled by 1/B, as that
+ * factor is applied to the partition spectra instead.
+ *
+ * @param real      The real components of the spectrum
+ * @param imag      The imaginary components of the spectrum
+ * @param output    The array to store the 2B real samples
+ */
+void Convolver::inverse(const float* real, const float* imag, float* output) {
+    size_t size = _block;
+    float* zr = _scratch;
+    float* zi = zr+size;
+
+    // Recombine the even and odd spectra
+    for(size_t kk = 0; kk < size; kk++) {
+        float ar = real[kk];
+        float ai = imag[kk];
+        float br = real[size-kk];
+        float bi = -imag[size-kk];
+        float dr = 0.5f*(ar-br);
+        float di = 0.5f*(ai-bi);
+        float c = _rcosines[kk];
+        float s = _rsines[kk];
+        float odr = dr*c-di*s;
+        float odi = dr*s+di*c;
+        zr[kk] = 0.5f*(ar+br)-odi;
+        zi[kk] = 0.5f*(ai+bi)+odr;
+    }
+
+    transform(zi,zr);
+    for(size_t ii = 0; ii < size; ii++) {
+        output[2*ii  ] = zr[ii];
+        output[2*ii+1] = zi[ii];
+    }
+}
+
+/**
+ * Processes a completed block of input for the given channel.
+ *
+ * This method computes the output of the remaining partitions for the
+ * next B frames.
+ *
+ * @param channel   The channel to process
+ */
+void Convolver::process(unsigned channel) {
+    size_t size = _block;
+    float* input = _inputs+channel*2*size;
+    if (_parts) {
+        float* history = _history+channel*_parts*2*_stride;
+        float* spectrum = history+_slot*2*_stride;
+        forward(input,spectrum,spectrum+_stride);
+
+        float* accr = _scratch+2*size;
+        float* acci = accr+_stride;
+        std::memset(accr,0,2*_stride*sizeof(float));
+        for(size_t pp = 0; pp < _parts; pp++) {
+            const float* xr = history+((_slot+_parts-pp) % _parts)*2*_stride;
+            const float* xi = xr+_stride;
+            const float* hr = _spectra+pp*2*_stride;
+            const float* hi = hr+_stride;
+#if defined (CU_MATH_VECTOR_SSE)
+            if (VECTORIZE) {
+                for(size_t ii = 0; ii < _stride; ii += 4) {
+                    __m128 gr = _mm_load_ps(hr+ii);
+                    __m128 gi = _mm_load_ps(hi+ii);
+                    __m128 vr = _mm_load_ps(xr+ii);
+                    __m128 vi = _mm_load_ps(xi+ii);
+                    __m128 sr = _mm_sub_ps(_mm_mul_ps(gr,vr),_mm_mul_ps(gi,vi));
+                    __m128 si = _mm_add_ps(_mm_mul_ps(gr,vi),_mm_mul_ps(gi,vr));
+                    _mm_store_ps(accr+ii,_mm_add_ps(_mm_load_ps(accr+ii),sr));
+                    _mm_store_ps(acci+ii,_mm_add_ps(_mm_load_ps(acci+ii),si));
+                }
+            } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+            if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+                (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+            if (VECTORIZE) {
+#endif
+                for(size_t ii = 0; ii < _stride; ii += 4) {
+                    float32x4_t gr = vld1q_f32(hr+ii);
+                    float32x4_t gi = vld1q_f32(hi+ii);
+                    float32x4_t vr = vld1q_f32(xr+ii);
+                    float32x4_t vi = vld1q_f32(xi+ii);
+                    float32x4_t sr = vmlsq_f32(vmlaq_f32(vld1q_f32(accr+ii),gr,vr),gi,vi);
+                    float32x4_t si = vmlaq_f32(vmlaq_f32(vld1q_f32(acci+ii),gr,vi),gi,vr);
+                    vst1q_f32(accr+ii,sr);
+                    vst1q_f32(acci+ii,si);
+                }
+            } else {
+#else
+            {
+#endif
+                for(size_t ii = 0; ii <= size; ii++) {
+                    accr[ii] += hr[ii]*xr[ii]-hi[ii]*xi[ii];
+                    acci[ii] += hr[ii]*xi[ii]+hi[ii]*xr[ii];
+                }
+            }
+        }
+
+        // Overlap-save keeps the second half
+        float* time = acci+_stride;
+        inverse(accr,acci,time);
+        std::memcpy(_tails+channel*size,time+size,size*sizeof(float));
+    }
+    std::memcpy(input,input+size,size*sizeof(float));
+}
+
+#pragma mark -
+#pragma mark Filter Methods
+/**
+ * Performs a filter of single frame of data.
+ *
+ * The output is written to the given output array, which should be the
+ * same size as the input array. The size should be the number of channels.
+ * The gain parameter is applied at the filter input, but does not affect
+ * the filter coefficients.
+ *
+ * @param gain      The input gain factor
+ * @param input     The input frame
+ * @param output    The frame to receive the output
+ */
+void Convolver::step(float gain, const float* input, float* output) {
+    calculate(gain,input,output,1);
+}
+
+/**
+ * Performs a filter of interleaved input data.
+ *
+ * The output is written to the given output array, which should be the
+ * same size as the input array. The size is the number of frames, not
+ * samples.  Hence the arrays must be size times the number of channels
+ * in size.  The input and output may be the same array.
+ *
+ * There is no delay in the output.  The gain parameter is applied at the
+ * filter input, but does not affect the filter coefficients.
+ *
+ * @param gain      The input gain factor
+ * @param input     The array of input samples
+ * @param output    The array to write the sample output
+ * @param size      The input size in frames
+ */
+void Convolver::calculate(float gain, const float* input, float* output, size_t size) {
+    size_t block = _block;
+    size_t done  = 0;
+    while (done < size) {
+        // Process up to the end of the current block
+        size_t amt = std::min(size-done,block-_cursor);
+        const float* source = input+done*_channels;
+        float* dest = output+done*_channels;
+        for(unsigned ckk = 0; ckk < _channels; ckk++) {
+            float* row = _inputs+ckk*2*block+block+_cursor;
+            for(size_t ii = 0; ii < amt; ii++) {
+                row[ii] = gain*source[ii*_channels+ckk];
+            }
+        }
+
+        // The first partition has no latency
+        if (_child != nullptr) {
+            _child->calculate(gain,source,dest,amt);
+        } else {
+            for(unsigned ckk = 0; ckk < _channels; ckk++) {
+                float* row = _inputs+ckk*2*block+_cursor+1;
+                for(size_t ii = 0; ii < amt; ii++) {
+                    dest[ii*_channels+ckk] = DSPMath::dot(_head,row+ii,block);
+                }
+            }
+        }
+
+        if (_parts) {
+            for(unsigned ckk = 0; ckk < _channels; ckk++) {
+                float* tail = _tails+ckk*block+_cursor;
+                for(size_t ii = 0; ii < amt; ii++) {
+                    dest[ii*_channels+ckk] += tail[ii];
+                }
+            }
+        }
+
+        done += amt;
+        _cursor += amt;
+        if (_cursor == block) {
+            for(unsigned ckk = 0; ckk < _channels; ckk++) {
+                process(ckk);
+            }
+            _cursor = 0;
+            if (_parts) {
+                _slot = (_slot+1) % _parts;
+            }
+        }
+    }
+}
+
+/**
+ * Clears the filter buffer of any cached inputs
+ */
+void Convolver::clear() {
+    if (_child != nullptr) {
+        _child->clear();
+    }
+    _inputs.clear();
+    _history.clear();
+    _tails.clear();
+    _cursor = 0;
+    _slot = 0;
+}
+
+/**
+ * Flushes any delayed outputs to the provided array.
+ *
+ * As this filter has no delayed terms, this method will write nothing. It
+ * is only here to standardize the filter signature.
+ *
+ * This method will also clear the buffer.
+ *
+ * @return The number of frames (not samples) written
+ */
+size_t Convolver::flush(float* output) {
+    clear();
+    return 0;
+}
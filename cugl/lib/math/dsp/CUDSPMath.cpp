@@ -260,6 +260,214 @@ size_t DSPMath::scale_add(float* input1, float* input2, float scalar, float* out
 }
         
         
+/**
+ * Returns the dot product of two input signals
+ *
+ * This is the inner loop of an FIR filter, such as the polyphase filter
+ * in {@link audio::AudioResampler}.
+ *
+ * @param input1    The first input buffer
+ * @param input2    The second input buffer
+ * @param size      The number of elements to multiply
+ *
+ * @return the dot product of two input signals
+ */
+float DSPMath::dot(const float* input1, const float* input2, size_t size) {
+    float result = 0;
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        __m128 sum = _mm_setzero_ps();
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            sum = _mm_add_ps(sum,_mm_mul_ps(_mm_loadu_ps(input1+ii),_mm_loadu_ps(input2+ii)));
+        }
+        sum = _mm_add_ps(sum,_mm_movehl_ps(sum,sum));
+        sum = _mm_add_ss(sum,_mm_shuffle_ps(sum,sum,1));
+        result = _mm_cvtss_f32(sum);
+        if (size % 4 != 0) {
+            Uint32 rem = size % 4;
+            for(Uint32 ii = (Uint32)(size-rem); ii < size; ii++) {
+                result += input1[ii]*input2[ii];
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        float32x4_t sum = vdupq_n_f32(0);
+        for(int ii = 0; ii < (int)size-3; ii += 4) {
+            sum = vmlaq_f32(sum,vld1q_f32(input1+ii),vld1q_f32(input2+ii));
+        }
+        float32x2_t half = vadd_f32(vget_low_f32(sum),vget_high_f32(sum));
+        result = vget_lane_f32(vpadd_f32(half,half),0);
+        if (size % 4 != 0) {
+            Uint32 rem = size % 4;
+            for(Uint32 ii = (Uint32)(size-rem); ii < size; ii++) {
+                result += input1[ii]*input2[ii];
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        for(size_t ii = 0; ii < size; ii++) {
+            result += input1[ii]*input2[ii];
+        }
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Conversion Methods
+/**
+ * Converts a 16-bit integer signal to float, storing the result in output
+ *
+ * Each element is multiplied by the scalar after conversion. A scalar of
+ * 1/32768 converts 16-bit PCM data to the range [-1,1].
+ *
+ * The input and output buffers may not overlap.
+ *
+ * @param input     The input buffer
+ * @param scalar    The scalar to mutliply by
+ * @param output    The output buffer
+ * @param size      The number of elements to convert
+ *
+ * @return the number of elements successfully converted
+ */
+size_t DSPMath::convert(const Sint16* input, float scalar, float* output, size_t size) {
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE) {
+        // SSE2 only: sign extend by unpacking into the high half and shifting
+        const __m128 gain = _mm_set1_ps(scalar);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            __m128i words = _mm_loadu_si128((const __m128i*)(input+ii));
+            __m128i lower = _mm_srai_epi32(_mm_unpacklo_epi16(words,words),16);
+            __m128i upper = _mm_srai_epi32(_mm_unpackhi_epi16(words,words),16);
+            _mm_storeu_ps(output+ii,   _mm_mul_ps(_mm_cvtepi32_ps(lower),gain));
+            _mm_storeu_ps(output+ii+4, _mm_mul_ps(_mm_cvtepi32_ps(upper),gain));
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(Uint32 ii = (Uint32)(size-rem); ii < size; ii++) {
+                output[ii] = input[ii]*scalar;
+            }
+        }
+    } else {
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    if (VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+        (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0) {
+#else
+    if (VECTORIZE) {
+#endif
+        const float32x4_t gain = vld1q_dup_f32(&scalar);
+        for(int ii = 0; ii < (int)size-7; ii += 8) {
+            int16x8_t words = vld1q_s16(input+ii);
+            float32x4_t lower = vcvtq_f32_s32(vmovl_s16(vget_low_s16(words)));
+            float32x4_t upper = vcvtq_f32_s32(vmovl_s16(vget_high_s16(words)));
+            vst1q_f32(output+ii,   vmulq_f32(lower,gain));
+            vst1q_f32(output+ii+4, vmulq_f32(upper,gain));
+        }
+        if (size % 8 != 0) {
+            Uint32 rem = size % 8;
+            for(Uint32 ii = (Uint32)(size-rem); ii < size; ii++) {
+                output[ii] = input[ii]*scalar;
+            }
+        }
+    } else {
+#else
+    {
+#endif
+        for(size_t ii = 0; ii < size; ii++) {
+            output[ii] = input[ii]*scalar;
+        }
+    }
+    return size;
+}
+
+#pragma mark -
+#pragma mark Panning Methods
+/**
+ * Maps an interleaved signal onto a new set of channels, storing the result in output
+ *
+ * The matrix has field x channels elements. The value at position
+ * `i*channels+j` is the gain of input channel i in output channel j.
+ * The output has channels * frames elements, and is overwritten.
+ *
+ * The common cases of mono to stereo and stereo to stereo are vectorized.
+ * The input and output buffers may not overlap.
+ *
+ * @param input     The input buffer
+ * @param field     The number of input channels
+ * @param matrix    The channel gain matrix
+ * @param channels  The number of output channels
+ * @param output    The output buffer
+ * @param frames    The number of frames to map
+ *
+ * @return the number of frames successfully mapped
+ */
+size_t DSPMath::pan(const float* input, Uint32 field, const float* matrix,
+                    Uint32 channels, float* output, size_t frames) {
+    size_t done = 0;
+#if defined (CU_MATH_VECTOR_SSE)
+    if (VECTORIZE && channels == 2 && field == 1) {
+        const __m128 gain = _mm_setr_ps(matrix[0],matrix[1],matrix[0],matrix[1]);
+        for(; done+4 <= frames; done += 4) {
+            __m128 data = _mm_loadu_ps(input+done);
+            _mm_storeu_ps(output+2*done,   _mm_mul_ps(_mm_unpacklo_ps(data,data),gain));
+            _mm_storeu_ps(output+2*done+4, _mm_mul_ps(_mm_unpackhi_ps(data,data),gain));
+        }
+    } else if (VECTORIZE && channels == 2 && field == 2) {
+        // Straight gains on the diagonal, cross gains on the swapped pairs
+        const __m128 diag  = _mm_setr_ps(matrix[0],matrix[3],matrix[0],matrix[3]);
+        const __m128 cross = _mm_setr_ps(matrix[2],matrix[1],matrix[2],matrix[1]);
+        for(; done+2 <= frames; done += 2) {
+            __m128 data = _mm_loadu_ps(input+2*done);
+            __m128 swap = _mm_shuffle_ps(data,data,_MM_SHUFFLE(2,3,0,1));
+            _mm_storeu_ps(output+2*done, _mm_add_ps(_mm_mul_ps(data,diag),_mm_mul_ps(swap,cross)));
+        }
+    }
+#elif defined (CU_MATH_VECTOR_NEON64)
+#if defined (__ANDROID__)
+    bool vectorize = VECTORIZE && android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+                     (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+#else
+    bool vectorize = VECTORIZE;
+#endif
+    if (vectorize && channels == 2 && field == 1) {
+        const float32x4_t gain = {matrix[0],matrix[1],matrix[0],matrix[1]};
+        for(; done+4 <= frames; done += 4) {
+            float32x4x2_t data = vzipq_f32(vld1q_f32(input+done),vld1q_f32(input+done));
+            vst1q_f32(output+2*done,   vmulq_f32(data.val[0],gain));
+            vst1q_f32(output+2*done+4, vmulq_f32(data.val[1],gain));
+        }
+    } else if (vectorize && channels == 2 && field == 2) {
+        // Straight gains on the diagonal, cross gains on the swapped pairs
+        const float32x4_t diag  = {matrix[0],matrix[3],matrix[0],matrix[3]};
+        const float32x4_t cross = {matrix[2],matrix[1],matrix[2],matrix[1]};
+        for(; done+2 <= frames; done += 2) {
+            float32x4_t data = vld1q_f32(input+2*done);
+            vst1q_f32(output+2*done, vmlaq_f32(vmulq_f32(data,diag),vrev64q_f32(data),cross));
+        }
+    }
+#endif
+    for(; done < frames; done++) {
+        const float* frame = input+done*field;
+        float* result = output+done*channels;
+        for(Uint32 jj = 0; jj < channels; jj++) {
+            float value = 0;
+            for(Uint32 ii = 0; ii < field; ii++) {
+                value += frame[ii]*matrix[ii*channels+jj];
+            }
+            result[jj] = value;
+        }
+    }
+    return frames;
+}
+
 #pragma mark -
 #pragma mark Fade-In/Out Methods
 /**
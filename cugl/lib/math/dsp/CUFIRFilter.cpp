@@ -55,6 +55,8 @@ using namespace cugl::dsp;
 
 /** Whether to use a vectorization algorithm */
 bool FIRFilter::VECTORIZE = true;
+/** The number of coefficients after which to use an FFT convolution */
+size_t FIRFilter::FFT_THRESHOLD = 128;
 
 #pragma mark Constructors
 
@@ -110,6 +112,9 @@ FIRFilter::FIRFilter(const FIRFilter& copy) {
     _channels = copy._channels;
     _bval = copy._bval;
     _inns = copy._inns;
+    if (copy._convolver != nullptr) {
+        _convolver = std::unique_ptr<Convolver>(new Convolver(*copy._convolver));
+    }
 }
 
 /**
@@ -122,6 +127,7 @@ FIRFilter::FIRFilter(FIRFilter&& filter) {
     _channels = filter._channels;
     _bval = std::move(filter._bval);
     _inns = std::move(filter._inns);
+    _convolver = std::move(filter._convolver);
 }
 
 /**
@@ -135,7 +141,13 @@ FIRFilter::~FIRFilter() {}
  * This must be called if the number of channels or coefficients change.
  */
 void FIRFilter::reset() {
-    _inns.reset(_bval.size()*_channels,16);
+    if (_bval.size()+1 > FFT_THRESHOLD) {
+        _convolver = std::unique_ptr<Convolver>(new Convolver(_channels,getBCoeff()));
+        _inns.reset(0,16);
+    } else {
+        _convolver = nullptr;
+        _inns.reset(_bval.size()*_channels,16);
+    }
     clear();
 }
 
@@ -196,10 +208,12 @@ void FIRFilter::setCoeff(const std::vector<float> &bvals, const std::vector<floa
  * @return The upper coefficients
  */
 const std::vector<float> FIRFilter::getBCoeff() const {
+    size_t bsize = _bval.size();
     std::vector<float> result;
+    result.reserve(bsize+1);
     result.push_back(_b0);
-    for(size_t ii = 0; ii < _bval.size(); ii++) {
-        result.push_back(_bval[ii]);
+    for(size_t ii = 0; ii < bsize; ii++) {
+        result.push_back(_bval[bsize-ii-1]);
     }
     return result;
 }
@@ -240,10 +254,10 @@ void FIRFilter::setBCoeff(const std::vector<float> &bvals) {
     size_t bsize = bvals.size() > 0 ? bvals.size()-1 : 0;
     _bval.reset(bsize,16);
     
-    // Upper coefficients are in forward order
+    // Upper coefficients are in reverse order
     _b0 = bvals.size() == 0 ? 0.0f : bvals[0];
     for(size_t ii = 0; ii < bsize; ii++) {
-        _bval[ii] = bvals[ii+1];
+        _bval[bsize-ii-1] = bvals[ii+1];
     }
     reset();
 }
@@ -272,6 +286,11 @@ void FIRFilter::setBCoeff(const std::vector<float> &bvals) {
  * @param size      The input size in frames
  */
 void FIRFilter::step(float gain, float* input, float* output) {
+    if (_convolver != nullptr) {
+        _convolver->step(gain,input,output);
+        return;
+    }
+    
     size_t bsize = _bval.size();
 
     for(size_t ckk = 0; ckk < _channels; ckk++) {
@@ -282,6 +301,9 @@ void FIRFilter::step(float gain, float* input, float* output) {
         output[ckk] = temp;
     }
     
+    if (bsize == 0) {
+        return;
+    }
     for(size_t bjj = 0; bjj < _channels*(bsize-1); bjj++) {
         _inns[bjj] = _inns[bjj+_channels];
     }
@@ -314,31 +336,41 @@ void FIRFilter::step(float gain, float* input, float* output) {
  * @param size      The input size in frames
  */
 void FIRFilter::calculate(float gain,float* input, float* output, size_t size) {
+    if (_convolver != nullptr) {
+        _convolver->calculate(gain,input,output,size);
+        return;
+    }
+    
     size_t valid = VECTORIZE ? size-(size % 4) : size;
-    switch (_channels) {
-        case 1:
-            single(gain,input,output,valid);
-            break;
-        case 2:
-            dual(gain,input,output,valid);
-            break;
-        case 3:
-            trio(gain,input,output,valid);
-            break;
-        case 4:
-            quad(gain,input,output,valid);
-            break;
-        case 8:
-            quart(gain,input,output,valid);
-            break;
-        default:
-            for(int ii = 0; ii < _channels; ii++) {
-                stride(gain,input+ii,output+ii,valid,ii);
-            }
-            break;
+    if (valid == 0 || valid < _bval.size()) {
+        // The specialized filters need at least as much input as history
+        valid = 0;
+    } else {
+        switch (_channels) {
+            case 1:
+                single(gain,input,output,valid);
+                break;
+            case 2:
+                dual(gain,input,output,valid);
+                break;
+            case 3:
+                trio(gain,input,output,valid);
+                break;
+            case 4:
+                quad(gain,input,output,valid);
+                break;
+            case 8:
+                quart(gain,input,output,valid);
+                break;
+            default:
+                for(int ii = 0; ii < _channels; ii++) {
+                    stride(gain,input+ii,output+ii,valid,ii);
+                }
+                break;
+        }
     }
     if (valid < size) {
-        for(size_t ii = size-valid; ii < size; ii++) {
+        for(size_t ii = valid; ii < size; ii++) {
             step(gain,input+ii*_channels,output+ii*_channels);
         }
     }
@@ -348,6 +380,9 @@ void FIRFilter::calculate(float gain,float* input, float* output, size_t size) {
  * Clears the filter buffer of any delayed outputs or cached inputs
  */
 void FIRFilter::clear() {
+    if (_convolver != nullptr) {
+        _convolver->clear();
+    }
     for(size_t ii = 0; ii < _inns.size(); ii++) {
         _inns[ii] = 0.0f;
     }
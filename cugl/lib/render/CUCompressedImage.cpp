@@ -0,0 +1,1195 @@
+//
+//  CUCompressedImage.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for GPU-compressed texture data stored in
+//  KTX (version 1.1) containers.  Compressed textures are uploaded to the
+//  GPU as-is, so they require no decoding at load time and use a fraction
+//  of the video memory of an RGBA texture.
+//
+//  This module can also encode RGBA images as ETC2, which is supported by
+//  every OpenGLES 3 device.  This encoder is meant for offline use (see the
+//  texture cooker in the tools directory), as it is far too slow to run when
+//  loading assets.  The KTX reader accepts ASTC data as well, but ASTC data
+//  must be produced by an external encoder.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/render/CUCompressedImage.h>
+#include <cugl/render/CURenderRecorder.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFiletools.h>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+using namespace cugl;
+
+#pragma mark Internal Helpers
+/** The KTX 1.1 file identifier */
+static const Uint8 KTX_IDENTIFIER[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+/** The KTX endianness marker, as written by a machine of the same endianness */
+static const Uint32 KTX_ENDIAN = 0x04030201;
+/** The KTX endianness marker, as written by a machine of the opposite endianness */
+static const Uint32 KTX_SWAPPED = 0x01020304;
+/** The size of the KTX header (including the identifier) in bytes */
+static const size_t KTX_HEADER = 64;
+
+/** The ETC1 intensity modifier tables (the small and large modifier) */
+static const int ETC_MODIFIERS[8][2] = {
+    {2,8}, {5,17}, {9,29}, {13,42}, {18,60}, {24,80}, {33,106}, {47,183}
+};
+/** The ETC2 distances for the T and H modes */
+static const int ETC_DISTANCES[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+/** The EAC alpha modifier tables */
+static const int EAC_MODIFIERS[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+/**
+ * A 4x4 block of RGBA pixels, indexed by y*4+x
+ *
+ * The weights are used to ignore the color of fully transparent pixels.
+ */
+typedef struct {
+    /** The block pixels */
+    int pixels[16][4];
+    /** The color weight of each pixel */
+    int weights[16];
+} PixelBlock;
+
+/**
+ * Returns the value clamped to a byte
+ *
+ * @param value The value to clamp
+ *
+ * @return the value clamped to a byte
+ */
+static inline int clamp_byte(int value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/**
+ * Returns the given bits of the block
+ *
+ * @param bits  The (big-endian) block
+ * @param high  The position of the most significant bit
+ * @param count The number of bits
+ *
+ * @return the given bits of the block
+ */
+static inline int get_bits(Uint64 bits, int high, int count) {
+    return (int)((bits >> (high-count+1)) & ((1ull << count)-1));
+}
+
+/**
+ * Returns the sign-extended value of a 3-bit two's complement number
+ *
+ * @param value The 3-bit value
+ *
+ * @return the sign-extended value of a 3-bit two's complement number
+ */
+static inline int sign_extend3(int value) {
+    return (value & 4) ? value-8 : value;
+}
+
+/**
+ * Returns the given n-bit color component expanded to 8 bits
+ *
+ * @param value The color component
+ * @param bits  The number of bits in the component
+ *
+ * @return the given n-bit color component expanded to 8 bits
+ */
+static inline int expand_bits(int value, int bits) {
+    return (value << (8-bits)) | (value >> (2*bits-8));
+}
+
+/**
+ * Returns the given color component quantized to n bits
+ *
+ * @param value The 8-bit color component
+ * @param bits  The number of bits in the quantized component
+ *
+ * @return the given color component quantized to n bits
+ */
+static inline int quantize_bits(float value, int bits) {
+    int limit = (1 << bits)-1;
+    int result = (int)(value*limit/255.0f+0.5f);
+    return result < 0 ? 0 : (result > limit ? limit : result);
+}
+
+/**
+ * Returns the 64-bit block stored big-endian at the given address
+ *
+ * @param data  The block address
+ *
+ * @return the 64-bit block stored big-endian at the given address
+ */
+static Uint64 read_block(const Uint8* data) {
+    Uint64 result = 0;
+    for(int ii = 0; ii < 8; ii++) {
+        result = (result << 8) | data[ii];
+    }
+    return result;
+}
+
+/**
+ * Stores the 64-bit block big-endian at the given address
+ *
+ * @param bits  The block
+ * @param data  The block address
+ */
+static void write_block(Uint64 bits, Uint8* data) {
+    for(int ii = 7; ii >= 0; ii--) {
+        data[ii] = (Uint8)(bits & 0xff);
+        bits >>= 8;
+    }
+}
+
+/**
+ * Returns the block dimensions and size of the given format
+ *
+ * @param format    The compression format
+ * @param width     Stores the block width in pixels
+ * @param height    Stores the block height in pixels
+ *
+ * @return the size of a block in bytes (0 if the format is unknown)
+ */
+static Uint32 block_size(CompressedImage::Format format, Uint32& width, Uint32& height) {
+    switch (format) {
+        case CompressedImage::Format::ETC2_RGB:
+            width = height = 4;
+            return 8;
+        case CompressedImage::Format::ETC2_RGBA:
+            width = height = 4;
+            return 16;
+        case CompressedImage::Format::ASTC_4x4:
+            width = height = 4;
+            return 16;
+        case CompressedImage::Format::ASTC_5x5:
+            width = height = 5;
+            return 16;
+        case CompressedImage::Format::ASTC_6x6:
+            width = height = 6;
+            return 16;
+        case CompressedImage::Format::ASTC_8x8:
+            width = height = 8;
+            return 16;
+        default:
+            break;
+    }
+    width = height = 0;
+    return 0;
+}
+
+#pragma mark -
+#pragma mark ETC2 Decoding
+/**
+ * Decodes an ETC2 RGB block into the given block of pixels
+ *
+ * This function supports all five ETC2 block modes.  It only sets the
+ * color channels; the alpha channel is unchanged.
+ *
+ * @param bits      The ETC2 block
+ * @param block     The pixels to store the result, indexed by y*4+x
+ */
+static void decode_etc2(Uint64 bits, Uint8 block[16][4]) {
+    bool flip = (bits >> 32) & 1;
+    int base1[3], base2[3];
+    if (((bits >> 33) & 1) == 0) {
+        // Individual mode
+        for(int ii = 0; ii < 3; ii++) {
+            base1[ii] = get_bits(bits,63-8*ii,4)*17;
+            base2[ii] = get_bits(bits,59-8*ii,4)*17;
+        }
+    } else {
+        int color[3], delta[3];
+        for(int ii = 0; ii < 3; ii++) {
+            color[ii] = get_bits(bits,63-8*ii,5);
+            delta[ii] = sign_extend3(get_bits(bits,58-8*ii,3));
+        }
+
+        if (color[0]+delta[0] < 0 || color[0]+delta[0] > 31) {
+            // T mode
+            int c1[3], c2[3];
+            c1[0] = expand_bits((get_bits(bits,60,2) << 2) | get_bits(bits,57,2),4);
+            c1[1] = expand_bits(get_bits(bits,55,4),4);
+            c1[2] = expand_bits(get_bits(bits,51,4),4);
+            c2[0] = expand_bits(get_bits(bits,47,4),4);
+            c2[1] = expand_bits(get_bits(bits,43,4),4);
+            c2[2] = expand_bits(get_bits(bits,39,4),4);
+            int dist = ETC_DISTANCES[(get_bits(bits,35,2) << 1) | get_bits(bits,32,1)];
+            int paint[4][3];
+            for(int ii = 0; ii < 3; ii++) {
+                paint[0][ii] = c1[ii];
+                paint[1][ii] = clamp_byte(c2[ii]+dist);
+                paint[2][ii] = c2[ii];
+                paint[3][ii] = clamp_byte(c2[ii]-dist);
+            }
+            for(int pos = 0; pos < 16; pos++) {
+                int index = (((bits >> (16+pos)) & 1) << 1) | ((bits >> pos) & 1);
+                Uint8* pixel = block[(pos & 3)*4+(pos >> 2)];
+                for(int ii = 0; ii < 3; ii++) {
+                    pixel[ii] = (Uint8)paint[index][ii];
+                }
+            }
+            return;
+        } else if (color[1]+delta[1] < 0 || color[1]+delta[1] > 31) {
+            // H mode
+            int r1 = get_bits(bits,62,4);
+            int g1 = (get_bits(bits,58,3) << 1) | get_bits(bits,52,1);
+            int b1 = (get_bits(bits,51,1) << 3) | get_bits(bits,49,3);
+            int r2 = get_bits(bits,46,4);
+            int g2 = get_bits(bits,42,4);
+            int b2 = get_bits(bits,38,4);
+            int index = (get_bits(bits,34,1) << 2) | (get_bits(bits,32,1) << 1);
+            if (((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2)) {
+                index |= 1;
+            }
+            int dist = ETC_DISTANCES[index];
+            int c1[3] = { expand_bits(r1,4), expand_bits(g1,4), expand_bits(b1,4) };
+            int c2[3] = { expand_bits(r2,4), expand_bits(g2,4), expand_bits(b2,4) };
+            int paint[4][3];
+            for(int ii = 0; ii < 3; ii++) {
+                paint[0][ii] = clamp_byte(c1[ii]+dist);
+                paint[1][ii] = clamp_byte(c1[ii]-dist);
+                paint[2][ii] = clamp_byte(c2[ii]+dist);
+                paint[3][ii] = clamp_byte(c2[ii]-dist);
+            }
+            for(int pos = 0; pos < 16; pos++) {
+                int index = (((bits >> (16+pos)) & 1) << 1) | ((bits >> pos) & 1);
+                Uint8* pixel = block[(pos & 3)*4+(pos >> 2)];
+                for(int ii = 0; ii < 3; ii++) {
+                    pixel[ii] = (Uint8)paint[index][ii];
+                }
+            }
+            return;
+        } else if (color[2]+delta[2] < 0 || color[2]+delta[2] > 31) {
+            // Planar mode
+            int origin[3], horz[3], vert[3];
+            origin[0] = expand_bits(get_bits(bits,62,6),6);
+            origin[1] = expand_bits((get_bits(bits,56,1) << 6) | get_bits(bits,54,6),7);
+            origin[2] = expand_bits((get_bits(bits,48,1) << 5) | (get_bits(bits,44,2) << 3) | get_bits(bits,41,3),6);
+            horz[0] = expand_bits((get_bits(bits,38,5) << 1) | get_bits(bits,32,1),6);
+            horz[1] = expand_bits(get_bits(bits,31,7),7);
+            horz[2] = expand_bits(get_bits(bits,24,6),6);
+            vert[0] = expand_bits(get_bits(bits,18,6),6);
+            vert[1] = expand_bits(get_bits(bits,12,7),7);
+            vert[2] = expand_bits(get_bits(bits,5,6),6);
+            for(int y = 0; y < 4; y++) {
+                for(int x = 0; x < 4; x++) {
+                    for(int ii = 0; ii < 3; ii++) {
+                        int value = x*(horz[ii]-origin[ii])+y*(vert[ii]-origin[ii])+4*origin[ii]+2;
+                        block[y*4+x][ii] = (Uint8)clamp_byte(value >> 2);
+                    }
+                }
+            }
+            return;
+        }
+
+        // Differential mode
+        for(int ii = 0; ii < 3; ii++) {
+            base1[ii] = expand_bits(color[ii],5);
+            base2[ii] = expand_bits(color[ii]+delta[ii],5);
+        }
+    }
+
+    int table1 = get_bits(bits,39,3);
+    int table2 = get_bits(bits,36,3);
+    for(int pos = 0; pos < 16; pos++) {
+        int x = pos >> 2;
+        int y = pos & 3;
+        bool second = flip ? y >= 2 : x >= 2;
+        const int* base  = second ? base2 : base1;
+        const int* table = ETC_MODIFIERS[second ? table2 : table1];
+        int index = (((bits >> (16+pos)) & 1) << 1) | ((bits >> pos) & 1);
+        int modifier = (index & 1) ? table[1] : table[0];
+        if (index & 2) {
+            modifier = -modifier;
+        }
+        for(int ii = 0; ii < 3; ii++) {
+            block[y*4+x][ii] = (Uint8)clamp_byte(base[ii]+modifier);
+        }
+    }
+}
+
+/**
+ * Decodes an EAC alpha block into the given block of pixels
+ *
+ * This function only sets the alpha channel; the color channels are
+ * unchanged.
+ *
+ * @param bits      The EAC block
+ * @param block     The pixels to store the result, indexed by y*4+x
+ */
+static void decode_eac(Uint64 bits, Uint8 block[16][4]) {
+    int base  = get_bits(bits,63,8);
+    int mult  = get_bits(bits,55,4);
+    const int* table = EAC_MODIFIERS[get_bits(bits,51,4)];
+    for(int pos = 0; pos < 16; pos++) {
+        int index = (int)((bits >> (45-3*pos)) & 7);
+        block[(pos & 3)*4+(pos >> 2)][3] = (Uint8)clamp_byte(base+table[index]*mult);
+    }
+}
+
+#pragma mark -
+#pragma mark ETC2 Encoding
+/**
+ * Returns the error of the best ETC1 encoding of a subblock with the given base color
+ *
+ * This function tries every modifier table and picks the one with the
+ * least error.  The chosen indices are stored in the given array, with
+ * the modifier for each pixel (used to refine the base color).
+ *
+ * @param block     The pixel block
+ * @param members   The positions (y*4+x) of the eight pixels in the subblock
+ * @param base      The (expanded) base color
+ * @param table     Stores the chosen table
+ * @param indices   Stores the chosen index for each pixel in the subblock
+ * @param modifiers Stores the chosen modifier for each pixel in the subblock
+ *
+ * @return the error of the best ETC1 encoding of the subblock
+ */
+static Uint64 fit_subblock(const PixelBlock& block, const int members[8], const int base[3],
+                           int& table, int indices[8], int modifiers[8]) {
+    Uint64 best = ULLONG_MAX;
+    for(int tt = 0; tt < 8; tt++) {
+        Uint64 total = 0;
+        int choices[8];
+        int values[8];
+        for(int ii = 0; ii < 8 && total < best; ii++) {
+            const int* pixel = block.pixels[members[ii]];
+            Uint64 least = ULLONG_MAX;
+            for(int kk = 0; kk < 4; kk++) {
+                int modifier = (kk & 1) ? ETC_MODIFIERS[tt][1] : ETC_MODIFIERS[tt][0];
+                if (kk & 2) {
+                    modifier = -modifier;
+                }
+                Uint64 error = 0;
+                for(int cc = 0; cc < 3; cc++) {
+                    int diff = clamp_byte(base[cc]+modifier)-pixel[cc];
+                    error += diff*diff;
+                }
+                if (error < least) {
+                    least = error;
+                    choices[ii] = kk;
+                    values[ii] = modifier;
+                }
+            }
+            total += least*block.weights[members[ii]];
+        }
+        if (total < best) {
+            best  = total;
+            table = tt;
+            std::memcpy(indices, choices, sizeof(choices));
+            std::memcpy(modifiers, values, sizeof(values));
+        }
+    }
+    return best;
+}
+
+/**
+ * Returns the weighted average of the subblock pixels, less their modifiers
+ *
+ * If the modifiers are nullptr, this is just the average color.  Otherwise,
+ * it is the base color that would best reproduce the subblock with the
+ * given modifiers.
+ *
+ * @param block     The pixel block
+ * @param members   The positions (y*4+x) of the eight pixels in the subblock
+ * @param modifiers The modifier for each pixel (may be nullptr)
+ * @param result    Stores the average color
+ */
+static void average_subblock(const PixelBlock& block, const int members[8], const int* modifiers,
+                             float result[3]) {
+    int weight = 0;
+    for(int ii = 0; ii < 8; ii++) {
+        weight += block.weights[members[ii]];
+    }
+    for(int cc = 0; cc < 3; cc++) {
+        float sum = 0;
+        for(int ii = 0; ii < 8; ii++) {
+            int w = weight ? block.weights[members[ii]] : 1;
+            int value = block.pixels[members[ii]][cc]-(modifiers ? modifiers[ii] : 0);
+            sum += w*value;
+        }
+        result[cc] = sum/(weight ? weight : 8);
+    }
+}
+
+/**
+ * Returns the error of the ETC1-compatible encoding of a block
+ *
+ * This function encodes the block in either individual or differential mode,
+ * with the given subblock orientation.  The base colors are chosen from the
+ * subblock averages, and then refined once to account for the modifiers.
+ *
+ * @param block     The pixel block
+ * @param flip      Whether the subblocks are stacked vertically
+ * @param diff      Whether to use differential mode
+ * @param result    Stores the encoded block
+ *
+ * @return the error of the ETC1-compatible encoding of a block
+ */
+static Uint64 encode_etc1(const PixelBlock& block, bool flip, bool diff, Uint64& result) {
+    int members[2][8];
+    int count[2] = {0, 0};
+    for(int pos = 0; pos < 16; pos++) {
+        int x = pos & 3;
+        int y = pos >> 2;
+        int sub = flip ? (y >= 2) : (x >= 2);
+        members[sub][count[sub]++] = pos;
+    }
+
+    float target[2][3];
+    average_subblock(block, members[0], nullptr, target[0]);
+    average_subblock(block, members[1], nullptr, target[1]);
+
+    Uint64 best = ULLONG_MAX;
+    for(int pass = 0; pass < 2; pass++) {
+        // Quantize the base colors
+        int quant[2][3];
+        int base[2][3];
+        for(int cc = 0; cc < 3; cc++) {
+            if (diff) {
+                quant[0][cc] = quantize_bits(target[0][cc],5);
+                quant[1][cc] = quantize_bits(target[1][cc],5);
+                int delta = std::max(-4,std::min(3,quant[1][cc]-quant[0][cc]));
+                quant[1][cc] = quant[0][cc]+delta;
+                base[0][cc] = expand_bits(quant[0][cc],5);
+                base[1][cc] = expand_bits(quant[1][cc],5);
+            } else {
+                quant[0][cc] = quantize_bits(target[0][cc],4);
+                quant[1][cc] = quantize_bits(target[1][cc],4);
+                base[0][cc] = quant[0][cc]*17;
+                base[1][cc] = quant[1][cc]*17;
+            }
+        }
+
+        int table[2];
+        int indices[2][8];
+        int modifiers[2][8];
+        Uint64 error = fit_subblock(block, members[0], base[0], table[0], indices[0], modifiers[0]);
+        error += fit_subblock(block, members[1], base[1], table[1], indices[1], modifiers[1]);
+
+        if (error < best) {
+            best = error;
+            Uint64 bits = 0;
+            for(int cc = 0; cc < 3; cc++) {
+                if (diff) {
+                    bits |= (Uint64)quant[0][cc] << (59-8*cc);
+                    bits |= (Uint64)((quant[1][cc]-quant[0][cc]) & 7) << (56-8*cc);
+                } else {
+                    bits |= (Uint64)quant[0][cc] << (60-8*cc);
+                    bits |= (Uint64)quant[1][cc] << (56-8*cc);
+                }
+            }
+            bits |= (Uint64)table[0] << 37;
+            bits |= (Uint64)table[1] << 34;
+            bits |= (Uint64)(diff ? 1 : 0) << 33;
+            bits |= (Uint64)(flip ? 1 : 0) << 32;
+            for(int sub = 0; sub < 2; sub++) {
+                for(int ii = 0; ii < 8; ii++) {
+                    int pos = members[sub][ii];
+                    int shift = (pos & 3)*4+(pos >> 2);
+                    bits |= (Uint64)(indices[sub][ii] >> 1) << (16+shift);
+                    bits |= (Uint64)(indices[sub][ii] & 1) << shift;
+                }
+            }
+            result = bits;
+        }
+
+        // Refine the base colors for the chosen modifiers
+        average_subblock(block, members[0], modifiers[0], target[0]);
+        average_subblock(block, members[1], modifiers[1], target[1]);
+    }
+    return best;
+}
+
+/**
+ * Returns the error of the given ETC2 block for the pixel block
+ *
+ * @param block     The pixel block
+ * @param bits      The ETC2 block
+ *
+ * @return the error of the given ETC2 block for the pixel block
+ */
+static Uint64 measure_etc2(const PixelBlock& block, Uint64 bits) {
+    Uint8 decoded[16][4];
+    decode_etc2(bits, decoded);
+    Uint64 total = 0;
+    for(int pos = 0; pos < 16; pos++) {
+        Uint64 error = 0;
+        for(int cc = 0; cc < 3; cc++) {
+            int diff = decoded[pos][cc]-block.pixels[pos][cc];
+            error += diff*diff;
+        }
+        total += error*block.weights[pos];
+    }
+    return total;
+}
+
+/**
+ * Returns the error of the planar encoding of a block
+ *
+ * The planar mode fits a linear gradient to the block, which is ideal for
+ * smooth regions of an image.  The gradient is a least-squares fit of the
+ * block pixels.
+ *
+ * @param block     The pixel block
+ * @param result    Stores the encoded block
+ *
+ * @return the error of the planar encoding of a block
+ */
+static Uint64 encode_planar(const PixelBlock& block, Uint64& result) {
+    // Least squares fit of c = a + b*x + c*y at x,y in [0,3]
+    int bits[3] = { 6, 7, 6 };
+    int origin[3], horz[3], vert[3];
+    for(int cc = 0; cc < 3; cc++) {
+        float sum = 0, sumx = 0, sumy = 0;
+        for(int pos = 0; pos < 16; pos++) {
+            float value = (float)block.pixels[pos][cc];
+            sum  += value;
+            sumx += ((pos & 3)-1.5f)*value;
+            sumy += ((pos >> 2)-1.5f)*value;
+        }
+        float slopex = sumx/20.0f;
+        float slopey = sumy/20.0f;
+        float start  = sum/16.0f-1.5f*(slopex+slopey);
+        origin[cc] = quantize_bits(start,bits[cc]);
+        horz[cc] = quantize_bits(start+4*slopex,bits[cc]);
+        vert[cc] = quantize_bits(start+4*slopey,bits[cc]);
+    }
+
+    Uint64 value = 0;
+    value |= (Uint64)origin[0] << 57;
+    value |= (Uint64)(origin[1] >> 6) << 56;
+    value |= (Uint64)(origin[1] & 63) << 49;
+    value |= (Uint64)(origin[2] >> 5) << 48;
+    value |= (Uint64)((origin[2] >> 3) & 3) << 43;
+    value |= (Uint64)(origin[2] & 7) << 39;
+    value |= (Uint64)(horz[0] >> 1) << 34;
+    value |= (Uint64)1 << 33;
+    value |= (Uint64)(horz[0] & 1) << 32;
+    value |= (Uint64)horz[1] << 25;
+    value |= (Uint64)horz[2] << 19;
+    value |= (Uint64)vert[0] << 13;
+    value |= (Uint64)vert[1] << 6;
+    value |= (Uint64)vert[2];
+
+    // Set the unused bits so that only blue overflows in differential mode
+    for(int free = 0; free < 64; free++) {
+        Uint64 bits = value;
+        bits |= (Uint64)(free & 1) << 63;
+        bits |= (Uint64)((free >> 1) & 1) << 55;
+        bits |= (Uint64)((free >> 2) & 7) << 45;
+        bits |= (Uint64)((free >> 5) & 1) << 42;
+        int red   = get_bits(bits,63,5)+sign_extend3(get_bits(bits,58,3));
+        int green = get_bits(bits,55,5)+sign_extend3(get_bits(bits,50,3));
+        int blue  = get_bits(bits,47,5)+sign_extend3(get_bits(bits,42,3));
+        if (red >= 0 && red <= 31 && green >= 0 && green <= 31 && (blue < 0 || blue > 31)) {
+            result = bits;
+            return measure_etc2(block, bits);
+        }
+    }
+    return ULLONG_MAX;
+}
+
+/**
+ * Returns the best ETC2 RGB block for the given pixels
+ *
+ * This function tries the individual, differential, and planar modes and
+ * picks the one with the least error.
+ *
+ * @param block     The pixel block
+ *
+ * @return the best ETC2 RGB block for the given pixels
+ */
+static Uint64 encode_etc2(const PixelBlock& block) {
+    Uint64 best = ULLONG_MAX;
+    Uint64 result = 0;
+    for(int mode = 0; mode < 4; mode++) {
+        Uint64 bits = 0;
+        Uint64 error = encode_etc1(block, mode & 1, mode & 2, bits);
+        if (error < best) {
+            best = error;
+            result = bits;
+        }
+    }
+    if (best > 0) {
+        Uint64 bits = 0;
+        Uint64 error = encode_planar(block, bits);
+        if (error < best) {
+            result = bits;
+        }
+    }
+    return result;
+}
+
+/**
+ * Returns the best EAC alpha block for the given pixels
+ *
+ * This function searches every modifier table, with the multipliers and
+ * base values closest to those that span the alpha range of the block.
+ *
+ * @param block     The pixel block
+ *
+ * @return the best EAC alpha block for the given pixels
+ */
+static Uint64 encode_eac(const PixelBlock& block) {
+    int amin = 255;
+    int amax = 0;
+    for(int pos = 0; pos < 16; pos++) {
+        amin = std::min(amin,block.pixels[pos][3]);
+        amax = std::max(amax,block.pixels[pos][3]);
+    }
+
+    int bestbase = amin;
+    int bestmult = 1;
+    int besttable = 13;
+    int bestindex[16];
+    Uint64 best = ULLONG_MAX;
+    if (amin == amax) {
+        // Table 13 has a zero modifier
+        best = 0;
+        for(int pos = 0; pos < 16; pos++) {
+            bestindex[pos] = 4;
+        }
+    }
+
+    for(int tt = 0; tt < 16 && best > 0; tt++) {
+        const int* table = EAC_MODIFIERS[tt];
+        int span = table[7]-table[3];
+        int guess = std::max(1,std::min(15,(amax-amin+span/2)/span));
+        for(int mult = std::max(1,guess-1); mult <= std::min(15,guess+1); mult++) {
+            int center = (amin+amax-(table[3]+table[7])*mult)/2;
+            for(int base = std::max(0,center-1); base <= std::min(255,center+1); base++) {
+                int choices[16];
+                Uint64 total = 0;
+                for(int pos = 0; pos < 16 && total < best; pos++) {
+                    int least = INT_MAX;
+                    for(int kk = 0; kk < 8; kk++) {
+                        int diff = clamp_byte(base+table[kk]*mult)-block.pixels[pos][3];
+                        if (diff*diff < least) {
+                            least = diff*diff;
+                            choices[pos] = kk;
+                        }
+                    }
+                    total += least;
+                }
+                if (total < best) {
+                    best = total;
+                    bestbase  = base;
+                    bestmult  = mult;
+                    besttable = tt;
+                    std::memcpy(bestindex, choices, sizeof(choices));
+                }
+            }
+        }
+    }
+
+    Uint64 bits = 0;
+    bits |= (Uint64)bestbase << 56;
+    bits |= (Uint64)bestmult << 52;
+    bits |= (Uint64)besttable << 48;
+    for(int pos = 0; pos < 16; pos++) {
+        int shift = (pos & 3)*4+(pos >> 2);
+        bits |= (Uint64)bestindex[pos] << (45-3*shift);
+    }
+    return bits;
+}
+
+/**
+ * Encodes an RGBA image as ETC2 data
+ *
+ * The partial blocks at the right and bottom edges are padded by repeating
+ * the edge pixels.
+ *
+ * @param pixels    The RGBA pixels
+ * @param width     The image width
+ * @param height    The image height
+ * @param alpha     Whether to encode the alpha channel with EAC
+ * @param output    The buffer to store the encoded blocks
+ */
+static void encode_image(const Uint8* pixels, Uint32 width, Uint32 height, bool alpha, Uint8* output) {
+    PixelBlock block;
+    for(Uint32 by = 0; by < height; by += 4) {
+        for(Uint32 bx = 0; bx < width; bx += 4) {
+            bool opaque = false;
+            for(int pos = 0; pos < 16; pos++) {
+                Uint32 x = std::min(bx+(pos & 3),width-1);
+                Uint32 y = std::min(by+(pos >> 2),height-1);
+                const Uint8* pixel = pixels+4*((size_t)y*width+x);
+                for(int cc = 0; cc < 4; cc++) {
+                    block.pixels[pos][cc] = pixel[cc];
+                }
+                // The color of invisible pixels does not matter
+                block.weights[pos] = (!alpha || pixel[3] > 0) ? 1 : 0;
+                opaque = opaque || block.weights[pos];
+            }
+            if (!opaque) {
+                for(int pos = 0; pos < 16; pos++) {
+                    block.weights[pos] = 1;
+                }
+            }
+
+            if (alpha) {
+                write_block(encode_eac(block), output);
+                output += 8;
+            }
+            write_block(encode_etc2(block), output);
+            output += 8;
+        }
+    }
+}
+
+/**
+ * Returns the next mipmap level of an RGBA image
+ *
+ * The next level is computed with a box filter.  When a dimension is odd,
+ * some boxes span three pixels instead of two, so that every pixel of the
+ * image contributes to the next level.
+ *
+ * @param pixels    The RGBA pixels
+ * @param width     The image width
+ * @param height    The image height
+ *
+ * @return the next mipmap level of an RGBA image
+ */
+static std::vector<Uint8> downsample(const std::vector<Uint8>& pixels, Uint32 width, Uint32 height) {
+    Uint32 w = std::max(1u,width/2);
+    Uint32 h = std::max(1u,height/2);
+    std::vector<Uint8> result(4*(size_t)w*h);
+    for(Uint32 y = 0; y < h; y++) {
+        Uint32 y0 = y*height/h;
+        Uint32 y1 = std::max(y0+1,(y+1)*height/h);
+        for(Uint32 x = 0; x < w; x++) {
+            Uint32 x0 = x*width/w;
+            Uint32 x1 = std::max(x0+1,(x+1)*width/w);
+            Uint32 area = (x1-x0)*(y1-y0);
+            for(int cc = 0; cc < 4; cc++) {
+                Uint32 sum = 0;
+                for(Uint32 yy = y0; yy < y1; yy++) {
+                    for(Uint32 xx = x0; xx < x1; xx++) {
+                        sum += pixels[4*((size_t)yy*width+xx)+cc];
+                    }
+                }
+                result[4*((size_t)y*w+x)+cc] = (Uint8)((sum+area/2)/area);
+            }
+        }
+    }
+    return result;
+}
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this image.
+ *
+ * A disposed image can be safely reinitialized.
+ */
+void CompressedImage::dispose() {
+    _format = Format::UNKNOWN;
+    _width  = 0;
+    _height = 0;
+    _mapping = nullptr;
+    _storage.clear();
+    _data = nullptr;
+    _levels.clear();
+}
+
+/**
+ * Initializes a compressed image from the given KTX file.
+ *
+ * The KTX file must contain a single 2D image (no arrays or cube maps)
+ * in one of the formats of {@link Format}.  The file is memory mapped,
+ * and the image data is not copied.
+ *
+ * @param file  The path to the KTX file
+ *
+ * @return true if initialization was successful.
+ */
+bool CompressedImage::initWithFile(const std::string file) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::alloc(file);
+    return mapping != nullptr && initWithMapping(mapping);
+}
+
+/**
+ * Initializes a compressed image from the given KTX file contents.
+ *
+ * The KTX file must contain a single 2D image (no arrays or cube maps)
+ * in one of the formats of {@link Format}.  The image data is not copied,
+ * and this image retains a reference to the mapping.
+ *
+ * @param mapping   The contents of a KTX file
+ *
+ * @return true if initialization was successful.
+ */
+bool CompressedImage::initWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+    if (_data) {
+        CUAssertLog(false, "Image is already initialized");
+        return false; // In case asserts are off.
+    }
+
+    const Uint8* data = (const Uint8*)mapping->data();
+    size_t size = mapping->size();
+    if (size < KTX_HEADER || std::memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0) {
+        CULogError("File '%s' is not a KTX file", mapping->getName().c_str());
+        return false;
+    }
+
+    Uint32 header[13];
+    std::memcpy(header, data+sizeof(KTX_IDENTIFIER), sizeof(header));
+    bool swap = (header[0] == KTX_SWAPPED);
+    if (!swap && header[0] != KTX_ENDIAN) {
+        CULogError("File '%s' has an invalid KTX header", mapping->getName().c_str());
+        return false;
+    } else if (swap) {
+        for(int ii = 0; ii < 13; ii++) {
+            header[ii] = SDL_Swap32(header[ii]);
+        }
+    }
+
+    // Compressed data has no glType or glFormat
+    Format format = (Format)header[4];
+    Uint32 bwidth, bheight;
+    if (header[1] != 0 || header[3] != 0 || block_size(format, bwidth, bheight) == 0) {
+        CULogError("File '%s' is not in a supported compression format", mapping->getName().c_str());
+        return false;
+    } else if (header[6] == 0 || header[7] == 0 || header[8] > 1 || header[9] > 1 || header[10] != 1) {
+        CULogError("File '%s' is not a 2D texture", mapping->getName().c_str());
+        return false;
+    }
+
+    Uint32 width  = header[6];
+    Uint32 height = header[7];
+    Uint32 levels = std::max(1u,header[11]);
+    size_t offset = KTX_HEADER+header[12];
+    std::vector<std::pair<size_t,size_t>> entries;
+    for(Uint32 ii = 0; ii < levels; ii++) {
+        if (offset+4 > size) {
+            CULogError("File '%s' is truncated", mapping->getName().c_str());
+            return false;
+        }
+        Uint32 amount;
+        std::memcpy(&amount, data+offset, 4);
+        if (swap) {
+            amount = SDL_Swap32(amount);
+        }
+        offset += 4;
+
+        size_t expected = getDataSize(format, std::max(1u,width >> ii), std::max(1u,height >> ii));
+        if (amount != expected || offset+amount > size) {
+            CULogError("File '%s' has an invalid mipmap level %d", mapping->getName().c_str(), ii);
+            return false;
+        }
+        entries.push_back(std::make_pair(offset,(size_t)amount));
+        offset = (offset+amount+3) & ~(size_t)3;
+    }
+
+    _format  = format;
+    _width   = width;
+    _height  = height;
+    _mapping = mapping;
+    _data    = data;
+    _levels  = std::move(entries);
+    return true;
+}
+
+/**
+ * Initializes a compressed image by encoding the given RGBA pixels.
+ *
+ * The pixels must be stored row by row, with four bytes per pixel in
+ * the order red, green, blue, and alpha.  The format must be either
+ * {@link Format#ETC2_RGB} or {@link Format#ETC2_RGBA}.  If the format
+ * is ETC2_RGB, the alpha channel is ignored.
+ *
+ * If mipmaps is true, this method will compute the full mip chain with
+ * a box filter, and encode every level.
+ *
+ * @param pixels    The RGBA pixels to encode
+ * @param width     The image width in pixels
+ * @param height    The image height in pixels
+ * @param format    The compression format
+ * @param mipmaps   Whether to compute and encode the mip chain
+ *
+ * @return true if initialization was successful.
+ */
+bool CompressedImage::initWithPixels(const Uint8* pixels, Uint32 width, Uint32 height,
+                                     Format format, bool mipmaps) {
+    if (_data) {
+        CUAssertLog(false, "Image is already initialized");
+        return false; // In case asserts are off.
+    } else if (format != Format::ETC2_RGB && format != Format::ETC2_RGBA) {
+        CUAssertLog(false, "Only ETC2 images may be encoded");
+        return false;
+    } else if (pixels == nullptr || width == 0 || height == 0) {
+        return false;
+    }
+
+    Uint32 levels = 1;
+    if (mipmaps) {
+        while ((width >> levels) > 0 || (height >> levels) > 0) {
+            levels++;
+        }
+    }
+
+    size_t total = 0;
+    for(Uint32 ii = 0; ii < levels; ii++) {
+        size_t amount = getDataSize(format, std::max(1u,width >> ii), std::max(1u,height >> ii));
+        _levels.push_back(std::make_pair(total,amount));
+        total += amount;
+    }
+    _storage.resize(total);
+
+    bool alpha = (format == Format::ETC2_RGBA);
+    encode_image(pixels, width, height, alpha, _storage.data());
+    if (levels > 1) {
+        std::vector<Uint8> level(pixels,pixels+4*(size_t)width*height);
+        Uint32 w = width;
+        Uint32 h = height;
+        for(Uint32 ii = 1; ii < levels; ii++) {
+            level = downsample(level, w, h);
+            w = std::max(1u,w/2);
+            h = std::max(1u,h/2);
+            encode_image(level.data(), w, h, alpha, _storage.data()+_levels[ii].first);
+        }
+    }
+
+    _format = format;
+    _width  = width;
+    _height = height;
+    _data   = _storage.data();
+    return true;
+}
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Returns the compressed data for the given mipmap level.
+ *
+ * The data is exactly what should be passed to glCompressedTexImage2D.
+ * This method returns nullptr if the level does not exist.
+ *
+ * @param level The mipmap level
+ * @param size  Stores the size of the data in bytes
+ *
+ * @return the compressed data for the given mipmap level.
+ */
+const Uint8* CompressedImage::getLevel(size_t level, size_t& size) const {
+    if (level >= _levels.size()) {
+        size = 0;
+        return nullptr;
+    }
+    size = _levels[level].second;
+    return _data+_levels[level].first;
+}
+
+/**
+ * Returns the total size of the compressed data in bytes.
+ *
+ * This is the amount of video memory used by the texture for this image.
+ *
+ * @return the total size of the compressed data in bytes.
+ */
+size_t CompressedImage::getByteSize() const {
+    size_t total = 0;
+    for(auto it = _levels.begin(); it != _levels.end(); ++it) {
+        total += it->second;
+    }
+    return total;
+}
+
+/**
+ * Returns true if the given format is supported by the current GPU.
+ *
+ * The supported formats are queried from OpenGL the first time this
+ * method is called, so it must be called in the main thread.  ETC2 is
+ * always supported in OpenGLES 3, but is not available on macOS.  ASTC
+ * is only supported on recent mobile devices.
+ *
+ * @param format    The compression format
+ *
+ * @return true if the given format is supported by the current GPU.
+ */
+bool CompressedImage::isSupported(Format format) {
+    if (format == Format::UNKNOWN) {
+        return false;
+    } else if (RenderRecorder::isHeadless()) {
+        return true;
+    }
+
+    static std::vector<GLint> formats;
+    static bool queried = false;
+    if (!queried) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        formats.resize(count);
+        if (count > 0) {
+            glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        }
+        queried = true;
+    }
+    return std::find(formats.begin(), formats.end(), (GLint)format) != formats.end();
+}
+
+/**
+ * Returns the size of the compressed data for an image of the given size.
+ *
+ * This method returns 0 if the format is unknown.
+ *
+ * @param format    The compression format
+ * @param width     The image width in pixels
+ * @param height    The image height in pixels
+ *
+ * @return the size of the compressed data for an image of the given size.
+ */
+size_t CompressedImage::getDataSize(Format format, Uint32 width, Uint32 height) {
+    Uint32 bwidth, bheight;
+    Uint32 bytes = block_size(format, bwidth, bheight);
+    if (bytes == 0) {
+        return 0;
+    }
+    return (size_t)((width+bwidth-1)/bwidth)*((height+bheight-1)/bheight)*bytes;
+}
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Decodes the given mipmap level into RGBA pixels.
+ *
+ * The pixels are stored row by row, with four bytes per pixel in the
+ * order red, green, blue, and alpha.  Only the ETC2 formats may be
+ * decoded.  All of the ETC2 block modes are supported, and not just
+ * the ones produced by the encoder.
+ *
+ * @param level     The mipmap level
+ * @param pixels    The vector to store the decoded pixels
+ *
+ * @return true if the level could be decoded.
+ */
+bool CompressedImage::decode(size_t level, std::vector<Uint8>& pixels) const {
+    if (level >= _levels.size() || (_format != Format::ETC2_RGB && _format != Format::ETC2_RGBA)) {
+        return false;
+    }
+
+    Uint32 width  = std::max(1u,_width >> level);
+    Uint32 height = std::max(1u,_height >> level);
+    pixels.resize(4*(size_t)width*height);
+
+    bool alpha = (_format == Format::ETC2_RGBA);
+    const Uint8* input = _data+_levels[level].first;
+    Uint8 block[16][4];
+    for(Uint32 by = 0; by < height; by += 4) {
+        for(Uint32 bx = 0; bx < width; bx += 4) {
+            if (alpha) {
+                decode_eac(read_block(input), block);
+                input += 8;
+            } else {
+                for(int pos = 0; pos < 16; pos++) {
+                    block[pos][3] = 255;
+                }
+            }
+            decode_etc2(read_block(input), block);
+            input += 8;
+
+            for(int pos = 0; pos < 16; pos++) {
+                Uint32 x = bx+(pos & 3);
+                Uint32 y = by+(pos >> 2);
+                if (x < width && y < height) {
+                    std::memcpy(pixels.data()+4*((size_t)y*width+x), block[pos], 4);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Saves this image to the given file as a KTX file.
+ *
+ * The file should have the extension ".ktx".  This method returns false
+ * if the file could not be written.
+ *
+ * @param file  The path to the KTX file
+ *
+ * @return true if the file was saved successfully.
+ */
+bool CompressedImage::save(const std::string file) const {
+    if (_data == nullptr) {
+        return false;
+    }
+
+    // glType, glTypeSize, glFormat, internal format, base format, dimensions
+    Uint32 header[13] = {
+        KTX_ENDIAN, 0, 1, 0, (Uint32)_format,
+        (Uint32)(hasAlpha() ? GL_RGBA : GL_RGB),
+        _width, _height, 0, 0, 1, (Uint32)_levels.size(), 0
+    };
+
+    std::string path = filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "wb");
+    if (!stream) {
+        CULogError("Could not open '%s' for writing",path.c_str());
+        return false;
+    }
+
+    bool success = SDL_RWwrite(stream, KTX_IDENTIFIER, 1, sizeof(KTX_IDENTIFIER)) == sizeof(KTX_IDENTIFIER);
+    success = success && SDL_RWwrite(stream, header, 1, sizeof(header)) == sizeof(header);
+    for(auto it = _levels.begin(); success && it != _levels.end(); ++it) {
+        Uint32 amount = (Uint32)it->second;
+        success = SDL_RWwrite(stream, &amount, 1, 4) == 4;
+        success = success && SDL_RWwrite(stream, _data+it->first, 1, it->second) == it->second;
+        // Block sizes are multiples of 8, so levels never need padding
+    }
+    SDL_RWclose(stream);
+    return success;
+}
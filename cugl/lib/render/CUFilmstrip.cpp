@@ -0,0 +1,610 @@
+//
+//  CUFilmstrip.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides support for long animations stored as a stream of
+//  compressed frames.  A sprite sheet must keep every frame of an animation
+//  resident in video memory.  A filmstrip only stores the differences between
+//  consecutive frames, and it is decoded one frame at a time.  This makes it
+//  suitable for long background animations, where only the current frame
+//  needs to be on the GPU.  See {@link scene2::StreamedAnimationNode}.
+//
+//  The frames are encoded as runs of skipped, copied, and filled pixels.
+//  Key frames (which do not depend on the previous frame) are inserted at a
+//  regular interval so that the decoder can seek.  The encoder is meant for
+//  offline use (see the texture cooker in the tools directory).
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/render/CUFilmstrip.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFiletools.h>
+#include <cstring>
+#include <cstdlib>
+
+using namespace cugl;
+
+#pragma mark Internal Helpers
+/** The identifier at the start of every filmstrip file */
+static const Uint8 FILM_IDENTIFIER[4] = { 'C', 'U', 'F', 'S' };
+/** The current version of the filmstrip format */
+static const Uint32 FILM_VERSION = 1;
+/** The size of the filmstrip header (including the identifier) */
+static const size_t FILM_HEADER = 32;
+
+/** The first byte of a key frame */
+static const Uint8 FRAME_KEY   = 1;
+/** The first byte of a delta frame */
+static const Uint8 FRAME_DELTA = 0;
+
+/** A run of pixels unchanged from the previous frame */
+static const Uint32 RUN_SKIP = 0;
+/** A run of pixels stored verbatim */
+static const Uint32 RUN_COPY = 1;
+/** A run of pixels with a single color */
+static const Uint32 RUN_FILL = 2;
+
+/** The shortest fill run the encoder will emit */
+static const Uint32 MIN_FILL = 3;
+/** The shortest skip run that will break up a copy run */
+static const Uint32 MIN_SKIP = 2;
+
+/**
+ * Appends the given value to the buffer as a variable-length integer
+ *
+ * Each byte stores seven bits of the value, with the high bit set if more
+ * bytes follow.
+ *
+ * @param value     The value to write
+ * @param buffer    The buffer to append to
+ */
+static void write_varint(Uint32 value, std::vector<Uint8>& buffer) {
+    while (value >= 0x80) {
+        buffer.push_back((Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((Uint8)value);
+}
+
+/**
+ * Returns the variable-length integer at the given position
+ *
+ * The position is advanced past the integer.  This function returns false
+ * if the integer runs past the end of the data.
+ *
+ * @param data      The encoded data
+ * @param size      The size of the encoded data
+ * @param pos       The position to read (advanced on success)
+ * @param value     Stores the decoded value
+ *
+ * @return true if the integer could be read
+ */
+static bool read_varint(const Uint8* data, size_t size, size_t& pos, Uint32& value) {
+    value = 0;
+    for(int shift = 0; shift < 32; shift += 7) {
+        if (pos >= size) {
+            return false;
+        }
+        Uint8 byte = data[pos++];
+        value |= (Uint32)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the little-endian 32-bit value at the given address
+ *
+ * @param data  The address to read
+ *
+ * @return the little-endian 32-bit value at the given address
+ */
+static inline Uint32 read_uint32(const Uint8* data) {
+    Uint32 value;
+    std::memcpy(&value, data, 4);
+    return SDL_SwapLE32(value);
+}
+
+/**
+ * Returns true if the two RGBA pixels differ by at most tolerance
+ *
+ * @param a         The first pixel
+ * @param b         The second pixel
+ * @param channels  The number of channels to compare
+ * @param tolerance The largest per-channel difference allowed
+ *
+ * @return true if the two RGBA pixels differ by at most tolerance
+ */
+static inline bool same_pixel(const Uint8* a, const Uint8* b, int channels, int tolerance) {
+    for(int ii = 0; ii < channels; ii++) {
+        if (std::abs((int)a[ii]-(int)b[ii]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Applies the encoded frame to the canvas
+ *
+ * The frame must cover every pixel of the canvas exactly.  This function
+ * returns false if the frame is corrupt.
+ *
+ * @param data      The encoded frame (after the frame type)
+ * @param size      The size of the encoded frame
+ * @param channels  The number of stored channels (3 or 4)
+ * @param canvas    The RGBA pixels to modify
+ * @param total     The number of pixels in the canvas
+ *
+ * @return true if the frame was applied successfully
+ */
+static bool apply_frame(const Uint8* data, size_t size, int channels, Uint8* canvas, size_t total) {
+    size_t pos = 0;
+    size_t pixel = 0;
+    while (pos < size) {
+        Uint32 token;
+        if (!read_varint(data, size, pos, token)) {
+            return false;
+        }
+        Uint32 kind  = token & 3;
+        size_t count = token >> 2;
+        if (count == 0 || pixel+count > total) {
+            return false;
+        }
+
+        Uint8* out = canvas+4*pixel;
+        switch (kind) {
+        case RUN_SKIP:
+            break;
+        case RUN_COPY:
+            if (pos+count*channels > size) {
+                return false;
+            } else if (channels == 4) {
+                std::memcpy(out, data+pos, 4*count);
+            } else {
+                const Uint8* src = data+pos;
+                for(size_t ii = 0; ii < count; ii++, src += 3, out += 4) {
+                    out[0] = src[0]; out[1] = src[1]; out[2] = src[2]; out[3] = 0xff;
+                }
+            }
+            pos += count*channels;
+            break;
+        case RUN_FILL:
+        {
+            if (pos+channels > size) {
+                return false;
+            }
+            Uint8 color[4] = { data[pos], data[pos+1], data[pos+2], 0xff };
+            if (channels == 4) {
+                color[3] = data[pos+3];
+            }
+            for(size_t ii = 0; ii < count; ii++, out += 4) {
+                std::memcpy(out, color, 4);
+            }
+            pos += channels;
+        }
+            break;
+        default:
+            return false;
+        }
+        pixel += count;
+    }
+    return pixel == total;
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this filmstrip.
+ *
+ * A disposed filmstrip can be safely reinitialized.
+ */
+void Filmstrip::dispose() {
+    _width  = 0;
+    _height = 0;
+    _alpha  = false;
+    _interval  = 0;
+    _tolerance = 0;
+    _mapping = nullptr;
+    _storage.clear();
+    _data = nullptr;
+    _frames.clear();
+    _canvas.clear();
+}
+
+/**
+ * Initializes an empty filmstrip for encoding frames.
+ *
+ * Frames are added to this filmstrip with {@link append}.  A key frame is
+ * inserted every interval frames.  If interval is 0, only the first frame
+ * is a key frame.  Shorter intervals make seeking faster, at the cost of
+ * a larger filmstrip.
+ *
+ * If tolerance is positive, the encoder is lossy.  A pixel whose channels
+ * differ by at most tolerance from the previous frame is left unchanged,
+ * and a run of pixels that differ by at most tolerance from each other is
+ * filled with a single color.  The encoder compares against the frames
+ * that the decoder will actually produce, so errors never accumulate
+ * beyond the tolerance.
+ *
+ * @param width     The frame width in pixels
+ * @param height    The frame height in pixels
+ * @param alpha     Whether to store the alpha channel
+ * @param interval  The number of frames between key frames
+ * @param tolerance The largest per-channel difference to ignore
+ *
+ * @return true if initialization was successful.
+ */
+bool Filmstrip::init(Uint32 width, Uint32 height, bool alpha, Uint32 interval, Uint8 tolerance) {
+    if (_width) {
+        CUAssertLog(false, "Filmstrip is already initialized");
+        return false; // In case asserts are off.
+    } else if (width == 0 || height == 0) {
+        return false;
+    }
+
+    _width  = width;
+    _height = height;
+    _alpha  = alpha;
+    _interval  = interval;
+    _tolerance = tolerance;
+    return true;
+}
+
+/**
+ * Initializes a filmstrip from the given file.
+ *
+ * The file is memory mapped, and the frame data is not copied.
+ *
+ * @param file  The path to the filmstrip file
+ *
+ * @return true if initialization was successful.
+ */
+bool Filmstrip::initWithFile(const std::string file) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::alloc(file);
+    return mapping != nullptr && initWithMapping(mapping);
+}
+
+/**
+ * Initializes a filmstrip from the given file contents.
+ *
+ * The frame data is not copied, and this filmstrip retains a reference to
+ * the mapping.
+ *
+ * @param mapping   The contents of a filmstrip file
+ *
+ * @return true if initialization was successful.
+ */
+bool Filmstrip::initWithMapping(const std::shared_ptr<MappedFile>& mapping) {
+    if (_width) {
+        CUAssertLog(false, "Filmstrip is already initialized");
+        return false; // In case asserts are off.
+    }
+
+    const Uint8* data = (const Uint8*)mapping->data();
+    size_t size = mapping->size();
+    if (size < FILM_HEADER || std::memcmp(data, FILM_IDENTIFIER, sizeof(FILM_IDENTIFIER)) != 0) {
+        CULogError("File '%s' is not a filmstrip", mapping->getName().c_str());
+        return false;
+    }
+
+    // Version, width, height, channels, frames, interval, reserved
+    Uint32 header[7];
+    for(int ii = 0; ii < 7; ii++) {
+        header[ii] = read_uint32(data+4*(ii+1));
+    }
+    if (header[0] != FILM_VERSION) {
+        CULogError("File '%s' has unsupported version %d", mapping->getName().c_str(), header[0]);
+        return false;
+    } else if (header[1] == 0 || header[2] == 0 || (header[3] != 3 && header[3] != 4)) {
+        CULogError("File '%s' has an invalid filmstrip header", mapping->getName().c_str());
+        return false;
+    }
+
+    Uint32 count = header[4];
+    size_t offset = FILM_HEADER+4*(size_t)count;
+    if (offset > size) {
+        CULogError("File '%s' is truncated", mapping->getName().c_str());
+        return false;
+    }
+
+    std::vector<std::pair<size_t,size_t>> entries;
+    entries.reserve(count);
+    for(Uint32 ii = 0; ii < count; ii++) {
+        size_t amount = read_uint32(data+FILM_HEADER+4*ii);
+        if (amount == 0 || offset+amount > size) {
+            CULogError("File '%s' has an invalid frame %d", mapping->getName().c_str(), ii);
+            return false;
+        }
+        entries.push_back(std::make_pair(offset,amount));
+        offset += amount;
+    }
+    if (count > 0 && data[entries[0].first] != FRAME_KEY) {
+        CULogError("File '%s' does not start with a key frame", mapping->getName().c_str());
+        return false;
+    }
+
+    _width  = header[1];
+    _height = header[2];
+    _alpha  = (header[3] == 4);
+    _interval = header[5];
+    _mapping  = mapping;
+    _data   = data;
+    _frames = std::move(entries);
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Returns true if the given frame is a key frame.
+ *
+ * A key frame may be decoded without the previous frame.
+ *
+ * @param frame The frame index
+ *
+ * @return true if the given frame is a key frame.
+ */
+bool Filmstrip::isKeyFrame(Uint32 frame) const {
+    if (frame >= _frames.size()) {
+        return false;
+    }
+    return _data[_frames[frame].first] == FRAME_KEY;
+}
+
+/**
+ * Returns the total size of the encoded frames in bytes.
+ *
+ * @return the total size of the encoded frames in bytes.
+ */
+size_t Filmstrip::getByteSize() const {
+    size_t total = 0;
+    for(auto it = _frames.begin(); it != _frames.end(); ++it) {
+        total += it->second;
+    }
+    return total;
+}
+
+
+#pragma mark -
+#pragma mark Conversion
+/**
+ * Appends a frame to the end of this filmstrip.
+ *
+ * The pixels must be stored row by row, with four bytes per pixel in
+ * the order red, green, blue, and alpha.  If this filmstrip has no alpha
+ * channel, the alpha values are ignored.  The frame is encoded as the
+ * difference from the previous frame, unless it is a key frame.
+ *
+ * This method may only be used on a filmstrip created with {@link init}.
+ *
+ * @param pixels    The RGBA pixels of the frame
+ *
+ * @return true if the frame was encoded.
+ */
+bool Filmstrip::append(const Uint8* pixels) {
+    if (_mapping != nullptr) {
+        CUAssertLog(false, "Cannot append to a filmstrip read from a file");
+        return false;
+    } else if (pixels == nullptr || _width == 0) {
+        return false;
+    }
+
+    Uint32 index = (Uint32)_frames.size();
+    bool key = (index == 0 || (_interval > 0 && index % _interval == 0));
+    int channels  = _alpha ? 4 : 3;
+    int tolerance = _tolerance;
+    size_t total  = (size_t)_width*_height;
+    if (_canvas.size() != 4*total) {
+        _canvas.assign(4*total, 0);
+    }
+
+    std::vector<Uint8> buffer;
+    buffer.push_back(key ? FRAME_KEY : FRAME_DELTA);
+
+    Uint8* canvas = _canvas.data();
+    size_t pixel = 0;
+    while (pixel < total) {
+        const Uint8* src = pixels+4*pixel;
+
+        // Pixels that the previous frame already gets right
+        size_t end = pixel;
+        if (!key) {
+            while (end < total && same_pixel(pixels+4*end, canvas+4*end, channels, tolerance)) {
+                end++;
+            }
+            if (end > pixel) {
+                write_varint((Uint32)(end-pixel) << 2 | RUN_SKIP, buffer);
+                pixel = end;
+                continue;
+            }
+        }
+
+        // Pixels that are (nearly) a single color
+        end = pixel+1;
+        while (end < total && same_pixel(pixels+4*end, src, channels, tolerance)) {
+            end++;
+        }
+        if (end-pixel >= MIN_FILL) {
+            write_varint((Uint32)(end-pixel) << 2 | RUN_FILL, buffer);
+            buffer.insert(buffer.end(), src, src+channels);
+            Uint8 color[4] = { src[0], src[1], src[2], (Uint8)(_alpha ? src[3] : 0xff) };
+            for(size_t ii = pixel; ii < end; ii++) {
+                std::memcpy(canvas+4*ii, color, 4);
+            }
+            pixel = end;
+            continue;
+        }
+
+        // Everything else, until a skip or fill run starts
+        end = pixel+1;
+        while (end < total) {
+            const Uint8* next = pixels+4*end;
+            size_t run = 0;
+            if (!key) {
+                while (run < MIN_SKIP && end+run < total &&
+                       same_pixel(pixels+4*(end+run), canvas+4*(end+run), channels, tolerance)) {
+                    run++;
+                }
+                if (run == MIN_SKIP || end+run == total) {
+                    break;
+                }
+            }
+            run = 1;
+            while (run < MIN_FILL && end+run < total &&
+                   same_pixel(pixels+4*(end+run), next, channels, tolerance)) {
+                run++;
+            }
+            if (run == MIN_FILL) {
+                break;
+            }
+            end++;
+        }
+
+        write_varint((Uint32)(end-pixel) << 2 | RUN_COPY, buffer);
+        for(size_t ii = pixel; ii < end; ii++) {
+            const Uint8* p = pixels+4*ii;
+            buffer.insert(buffer.end(), p, p+channels);
+            canvas[4*ii  ] = p[0];
+            canvas[4*ii+1] = p[1];
+            canvas[4*ii+2] = p[2];
+            canvas[4*ii+3] = _alpha ? p[3] : 0xff;
+        }
+        pixel = end;
+    }
+
+    _frames.push_back(std::make_pair(_storage.size(),buffer.size()));
+    _storage.insert(_storage.end(), buffer.begin(), buffer.end());
+    _data = _storage.data();
+    return true;
+}
+
+/**
+ * Decodes the given frame into the canvas.
+ *
+ * The canvas holds the RGBA pixels of the frame current, and this method
+ * advances it to the given frame.  If frame is after current, and there
+ * is no key frame in between, this method only decodes the frames after
+ * current.  Otherwise, it decodes from the last key frame at or before
+ * frame.  Hence it is most efficient to decode frames in order.
+ *
+ * If current is negative, the canvas is assumed to be uninitialized, and
+ * it will be resized to {@link getFrameSize}.  On success, current is set
+ * to frame.  On failure, current is set to -1.
+ *
+ * @param frame     The frame to decode
+ * @param canvas    The RGBA pixels of the current frame
+ * @param current   The frame currently stored in canvas
+ *
+ * @return true if the frame could be decoded.
+ */
+bool Filmstrip::decode(Uint32 frame, std::vector<Uint8>& canvas, Sint32& current) const {
+    if (frame >= _frames.size()) {
+        current = -1;
+        return false;
+    } else if (current == (Sint32)frame && canvas.size() == getFrameSize()) {
+        return true;
+    }
+
+    // Find the last key frame we cannot skip over
+    Uint32 start = frame;
+    while (start > 0 && !isKeyFrame(start)) {
+        start--;
+    }
+    if (current >= 0 && current < (Sint32)frame && start <= (Uint32)current &&
+        canvas.size() == getFrameSize()) {
+        start = current+1;
+    } else {
+        canvas.resize(getFrameSize());
+    }
+
+    int channels = _alpha ? 4 : 3;
+    size_t total = (size_t)_width*_height;
+    for(Uint32 ii = start; ii <= frame; ii++) {
+        const Uint8* data = _data+_frames[ii].first;
+        size_t size = _frames[ii].second;
+        if (!apply_frame(data+1, size-1, channels, canvas.data(), total)) {
+            CULogError("Filmstrip frame %d is corrupt", ii);
+            current = -1;
+            return false;
+        }
+    }
+    current = frame;
+    return true;
+}
+
+/**
+ * Saves this filmstrip to the given file.
+ *
+ * The file should have the extension ".film".  This method returns false
+ * if the file could not be written.
+ *
+ * @param file  The path to the filmstrip file
+ *
+ * @return true if the file was saved successfully.
+ */
+bool Filmstrip::save(const std::string file) const {
+    if (_frames.empty()) {
+        return false;
+    }
+
+    // Version, width, height, channels, frames, interval, reserved
+    Uint32 header[7] = {
+        FILM_VERSION, _width, _height, (Uint32)(_alpha ? 4 : 3),
+        (Uint32)_frames.size(), _interval, 0
+    };
+
+    std::string path = filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "wb");
+    if (!stream) {
+        CULogError("Could not open '%s' for writing",path.c_str());
+        return false;
+    }
+
+    bool success = SDL_RWwrite(stream, FILM_IDENTIFIER, 1, sizeof(FILM_IDENTIFIER)) == sizeof(FILM_IDENTIFIER);
+    for(int ii = 0; success && ii < 7; ii++) {
+        success = SDL_WriteLE32(stream, header[ii]) == 1;
+    }
+    for(auto it = _frames.begin(); success && it != _frames.end(); ++it) {
+        success = SDL_WriteLE32(stream, (Uint32)it->second) == 1;
+    }
+    for(auto it = _frames.begin(); success && it != _frames.end(); ++it) {
+        success = SDL_RWwrite(stream, _data+it->first, 1, it->second) == it->second;
+    }
+    SDL_RWclose(stream);
+    return success;
+}
@@ -45,6 +45,9 @@
 
 #include <deque>
 #include <algorithm>
+#include <cstring>
+#include <climits>
+#include <cmath>
 #include <utf8/utf8.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUFiletools.h>
@@ -56,6 +59,106 @@ using namespace cugl;
 /** The amount of border to put around a glyph to prevent bleeding. */
 #define GLYPH_BORDER    2
 
+/** The identifier at the start of every baked font file */
+static const char BAKED_IDENTIFIER[4] = { 'C', 'U', 'F', 'B' };
+/** The version of the baked font file format */
+#define BAKED_VERSION   1
+/** The number of 32-bit words in the header (after the identifier) */
+#define BAKED_WORDS     17
+/** The size of the header in bytes */
+#define BAKED_HEADER    (4+4*BAKED_WORDS)
+/** The number of 32-bit words in a glyph record */
+#define BAKED_GLYPH     10
+/** The number of 32-bit words in a kerning record */
+#define BAKED_KERNING   3
+/** The header flag for a distance field atlas */
+#define BAKED_DISTANCE  1
+/** The header flag for a fixed width font */
+#define BAKED_FIXED     2
+
+#pragma mark -
+#pragma mark Baking Helpers
+/**
+ * Returns the little-endian 32-bit value at the given address
+ *
+ * @param data  The address to read
+ *
+ * @return the little-endian 32-bit value at the given address
+ */
+static inline Uint32 read_uint32(const Uint8* data) {
+    Uint32 value;
+    std::memcpy(&value, data, 4);
+    return SDL_SwapLE32(value);
+}
+
+/**
+ * Appends a little-endian 32-bit value to the buffer
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The value to append
+ */
+static inline void write_uint32(std::vector<Uint8>& buffer, Uint32 value) {
+    value = SDL_SwapLE32(value);
+    const Uint8* bytes = (const Uint8*)&value;
+    buffer.insert(buffer.end(), bytes, bytes+4);
+}
+
+/**
+ * Returns the given font value scaled to a new font size
+ *
+ * @param value The value at the baked size
+ * @param scale The ratio of the new size to the baked size
+ *
+ * @return the given font value scaled to a new font size
+ */
+static inline int scale_metric(int value, float scale) {
+    return (int)std::lround(value*scale);
+}
+
+/**
+ * Writes the signed distance field of a glyph cell into the output atlas.
+ *
+ * The glyph is the set of pixels in the cell with coverage at least one
+ * half. Each output pixel stores the distance to the glyph edge, mapped
+ * so that 128 is the edge, 255 is spread pixels inside, and 0 is spread
+ * pixels outside.  The search never leaves the cell, so neighboring
+ * glyphs in the atlas do not bleed into each other.
+ *
+ * @param coverage  The coverage (alpha) of the rasterized atlas
+ * @param output    The distance field atlas
+ * @param width     The width of the atlas
+ * @param x0        The left edge of the cell
+ * @param y0        The top edge of the cell
+ * @param x1        The right edge of the cell (exclusive)
+ * @param y1        The bottom edge of the cell (exclusive)
+ * @param spread    The distance at which the field is clamped
+ */
+static void bake_distance(const Uint8* coverage, Uint8* output, int width,
+                          int x0, int y0, int x1, int y1, int spread) {
+    int limit = spread*spread;
+    for(int yy = y0; yy < y1; yy++) {
+        for(int xx = x0; xx < x1; xx++) {
+            bool inside = coverage[yy*width+xx] >= 128;
+            int best = limit+1;
+            int top = std::max(y0,yy-spread), bottom = std::min(y1,yy+spread+1);
+            int left = std::max(x0,xx-spread), right = std::min(x1,xx+spread+1);
+            for(int jj = top; jj < bottom; jj++) {
+                for(int ii = left; ii < right; ii++) {
+                    if ((coverage[jj*width+ii] >= 128) != inside) {
+                        int dist = (ii-xx)*(ii-xx)+(jj-yy)*(jj-yy);
+                        best = std::min(best,dist);
+                    }
+                }
+            }
+            // The edge is halfway between a pixel and its opposite neighbor
+            float dist = (best > limit ? (float)spread : std::sqrt((float)best)-0.5f);
+            dist = (inside ? dist : -dist)/(2.0f*spread)+0.5f;
+            dist = std::max(0.0f,std::min(1.0f,dist));
+            output[yy*width+xx] = (Uint8)std::lround(dist*255);
+        }
+    }
+}
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -79,7 +182,9 @@ _style(Style::NORMAL),
 _hints(Hinting::NORMAL),
 _render(Resolution::BLENDED),
 _hasAtlas(false),
-_surface(nullptr) { }
+_surface(nullptr),
+_distance(false),
+_atlasScale(1.0f) { }
 
 /**
  * Deletes the font resources and resets all attributes.
@@ -104,6 +209,8 @@ void Font::dispose() {
     _hints  = Hinting::NORMAL;
     _render = Resolution::BLENDED;
     _hasAtlas = false;
+    _distance = false;
+    _atlasScale = 1.0f;
     _texture = nullptr;
     _glyphset.clear();
     _glyphsize.clear();
@@ -124,7 +231,7 @@ void Font::dispose() {
  * @return true if initialization is successful.
  */
 bool Font::init(const std::string file, int size) {
-    if (_data != nullptr) {
+    if (_data != nullptr || isBaked()) {
         CUAssertLog(false,"Font %s already loaded", _name.c_str());
         return false;
     }
@@ -150,6 +257,156 @@ bool Font::init(const std::string file, int size) {
     return true;
 }
 
+/**
+ * Initializes a font from the given baked font file.
+ *
+ * A baked font file is produced by {@link bake}, and contains the atlas,
+ * the glyph metrics, and the kerning of a font.  The font is ready to
+ * draw once {@link getAtlas()} is called in the main thread.  There is no
+ * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+ * and resolution cannot be changed.
+ *
+ * If size is 0, the font has the size at which it was baked.  Otherwise,
+ * the bake must either have that size, or be a distance field.  A distance
+ * field is scaled to the requested size.
+ *
+ * @param file  The path to the baked font file
+ * @param size  The font size in points (0 for the baked size)
+ *
+ * @return true if initialization is successful.
+ */
+bool Font::initWithBaked(const std::string file, int size) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::alloc(file);
+    if (mapping == nullptr) {
+        CULogError("Could not read baked font '%s'", file.c_str());
+        return false;
+    }
+    return initWithBaked(mapping, size);
+}
+
+/**
+ * Initializes a font from the given baked font contents.
+ *
+ * A baked font file is produced by {@link bake}, and contains the atlas,
+ * the glyph metrics, and the kerning of a font.  The font is ready to
+ * draw once {@link getAtlas()} is called in the main thread.  There is no
+ * TrueType data, so the atlas cannot be rebuilt, and the style, hinting,
+ * and resolution cannot be changed.
+ *
+ * If size is 0, the font has the size at which it was baked.  Otherwise,
+ * the bake must either have that size, or be a distance field.  A distance
+ * field is scaled to the requested size.
+ *
+ * @param mapping   The contents of a baked font file
+ * @param size      The font size in points (0 for the baked size)
+ *
+ * @return true if initialization is successful.
+ */
+bool Font::initWithBaked(const std::shared_ptr<MappedFile>& mapping, int size) {
+    if (_data != nullptr || isBaked()) {
+        CUAssertLog(false,"Font %s already loaded", _name.c_str());
+        return false;
+    }
+    
+    const Uint8* data = (const Uint8*)mapping->data();
+    size_t total = mapping->size();
+    const char* name = mapping->getName().c_str();
+    if (total < BAKED_HEADER || std::memcmp(data, BAKED_IDENTIFIER, sizeof(BAKED_IDENTIFIER)) != 0) {
+        CULogError("File '%s' is not a baked font", name);
+        return false;
+    }
+    
+    // Version, size, flags, spread, height, ascent, descent, line skip, style,
+    // hinting, atlas width, atlas height, glyphs, kerning pairs, name lengths
+    Uint32 header[BAKED_WORDS];
+    for(int ii = 0; ii < BAKED_WORDS; ii++) {
+        header[ii] = read_uint32(data+4*(ii+1));
+    }
+    if (header[0] != BAKED_VERSION) {
+        CULogError("File '%s' has unsupported version %d", name, header[0]);
+        return false;
+    } else if (header[1] == 0 || header[10] == 0 || header[11] == 0) {
+        CULogError("File '%s' has an invalid font header", name);
+        return false;
+    }
+    
+    Uint32 baked = header[1];
+    bool distance = (header[2] & BAKED_DISTANCE) != 0;
+    if (size <= 0) {
+        size = (int)baked;
+    } else if ((Uint32)size != baked && !distance) {
+        CULogError("File '%s' was baked at size %d, not %d", name, baked, size);
+        return false;
+    }
+    
+    size_t strings = ((size_t)header[14]+header[15]+3) & ~(size_t)3;
+    size_t glyphs  = BAKED_HEADER+strings;
+    size_t kerning = glyphs+4*BAKED_GLYPH*(size_t)header[12];
+    size_t pixels  = kerning+4*BAKED_KERNING*(size_t)header[13];
+    if (pixels+(size_t)header[10]*header[11] > total) {
+        CULogError("File '%s' is truncated", name);
+        return false;
+    }
+    
+    int width  = (int)header[10];
+    int height = (int)header[11];
+    _surface = allocSurface(width, height);
+    if (_surface == nullptr) {
+        CULogError("Could not allocate an atlas for '%s'", name);
+        return false;
+    }
+    
+    // The atlas only stores alpha, as every glyph is white
+    Uint32 white = _surface->format->Rmask | _surface->format->Gmask | _surface->format->Bmask;
+    const Uint8* alpha = data+pixels;
+    for(int yy = 0; yy < height; yy++) {
+        Uint32* row = (Uint32*)((Uint8*)_surface->pixels+yy*_surface->pitch);
+        for(int xx = 0; xx < width; xx++) {
+            row[xx] = white | ((Uint32)alpha[yy*width+xx] << _surface->format->Ashift);
+        }
+    }
+    
+    // The atlas rectangles stay in atlas pixels; the metrics are scaled
+    float scale = (float)size/(float)baked;
+    const Uint8* record = data+glyphs;
+    for(Uint32 ii = 0; ii < header[12]; ii++, record += 4*BAKED_GLYPH) {
+        Uint32 thechar = read_uint32(record);
+        Metrics metrics;
+        metrics.minx = scale_metric((Sint32)read_uint32(record+4),scale);
+        metrics.maxx = scale_metric((Sint32)read_uint32(record+8),scale);
+        metrics.miny = scale_metric((Sint32)read_uint32(record+12),scale);
+        metrics.maxy = scale_metric((Sint32)read_uint32(record+16),scale);
+        metrics.advance = scale_metric((Sint32)read_uint32(record+20),scale);
+        _glyphsize.emplace(thechar,metrics);
+        _glyphmap.emplace(thechar,Rect((float)read_uint32(record+24), (float)read_uint32(record+28),
+                                       (float)read_uint32(record+32), (float)read_uint32(record+36)));
+        _glyphset.push_back(thechar);
+    }
+    
+    record = data+kerning;
+    for(Uint32 ii = 0; ii < header[13]; ii++, record += 4*BAKED_KERNING) {
+        int amount = scale_metric((Sint32)read_uint32(record+8),scale);
+        if (amount != 0) {
+            _kernmap[read_uint32(record)].emplace(read_uint32(record+4),(Uint32)amount);
+        }
+    }
+    
+    _name = std::string((const char*)data+BAKED_HEADER, header[14]);
+    _stylename = std::string((const char*)data+BAKED_HEADER+header[14], header[15]);
+    _size = size;
+    _fontHeight   = scale_metric((Sint32)header[4],scale);
+    _fontAscent   = scale_metric((Sint32)header[5],scale);
+    _fontDescent  = scale_metric((Sint32)header[6],scale);
+    _fontLineSkip = scale_metric((Sint32)header[7],scale);
+    _fixedWidth   = (header[2] & BAKED_FIXED) != 0;
+    _style = (Style)header[8];
+    _hints = (Hinting)header[9];
+    _distance = distance;
+    _atlasScale = 1.0f/scale;
+    _hasAtlas = true;
+    return true;
+}
+
 
 
 #pragma mark -
@@ -217,7 +474,9 @@ bool Font::hasString(const std::string text) const {
  */
 void Font::setKerning(bool kerning) {
     _useKerning = kerning;
-    TTF_SetFontKerning(_data, _useKerning);
+    if (_data != nullptr) {
+        TTF_SetFontKerning(_data, _useKerning);
+    }
 }
 
 
@@ -228,7 +487,7 @@ void Font::setKerning(bool kerning) {
  * Sets the style for this font.
  *
  * Changing this value will delete any atlas that is present.  The atlas
- * must be regenerated.
+ * must be regenerated.  This value cannot be changed on a baked font.
  *
  * With the exception of normal style (which is an absent of any style), all
  * of the styles may be combined.  So it is possible to have a bold, italic,
@@ -238,6 +497,10 @@ void Font::setKerning(bool kerning) {
  * @param style The style for this font.
  */
 void Font::setStyle(Style style) {
+    if (isBaked()) {
+        CULogError("The style of baked font %s cannot be changed", _name.c_str());
+        return;
+    }
     clearAtlas(); _style = style;
     TTF_SetFontStyle(_data, (int)style);
 }
@@ -246,7 +509,7 @@ void Font::setStyle(Style style) {
  * Sets the rasterization hints
  *
  * Changing this value will delete any atlas that is present.  The atlas
- * must be regenerated.
+ * must be regenerated.  This value cannot be changed on a baked font.
  *
  * Hinting is used to align the font to a rasterized grid. At low screen
  * resolutions, hinting is critical for producing clear, legible text
@@ -255,6 +518,10 @@ void Font::setStyle(Style style) {
  * @param hinting   The rasterization hints
  */
 void Font::setHinting(Hinting hinting) {
+    if (isBaked()) {
+        CULogError("The hinting of baked font %s cannot be changed", _name.c_str());
+        return;
+    }
     clearAtlas(); _hints = hinting;
     TTF_SetFontHinting(_data, (int)hinting);
 }
@@ -301,7 +568,7 @@ unsigned int Font::getKerning(Uint32 a, Uint32 b) const {
     if (_hasAtlas) {
         CUAssertLog(_glyphmap.find(a) != _glyphmap.end(), "Character '%c' is not supported", a);
         CUAssertLog(_glyphmap.find(b) != _glyphmap.end(), "Character '%c' is not supported", b);
-        return _kernmap.at(a).at(b);
+        return getAtlasKerning(a, b);
     }
     
     CUAssertLog(TTF_GlyphIsProvided(_data, (Uint16)a), "Character '%c' is not supported", a);
@@ -384,8 +651,14 @@ Rect Font::getInternalBounds(const std::string text, bool utf8) const {
  * Deletes the current atlas
  *
  * The font will use direct rendering until a new atlas is created.
+ *
+ * A baked font cannot render without its atlas, so this method does
+ * nothing if the font was baked.
  */
 void Font::clearAtlas() {
+    if (isBaked()) {
+        return;
+    }
     if (_surface != nullptr) { SDL_FreeSurface(_surface); _surface = nullptr;   }
     _texture = nullptr;
     _glyphmap.clear();
@@ -468,6 +741,120 @@ const std::shared_ptr<Texture>& Font::getAtlas() {
 
 }
 
+/**
+ * Saves the atlas, glyph metrics, and kerning of this font to a file.
+ *
+ * The file can be read with {@link initWithBaked}.  It should have the
+ * extension ".font".  This method must be called after one of the methods
+ * {@link buildAtlasAsync} and before {@link getAtlas}, as the atlas pixels
+ * cannot be read back from the OpenGL texture.  This method does not use
+ * OpenGL, and so is safe for offline tools.
+ *
+ * If spread is positive, the atlas is saved as a signed distance field.
+ * The spread is the distance (in atlas pixels) at which the field is
+ * clamped.  A distance field should be baked at a large size with no
+ * hinting, so that it can be scaled to any size when loaded.
+ *
+ * @param file      The path to the baked font file
+ * @param spread    The distance field spread (0 for a coverage atlas)
+ *
+ * @return true if the file was saved successfully.
+ */
+bool Font::bake(const std::string file, Uint32 spread) const {
+    if (isBaked()) {
+        CULogError("Font %s is already baked", _name.c_str());
+        return false;
+    } else if (!_hasAtlas || _surface == nullptr) {
+        CULogError("Font %s has no atlas surface to bake", _name.c_str());
+        return false;
+    }
+    
+    int width  = _surface->w;
+    int height = _surface->h;
+    std::vector<Uint8> coverage((size_t)width*height);
+    for(int yy = 0; yy < height; yy++) {
+        const Uint32* row = (const Uint32*)((const Uint8*)_surface->pixels+yy*_surface->pitch);
+        for(int xx = 0; xx < width; xx++) {
+            coverage[yy*width+xx] = (Uint8)((row[xx] & _surface->format->Amask) >> _surface->format->Ashift);
+        }
+    }
+    
+    std::vector<Uint8> atlas;
+    if (spread == 0) {
+        atlas.swap(coverage);
+    } else {
+        // Keep the 2-patch, and give each glyph a one pixel margin of its border
+        atlas.resize(coverage.size(),0);
+        atlas[0] = atlas[1] = atlas[width] = atlas[width+1] = 255;
+        for(auto it = _glyphset.begin(); it != _glyphset.end(); ++it) {
+            const Rect& bounds = _glyphmap.at(*it);
+            int x0 = std::max(0,(int)bounds.origin.x-GLYPH_BORDER/2);
+            int y0 = std::max(0,(int)bounds.origin.y-GLYPH_BORDER/2);
+            int x1 = std::min(width, (int)(bounds.origin.x+bounds.size.width)+GLYPH_BORDER/2);
+            int y1 = std::min(height,(int)(bounds.origin.y+bounds.size.height)+GLYPH_BORDER/2);
+            bake_distance(coverage.data(), atlas.data(), width, x0, y0, x1, y1, (int)spread);
+        }
+    }
+    
+    // Only the nonzero kerning pairs are stored
+    std::vector<Uint32> pairs;
+    for(auto it = _glyphset.begin(); it != _glyphset.end(); ++it) {
+        for(auto jt = _glyphset.begin(); jt != _glyphset.end(); ++jt) {
+            int amount = getAtlasKerning(*it, *jt);
+            if (amount != 0) {
+                pairs.push_back(*it);
+                pairs.push_back(*jt);
+                pairs.push_back((Uint32)amount);
+            }
+        }
+    }
+    
+    Uint32 flags = (spread ? BAKED_DISTANCE : 0) | (_fixedWidth ? BAKED_FIXED : 0);
+    Uint32 header[BAKED_WORDS] = {
+        BAKED_VERSION, (Uint32)_size, flags, spread,
+        _fontHeight, _fontAscent, _fontDescent, _fontLineSkip,
+        (Uint32)_style, (Uint32)_hints, (Uint32)width, (Uint32)height,
+        (Uint32)_glyphset.size(), (Uint32)(pairs.size()/BAKED_KERNING),
+        (Uint32)_name.size(), (Uint32)_stylename.size(), 0
+    };
+    
+    std::vector<Uint8> buffer(BAKED_IDENTIFIER, BAKED_IDENTIFIER+sizeof(BAKED_IDENTIFIER));
+    for(int ii = 0; ii < BAKED_WORDS; ii++) {
+        write_uint32(buffer, header[ii]);
+    }
+    buffer.insert(buffer.end(), _name.begin(), _name.end());
+    buffer.insert(buffer.end(), _stylename.begin(), _stylename.end());
+    buffer.resize((buffer.size()+3) & ~(size_t)3, 0);
+    for(auto it = _glyphset.begin(); it != _glyphset.end(); ++it) {
+        const Metrics& metrics = _glyphsize.at(*it);
+        const Rect& bounds = _glyphmap.at(*it);
+        write_uint32(buffer, *it);
+        write_uint32(buffer, (Uint32)metrics.minx);
+        write_uint32(buffer, (Uint32)metrics.maxx);
+        write_uint32(buffer, (Uint32)metrics.miny);
+        write_uint32(buffer, (Uint32)metrics.maxy);
+        write_uint32(buffer, (Uint32)metrics.advance);
+        write_uint32(buffer, (Uint32)bounds.origin.x);
+        write_uint32(buffer, (Uint32)bounds.origin.y);
+        write_uint32(buffer, (Uint32)bounds.size.width);
+        write_uint32(buffer, (Uint32)bounds.size.height);
+    }
+    for(auto it = pairs.begin(); it != pairs.end(); ++it) {
+        write_uint32(buffer, *it);
+    }
+    buffer.insert(buffer.end(), atlas.begin(), atlas.end());
+    
+    std::string path = filetool::normalize_path(file);
+    SDL_RWops* stream = SDL_RWFromFile(path.c_str(), "wb");
+    if (!stream) {
+        CULogError("Could not open '%s' for writing",path.c_str());
+        return false;
+    }
+    bool success = SDL_RWwrite(stream, buffer.data(), 1, buffer.size()) == buffer.size();
+    SDL_RWclose(stream);
+    return success;
+}
+
 #pragma mark -
 #pragma mark Rendering
 /**
@@ -800,7 +1187,7 @@ void Font::getAtlasMesh(const std::string text, const Vec2 origin, const Rect re
     if (!utf8) {
         for(int ii = 0; ii < line.size(); ii++) {
             if (ii > 0) {
-                offset.x -= _kernmap[line[ii-1]][line[ii]];
+                offset.x -= getAtlasKerning(line[ii-1], line[ii]);
             }
             ii = (getAtlasQuad(line[ii],offset,rect,mesh) ? ii+1 : (int)line.size());
         }
@@ -814,7 +1201,7 @@ void Font::getAtlasMesh(const std::string text, const Vec2 origin, const Rect re
     
     for(int ii = 0; ii < utf32.size();) {
         if (ii > 0) {
-            offset.x -= _kernmap[utf32[ii-1]][utf32[ii]];
+            offset.x -= getAtlasKerning(utf32[ii-1], utf32[ii]);
         }
         ii = (getAtlasQuad(utf32[ii],offset,rect,mesh) ? ii+1 : (int)utf32.size());
     }
@@ -959,25 +1346,28 @@ bool Font::getAtlasQuad(Uint32 thechar, Vec2& offset, const Rect rect, Mesh<Spri
     // Technically, this answer is correct
     if (!hasGlyph(thechar)) { return true; }
     
+    // Bounds are in atlas pixels, which are scaled if the atlas was baked
     Rect bounds = _glyphmap[thechar];
-    Rect quad(offset,bounds.size);
+    Rect quad(offset,bounds.size/_atlasScale);
+    float advance = (float)_glyphsize[thechar].advance;
     
     // Skip over glyph, but recognize we may have later glyphs
     if (!rect.doesIntersect(quad)) {
-        offset.x += bounds.size.width;
+        offset.x += advance;
         return quad.getMaxX() <= rect.getMaxX();
     }
     
     // Compute intersection and adjust cookie cutter
+    float full = quad.size.height;
     quad.intersect(rect);
     bool result = quad.getMaxX() <= rect.getMaxX();
     
     // REMEMBER! Bounds and rect have different y-orientations.
-    bounds.origin.x += quad.origin.x-offset.x;
-    bounds.origin.y -= quad.origin.y+quad.size.height-offset.y-bounds.size.height;
+    bounds.origin.x += (quad.origin.x-offset.x)*_atlasScale;
+    bounds.origin.y -= (quad.origin.y+quad.size.height-offset.y-full)*_atlasScale;
     
-    offset.x += bounds.size.width;
-    bounds.size = quad.size;
+    offset.x += advance;
+    bounds.size = quad.size*_atlasScale;
     
     int width  = _texture->getWidth();
     int height = _texture->getHeight();
@@ -994,14 +1384,14 @@ bool Font::getAtlasQuad(Uint32 thechar, Vec2& offset, const Rect rect, Mesh<Spri
     
     // Bottom right
     temp.position = quad.origin;
-    temp.position.x += bounds.size.width;
+    temp.position.x += quad.size.width;
     temp.color = Color4::WHITE;
     temp.texcoord.x = (bounds.origin.x+bounds.size.width)/(float)width;
     temp.texcoord.y = (bounds.origin.y+bounds.size.height)/(float)height;
     mesh.vertices.push_back(temp);
     
     // Top right
-    temp.position = quad.origin+bounds.size;
+    temp.position = quad.origin+quad.size;
     temp.color = Color4::WHITE;
     temp.texcoord.x = (bounds.origin.x+bounds.size.width)/(float)width;
     temp.texcoord.y = bounds.origin.y/(float)height;
@@ -1009,7 +1399,7 @@ bool Font::getAtlasQuad(Uint32 thechar, Vec2& offset, const Rect rect, Mesh<Spri
     
     // Top left
     temp.position = quad.origin;
-    temp.position.y += bounds.size.height;
+    temp.position.y += quad.size.height;
     temp.color = Color4::WHITE;
     temp.texcoord.x = bounds.origin.x/(float)width;
     temp.texcoord.y = bounds.origin.y/(float)height;
@@ -1163,7 +1553,7 @@ void Font::getAtlasMesh(const std::string text, const Vec2 origin, const Rect re
     if (!utf8) {
         for(int ii = 0; ii < line.size(); ii++) {
             if (ii > 0) {
-                offset.x -= _kernmap[line[ii-1]][line[ii]];
+                offset.x -= getAtlasKerning(line[ii-1], line[ii]);
             }
             ii = (getAtlasQuad(line[ii],offset,rect,mesh,z) ? ii+1 : (int)line.size());
         }
@@ -1177,7 +1567,7 @@ void Font::getAtlasMesh(const std::string text, const Vec2 origin, const Rect re
     
     for(int ii = 0; ii < utf32.size();) {
         if (ii > 0) {
-            offset.x -= _kernmap[utf32[ii-1]][utf32[ii]];
+            offset.x -= getAtlasKerning(utf32[ii-1], utf32[ii]);
         }
         ii = (getAtlasQuad(utf32[ii],offset,rect,mesh,z) ? ii+1 : (int)utf32.size());
     }
@@ -1330,25 +1720,28 @@ bool Font::getAtlasQuad(Uint32 thechar, Vec2& offset, const Rect rect, Mesh<Spri
     // Technically, this answer is correct
     if (!hasGlyph(thechar)) { return true; }
     
+    // Bounds are in atlas pixels, which are scaled if the atlas was baked
     Rect bounds = _glyphmap[thechar];
-    Rect quad(offset,bounds.size);
+    Rect quad(offset,bounds.size/_atlasScale);
+    float advance = (float)_glyphsize[thechar].advance;
     
     // Skip over glyph, but recognize we may have later glyphs
     if (!rect.doesIntersect(quad)) {
-        offset.x += bounds.size.width;
+        offset.x += advance;
         return quad.getMaxX() <= rect.getMaxX();
     }
     
     // Compute intersection and adjust cookie cutter
+    float full = quad.size.height;
     quad.intersect(rect);
     bool result = quad.getMaxX() <= rect.getMaxX();
     
     // REMEMBER! Bounds and rect have different y-orientations.
-    bounds.origin.x += quad.origin.x-offset.x;
-    bounds.origin.y -= quad.origin.y+quad.size.height-offset.y-bounds.size.height;
+    bounds.origin.x += (quad.origin.x-offset.x)*_atlasScale;
+    bounds.origin.y -= (quad.origin.y+quad.size.height-offset.y-full)*_atlasScale;
     
-    offset.x += bounds.size.width;
-    bounds.size = quad.size;
+    offset.x += advance;
+    bounds.size = quad.size*_atlasScale;
     
     int width  = _texture->getWidth();
     int height = _texture->getHeight();
@@ -1544,7 +1937,7 @@ Size Font::getSizeASCII(const std::string text) const {
     for(int ii = 0; ii < text.size(); ii++) {
         if (hasGlyph(text[ii])) {
             if (ii > 0) {
-                result.width -= _kernmap.at((Uint32)text[ii-1]).at((Uint32)text[ii]);
+                result.width -= getAtlasKerning((Uint32)text[ii-1], (Uint32)text[ii]);
             }
             result.width += _glyphsize.at((Uint32)text[ii]).advance;
         }
@@ -1589,7 +1982,7 @@ Size Font::getSizeUTF8(const std::string text) const {
     for(int ii = 0; ii < utf32.size(); ii++) {
         if (hasGlyph(utf32[ii])) {
             if (ii > 0 && hasGlyph(utf32[ii-1])) {
-                result.width -= _kernmap.at(utf32[ii-1]).at(utf32[ii]);
+                result.width -= getAtlasKerning(utf32[ii-1], utf32[ii]);
             }
             result.width += _glyphsize.at(utf32[ii]).advance;
         }
@@ -1661,7 +2054,7 @@ Rect Font::getInternalBoundsASCII(const std::string text) const {
     for(int ii = first+1; ii < text.size(); ii++) {
         Uint32 ch = (Uint32)text[ii];
         if (hasGlyph(ch)) {
-            result.size.width -= _kernmap.at(last).at(ch);
+            result.size.width -= (_hasAtlas ? getAtlasKerning(last, ch) : computeKerning(last, ch));
             metrics = (_hasAtlas ? _glyphsize.at(ch) : computeMetrics(ch));
             result.size.width += metrics.advance;
             maxy = (metrics.maxy > maxy ? metrics.maxy : maxy);
@@ -1749,7 +2142,7 @@ Rect Font::getInternalBoundsUTF8(const std::string text) const {
     for(int ii = first+1; ii < utf32.size(); ii++) {
         Uint32 ch = utf32[ii];
         if (hasGlyph(ch)) {
-            result.size.width -= (_hasAtlas ? _kernmap.at(last).at(ch) : computeKerning(last, ch));
+            result.size.width -= (_hasAtlas ? getAtlasKerning(last, ch) : computeKerning(last, ch));
             metrics = (_hasAtlas ? _glyphsize.at(ch) : computeMetrics(ch));
             result.size.width += metrics.advance;
             maxy = (metrics.maxy > maxy ? metrics.maxy : maxy);
@@ -1847,12 +2240,17 @@ int Font::prepareAtlas(std::string charset) {
 
 /**
  * Gathers the kerning information for the atlas.
+ *
+ * Only the pairs with nonzero kerning are stored.  Use the method
+ * {@link getAtlasKerning} to look up a pair.
  */
 void Font::prepareAtlasKerning() {
     for(auto it = _glyphset.begin(); it != _glyphset.end(); ++it) {
-        _kernmap.emplace(*it, std::unordered_map<Uint32, Uint32>());
         for(auto jt = _glyphset.begin(); jt != _glyphset.end(); ++jt) {
-            _kernmap[*it].emplace(*jt, computeKerning(*it, *jt));
+            int kerning = computeKerning(*it, *jt);
+            if (kerning != 0) {
+                _kernmap[*it].emplace(*jt, (Uint32)kerning);
+            }
         }
     }
 }
@@ -1909,6 +2307,26 @@ int Font::computeKerning(Uint32 a, Uint32 b) const {
     return w2-w1;
 }
 
+/**
+ * Returns the kerning between the two characters in the atlas.
+ *
+ * The atlas only stores pairs with nonzero kerning, so this method
+ * returns 0 for any pair that is missing.
+ *
+ * @param a     The first character in the pair
+ * @param b     The second character in the pair
+ *
+ * @return the kerning between the two characters in the atlas.
+ */
+int Font::getAtlasKerning(Uint32 a, Uint32 b) const {
+    auto it = _kernmap.find(a);
+    if (it == _kernmap.end()) {
+        return 0;
+    }
+    auto jt = it->second.find(b);
+    return (jt == it->second.end() ? 0 : (int)jt->second);
+}
+
 /**
  * Computes the size of the atlas texture
  *
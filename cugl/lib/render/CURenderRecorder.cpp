@@ -0,0 +1,177 @@
+//
+//  CURenderRecorder.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorder for the OpenGL command stream. Every
+//  rendering class (SpriteBatch, VertexBuffer, Shader, Texture, RenderTarget)
+//  reports its draw calls, uploads, and binds to this recorder. This allows
+//  us to measure the cost of a frame (in draw calls and bytes) independent
+//  of the speed of the GPU.
+//
+//  In addition, the recorder can be put in headless mode. In this mode, the
+//  rendering classes record their commands but never touch OpenGL. Handles
+//  and bindings are simulated by the recorder instead. This allows the
+//  render paths to run on machines with no graphics card (or no display).
+//
+//  This class is a collection of static methods. It should never be
+//  instantiated.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+#include <cugl/render/CURenderRecorder.h>
+#include <sstream>
+
+using namespace cugl;
+
+/** Whether the recorder is headless */
+bool RenderRecorder::_headless = false;
+/** Whether the recorder is capturing the command stream */
+bool RenderRecorder::_capturing = false;
+/** The accumulated counts */
+RenderRecorder::Counts RenderRecorder::_counts;
+/** The captured command stream */
+std::vector<RenderRecorder::Entry> RenderRecorder::_commands;
+/** The next available simulated handle */
+GLuint RenderRecorder::_nexthandle = 1;
+/** The simulated bindings, keyed by target and index (headless only) */
+std::unordered_map<Uint64,GLuint> RenderRecorder::_bindings;
+/** The simulated viewport (headless only) */
+GLint RenderRecorder::_viewport[4] = {0, 0, 0, 0};
+
+#pragma mark Counts
+/**
+ * Sets all of the counts to 0.
+ */
+void RenderRecorder::Counts::clear() {
+    drawCalls = 0;
+    indices = 0;
+    vertices = 0;
+    bytesUploaded = 0;
+    stateChanges = 0;
+    textureBinds = 0;
+    shaderBinds = 0;
+    targetSwitches = 0;
+}
+
+/**
+ * Returns a string representation of these counts for debugging.
+ *
+ * @return a string representation of these counts for debugging.
+ */
+std::string RenderRecorder::Counts::toString() const {
+    std::stringstream ss;
+    ss << "[draws=" << drawCalls << ",indices=" << indices;
+    ss << ",vertices=" << vertices << ",bytes=" << bytesUploaded;
+    ss << ",states=" << stateChanges << ",textures=" << textureBinds;
+    ss << ",shaders=" << shaderBinds << ",targets=" << targetSwitches << "]";
+    return ss.str();
+}
+
+#pragma mark -
+#pragma mark Headless Mode
+/**
+ * Sets whether the rendering classes are headless.
+ *
+ * In headless mode, no rendering class will make an OpenGL call. This
+ * value must be set before any graphics objects are allocated. Objects
+ * allocated in one mode cannot be used in the other.
+ *
+ * @param value Whether the rendering classes are headless.
+ */
+void RenderRecorder::setHeadless(bool value) {
+    _headless = value;
+    _bindings.clear();
+    for(int ii = 0; ii < 4; ii++) {
+        _viewport[ii] = 0;
+    }
+}
+
+/**
+ * Returns the simulated binding for the given target.
+ *
+ * The target should be the OpenGL query enum for that binding, such as
+ * GL_CURRENT_PROGRAM or GL_VERTEX_ARRAY_BINDING. Indexed targets (like
+ * GL_TEXTURE_BINDING_2D) use the bind point as the index. If nothing is
+ * bound, this returns 0.
+ *
+ * @param target    The binding target
+ * @param index     The binding index
+ *
+ * @return the simulated binding for the given target.
+ */
+GLuint RenderRecorder::getBinding(GLenum target, GLuint index) {
+    auto it = _bindings.find(((Uint64)target << 32) | index);
+    return it == _bindings.end() ? 0 : it->second;
+}
+
+/**
+ * Stores the simulated viewport in the given array.
+ *
+ * The array must have room for 4 values, which are stored in the same
+ * order as the GL_VIEWPORT query.
+ *
+ * @param viewport  The array to store the viewport
+ */
+void RenderRecorder::getViewport(GLint* viewport) {
+    for(int ii = 0; ii < 4; ii++) {
+        viewport[ii] = _viewport[ii];
+    }
+}
+
+/**
+ * Sets the simulated viewport.
+ *
+ * @param x         The viewport left
+ * @param y         The viewport bottom
+ * @param width     The viewport width
+ * @param height    The viewport height
+ */
+void RenderRecorder::setViewport(GLint x, GLint y, GLint width, GLint height) {
+    _viewport[0] = x;
+    _viewport[1] = y;
+    _viewport[2] = width;
+    _viewport[3] = height;
+}
+
+#pragma mark -
+#pragma mark Command Stream
+/**
+ * Resets the command counts and clears the captured command stream.
+ */
+void RenderRecorder::reset() {
+    _counts.clear();
+    _commands.clear();
+}
+
+/**
+ * Appends a command to the command stream if capturing.
+ *
+ * @param type  The command type
+ * @param mode  The OpenGL enum for the command
+ * @param value The command value
+ */
+void RenderRecorder::capture(Command type, GLenum mode, Uint64 value) {
+    Entry entry;
+    entry.type  = type;
+    entry.mode  = mode;
+    entry.value = value;
+    _commands.push_back(entry);
+}
@@ -42,6 +42,7 @@
 
 #include <cugl/render/CURenderTarget.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CURenderRecorder.h>
 #include <cugl/base/CUDisplay.h>
 #include <cugl/util/CUDebug.h>
 
@@ -61,6 +62,18 @@ using namespace cugl;
  * @return true if initialization was successful.
  */
 bool RenderTarget::prepareBuffer() {
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::getViewport(_viewport);
+        _framebo  = RenderRecorder::genHandle();
+        _renderbo = RenderRecorder::genHandle();
+        _depthst = Texture::alloc(_width,_height,Texture::PixelFormat::DEPTH_STENCIL);
+        if (_depthst == nullptr) {
+            dispose();
+            return false;
+        }
+        return true;
+    }
+
     glGetIntegerv(GL_VIEWPORT, _viewport);
     
     GLenum error;
@@ -133,6 +146,8 @@ bool RenderTarget::attachTexture(GLuint index, Texture::PixelFormat format) {
         dispose();
         Display::get()->restoreRenderTarget();
         return false;
+    } else if (RenderRecorder::isHeadless()) {
+        return true;
     }
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+(GLint)index,
                            GL_TEXTURE_2D,  texture->getBuffer(), 0);
@@ -159,6 +174,9 @@ bool RenderTarget::attachTexture(GLuint index, Texture::PixelFormat format) {
  * @return true if the framebuffer was successfully finalized.
  */
 bool RenderTarget::completeBuffer() {
+    if (RenderRecorder::isHeadless()) {
+        return true;
+    }
     glDrawBuffers((int)_outsize, _bindpoints.data());
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (status != GL_FRAMEBUFFER_COMPLETE) {
@@ -389,11 +407,15 @@ bool RenderTarget::init(int width, int height, Texture::PixelFormat* outputs, si
  */
 void RenderTarget::dispose() {
     if (_framebo) {
-        glDeleteFramebuffers(1, &_framebo);
+        if (!RenderRecorder::isHeadless()) {
+            glDeleteFramebuffers(1, &_framebo);
+        }
         _framebo = 0;
     }
     if (_renderbo) {
-        glDeleteRenderbuffers(1, &_renderbo);
+        if (!RenderRecorder::isHeadless()) {
+            glDeleteRenderbuffers(1, &_renderbo);
+        }
         _renderbo = 0;
     }
     _outputs.clear();
@@ -435,6 +457,13 @@ const std::shared_ptr<Texture>& RenderTarget::getTexture(size_t index) const {
  * return control to the default render target (the screen) when done.
  */
 void RenderTarget::begin() {
+    RenderRecorder::recordTarget(_framebo);
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::getViewport(_viewport);
+        RenderRecorder::setBinding(GL_FRAMEBUFFER_BINDING, _framebo);
+        RenderRecorder::setViewport(0, 0, _width, _height);
+        return;
+    }
     glGetIntegerv(GL_VIEWPORT, _viewport);
     glBindFramebuffer(GL_FRAMEBUFFER, _framebo);
     //glBindRenderbuffer(GL_RENDERBUFFER, _renderbo);
@@ -455,7 +484,12 @@ void RenderTarget::begin() {
  * return control to the default render target (the screen) when done.
  */
 void RenderTarget::end() {
+    RenderRecorder::recordTarget(0);
     Display::get()->restoreRenderTarget();
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+        return;
+    }
     glViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
 }
 
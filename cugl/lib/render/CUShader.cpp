@@ -33,6 +33,7 @@
 #include <cugl/util/CUStrings.h>
 #include <cugl/render/CUShader.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CURenderRecorder.h>
 
 using namespace cugl;
 
@@ -66,6 +67,10 @@ bool Shader::compile() {
     CUAssertLog(!_vertSource.empty(), "Vertex shader source is not defined");
     CUAssertLog(!_fragSource.empty(), "Fragment shader source is not defined");
     CUAssertLog(!_program,   "This shader is already compiled");
+    if (RenderRecorder::isHeadless()) {
+        _program = RenderRecorder::genHandle();
+        return true;
+    }
     
     _program = glCreateProgram();
     if (!_program) {
@@ -121,10 +126,19 @@ bool Shader::compile() {
  * You must reinitialize the shader to use it.
  */
 void Shader::dispose() {
-    glUseProgram(NULL);
-    if (_fragShader) { glDeleteShader(_fragShader); _fragShader = 0;}
-    if (_vertShader) { glDeleteShader(_vertShader); _vertShader = 0;}
-    if (_program) { glDeleteShader(_program); _program = 0;}
+    if (RenderRecorder::isHeadless()) {
+        if (_program && isBound()) {
+            RenderRecorder::setBinding(GL_CURRENT_PROGRAM, 0);
+        }
+        _fragShader = 0;
+        _vertShader = 0;
+        _program = 0;
+    } else {
+        glUseProgram(NULL);
+        if (_fragShader) { glDeleteShader(_fragShader); _fragShader = 0;}
+        if (_vertShader) { glDeleteShader(_vertShader); _vertShader = 0;}
+        if (_program) { glDeleteShader(_program); _program = 0;}
+    }
     _vertSource.clear();
     _fragSource.clear();
 
@@ -322,8 +336,10 @@ bool Shader::init(const std::string vsource, const std::string fsource) {
         return false;
     }
     
-    cacheAttributes();
-    cacheUniforms();
+    if (!RenderRecorder::isHeadless()) {
+        cacheAttributes();
+        cacheUniforms();
+    }
     bind();
     return true;
 }
@@ -336,6 +352,11 @@ bool Shader::init(const std::string vsource, const std::string fsource) {
  */
 void Shader::bind() {
     CUAssertLog(_program, "Shader has not been initialized.");
+    RenderRecorder::recordShader(_program);
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_CURRENT_PROGRAM, _program);
+        return;
+    }
     glUseProgram( _program );
 }
 
@@ -346,7 +367,11 @@ void Shader::bind() {
  */
 void Shader::unbind() {
     CUAssertLog(_program, "Shader has not been initialized.");
-    if (isBound()) {
+    if (RenderRecorder::isHeadless()) {
+        if (isBound()) {
+            RenderRecorder::setBinding(GL_CURRENT_PROGRAM, 0);
+        }
+    } else if (isBound()) {
         glUseProgram( NULL );
     }
 }
@@ -359,6 +384,9 @@ void Shader::unbind() {
  * @return true if this shader is currently bound.
  */
 bool Shader::isBound() const {
+    if (RenderRecorder::isHeadless()) {
+        return RenderRecorder::getBinding(GL_CURRENT_PROGRAM) == _program;
+    }
     GLint prog;
     glGetIntegerv(GL_CURRENT_PROGRAM,&prog);
     return prog == _program;
@@ -390,6 +418,9 @@ std::vector<std::string> Shader::getAttributes() const {
  * @return the program offset of the given attribute
  */
 GLint Shader::getAttributeLocation(const std::string name) const {
+    if (RenderRecorder::isHeadless()) {
+        return -1;
+    }
     return glGetAttribLocation(_program,name.c_str());
 }
 
@@ -447,6 +478,9 @@ GLenum Shader::getAttributeType(const std::string name) const  {
  * @return the program offset of the given output variable.
  */
 GLint Shader::getOutputLocation(const std::string name) const {
+    if (RenderRecorder::isHeadless()) {
+        return -1;
+    }
     return glGetFragDataLocation(_program, name.c_str());
 }
 
@@ -476,6 +510,9 @@ std::vector<std::string> Shader::getUniforms() const {
  * @return the program offset of the given uniform
  */
 GLint Shader::getUniformLocation(const std::string name) const {
+    if (RenderRecorder::isHeadless()) {
+        return -1;
+    }
     return glGetUniformLocation(_program,name.c_str());
 }
 
@@ -549,7 +586,7 @@ std::vector<std::string> Shader::getSamplers() const {
  * @return the program offset of the given sampler variable
  */
 GLint Shader::getSamplerLocation(const std::string name) const {
-    GLint result =  glGetUniformLocation(_program,name.c_str());
+    GLint result = getUniformLocation(name);
     if (result != -1 && _uniformtypes.at(name) != GL_SAMPLER_2D) {
         result = -1;
     }
@@ -731,7 +768,8 @@ std::vector<std::string> Shader::getUniformsForBlock(GLint pos) const {
  */
 std::vector<std::string> Shader::getUniformsForBlock(std::string name) const {
     std::vector<std::string> result;
-    GLuint index = glGetUniformBlockIndex(_program, name.c_str());
+    GLuint index = RenderRecorder::isHeadless() ? GL_INVALID_INDEX :
+                   glGetUniformBlockIndex(_program, name.c_str());
     if (index == GL_INVALID_INDEX) {
         return result;
     }
@@ -757,6 +795,9 @@ std::vector<std::string> Shader::getUniformsForBlock(std::string name) const {
  * @param bpoint   The bindpoint for the uniform block
  */
 void Shader::setUniformBlock(GLint pos, GLuint bindpoint) {
+    if (RenderRecorder::isHeadless()) {
+        return;
+    }
     glUniformBlockBinding(_program, pos, bindpoint);
 }
 
@@ -774,7 +815,8 @@ void Shader::setUniformBlock(GLint pos, GLuint bindpoint) {
  * @param bpoint   The bindpoint for the uniform block
  */
 void Shader::setUniformBlock(const std::string name, GLuint bindpoint) {
-    GLuint index = glGetUniformBlockIndex(_program, name.c_str());
+    GLuint index = RenderRecorder::isHeadless() ? GL_INVALID_INDEX :
+                   glGetUniformBlockIndex(_program, name.c_str());
     if (index != GL_INVALID_INDEX) {
         glUniformBlockBinding(_program, index, bindpoint);
     }
@@ -829,7 +871,9 @@ void Shader::setUniformBlock(GLint pos, const std::shared_ptr<UniformBuffer>& bu
     }
     
     // Now bind
-    glUniformBlockBinding(_program, pos, bpoint);
+    if (!RenderRecorder::isHeadless()) {
+        glUniformBlockBinding(_program, pos, bpoint);
+    }
 }
 
 /**
@@ -852,7 +896,8 @@ void Shader::setUniformBlock(GLint pos, const std::shared_ptr<UniformBuffer>& bu
  */
 void Shader::setUniformBlock(const std::string name,
                              const std::shared_ptr<UniformBuffer>& buffer) {
-    GLuint index = glGetUniformBlockIndex(_program, name.c_str());
+    GLuint index = RenderRecorder::isHeadless() ? GL_INVALID_INDEX :
+                   glGetUniformBlockIndex(_program, name.c_str());
     if (index != GL_INVALID_INDEX) {
         setUniformBlock(index, buffer);
     }
@@ -870,6 +915,9 @@ void Shader::setUniformBlock(const std::string name,
  * @return the buffer bindpoint associated with the given uniform block.
  */
 GLuint Shader::getUniformBlock(GLint pos) const {
+    if (RenderRecorder::isHeadless()) {
+        return 0;
+    }
     GLint block;
     glGetActiveUniformBlockiv(_program,pos,GL_UNIFORM_BLOCK_BINDING,&block);
     return block;
@@ -887,7 +935,8 @@ GLuint Shader::getUniformBlock(GLint pos) const {
  * @return the buffer bindpoint associated with the given uniform block.
  */
 GLuint Shader::getUniformBlock(const std::string name) const {
-    GLuint index = glGetUniformBlockIndex(_program, name.c_str());
+    GLuint index = RenderRecorder::isHeadless() ? GL_INVALID_INDEX :
+                   glGetUniformBlockIndex(_program, name.c_str());
     if (index == GL_INVALID_INDEX) {
         return 0;
     }
@@ -910,7 +959,7 @@ GLuint Shader::getUniformBlock(const std::string name) const {
  */
 void Shader::setUniformVec2(GLint pos, const Vec2 vec) {
     CUAssertLog(isBound(), "Shader is not active.");
-    glUniform2f(pos,vec.x,vec.y);
+    if (pos >= 0) glUniform2f(pos,vec.x,vec.y);
 }
 
 /**
@@ -969,7 +1018,7 @@ bool Shader::getUniformVec2(const std::string name, Vec2& vec) const {
  */
 void Shader::setUniformVec3(GLint pos, const Vec3 vec) {
     CUAssertLog(isBound(), "Shader is not active.");
-    glUniform3f(pos,vec.x,vec.y,vec.z);
+    if (pos >= 0) glUniform3f(pos,vec.x,vec.y,vec.z);
 }
 
 /**
@@ -1028,7 +1077,7 @@ bool Shader::getUniformVec3(const std::string name, Vec3& vec) const {
  */
 void Shader::setUniformVec4(GLint pos, const Vec4 vec) {
     CUAssertLog(isBound(), "Shader is not active.");
-    glUniform4f(pos,vec.x,vec.y,vec.z,vec.w);
+    if (pos >= 0) glUniform4f(pos,vec.x,vec.y,vec.z,vec.w);
 }
 
 /**
@@ -1206,7 +1255,7 @@ bool Shader::getUniformColor4f(const std::string name, Color4f& color) const {
  */
 void Shader::setUniformMat4(GLint pos, const Mat4& mat) {
     CUAssertLog(isBound(), "Shader is not active.");
-    glUniformMatrix4fv(pos,1,false,mat.m);
+    if (pos >= 0) glUniformMatrix4fv(pos,1,false,mat.m);
 }
 
 /**
@@ -1270,7 +1319,7 @@ void Shader::setUniformAffine2(GLint pos, const Affine2& mat) {
     CUAssertLog(isBound(), "Shader is not active.");
     float data[9];
     mat.get3x3(data);
-    glUniformMatrix3fv(pos,1,false,data);
+    if (pos >= 0) glUniformMatrix3fv(pos,1,false,data);
 }
 
 /**
@@ -1405,7 +1454,7 @@ bool Shader::getUniformQuaternion(const std::string name, Quaternion& quat) cons
  */
 void Shader::setUniform1f(GLint pos, GLfloat v0) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1f(pos, v0);
+	if (pos >= 0) glUniform1f(pos, v0);
 }
 
 /**
@@ -1435,7 +1484,7 @@ void Shader::setUniform1f(const std::string name, GLfloat v0) {
  */
 void Shader::setUniform2f(GLint pos, GLfloat v0, GLfloat v1) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2f(pos, v0, v1);
+	if (pos >= 0) glUniform2f(pos, v0, v1);
 }
 
 /**
@@ -1467,7 +1516,7 @@ void Shader::setUniform2f(const std::string name, GLfloat v0, GLfloat v1) {
  */
 void Shader::setUniform3f(GLint pos, GLfloat v0, GLfloat v1, GLfloat v2) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3f(pos, v0, v1, v2);
+	if (pos >= 0) glUniform3f(pos, v0, v1, v2);
 }
 
 /**
@@ -1501,7 +1550,7 @@ void Shader::setUniform3f(const std::string name, GLfloat v0, GLfloat v1, GLfloa
  */
 void Shader::setUniform4f(GLint pos, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4f(pos, v0, v1, v2, v3);
+	if (pos >= 0) glUniform4f(pos, v0, v1, v2, v3);
 }
 
 /**
@@ -1533,7 +1582,7 @@ void Shader::setUniform4f(const std::string name, GLfloat v0, GLfloat v1, GLfloa
  */
 void Shader::setUniform1i(GLint pos, GLint v0) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1i(pos, v0);
+	if (pos >= 0) glUniform1i(pos, v0);
 }
 
 /**
@@ -1563,7 +1612,7 @@ void Shader::setUniform1i(const std::string name, GLint v0) {
  */
 void Shader::setUniform2i(GLint pos, GLint v0, GLint v1) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2i(pos, v0, v1);
+	if (pos >= 0) glUniform2i(pos, v0, v1);
 }
 
 /**
@@ -1595,7 +1644,7 @@ void Shader::setUniform2i(const std::string name, GLint v0, GLint v1) {
  */
 void Shader::setUniform3i(GLint pos, GLint v0, GLint v1, GLint v2) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3i(pos, v0, v1, v2);
+	if (pos >= 0) glUniform3i(pos, v0, v1, v2);
 }
 
 /**
@@ -1629,7 +1678,7 @@ void Shader::setUniform3i(const std::string name, GLint v0, GLint v1, GLint v2)
  */
 void Shader::setUniform4i(GLint pos, GLint v0, GLint v1, GLint v2, GLint v3) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4i(pos, v0, v1, v2, v3);
+	if (pos >= 0) glUniform4i(pos, v0, v1, v2, v3);
 }
 
 /**
@@ -1661,7 +1710,7 @@ void Shader::setUniform4i(const std::string name, GLint v0, GLint v1, GLint v2,
  */
 void Shader::setUniform1ui(GLint pos, GLuint v0) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1ui(pos, v0);
+	if (pos >= 0) glUniform1ui(pos, v0);
 }
 
 /**
@@ -1691,7 +1740,7 @@ void Shader::setUniform1ui(const std::string name, GLuint v0) {
  */
 void Shader::setUniform2ui(GLint pos, GLuint v0, GLuint v1) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2ui(pos, v0, v1);
+	if (pos >= 0) glUniform2ui(pos, v0, v1);
 }
 
 /**
@@ -1723,7 +1772,7 @@ void Shader::setUniform2ui(const std::string name, GLuint v0, GLuint v1) {
  */
 void Shader::setUniform3ui(GLint pos, GLuint v0, GLuint v1, GLuint v2) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3ui(pos, v0, v1, v2);
+	if (pos >= 0) glUniform3ui(pos, v0, v1, v2);
 }
 
 /**
@@ -1757,7 +1806,7 @@ void Shader::setUniform3ui(const std::string name, GLuint v0, GLuint v1, GLuint
  */
 void Shader::setUniform4ui(GLint pos, GLuint v0, GLuint v1, GLuint v2, GLuint v3) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4ui(pos, v0, v1, v2, v3);
+	if (pos >= 0) glUniform4ui(pos, v0, v1, v2, v3);
 }
 
 /**
@@ -1790,7 +1839,7 @@ void Shader::setUniform4ui(const std::string name, GLuint v0, GLuint v1, GLuint
  */
 void Shader::setUniform1fv(GLint pos, GLsizei count, const GLfloat *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1fv(pos, count, value);
+	if (pos >= 0) glUniform1fv(pos, count, value);
 }
 
 /**
@@ -1821,7 +1870,7 @@ void Shader::setUniform1fv(const std::string name, GLsizei count, const GLfloat
  */
 void Shader::setUniform2fv(GLint pos, GLsizei count, const GLfloat *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2fv(pos, count, value);
+	if (pos >= 0) glUniform2fv(pos, count, value);
 }
 
 /**
@@ -1852,7 +1901,7 @@ void Shader::setUniform2fv(const std::string name, GLsizei count, const GLfloat
  */
 void Shader::setUniform3fv(GLint pos, GLsizei count, const GLfloat *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3fv(pos, count, value);
+	if (pos >= 0) glUniform3fv(pos, count, value);
 }
 
 /**
@@ -1883,7 +1932,7 @@ void Shader::setUniform3fv(const std::string name, GLsizei count, const GLfloat
  */
 void Shader::setUniform4fv(GLint pos, GLsizei count, const GLfloat *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4fv(pos, count, value);
+	if (pos >= 0) glUniform4fv(pos, count, value);
 }
 
 /**
@@ -1914,7 +1963,7 @@ void Shader::setUniform4fv(const std::string name, GLsizei count, const GLfloat
  */
 void Shader::setUniform1iv(GLint pos, GLsizei count, const GLint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1iv(pos, count, value);
+	if (pos >= 0) glUniform1iv(pos, count, value);
 }
 
 /**
@@ -1945,7 +1994,7 @@ void Shader::setUniform1iv(const std::string name, GLsizei count, const GLint *v
  */
 void Shader::setUniform2iv(GLint pos, GLsizei count, const GLint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2iv(pos, count, value);
+	if (pos >= 0) glUniform2iv(pos, count, value);
 }
 
 /**
@@ -1976,7 +2025,7 @@ void Shader::setUniform2iv(const std::string name, GLsizei count, const GLint *v
  */
 void Shader::setUniform3iv(GLint pos, GLsizei count, const GLint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3iv(pos, count, value);
+	if (pos >= 0) glUniform3iv(pos, count, value);
 }
 
 /**
@@ -2007,7 +2056,7 @@ void Shader::setUniform3iv(const std::string name, GLsizei count, const GLint *v
  */
 void Shader::setUniform4iv(GLint pos, GLsizei count, const GLint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4iv(pos, count, value);
+	if (pos >= 0) glUniform4iv(pos, count, value);
 }
 
 /**
@@ -2038,7 +2087,7 @@ void Shader::setUniform4iv(const std::string name, GLsizei count, const GLint *v
  */
 void Shader::setUniform1uiv(GLint pos, GLsizei count, const GLuint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform1uiv(pos, count, value);
+	if (pos >= 0) glUniform1uiv(pos, count, value);
 }
 
 /**
@@ -2069,7 +2118,7 @@ void Shader::setUniform1uiv(const std::string name, GLsizei count, const GLuint
  */
 void Shader::setUniform2uiv(GLint pos, GLsizei count, const GLuint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform2uiv(pos, count, value);
+	if (pos >= 0) glUniform2uiv(pos, count, value);
 }
 
 /**
@@ -2100,7 +2149,7 @@ void Shader::setUniform2uiv(const std::string name, GLsizei count, const GLuint
  */
 void Shader::setUniform3uiv(GLint pos, GLsizei count, const GLuint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform3uiv(pos, count, value);
+	if (pos >= 0) glUniform3uiv(pos, count, value);
 }
 
 /**
@@ -2131,7 +2180,7 @@ void Shader::setUniform3uiv(const std::string name, GLsizei count, const GLuint
  */
 void Shader::setUniform4uiv(GLint pos, GLsizei count, const GLuint *value) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniform4uiv(pos, count, value);
+	if (pos >= 0) glUniform4uiv(pos, count, value);
 }
 
 /**
@@ -2163,7 +2212,7 @@ void Shader::setUniform4uiv(const std::string name, GLsizei count, const GLuint
  */
 void Shader::setUniformMatrix2fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix2fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix2fv(pos, count, tpose, value);
 }
 
 /**
@@ -2196,7 +2245,7 @@ void Shader::setUniformMatrix2fv(const std::string name, GLsizei count, const GL
  */
 void Shader::setUniformMatrix3fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix3fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix3fv(pos, count, tpose, value);
 }
 
 /**
@@ -2229,7 +2278,7 @@ void Shader::setUniformMatrix3fv(const std::string name, GLsizei count, const GL
  */
 void Shader::setUniformMatrix4fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix4fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix4fv(pos, count, tpose, value);
 }
 
 /**
@@ -2262,7 +2311,7 @@ void Shader::setUniformMatrix4fv(const std::string name, GLsizei count, const GL
  */
 void Shader::setUniformMatrix2x3fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix2x3fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix2x3fv(pos, count, tpose, value);
 }
 
 /**
@@ -2295,7 +2344,7 @@ void Shader::setUniformMatrix2x3fv(const std::string name, GLsizei count, const
  */
 void Shader::setUniformMatrix3x2fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix3x2fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix3x2fv(pos, count, tpose, value);
 }
 
 /**
@@ -2328,7 +2377,7 @@ void Shader::setUniformMatrix3x2fv(const std::string name, GLsizei count, const
  */
 void Shader::setUniformMatrix2x4fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix2x4fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix2x4fv(pos, count, tpose, value);
 }
 
 /**
@@ -2361,7 +2410,7 @@ void Shader::setUniformMatrix2x4fv(const std::string name, GLsizei count, const
  */
 void Shader::setUniformMatrix4x2fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix4x2fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix4x2fv(pos, count, tpose, value);
 }
 
 /**
@@ -2394,7 +2443,7 @@ void Shader::setUniformMatrix4x2fv(const std::string name, GLsizei count, const
  */
 void Shader::setUniformMatrix3x4fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix3x4fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix3x4fv(pos, count, tpose, value);
 }
 
 /**
@@ -2427,7 +2476,7 @@ void Shader::setUniformMatrix3x4fv(const std::string name, GLsizei count, const
  */
 void Shader::setUniformMatrix4x3fv(GLint pos, GLsizei count, const GLfloat *value, GLboolean tpose) {
 	CUAssertLog(isBound(), "Shader is not active.");
-	glUniformMatrix4x3fv(pos, count, tpose, value);
+	if (pos >= 0) glUniformMatrix4x3fv(pos, count, tpose, value);
 }
 
 /**
@@ -2461,6 +2510,9 @@ void Shader::setUniformMatrix4x3fv(const std::string name, GLsizei count, const
  */
 bool Shader::getUniformfv(GLint pos, GLsizei size, GLfloat *value) const {
     CUAssertLog(isBound(), "Shader is not active.");
+    if (pos < 0) {
+        return false;
+    }
     glGetUniformfv(_program,pos,value);
     return !(glGetError());
 }
@@ -2501,6 +2553,9 @@ bool Shader::getUniformfv(const std::string name, GLsizei size, GLfloat *value)
  */
 bool Shader::getUniformiv(GLint pos, GLsizei size, GLint *value) const {
     CUAssertLog(isBound(), "Shader is not active.");
+    if (pos < 0) {
+        return false;
+    }
     glGetUniformiv(_program,pos,value);
     return !(glGetError());
 }
@@ -2541,6 +2596,9 @@ bool Shader::getUniformiv(const std::string name, GLsizei size, GLint *value) co
  */
 bool Shader::getUniformuiv(GLint pos, GLsizei size, GLuint *value) const {
     CUAssertLog(isBound(), "Shader is not active.");
+    if (pos < 0) {
+        return false;
+    }
     glGetUniformuiv(_program,pos,value);
     return !(glGetError());
 }
@@ -42,6 +42,7 @@
 //
 //  Author: Walker White
 //  Version: 2/10/20
+#include <algorithm>
 #include <cugl/math/cu_math.h>
 #include <cugl/util/CUDebug.h>
 #include <cugl/render/CUSpriteBatch.h>
@@ -50,6 +51,7 @@
 #include <cugl/render/CUShader.h>
 #include <cugl/render/CUGradient.h>
 #include <cugl/render/CUScissor.h>
+#include <cugl/render/CURenderRecorder.h>
 
 /**
  * Default fragment shader
@@ -88,6 +90,8 @@ using namespace cugl;
 #define TYPE_SCISSOR    4
 /** The drawing type for a (simple) texture blur */
 #define TYPE_GAUSSBLUR  8
+/** The drawing type for a signed distance field texture */
+#define TYPE_DISTANCE   16
 
 /** The drawing command has changed */
 #define DIRTY_COMMAND       1
@@ -120,6 +124,8 @@ SpriteBatch::Context::Context() {
     blendEquation = GL_FUNC_ADD;
     srcFactor = GL_SRC_ALPHA;
     dstFactor = GL_ONE_MINUS_SRC_ALPHA;
+    srcAlpha  = GL_SRC_ALPHA;
+    dstAlpha  = GL_ONE_MINUS_SRC_ALPHA;
     depthFunc = GL_ALWAYS;
     perspective = std::make_shared<Mat4>();
     perspective->setIdentity();
@@ -141,6 +147,8 @@ SpriteBatch::Context::Context(Context* copy) {
     command = copy->command;
     srcFactor = copy->srcFactor;
     dstFactor = copy->dstFactor;
+    srcAlpha  = copy->srcAlpha;
+    dstAlpha  = copy->dstAlpha;
     depthFunc = copy->depthFunc;
     blendEquation = copy->blendEquation;
     perspective = copy->perspective;
@@ -160,6 +168,8 @@ SpriteBatch::Context::~Context() {
     blendEquation = GL_FALSE;
     srcFactor = GL_FALSE;
     dstFactor = GL_FALSE;
+    srcAlpha  = GL_FALSE;
+    dstAlpha  = GL_FALSE;
     depthFunc = GL_ALWAYS;
     perspective = nullptr;
     texture  = nullptr;
@@ -187,6 +197,9 @@ _vertMax(0),
 _vertSize(0),
 _indxMax(0),
 _indxSize(0),
+_remapGen(0),
+_deferred(false),
+_recordSize(0),
 _vertTotal(0),
 _callTotal(0) {
     _shader = nullptr;
@@ -224,6 +237,15 @@ void SpriteBatch::dispose() {
     _depth = 0;
     _color = Color4f::WHITE;
     
+    _remapIndex.clear();
+    _remapStamp.clear();
+    _remapGen = 0;
+    
+    _deferred = false;
+    _blockData.clear();
+    _recording.clear();
+    _recordSize = 0;
+    
     _vertTotal = 0;
     _callTotal = 0;
     
@@ -345,6 +367,43 @@ bool SpriteBatch::init(unsigned int capacity, const std::shared_ptr<Shader>& sha
     
     _context = new Context();
     _context->dirty = DIRTY_ALL_VALS;
+    _initialized = true;
+    return true;
+}
+
+/**
+ * Initializes a deferred sprite batch with the given vertex capacity.
+ *
+ * A deferred sprite batch has no shader and allocates no OpenGL
+ * resources. Instead of drawing, every flush records its vertices and
+ * drawing contexts. These recordings are drawn by passing this batch
+ * to {@link #replay} on a normal sprite batch. As it never touches
+ * OpenGL, a deferred sprite batch may be used on any thread.
+ *
+ * The capacity (and uniform block capacity) follow the same rules as
+ * a normal sprite batch. The capacity may not be larger than that of
+ * the sprite batch that replays it.
+ *
+ * @param capacity The vertex capacity of this spritebatch
+ *
+ * @return true if initialization was successful.
+ */
+bool SpriteBatch::initDeferred(unsigned int capacity) {
+    if (_initialized) {
+        CUAssertLog(false, "SpriteBatch is already initialized");
+        return false; // If asserts are turned off.
+    }
+    
+    _deferred = true;
+    _vertMax = capacity;
+    _vertData = new SpriteVertex3[_vertMax];
+    _indxMax = capacity*3;
+    _indxData = new GLuint[_indxMax];
+    _blockData.resize(40*(capacity/16));
+    
+    _context = new Context();
+    _context->dirty = DIRTY_ALL_VALS;
+    _initialized = true;
     return true;
 }
 
@@ -381,6 +440,7 @@ void SpriteBatch::setColor(const Color4f color) {
 void SpriteBatch::setShader(const std::shared_ptr<Shader>& shader) {
     CUAssertLog(_active, "Attempt to reassign shader while drawing is active");
     CUAssertLog(shader != nullptr, "Shader cannot be null");
+    CUAssertLog(!_deferred, "Deferred sprite batches do not have a shader");
     _vertbuff->detach();
     _shader = shader;
     _vertbuff->attach(_shader);
@@ -592,10 +652,36 @@ void SpriteBatch::setScissor(const std::shared_ptr<Scissor>& scissor) {
  * @param dstFactor Specifies how the destination blending factors are computed.
  */
 void SpriteBatch::setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
-    if (_context->srcFactor != srcFactor || _context->dstFactor != dstFactor) {
+    setBlendFuncSeparate(srcFactor, dstFactor, srcFactor, dstFactor);
+}
+
+/**
+ * Sets separate blending functions for the color and alpha channels
+ *
+ * The enums are the standard ones supported by OpenGL.  See
+ *
+ *      https://www.opengl.org/sdk/docs/man/html/glBlendFuncSeparate.xhtml
+ *
+ * However, this setter does not do any error checking to verify that
+ * the enums are valid. This is necessary to draw into a render target
+ * with premultiplied alpha, as the alpha channel should be blended with
+ * GL_ONE and GL_ONE_MINUS_SRC_ALPHA.
+ *
+ * Changing this value will cause the sprite batch to flush.
+ *
+ * @param srcRGB    Specifies how the source color factors are computed
+ * @param dstRGB    Specifies how the destination color factors are computed
+ * @param srcAlpha  Specifies how the source alpha factor is computed
+ * @param dstAlpha  Specifies how the destination alpha factor is computed
+ */
+void SpriteBatch::setBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    if (_context->srcFactor != srcRGB || _context->dstFactor != dstRGB ||
+        _context->srcAlpha != srcAlpha || _context->dstAlpha != dstAlpha) {
         if (_inflight) { record(); }
-        _context->srcFactor = srcFactor;
-        _context->dstFactor = dstFactor;
+        _context->srcFactor = srcRGB;
+        _context->dstFactor = dstRGB;
+        _context->srcAlpha  = srcAlpha;
+        _context->dstAlpha  = dstAlpha;
         _context->dirty = _context->dirty | DIRTY_BLENDFACTOR;
     }
 }
@@ -700,6 +786,50 @@ void SpriteBatch::setBlurStep(GLuint step) {
     _context->blurstep = step;
 }
 
+/**
+ * Sets whether textures are drawn as signed distance fields.
+ *
+ * A distance field texture stores the distance to a shape edge in its
+ * alpha channel, with the edge at one half.  In this mode, the alpha
+ * value is replaced by a smooth step across that edge, so the shape
+ * stays sharp at any scale. This is how {@link Font} draws an atlas
+ * that was baked as a distance field.
+ *
+ * This value is false by default.
+ *
+ * @param flag  Whether textures are drawn as signed distance fields
+ */
+void SpriteBatch::setDistanceField(bool flag) {
+    if (isDistanceField() == flag) {
+        return;
+    }
+    
+    if (_inflight) { record(); }
+    _context->dirty = _context->dirty | DIRTY_DRAWTYPE;
+    if (flag) {
+        _context->type = _context->type | TYPE_DISTANCE;
+    } else {
+        _context->type = _context->type & ~TYPE_DISTANCE;
+    }
+}
+
+/**
+ * Returns true if textures are drawn as signed distance fields.
+ *
+ * A distance field texture stores the distance to a shape edge in its
+ * alpha channel, with the edge at one half.  In this mode, the alpha
+ * value is replaced by a smooth step across that edge, so the shape
+ * stays sharp at any scale. This is how {@link Font} draws an atlas
+ * that was baked as a distance field.
+ *
+ * This value is false by default.
+ *
+ * @return true if textures are drawn as signed distance fields.
+ */
+bool SpriteBatch::isDistanceField() const {
+    return (_context->type & TYPE_DISTANCE) != 0;
+}
+
 
 #pragma mark -
 #pragma mark Rendering
@@ -712,9 +842,20 @@ void SpriteBatch::setBlurStep(GLuint step) {
  * Calling this method will reset the vertex and OpenGL call counters to 0.
  */
 void SpriteBatch::begin() {
-    glDisable(GL_CULL_FACE);
-    glDepthMask(true);
-    glEnable(GL_BLEND);
+    if (_deferred) {
+        _recordSize = 0;
+        _context->dirty = DIRTY_ALL_VALS;
+        _active = true;
+        _callTotal = 0;
+        _vertTotal = 0;
+        return;
+    }
+    
+    if (!RenderRecorder::isHeadless()) {
+        glDisable(GL_CULL_FACE);
+        glDepthMask(true);
+        glEnable(GL_BLEND);
+    }
 
     // DO NOT CLEAR.  This responsibility lies elsewhere
     _shader->bind();
@@ -735,7 +876,9 @@ void SpriteBatch::begin() {
 void SpriteBatch::end() {
     CUAssertLog(_active,"SpriteBatch is not active");
     flush();
-    _shader->unbind();
+    if (!_deferred) {
+        _shader->unbind();
+    }
     _active = false;
 }
 
@@ -754,6 +897,11 @@ void SpriteBatch::flush() {
         record();
     }
     
+    if (_deferred) {
+        store();
+        return;
+    }
+    
     // Load all the vertex data at once
     _vertbuff->loadVertexData(_vertData, _vertSize);
     _vertbuff->loadIndexData(_indxData, _indxSize);
@@ -761,30 +909,36 @@ void SpriteBatch::flush() {
     _unifbuff->flush();
     
     // Chunk the uniforms
+    bool headless = RenderRecorder::isHeadless();
     std::shared_ptr<Texture> previous = _context->texture;
     for(auto it = _history.begin(); it != _history.end(); ++it) {
         Context* next = *it;
         if (next->dirty & DIRTY_EQUATION) {
-            glBlendEquation(next->blendEquation);
-        }
-        if (next->dirty & DIRTY_BLENDFACTOR) {
-            glBlendFunc(next->srcFactor, next->dstFactor);
+            RenderRecorder::recordState(GL_BLEND_EQUATION);
+            if (!headless) glBlendEquation(next->blendEquation);
         }
         if (next->dirty & DIRTY_BLENDFACTOR) {
-            glBlendFunc(next->srcFactor, next->dstFactor);
+            RenderRecorder::recordState(GL_BLEND_SRC);
+            if (!headless) {
+                glBlendFuncSeparate(next->srcFactor, next->dstFactor,
+                                    next->srcAlpha, next->dstAlpha);
+            }
         }
         if (next->dirty & DIRTY_DEPTHTEST) {
-            if (next->depthFunc == GL_ALWAYS) {
+            RenderRecorder::recordState(GL_DEPTH_FUNC);
+            if (!headless && next->depthFunc == GL_ALWAYS) {
                 glDisable(GL_DEPTH_TEST);
-            } else {
+            } else if (!headless) {
                 glEnable(GL_DEPTH_TEST);
                 glDepthFunc(next->depthFunc);
             }
         }
         if (next->dirty & DIRTY_DRAWTYPE) {
-             _shader->setUniform1i("uType", next->type);
+            RenderRecorder::recordState(GL_CURRENT_PROGRAM);
+            _shader->setUniform1i("uType", next->type);
         }
         if (next->dirty & DIRTY_PERSPECTIVE) {
+            RenderRecorder::recordState(GL_CURRENT_PROGRAM);
             _shader->setUniformMat4("uPerspective",*(next->perspective.get()));
         }
         if (next->dirty & DIRTY_TEXTURE) {
@@ -797,6 +951,7 @@ void SpriteBatch::flush() {
             _unifbuff->setBlock(next->blockptr);
         }
         if (next->dirty & DIRTY_BLURSTEP) {
+            RenderRecorder::recordState(GL_CURRENT_PROGRAM);
             blurTexture(next->texture,next->blurstep);
         }
         GLuint amt = next->last-next->first;
@@ -817,6 +972,122 @@ void SpriteBatch::flush() {
 }
 
 
+/**
+ * Appends the recordings of a deferred sprite batch to this one.
+ *
+ * The vertices, uniform blocks, and drawing contexts recorded by the
+ * deferred batch (since its last call to {@link #begin}) are copied into
+ * this sprite batch in order. They are uploaded together with any other
+ * vertices at the next flush, so several deferred batches share a single
+ * vertex upload (though each adds at least one draw call). This sprite
+ * batch will only flush early if the recordings do not fit in its buffers.
+ *
+ * The state of this sprite batch (color, texture, blending, and so on)
+ * is unchanged by this method. This sprite batch must be active and
+ * must not itself be deferred. The deferred batch must have finished
+ * recording (e.g. {@link #end} was called) and may not have a larger
+ * capacity than this one.
+ *
+ * @param batch The deferred sprite batch to replay
+ */
+void SpriteBatch::replay(const std::shared_ptr<SpriteBatch>& batch) {
+    CUAssertLog(_active, "SpriteBatch is not active");
+    CUAssertLog(!_deferred, "Deferred sprite batches cannot replay");
+    CUAssertLog(batch->_deferred, "Only deferred sprite batches may be replayed");
+    CUAssertLog(!batch->_active, "Deferred sprite batch is still recording");
+    CUAssertLog(batch->_vertMax <= _vertMax, "Deferred sprite batch capacity is too large");
+    if (batch->_recordSize == 0) {
+        return;
+    }
+    
+    // Restore our own state after the replay
+    Context saved(_context);
+    for(size_t ii = 0; ii < batch->_recordSize; ii++) {
+        const Recording& chunk = batch->_recording[ii];
+        GLsizei blocks = (GLsizei)(chunk.blocks.size()/40);
+        if (_vertSize+chunk.vertices.size() > _vertMax ||
+            _indxSize+chunk.indices.size()  > _indxMax ||
+            _context->blockptr+1+blocks > (GLsizei)_unifbuff->getBlockCount()) {
+            flush();
+        }
+        
+        // Close the current context
+        GLsizei blockbase = _context->blockptr+1;
+        if (_context->first != _indxSize) {
+            _context->last = _indxSize;
+            _history.push_back(_context);
+        } else {
+            delete _context;
+        }
+        
+        std::memcpy(_vertData+_vertSize, chunk.vertices.data(),
+                    chunk.vertices.size()*sizeof(SpriteVertex3));
+        for(size_t jj = 0; jj < chunk.indices.size(); jj++) {
+            _indxData[_indxSize+jj] = _vertSize+chunk.indices[jj];
+        }
+        for(GLsizei jj = 0; jj < blocks; jj++) {
+            _unifbuff->setUniformfv(blockbase+jj,0,40,chunk.blocks.data()+40*jj);
+        }
+        
+        bool first = true;
+        for(auto it = chunk.contexts.begin(); it != chunk.contexts.end(); ++it) {
+            Context* next = new Context(*it);
+            next->first += _indxSize;
+            next->last  += _indxSize;
+            if (first) {
+                // The previous state is unknown
+                next->dirty = DIRTY_ALL_VALS;
+                first = false;
+            }
+            if (next->blockptr >= 0) {
+                next->blockptr += blockbase;
+            } else {
+                next->dirty = next->dirty & ~DIRTY_UNIBLOCK;
+            }
+            _history.push_back(next);
+        }
+        
+        _vertSize += (unsigned int)chunk.vertices.size();
+        _indxSize += (unsigned int)chunk.indices.size();
+        
+        _context = new Context(&saved);
+        _context->first = _indxSize;
+        _context->last  = _indxSize;
+        _context->blockptr = blockbase+blocks-1;
+        _context->dirty = DIRTY_ALL_VALS;
+    }
+    _inflight = false;
+}
+
+/**
+ * Stores the current vertices and contexts as a new recording.
+ *
+ * This method is the flush of a deferred sprite batch. It copies the
+ * vertices, indices, uniform blocks, and contexts into the next recording
+ * slot (reusing its memory if possible) and then resets the batch.
+ */
+void SpriteBatch::store() {
+    if (_recordSize == _recording.size()) {
+        _recording.emplace_back();
+    }
+    Recording& chunk = _recording[_recordSize++];
+    chunk.vertices.assign(_vertData, _vertData+_vertSize);
+    chunk.indices.assign(_indxData, _indxData+_indxSize);
+    chunk.blocks.assign(_blockData.begin(), _blockData.begin()+40*(_context->blockptr+1));
+    chunk.contexts.clear();
+    for(auto it = _history.begin(); it != _history.end(); ++it) {
+        chunk.contexts.push_back(**it);
+    }
+    
+    _vertTotal += _indxSize;
+    _vertSize = _indxSize = 0;
+    unwind();
+    _context->first = 0;
+    _context->last  = 0;
+    _context->blockptr = -1;
+    _context->dirty = DIRTY_ALL_VALS;
+}
+
 #pragma mark -
 #pragma mark Solid Shapes
 /**
@@ -2052,7 +2323,8 @@ void SpriteBatch::setUniformBlock(Context* context, bool tint) {
     if (!(_context->dirty & DIRTY_UNIBLOCK)) {
         return;
     }
-    if (_context->blockptr+1 >= _unifbuff->getBlockCount()) {
+    GLsizei blockmax = _deferred ? (GLsizei)(_blockData.size()/40) : _unifbuff->getBlockCount();
+    if (_context->blockptr+1 >= blockmax) {
         flush();
     }
     float data[40];
@@ -2068,7 +2340,11 @@ void SpriteBatch::setUniformBlock(Context* context, bool tint) {
         std::memset(data+16,0,24*sizeof(float));
     }
     _context->blockptr++;
-    _unifbuff->setUniformfv(_context->blockptr,0,40,data);
+    if (_deferred) {
+        std::memcpy(_blockData.data()+40*_context->blockptr,data,40*sizeof(float));
+    } else {
+        _unifbuff->setUniformfv(_context->blockptr,0,40,data);
+    }
 }
 
 /**
@@ -2094,6 +2370,62 @@ void SpriteBatch::blurTexture(const std::shared_ptr<Texture>& texture, GLuint st
     _shader->setUniform2f("uBlur",size.width,size.height);
 }
 
+/**
+ * Transforms the positions of a range of batched vertices in place.
+ *
+ * This method uses the vectorized array transforms in {@link Mat4}. If
+ * the matrix is a planar (2d) transform, which is the case for almost
+ * all scene graph drawing, it uses the cheaper {@link Affine2} transform
+ * instead. If the matrix is the identity, this method does nothing.
+ *
+ * @param start The index of the first vertex to transform
+ * @param size  The number of vertices to transform
+ * @param mat   The transform to apply to the vertices
+ */
+void SpriteBatch::transformVertices(unsigned int start, unsigned int size, const Mat4& mat) {
+    if (size == 0 || mat.isIdentity(0)) {
+        return;
+    }
+    
+    const float* m = mat.m;
+    Vec3* position = &(_vertData[start].position);
+    if (m[2] == 0 && m[3] == 0 && m[6] == 0 && m[7] == 0 &&
+        m[8] == 0 && m[9] == 0 && m[10] == 1 && m[11] == 0 &&
+        m[14] == 0 && m[15] == 1) {
+        // z is unchanged, so only transform (x,y)
+        Affine2 aff(m[0],m[4],m[1],m[5],m[12],m[13]);
+        Vec2* planar = reinterpret_cast<Vec2*>(position);
+        Affine2::transform(aff, planar, planar, size, sizeof(SpriteVertex3));
+    } else {
+        Mat4::transform(mat, position, position, size, sizeof(SpriteVertex3));
+    }
+}
+
+/**
+ * Invalidates the remap table used by {@link #chunkify}.
+ *
+ * The remap table maps each source vertex of a chunked mesh to its
+ * position in the current batch, so that shared vertices are only
+ * copied once per flush. Rather than clearing the table, this method
+ * advances the generation counter, which makes all existing entries
+ * stale in constant time. The table only grows (and so allocates) when
+ * a mesh is larger than any mesh chunked so far.
+ *
+ * @param size  The number of source vertices in the mesh
+ */
+void SpriteBatch::resetRemap(size_t size) {
+    if (_remapStamp.size() < size) {
+        _remapIndex.resize(size);
+        _remapStamp.resize(size,0);
+    }
+    _remapGen++;
+    if (_remapGen == 0) {
+        // The counter wrapped, so stale stamps could match again
+        std::fill(_remapStamp.begin(), _remapStamp.end(), 0);
+        _remapGen = 1;
+    }
+}
+
 /**
  * Returns the number of vertices added to the drawing buffer.
  *
@@ -2200,7 +2532,7 @@ unsigned int SpriteBatch::prepare(const Rect rect, const Mat4& mat) {
     int ii = 0;
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
-        _vertData[vstart+ii].position = point*mat;
+        _vertData[vstart+ii].position = point;
         
         point.x = (point.x-rect.origin.x)/rect.size.width;
         point.y = 1-(point.y-rect.origin.y)/rect.size.height;
@@ -2211,6 +2543,8 @@ unsigned int SpriteBatch::prepare(const Rect rect, const Mat4& mat) {
         ii++;
     }
     
+    transformVertices(vstart, ii, mat);
+    
     int jj = 0;
     unsigned int istart = _indxSize;
     for(auto it = poly.indices().begin(); it != poly.indices().end(); ++it) {
@@ -2432,7 +2766,7 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
     int ii = 0;
     for(auto it = poly.vertices().begin(); it != poly.vertices().end(); ++it) {
         Vec3 point = Vec3((*it),_depth);
-        _vertData[vstart+ii].position = point*mat;
+        _vertData[vstart+ii].position = point;
         
         point.x /= twidth;
         point.y = 1-point.y/theight;
@@ -2442,6 +2776,8 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
         ii++;
     }
     
+    transformVertices(vstart, ii, mat);
+    
     int jj = 0;
     unsigned int istart = _indxSize;
     for(auto it = poly.indices().begin(); it != poly.indices().end(); ++it) {
@@ -2459,10 +2795,12 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
  * Returns the number of vertices added to the drawing buffer.
  *
  * This method is an alternate version of {@link #prepare} for the same
- * arguments.  It runs slower (e.g. the compiler cannot easily optimize
- * the loops) but it is guaranteed to work on any size polygon.  This
- * is important for avoiding memory corruption.  Unlike the perpare methods,
- * this method is guaranteed to flush, draining the vertex buffer.
+ * arguments.  It streams the polygon through the batch one primitive
+ * at a time, flushing whenever the next primitive would not fit. Hence
+ * it works on any size polygon, and a primitive is never split across
+ * two flushes. Vertices shared between primitives are only copied once
+ * per flush, and this method does not allocate memory (except to grow
+ * the remap table the first time it sees a larger polygon).
  *
  * All vertices will be uniformly transformed by the transform matrix.
  * If depth testing is on, all vertices will use the current sprite
@@ -2475,13 +2813,14 @@ unsigned int SpriteBatch::prepare(const Poly2& poly, const Mat4& mat) {
  */
 unsigned int SpriteBatch::chunkify(const Poly2& poly, const Mat4& mat) {
     Texture* texture = _context->texture.get();
-    std::unordered_map<Uint32, Uint32> offsets;
-    const std::vector<cugl::Vec2> vertices  = poly.vertices();
-    const std::vector<Uint32> indices = poly.indices();
+    const std::vector<cugl::Vec2>& vertices = poly.vertices();
+    const std::vector<Uint32>& indices = poly.indices();
     
     setUniformBlock(_context,true);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
-    unsigned int start = _indxSize;
+    resetRemap(vertices.size());
+    unsigned int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    unsigned int vfirst = _vertSize;
+    unsigned int total = 0;
 
     float twidth, theight;
     float tsmax, tsmin;
@@ -2501,35 +2840,42 @@ unsigned int SpriteBatch::chunkify(const Poly2& poly, const Mat4& mat) {
         ttmax = 1.0f; ttmin = 0.0f;
     }
 
-    for(int ii = 0;  ii < indices.size(); ii += chunksize) {
+    for(size_t ii = 0;  ii+chunksize <= indices.size(); ii += chunksize) {
+        // Never split a primitive across a flush
         if (_indxSize+chunksize > _indxMax || _vertSize+chunksize > _vertMax) {
+            transformVertices(vfirst, _vertSize-vfirst, mat);
             flush();
-            offsets.clear();
+            resetRemap(vertices.size());
+            vfirst = _vertSize;
         }
         
-        for(int jj = 0; jj < chunksize; jj++) {
-            auto search = offsets.find(indices[ii+jj]);
-            if (search != offsets.end()) {
-                _indxData[_indxSize] = search->second;
+        for(unsigned int jj = 0; jj < chunksize; jj++) {
+            Uint32 index = indices[ii+jj];
+            CUAssertLog(index < vertices.size(), "Index %d is out of range", index);
+            if (_remapStamp[index] == _remapGen) {
+                _indxData[_indxSize] = _remapIndex[index];
             } else {
-                Vec3 point = Vec3(vertices[indices[ii+jj]],_depth);
+                Vec3 point = Vec3(vertices[index],_depth);
                 _indxData[_indxSize] = _vertSize;
-                _vertData[_vertSize].position = point*mat;
+                _vertData[_vertSize].position = point;
                 
                 point.x /= twidth;
                 point.y = 1-point.y/theight;
                 _vertData[_vertSize].texcoord.x = point.x*tsmax+(1-point.x)*tsmin;
                 _vertData[_vertSize].texcoord.y = point.y*ttmax+(1-point.y)*ttmin;
                 _vertData[_vertSize].color = (_gradient == nullptr) ? (Vec4)_color : Vec4(_vertData[_vertSize].texcoord,0,0);
-                offsets[indices[ii+jj]] = _vertSize;
+                _remapStamp[index] = _remapGen;
+                _remapIndex[index] = _vertSize;
                 _vertSize++;
+                total++;
             }
             _indxSize++;
         }
     }
 
+    transformVertices(vfirst, _vertSize-vfirst, mat);
     _inflight = true;
-    return (unsigned int)indices.size()+start;
+    return total;
 }
 
 /**
@@ -2563,13 +2909,14 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex2>& mesh, const Mat4& m
         _vertData[_vertSize+ii].position = Vec3(it->position,_depth);
         _vertData[_vertSize+ii].color = it->color;
         _vertData[_vertSize+ii].texcoord = it->texcoord;
-        _vertData[_vertSize+ii].position *= mat;
         if (tint && _gradient == nullptr) {
             _vertData[_vertSize+ii].color *= _color;
         }
         ii++;
     }
     
+    transformVertices(_vertSize, ii, mat);
+    
     int jj = 0;
     for(auto it = mesh.indices.begin(); it != mesh.indices.end(); ++it) {
         _indxData[_indxSize+jj] = _vertSize+(*it);
@@ -2586,10 +2933,12 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex2>& mesh, const Mat4& m
  * Returns the number of vertices added to the drawing buffer.
  *
  * This method is an alternate version of {@link #prepare} for the same
- * arguments.  It runs slower (e.g. the compiler cannot easily optimize
- * the loops) but it is guaranteed to work on any size array.  This
- * is important for avoiding memory corruption.  Unlike the perpare methods,
- * this method is guaranteed to flush, draining the vertex buffer.
+ * arguments.  It streams the mesh through the batch one primitive at
+ * a time, flushing whenever the next primitive would not fit. Hence
+ * it works on any size mesh, and a primitive is never split across
+ * two flushes. Vertices shared between primitives are only copied once
+ * per flush, and this method does not allocate memory (except to grow
+ * the remap table the first time it sees a larger mesh).
  *
  * @param mesh  The mesh to add to the buffer
  * @param mat   The transform to apply to the vertices
@@ -2598,39 +2947,47 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex2>& mesh, const Mat4& m
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex2>& mesh, const Mat4& mat, bool tint) {
-    std::unordered_map<Uint32, Uint32> offsets;
-    
     setUniformBlock(_context,tint);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
-    unsigned int start = _indxSize;
+    resetRemap(mesh.vertices.size());
+    unsigned int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    unsigned int vfirst = _vertSize;
+    unsigned int total = 0;
     
-    for(int ii = 0;  ii < mesh.indices.size(); ii += chunksize) {
+    for(size_t ii = 0;  ii+chunksize <= mesh.indices.size(); ii += chunksize) {
+        // Never split a primitive across a flush
         if (_indxSize+chunksize > _indxMax || _vertSize+chunksize > _vertMax) {
+            transformVertices(vfirst, _vertSize-vfirst, mat);
             flush();
-            offsets.clear();
+            resetRemap(mesh.vertices.size());
+            vfirst = _vertSize;
         }
         
-        for(int jj = 0; jj < chunksize; jj++) {
-            auto search = offsets.find(mesh.indices[ii+jj]);
-            if (search != offsets.end()) {
-                _indxData[_indxSize] = search->second;
+        for(unsigned int jj = 0; jj < chunksize; jj++) {
+            Uint32 index = mesh.indices[ii+jj];
+            CUAssertLog(index < mesh.vertices.size(), "Index %d is out of range", index);
+            if (_remapStamp[index] == _remapGen) {
+                _indxData[_indxSize] = _remapIndex[index];
             } else {
+                const SpriteVertex2& vertex = mesh.vertices[index];
                 _indxData[_indxSize] = _vertSize;
-                _vertData[_vertSize].position = Vec3(mesh.vertices[ii+jj].position,_depth);
-                _vertData[_vertSize].color = mesh.vertices[ii+jj].color;
-                _vertData[_vertSize].texcoord = mesh.vertices[ii+jj].texcoord;
-                _vertData[_vertSize].position *= mat;
+                _vertData[_vertSize].position = Vec3(vertex.position,_depth);
+                _vertData[_vertSize].color = vertex.color;
+                _vertData[_vertSize].texcoord = vertex.texcoord;
                 if (tint && _gradient == nullptr) {
                     _vertData[_vertSize].color *= _color;
                 }
+                _remapStamp[index] = _remapGen;
+                _remapIndex[index] = _vertSize;
                 _vertSize++;
+                total++;
             }
             _indxSize++;
         }
     }
 
+    transformVertices(vfirst, _vertSize-vfirst, mat);
     _inflight = true;
-    return (unsigned int)(mesh.indices.size()+start);
+    return total;
 }
 
 /**
@@ -2659,13 +3016,14 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex3>& mesh, const Mat4& m
     int ii = 0;
     for(auto it = mesh.vertices.begin(); it != mesh.vertices.end(); ++it) {
         _vertData[_vertSize+ii] = *it;
-        _vertData[_vertSize+ii].position *= mat;
         if (tint && _gradient == nullptr) {
             _vertData[_vertSize+ii].color *= _color;
         }
         ii++;
     }
     
+    transformVertices(_vertSize, ii, mat);
+    
     int jj = 0;
     for(auto it = mesh.indices.begin(); it != mesh.indices.end(); ++it) {
         _indxData[_indxSize+jj] = _vertSize+(*it);
@@ -2681,10 +3039,12 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex3>& mesh, const Mat4& m
  * Returns the number of vertices added to the drawing buffer.
  *
  * This method is an alternate version of {@link #prepare} for the same
- * arguments.  It runs slower (e.g. the compiler cannot easily optimize
- * the loops) but it is guaranteed to work on any size array.  This
- * is important for avoiding memory corruption.  Unlike the perpare methods,
- * this method is guaranteed to flush, draining the vertex buffer.
+ * arguments.  It streams the mesh through the batch one primitive at
+ * a time, flushing whenever the next primitive would not fit. Hence
+ * it works on any size mesh, and a primitive is never split across
+ * two flushes. Vertices shared between primitives are only copied once
+ * per flush, and this method does not allocate memory (except to grow
+ * the remap table the first time it sees a larger mesh).
  *
  * @param mesh  The mesh to add to the buffer
  * @param mat   The transform to apply to the vertices
@@ -2693,36 +3053,43 @@ unsigned int SpriteBatch::prepare(const Mesh<SpriteVertex3>& mesh, const Mat4& m
  * @return the number of vertices added to the drawing buffer.
  */
 unsigned int SpriteBatch::chunkify(const Mesh<SpriteVertex3>& mesh, const Mat4& mat, bool tint) {
-    std::unordered_map<Uint32, Uint32> offsets;
-    
     setUniformBlock(_context,tint);
-    int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
-    unsigned int start = _indxSize;
+    resetRemap(mesh.vertices.size());
+    unsigned int chunksize = _context->command == GL_TRIANGLES ? 3 : 2;
+    unsigned int vfirst = _vertSize;
+    unsigned int total = 0;
     
-    for(int ii = 0;  ii < mesh.indices.size(); ii += chunksize) {
+    for(size_t ii = 0;  ii+chunksize <= mesh.indices.size(); ii += chunksize) {
+        // Never split a primitive across a flush
         if (_indxSize+chunksize > _indxMax || _vertSize+chunksize > _vertMax) {
+            transformVertices(vfirst, _vertSize-vfirst, mat);
             flush();
-            offsets.clear();
+            resetRemap(mesh.vertices.size());
+            vfirst = _vertSize;
         }
         
-        for(int jj = 0; jj < chunksize; jj++) {
-            auto search = offsets.find(mesh.indices[ii+jj]);
-            if (search != offsets.end()) {
-                _indxData[_indxSize] = search->second;
+        for(unsigned int jj = 0; jj < chunksize; jj++) {
+            Uint32 index = mesh.indices[ii+jj];
+            CUAssertLog(index < mesh.vertices.size(), "Index %d is out of range", index);
+            if (_remapStamp[index] == _remapGen) {
+                _indxData[_indxSize] = _remapIndex[index];
             } else {
                 _indxData[_indxSize] = _vertSize;
-                _vertData[_vertSize] = mesh.vertices[ii+jj];
-                _vertData[_vertSize].position *= mat;
+                _vertData[_vertSize] = mesh.vertices[index];
                 if (tint && _gradient == nullptr) {
                     _vertData[_vertSize].color *= _color;
                 }
+                _remapStamp[index] = _remapGen;
+                _remapIndex[index] = _vertSize;
                 _vertSize++;
+                total++;
             }
             _indxSize++;
         }
     }
 
+    transformVertices(vfirst, _vertSize-vfirst, mat);
     _inflight = true;
-    return (unsigned int)(mesh.indices.size()+start);
+    return total;
 }
 
@@ -34,7 +34,10 @@
 #include <sstream>
 #include <cugl/util/CUDebug.h>
 #include <cugl/util/CUFiletools.h>
+#include <cugl/util/CUStrings.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CUCompressedImage.h>
+#include <cugl/render/CURenderRecorder.h>
 
 using namespace cugl;
 
@@ -177,6 +180,9 @@ _magFilter(GL_LINEAR),
 _wrapS(GL_CLAMP_TO_EDGE),
 _wrapT(GL_CLAMP_TO_EDGE),
 _hasMipmaps(false),
+_compression(0),
+_compressedSize(0),
+_resolution(1),
 _parent(nullptr),
 _bindpoint(0),
 _minS(0),
@@ -193,7 +199,7 @@ _dirty(false) {}
 void Texture::dispose() {
     if (_buffer != 0) {
         // Do we own the texture?
-        if (_parent == nullptr) {
+        if (_parent == nullptr && !RenderRecorder::isHeadless()) {
             glDeleteTextures(1, &_buffer);
         }
         _buffer = 0;
@@ -206,6 +212,9 @@ void Texture::dispose() {
         _minS = _minT = 0;
         _maxS = _maxT = 1;
         _hasMipmaps = false;
+        _compression = 0;
+        _compressedSize = 0;
+        _resolution = 1;
         _bindpoint  = 0;
         _dirty = false;
     }
@@ -238,6 +247,18 @@ bool Texture::initWithData(const void *data, int width, int height, Texture::Pix
         return false; // In case asserts are off.
     }
     
+    if (RenderRecorder::isHeadless()) {
+        _buffer = RenderRecorder::genHandle();
+        _width  = width;
+        _height = height;
+        _pixelFormat = format;
+        RenderRecorder::recordUpload(GL_TEXTURE_2D, getByteSize()*width*height);
+        std::stringstream ss;
+        ss << "@" << data;
+        setName(ss.str());
+        return true;
+    }
+    
     glGenTextures(1, &_buffer);
     if (_buffer == 0) {
         error = glGetError();
@@ -253,6 +274,7 @@ bool Texture::initWithData(const void *data, int width, int height, Texture::Pix
 
     GLint  internal = internal_format(format);
     GLenum datatype = format_type(format);
+    RenderRecorder::recordUpload(GL_TEXTURE_2D, getByteSize()*width*height);
     glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, (GLenum)format, datatype, data);
     
     error = glGetError();
@@ -288,12 +310,26 @@ bool Texture::initWithData(const void *data, int width, int height, Texture::Pix
  * The texture will be stored in RGBA format, even if it is a file format
  * that does not support transparency (e.g. JPEG).
  *
+ * If the file has the extension ".ktx", it is read as a compressed image
+ * instead.  See {@link #initWithImage} for the details.
+ *
  * @param filename  The file supporting the texture file.
  *
  * @return true if initialization was successful.
  */
 bool Texture::initWithFile(const std::string filename) {
     std::string fullpath = filetool::normalize_path(filename);
+    if (strtool::tolower(filetool::base_suffix(fullpath)) == "ktx") {
+        std::shared_ptr<CompressedImage> image = CompressedImage::allocWithFile(fullpath);
+        if (image == nullptr) {
+            CULogError("Could not load file %s.", filename.c_str());
+            return false;
+        }
+        bool result = initWithImage(image);
+        if (result) setName(filename);
+        return result;
+    }
+
     SDL_Surface* surface = IMG_Load(fullpath.c_str());
     if (surface == nullptr) {
         CULogError("Could not load file %s. %s", filename.c_str(), SDL_GetError());
@@ -318,6 +354,89 @@ bool Texture::initWithFile(const std::string filename) {
     return result;
 }
 
+/**
+ * Initializes a texture with the given compressed image.
+ *
+ * Initializing a texture requires the use of texture offset 0.  Any texture
+ * bound to that offset will be unbound.  In addition, once initialization
+ * is done, this texture will not longer be bound as well.
+ *
+ * The compressed data is uploaded to the GPU as-is, including any mipmap
+ * levels in the image.  The image format must be supported by the GPU
+ * (see {@link CompressedImage#isSupported}).  The pixel format of a
+ * compressed texture is RGBA (or RGB if the image has no alpha), but its
+ * contents cannot be changed with {@link #set}.
+ *
+ * @param image     The compressed image
+ *
+ * @return true if initialization was successful.
+ */
+bool Texture::initWithImage(const std::shared_ptr<CompressedImage>& image) {
+    CUAssertLog(image != nullptr && image->getLevelCount() > 0, "Compressed image is not valid");
+    GLenum error;
+
+    if (_buffer) {
+        CUAssertLog(false, "Texture is already initialized");
+        return false; // In case asserts are off.
+    } else if (!CompressedImage::isSupported(image->getFormat())) {
+        CULogError("Compressed format 0x%04X is not supported", (GLenum)image->getFormat());
+        return false;
+    }
+
+    size_t levels = image->getLevelCount();
+    if (RenderRecorder::isHeadless()) {
+        _buffer = RenderRecorder::genHandle();
+    } else {
+        glGenTextures(1, &_buffer);
+        if (_buffer == 0) {
+            error = glGetError();
+            CULogError("Could not allocate texture. %s", gl_error_name(error).c_str());
+            return false;
+        }
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _buffer);
+        for(size_t ii = 0; ii < levels; ii++) {
+            size_t size;
+            const Uint8* data = image->getLevel(ii, size);
+            GLsizei w = std::max(1u,image->getWidth() >> ii);
+            GLsizei h = std::max(1u,image->getHeight() >> ii);
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)ii, (GLenum)image->getFormat(),
+                                   w, h, 0, (GLsizei)size, data);
+        }
+        
+        error = glGetError();
+        if (error) {
+            CULogError("Could not initialize texture. %s", gl_error_name(error).c_str());
+            glDeleteTextures(1, &_buffer);
+            _buffer = 0;
+            return false;
+        }
+    }
+
+    _width  = image->getWidth();
+    _height = image->getHeight();
+    _pixelFormat = image->hasAlpha() ? PixelFormat::RGBA : PixelFormat::RGB;
+    _compression = (GLenum)image->getFormat();
+    _compressedSize = image->getByteSize();
+    _hasMipmaps = levels > 1;
+    RenderRecorder::recordUpload(GL_TEXTURE_2D, _compressedSize);
+
+    if (!RenderRecorder::isHeadless()) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels-1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _wrapT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    std::stringstream ss;
+    ss << "@" << image.get();
+    setName(ss.str());
+    return true;
+}
+
 /**
  * Returns a blank texture that can be used to make solid shapes.
  *
@@ -366,8 +485,15 @@ const Texture& Texture::set(const void *data) {
     if (!isActive()) {
         CUAssertLog(false,"Texture %s is not currently active.",_name.c_str());
         return *this;
+    } else if (isCompressed()) {
+        CUAssertLog(false,"Texture %s is compressed.",_name.c_str());
+        return *this;
     }
 
+    RenderRecorder::recordUpload(GL_TEXTURE_2D, getByteSize()*_width*_height);
+    if (RenderRecorder::isHeadless()) {
+        return *this;
+    }
     glTexImage2D(GL_TEXTURE_2D, 0, (GLenum)_pixelFormat, _width, _height, 0,
                  (GLenum)_pixelFormat, GL_UNSIGNED_BYTE, data);
     return *this;
@@ -404,6 +530,47 @@ unsigned int Texture::getByteSize() const {
     return GL_RGBA8;
 }
 
+/**
+ * Sets the number of pixels per logical unit.
+ *
+ * A texture may be loaded at a reduced resolution to save memory on
+ * small displays (see {@link TextureLoader}).  In that case the pixel
+ * data is smaller, but the texture reports the size of the full
+ * resolution image.  This keeps any sizes derived from the texture,
+ * such as atlas regions, filmstrip frames, and node content sizes,
+ * the same across all resolutions.
+ *
+ * This method may not be called on a subtexture.  It has to be set on
+ * the parent texture.
+ *
+ * @param resolution    The number of pixels per logical unit.
+ */
+void Texture::setResolution(float resolution) {
+    CUAssertLog(_parent == nullptr, "Cannot set the resolution of a subtexture");
+    CUAssertLog(resolution > 0, "Resolution %f is not positive", resolution);
+    _resolution = resolution;
+}
+
+/**
+ * Returns the (approximate) video memory used by this texture in bytes.
+ *
+ * For an uncompressed texture this is the size of the pixel data, plus
+ * a third for the mipmaps (if any).  For a compressed texture it is the
+ * exact size of the compressed data.  A subtexture shares the memory of
+ * its parent, so its footprint is 0.
+ *
+ * @return the (approximate) video memory used by this texture in bytes.
+ */
+size_t Texture::getFootprint() const {
+    if (_parent != nullptr || _buffer == 0) {
+        return 0;
+    } else if (_compression != 0) {
+        return _compressedSize;
+    }
+    size_t bytes = (size_t)_width*_height*getByteSize();
+    return _hasMipmaps ? bytes+bytes/3 : bytes;
+}
+
 /**
  * Builds mipmaps for the current texture.
  *
@@ -411,14 +578,22 @@ unsigned int Texture::getByteSize() const {
  * texture can have mipmaps.  In addition, mipmaps can only be built if the
  * texture size is a power of two.
  *
+ * This method has no effect on a compressed texture, as its mipmaps
+ * (if any) are part of the compressed image.
+ *
  * This method is only successful if the texture is currently active.
  */
 void Texture::buildMipMaps() {
+    if (isCompressed()) {
+        return;
+    }
     CUAssertLog(nextPOT(_width)  == _width,  "Width  %d is not a power of two", _width);
     CUAssertLog(nextPOT(_height) == _height, "Height %d is not a power of two", _height);
     CUAssertLog(_parent == nullptr, "Cannot build mipmaps for a subtexture");
     CUAssertLog(isActive(), "Texture is not active");
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (!RenderRecorder::isHeadless()) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
     _hasMipmaps = true;
 }
 
@@ -439,7 +614,7 @@ void Texture::buildMipMaps() {
 void Texture::setMinFilter(GLuint minFilter) {
     CUAssertLog(_parent == nullptr, "Cannot set filters for a subtexture");
     _minFilter = minFilter;
-    if (isActive()) {
+    if (isActive() && !RenderRecorder::isHeadless()) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _minFilter);
     } else {
     	_dirty = true;
@@ -463,7 +638,7 @@ void Texture::setMinFilter(GLuint minFilter) {
 void Texture::setMagFilter(GLuint magFilter) {
     CUAssertLog(_parent == nullptr, "Cannot set filters for a subtexture");
     _magFilter = magFilter;
-    if (isActive()) {
+    if (isActive() && !RenderRecorder::isHeadless()) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _magFilter);
 	} else {
     	_dirty = true;
@@ -486,7 +661,7 @@ void Texture::setMagFilter(GLuint magFilter) {
 void Texture::setWrapS(GLuint wrap) {
     CUAssertLog(_parent == nullptr, "Cannot set wrap S for a subtexture");
     _wrapS = wrap;
-    if (isActive()) {
+    if (isActive() && !RenderRecorder::isHeadless()) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _wrapS);
 	} else {
     	_dirty = true;
@@ -509,7 +684,7 @@ void Texture::setWrapS(GLuint wrap) {
 void Texture::setWrapT(GLuint wrap) {
     CUAssertLog(_parent == nullptr, "Cannot set wrap T for a subtexture");
     _wrapT = wrap;
-    if (isActive()) {
+    if (isActive() && !RenderRecorder::isHeadless()) {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _wrapT);
 	} else {
     	_dirty = true;
@@ -593,6 +768,13 @@ std::shared_ptr<Texture> Texture::getSubTexture(GLfloat minS, GLfloat maxS,
  * @param the texture location to associate with this texture.
  */
 void Texture::setBindPoint(GLuint point) {
+    if (RenderRecorder::isHeadless()) {
+        if (RenderRecorder::getBinding(GL_TEXTURE_BINDING_2D,_bindpoint) == _buffer) {
+            RenderRecorder::setBinding(GL_TEXTURE_BINDING_2D, 0, _bindpoint);
+        }
+        _bindpoint = point;
+        return;
+    }
     GLint orig;
     glGetIntegerv(GL_ACTIVE_TEXTURE,&orig);
     if (orig != _bindpoint+GL_TEXTURE0) {
@@ -633,6 +815,13 @@ void Texture::bind() {
         return;
     }
     
+    RenderRecorder::recordTexture(_buffer);
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_ACTIVE_TEXTURE, GL_TEXTURE0+_bindpoint);
+        RenderRecorder::setBinding(GL_TEXTURE_BINDING_2D, _buffer, _bindpoint);
+        _dirty = false;
+        return;
+    }
     glActiveTexture(GL_TEXTURE0+_bindpoint);
     glBindTexture(GL_TEXTURE_2D,_buffer);
     if (_dirty) {
@@ -661,6 +850,10 @@ void Texture::unbind() {
         return;
     }
 
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_TEXTURE_BINDING_2D, 0, _bindpoint);
+        return;
+    }
     GLint orig;
     glGetIntegerv(GL_ACTIVE_TEXTURE,&orig);
     if (orig != _bindpoint+GL_TEXTURE0) {
@@ -688,6 +881,8 @@ void Texture::unbind() {
 bool Texture::isBound() const {
     if (!_buffer) {
         return false;
+    } else if (RenderRecorder::isHeadless()) {
+        return RenderRecorder::getBinding(GL_TEXTURE_BINDING_2D,_bindpoint) == _buffer;
     }
     
     GLint orig;
@@ -720,6 +915,9 @@ bool Texture::isBound() const {
 bool Texture::isActive() const {
     if (!_buffer) {
         return false;
+    } else if (RenderRecorder::isHeadless()) {
+        return (RenderRecorder::getBinding(GL_ACTIVE_TEXTURE) == _bindpoint+GL_TEXTURE0 &&
+                RenderRecorder::getBinding(GL_TEXTURE_BINDING_2D,_bindpoint) == _buffer);
     }
     GLint orig;
     glGetIntegerv(GL_ACTIVE_TEXTURE,&orig);
@@ -779,7 +977,10 @@ bool Texture::save(const std::string file) {
     CUAssertLog(false, "Texture saving is not supported in OpenGLES");
     return false;
 #else
-    if (!isActive()) {
+    if (RenderRecorder::isHeadless()) {
+        CULogError("Texture %s cannot be saved without a graphics context.",_name.c_str());
+        return false;
+    } else if (!isActive()) {
         CUAssertLog(false,"Texture %s is not currently active.",_name.c_str());
         return false;
     } else if (!filetool::is_absolute(file)) {
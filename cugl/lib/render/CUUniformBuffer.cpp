@@ -44,6 +44,10 @@
 //  Version: 2/29/20
 #include <cugl/util/CUDebug.h>
 #include <cugl/render/CUUniformBuffer.h>
+#include <cugl/render/CURenderRecorder.h>
+
+/** The block alignment assumed when there is no OpenGL context */
+#define HEADLESS_ALIGNMENT  256
 
 using namespace cugl;
 
@@ -116,11 +120,21 @@ bool UniformBuffer::init(GLsizei capacity, GLuint blocks) {
     _blocksize = capacity;
     
     GLint value;
-    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+    if (RenderRecorder::isHeadless()) {
+        value = HEADLESS_ALIGNMENT;
+    } else {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+    }
     while (_blockstride < _blocksize) {
         _blockstride += value;
     }
     
+    if (RenderRecorder::isHeadless()) {
+        _dataBuffer = RenderRecorder::genHandle();
+        _bytebuffer = (char*)malloc(_blockstride*_blockcount);
+        return true;
+    }
+    
     // Quit if the memory request is too high
     glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &value);
     if (_blockstride > value) {
@@ -162,7 +176,9 @@ bool UniformBuffer::init(GLsizei capacity, GLuint blocks) {
  */
 void UniformBuffer::dispose() {
     if (_dataBuffer) {
-        glDeleteBuffers(1,&_dataBuffer);
+        if (!RenderRecorder::isHeadless()) {
+            glDeleteBuffers(1,&_dataBuffer);
+        }
         _dataBuffer = 0;
     }
     if (_bytebuffer) {
@@ -198,10 +214,16 @@ void UniformBuffer::dispose() {
  * @param point The bind point for for this uniform buffer.
  */
 void UniformBuffer::setBindPoint(GLuint point) {
-    GLint bound;
-    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING,_bindpoint,&bound);
-    if (bound == _dataBuffer) {
-        glBindBufferBase(GL_UNIFORM_BUFFER, _bindpoint, 0);
+    if (RenderRecorder::isHeadless()) {
+        if (isBound()) {
+            RenderRecorder::setBinding(GL_UNIFORM_BUFFER_BINDING, 0, _bindpoint);
+        }
+    } else {
+        GLint bound;
+        glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING,_bindpoint,&bound);
+        if (bound == _dataBuffer) {
+            glBindBufferBase(GL_UNIFORM_BUFFER, _bindpoint, 0);
+        }
     }
     _bindpoint = point;
 }
@@ -230,6 +252,10 @@ void UniformBuffer::bind(bool activate) {
     if (activate) {
         this->activate();
     }
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_UNIFORM_BUFFER_BINDING, _dataBuffer, _bindpoint);
+        return;
+    }
     glBindBufferBase(GL_UNIFORM_BUFFER, _bindpoint, _dataBuffer);
 }
 
@@ -247,10 +273,16 @@ void UniformBuffer::bind(bool activate) {
  * This call is reentrant.  If can be safely called multiple times.
  */
 void UniformBuffer::unbind() {
-    GLint bound;
-    glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING,_bindpoint,&bound);
-    if (bound == _dataBuffer) {
-        glBindBufferBase(GL_UNIFORM_BUFFER, _bindpoint, 0);
+    if (RenderRecorder::isHeadless()) {
+        if (isBound()) {
+            RenderRecorder::setBinding(GL_UNIFORM_BUFFER_BINDING, 0, _bindpoint);
+        }
+    } else {
+        GLint bound;
+        glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING,_bindpoint,&bound);
+        if (bound == _dataBuffer) {
+            glBindBufferBase(GL_UNIFORM_BUFFER, _bindpoint, 0);
+        }
     }
 }
 
@@ -269,9 +301,16 @@ void UniformBuffer::unbind() {
  * This call is reentrant.  If can be safely called multiple times.
  */
 void UniformBuffer::activate() {
-    glBindBuffer(GL_UNIFORM_BUFFER, _dataBuffer);
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_UNIFORM_BUFFER, _dataBuffer);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, _dataBuffer);
+    }
     if (_autoflush && _dirty) {
-        glBufferData(GL_UNIFORM_BUFFER,_blockstride*_blockcount,_bytebuffer,_drawtype);
+        RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, _blockstride*_blockcount);
+        if (!RenderRecorder::isHeadless()) {
+            glBufferData(GL_UNIFORM_BUFFER,_blockstride*_blockcount,_bytebuffer,_drawtype);
+        }
         _dirty = false;
     }
 }
@@ -288,6 +327,12 @@ void UniformBuffer::activate() {
  * This call is reentrant.  If can be safely called multiple times.
  */
 void UniformBuffer::deactivate() {
+    if (RenderRecorder::isHeadless()) {
+        if (isActive()) {
+            RenderRecorder::setBinding(GL_UNIFORM_BUFFER, 0);
+        }
+        return;
+    }
 #if CU_PLATFORM == CU_PLATFORM_ANDROID
  	// There are problems with this query on emulator
  	glBindBuffer(GL_UNIFORM_BUFFER, 0);
@@ -310,6 +355,9 @@ void UniformBuffer::deactivate() {
  * @return true if this uniform block is currently bound.
  */
 bool UniformBuffer::isBound() const {
+    if (RenderRecorder::isHeadless()) {
+        return RenderRecorder::getBinding(GL_UNIFORM_BUFFER_BINDING, _bindpoint) == _dataBuffer;
+    }
     GLint bound;
     glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING,_bindpoint,&bound);
     return bound == _dataBuffer;
@@ -329,6 +377,9 @@ bool UniformBuffer::isBound() const {
  * @return true if this uniform block is currently active.
  */
 bool UniformBuffer::isActive() const {
+    if (RenderRecorder::isHeadless()) {
+        return RenderRecorder::getBinding(GL_UNIFORM_BUFFER) == _dataBuffer;
+    }
     GLint bound;
     glGetIntegerv(GL_UNIFORM_BUFFER_BINDING,&bound);
     return bound == _dataBuffer;
@@ -347,8 +398,11 @@ void UniformBuffer::setBlock(GLuint block) {
     CUAssertLog(isBound(), "Buffer is not bound.");
     if (_blockpntr != block) {
         _blockpntr = block;
-        glBindBufferRange(GL_UNIFORM_BUFFER,_bindpoint,_dataBuffer,
-                          block*_blockstride,_blocksize);
+        RenderRecorder::recordState(GL_UNIFORM_BUFFER_BINDING);
+        if (!RenderRecorder::isHeadless()) {
+            glBindBufferRange(GL_UNIFORM_BUFFER,_bindpoint,_dataBuffer,
+                              block*_blockstride,_blocksize);
+        }
     }
 }
 
@@ -362,7 +416,10 @@ void UniformBuffer::setBlock(GLuint block) {
  */
 void UniformBuffer::flush() {
     // CUAssertLog(isActive(), "Buffer is not active."); // Problems on android emulator for now
-    glBufferData(GL_UNIFORM_BUFFER,_blockstride*_blockcount,_bytebuffer,_drawtype);
+    RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, _blockstride*_blockcount);
+    if (!RenderRecorder::isHeadless()) {
+        glBufferData(GL_UNIFORM_BUFFER,_blockstride*_blockcount,_bytebuffer,_drawtype);
+    }
     _dirty = false;
 }
 
@@ -1237,7 +1294,10 @@ void UniformBuffer::setUniformfv(GLint block, GLsizei offset, GLsizei size, cons
         GLsizei position = block*_blockstride+offset;
         std::memcpy(_bytebuffer+position, values, size*sizeof(float));
         if (_autoflush && isActive()) {
-            glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(float), values);
+            RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(float));
+            if (!RenderRecorder::isHeadless()) {
+                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(float), values);
+            }
         } else {
             _dirty = true;
         }
@@ -1252,7 +1312,10 @@ void UniformBuffer::setUniformfv(GLint block, GLsizei offset, GLsizei size, cons
             GLsizei position = block*_blockstride+offset;
             std::memcpy(_bytebuffer+position, values, size*sizeof(float));
             if (active) {
-                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(float), values);
+                RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(float));
+                if (!RenderRecorder::isHeadless()) {
+                    glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(float), values);
+                }
             }
         }
     }
@@ -1354,7 +1417,10 @@ void UniformBuffer::setUniformiv(GLint block, GLsizei offset, GLsizei size, cons
         GLsizei position = block*_blockstride+offset;
         std::memcpy(_bytebuffer+position, values, size*sizeof(GLint));
         if (_autoflush && isActive()) {
-            glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLint), values);
+            RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(GLint));
+            if (!RenderRecorder::isHeadless()) {
+                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLint), values);
+            }
         } else {
             _dirty = true;
         }
@@ -1369,7 +1435,10 @@ void UniformBuffer::setUniformiv(GLint block, GLsizei offset, GLsizei size, cons
             GLsizei position = block*_blockstride+offset;
             std::memcpy(_bytebuffer+position, values, size*sizeof(GLint));
             if (active) {
-                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLint), values);
+                RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(GLint));
+                if (!RenderRecorder::isHeadless()) {
+                    glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLint), values);
+                }
             }
         }
     }
@@ -1471,7 +1540,10 @@ void UniformBuffer::setUniformuiv(GLint block, GLsizei offset, GLsizei size, con
         GLsizei position = block*_blockstride+offset;
         std::memcpy(_bytebuffer+position, values, size*sizeof(GLuint));
         if (_autoflush && isActive()) {
-            glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLuint), values);
+            RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(GLuint));
+            if (!RenderRecorder::isHeadless()) {
+                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLuint), values);
+            }
         } else {
             _dirty = true;
         }
@@ -1486,7 +1558,10 @@ void UniformBuffer::setUniformuiv(GLint block, GLsizei offset, GLsizei size, con
             GLsizei position = block*_blockstride+offset;
             std::memcpy(_bytebuffer+position, values, size*sizeof(GLuint));
             if (active) {
-                glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLuint), values);
+                RenderRecorder::recordUpload(GL_UNIFORM_BUFFER, size*sizeof(GLuint));
+                if (!RenderRecorder::isHeadless()) {
+                    glBufferSubData(GL_UNIFORM_BUFFER, position, size*sizeof(GLuint), values);
+                }
             }
         }
     }
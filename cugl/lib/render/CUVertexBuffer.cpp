@@ -33,6 +33,7 @@
 #include <cugl/render/CUVertexBuffer.h>
 #include <cugl/render/CUShader.h>
 #include <cugl/render/CUTexture.h>
+#include <cugl/render/CURenderRecorder.h>
 
 using namespace cugl;
 
@@ -74,6 +75,13 @@ VertexBuffer::~VertexBuffer() {
  */
 bool VertexBuffer::init(GLsizei stride) {
     _stride = stride;
+    if (RenderRecorder::isHeadless()) {
+        _vertArray  = RenderRecorder::genHandle();
+        _vertBuffer = RenderRecorder::genHandle();
+        _indxBuffer = RenderRecorder::genHandle();
+        return true;
+    }
+
     glGenVertexArrays (1, &_vertArray);
     if (!_vertArray) {
         GLenum error = glGetError();
@@ -113,9 +121,13 @@ void VertexBuffer::dispose() {
     }
     _enabled.clear();
     _attributes.clear();
-    glDeleteBuffers(1,&_indxBuffer);
-    glDeleteBuffers(1,&_vertBuffer);
-    glDeleteVertexArrays(1,&_vertArray);
+    if (!RenderRecorder::isHeadless()) {
+        glDeleteBuffers(1,&_indxBuffer);
+        glDeleteBuffers(1,&_vertBuffer);
+        glDeleteVertexArrays(1,&_vertArray);
+    } else if (isBound()) {
+        RenderRecorder::setBinding(GL_VERTEX_ARRAY_BINDING, 0);
+    }
     _indxBuffer = 0;
     _vertBuffer = 0;
     _vertArray  = 0;
@@ -139,9 +151,13 @@ void VertexBuffer::dispose() {
  */
 void VertexBuffer::bind() {
     CUAssertLog(_vertBuffer, "VertexBuffer has not be initialized.");
-    glBindVertexArray(_vertArray);
-	glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::setBinding(GL_VERTEX_ARRAY_BINDING, _vertArray);
+    } else {
+        glBindVertexArray(_vertArray);
+        glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
+        glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    }
     if (_shader != nullptr) {
         _shader->bind();
     }
@@ -159,7 +175,11 @@ void VertexBuffer::bind() {
  * set again when the vertex buffer is next bound.
  */
 void VertexBuffer::unbind() {
-    if (isBound()) {
+    if (RenderRecorder::isHeadless()) {
+        if (isBound()) {
+            RenderRecorder::setBinding(GL_VERTEX_ARRAY_BINDING, 0);
+        }
+    } else if (isBound()) {
         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
         glBindBuffer( GL_ARRAY_BUFFER, 0 );
         glBindVertexArray(0);
@@ -181,6 +201,9 @@ void VertexBuffer::attach(const std::shared_ptr<Shader>& shader) {
     if (_shader != shader) {
         _shader = shader;
         bind();
+        if (RenderRecorder::isHeadless()) {
+            return;
+        }
         
         // Link up attributes on the first time
         for(auto it = _attributes.begin(); it != _attributes.end(); ++it) {
@@ -225,6 +248,9 @@ std::shared_ptr<Shader> VertexBuffer::detach() {
  * @return true if this vertex is currently bound.
  */
 bool VertexBuffer::isBound() const {
+    if (RenderRecorder::isHeadless()) {
+        return RenderRecorder::getBinding(GL_VERTEX_ARRAY_BINDING) == _vertArray;
+    }
     GLint vao;
     glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
     return vao == _vertArray;
@@ -260,6 +286,10 @@ bool VertexBuffer::isBound() const {
  */
 void VertexBuffer::loadVertexData(const void * data, GLsizei size, GLenum usage) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
+    RenderRecorder::recordVertices(size, _stride * size);
+    if (RenderRecorder::isHeadless()) {
+        return;
+    }
     glBufferData( GL_ARRAY_BUFFER, _stride * size, data, usage );
     
     GLenum error = glGetError();
@@ -294,6 +324,10 @@ void VertexBuffer::loadVertexData(const void * data, GLsizei size, GLenum usage)
  */
 void VertexBuffer::loadIndexData(const void * data, GLsizei size, GLenum usage) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
+    RenderRecorder::recordUpload(GL_ELEMENT_ARRAY_BUFFER, size * sizeof(GLuint));
+    if (RenderRecorder::isHeadless()) {
+        return;
+    }
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, size * sizeof(GLuint), data, usage );
     GLenum error = glGetError();
     CUAssertLog(error == GL_NO_ERROR, "VertexBuffer: %s", gl_error_name(error).c_str());
@@ -322,6 +356,10 @@ void VertexBuffer::loadIndexData(const void * data, GLsizei size, GLenum usage)
  */
 void VertexBuffer::draw(GLenum mode, GLsizei count, GLsizei offset) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
+    RenderRecorder::recordDraw(mode, count);
+    if (RenderRecorder::isHeadless()) {
+        return;
+    }
     glDrawElements(mode, count, GL_UNSIGNED_INT, (void*)(offset * sizeof(GLuint)));
 }
 
@@ -356,6 +394,10 @@ void VertexBuffer::draw(GLenum mode, GLsizei count, GLsizei offset) {
  */
 void VertexBuffer::drawInstanced(GLenum mode, GLsizei count, GLsizei instance, GLsizei offset) {
     //CUAssertLog(isBound(), "Vertex buffer is not bound"); // Problems on android emulator for now
+    RenderRecorder::recordDraw(mode, count, instance);
+    if (RenderRecorder::isHeadless()) {
+        return;
+    }
     glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, (void*)(offset * sizeof(GLuint)), instance);
 }
 
@@ -390,7 +432,7 @@ void VertexBuffer::setupAttribute(const std::string name, GLint size, GLenum typ
     _attributes[name] = data;
     _enabled[name] = true;
     
-    if (_shader != nullptr) {
+    if (_shader != nullptr && !RenderRecorder::isHeadless()) {
         _shader->bind();
         GLint pos = glGetAttribLocation(_shader->getProgram(), name.c_str());
         if (pos == -1) {
@@ -421,7 +463,7 @@ void VertexBuffer::enableAttribute(const std::string name) {
     CUAssertLog(isBound(), "Vertex buffer is not bound.");
 	if (!_enabled[name]) {
 		_enabled[name] = true;
-		if (_shader != nullptr) {
+		if (_shader != nullptr && !RenderRecorder::isHeadless()) {
 			GLint locale = _shader->getUniformLocation(name);
 			glEnableVertexAttribArray(locale);
 		}
@@ -443,7 +485,7 @@ void VertexBuffer::disableAttribute(const std::string name) {
     CUAssertLog(isBound(), "Vertex buffer is not bound.");
 	if (_enabled[name]) {
 		_enabled[name] = false;
-		if (_shader != nullptr) {
+		if (_shader != nullptr && !RenderRecorder::isHeadless()) {
 			GLint locale = _shader->getUniformLocation(name);
 			glDisableVertexAttribArray(locale);
 		}
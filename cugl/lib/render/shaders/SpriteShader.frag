@@ -35,7 +35,7 @@ R"(////////// SHADER BEGIN /////////
 precision highp float;  // highp required for gradient precision
 #endif
 
-// Bit vector for texturing, gradients, and scissoring
+// Bit vector for texturing, gradients, scissoring, blur, and distance fields
 uniform int  uType;
 // Blur offset for simple kernel blur
 uniform vec2 uBlur;
@@ -177,11 +177,18 @@ void main(void) {
     
     if (mod(fType, 2.0) == 1.0) {
         // Include texture (tinted by color or gradient)
-        if (uType >= 8) {
-            result *= blursample(outTexCoord);
+        vec4 texel;
+        if (mod(fType, 16.0) >= 8.0) {
+            texel = blursample(outTexCoord);
         } else {
-            result *= texture(uTexture, outTexCoord);
+            texel = texture(uTexture, outTexCoord);
         }
+        if (uType >= 16) {
+            // Distance fields put the edge at 0.5; smooth it over one pixel
+            float width = max(0.5*fwidth(texel.a), 0.0001);
+            texel.a = smoothstep(0.5-width, 0.5+width, texel.a);
+        }
+        result *= texel;
     }
     
     if (mod(fType, 8.0) >= 4.0) {
@@ -40,7 +40,10 @@
 //  Version: 7/1/16
 
 #include <cugl/scene2/CUScene2.h>
+#include <cugl/scene2/graph/CUCachedNode.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/util/CUThreadPool.h>
+#include <cugl/render/CUTexture.h>
 #include <sstream>
 #include <algorithm>
 
@@ -61,7 +64,8 @@ _color(Color4::WHITE),
 _blendEquation(GL_FUNC_ADD),
 _srcFactor(GL_SRC_ALPHA),
 _dstFactor(GL_ONE_MINUS_SRC_ALPHA),
-_active(false)
+_active(false),
+_parallel(false)
 {}
 
 /**
@@ -76,6 +80,7 @@ void Scene2::dispose() {
     _name = "";
     _color = Color4::WHITE;
     _active = false;
+    setParallel(false);
 }
 
 /**
@@ -418,9 +423,88 @@ void Scene2::render(const std::shared_ptr<SpriteBatch>& batch) {
     batch->setBlendFunc(_srcFactor, _dstFactor);
     batch->setBlendEquation(_blendEquation);
 
-    for(auto it = _children.begin(); it != _children.end(); ++it) {
-        (*it)->render(batch, Mat4::IDENTITY, _color);
+    // Redraw any caches that were stale in a parallel pass
+    scene2::CachedNode::refreshPending(batch);
+    if (_parallel && _children.size() > 1) {
+        renderParallel(batch);
+    } else {
+        for(auto it = _children.begin(); it != _children.end(); ++it) {
+            (*it)->render(batch, Mat4::IDENTITY, _color);
+        }
     }
 
     batch->end();
 }
+
+/**
+ * Sets whether this scene records its top-level children in parallel.
+ *
+ * When parallel recording is on, each top-level child of this scene is
+ * rendered into its own deferred {@link SpriteBatch}. The children are
+ * recorded on worker threads (and on the calling thread). Afterwards
+ * their recordings are replayed in order into the sprite batch passed
+ * to {@link #render}. All OpenGL calls stay on the calling thread, and
+ * the draw order is the same as serial rendering.
+ *
+ * The top-level children must be independent. In particular, their
+ * draw methods may not modify anything outside of their own subtree.
+ * All of the scene graph classes in this library are safe to record
+ * in parallel. A {@link scene2::CachedNode} still uses its cache when
+ * recorded in parallel. But a stale cache is only redrawn at the start of
+ * the next pass, as that requires the OpenGL thread. Until then, the
+ * subtree is recorded directly.
+ *
+ * @param value Whether to record the top-level children in parallel
+ */
+void Scene2::setParallel(bool value) {
+    _parallel = value;
+    if (value && _workers == nullptr) {
+        // Leave a core for the calling thread
+        int threads = std::max(SDL_GetCPUCount()-1,1);
+        _workers = ThreadPool::alloc(threads);
+    } else if (!value) {
+        _workers = nullptr;
+        _recorders.clear();
+    }
+}
+
+/**
+ * Records the top-level children in parallel and replays them into batch.
+ *
+ * The sprite batch must be actively drawing. This method blocks until
+ * all of the children have been recorded.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ */
+void Scene2::renderParallel(const std::shared_ptr<SpriteBatch>& batch) {
+    size_t count = _children.size();
+    unsigned int capacity = batch->getCapacity();
+    for(size_t ii = 0; ii < _recorders.size() && ii < count; ii++) {
+        if (_recorders[ii]->getCapacity() != capacity) {
+            _recorders[ii] = SpriteBatch::allocDeferred(capacity);
+        }
+    }
+    while (_recorders.size() < count) {
+        _recorders.push_back(SpriteBatch::allocDeferred(capacity));
+    }
+    
+    // The blank texture must be created on this thread
+    Texture::getBlank();
+    
+    Mat4 perspective = _camera->getCombined();
+    auto record = [&](size_t index) {
+        const std::shared_ptr<SpriteBatch>& recorder = _recorders[index];
+        recorder->begin(perspective);
+        recorder->setBlendFunc(_srcFactor, _dstFactor);
+        recorder->setBlendEquation(_blendEquation);
+        _children[index]->render(recorder, Mat4::IDENTITY, _color);
+        recorder->end();
+    };
+    
+    // The calling thread records children as well while it waits
+    _workers->parallel_for(0, count, 1, record);
+    
+    for(size_t ii = 0; ii < count; ii++) {
+        batch->replay(_recorders[ii]);
+    }
+}
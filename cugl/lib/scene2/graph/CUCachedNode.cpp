@@ -0,0 +1,496 @@
+//
+//  CUCachedNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that caches the rendering of its
+//  subtree in an offscreen texture. Most UI elements (menu panels, HUD
+//  decorations) only change in response to game state. There is no reason
+//  to tessellate and submit them to the sprite batch every animation frame.
+//  This node renders its children once, and then draws them as a single
+//  textured quad until one of its descendants changes.
+//
+//  Offscreen textures are a limited resource, particularly on mobile devices.
+//  Therefore all cached nodes share a single memory budget. When that budget
+//  is exceeded, the least recently drawn caches are evicted.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+#include <cugl/scene2/graph/CUCachedNode.h>
+#include <cugl/render/CUScissor.h>
+#include <cugl/render/CURenderRecorder.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace cugl;
+using namespace cugl::scene2;
+
+/** The number of bytes per texel (RGBA color plus depth/stencil) */
+#define CACHE_TEXEL_BYTES   8
+/** The scale increase (relative to the cache) that forces a redraw */
+#define CACHE_SCALE_UPPER   1.1f
+/** The scale decrease (relative to the cache) that forces a redraw */
+#define CACHE_SCALE_LOWER   0.5f
+
+size_t CachedNode::_budget = CU_CACHED_NODE_BUDGET;
+size_t CachedNode::_usage  = 0;
+int    CachedNode::_capturing = 0;
+std::list<CachedNode*> CachedNode::_residents;
+std::vector<CachedNode*> CachedNode::_stale;
+std::mutex CachedNode::_mutex;
+
+/**
+ * Returns true if a descendant of the node ignores the color of its parent
+ *
+ * @param node  The root of the subtree
+ *
+ * @return true if a descendant of the node ignores the color of its parent
+ */
+static bool has_absolute_color(const SceneNode* node) {
+    for(auto it = node->getChildren().begin(); it != node->getChildren().end(); ++it) {
+        if (!(*it)->hasRelativeColor() || has_absolute_color(it->get())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#pragma mark Constructors
+/**
+ * Creates an uninitialized cached node.
+ *
+ * You must initialize this CachedNode before use.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a CachedNode
+ * on the heap, use one of the static constructors instead.
+ */
+CachedNode::CachedNode() : SceneNode(),
+_target(nullptr),
+_cacheDirty(true),
+_caching(true),
+_cacheScale(0),
+_footprint(0),
+_absolute(false),
+_pending(false),
+_pendingScale(0) {
+}
+
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed CachedNode can be safely reinitialized. Any children owned by
+ * this node will be released. They will be deleted if no other object owns
+ * them. The offscreen buffer is released immediately.
+ *
+ * It is unsafe to call this on a CachedNode that is still currently inside
+ * of a scene graph.
+ */
+void CachedNode::dispose() {
+    if (_pending) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stale.erase(std::remove(_stale.begin(), _stale.end(), this), _stale.end());
+        _pending = false;
+    }
+    releaseCache();
+    _caching = true;
+    _cacheScale = 0;
+    SceneNode::dispose();
+}
+
+/**
+ * Initializes a node with the given JSON specificaton.
+ *
+ * This initializer is designed to receive the "data" object from the
+ * JSON passed to {@link Scene2Loader}. This JSON format supports all
+ * of the attribute values of its parent class. In addition, it supports
+ * the following additional attributes:
+ *
+ *      "caching":  A boolean indicating whether to cache the subtree
+ *
+ * All attributes are optional. There are no required attributes.
+ *
+ * @param loader    The scene loader passing this JSON file
+ * @param data      The JSON object specifying the node
+ *
+ * @return true if initialization was successful.
+ */
+bool CachedNode::initWithData(const Scene2Loader* loader, const std::shared_ptr<JsonValue>& data) {
+    if (SceneNode::initWithData(loader, data)) {
+        _caching = (data == nullptr ? true : data->getBool("caching",true));
+        return true;
+    }
+    return false;
+}
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Sets whether this node caches the rendering of its subtree.
+ *
+ * If this value is false, this node behaves exactly like a
+ * {@link SceneNode}. Disabling the cache immediately releases the
+ * offscreen buffer. This value is true by default.
+ *
+ * @param value Whether this node caches the rendering of its subtree.
+ */
+void CachedNode::setCaching(bool value) {
+    _caching = value;
+    if (!value) {
+        releaseCache();
+    }
+}
+
+/**
+ * Releases the offscreen buffer of this node.
+ *
+ * The subtree will be redrawn (and a new buffer allocated) the next
+ * time this node is rendered. You may want to call this when a cached
+ * node is removed from the scene but not deleted.
+ */
+void CachedNode::releaseCache() {
+    if (_target != nullptr) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _residents.erase(_residency);
+        _usage -= _footprint;
+        _footprint = 0;
+        _target = nullptr;
+    }
+    _cacheDirty = true;
+}
+
+/**
+ * Sets the untransformed size of the node.
+ *
+ * The content size is also the size of the offscreen buffer. Changing
+ * the size of this node will invalidate the current cache.
+ *
+ * @param size  The untransformed size of the node.
+ */
+void CachedNode::setContentSize(const Size size) {
+    SceneNode::setContentSize(size);
+    _cacheDirty = true;
+}
+
+#pragma mark -
+#pragma mark Memory Budget
+/**
+ * Sets the memory budget (in bytes) shared by all cached nodes.
+ *
+ * If the current memory usage exceeds the new budget, the least recently
+ * drawn caches are evicted immediately.
+ *
+ * @param bytes The memory budget (in bytes) shared by all cached nodes.
+ */
+void CachedNode::setMemoryBudget(size_t bytes) {
+    _budget = bytes;
+    reserve(0, nullptr);
+}
+
+/**
+ * Releases the offscreen buffers of all cached nodes.
+ *
+ * This is the appropriate response to a low-memory warning. Each node
+ * will redraw its cache the next time that it is rendered.
+ */
+void CachedNode::purgeAll() {
+    while (true) {
+        CachedNode* node = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_residents.empty()) {
+                return;
+            }
+            node = _residents.back();
+        }
+        node->releaseCache();
+    }
+}
+
+/**
+ * Evicts least recently drawn caches until the given bytes will fit.
+ *
+ * This method never evicts the cache of the given node. It returns
+ * false if the bytes will not fit even after all evictions.
+ *
+ * @param bytes     The number of bytes to make room for
+ * @param keep      A node whose cache should not be evicted
+ *
+ * @return true if the given bytes fit within the budget
+ */
+bool CachedNode::reserve(size_t bytes, const CachedNode* keep) {
+    size_t kept = (keep == nullptr ? 0 : keep->_footprint);
+    if (bytes+kept > _budget) {
+        // Do not evict anything if it is hopeless
+        return false;
+    }
+
+    while (true) {
+        // Releasing a cache takes the lock, so choose the victim first
+        CachedNode* node = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_usage+bytes <= _budget) {
+                return true;
+            }
+            for(auto it = _residents.rbegin(); node == nullptr && it != _residents.rend(); ++it) {
+                if (*it != keep) {
+                    node = *it;
+                }
+            }
+        }
+        if (node == nullptr) {
+            return false;
+        }
+        node->releaseCache();
+    }
+}
+
+#pragma mark -
+#pragma mark Rendering
+/**
+ * Records that a descendant of this node has changed its appearance.
+ *
+ * This invalidates the cache and passes the notification on to the
+ * ancestors of this node (which may be cached as well).
+ */
+void CachedNode::setChildDirty() {
+    _cacheDirty = true;
+    SceneNode::setChildDirty();
+}
+
+/**
+ * Redraws the subtree of this node into the offscreen buffer.
+ *
+ * The buffer is sized to match the screen resolution at the given world
+ * scale. This method will (re)allocate the buffer if necessary, evicting
+ * other caches to stay within the memory budget. It returns false if
+ * the buffer could not be allocated.
+ *
+ * The children are normally drawn untinted, and the cache is tinted when
+ * it is drawn. But if a descendant ignores the color of its parent, that
+ * would tint the descendant. In that case the children are drawn with the
+ * given tint instead, and the cache is stale whenever the tint changes.
+ *
+ * This method must be called in the middle of a sprite batch pass. It
+ * will end that pass and restart it when done.
+ *
+ * @param batch The SpriteBatch to draw with.
+ * @param scale The world scale of this node
+ * @param tint  The tint passed to the children of this node
+ *
+ * @return true if the cache was successfully redrawn.
+ */
+bool CachedNode::refresh(const std::shared_ptr<SpriteBatch>& batch, float scale, Color4 tint) {
+    // Match the resolution of the current viewport
+    GLint viewport[4];
+    if (RenderRecorder::isHeadless()) {
+        RenderRecorder::getViewport(viewport);
+    } else {
+        glGetIntegerv(GL_VIEWPORT, viewport);
+    }
+    Mat4 perspective = batch->getPerspective();
+    float density = std::max(fabsf(perspective.m[0])*viewport[2],
+                             fabsf(perspective.m[5])*viewport[3])*scale/2.0f;
+
+    int width  = std::min((int)ceilf(_contentSize.width*density),  CU_CACHED_NODE_MAXSIZE);
+    int height = std::min((int)ceilf(_contentSize.height*density), CU_CACHED_NODE_MAXSIZE);
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+
+    if (_target == nullptr || _target->getWidth() != width || _target->getHeight() != height) {
+        releaseCache();
+        size_t bytes = (size_t)width*(size_t)height*CACHE_TEXEL_BYTES;
+        if (!reserve(bytes, this)) {
+            return false;
+        }
+        _target = RenderTarget::alloc(width, height);
+        if (_target == nullptr) {
+            return false;
+        }
+        _target->setClearColor(Color4::CLEAR);
+        std::lock_guard<std::mutex> lock(_mutex);
+        _footprint = bytes;
+        _usage += bytes;
+        _residents.push_front(this);
+        _residency = _residents.begin();
+    }
+
+    // Clear the flag first, as the children may dirty it while drawing
+    _cacheScale = scale;
+    _cacheDirty = false;
+    _absolute = has_absolute_color(this);
+    _cacheTint = (_absolute ? tint : Color4::WHITE);
+
+    // Suspend the active pass
+    std::shared_ptr<Scissor> scissor = batch->getScissor();
+    GLenum srcRGB = batch->getSourceBlendFactor();
+    GLenum dstRGB = batch->getDestinationBlendFactor();
+    GLenum srcAlpha = batch->getSourceAlphaFactor();
+    GLenum dstAlpha = batch->getDestinationAlphaFactor();
+    batch->end();
+
+    Mat4 matrix = Mat4::createOrthographicOffCenter(0, _contentSize.width,
+                                                    0, _contentSize.height, -1, 1);
+    matrix.scale(1, -1, 1); // Flip the y axis for texture write
+
+    _capturing++;
+    _target->begin();
+    batch->begin(matrix);
+    batch->setScissor(nullptr);
+    // Straight alpha in, premultiplied alpha out (so alpha is not squared)
+    batch->setBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+                                GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    draw(batch, Mat4::IDENTITY, _cacheTint);
+    for(auto it = _children.begin(); it != _children.end(); ++it) {
+        (*it)->render(batch, Mat4::IDENTITY, _cacheTint);
+    }
+    batch->end();
+    _target->end();
+    _capturing--;
+
+    // Resume the original pass
+    batch->setBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    batch->begin(perspective);
+    batch->setScissor(scissor);
+    return true;
+}
+
+/**
+ * Draws this node and all of its children with the given SpriteBatch.
+ *
+ * If the cache is valid, this draws the cached texture as a single quad.
+ * Otherwise, it redraws the subtree into the cache first. If the cache
+ * cannot be allocated within the memory budget, this method renders
+ * the children directly, like {@link SceneNode#render}. It also renders
+ * the children directly into a deferred sprite batch, as the cache can
+ * only be drawn on the OpenGL thread.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the node color.
+ */
+void CachedNode::render(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+    if (!_isVisible) { return; }
+    if (!_caching || _capturing > 0) {
+        SceneNode::render(batch, transform, tint);
+        return;
+    }
+
+    Mat4 matrix;
+    Mat4::multiply(_combined,transform,&matrix);
+    Color4 color = _tintColor;
+    if (_hasParentColor) {
+        color *= tint;
+    }
+
+    // Only redraw on a significant change in resolution
+    float scale = std::max(Vec2(matrix.m[0],matrix.m[1]).length(),
+                           Vec2(matrix.m[4],matrix.m[5]).length());
+    bool stale = isCacheDirty() || (_absolute && color != _cacheTint);
+    stale = stale || scale > _cacheScale*CACHE_SCALE_UPPER || scale < _cacheScale*CACHE_SCALE_LOWER;
+    if (stale && batch->isDeferred()) {
+        // Only the OpenGL thread can redraw the cache
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_pending) {
+            _stale.push_back(this);
+            _pending = true;
+        }
+        _pendingScale = scale;
+        _pendingTint = color;
+    }
+    if (stale && (batch->isDeferred() || !refresh(batch, scale, color))) {
+        SceneNode::render(batch, transform, tint);
+        return;
+    }
+
+    // Mark as the most recently drawn
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _residents.splice(_residents.begin(), _residents, _residency);
+    }
+
+    std::shared_ptr<Scissor> active = batch->getScissor();
+    if (_scissor) {
+        std::shared_ptr<Scissor> local = Scissor::alloc(_scissor);
+        local->setTransform(matrix);
+        if (active) {
+            local = active->getIntersection(local, false);
+        }
+        batch->setScissor(local);
+    }
+
+    // The cache has premultiplied alpha (and may already be tinted)
+    Color4f quad = (_absolute ? Color4f::WHITE : Color4f(color));
+    quad.r *= quad.a;
+    quad.g *= quad.a;
+    quad.b *= quad.a;
+
+    GLenum srcRGB = batch->getSourceBlendFactor();
+    GLenum dstRGB = batch->getDestinationBlendFactor();
+    GLenum srcAlpha = batch->getSourceAlphaFactor();
+    GLenum dstAlpha = batch->getDestinationAlphaFactor();
+    batch->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    batch->draw(_target->getTexture(), quad, Rect(Vec2::ZERO,_contentSize), Vec2::ZERO, matrix);
+    batch->setBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+
+    if (_scissor) {
+        batch->setScissor(active);
+    }
+}
+
+/**
+ * Redraws the caches that were recorded stale into a deferred batch.
+ *
+ * A deferred batch cannot redraw a cache, so stale caches are queued
+ * until the OpenGL thread calls this method. {@link Scene2#render} calls
+ * it before each parallel pass, so most applications do not need to
+ * call it directly.
+ *
+ * This method must be called on the OpenGL thread in the middle of a
+ * sprite batch pass, and not while any deferred batch is recording.
+ *
+ * @param batch The SpriteBatch to draw with.
+ */
+void CachedNode::refreshPending(const std::shared_ptr<SpriteBatch>& batch) {
+    std::vector<CachedNode*> stale;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        stale.swap(_stale);
+    }
+    for(auto it = stale.begin(); it != stale.end(); ++it) {
+        CachedNode* node = *it;
+        node->_pending = false;
+        if (node->_caching) {
+            node->refresh(batch, node->_pendingScale, node->_pendingTint);
+        }
+    }
+}
@@ -327,6 +327,7 @@ void SceneNode::setPosition(float x, float y) {
     _combined.m[12] += (x-_position.x);
     _combined.m[13] += (y-_position.y);
     _position.set(x,y);
+    markDirty();
 }
 
 /**
@@ -349,6 +350,7 @@ void SceneNode::setContentSize(const Size size) {
     if (_layout) {
         doLayout();
     }
+    markDirty();
 }
 
 /**
@@ -374,6 +376,7 @@ void SceneNode::setAnchor(const Vec2 anchor) {
     _position += (anchor-_anchor)*_contentSize;
     _anchor = anchor;
     if (!_useTransform) updateTransform();
+    markDirty();
 }
 
 /**
@@ -502,6 +505,7 @@ void SceneNode::updateTransform() {
     }
     _combined.m[12] += _position.x-offset.x;
     _combined.m[13] += _position.y-offset.y;
+    markDirty();
 }
 
 
@@ -615,7 +619,7 @@ void SceneNode::addChild(const std::shared_ptr<SceneNode>& child, int zval) {
     _children.push_back(child);
     child->setParent(this);
     child->pushScene(_graph);
-    
+    child->markDirty();
 }
 
 /**
@@ -651,6 +655,7 @@ void SceneNode::swapChild(const std::shared_ptr<SceneNode>& child1,
         childdirty = child2->isZDirty();
     }
     setZDirty(_zDirty || child1->_zOrder != child2->_zOrder || childdirty);
+    child2->markDirty();
 }
 
 /**
@@ -672,6 +677,7 @@ void SceneNode::removeChild(unsigned int pos) {
         _children[ii]->_childOffset = ii;
     }
     _children.resize(_children.size()-1);
+    setChildDirty();
 }
 
 /**
@@ -736,6 +742,7 @@ void SceneNode::removeAllChildren() {
     }
     _children.clear();
     _zDirty = false;
+    setChildDirty();
 }
 
 /**
@@ -787,6 +794,7 @@ void SceneNode::doLayout() {
  */
 void SceneNode::setZOrder(int z) {
     _zOrder = z;
+    markDirty();
     
     // Notify the parent if we have a problem.
     if (_parent != nullptr && !_parent->_zDirty) {
@@ -0,0 +1,415 @@
+//
+//  CUStreamedAnimationNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a filmstrip node for long animations.  Instead of
+//  keeping every frame resident in a single sprite sheet, this node decodes
+//  frames from a {@link Filmstrip} on a worker thread, and uploads them into
+//  a small ring of textures just before they are shown.  Hence the memory
+//  used by the animation depends on the size of the ring, and not on the
+//  number of frames.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/scene2/graph/CUStreamedAnimationNode.h>
+#include <cugl/io/CUMappedFile.h>
+#include <cugl/base/CUApplication.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace cugl;
+using namespace cugl::scene2;
+
+/** The tag of a buffer with no decoded frame */
+#define EMPTY_TAG   0
+
+
+#pragma mark -
+#pragma mark Constructors
+
+/**
+ * Constructs a StreamedAnimationNode with no filmstrip
+ *
+ * You must initialize this object before use.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+ * the heap, use one of the static constructors instead.
+ */
+StreamedAnimationNode::StreamedAnimationNode() : AnimationNode(),
+_ring(0),
+_current(0),
+_displayed(0),
+_generation(1),
+_decoded(-1) {
+    _name = "StreamedAnimationNode";
+}
+
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed StreamedAnimationNode can be safely reinitialized. This
+ * method blocks until the worker thread has finished its current frame.
+ *
+ * It is unsafe to call this on a node that is still currently inside of
+ * a scene graph.
+ */
+void StreamedAnimationNode::dispose() {
+    // The thread pool destructor blocks until the worker is done
+    _decoder = nullptr;
+    _filmstrip = nullptr;
+    _textures.clear();
+    _buffers.reset();
+    _pending.clear();
+    _canvas.clear();
+    _ring = 0;
+    _current = 0;
+    _displayed = 0;
+    _decoded = -1;
+    AnimationNode::dispose();
+}
+
+/**
+ * Initializes the node to stream the given filmstrip.
+ *
+ * The ring size is the number of frames decoded ahead of the active frame.
+ * This node allocates that many textures and decode buffers, each the size
+ * of a single frame.  A ring of 2 or 3 is enough when the frames are
+ * played in order.
+ *
+ * The initial frame is decoded immediately, on the calling thread.
+ *
+ * The size of the node is equal to the size of a single frame. To resize
+ * the node, scale it up or down.
+ *
+ * @param filmstrip The filmstrip to stream
+ * @param ring      The number of frames to decode ahead
+ * @param frame     The initial frame
+ *
+ * @return true if the node is initialized properly, false otherwise.
+ */
+bool StreamedAnimationNode::initWithFilmstrip(const std::shared_ptr<Filmstrip>& filmstrip,
+                                              int ring, int frame) {
+    if (_texture != nullptr) {
+        CUAssertLog(false, "%s is already initialized",_classname.c_str());
+        return false;
+    } else if (!startStream(filmstrip, ring, frame)) {
+        return false;
+    }
+    return initWithTexture(_textures[_current], _bounds);
+}
+
+/**
+ * Initializes a node with the given JSON specificaton.
+ *
+ * This initializer is designed to receive the "data" object from the
+ * JSON passed to {@link Scene2Loader}.  This JSON format supports all
+ * of the attribute values of its parent class.  In addition, it supports
+ * the following additional attributes:
+ *
+ *      "source":   The path to the filmstrip, relative to the asset directory
+ *      "ring":     The number of frames to decode ahead
+ *      "fallback": The path to a sprite sheet, relative to the asset directory
+ *
+ * If there is no source, or the source cannot be read, this node falls
+ * back to the sprite sheet attributes of {@link AnimationNode}.  If there
+ * is a fallback, that sprite sheet is loaded in place of the "texture"
+ * attribute.  As it is only loaded when the filmstrip fails, it does not
+ * need to be kept in the asset manager.  The attribute "frame" is supported
+ * in both cases.
+ *
+ * @param loader    The scene loader passing this JSON file
+ * @param data      The JSON object specifying the node
+ *
+ * @return true if initialization was successful.
+ */
+bool StreamedAnimationNode::initWithData(const Scene2Loader* loader, const std::shared_ptr<JsonValue>& data) {
+    if (!data) {
+        return init();
+    }
+
+    std::shared_ptr<Filmstrip> filmstrip = nullptr;
+    if (data->has("source")) {
+        std::string source = data->getString("source");
+        std::shared_ptr<MappedFile> mapping = MappedFile::allocWithAsset(source);
+        if (mapping != nullptr) {
+            filmstrip = Filmstrip::allocWithMapping(mapping);
+        }
+        if (filmstrip == nullptr) {
+            CULogError("Could not stream filmstrip '%s'; using sprite sheet", source.c_str());
+        }
+    }
+
+    if (filmstrip == nullptr) {
+        if (!AnimationNode::initWithData(loader, data)) {
+            return false;
+        } else if (data->has("fallback")) {
+            std::string path = Application::get()->getAssetDirectory();
+            path.append(data->getString("fallback"));
+            std::shared_ptr<Texture> sheet = Texture::allocWithFile(path);
+            if (sheet == nullptr) {
+                return false;
+            }
+            
+            // Resize to the fallback sheet, as the frames came from the blank texture
+            int rows = _size/_cols + (_size % _cols == 0 ? 0 : 1);
+            setTexture(sheet);
+            _bounds.size = _texture->getSize();
+            _bounds.size.width  /= _cols;
+            _bounds.size.height /= rows;
+            _bounds.origin.x = (_frame % _cols)*_bounds.size.width;
+            _bounds.origin.y = _texture->getSize().height - (1+_frame/_cols)*_bounds.size.height;
+            
+            Vec2 coord = getPosition();
+            setPolygon(_bounds);
+            setPosition(coord);
+        }
+        return true;
+    } else if (!TexturedNode::initWithData(loader, data)) {
+        return false;
+    }
+
+    Vec2 coord = getPosition();
+    int ring = data->getInt("ring",STREAM_RING_SIZE);
+    if (!startStream(filmstrip, ring, data->getInt("frame",0))) {
+        return false;
+    }
+
+    // And position it correctly
+    setTexture(_textures[_current]);
+    setPolygon(_bounds);
+    setPosition(coord);
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Attribute Accessors
+/**
+ * Returns the frame currently shown by this node.
+ *
+ * This is the same as {@link getFrame} unless the decoder has fallen
+ * behind, in which case it is an earlier frame.
+ *
+ * @return the frame currently shown by this node.
+ */
+int StreamedAnimationNode::getDisplayedFrame() const {
+    return _filmstrip == nullptr ? _frame : _displayed;
+}
+
+/**
+ * Sets the active frame as the given index.
+ *
+ * If the frame has been decoded, it is uploaded to the next texture in
+ * the ring, and the decoder starts on the next frame in its place. If
+ * not, this node keeps showing the previous frame.  If the frame is not
+ * one of the frames being decoded, the decoder restarts at this frame.
+ *
+ * If the frame index is invalid, an error is raised.  However, if this
+ * node has fallen back to a sprite sheet, the index is clamped to the
+ * frames of that sheet instead.
+ *
+ * @param frame the index to make the active frame
+ */
+void StreamedAnimationNode::setFrame(int frame) {
+    if (_filmstrip == nullptr) {
+        // The sprite sheet may be shorter than the filmstrip it stands in for
+        AnimationNode::setFrame(std::max(0,std::min(frame,_size-1)));
+        return;
+    }
+
+    CUAssertLog(frame >= 0 && frame < _size, "Invalid animation frame %d", frame);
+    _frame = frame;
+    if (frame == _displayed) {
+        return;
+    }
+
+    auto it = std::find_if(_pending.begin(), _pending.end(),
+                           [=](const std::pair<int,size_t>& entry) { return entry.first == frame; });
+    if (it == _pending.end()) {
+        restart(frame);
+        return;
+    }
+
+    // Recycle the buffers of any frames we skipped
+    while (_pending.front().first != frame) {
+        size_t buffer = _pending.front().second;
+        _pending.pop_front();
+        request((_pending.back().first+1) % _size, buffer);
+    }
+    upload();
+}
+
+
+#pragma mark -
+#pragma mark Internal Helpers
+/**
+ * Allocates the texture ring and starts decoding the given filmstrip.
+ *
+ * The initial frame is decoded immediately and uploaded to the first
+ * texture.  This method does not set the texture or polygon of this node.
+ *
+ * @param filmstrip The filmstrip to stream
+ * @param ring      The number of frames to decode ahead
+ * @param frame     The initial frame
+ *
+ * @return true if the initial frame was decoded.
+ */
+bool StreamedAnimationNode::startStream(const std::shared_ptr<Filmstrip>& filmstrip, int ring, int frame) {
+    if (filmstrip == nullptr || filmstrip->getFrameCount() == 0) {
+        return false;
+    }
+
+    Uint32 size = filmstrip->getFrameCount();
+    CUAssertLog(frame >= 0 && frame < (int)size, "Invalid animation frame %d", frame);
+    _decoded = -1;
+    if (!filmstrip->decode(frame, _canvas, _decoded)) {
+        return false;
+    }
+
+    // There is no point in decoding more frames than the filmstrip has
+    _ring = std::max(1, std::min(ring, std::max(1,(int)size-1)));
+    for(size_t ii = 0; ii < _ring; ii++) {
+        std::shared_ptr<Texture> texture = Texture::alloc(filmstrip->getWidth(), filmstrip->getHeight());
+        if (texture == nullptr) {
+            _textures.clear();
+            return false;
+        }
+        _textures.push_back(texture);
+    }
+    _buffers.reset(new Buffer[_ring]);
+    for(size_t ii = 0; ii < _ring; ii++) {
+        _buffers[ii].pixels.resize(filmstrip->getFrameSize());
+        _buffers[ii].tag.store(EMPTY_TAG);
+    }
+
+    _current = 0;
+    _textures[_current]->bind();
+    _textures[_current]->set(_canvas.data());
+    _textures[_current]->unbind();
+
+    _filmstrip = filmstrip;
+    _size  = size;
+    _cols  = 1;
+    _frame = frame;
+    _displayed = frame;
+    _bounds.origin = Vec2::ZERO;
+    _bounds.size = _textures[_current]->getSize();
+
+    if (size > 1) {
+        _decoder = ThreadPool::alloc(1);
+        restart((frame+1) % size);
+    }
+    return true;
+}
+
+/**
+ * Asks the worker thread to decode the given frame into the given buffer.
+ *
+ * @param frame     The frame to decode
+ * @param buffer    The index of the buffer to receive the frame
+ */
+void StreamedAnimationNode::request(int frame, size_t buffer) {
+    _pending.push_back(std::make_pair(frame,buffer));
+    Uint64 tag = tagFrame(frame);
+    _decoder->addTask([=](void) {
+        this->decode(frame, buffer, tag);
+    });
+}
+
+/**
+ * Decodes the given frame into the given buffer.
+ *
+ * This method is executed on the worker thread.  It does nothing if the
+ * decoder has restarted since the frame was requested.
+ *
+ * @param frame     The frame to decode
+ * @param buffer    The index of the buffer to receive the frame
+ * @param tag       The tag of the frame when it was requested
+ */
+void StreamedAnimationNode::decode(int frame, size_t buffer, Uint64 tag) {
+    if ((tag >> 32) != _generation.load()) {
+        return;
+    } else if (!_filmstrip->decode(frame, _canvas, _decoded)) {
+        return;
+    }
+    std::memcpy(_buffers[buffer].pixels.data(), _canvas.data(), _canvas.size());
+    _buffers[buffer].tag.store(tag);
+}
+
+/**
+ * Restarts the decoder at the given frame.
+ *
+ * Any frames previously requested are discarded.
+ *
+ * @param frame The frame to decode first
+ */
+void StreamedAnimationNode::restart(int frame) {
+    // The worker skips any task from an older generation
+    _generation++;
+    _pending.clear();
+    for(size_t ii = 0; ii < _ring; ii++) {
+        request((frame+(int)ii) % _size, ii);
+    }
+}
+
+/**
+ * Uploads the next pending frame if it is the active frame and is ready.
+ *
+ * @return true if the frame was uploaded
+ */
+bool StreamedAnimationNode::upload() {
+    if (_pending.empty() || _pending.front().first != _frame) {
+        return false;
+    }
+
+    size_t buffer = _pending.front().second;
+    if (_buffers[buffer].tag.load() != tagFrame(_frame)) {
+        return false;
+    }
+
+    // Never overwrite the texture that the previous frame may still be using
+    _current = (_current+1) % _ring;
+    std::shared_ptr<Texture> texture = _textures[_current];
+    texture->bind();
+    texture->set(_buffers[buffer].pixels.data());
+    texture->unbind();
+    setTexture(texture);
+    _displayed = _frame;
+
+    _buffers[buffer].tag.store(EMPTY_TAG);
+    _pending.pop_front();
+    int next = (_pending.empty() ? _frame : _pending.back().first)+1;
+    request(next % _size, buffer);
+    return true;
+}
@@ -504,7 +504,7 @@ void TexturedNode::generateRenderData() {
 void TexturedNode::clearRenderData() {
     _mesh.clear();
     _rendered = false;
-    
+    markDirty();
 }
 
 /**
@@ -515,6 +515,7 @@ void TexturedNode::clearRenderData() {
  * of the texture.
  */
 void TexturedNode::updateTextureCoords() {
+    markDirty();
     if (!_rendered) {
         return;
     }
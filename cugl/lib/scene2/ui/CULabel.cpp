@@ -528,7 +528,13 @@ void Label::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transfor
     }
     batch->setTexture(_texture);
     batch->setColor(tint);
-    batch->fill(_mesh, transform);
+    if (_font->isDistanceField()) {
+        batch->setDistanceField(true);
+        batch->fill(_mesh, transform);
+        batch->setDistanceField(false);
+    } else {
+        batch->fill(_mesh, transform);
+    }
 }
 
 
@@ -576,6 +582,7 @@ void Label::clearRenderData() {
     _mesh.clear();
     _mesh.command = GL_TRIANGLES;
     _rendered = false;
+    markDirty();
 }
 
 /**
@@ -585,6 +592,7 @@ void Label::clearRenderData() {
  * colors.
  */
 void Label::updateColor() {
+    markDirty();
     if (!_rendered) {
         return;
     }
@@ -53,8 +53,8 @@ using namespace cugl::scene2;
 
 /** The pixel width of the cursor */
 #define CURSOR_WIDTH  3
-/** The number of frames to cycle before blinking the cursor */
-#define CURSOR_PERIOD 25
+/** The number of milliseconds to cycle before blinking the cursor */
+#define CURSOR_PERIOD 400
 /** The number of milliseconds to delay until continuous deletion */
 #define DELETE_DELAY  500
 
@@ -69,20 +69,21 @@ using namespace cugl::scene2;
  * heap, use one of the static constructors instead.
  */
 TextField::TextField() :
+_cursorShown(false),
+_blinkKey(0),
+_cursorIndex(0),
+_textLength(-1),
 _active(false),
 _focused(false),
 _mouse(true),
-_altDown(false),
-_metaDown(false),
-_backDown(false),
-_backCount(0),
-_cursorBlink(0),
-_cursorIndex(0),
-_textLength(-1),
 _tkey(0),
 _kkey(0),
 _fkey(0),
-_nextKey(1) {
+_nextKey(1),
+_altDown(false),
+_metaDown(false),
+_backDown(false),
+_backCount(0) {
     _name = "TextField";
 }
 
@@ -429,6 +430,7 @@ bool TextField::deactivate(bool dispose) {
     if (_focused && !dispose) {
         success = releaseFocus();
     }
+    stopBlink();
     TextInput* textInput = Input::get<TextInput>();
     Keyboard* keyBoard  = Input::get<Keyboard>();
     
@@ -488,9 +490,9 @@ bool TextField::requestFocus() {
     _backDown = false;
 
     _focused = true;
-    _cursorBlink = 0;
 	_cursorIndex = 0;
 	updateCursor();
+    restartBlink();
     return true;
 }
 
@@ -528,6 +530,7 @@ bool TextField::releaseFocus() {
         it->second(getName(), _text);
     }
     _focused = false;
+    stopBlink();
     return true;
 }
 
@@ -556,16 +559,10 @@ bool TextField::releaseFocus() {
 void TextField::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
     Label::draw(batch, transform, tint);
 
-	if (_focused) {
-		_cursorBlink--;
-		if (_cursorBlink < 0) {
-			batch->setTexture(Texture::getBlank());
-			batch->setColor(_foreground);
-			batch->fill(_cursor);
-		}
-        if (_cursorBlink == -CURSOR_PERIOD) {
-			_cursorBlink = CURSOR_PERIOD;
-        }
+	if (_focused && _cursorShown) {
+		batch->setTexture(Texture::getBlank());
+		batch->setColor(_foreground);
+		batch->fill(_cursor);
 	}
 }
 
@@ -698,8 +695,8 @@ void TextField::updateKey(const KeyEvent& Event, bool focus, bool down) {
             } else {
 				_cursorIndex++;
             }
-            _cursorBlink = 0;
 			updateCursor();
+            restartBlink();
         }
 		break;
 	case KeyCode::ARROW_RIGHT:
@@ -711,8 +708,8 @@ void TextField::updateKey(const KeyEvent& Event, bool focus, bool down) {
             } else {
 				_cursorIndex--;
             }
-            _cursorBlink = 0;
 			updateCursor();
+            restartBlink();
 		}
 		break;
     case KeyCode::ENTER:
@@ -760,8 +757,8 @@ void TextField::updatePress(Vec2 pos, bool focus) {
         }
 
         _cursorIndex = (index == -1 ? (int) _text.length() : index);
-        _cursorBlink = 0;
         updateCursor();
+        restartBlink();
     }
 }
 
@@ -784,6 +781,44 @@ void TextField::updateCursor() {
 	_cursor.origin = nodeToWorldCoords(origin);
 	_cursor.size.height = _textbounds.size.height;
 	_cursor.size.width = CURSOR_WIDTH;
+    if (_focused) {
+        markDirty();
+    }
+}
+
+/**
+ * Shows the cursor and restarts the blink timer.
+ *
+ * The cursor blinks on a timer scheduled with the {@link Application},
+ * not in {@link draw}.  That way this node is only marked dirty when the
+ * cursor actually changes, and it still blinks inside a cached subtree.
+ */
+void TextField::restartBlink() {
+    Application* app = Application::get();
+    if (_blinkKey) {
+        app->unschedule(_blinkKey);
+    }
+    _cursorShown = true;
+    _blinkKey = app->schedule([this](void) {
+        _cursorShown = !_cursorShown;
+        markDirty();
+        return true;
+    }, CURSOR_PERIOD, CURSOR_PERIOD);
+    markDirty();
+}
+
+/**
+ * Hides the cursor and stops the blink timer.
+ */
+void TextField::stopBlink() {
+    if (_blinkKey) {
+        Application::get()->unschedule(_blinkKey);
+        _blinkKey = 0;
+    }
+    if (_cursorShown) {
+        _cursorShown = false;
+        markDirty();
+    }
 }
 
 /**
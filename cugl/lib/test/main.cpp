@@ -10,12 +10,22 @@
 #include <stdio.h>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <new>
+#include <vector>
 #include <cugl/cugl.h>
 
+// The math and scene tests predate the current Poly2 API, and only build in Xcode
+#if !defined (CU_NO_LEGACY_TESTS)
 #include "TCUMathTest.h"
 #include "TCU2DTest.h"
+#endif
 
+#if defined (__APPLE__)
 #include <Accelerate/Accelerate.h>
+#endif
+
 
 void testBinary() {
     CULog("Writing to File");
@@ -84,47 +94,47 @@ void testBinary() {
 
     Uint8* b1 = (Uint8*)malloc(8);
     amt = reader->read(b1,4,0);
-    CULog("String is %s",cugl::to_string(b1,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b1,amt).c_str());
     free(b1);
 
     Sint16* b2 = (Sint16*)malloc(8*2);
     amt = reader->read(b2,4,0);
-    CULog("String is %s",cugl::to_string(b2,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b2,amt).c_str());
     free(b2);
 
     Uint16* b3 = (Uint16*)malloc(8*2);
     amt = reader->read(b3,4,0);
-    CULog("String is %s",cugl::to_string(b3,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b3,amt).c_str());
     free(b3);
 
     Sint32* b4 = (Sint32*)malloc(8*4);
     amt = reader->read(b4,4,0);
-    CULog("String is %s",cugl::to_string(b4,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b4,amt).c_str());
     free(b4);
     
     Uint32* b5 = (Uint32*)malloc(8*4);
     amt = reader->read(b5,4,0);
-    CULog("String is %s",cugl::to_string(b5,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b5,amt).c_str());
     free(b5);
 
     Sint64* b6 = (Sint64*)malloc(8*8);
     amt = reader->read(b6,4,0);
-    CULog("String is %s",cugl::to_string(b6,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b6,amt).c_str());
     free(b6);
     
     Uint64* b7 = (Uint64*)malloc(8*8);
     amt = reader->read(b7,4,0);
-    CULog("String is %s",cugl::to_string(b7,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b7,amt).c_str());
     free(b7);
 
     float* b8 = (float*)malloc(8*4);
     amt = reader->read(b8,4,0);
-    CULog("String is %s",cugl::to_string(b8,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b8,amt).c_str());
     free(b8);
     
     double* b9 = (double*)malloc(8*8);
     amt = reader->read(b9,5,0);
-    CULog("String is %s",cugl::to_string(b9,amt).c_str());
+    CULog("String is %s",cugl::strtool::to_string(b9,amt).c_str());
     free(b9);
     
     CULog("Ready: %d",reader->ready());
@@ -170,11 +180,1888 @@ void testThread() {
     pool = nullptr;
 }
 
+void testRecorder() {
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::Texture> blank = cugl::Texture::getBlank();
+    cugl::RenderRecorder::reset();
+    
+    // Same texture and state should batch into a single call
+    batch->begin();
+    batch->draw(blank, cugl::Rect(0,0,10,10));
+    batch->draw(blank, cugl::Rect(20,0,10,10));
+    batch->end();
+    cugl::RenderRecorder::Counts counts = cugl::RenderRecorder::getCounts();
+    CULog("Batched %s", counts.toString().c_str());
+    CUAssertLog(counts.drawCalls == 1, "Expected 1 draw call, got %llu",
+                (unsigned long long)counts.drawCalls);
+    CUAssertLog(counts.vertices == 8, "Expected 8 vertices, got %llu",
+                (unsigned long long)counts.vertices);
+    CUAssertLog(counts.indices == 12, "Expected 12 indices, got %llu",
+                (unsigned long long)counts.indices);
+    
+    // A blend change forces a second call
+    cugl::RenderRecorder::reset();
+    batch->begin();
+    batch->draw(blank, cugl::Rect(0,0,10,10));
+    batch->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    batch->draw(blank, cugl::Rect(20,0,10,10));
+    batch->end();
+    counts = cugl::RenderRecorder::getCounts();
+    CULog("Split %s", counts.toString().c_str());
+    CUAssertLog(counts.drawCalls == 2, "Expected 2 draw calls, got %llu",
+                (unsigned long long)counts.drawCalls);
+}
+
+void testTransform() {
+    const size_t size = 1 << 16;
+    const int rounds = 64;
+    std::vector<cugl::SpriteVertex3> verts(size);
+    std::vector<cugl::SpriteVertex3> check(size);
+    for(size_t ii = 0; ii < size; ii++) {
+        verts[ii].position.set((float)(ii % 256), (float)(ii / 256), 0.5f);
+    }
+
+    cugl::Mat4 planar;
+    cugl::Mat4::createRotationZ(0.3f, &planar);
+    planar.scale(2.0f, 0.5f, 1.0f);
+    planar.translate(100, 50, 0);
+    cugl::Mat4 full;
+    cugl::Mat4::createPerspective(60.0f, 1.5f, 0.1f, 100.0f, &full);
+    full *= planar;
+    cugl::Affine2 affine(planar);
+
+    const cugl::Mat4* mats[2] = { &planar, &full };
+    const char* names[2] = { "Affine2", "Mat4" };
+    for(int kk = 0; kk < 2; kk++) {
+        const cugl::Mat4& mat = *mats[kk];
+
+        // Scalar baseline
+        cugl::Timestamp start;
+        for(int rr = 0; rr < rounds; rr++) {
+            for(size_t ii = 0; ii < size; ii++) {
+                check[ii].position = verts[ii].position*mat;
+            }
+        }
+        cugl::Timestamp end;
+        Uint64 scalar = cugl::Timestamp::ellapsedMicros(start,end);
+
+        // Strided array kernel
+        std::vector<cugl::SpriteVertex3> work(verts);
+        start.mark();
+        for(int rr = 0; rr < rounds; rr++) {
+            cugl::Vec3* input = &(verts[0].position);
+            cugl::Vec3* output = &(work[0].position);
+            if (kk == 0) {
+                cugl::Affine2::transform(affine, reinterpret_cast<cugl::Vec2*>(input),
+                                         reinterpret_cast<cugl::Vec2*>(output), size,
+                                         sizeof(cugl::SpriteVertex3));
+            } else {
+                cugl::Mat4::transform(mat, input, output, size, sizeof(cugl::SpriteVertex3));
+            }
+        }
+        end.mark();
+        Uint64 vector = cugl::Timestamp::ellapsedMicros(start,end);
+
+        for(size_t ii = 0; ii < size; ii++) {
+            CUAssertLog(work[ii].position.equals(check[ii].position, 0.001f),
+                        "%s transform mismatch at %zu", names[kk], ii);
+        }
+        double total = (double)size*rounds;
+        CULog("%s scalar: %.1f Mverts/sec", names[kk], total/std::max(scalar,(Uint64)1));
+        CULog("%s kernel: %.1f Mverts/sec", names[kk], total/std::max(vector,(Uint64)1));
+    }
+}
+
+
+void testChunkify() {
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::Texture> blank = cugl::Texture::getBlank();
+
+    // A triangulated grid much larger than the batch capacity
+    const Uint32 width  = 256;
+    const Uint32 height = 128;
+    cugl::Mesh<cugl::SpriteVertex2> grid;
+    grid.command = GL_TRIANGLES;
+    for(Uint32 yy = 0; yy < height; yy++) {
+        for(Uint32 xx = 0; xx < width; xx++) {
+            cugl::SpriteVertex2 vert;
+            vert.position.set((float)xx, (float)yy);
+            vert.color = cugl::Vec4::ONE;
+            vert.texcoord.set(xx/(float)width, yy/(float)height);
+            grid.vertices.push_back(vert);
+        }
+    }
+    for(Uint32 yy = 0; yy+1 < height; yy++) {
+        for(Uint32 xx = 0; xx+1 < width; xx++) {
+            Uint32 base = yy*width+xx;
+            grid.indices.push_back(base);
+            grid.indices.push_back(base+1);
+            grid.indices.push_back(base+width);
+            grid.indices.push_back(base+1);
+            grid.indices.push_back(base+width+1);
+            grid.indices.push_back(base+width);
+        }
+    }
+
+    cugl::RenderRecorder::reset();
+    batch->begin();
+    batch->setTexture(blank);
+    batch->fill(grid, cugl::Mat4::IDENTITY);
+    batch->end();
+    cugl::RenderRecorder::Counts counts = cugl::RenderRecorder::getCounts();
+    CULog("Grid %s", counts.toString().c_str());
+    CUAssertLog(counts.indices == grid.indices.size(), "Expected %zu indices, got %llu",
+                grid.indices.size(), (unsigned long long)counts.indices);
+    CUAssertLog(counts.drawCalls > 1, "Expected the grid to be chunked");
+    // Shared vertices are copied once per flush, not once per index
+    CUAssertLog(counts.vertices < 2*grid.vertices.size(), "Too many vertices: %llu",
+                (unsigned long long)counts.vertices);
+
+    // Large path and wire geometry
+    std::vector<cugl::Vec2> path;
+    for(int ii = 0; ii < 20000; ii++) {
+        path.push_back(cugl::Vec2((float)ii, (ii % 2) ? 10.0f : 0.0f));
+    }
+    std::shared_ptr<cugl::scene2::PathNode> pnode;
+    pnode = cugl::scene2::PathNode::allocWithVertices(path, 2.0f, cugl::poly2::Joint::MITRE,
+                                                      cugl::poly2::EndCap::NONE, false);
+    std::shared_ptr<cugl::scene2::WireNode> wnode = cugl::scene2::WireNode::alloc(path);
+    std::shared_ptr<cugl::scene2::SceneNode> nodes[2] = { pnode, wnode };
+    const char* names[2] = { "PathNode", "WireNode" };
+    for(int kk = 0; kk < 2; kk++) {
+        cugl::RenderRecorder::reset();
+        batch->begin();
+        nodes[kk]->render(batch);
+        batch->end();
+        counts = cugl::RenderRecorder::getCounts();
+        CULog("%s %s", names[kk], counts.toString().c_str());
+        CUAssertLog(counts.drawCalls > 1, "Expected %s to be chunked", names[kk]);
+        CUAssertLog(counts.vertices <= counts.indices, "Vertices were not shared");
+        CUAssertLog(counts.indices % (kk == 0 ? 3 : 2) == 0, "A primitive was split");
+    }
+
+    // Throughput
+    const int rounds = 32;
+    cugl::Mat4 transform;
+    cugl::Mat4::createTranslation(10, 20, 0, &transform);
+    cugl::Timestamp start;
+    batch->begin();
+    batch->setTexture(blank);
+    for(int rr = 0; rr < rounds; rr++) {
+        batch->fill(grid, transform);
+    }
+    batch->end();
+    cugl::Timestamp end;
+    Uint64 micros = cugl::Timestamp::ellapsedMicros(start,end);
+    double total = (double)grid.indices.size()*rounds;
+    CULog("Chunked %.1f Mindices/sec", total/std::max(micros,(Uint64)1));
+}
+
+
+void testDeferred() {
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::Texture> blank = cugl::Texture::getBlank();
+    std::shared_ptr<cugl::SpriteBatch> left  = cugl::SpriteBatch::allocDeferred();
+    std::shared_ptr<cugl::SpriteBatch> right = cugl::SpriteBatch::allocDeferred();
+    
+    // Record on separate threads
+    std::thread first([&]() {
+        left->begin();
+        left->draw(blank, cugl::Rect(0,0,10,10));
+        left->end();
+    });
+    std::thread second([&]() {
+        right->begin();
+        right->draw(blank, cugl::Rect(20,0,10,10));
+        right->end();
+    });
+    first.join();
+    second.join();
+    
+    // Both recordings should share a single upload
+    cugl::RenderRecorder::reset();
+    batch->begin();
+    batch->replay(left);
+    batch->replay(right);
+    batch->end();
+    cugl::RenderRecorder::Counts counts = cugl::RenderRecorder::getCounts();
+    CULog("Replayed %s", counts.toString().c_str());
+    CUAssertLog(counts.vertices == 8, "Expected 8 vertices, got %llu",
+                (unsigned long long)counts.vertices);
+    CUAssertLog(counts.indices == 12, "Expected 12 indices, got %llu",
+                (unsigned long long)counts.indices);
+    CUAssertLog(counts.drawCalls == 2, "Expected 2 draw calls, got %llu",
+                (unsigned long long)counts.drawCalls);
+}
+
+
+/**
+ * Reads back a translucent quad drawn directly and through a CachedNode.
+ *
+ * The cache stores premultiplied color, so both pixels should match. If
+ * the capture multiplied alpha by itself, the cached pixel is too light.
+ * A headless run has no framebuffer, so it skips this comparison.
+ * Finally, the cache is recorded into a deferred batch, which should use
+ * the cache rather than the subtree. A child that ignores the parent color
+ * is drawn untinted through the cache, which is redrawn when the tint changes.
+ */
+void testCachedNode() {
+    const int SIZE = 16;
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::RenderTarget> target = cugl::RenderTarget::alloc(SIZE,SIZE);
+    target->setClearColor(cugl::Color4::WHITE);
+    cugl::Mat4 ortho = cugl::Mat4::createOrthographicOffCenter(0,SIZE,0,SIZE,-1,1);
+
+    std::shared_ptr<cugl::scene2::PolygonNode> quad;
+    quad = cugl::scene2::PolygonNode::alloc(cugl::Rect(0,0,SIZE,SIZE));
+    quad->setColor(cugl::Color4(255,0,0,128));
+
+    // Draw the quad directly
+    GLubyte direct[4];
+    target->begin();
+    batch->begin(ortho);
+    quad->render(batch,cugl::Mat4::IDENTITY,cugl::Color4::WHITE);
+    batch->end();
+    glReadPixels(SIZE/2,SIZE/2,1,1,GL_RGBA,GL_UNSIGNED_BYTE,direct);
+    target->end();
+
+    // Draw it again through a cache
+    std::shared_ptr<cugl::scene2::CachedNode> cache;
+    cache = cugl::scene2::CachedNode::allocWithBounds(cugl::Rect(0,0,SIZE,SIZE));
+    cache->addChild(quad);
+    GLubyte cached[4];
+    target->begin();
+    batch->begin(ortho);
+    cache->render(batch,cugl::Mat4::IDENTITY,cugl::Color4::WHITE);
+    batch->end();
+    glReadPixels(SIZE/2,SIZE/2,1,1,GL_RGBA,GL_UNSIGNED_BYTE,cached);
+    target->end();
+
+    CULog("Direct pixel (%d,%d,%d,%d), cached pixel (%d,%d,%d,%d)",
+          direct[0],direct[1],direct[2],direct[3],cached[0],cached[1],cached[2],cached[3]);
+    CUAssertLog(cache->isResident(), "The quad was not cached");
+    if (cugl::Application::get()->isHeadless()) {
+        // There is no framebuffer to read back
+        CULog("Skipping the pixel comparison (headless)");
+    } else {
+        for(int ii = 0; ii < 4; ii++) {
+            CUAssertLog(abs((int)direct[ii]-(int)cached[ii]) <= 2,
+                        "Channel %d differs: %d direct, %d cached",ii,direct[ii],cached[ii]);
+        }
+    }
+
+    // A valid cache is recorded into a deferred batch as a single quad
+    std::shared_ptr<cugl::SpriteBatch> deferred = cugl::SpriteBatch::allocDeferred();
+    deferred->begin(ortho);
+    cache->render(deferred,cugl::Mat4::IDENTITY,cugl::Color4::WHITE);
+    deferred->end();
+    cugl::RenderRecorder::reset();
+    target->begin();
+    batch->begin(ortho);
+    batch->replay(deferred);
+    batch->end();
+    target->end();
+    cugl::RenderRecorder::Counts counts = cugl::RenderRecorder::getCounts();
+    CUAssertLog(counts.vertices == 4, "Expected the cached quad, got %llu vertices",
+                (unsigned long long)counts.vertices);
+
+    // A child that ignores the parent color must not be tinted by the cache
+    quad->setRelativeColor(false);
+    cugl::Color4 tints[3] = { cugl::Color4::BLUE, cugl::Color4::BLUE, cugl::Color4::GREEN };
+    for(int ii = 0; ii < 3; ii++) {
+        cugl::RenderRecorder::reset();
+        target->begin();
+        batch->begin(ortho);
+        cache->render(batch,cugl::Mat4::IDENTITY,tints[ii]);
+        batch->end();
+        glReadPixels(SIZE/2,SIZE/2,1,1,GL_RGBA,GL_UNSIGNED_BYTE,cached);
+        target->end();
+        counts = cugl::RenderRecorder::getCounts();
+
+        // The cache is redrawn (child and cache quad) only when the tint changes
+        Uint64 expected = (ii == 1 ? 4 : 8);
+        CUAssertLog(counts.vertices == expected, "Expected %llu vertices for tint %d, got %llu",
+                    (unsigned long long)expected, ii, (unsigned long long)counts.vertices);
+        if (!cugl::Application::get()->isHeadless()) {
+            for(int jj = 0; jj < 4; jj++) {
+                CUAssertLog(abs((int)direct[jj]-(int)cached[jj]) <= 2,
+                            "Channel %d of tint %d differs: %d direct, %d cached",
+                            jj,ii,direct[jj],cached[jj]);
+            }
+        }
+    }
+}
+
+
+/** Whether the current thread is rendering audio for testAudioStress */
+static thread_local bool gAudioThread = false;
+/** The number of heap operations made while gAudioThread was set */
+static std::atomic<Uint64> gAudioHeapOps(0);
+
+void* operator new(std::size_t size) {
+    if (gAudioThread) {
+        gAudioHeapOps.fetch_add(1,std::memory_order_relaxed);
+    }
+    void* result = malloc(size == 0 ? 1 : size);
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (gAudioThread && ptr != nullptr) {
+        gAudioHeapOps.fetch_add(1,std::memory_order_relaxed);
+    }
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    operator delete(ptr);
+}
+
+/**
+ * Hammers the audio engine while a separate thread renders it.
+ *
+ * The engine renders to an offline output on a thread of its own, which
+ * plays the role of the audio thread.  The test fails if that thread touches
+ * the heap once it is warmed up.  Underruns depend on the machine, so they
+ * are only reported.
+ */
+void testAudioStress() {
+    const Uint32 RATE  = 48000;
+    const Uint32 BLOCK = 512;
+    cugl::AudioDevices::start();
+    std::shared_ptr<cugl::audio::AudioOfflineOutput> output;
+    output = cugl::audio::AudioOfflineOutput::alloc(2,RATE,BLOCK);
+    if (output == nullptr || !cugl::AudioEngine::start(output,24)) {
+        CULogError("Could not start the audio engine");
+        cugl::AudioDevices::stop();
+        return;
+    }
+    
+    // A mismatched rate forces a resampler into every voice
+    cugl::AudioEngine* engine = cugl::AudioEngine::get();
+    std::shared_ptr<cugl::AudioWaveform> wave;
+    wave = cugl::AudioWaveform::alloc(2,44100,cugl::AudioWaveform::Type::SINE,440);
+    engine->play("warmup",wave,false,0.1f,true);
+    output->render(RATE/10);
+    engine->clear(0);
+    output->render(RATE/10);
+    cugl::AudioDevices::get()->flushEvents();
+    output->resetStatistics();
+    
+    std::atomic<bool> running(true);
+    std::thread renderer([&] {
+        while (running.load()) {
+            gAudioThread = true;
+            output->render(BLOCK);
+            gAudioThread = false;
+            std::this_thread::yield();
+        }
+    });
+    
+    // Hammer play and stop while the other thread renders
+    Uint64 heapops = gAudioHeapOps.load();
+    cugl::Timestamp start;
+    const int ITERATIONS = 20000;
+    for(int ii = 0; ii < ITERATIONS; ii++) {
+        std::string key = "stress"+std::to_string(ii % 32);
+        if (ii % 3 == 0) {
+            engine->clear(key,0);
+        } else {
+            engine->play(key,wave,false,0.1f,true);
+        }
+        if (ii % 200 == 0) {
+            cugl::AudioDevices::get()->flushEvents();
+            SDL_Delay(1);
+        }
+    }
+    engine->clear(0);
+    SDL_Delay(100);
+    running.store(false);
+    renderer.join();
+    cugl::AudioDevices::get()->flushEvents();
+    cugl::Timestamp end;
+    
+    heapops = gAudioHeapOps.load()-heapops;
+    CULog("Audio stress: %d play/stop calls in %llu ms over %llu callbacks (worst %llu us, %llu underruns)",
+          ITERATIONS,(unsigned long long)cugl::Timestamp::ellapsedMillis(start,end),
+          (unsigned long long)output->getCallbacks(),(unsigned long long)output->getWorstCost(),
+          (unsigned long long)output->getUnderruns());
+    CUAssertLog(heapops == 0, "Audio thread touched the heap %llu times",
+                (unsigned long long)heapops);
+    
+    cugl::AudioEngine::stop();
+    cugl::AudioDevices::stop();
+}
+
+/**
+ * Reports the memory and decode cost of each in-memory sample format
+ */
+void testSampleFormats() {
+    const Uint32 RATE = 48000;
+    const Uint32 FRAMES = 2*RATE;
+    const Uint32 BLOCK = 512;
+    const char* names[] = { "float", "int16", "adpcm" };
+
+    std::vector<float> output(FRAMES*2);
+    for(int ii = 0; ii < 3; ii++) {
+        std::shared_ptr<cugl::AudioSample> sample = cugl::AudioSample::alloc(2,RATE,FRAMES);
+        float* buffer = sample->getBuffer();
+        for(Uint32 ff = 0; ff < FRAMES; ff++) {
+            buffer[2*ff  ] = 0.5f*sinf(ff*0.05f);
+            buffer[2*ff+1] = 0.3f*sinf(ff*0.013f);
+        }
+        std::vector<float> source(buffer,buffer+FRAMES*2);
+        sample->setFormat((cugl::AudioSample::Format)ii);
+
+        // Decode in audio-sized blocks, as the player would
+        cugl::Timestamp start;
+        for(Uint64 pos = 0; pos < FRAMES; pos += BLOCK) {
+            sample->read(output.data()+pos*2,pos,BLOCK);
+        }
+        cugl::Timestamp end;
+
+        float error = 0;
+        for(size_t jj = 0; jj < source.size(); jj++) {
+            error = std::max(error,fabsf(source[jj]-output[jj]));
+        }
+        CULog("Sample format %s: %zu bytes, %llu us to decode %.1f s, max error %.4f",
+              names[ii],sample->getFootprint(),
+              (unsigned long long)cugl::Timestamp::ellapsedMicros(start,end),
+              (double)FRAMES/RATE,error);
+    }
+}
+
+/**
+ * Checks voice priorities and rate limiting in the audio engine
+ */
+void testVoicePool() {
+    cugl::AudioDevices::start();
+    std::shared_ptr<cugl::audio::AudioOutput> output = cugl::AudioDevices::get()->openOutput();
+    if (output == nullptr || !cugl::AudioEngine::start(output,4)) {
+        CULogError("Could not start the audio engine");
+        cugl::AudioDevices::stop();
+        return;
+    }
+
+    cugl::AudioEngine* engine = cugl::AudioEngine::get();
+    std::shared_ptr<cugl::AudioWaveform> wave;
+    wave = cugl::AudioWaveform::alloc(2,output->getRate(),cugl::AudioWaveform::Type::SINE,440);
+
+    // Rate limited plays are coalesced into a single voice
+    engine->setRateLimit("hit",1.0f);
+    for(int ii = 0; ii < 100; ii++) {
+        CUAssertLog(engine->play("hit",wave,true,0.1f,true), "Coalesced play failed");
+    }
+    CUAssertLog(engine->getAvailableSlots() == 3, "Coalesced plays used %zu voices",
+                4-engine->getAvailableSlots());
+
+    // Low priority sounds cannot steal from high priority ones
+    for(int ii = 0; ii < 3; ii++) {
+        engine->play("high"+std::to_string(ii),wave,true,0.1f,false,2);
+    }
+    CUAssertLog(engine->getAvailableSlots() == 0, "Voice pool is not full");
+    CUAssertLog(!engine->play("low",wave,true,0.1f,true,1), "Low priority sound stole a voice");
+    CUAssertLog(engine->play("top",wave,true,0.1f,true,3), "High priority sound did not steal a voice");
+    CULog("Voice pool: %d voices free", (int)engine->getAvailableSlots());
+
+    engine->setRateLimit("hit",0);
+    cugl::AudioEngine::stop();
+    cugl::AudioDevices::stop();
+}
+
+/**
+ * A synthetic decoder whose samples are their own frame position
+ */
+class RampDecoder : public cugl::audio::AudioDecoder {
+public:
+    RampDecoder() { _channels = 2; _rate = 48000; _frames = 480000+123; _pagesize = 1024; _currpage = 0; }
+    bool init(const std::string& file) override { return true; }
+    void dispose() override {}
+    void setPage(Uint64 page) override { _currpage = page; }
+    Sint32 pagein(float* buffer) override {
+        Uint64 start = _currpage*_pagesize;
+        if (start >= _frames) {
+            return 0;
+        }
+        Uint32 amt = (Uint32)std::min((Uint64)_pagesize,_frames-start);
+        for(Uint32 ii = 0; ii < amt; ii++) {
+            buffer[2*ii] = buffer[2*ii+1] = (float)(start+ii);
+        }
+        _currpage++;
+        return amt;
+    }
+};
+
+void testReadAhead() {
+    std::shared_ptr<cugl::audio::AudioReadAhead> stream;
+    stream = cugl::audio::AudioReadAhead::alloc(std::make_shared<RampDecoder>());
+    std::atomic<bool> running(true);
+    std::thread worker([&]() {
+        while (running.load()) {
+            if (!stream->fill()) {
+                SDL_Delay(1);
+            }
+        }
+    });
+    
+    // Loop the stream repeatedly, with an occasional random seek
+    float buffer[512*2];
+    Uint64 pos = 0;
+    Uint64 errors = 0;
+    for(int ii = 0; ii < 4000; ii++) {
+        if (ii % 500 == 499) {
+            pos = rand() % stream->getLength();
+            stream->seek(pos);
+        }
+        Uint32 amt = stream->read(buffer,512);
+        for(Uint32 jj = 0; jj < amt; jj++) {
+            errors += buffer[2*jj] != (float)(pos+jj);
+        }
+        pos += amt;
+        if (pos >= stream->getLength()) {
+            pos = 0;
+            stream->seek(0);
+        }
+        SDL_Delay(ii % 4 == 0);
+    }
+    running.store(false);
+    worker.join();
+    CULog("Read-ahead: %llu underruns (random seeks only)",
+          (unsigned long long)stream->getUnderruns());
+    CUAssertLog(errors == 0, "Read-ahead produced %llu bad samples",
+                (unsigned long long)errors);
+}
+
+/**
+ * Compares the vectorized audio kernels to scalar code and times the graph nodes
+ */
+void testGraphKernels() {
+    using namespace cugl::dsp;
+    const size_t FRAMES = 1021;
+    std::vector<float> input1(FRAMES*2), input2(FRAMES*2);
+    std::vector<Sint16> pcm(FRAMES*2);
+    for(size_t ii = 0; ii < FRAMES*2; ii++) {
+        input1[ii] = sinf(ii*0.031f);
+        input2[ii] = cosf(ii*0.017f);
+        pcm[ii] = (Sint16)(32767*sinf(ii*0.007f));
+    }
+    const float matrix[4] = { 0.8f, 0.3f, 0.25f, 0.9f };
+
+    // Golden values are the scalar results
+    std::vector<float> golden[4], actual[4];
+    for(int pass = 0; pass < 2; pass++) {
+        std::vector<float>* results = pass ? actual : golden;
+        DSPMath::VECTORIZE = (pass == 1);
+        for(int ii = 0; ii < 4; ii++) {
+            results[ii].assign(FRAMES*2,0);
+        }
+        DSPMath::scale_add(input1.data(),input2.data(),0.7f,results[0].data(),FRAMES*2);
+        DSPMath::convert(pcm.data(),1.0f/32768,results[1].data(),FRAMES*2);
+        DSPMath::pan(input1.data(),2,matrix,2,results[2].data(),FRAMES);
+        DSPMath::pan(input1.data(),1,matrix,2,results[3].data(),FRAMES);
+        results[0][0] = DSPMath::dot(input1.data(),input2.data(),FRAMES*2);
+    }
+    DSPMath::VECTORIZE = true;
+
+    const char* names[] = { "scale_add/dot", "convert", "pan 2x2", "pan 1x2" };
+    for(int ii = 0; ii < 4; ii++) {
+        float error = 0;
+        for(size_t jj = 0; jj < FRAMES*2; jj++) {
+            error = std::max(error,fabsf(golden[ii][jj]-actual[ii][jj]));
+        }
+        CUAssertLog(error < 1e-3f, "Kernel %s differs by %f", names[ii], error);
+        CULog("Kernel %s: max error %g", names[ii], error);
+    }
+
+    // Time each node type on a 44.1 kHz source played at 48 kHz
+    cugl::AudioDevices::start();
+    Uint32 block = cugl::AudioDevices::get()->getReadSize();
+    std::shared_ptr<cugl::AudioSample> sample = cugl::AudioSample::alloc(2,44100,44100);
+    float* data = sample->getBuffer();
+    for(Uint32 ff = 0; ff < 2*44100; ff++) {
+        data[ff] = 0.5f*sinf(ff*0.05f);
+    }
+
+    std::shared_ptr<cugl::audio::AudioResampler> resampler = cugl::audio::AudioResampler::alloc(2,48000);
+    resampler->attach(cugl::audio::AudioPlayer::alloc(sample));
+    std::shared_ptr<cugl::audio::AudioFader> fader = cugl::audio::AudioFader::alloc(resampler);
+    std::shared_ptr<cugl::audio::AudioPanner> panner = cugl::audio::AudioPanner::alloc(2,2,48000);
+    panner->setPan(0,1,0.3f);
+    panner->attach(fader);
+    std::shared_ptr<cugl::audio::AudioMixer> mixer = cugl::audio::AudioMixer::alloc(8,2,48000);
+    for(Uint8 ii = 0; ii < 8; ii++) {
+        std::shared_ptr<cugl::AudioWaveform> wave;
+        wave = cugl::AudioWaveform::alloc(2,48000,cugl::AudioWaveform::Type::SINE,220+ii*110);
+        mixer->attach(ii,wave->createNode());
+    }
+
+    std::vector<float> buffer(block*2);
+    std::shared_ptr<cugl::audio::AudioNode> nodes[] = { resampler, fader, panner, mixer };
+    const char* labels[] = { "resampler", "fader", "panner", "mixer x8" };
+    for(int ii = 0; ii < 4; ii++) {
+        fader->fadeIn(0.5);
+        resampler->reset();
+        cugl::Timestamp start;
+        Uint64 total = 0;
+        for(int jj = 0; jj < 64; jj++) {
+            total += nodes[ii]->read(buffer.data(),block);
+        }
+        cugl::Timestamp end;
+        CULog("Node %s: %.1f ns/frame (cumulative)", labels[ii],
+              1000.0*cugl::Timestamp::ellapsedMicros(start,end)/std::max(total,(Uint64)1));
+    }
+    cugl::AudioDevices::stop();
+}
+
+/**
+ * Measures the audio engine under game loads on an offline output
+ */
+void testAudioBenchmark() {
+    const Uint32 RATE = 48000;
+    const Uint32 FPS  = 60;
+    const Uint32 SECONDS = 10;
+    cugl::AudioDevices::start();
+
+    // Bounce a music track at a foreign rate, so that it must be streamed and resampled
+    std::string path = cugl::Application::get()->getSaveDirectory()+"benchmark.wav";
+    {
+        std::shared_ptr<cugl::audio::AudioOfflineOutput> bounce;
+        bounce = cugl::audio::AudioOfflineOutput::alloc(2,44100);
+        std::shared_ptr<cugl::AudioWaveform> wave;
+        wave = cugl::AudioWaveform::alloc(2,44100,cugl::AudioWaveform::Type::NAIVE_TRIANG,110);
+        bounce->attach(wave->createNode());
+        bounce->setCapture(44100*SECONDS);
+        bounce->render(44100*SECONDS);
+        CUAssertLog(bounce->saveCapture(path), "Could not save the music track");
+    }
+    std::shared_ptr<cugl::AudioSample> music = cugl::AudioSample::alloc(path,true);
+
+    // Short effects in each in-memory format, at rates that need resampling
+    std::vector<std::shared_ptr<cugl::AudioSample>> effects;
+    Uint32 rates[] = { 22050, 44100, 48000 };
+    for(int ii = 0; ii < 3; ii++) {
+        std::shared_ptr<cugl::AudioSample> sample = cugl::AudioSample::alloc(2,rates[ii],rates[ii]/2);
+        float* data = sample->getBuffer();
+        for(Uint32 ff = 0; ff < rates[ii]/2; ff++) {
+            float envelope = 1.0f-(float)ff/(rates[ii]/2);
+            data[2*ff  ] = envelope*sinf(ff*(0.02f+ii*0.01f));
+            data[2*ff+1] = envelope*sinf(ff*(0.03f+ii*0.01f));
+        }
+        sample->setFormat((cugl::AudioSample::Format)ii);
+        effects.push_back(sample);
+    }
+
+    std::shared_ptr<cugl::audio::AudioOfflineOutput> output;
+    output = cugl::audio::AudioOfflineOutput::alloc(2,RATE);
+    if (output == nullptr || music == nullptr || !cugl::AudioEngine::start(output,32)) {
+        CULogError("Could not start the audio engine");
+        cugl::AudioDevices::stop();
+        return;
+    }
+
+    // Scheduled callbacks (which free finished voices) run once per frame
+    cugl::Application* app = cugl::Application::get();
+    float fps = app->getFPS();
+    app->setFPS(1000);
+
+    cugl::AudioEngine* engine = cugl::AudioEngine::get();
+    int loads[] = { 0, 8, 16, 24, 32 };
+    for(int load : loads) {
+        engine->clear(0);
+        engine->getMusicQueue()->play(music,true,0.5f,0.5f);
+        output->render(RATE/FPS);
+        app->step();
+        output->resetStatistics();
+
+        Uint64 frames = 0;
+        for(Uint32 frame = 0; frame < SECONDS*FPS; frame++) {
+            // Keep the given number of effects sounding, fading some out early
+            for(int ii = 0; ii < load; ii++) {
+                std::string key = "effect"+std::to_string(ii);
+                if (!engine->isActive(key)) {
+                    engine->play(key,effects[ii % 3],false,0.2f,true);
+                } else if ((frame+ii) % 45 == 0) {
+                    engine->clear(key,0.1f);
+                }
+            }
+            frames += output->render(RATE/FPS);
+            app->step();
+        }
+
+        CULog("Audio load %2d effects: %llu callbacks, %.1f us average, %llu us worst, %.2f%% CPU, %llu underruns",
+              load,(unsigned long long)output->getCallbacks(),output->getAverageCost(),
+              (unsigned long long)output->getWorstCost(),100*output->getLoad(),
+              (unsigned long long)output->getUnderruns());
+        CUAssertLog(frames >= SECONDS*RATE, "Rendered only %llu frames", (unsigned long long)frames);
+    }
+
+    app->setFPS(fps);
+    cugl::AudioEngine::stop();
+    cugl::AudioDevices::stop();
+}
+
+/**
+ * Compares FFT convolution to the direct form for long impulse responses
+ */
+void testConvolution() {
+    using namespace cugl::dsp;
+    const size_t FRAMES = 48000;
+    const size_t BLOCK  = 512;
+    std::vector<float> input(FRAMES*2), direct(FRAMES*2), fast(FRAMES*2);
+    for(size_t ii = 0; ii < FRAMES*2; ii++) {
+        input[ii] = sinf(ii*0.013f)+0.25f*sinf(ii*0.29f);
+    }
+
+    size_t threshold = FIRFilter::FFT_THRESHOLD;
+    const size_t taps[] = { 64, 512, 4096, 32768 };
+    for(int ii = 0; ii < 4; ii++) {
+        std::vector<float> impulse(taps[ii]);
+        for(size_t jj = 0; jj < taps[ii]; jj++) {
+            impulse[jj] = expf(-6.0f*jj/taps[ii])*sinf(jj*0.37f)/sqrtf((float)taps[ii]);
+        }
+
+        FIRFilter::FFT_THRESHOLD = (size_t)-1;
+        FIRFilter slow(2,impulse);
+        Convolver filter(2,impulse);
+
+        // Direct form is too slow to time on the full input for long filters
+        size_t length = std::min(FRAMES,(size_t)(FRAMES*64/taps[ii]));
+        cugl::Timestamp start;
+        for(size_t pos = 0; pos < length; pos += BLOCK) {
+            size_t amt = std::min(BLOCK,length-pos);
+            slow.calculate(1.0f,input.data()+2*pos,direct.data()+2*pos,amt);
+        }
+        cugl::Timestamp middle;
+        for(size_t pos = 0; pos < FRAMES; pos += BLOCK) {
+            size_t amt = std::min(BLOCK,FRAMES-pos);
+            filter.calculate(1.0f,input.data()+2*pos,fast.data()+2*pos,amt);
+        }
+        cugl::Timestamp end;
+
+        float error = 0;
+        for(size_t jj = 0; jj < length*2; jj++) {
+            error = std::max(error,fabsf(direct[jj]-fast[jj]));
+        }
+        CUAssertLog(error < 1e-3f, "Convolution of %zu taps differs by %f", taps[ii], error);
+        CULog("Convolution %5zu taps (block %4zu): fft %.1f ns/frame, direct %.1f ns/frame, max error %g",
+              taps[ii], filter.getBlockSize(),
+              1000.0*cugl::Timestamp::ellapsedMicros(middle,end)/FRAMES,
+              1000.0*cugl::Timestamp::ellapsedMicros(start,middle)/length, error);
+    }
+    FIRFilter::FFT_THRESHOLD = threshold;
+}
+
+/**
+ * Checks that storms of positional effects are capped at a constant cost
+ */
+void testSpatialAudio() {
+    const Uint32 RATE = 48000;
+    const Uint32 FPS  = 60;
+    cugl::AudioDevices::start();
+    std::shared_ptr<cugl::audio::AudioOfflineOutput> output;
+    output = cugl::audio::AudioOfflineOutput::alloc(2,RATE);
+    if (output == nullptr || !cugl::AudioEngine::start(output,32)) {
+        CULogError("Could not start the audio engine");
+        cugl::AudioDevices::stop();
+        return;
+    }
+
+    std::shared_ptr<cugl::AudioSample> hit = cugl::AudioSample::alloc(1,RATE,RATE/4);
+    float* data = hit->getBuffer();
+    for(Uint32 ff = 0; ff < RATE/4; ff++) {
+        data[ff] = (1.0f-(float)ff/(RATE/4))*sinf(ff*0.05f);
+    }
+
+    cugl::AudioEngine* engine = cugl::AudioEngine::get();
+    engine->setSpatialListener(cugl::Vec2::ZERO,100,400);
+    engine->setSpatialVoices(4);
+    CUAssertLog(engine->getSpatialPan(cugl::Vec2(-200,0)) == -1, "Pan is not clamped");
+    CUAssertLog(engine->getSpatialPan(cugl::Vec2(50,0)) == 0.5f, "Pan is not proportional");
+    CUAssertLog(engine->getSpatialGain(cugl::Vec2(0,200)) == 0.25f, "Gain is not attenuated");
+    CUAssertLog(!engine->playAt("far",hit,cugl::Vec2(500,0)), "Inaudible effect was not culled");
+
+    // Merged effects play at the loudest requested volume
+    engine->setSpatialVoices(1);
+    CUAssertLog(engine->playAt("merge",hit,cugl::Vec2::ZERO,0.8f), "Effect was not played");
+    for(int ii = 0; ii < 10; ii++) {
+        CUAssertLog(engine->playAt("merge",hit,cugl::Vec2::ZERO,0.6f), "Effect was not merged");
+    }
+    CUAssertLog(engine->getSpatialCount() == 1, "Merged effects used %zu voices", engine->getSpatialCount());
+    CUAssertLog(engine->getSpatialVolume("merge") == 0.8f, "Merged volume is %g, not 0.8",
+                engine->getSpatialVolume("merge"));
+    engine->clear(0);
+    engine->setSpatialVoices(4);
+
+    cugl::Application* app = cugl::Application::get();
+    float fps = app->getFPS();
+    app->setFPS(1000);
+
+    int storms[] = { 1, 10, 100, 1000 };
+    for(int storm : storms) {
+        engine->clear(0);
+        output->render(RATE/FPS);
+        app->step();
+        output->resetStatistics();
+
+        size_t accepted = 0;
+        size_t peak = 0;
+        for(Uint32 frame = 0; frame < FPS; frame++) {
+            for(int ii = 0; ii < storm; ii++) {
+                cugl::Vec2 pos(rand() % 600-300, rand() % 600-300);
+                accepted += engine->playAt("hit",hit,pos,1.0f) ? 1 : 0;
+            }
+            peak = std::max(peak,engine->getSpatialCount());
+            output->render(RATE/FPS);
+            app->step();
+        }
+        CUAssertLog(peak <= engine->getSpatialVoices(), "Played %zu positional voices", peak);
+        CULog("Storm of %4d hits/frame: %zu accepted, %zu voices, %.1f us average callback",
+              storm,accepted,peak,output->getAverageCost());
+    }
+
+    app->setFPS(fps);
+    cugl::AudioEngine::stop();
+    cugl::AudioDevices::stop();
+}
+
+/**
+ * Collects every (object, key) pair in the given JSON tree
+ *
+ * @param node  The root of the tree
+ * @param keys  The vector to store the pairs
+ */
+void collectJsonKeys(const std::shared_ptr<cugl::JsonValue>& node,
+                     std::vector<std::pair<cugl::JsonValue*,std::string>>& keys) {
+    for(unsigned int ii = 0; ii < node->size(); ii++) {
+        std::shared_ptr<cugl::JsonValue> child = node->get(ii);
+        if (node->isObject()) {
+            CUAssertLog(node->get(child->key()) == child, "Lookup of %s failed", child->key().c_str());
+            keys.push_back(std::make_pair(node.get(),child->key()));
+        }
+        collectJsonKeys(child,keys);
+    }
+}
+
+/**
+ * Measures parse and lookup times on the JSON files of our assets
+ */
+void testJsonParse() {
+    const int ROUNDS = 200;
+    const char* files[] = { "json/assets.json", "json/loading.json", "json/menu.json" };
+    for(int ii = 0; ii < 3; ii++) {
+        std::shared_ptr<cugl::TextReader> reader = cugl::TextReader::allocWithAsset(files[ii]);
+        if (reader == nullptr) {
+            CULogError("Could not read %s",files[ii]);
+            continue;
+        }
+        std::string text = reader->readAll();
+        reader->close();
+
+        // The cJSON parse alone was the first of two passes in the old DOM
+        cugl::Timestamp start;
+        for(int jj = 0; jj < ROUNDS; jj++) {
+            cJSON* node = cJSON_Parse(text.c_str());
+            cJSON_Delete(node);
+        }
+        cugl::Timestamp middle;
+        std::shared_ptr<cugl::JsonValue> json;
+        for(int jj = 0; jj < ROUNDS; jj++) {
+            json = cugl::JsonValue::allocWithJson(text);
+        }
+        cugl::Timestamp end;
+
+        cJSON* node = cJSON_Parse(text.c_str());
+        char* expected = cJSON_PrintUnformatted(node);
+        CUAssertLog(json->toString(false) == expected, "Parse of %s differs from cJSON", files[ii]);
+        free(expected);
+        cJSON_Delete(node);
+
+        std::vector<std::pair<cugl::JsonValue*,std::string>> keys;
+        collectJsonKeys(json,keys);
+        size_t found = 0;
+        cugl::Timestamp before;
+        for(int jj = 0; jj < ROUNDS; jj++) {
+            for(auto it = keys.begin(); it != keys.end(); ++it) {
+                found += it->first->get(it->second) != nullptr;
+            }
+        }
+        cugl::Timestamp after;
+        CUAssertLog(found == keys.size()*ROUNDS, "Missing keys in %s", files[ii]);
+
+        CULog("%-18s %6zu bytes: cJSON %.1f us, JsonValue %.1f us, lookup %.1f ns/key (%zu keys)",
+              files[ii], text.size(),
+              cugl::Timestamp::ellapsedMicros(start,middle)/(double)ROUNDS,
+              cugl::Timestamp::ellapsedMicros(middle,end)/(double)ROUNDS,
+              1000.0*cugl::Timestamp::ellapsedMicros(before,after)/(ROUNDS*keys.size()),
+              keys.size());
+    }
+
+    // Repeated keys share one string per document, but renamed nodes do not
+    std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocWithJson("[{\"name\":1},{\"name\":2}]");
+    CUAssertLog(&json->get(0)->get(0)->key() == &json->get(1)->get(0)->key(), "Keys are not interned");
+    json->get(1)->get(0)->setKey("label");
+    CUAssertLog(json->get(0)->get(0)->key() == "name", "Renaming a key changed the interned key");
+    CUAssertLog(json->get(1)->get("label") != nullptr, "Renamed key is not indexed");
+}
+
+void testJsonDepth() {
+    // The limit itself is fine
+    std::string text = std::string(1000,'[')+std::string(1000,']');
+    std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocWithJson(text);
+    CUAssertLog(json != nullptr, "Rejected JSON nested 1000 deep");
+    
+    // Anything deeper is an error (not an assert), no matter how deep
+    text = std::string(1001,'[')+std::string(1001,']');
+    bool shallow = cugl::JsonValue::allocWithJson(text) == nullptr;
+    text = std::string(1000000,'[');
+    bool deep = cugl::JsonValue::allocWithJson(text) == nullptr;
+    CUAssertLog(shallow && deep, "Accepted JSON nested over 1000 deep");
+    CULog("JSON depth: nesting capped at 1000");
+}
 
+void testJsonNumbers() {
+    // Long mantissas and large exponents must round exactly as strtod does
+    const char* valid[] = {
+        "0", "-0", "12", "-12.5", "0.1", "1e3", "1E-3", "2.5e+10",
+        "3.141592653589793238462643383279", "1.7976931348623157e308",
+        "2.2250738585072014e-308", "123456789012345678901234567890e-10",
+        "0.000000000000000000000000000000000000001",
+        "9007199254740993.000000000000000000000000000000000000000000000000000000000000000001"
+    };
+    for(size_t ii = 0; ii < sizeof(valid)/sizeof(const char*); ii++) {
+        std::string text = std::string("[")+valid[ii]+"]";
+        std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocWithJson(text);
+        CUAssertLog(json != nullptr, "Rejected the number %s", valid[ii]);
+        double value = json->get(0)->asDouble();
+        CUAssertLog(value == strtod(valid[ii],nullptr), "Parsed %s as %.17g", valid[ii], value);
+    }
+    
+    // Anything outside of the JSON grammar is an error
+    const char* invalid[] = {
+        "-", "1e", "1e+", "0123", "-01", "1.", ".5", "1.e3", "+1", "--1", "1e3.5"
+    };
+    for(size_t ii = 0; ii < sizeof(invalid)/sizeof(const char*); ii++) {
+        std::string text = std::string("[")+invalid[ii]+"]";
+        CUAssertLog(cugl::JsonValue::allocWithJson(text) == nullptr, "Accepted the number %s", invalid[ii]);
+    }
+    CULog("JSON numbers: %zu valid, %zu invalid",
+          sizeof(valid)/sizeof(const char*), sizeof(invalid)/sizeof(const char*));
+}
+
+/**
+ * Reads the JSON asset at the given path (nullptr if it cannot be read)
+ *
+ * @param path  The path relative to the asset directory
+ *
+ * @return the JSON asset at the given path
+ */
+std::shared_ptr<cugl::JsonValue> readJsonAsset(const std::string& path) {
+    std::shared_ptr<cugl::TextReader> reader = cugl::TextReader::allocWithAsset(path);
+    if (reader == nullptr) {
+        return nullptr;
+    }
+    std::string text = reader->readAll();
+    reader->close();
+    return cugl::JsonValue::allocWithJson(text);
+}
+
+/**
+ * Compiles the asset directories and compares them to the JSON sources
+ */
+void testAssetManifest() {
+    const int ROUNDS = 200;
+    std::vector<std::string> files = { "json/assets.json", "json/loading.json", "json/menu.json" };
+    std::vector<std::shared_ptr<cugl::JsonValue>> directories;
+    for(auto it = files.begin(); it != files.end(); ++it) {
+        directories.push_back(readJsonAsset(*it));
+    }
+    
+    for(size_t ii = 0; ii < files.size(); ii++) {
+        std::shared_ptr<cugl::AssetManifest> compiled;
+        compiled = cugl::AssetManifest::alloc(directories[ii],directories,readJsonAsset);
+        CUAssertLog(compiled != nullptr, "Could not compile %s", files[ii].c_str());
+        
+        std::vector<Uint8> data = compiled->getData();
+        std::shared_ptr<cugl::AssetManifest> manifest = cugl::AssetManifest::allocWithData(std::move(data));
+        CUAssertLog(manifest != nullptr, "Could not reload %s", files[ii].c_str());
+        for(size_t jj = 0; jj < manifest->getCategoryCount(); jj++) {
+            std::string category = manifest->getCategory(jj);
+            if (category != "widgets" && category != "scene2s") {
+                std::shared_ptr<cugl::JsonValue> json = manifest->getJson(manifest->getCategoryNode(jj));
+                CUAssertLog(json->toString(false) == directories[ii]->get(category)->toString(false),
+                            "Category %s of %s differs", category.c_str(), files[ii].c_str());
+            }
+        }
+        
+        // Compare the JSON parse to the manifest rebuild of every scene node
+        std::string text = directories[ii]->toString(false);
+        cugl::Timestamp start;
+        for(int jj = 0; jj < ROUNDS; jj++) {
+            cugl::JsonValue::allocWithJson(text);
+        }
+        cugl::Timestamp middle;
+        size_t total = 0;
+        for(int jj = 0; jj < ROUNDS; jj++) {
+            std::vector<Uint8> copy = compiled->getData();
+            manifest = cugl::AssetManifest::allocWithData(std::move(copy));
+            for(size_t kk = 0; kk < manifest->getSceneCount(); kk++) {
+                size_t count = 0;
+                const cugl::AssetManifest::Entry* entries = manifest->getSceneEntries(kk,count);
+                for(size_t pos = 0; pos < count; pos++) {
+                    manifest->getJson(entries[pos].data);
+                    manifest->getJson(entries[pos].format);
+                    manifest->getJson(entries[pos].layout);
+                }
+                total += count;
+            }
+        }
+        cugl::Timestamp end;
+        
+        CULog("%-18s %6zu bytes: JSON parse %.1f us, manifest %.1f us (%zu scene nodes)",
+              files[ii].c_str(), compiled->getData().size(),
+              cugl::Timestamp::ellapsedMicros(start,middle)/(double)ROUNDS,
+              cugl::Timestamp::ellapsedMicros(middle,end)/(double)ROUNDS,
+              total/ROUNDS);
+    }
+}
+
+/**
+ * Writes the given text to a file in the save directory
+ *
+ * @param file  The file name
+ * @param text  The file contents
+ */
+void writeSaveFile(const std::string& file, const std::string& text) {
+    std::string path = cugl::Application::get()->getSaveDirectory()+file;
+    std::shared_ptr<cugl::TextWriter> writer = cugl::TextWriter::alloc(path);
+    writer->write(text);
+    writer->close();
+}
+
+/**
+ * Checks that a manifest is stale once its directory or widget files change
+ */
+void testStaleManifest() {
+    std::string root = cugl::Application::get()->getSaveDirectory();
+    std::string widget = "{\"contents\":{\"type\":\"Node\"}}";
+    std::string directory = "{\"widgets\":{\"box\":\"stale_widget.json\"},"
+                            "\"scene2s\":{\"root\":{\"type\":\"Widget\",\"data\":{\"key\":\"box\"}}}}";
+    writeSaveFile("stale_widget.json",widget);
+    writeSaveFile("stale.json",directory);
+
+    cugl::AssetManifest::Reader reader = [=](const std::string& path) {
+        std::shared_ptr<cugl::TextReader> text = cugl::TextReader::alloc(root+path);
+        return text == nullptr ? nullptr : cugl::JsonValue::allocWithJson(text->readAll());
+    };
+    std::shared_ptr<cugl::JsonValue> json = reader("stale.json");
+    std::vector<std::shared_ptr<cugl::JsonValue>> context = { json };
+    std::vector<std::string> sources = { "stale.json" };
+    std::shared_ptr<cugl::AssetManifest> manifest;
+    manifest = cugl::AssetManifest::alloc(json,context,reader,root,sources);
+    CUAssertLog(manifest != nullptr, "Could not compile stale.json");
+    CUAssertLog(manifest->isCurrent(root), "Fresh manifest reported as stale");
+
+    // The reloaded manifest keeps its sources
+    std::vector<Uint8> data = manifest->getData();
+    manifest = cugl::AssetManifest::allocWithData(std::move(data));
+    CUAssertLog(manifest != nullptr && manifest->isCurrent(root), "Reloaded manifest reported as stale");
+
+    // Same size, different contents
+    writeSaveFile("stale_widget.json","{\"contents\":{\"type\":\"Nide\"}}");
+    CUAssertLog(!manifest->isCurrent(root), "Edited widget not detected");
+    writeSaveFile("stale_widget.json",widget);
+    CUAssertLog(manifest->isCurrent(root), "Restored widget reported as stale");
+
+    writeSaveFile("stale.json",directory+" ");
+    CUAssertLog(!manifest->isCurrent(root), "Edited directory not detected");
+    writeSaveFile("stale.json",directory);
+    CUAssertLog(manifest->isCurrent(root), "Restored directory reported as stale");
+    CULog("Stale manifests detected");
+}
+
+/**
+ * Compares the buffered and mapped readers on a large generated file
+ */
+void testMappedReaders() {
+    const int ROUNDS = 5;
+    const int NODES  = 100000;
+    
+    // A large JSON file, similar in shape to a scene graph
+    std::string text = "{\"nodes\":[";
+    for(int ii = 0; ii < NODES; ii++) {
+        text.append(ii ? ",\n" : "\n");
+        text.append("{\"name\":\"node"+std::to_string(ii)+"\",\"position\":[");
+        text.append(std::to_string(ii % 1024)+","+std::to_string(ii / 1024)+"],");
+        text.append("\"visible\":true,\"color\":\"#ff00ff\"}");
+    }
+    text.append("\n]}\n");
+    std::shared_ptr<cugl::TextWriter> writer = cugl::TextWriter::alloc("mapped.json");
+    writer->write(text);
+    writer->close();
+    
+    // Line by line throughput
+    size_t lines = 0;
+    cugl::Timestamp start;
+    for(int jj = 0; jj < ROUNDS; jj++) {
+        std::shared_ptr<cugl::TextReader> reader = cugl::TextReader::alloc("mapped.json");
+        while (reader->ready()) {
+            std::string line = reader->readLine();
+            lines++;
+        }
+    }
+    cugl::Timestamp middle;
+    size_t spans = 0;
+    for(int jj = 0; jj < ROUNDS; jj++) {
+        std::shared_ptr<cugl::TextReader> reader = cugl::TextReader::allocWithMapping(cugl::MappedFile::alloc("mapped.json"));
+        while (reader->ready()) {
+            std::string line = reader->readLine();
+            spans++;
+        }
+    }
+    cugl::Timestamp end;
+    CUAssertLog(lines == spans, "Mapped reader found %zu lines, not %zu", spans/ROUNDS, lines/ROUNDS);
+    
+    double mb = text.size()*ROUNDS/(1024.0*1024.0);
+    CULog("Lines (%zu bytes): buffered %.0f MB/s, mapped %.0f MB/s", text.size(),
+          mb/(cugl::Timestamp::ellapsedMicros(start,middle)/1000000.0),
+          mb/(cugl::Timestamp::ellapsedMicros(middle,end)/1000000.0));
+    
+    // JSON parse, where the buffered reader copies the file into a string
+    std::shared_ptr<cugl::JsonValue> buffered;
+    std::shared_ptr<cugl::JsonValue> mapped;
+    size_t copied = 0;
+    size_t resident = 0;
+    start.mark();
+    for(int jj = 0; jj < ROUNDS; jj++) {
+        std::shared_ptr<cugl::JsonReader> reader = cugl::JsonReader::alloc("mapped.json");
+        std::string json = reader->readJsonString();
+        copied = json.size();
+        buffered = cugl::JsonValue::allocWithJson(json);
+    }
+    middle.mark();
+    for(int jj = 0; jj < ROUNDS; jj++) {
+        std::shared_ptr<cugl::MappedFile> mapping = cugl::MappedFile::alloc("mapped.json");
+        resident = (mapping->isMapped() ? 0 : mapping->size());
+        mapped = cugl::JsonReader::allocWithMapping(mapping)->readJson();
+    }
+    end.mark();
+    CUAssertLog(mapped != nullptr && mapped->toString(false) == buffered->toString(false),
+                "Mapped parse differs from buffered parse");
+    
+    CULog("JSON  (%zu bytes): buffered %.1f ms (%zu heap bytes copied), mapped %.1f ms (%zu heap bytes copied)",
+          text.size(), cugl::Timestamp::ellapsedMicros(start,middle)/(1000.0*ROUNDS), copied,
+          cugl::Timestamp::ellapsedMicros(middle,end)/(1000.0*ROUNDS), resident);
+    
+    // Binary data, decoded in place from the span
+    std::shared_ptr<cugl::BinaryWriter> bwriter = cugl::BinaryWriter::alloc("mapped.b");
+    for(Uint32 ii = 0; ii < 1000000; ii++) {
+        bwriter->writeUint32(ii*2654435761u);
+    }
+    bwriter->close();
+    
+    Uint64 expected = 0;
+    start.mark();
+    std::shared_ptr<cugl::BinaryReader> breader = cugl::BinaryReader::alloc("mapped.b");
+    while (breader->ready(4)) {
+        expected += breader->readUint32();
+    }
+    middle.mark();
+    Uint64 actual = 0;
+    breader = cugl::BinaryReader::allocWithMapping(cugl::MappedFile::alloc("mapped.b"));
+    while (breader->ready(4)) {
+        actual += breader->readUint32();
+    }
+    end.mark();
+    Uint64 decoded = 0;
+    breader->reset();
+    size_t length = 0;
+    const Uint8* span = breader->peek(length);
+    for(size_t kk = 0; kk+4 <= length; kk += 4) {
+        Uint32 value;
+        std::memcpy(&value,span+kk,4);
+        decoded += cugl::marshall(value);
+    }
+    breader->advance(length);
+    cugl::Timestamp after;
+    CUAssertLog(expected == actual && expected == decoded, "Mapped binary sum differs from buffered sum");
+    CULog("Binary (4000000 bytes): buffered %.1f ms, mapped %.1f ms, span %.2f ms",
+          cugl::Timestamp::ellapsedMicros(start,middle)/1000.0,
+          cugl::Timestamp::ellapsedMicros(middle,end)/1000.0,
+          cugl::Timestamp::ellapsedMicros(end,after)/1000.0);
+}
+
+/**
+ * A synthetic loader whose assets are strings of the size given by the source
+ */
+class BlobLoader : public cugl::Loader<std::string> {
+public:
+    int reads = 0;
+    bool read(const std::string& key, const std::string& source,
+              cugl::LoaderCallback callback, bool async) override {
+        if (_assets.find(key) != _assets.end()) {
+            return false;
+        }
+        _assets[key] = std::make_shared<std::string>(std::stoul(source),'x');
+        reads++;
+        return true;
+    }
+    /** Marks an asset as in flight, as it is while its callback runs */
+    void fly(const std::string& key, bool flight) {
+        if (flight) {
+            _queue.emplace(key);
+        } else {
+            _queue.erase(key);
+        }
+    }
+    size_t measure(const std::shared_ptr<std::string>& asset) const override {
+        return asset->size();
+    }
+};
+
+void testAssetResidency() {
+    std::shared_ptr<BlobLoader> loader = std::make_shared<BlobLoader>();
+    std::shared_ptr<cugl::AssetManager> assets = cugl::AssetManager::alloc();
+    assets->attach<std::string>(loader->getHook());
+    assets->load<std::string>("a","1000");
+    assets->load<std::string>("b","2000");
+    assets->load<std::string>("c","4000");
+    CUAssertLog(assets->getFootprint() == 7000, "Footprint is %zu", assets->getFootprint());
+    
+    // Touch a, then hold c so that it is in use
+    assets->get<std::string>("a");
+    std::shared_ptr<std::string> held = assets->get<std::string>("c");
+    
+    // The budget evicts b first, as it was never used
+    assets->setMemoryBudget(5000);
+    size_t freed = assets->reclaim();
+    CUAssertLog(freed == 2000 && assets->isEvicted<std::string>("b"), "Evicted %zu bytes", freed);
+    CUAssertLog(!assets->isEvicted<std::string>("a"), "Evicted a recently used asset");
+    
+    // Assets in use survive even a full trim
+    freed = assets->trim(0);
+    CUAssertLog(freed == 1000 && assets->getFootprint() == 4000, "Trimmed %zu bytes", freed);
+    
+    // Evicted assets are restored on access, which may evict others
+    assets->setMemoryBudget(0);
+    std::shared_ptr<std::string> blob = assets->get<std::string>("b");
+    CUAssertLog(blob != nullptr && blob->size() == 2000 && loader->reads == 4, "Failed to restore b");
+    CUAssertLog(assets->getFootprint<std::string>("b") == 2000, "Restored footprint differs");
+    
+    // Assets still in flight are never trimmed
+    blob = nullptr;
+    loader->fly("b",true);
+    assets->trim(0);
+    CUAssertLog(!assets->isEvicted<std::string>("b"), "Trimmed an asset in flight");
+    loader->fly("b",false);
+    
+    // Access stamps are safe from any thread
+    std::vector<std::thread> readers;
+    for(int ii = 0; ii < 4; ii++) {
+        readers.emplace_back([=] {
+            for(int jj = 0; jj < 1000; jj++) {
+                assets->get<std::string>(jj % 2 ? "a" : "b");
+            }
+        });
+    }
+    for(auto it = readers.begin(); it != readers.end(); ++it) {
+        it->join();
+    }
+    
+    // Evicted assets are only restored on the main thread
+    assets->trim(0);
+    int reads = loader->reads;
+    std::thread worker([=] {
+        CUAssertLog(assets->get<std::string>("b") == nullptr, "Restored b off the main thread");
+    });
+    worker.join();
+    CUAssertLog(assets->isEvicted<std::string>("b") && loader->reads == reads, "Restored b off the main thread");
+    
+    // Unloading forgets an asset completely
+    assets->unload<std::string>("a");
+    CUAssertLog(assets->get<std::string>("a") == nullptr, "Unloaded asset was restored");
+    CULog("Asset residency: %zu bytes resident, %d reads", assets->getFootprint(), loader->reads);
+}
+
+/**
+ * Returns the peak signal-to-noise ratio (in dB) of the given channels.
+ *
+ * @param a         The first RGBA image
+ * @param b         The second RGBA image
+ * @param first     The first channel to compare
+ * @param last      The last channel to compare
+ *
+ * @return the peak signal-to-noise ratio (in dB) of the given channels.
+ */
+static double psnr(const std::vector<Uint8>& a, const std::vector<Uint8>& b, int first, int last) {
+    double error = 0;
+    size_t count = 0;
+    for(size_t ii = 0; ii < a.size(); ii += 4) {
+        for(int cc = first; cc <= last; cc++) {
+            double diff = (double)a[ii+cc]-(double)b[ii+cc];
+            error += diff*diff;
+            count++;
+        }
+    }
+    return error == 0 ? 99.0 : 10*log10(255.0*255.0*count/error);
+}
+
+void testTextureCooker() {
+    typedef cugl::CompressedImage::Format Format;
+    const Uint32 WIDTH  = 61;
+    const Uint32 HEIGHT = 37;
+    
+    // Smooth gradients with a hard edge and a little noise
+    std::vector<Uint8> pixels(4*WIDTH*HEIGHT);
+    Uint32 seed = 12345;
+    for(Uint32 y = 0; y < HEIGHT; y++) {
+        for(Uint32 x = 0; x < WIDTH; x++) {
+            seed = seed*1103515245+12345;
+            int noise = (int)((seed >> 16) % 9)-4;
+            Uint8* pixel = pixels.data()+4*(y*WIDTH+x);
+            pixel[0] = (Uint8)std::min(255,std::max(0,(int)(x*255/WIDTH)+noise));
+            pixel[1] = (Uint8)(y*255/HEIGHT);
+            pixel[2] = x < WIDTH/2 ? 40 : 220;
+            pixel[3] = (Uint8)((x+y)*255/(WIDTH+HEIGHT));
+        }
+    }
+    
+    std::shared_ptr<cugl::CompressedImage> image;
+    image = cugl::CompressedImage::allocWithPixels(pixels.data(), WIDTH, HEIGHT, Format::ETC2_RGBA, true);
+    CUAssertLog(image != nullptr && image->getLevelCount() == 6, "Mip chain is incomplete");
+    CUAssertLog(image->getByteSize() == 16*(16*10+8*5+4*3+2+1+1), "Size is %zu", image->getByteSize());
+    
+    std::vector<Uint8> decoded;
+    bool success = image->decode(0, decoded);
+    CUAssertLog(success && decoded.size() == pixels.size(), "Could not decode");
+    double color = psnr(pixels, decoded, 0, 2);
+    double alpha = psnr(pixels, decoded, 3, 3);
+    CUAssertLog(color > 32 && alpha > 40, "Quality is %.1f dB (color), %.1f dB (alpha)", color, alpha);
+    
+    // The smallest level is (roughly) the average of the image
+    std::vector<Uint8> tiny;
+    success = image->decode(5, tiny);
+    CUAssertLog(success && tiny.size() == 4, "Could not decode the last level");
+    for(int cc = 0; cc < 4; cc++) {
+        double mean = 0;
+        for(size_t ii = cc; ii < pixels.size(); ii += 4) {
+            mean += pixels[ii];
+        }
+        mean /= WIDTH*HEIGHT;
+        CUAssertLog(fabs(tiny[cc]-mean) < 24, "Mip chain channel %d is %d, not %.0f", cc, tiny[cc], mean);
+    }
+    
+    // Opaque images drop the alpha channel
+    std::shared_ptr<cugl::CompressedImage> opaque;
+    opaque = cugl::CompressedImage::allocWithPixels(pixels.data(), WIDTH, HEIGHT, Format::ETC2_RGB, false);
+    std::vector<Uint8> rgb;
+    success = opaque->decode(0, rgb);
+    CUAssertLog(success && opaque->getByteSize() == 8*16*10, "Could not encode RGB");
+    CUAssertLog(rgb[3] == 255 && psnr(pixels, rgb, 0, 2) > 32, "RGB quality differs");
+    
+    // The KTX file is read back exactly
+    success = image->save("cooked.ktx");
+    CUAssertLog(success, "Could not save the KTX file");
+    std::shared_ptr<cugl::CompressedImage> loaded = cugl::CompressedImage::allocWithFile("cooked.ktx");
+    CUAssertLog(loaded != nullptr && loaded->getFormat() == Format::ETC2_RGBA, "Could not load the KTX file");
+    CUAssertLog(loaded->getWidth() == WIDTH && loaded->getLevelCount() == 6, "KTX header differs");
+    for(size_t ii = 0; ii < image->getLevelCount(); ii++) {
+        size_t size1, size2;
+        const Uint8* data1 = image->getLevel(ii, size1);
+        const Uint8* data2 = loaded->getLevel(ii, size2);
+        CUAssertLog(size1 == size2 && memcmp(data1, data2, size1) == 0, "KTX level %zu differs", ii);
+    }
+    CULog("Texture cooker: %.1f dB (color), %.1f dB (alpha), %zu bytes", color, alpha, image->getByteSize());
+}
+
+/**
+ * A texture loader that exposes its variant selection
+ */
+class VariantLoader : public cugl::TextureLoader {
+public:
+    using cugl::TextureLoader::selectVariant;
+};
+
+void testTextureVariants() {
+    bool headless = cugl::RenderRecorder::isHeadless();
+    cugl::RenderRecorder::setHeadless(true);
+    
+    // A half resolution variant reports the full resolution size
+    std::shared_ptr<cugl::Texture> full = cugl::Texture::alloc(256, 128);
+    std::shared_ptr<cugl::Texture> half = cugl::Texture::alloc(128, 64);
+    half->setResolution(0.5f);
+    CUAssertLog(half->getSize() == full->getSize(), "Logical sizes differ");
+    CUAssertLog(half->getPixelSize() == cugl::Size(128,64), "Pixel size is wrong");
+    CUAssertLog(half->getFootprint()*4 == full->getFootprint(), "Footprint is %zu", half->getFootprint());
+    
+    // Atlas regions and filmstrip frames line up across tiers
+    std::shared_ptr<cugl::Texture> frame1 = full->getSubTexture(0.25f, 0.5f, 0.5f, 1.0f);
+    std::shared_ptr<cugl::Texture> frame2 = half->getSubTexture(0.25f, 0.5f, 0.5f, 1.0f);
+    CUAssertLog(frame1->getSize() == frame2->getSize() && frame2->getWidth() == 64,
+                "Frame is %ux%u", frame2->getWidth(), frame2->getHeight());
+    
+    // The loader picks the smallest variant that meets the resolution
+    std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocWithJson(
+        "{\"file\":\"core.png\",\"variants\":{\"0.5\":\"core@0.5x.png\",\"0.25\":\"core@0.25x.png\"}}");
+    VariantLoader loader;
+    float scale;
+    loader.setResolution(0.4f);
+    std::string source = loader.selectVariant(json, scale);
+    CUAssertLog(source == "core@0.5x.png" && scale == 0.5f, "Chose %s", source.c_str());
+    loader.setResolution(0.25f);
+    source = loader.selectVariant(json, scale);
+    CUAssertLog(source == "core@0.25x.png" && scale == 0.25f, "Chose %s", source.c_str());
+    loader.setResolution(2.0f);
+    source = loader.selectVariant(json, scale);
+    CUAssertLog(source == "core.png" && scale == 1.0f, "Chose %s", source.c_str());
+    
+    // Release the textures while still headless
+    CULog("Texture variants: %s", half->toString().c_str());
+    frame1 = frame2 = nullptr;
+    full = half = nullptr;
+    cugl::RenderRecorder::setHeadless(headless);
+}
+
+void testStreamedAnimation() {
+    const Uint32 WIDTH  = 48;
+    const Uint32 HEIGHT = 32;
+    const Uint32 FRAMES = 40;
+    
+    // A dark background with a drifting gradient and a moving square
+    std::vector<std::vector<Uint8>> frames(FRAMES);
+    for(Uint32 ff = 0; ff < FRAMES; ff++) {
+        frames[ff].resize(4*WIDTH*HEIGHT);
+        for(Uint32 y = 0; y < HEIGHT; y++) {
+            for(Uint32 x = 0; x < WIDTH; x++) {
+                Uint8* pixel = frames[ff].data()+4*(y*WIDTH+x);
+                bool square = (x >= ff && x < ff+8 && y >= 12 && y < 20);
+                pixel[0] = square ? 250 : 10;
+                pixel[1] = square ? 200 : (Uint8)(y < 4 ? (x+ff)*4 : 12);
+                pixel[2] = square ? 30 : 40;
+                pixel[3] = 255;
+            }
+        }
+    }
+    
+    std::shared_ptr<cugl::Filmstrip> strip = cugl::Filmstrip::alloc(WIDTH, HEIGHT, false, 16);
+    for(Uint32 ff = 0; ff < FRAMES; ff++) {
+        strip->append(frames[ff].data());
+    }
+    CUAssertLog(strip->getFrameCount() == FRAMES, "Filmstrip has %u frames", strip->getFrameCount());
+    CUAssertLog(strip->isKeyFrame(0) && strip->isKeyFrame(32) && !strip->isKeyFrame(33), "Key frames are wrong");
+    CUAssertLog(strip->getByteSize()*8 < strip->getFrameSize()*FRAMES, "Filmstrip is %zu bytes", strip->getByteSize());
+    
+    // Lossless decoding, both in order and by seeking
+    std::vector<Uint8> canvas;
+    Sint32 current = -1;
+    bool success = true;
+    for(Uint32 ff = 0; ff < FRAMES; ff++) {
+        success = success && strip->decode(ff, canvas, current) && canvas == frames[ff];
+    }
+    CUAssertLog(success, "Sequential decoding differs");
+    Uint32 seeks[5] = { 7, 3, 35, 36, 0 };
+    for(int ii = 0; ii < 5; ii++) {
+        success = success && strip->decode(seeks[ii], canvas, current) && canvas == frames[seeks[ii]];
+    }
+    CUAssertLog(success && current == 0, "Seeking differs");
+    
+    // Lossy encoding never drifts past the tolerance
+    std::shared_ptr<cugl::Filmstrip> lossy = cugl::Filmstrip::alloc(WIDTH, HEIGHT, true, 0, 4);
+    for(Uint32 ff = 0; ff < FRAMES; ff++) {
+        std::vector<Uint8> noisy = frames[ff];
+        for(size_t ii = 0; ii < noisy.size(); ii += 4) {
+            noisy[ii] = (Uint8)std::min(255, noisy[ii]+(int)((ii/4+ff) % 3));
+        }
+        lossy->append(noisy.data());
+        success = success && lossy->decode(ff, canvas, current);
+        for(size_t ii = 0; success && ii < noisy.size(); ii++) {
+            success = abs((int)canvas[ii]-(int)noisy[ii]) <= 4;
+        }
+    }
+    CUAssertLog(success && lossy->getByteSize() < strip->getByteSize(), "Lossy encoding drifts");
+    
+    // The file is read back exactly
+    success = strip->save("stream.film");
+    CUAssertLog(success, "Could not save the filmstrip");
+    std::shared_ptr<cugl::Filmstrip> loaded = cugl::Filmstrip::allocWithFile("stream.film");
+    CUAssertLog(loaded != nullptr && loaded->getFrameCount() == FRAMES && !loaded->hasAlpha(), "Could not load the filmstrip");
+    current = -1;
+    success = loaded->decode(FRAMES-1, canvas, current);
+    CUAssertLog(success && canvas == frames[FRAMES-1], "Loaded filmstrip differs");
+    
+    // The node only ever uploads into its ring
+    bool headless = cugl::RenderRecorder::isHeadless();
+    cugl::RenderRecorder::setHeadless(true);
+    std::shared_ptr<cugl::scene2::StreamedAnimationNode> node;
+    node = cugl::scene2::StreamedAnimationNode::alloc(loaded, 3);
+    CUAssertLog(node != nullptr && node->getSize() == FRAMES, "Could not create the node");
+    CUAssertLog(node->getContentSize() == cugl::Size(WIDTH,HEIGHT), "Node has the wrong size");
+    std::set<cugl::Texture*> textures;
+    textures.insert(node->getTexture().get());
+    int dropped = 0;
+    for(Uint32 ff = 1; ff < 2*FRAMES; ff++) {
+        int frame = ff % FRAMES;
+        node->setFrame(frame);
+        for(int tries = 0; node->getDisplayedFrame() != frame && tries < 100000; tries++) {
+            if (tries == 0) { dropped++; }
+            std::this_thread::yield();
+            node->setFrame(frame);
+        }
+        CUAssertLog(node->getDisplayedFrame() == frame, "Frame %d never arrived", frame);
+        textures.insert(node->getTexture().get());
+    }
+    
+    // Seeking restarts the decoder
+    node->setFrame(25);
+    for(int tries = 0; node->getDisplayedFrame() != 25 && tries < 100000; tries++) {
+        std::this_thread::yield();
+        node->setFrame(25);
+    }
+    CUAssertLog(node->getDisplayedFrame() == 25, "Seek never arrived");
+    CUAssertLog(textures.size() == 3, "Node used %zu textures", textures.size());
+    
+    CULog("Streamed animation: %zu bytes for %u frames (%zu decoded), %d late frames",
+          strip->getByteSize(), FRAMES, strip->getFrameSize()*FRAMES, dropped);
+    node = nullptr;
+    cugl::RenderRecorder::setHeadless(headless);
+}
+
+/**
+ * Tests that a baked font matches the font it was baked from
+ *
+ * This bakes the game font both as a coverage atlas and as a distance
+ * field, and compares the metrics, kerning, and meshes of the results.
+ */
+void testBakedFont() {
+    std::string path = cugl::Application::get()->getAssetDirectory()+"fonts/SairaSemicondensed.ttf";
+    const std::string text = "Core Impact: AVATAR Wave 12";
+    
+    Uint64 start = SDL_GetPerformanceCounter();
+    std::shared_ptr<cugl::Font> font = cugl::Font::alloc(path, 20);
+    if (font == nullptr) {
+        CULogError("Could not read %s", path.c_str());
+        return;
+    }
+    bool success = font->buildAtlasAsync();
+    Uint64 rasterized = SDL_GetPerformanceCounter()-start;
+    success = success && font->bake("saira.20.font");
+    CUAssertLog(success, "Could not bake the font");
+    
+    start = SDL_GetPerformanceCounter();
+    std::shared_ptr<cugl::Font> baked = cugl::Font::allocWithBaked("saira.20.font");
+    Uint64 loaded = SDL_GetPerformanceCounter()-start;
+    CUAssertLog(baked != nullptr && baked->isBaked() && !baked->isDistanceField(), "Could not load the baked font");
+    CUAssertLog(baked->getHeight() == font->getHeight() && baked->getAscent() == font->getAscent() &&
+                baked->getDescent() == font->getDescent() && baked->getLineSkip() == font->getLineSkip(),
+                "Baked font has the wrong dimensions");
+    for(Uint32 a = 32; success && a < 127; a++) {
+        success = baked->hasGlyph(a) == font->hasGlyph(a);
+        if (success && font->hasGlyph(a)) {
+            cugl::Font::Metrics m1 = font->getMetrics(a);
+            cugl::Font::Metrics m2 = baked->getMetrics(a);
+            success = m1.minx == m2.minx && m1.maxx == m2.maxx && m1.miny == m2.miny &&
+                      m1.maxy == m2.maxy && m1.advance == m2.advance;
+            for(Uint32 b = 32; success && b < 127; b++) {
+                success = !font->hasGlyph(b) || baked->getKerning(a,b) == font->getKerning(a,b);
+            }
+        }
+    }
+    CUAssertLog(success, "Baked glyphs differ");
+    CUAssertLog(baked->getSize(text) == font->getSize(text), "Baked font measures differently");
+    CUAssertLog(baked->getInternalBounds(text) == font->getInternalBounds(text), "Baked font has different bounds");
+    
+    // A coverage atlas only serves its own size
+    std::shared_ptr<cugl::Font> wrong = cugl::Font::allocWithBaked("saira.20.font", 32);
+    CUAssertLog(wrong == nullptr, "Coverage atlas loaded at the wrong size");
+    
+    // A distance field serves every size
+    std::shared_ptr<cugl::Font> large = cugl::Font::alloc(path, 64);
+    large->setHinting(cugl::Font::Hinting::NONE);
+    success = large->buildAtlasAsync() && large->bake("saira.font", 6);
+    CUAssertLog(success, "Could not bake the distance field");
+    std::shared_ptr<cugl::Font> field = cugl::Font::allocWithBaked("saira.font", 32);
+    std::shared_ptr<cugl::Font> exact = cugl::Font::alloc(path, 32);
+    CUAssertLog(field != nullptr && field->isDistanceField(), "Could not load the distance field");
+    CUAssertLog(abs(field->getHeight()-exact->getHeight()) <= 2, "Distance field height %d is not %d",
+                field->getHeight(), exact->getHeight());
+    float width = field->getSize(text).width;
+    float expected = exact->getSize(text).width;
+    CUAssertLog(fabsf(width-expected) <= 0.05f*expected, "Distance field width %g is not %g", width, expected);
+    
+    // The mesh covers the measured text, in the coordinates of the font size
+    bool headless = cugl::RenderRecorder::isHeadless();
+    cugl::RenderRecorder::setHeadless(true);
+    cugl::Mesh<cugl::SpriteVertex2> mesh;
+    mesh.command = GL_TRIANGLES;
+    std::shared_ptr<cugl::Texture> atlas = field->getMesh(text, cugl::Vec2::ZERO, mesh);
+    CUAssertLog(atlas != nullptr && atlas == field->getAtlas(), "Distance field has no atlas");
+    float right = 0;
+    for(auto it = mesh.vertices.begin(); it != mesh.vertices.end(); ++it) {
+        right = std::max(right, it->position.x);
+    }
+    CUAssertLog(fabsf(right-width) <= 2, "Distance field mesh ends at %g, not %g", right, width);
+    cugl::RenderRecorder::setHeadless(headless);
+    
+    CULog("Baked font: rasterized in %g ms, loaded in %g ms",
+          1000.0*rasterized/SDL_GetPerformanceFrequency(), 1000.0*loaded/SDL_GetPerformanceFrequency());
+}
+
+void testSaveWriter() {
+    std::shared_ptr<cugl::SaveWriter> writer = cugl::SaveWriter::alloc("saved.json");
+    CUAssertLog(writer != nullptr, "Could not allocate the save writer");
+    
+    // A burst of saves only needs to write the last one
+    std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocObject();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int ii = 0; ii < 100; ii++) {
+        json->removeChild("count");
+        json->appendValue("count", (long)ii);
+        writer->save(json);
+    }
+    Uint64 queued = SDL_GetPerformanceCounter()-start;
+    bool success = writer->flush(5000);
+    Uint64 written = SDL_GetPerformanceCounter()-start;
+    CUAssertLog(success && !writer->isPending(), "Save writer did not finish");
+    
+    std::shared_ptr<cugl::JsonReader> reader = cugl::JsonReader::alloc("saved.json");
+    CUAssertLog(reader != nullptr, "Save file was not written");
+    std::shared_ptr<cugl::JsonValue> saved = reader->readJson();
+    CUAssertLog(saved != nullptr && saved->getInt("count") == 99, "Save file has the wrong contents");
+    reader = nullptr;
+    CUAssertLog(!cugl::filetool::file_exists(writer->getFile()+".tmp"), "Temporary save file was left behind");
+    
+    // A save outlives the writer
+    writer->save("{ \"count\" : -1 }\n");
+    writer = nullptr;
+    saved = cugl::JsonReader::alloc("saved.json")->readJson();
+    CUAssertLog(saved != nullptr && saved->getInt("count") == -1, "Disposed writer lost a save");
+    
+    CULog("Save writer: queued 100 saves in %g ms, written in %g ms",
+          1000.0*queued/SDL_GetPerformanceFrequency(), 1000.0*written/SDL_GetPerformanceFrequency());
+}
+
+void testSceneBuilder() {
+    // A wide scene, with one child of an unknown type
+    std::shared_ptr<cugl::JsonValue> json = cugl::JsonValue::allocObject();
+    json->appendValue("type", "Node");
+    json->appendChild("data", cugl::JsonValue::allocObject());
+    json->get("data")->appendChild("size", cugl::JsonValue::allocWithJson("[1024, 576]"));
+    std::shared_ptr<cugl::JsonValue> children = cugl::JsonValue::allocObject();
+    for(int ii = 0; ii < 50; ii++) {
+        std::string panel = "{ \"type\" : \"Node\", \"data\" : { \"size\" : [20, 20] }, \"children\" : {";
+        for(int jj = 0; jj < 20; jj++) {
+            panel += (jj ? ", " : "")+std::string("\"item")+cugl::strtool::to_string(jj)+"\" : ";
+            panel += (jj == 7 ? "{ \"type\" : \"Unknown\" }" : "{ \"type\" : \"Node\", \"data\" : { \"size\" : [1, 1] } }");
+        }
+        panel += "} }";
+        children->appendChild("panel"+cugl::strtool::to_string(ii), cugl::JsonValue::allocWithJson(panel));
+    }
+    json->appendChild("children", children);
+    
+    std::shared_ptr<cugl::Scene2Loader> loader = cugl::Scene2Loader::alloc();
+    Uint64 start = SDL_GetPerformanceCounter();
+    std::shared_ptr<cugl::scene2::SceneNode> scene = loader->build("scene", json);
+    Uint64 built = SDL_GetPerformanceCounter()-start;
+    CUAssertLog(scene != nullptr && scene->getName() == "scene", "Could not build the scene");
+    CUAssertLog(scene->getChildCount() == 50, "Scene has %zu panels", scene->getChildCount());
+    bool success = true;
+    for(int ii = 0; success && ii < 50; ii++) {
+        std::shared_ptr<cugl::scene2::SceneNode> panel = scene->getChild(ii);
+        success = panel->getName() == "panel"+cugl::strtool::to_string(ii) && panel->getChildCount() == 19;
+        success = success && panel->getChild(7)->getName() == "item8";
+    }
+    CUAssertLog(success, "Scene nodes are out of order");
+    
+    // A scene with an unknown root cannot be built
+    std::shared_ptr<cugl::JsonValue> bad = cugl::JsonValue::allocWithJson("{ \"type\" : \"Unknown\" }");
+    CUAssertLog(loader->build("bad", bad) == nullptr, "Built a scene with an unknown root");
+    
+    CULog("Scene builder: built 1001 nodes in %g ms", 1000.0*built/SDL_GetPerformanceFrequency());
+    
+    // The same scene, a slice per 1 ms frame (callbacks need a whole millisecond)
+    cugl::Application* app = cugl::Application::get();
+    float fps = app->getFPS();
+    app->setFPS(1000);
+    const Uint32 budget = 500;
+    std::shared_ptr<cugl::scene2::SceneNode> copy = nullptr;
+    bool done = false;
+    loader->instantiate("copy", json, budget, [&](const std::shared_ptr<cugl::scene2::SceneNode>& root) {
+        copy = root;
+        done = true;
+    });
+    Uint32 slices = 0;
+    Uint64 longest = 0;
+    while (!done && slices < 10000) {
+        cugl::Timestamp start;
+        app->step();
+        cugl::Timestamp end;
+        longest = std::max(longest,cugl::Timestamp::ellapsedMicros(start,end));
+        slices++;
+    }
+    CUAssertLog(copy != nullptr && copy->getName() == "copy", "Could not instantiate the scene");
+    CUAssertLog(copy->getChildCount() == 50 && copy->getChild(49)->getChildCount() == 19,
+                "Instantiated scene is incomplete");
+    CULog("Scene builder: built 1001 nodes in %u frames with a %u us budget (longest frame %llu us with pacing)",
+          slices, budget, (unsigned long long)longest);
+    app->setFPS(fps);
+}
+
+void testJobSystem() {
+    // Fine-grained tasks: each index is a fraction of a microsecond of work
+    const size_t count = 1 << 22;
+    std::vector<float> values(count);
+    auto work = [&](size_t index) {
+        float x = (float)index;
+        for(int jj = 0; jj < 16; jj++) {
+            x = x*0.999f+1.0f;
+        }
+        values[index] = x;
+    };
+    
+    int cores = std::max(SDL_GetCPUCount(),1);
+    double serial = 0;
+    for(int threads = 0; threads < cores; threads++) {
+        // The calling thread is a worker while it waits
+        std::shared_ptr<cugl::ThreadPool> pool = cugl::ThreadPool::alloc(threads);
+        Uint64 start = SDL_GetPerformanceCounter();
+        pool->parallel_for(0, count, 1024, work);
+        double time = 1000.0*(SDL_GetPerformanceCounter()-start)/SDL_GetPerformanceFrequency();
+        serial = (threads == 0 ? time : serial);
+        CULog("Job system: %d cores in %g ms (%.2fx)", threads+1, time, serial/time);
+    }
+    
+    // A diamond of dependencies: a -> (b,c) -> d
+    std::shared_ptr<cugl::ThreadPool> pool = cugl::ThreadPool::alloc(cores-1);
+    std::atomic<int> stage(0);
+    std::atomic<int> errors(0);
+    cugl::TaskGroup first, middle, last;
+    for(int ii = 0; ii < 100; ii++) {
+        pool->addTask(first, [&] { stage++; });
+    }
+    pool->after(first, [&] { errors += (stage.load() < 100); stage += 10; }, &middle);
+    pool->after(first, [&] { errors += (stage.load() < 100); stage += 10; }, &middle);
+    pool->after(middle, [&] { errors += (stage.load() != 120); stage++; }, &last);
+    pool->wait(last);
+    CUAssertLog(stage.load() == 121 && errors.load() == 0, "Task dependencies out of order");
+    
+    // Tasks too large for the inline storage
+    std::array<double,16> payload;
+    payload.fill(1.0);
+    std::atomic<int> total(0);
+    for(int ii = 0; ii < 100; ii++) {
+        pool->addTask(last, [=, &total] { total += (int)payload[ii % 16]; });
+    }
+    pool->wait(last);
+    CUAssertLog(total.load() == 100, "Large tasks were lost");
+    
+    // Tasks added without a group keep their order, even from inside a task
+    std::shared_ptr<cugl::ThreadPool> single = cugl::ThreadPool::alloc(1);
+    std::vector<int> order;
+    std::atomic<bool> done(false);
+    single->addTask([&] {
+        for(int ii = 0; ii < 100; ii++) {
+            single->addTask([&order, ii] { order.push_back(ii); });
+        }
+        single->addTask([&done] { done = true; });
+    });
+    while (!done.load()) {
+        std::this_thread::yield();
+    }
+    bool ordered = order.size() == 100;
+    for(size_t ii = 0; ordered && ii < order.size(); ii++) {
+        ordered = order[ii] == (int)ii;
+    }
+    CUAssertLog(ordered, "Nested tasks ran out of order");
+    single = nullptr;
+    
+    // Stopping a pool finishes its groups
+    pool->stop();
+    pool->addTask(last, [&] { total++; });
+    pool->wait(last);
+    CUAssertLog(total.load() == 100 && last.isDone(), "Stopped pool ran a task");
+}
+
+/**
+ * A unit test that may be chosen by name from the command line
+ */
+typedef struct {
+    /** The test name (the name of the test function) */
+    const char* name;
+    /** The test function */
+    void (*run)();
+} UnitTest;
+
+/** The unit tests that may be run by name */
+static const UnitTest UNIT_TESTS[] = {
+#if !defined (CU_NO_LEGACY_TESTS)
+    { "mathUnitTest",          cugl::mathUnitTest },
+    { "sceneUnitTest",         cugl::sceneUnitTest },
+#endif
+    { "testBinary",            testBinary },
+    { "testFree",              testFree },
+    { "testThread",            testThread },
+    { "testRecorder",          testRecorder },
+    { "testTransform",         testTransform },
+    { "testChunkify",          testChunkify },
+    { "testDeferred",          testDeferred },
+    { "testCachedNode",        testCachedNode },
+    { "testAudioStress",       testAudioStress },
+    { "testReadAhead",         testReadAhead },
+    { "testVoicePool",         testVoicePool },
+    { "testSampleFormats",     testSampleFormats },
+    { "testGraphKernels",      testGraphKernels },
+    { "testAudioBenchmark",    testAudioBenchmark },
+    { "testConvolution",       testConvolution },
+    { "testSpatialAudio",      testSpatialAudio },
+    { "testJsonParse",         testJsonParse },
+    { "testJsonDepth",         testJsonDepth },
+    { "testJsonNumbers",       testJsonNumbers },
+    { "testAssetManifest",     testAssetManifest },
+    { "testStaleManifest",     testStaleManifest },
+    { "testMappedReaders",     testMappedReaders },
+    { "testAssetResidency",    testAssetResidency },
+    { "testTextureCooker",     testTextureCooker },
+    { "testTextureVariants",   testTextureVariants },
+    { "testStreamedAnimation", testStreamedAnimation },
+    { "testBakedFont",         testBakedFont },
+    { "testSaveWriter",        testSaveWriter },
+    { "testSceneBuilder",      testSceneBuilder },
+    { "testJobSystem",         testJobSystem },
+};
+
+/**
+ * Runs the unit tests named on the command line.
+ *
+ * The usage is
+ *
+ *     test [--headless] [<name> ...]
+ *
+ * where each name is a test in UNIT_TESTS.  Without any names, this runs
+ * the first test (mathUnitTest in Xcode).  A failed test stops on an
+ * assert, so the process exits abnormally.  An unknown test name is an
+ * error.
+ */
 int main(int argc, char * argv[]) {
+    bool headless = false;
+    std::vector<std::string> names;
+    for(int ii = 1; ii < argc; ii++) {
+        std::string arg = argv[ii];
+        if (arg == "--headless") {
+            headless = true;
+        } else {
+            names.push_back(arg);
+        }
+    }
+    if (names.empty()) {
+        names.push_back(UNIT_TESTS[0].name);
+    }
+    
     cugl::Application app;
     app.setName("Unit Test");
     app.setOrganization("GDIAC");
+    app.setHeadless(headless);
     if (!app.init()) {
         return 1;
     }
@@ -195,14 +2082,23 @@ int main(int argc, char * argv[]) {
     CULog("No Vectorization Support");
 #endif
     
-    cugl::mathUnitTest();
-
-    //cugl::sceneUnitTest();
-    //testBinary();
-    //testFree();
-    //testThread();
+    int result = 0;
+    const size_t count = sizeof(UNIT_TESTS)/sizeof(UnitTest);
+    for(auto it = names.begin(); it != names.end(); ++it) {
+        size_t pos = 0;
+        while (pos < count && *it != UNIT_TESTS[pos].name) {
+            pos++;
+        }
+        if (pos == count) {
+            CULogError("Unknown test '%s'", it->c_str());
+            result = 1;
+        } else {
+            CULog("Running %s", it->c_str());
+            UNIT_TESTS[pos].run();
+        }
+    }
     
     app.quit();
     app.onShutdown();
-    return 0;
+    return result;
 }
@@ -6,6 +6,13 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  The pool is a work-stealing scheduler.  Each worker has its own task deque,
+//  and idle workers steal from the others, so fine-grained tasks do not all
+//  contend for a single lock.  Tasks are stored without heap allocation when
+//  they are small enough.  Tasks may be collected in a group, which can be
+//  waited on, or which can start other tasks when it finishes.  A thread that
+//  waits on a group executes tasks while it waits.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -33,9 +40,15 @@
 //  Version: 11/29/16
 //
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUDebug.h>
 
 using namespace cugl;
 
+/** The pool of the calling thread, if it is a worker */
+static thread_local ThreadPool* t_pool = nullptr;
+/** The worker position of the calling thread in t_pool */
+static thread_local size_t t_index = 0;
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -43,12 +56,12 @@ using namespace cugl;
  *
  * A disposed thread pool can be safely reinitialized. However, it is a bad
  * idea to destroy the thread pool if the pool is not yet shut down. The
- * task queue is shared by the child threads, so we cannot delete it until
- * all the threads complete.  This destructor will block unti showndown.
+ * task deques are shared by the child threads, so we cannot delete them
+ * until all the threads complete.  This method will block until shutdown.
  */
 void ThreadPool::dispose() {
     stop();
-    while (!isShutdown());
+    _queues.clear();
 }
 
 /**
@@ -58,11 +71,30 @@ void ThreadPool::dispose() {
  * 4 is generally a good number, even if you have a lot of tasks.  Much
  * more than the number of cores on a machine is counter-productive.
  *
+ * A pool with no threads is allowed.  Its tasks are only executed by
+ * threads that wait on the pool.
+ *
  * @param threads   the number of threads in this pool
  *
  * @return true if the threed pool is initialized properly, false otherwise.
  */
 bool ThreadPool::init(int threads) {
+    if (!_workers.empty()) {
+        CUAssertLog(false, "ThreadPool is already initialized");
+        return false;
+    }
+
+    // The deques must all exist before any thread can steal from them
+    threads = (threads < 0 ? 0 : threads);
+    _queues.clear();
+    for (int index = 0; index <= threads; ++index) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    _queued = 0;
+    _started = 0;
+    _complete = 0;
+    _stop = false;
+
     for (int index = 0; index < threads; ++index) {
 #ifdef CU_SDL_THREADS
         _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)this));
@@ -80,66 +112,205 @@ bool ThreadPool::init(int threads) {
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
+ * This function pulls tasks from the deques until the pool is stopped.
  *
  * This implementation is safe to use with std::thread.
  */
 void ThreadPool::threadFunc() {
+    size_t index = (size_t)(_started++);
+    t_pool = this;
+    t_index = index;
     while (!_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(_queueMutex);
-            if (_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!_taskQueue.empty()) {
-                task = std::move(_taskQueue.front());
-                _taskQueue.pop();
-            } else {
-                _taskCondition.wait(lk);
-                continue;
-            }
+        if (runOne(index)) {
+            continue;
         }
-        // Perform the current task
-        task();
+
+        // Sleep until there is work (see push for the other half)
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _sleeping++;
+        _taskCondition.wait(lk, [this] { return _stop || _queued > 0; });
+        _sleeping--;
     }
+    t_pool = nullptr;
     _complete++;
 }
 
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
+ * This function pulls tasks from the deques until the pool is stopped.
  *
  * This static implementation uses the SDL thread API.  It should be used
  * on Android and Windows, which have special thread requirements.
  */
 int ThreadPool::sdlThreadFunc(void* ptr) {
     ThreadPool* self = (ThreadPool*)ptr;
-    while (!self->_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(self->_queueMutex);
-            if (self->_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!self->_taskQueue.empty()) {
-                task = std::move(self->_taskQueue.front());
-                self->_taskQueue.pop();
-            } else {
-                self->_taskCondition.wait(lk);
-                continue;
-            }
+    self->threadFunc();
+    return 0;
+}
+
+/**
+ * Returns the worker position of the calling thread.
+ *
+ * If the calling thread is not a worker of this pool, this method
+ * returns the position of the shared queue.
+ *
+ * @return the worker position of the calling thread.
+ */
+size_t ThreadPool::getIndex() const {
+    return (t_pool == this ? t_index : _queues.size()-1);
+}
+
+/**
+ * Adds the given task to the appropriate deque.
+ *
+ * A task in a group goes to the worker deque if the calling thread is a
+ * worker of this pool.  All other tasks go to the shared queue, so that
+ * they keep their order.  The group must already count the task.
+ *
+ * @param task      The task to add
+ * @param group     The group of the task (or nullptr)
+ */
+void ThreadPool::push(Task&& task, TaskGroup* group) {
+    if (_queues.empty()) {
+        CUAssertLog(false, "Attempt to add a task to an uninitialized thread pool");
+        if (group != nullptr) {
+            finish(group);
         }
-        // Perform the current task
-        task();
+        return;
     }
-    self->_complete++;
-    return 0;
+
+    // Ungrouped tasks may depend on the order they were added (see AssetManager)
+    Queue* queue = _queues[group != nullptr ? getIndex() : _queues.size()-1].get();
+    {
+        // Checked under the lock, so stop cannot miss this task
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!_stop) {
+            queue->jobs.push_back({std::move(task),group});
+            _queued++;
+        }
+    }
+
+    if (task) {
+        // The pool is stopped, so the task is discarded
+        task.reset();
+        if (group != nullptr) {
+            finish(group);
+        }
+    } else if (_sleeping > 0) {
+        // Locking makes sure a thread checking _queued is either before
+        // the check or already waiting.
+        std::lock_guard<std::mutex> lk(_sleepMutex);
+        _taskCondition.notify_one();
+    }
+}
+
+/**
+ * Returns true if a task was found and executed.
+ *
+ * This method looks first at the deque of the given worker, then at the
+ * shared queue, and then steals from the other workers.
+ *
+ * @param index The worker position (or the number of workers for another thread)
+ *
+ * @return true if a task was found and executed.
+ */
+bool ThreadPool::runOne(size_t index) {
+    if (_queued == 0) {
+        return false;
+    }
+
+    Job job;
+    job.group = nullptr;
+    size_t shared = _queues.size()-1;
+    bool found = false;
+
+    // Newest task of our own first, as its data is most likely in cache
+    if (index < shared) {
+        Queue* queue = _queues[index].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!queue->jobs.empty()) {
+            job = std::move(queue->jobs.back());
+            queue->jobs.pop_back();
+            _queued--;
+            found = true;
+        }
+    }
+
+    // Then the oldest task in the shared queue
+    if (!found) {
+        Queue* queue = _queues[shared].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!queue->jobs.empty()) {
+            job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+            _queued--;
+            found = true;
+        }
+    }
+
+    // Then steal the oldest task of another worker, starting with our neighbor
+    for (size_t ii = 1; !found && ii <= shared; ii++) {
+        size_t victim = (index+ii) % shared;
+        if (victim == index) {
+            continue;
+        }
+        Queue* queue = _queues[victim].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (!queue->jobs.empty()) {
+            job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+            _queued--;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    job.task();
+    job.task.reset();
+    if (job.group != nullptr) {
+        finish(job.group);
+    }
+    return true;
 }
 
+/**
+ * Marks one task of the group as finished.
+ *
+ * If this was the last task, the successors of the group are started,
+ * and any thread waiting on the group is woken up.
+ *
+ * @param group     The group of the finished task
+ */
+void ThreadPool::finish(TaskGroup* group) {
+    // Only the last task needs the lock
+    Uint32 pending = group->_pending.load(std::memory_order_relaxed);
+    while (pending > 1) {
+        if (group->_pending.compare_exchange_weak(pending, pending-1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    std::vector<std::pair<Task,TaskGroup*>> successors;
+    {
+        // A group is not released until this lock is, see wait()
+        std::lock_guard<std::mutex> lk(group->_mutex);
+        if (group->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            successors.swap(group->_successors);
+        }
+    }
+
+    for (auto it = successors.begin(); it != successors.end(); ++it) {
+        push(std::move(it->first), it->second);
+    }
+    if (_sleeping > 0) {
+        std::lock_guard<std::mutex> lk(_sleepMutex);
+        _taskCondition.notify_all();
+    }
+}
 
 
 #pragma mark -
@@ -152,28 +323,98 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
  * will not be executed immediately, but must wait for the first available
  * worker.
  *
+ * Tasks added with this method start in the order they are added, even
+ * if they are added from inside another task.
+ *
  * @param  task     the task function to add to the thread pool
  */
-void ThreadPool::addTask(const std::function<void()> &task){
-    std::unique_lock<std::mutex> lk(_queueMutex);
-    _taskQueue.emplace(task);
-    _taskCondition.notify_one();
+void ThreadPool::addTask(Task task) {
+    push(std::move(task), nullptr);
+}
+
+/**
+ * Adds a task in the given group to the thread pool.
+ *
+ * The group counts the task as unfinished until it returns.  The task
+ * will not be executed immediately, but must wait for the first available
+ * worker (or a thread waiting on the pool).
+ *
+ * @param group     the group of the task
+ * @param task      the task function to add to the thread pool
+ */
+void ThreadPool::addTask(TaskGroup& group, Task task) {
+    group._pending.fetch_add(1, std::memory_order_relaxed);
+    push(std::move(task), &group);
+}
+
+/**
+ * Adds a task to the thread pool once the given group is done.
+ *
+ * If the group is already done, the task is added immediately.  If the
+ * optional successor group is given, the task counts as unfinished in
+ * that group from this point on.  Hence tasks can be chained into a
+ * dependency graph, and waiting on the last group waits on the graph.
+ *
+ * @param group     the group to finish first
+ * @param task      the task function to add to the thread pool
+ * @param next      the group of the task (or nullptr)
+ */
+void ThreadPool::after(TaskGroup& group, Task task, TaskGroup* next) {
+    if (next != nullptr) {
+        next->_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lk(group._mutex);
+        if (group._pending.load(std::memory_order_acquire) > 0) {
+            group._successors.emplace_back(std::move(task),next);
+            return;
+        }
+    }
+    push(std::move(task), next);
+}
+
+/**
+ * Blocks until every task of the given group has finished.
+ *
+ * The calling thread executes tasks of this pool while it waits, so it
+ * is safe to call this method from inside a task.  Those tasks are not
+ * necessarily from the given group.  If the pool is stopped, the tasks
+ * that have not started are discarded, and count as finished.
+ *
+ * @param group     the group to wait on
+ */
+void ThreadPool::wait(TaskGroup& group) {
+    size_t index = getIndex();
+    while (!group.isDone()) {
+        if (runOne(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _sleeping++;
+        _taskCondition.wait(lk, [&] { return group.isDone() || _queued > 0; });
+        _sleeping--;
+    }
+
+    // The last task may still hold the lock of the group
+    std::lock_guard<std::mutex> lk(group._mutex);
 }
 
 /**
  * Stop the thread pool, marking it for shut down.
  *
- * A stopped thread pool is marked for shutdown, but it shutdown has not
- * necessarily completed.  Shutdown will be complete when the current child
- * threads have finished with their tasks.
+ * Any task that has not started is discarded, and counts as finished
+ * in its group.  So does any task added after the pool is stopped.  This
+ * method blocks until the current child threads have finished with their
+ * tasks.  Stopping a pool a second time has no effect.
  */
 void ThreadPool::stop() {
     {
-        std::unique_lock<std::mutex> lk(_queueMutex);
+        std::unique_lock<std::mutex> lk(_sleepMutex);
         _stop = true;
         _taskCondition.notify_all();
     }
-    
+
     for (auto&& worker : _workers) {
 #ifdef CU_SDL_THREADS
         int status;
@@ -182,4 +423,22 @@ void ThreadPool::stop() {
         worker.join();
 #endif
     }
+    _workers.clear();
+    _complete = 0;
+
+    // Discard the tasks that never started
+    for (auto it = _queues.begin(); it != _queues.end(); ++it) {
+        std::deque<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lk((*it)->mutex);
+            jobs.swap((*it)->jobs);
+            _queued -= (Uint32)jobs.size();
+        }
+        for (auto jt = jobs.begin(); jt != jobs.end(); ++jt) {
+            jt->task.reset();
+            if (jt->group != nullptr) {
+                finish(jt->group);
+            }
+        }
+    }
 }
@@ -0,0 +1,121 @@
+//
+//  main.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This is the asset compiler.  It compiles JSON asset directories into
+//  binary manifests (see AssetManifest), so that the asset manager does not
+//  have to parse JSON when the application starts. Each manifest is saved
+//  next to its JSON directory, with the extension ".cuam".
+//
+//  Usage:
+//
+//      assetc <asset root> <directory> [<directory> ...]
+//
+//  The directories are paths relative to the asset root, such as
+//  "json/assets.json".  All of the directories are compiled together, so
+//  a scene in one directory may use widgets declared in another.  Widget
+//  files are relative to the asset root as well.
+//
+//  This tool should be run whenever the JSON directories or widget files
+//  change.  Each manifest records the size and hash of every directory and
+//  widget file it was compiled from, so the asset manager ignores a stale
+//  manifest and reads the JSON instead.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/assets/CUAssetManifest.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace cugl;
+
+/**
+ * Returns the JSON value for the given file, or nullptr if it cannot be read.
+ *
+ * @param path  The path to the file
+ *
+ * @return the JSON value for the given file, or nullptr if it cannot be read.
+ */
+static std::shared_ptr<JsonValue> readJson(const std::string& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return JsonValue::allocWithJson(buffer.str());
+}
+
+/**
+ * Compiles the asset directories given on the command line.
+ *
+ * @param argc  The number of arguments
+ * @param argv  The arguments
+ *
+ * @return 0 if all directories were compiled successfully
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <asset root> <directory> [<directory> ...]" << std::endl;
+        return 1;
+    }
+
+    std::string root = argv[1];
+    if (!root.empty() && root.back() != '/' && root.back() != '\\') {
+        root.push_back('/');
+    }
+
+    std::vector<std::string> paths;
+    std::vector<std::shared_ptr<JsonValue>> directories;
+    for(int ii = 2; ii < argc; ii++) {
+        std::shared_ptr<JsonValue> json = readJson(root+argv[ii]);
+        if (json == nullptr) {
+            std::cerr << "Could not read the directory '" << argv[ii] << "'" << std::endl;
+            return 1;
+        }
+        paths.push_back(argv[ii]);
+        directories.push_back(json);
+    }
+
+    AssetManifest::Reader reader = [=](const std::string& path) {
+        return readJson(root+path);
+    };
+
+    int result = 0;
+    for(size_t ii = 0; ii < directories.size(); ii++) {
+        std::shared_ptr<AssetManifest> manifest = AssetManifest::alloc(directories[ii],directories,reader,root,paths);
+        std::string output = AssetManifest::getCompiledPath(root+paths[ii]);
+        if (manifest == nullptr) {
+            std::cerr << "Could not compile '" << paths[ii] << "'" << std::endl;
+            result = 1;
+        } else if (!manifest->save(output)) {
+            std::cerr << "Could not write '" << output << "'" << std::endl;
+            result = 1;
+        } else {
+            std::cout << output << ": " << manifest->getSceneCount() << " scenes, ";
+            std::cout << manifest->getData().size() << " bytes" << std::endl;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,159 @@
+//
+//  main.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This is the font baker.  It rasterizes the atlas of a TrueType font, and
+//  saves the atlas, the glyph metrics, and the kerning pairs as a single
+//  binary file (see Font::bake).  The font loader reads this file instead of
+//  rasterizing the font at startup.
+//
+//  Usage:
+//
+//      fontbake [options] <asset root> <font> <size> [<size> ...]
+//
+//  The font is a path relative to the asset root, such as
+//  "fonts/SairaSemicondensed.ttf".  The options are
+//
+//      --charset <chars>   The characters in the atlas (default ASCII)
+//      --sdf <spread>      Bake a distance field with the given spread
+//
+//  A font of size n is saved next to the font file with the extension
+//  ".n.font".  The font loader looks for this file first when it loads a
+//  font of that size.
+//
+//  A distance field is saved with the extension ".font", and the font loader
+//  uses it for any size that has no baked file of its own.  Only one size
+//  may be given in this mode, and it should be large (at least 48), as every
+//  other size is scaled from it.  The spread is the distance in atlas pixels
+//  at which the field is clamped; about a tenth of the size works well.
+//  Distance fields are rasterized without hinting.
+//
+//  This tool should be run whenever the font or its character set changes.
+//  Stale baked fonts are never detected at runtime.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/render/CUFont.h>
+#include <cugl/util/CUFiletools.h>
+#include <SDL/SDL_ttf.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace cugl;
+
+/**
+ * Returns true if the font could be baked at the given size.
+ *
+ * @param path      The path to the TrueType font
+ * @param output    The path to the baked font
+ * @param size      The font size in points
+ * @param charset   The atlas character set ("" for ASCII)
+ * @param spread    The distance field spread (0 for a coverage atlas)
+ *
+ * @return true if the font could be baked at the given size.
+ */
+static bool bake(const std::string& path, const std::string& output, int size,
+                 const std::string& charset, Uint32 spread) {
+    std::shared_ptr<Font> font = Font::alloc(path, size);
+    if (font == nullptr) {
+        std::cerr << "Could not read the font '" << path << "'. " << TTF_GetError() << std::endl;
+        return false;
+    }
+
+    // Hinting snaps to the baked pixel grid, which is wrong at other sizes
+    if (spread > 0) {
+        font->setHinting(Font::Hinting::NONE);
+    }
+    bool built = charset.empty() ? font->buildAtlasAsync() : font->buildAtlasAsync(charset);
+    if (!built || !font->bake(output, spread)) {
+        std::cerr << "Could not bake '" << output << "'" << std::endl;
+        return false;
+    }
+    std::cout << output << std::endl;
+    return true;
+}
+
+/**
+ * Bakes the fonts given on the command line.
+ *
+ * @param argc  The number of arguments
+ * @param argv  The arguments
+ *
+ * @return 0 on success, and 1 on failure
+ */
+int main(int argc, char** argv) {
+    Uint32 spread = 0;
+    std::string charset;
+    std::vector<std::string> paths;
+    for(int ii = 1; ii < argc; ii++) {
+        std::string arg = argv[ii];
+        if (arg == "--charset" && ii+1 < argc) {
+            charset = argv[++ii];
+        } else if (arg == "--sdf" && ii+1 < argc) {
+            spread = (Uint32)std::max(0,atoi(argv[++ii]));
+            if (spread == 0) {
+                std::cerr << "A distance field must have a positive spread" << std::endl;
+                return 1;
+            }
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.size() < 3 || (spread > 0 && paths.size() > 3)) {
+        std::cerr << "usage: " << argv[0] << " [--charset <chars>] [--sdf <spread>]";
+        std::cerr << " <asset root> <font> <size> [<size> ...]" << std::endl;
+        std::cerr << "A distance field (--sdf) is baked at exactly one size." << std::endl;
+        return 1;
+    }
+
+    std::string root = paths[0];
+    if (!root.empty() && root.back() != '/' && root.back() != '\\') {
+        root.push_back('/');
+    }
+
+    if (TTF_Init() != 0) {
+        std::cerr << "Could not initialize SDL_ttf. " << TTF_GetError() << std::endl;
+        return 1;
+    }
+
+    int result = 0;
+    std::string path = root+paths[1];
+    for(size_t ii = 2; ii < paths.size(); ii++) {
+        int size = atoi(paths[ii].c_str());
+        if (size <= 0) {
+            std::cerr << "Font size '" << paths[ii] << "' must be positive" << std::endl;
+            result = 1;
+            continue;
+        }
+        std::string suffix = (spread > 0 ? "font" : std::to_string(size)+".font");
+        if (!bake(path, filetool::set_suffix(path,suffix), size, charset, spread)) {
+            result = 1;
+        }
+    }
+
+    TTF_Quit();
+    return result;
+}
@@ -0,0 +1,564 @@
+//
+//  main.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This is the texture cooker.  It encodes images as ETC2 compressed data in
+//  KTX containers (see CompressedImage), so that the texture loader can upload
+//  them directly instead of decoding a PNG file.  Each KTX file is saved next
+//  to its image, with the same name and the extension ".ktx".  The texture
+//  loader finds these files on its own, and falls back to the image if the
+//  GPU does not support ETC2.
+//
+//  Usage:
+//
+//      texcook [options] <asset root> <image> [<image> ...]
+//
+//  The images are paths relative to the asset root, such as
+//  "textures/fog_standalone.png".  The options are
+//
+//      --rgb               Drop the alpha channel (half the size)
+//      --mipmaps           Encode the full mip chain
+//      --atlas <name>      Pack the images into a single atlas
+//      --padding <pixels>  The padding between atlas images (default 2)
+//      --variant <scale>   Also produce a reduced variant (e.g. 0.5)
+//      --filmstrip <cols> <span>   Convert a sprite sheet into a filmstrip
+//      --keyframes <frames>        The filmstrip key frame interval (default 30)
+//      --tolerance <value>         The filmstrip per-channel tolerance (default 0)
+//
+//  An atlas is saved as <name>.png, <name>.ktx and <name>.json, relative to
+//  the asset root.  The JSON file contains a texture entry whose "atlas"
+//  attribute names each image (by its file name without the extension), so
+//  it can be pasted into an asset directory.  The padding around each image
+//  repeats the image border, so that filtering does not bleed into the
+//  neighboring images.
+//
+//  A variant of scale s is saved next to its image as <name>@<s>x.png (and
+//  the matching KTX file).  The texture loader chooses between variants by
+//  display size if they are listed in the "variants" attribute of the
+//  texture entry.  The atlas JSON file lists them automatically.  Variants
+//  should scale the image evenly, or the atlas regions will be misaligned.
+//
+//  A filmstrip (see Filmstrip) is saved next to its sprite sheet with the
+//  extension ".film".  The sprite sheet is split into frames exactly like an
+//  AnimationNode with the given columns and span, and the frames are encoded
+//  as deltas.  A StreamedAnimationNode plays the result without keeping the
+//  sprite sheet in memory.  No KTX file is produced in this mode.
+//
+//  This tool should be run whenever the source images change.  Stale KTX
+//  files are never detected at runtime.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Version: 10/18/26
+//
+#include <cugl/render/CUCompressedImage.h>
+#include <cugl/render/CUFilmstrip.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <cugl/util/CUFiletools.h>
+#include <SDL/SDL_image.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+using namespace cugl;
+
+/** The largest atlas this tool will produce */
+#define MAX_ATLAS_SIZE  4096
+
+/**
+ * An RGBA image, and its position in an atlas
+ */
+typedef struct {
+    /** The image name (the file name without the extension) */
+    std::string name;
+    /** The image width in pixels */
+    Uint32 width;
+    /** The image height in pixels */
+    Uint32 height;
+    /** The RGBA pixels, row by row */
+    std::vector<Uint8> pixels;
+    /** The left edge in the atlas */
+    Uint32 x;
+    /** The top edge in the atlas */
+    Uint32 y;
+} Image;
+
+/**
+ * Returns the smallest power of two no smaller than value
+ *
+ * @param value The value to round
+ *
+ * @return the smallest power of two no smaller than value
+ */
+static Uint32 next_pot(Uint32 value) {
+    Uint32 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/**
+ * Returns true if the image file could be read as RGBA pixels.
+ *
+ * @param path  The path to the image file
+ * @param image The image to store the pixels
+ *
+ * @return true if the image file could be read as RGBA pixels.
+ */
+static bool readImage(const std::string& path, Image& image) {
+    SDL_Surface* surface = IMG_Load(path.c_str());
+    if (surface == nullptr) {
+        return false;
+    }
+    SDL_Surface* normal = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(surface);
+    if (normal == nullptr) {
+        return false;
+    }
+
+    image.name   = filetool::base_prefix(path);
+    image.width  = normal->w;
+    image.height = normal->h;
+    image.pixels.resize(4*(size_t)image.width*image.height);
+    SDL_LockSurface(normal);
+    for(Uint32 row = 0; row < image.height; row++) {
+        std::memcpy(image.pixels.data()+4*(size_t)row*image.width,
+                    (Uint8*)normal->pixels+(size_t)row*normal->pitch, 4*(size_t)image.width);
+    }
+    SDL_UnlockSurface(normal);
+    SDL_FreeSurface(normal);
+    return true;
+}
+
+/**
+ * Returns true if the pixels could be saved as a PNG file.
+ *
+ * @param path      The path to the PNG file
+ * @param pixels    The RGBA pixels, row by row
+ * @param width     The image width
+ * @param height    The image height
+ *
+ * @return true if the pixels could be saved as a PNG file.
+ */
+static bool writeImage(const std::string& path, std::vector<Uint8>& pixels, Uint32 width, Uint32 height) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), width, height, 32,
+                                                              4*width, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr) {
+        return false;
+    }
+    bool success = IMG_SavePNG(surface, path.c_str()) == 0;
+    SDL_FreeSurface(surface);
+    return success;
+}
+
+/**
+ * Returns a copy of the pixels resized by the given scale.
+ *
+ * Each pixel of the result is the average of the pixels that it covers,
+ * so this function is only suitable for reducing an image.
+ *
+ * @param pixels    The RGBA pixels, row by row
+ * @param width     The image width (replaced by the new width)
+ * @param height    The image height (replaced by the new height)
+ * @param scale     The scale factor (no more than 1)
+ *
+ * @return a copy of the pixels resized by the given scale.
+ */
+static std::vector<Uint8> resize(const std::vector<Uint8>& pixels, Uint32& width, Uint32& height, float scale) {
+    Uint32 w = std::max(1u,(Uint32)lroundf(width*scale));
+    Uint32 h = std::max(1u,(Uint32)lroundf(height*scale));
+    if (fabsf(width*scale-w) > 0.01f || fabsf(height*scale-h) > 0.01f) {
+        std::cerr << "Warning: " << width << "x" << height << " does not scale evenly by " << scale << std::endl;
+    }
+
+    std::vector<Uint8> result(4*(size_t)w*h);
+    for(Uint32 y = 0; y < h; y++) {
+        Uint32 y0 = y*height/h;
+        Uint32 y1 = std::max(y0+1,(y+1)*height/h);
+        for(Uint32 x = 0; x < w; x++) {
+            Uint32 x0 = x*width/w;
+            Uint32 x1 = std::max(x0+1,(x+1)*width/w);
+            Uint32 area = (x1-x0)*(y1-y0);
+            for(int cc = 0; cc < 4; cc++) {
+                Uint32 sum = 0;
+                for(Uint32 yy = y0; yy < y1; yy++) {
+                    for(Uint32 xx = x0; xx < x1; xx++) {
+                        sum += pixels[4*((size_t)yy*width+xx)+cc];
+                    }
+                }
+                result[4*((size_t)y*w+x)+cc] = (Uint8)((sum+area/2)/area);
+            }
+        }
+    }
+    width  = w;
+    height = h;
+    return result;
+}
+
+/**
+ * Returns the path of the variant of the given image.
+ *
+ * @param path  The path to the full resolution image
+ * @param scale The variant scale
+ *
+ * @return the path of the variant of the given image.
+ */
+static std::string variant_path(const std::string& path, const std::string& scale) {
+    std::string suffix = filetool::base_suffix(path);
+    std::string result = path.substr(0,path.size()-suffix.size()-(suffix.empty() ? 0 : 1));
+    result.append("@"+scale+"x");
+    return suffix.empty() ? result : result+"."+suffix;
+}
+
+/**
+ * Returns the area of the atlas of the given width, or 0 if it does not fit.
+ *
+ * This function packs the images in shelves (rows), in order.  The images
+ * should be sorted by decreasing height, so that the shelves are tight.
+ * The position of each image is stored in the image.
+ *
+ * @param images    The images to pack
+ * @param padding   The padding around each image
+ * @param width     The atlas width
+ * @param height    Stores the atlas height
+ *
+ * @return the area of the atlas of the given width, or 0 if it does not fit.
+ */
+static size_t pack(std::vector<Image>& images, Uint32 padding, Uint32 width, Uint32& height) {
+    Uint32 x = 0;
+    Uint32 y = 0;
+    Uint32 shelf = 0;
+    for(auto it = images.begin(); it != images.end(); ++it) {
+        Uint32 w = it->width+2*padding;
+        Uint32 h = it->height+2*padding;
+        if (w > width) {
+            return 0;
+        } else if (x+w > width) {
+            y += shelf;
+            x = 0;
+            shelf = 0;
+        }
+        it->x = x+padding;
+        it->y = y+padding;
+        x += w;
+        shelf = std::max(shelf,h);
+    }
+    height = next_pot(y+shelf);
+    return height > MAX_ATLAS_SIZE ? 0 : (size_t)width*height;
+}
+
+/**
+ * Copies the image into the atlas, extruding its border into the padding.
+ *
+ * @param image     The image to copy
+ * @param padding   The padding around the image
+ * @param atlas     The atlas pixels
+ * @param width     The atlas width
+ */
+static void blit(const Image& image, Uint32 padding, std::vector<Uint8>& atlas, Uint32 width) {
+    Sint64 left = (Sint64)image.x-padding;
+    Sint64 top  = (Sint64)image.y-padding;
+    for(Uint32 row = 0; row < image.height+2*padding; row++) {
+        Sint64 sy = std::min(std::max((Sint64)row-(Sint64)padding,(Sint64)0),(Sint64)image.height-1);
+        for(Uint32 col = 0; col < image.width+2*padding; col++) {
+            Sint64 sx = std::min(std::max((Sint64)col-(Sint64)padding,(Sint64)0),(Sint64)image.width-1);
+            const Uint8* src = image.pixels.data()+4*(sy*image.width+sx);
+            Uint8* dst = atlas.data()+4*((top+row)*width+(left+col));
+            std::memcpy(dst, src, 4);
+        }
+    }
+}
+
+/**
+ * Returns true if the pixels could be encoded and saved as a KTX file.
+ *
+ * @param path      The path to the KTX file
+ * @param pixels    The RGBA pixels, row by row
+ * @param width     The image width
+ * @param height    The image height
+ * @param alpha     Whether to keep the alpha channel
+ * @param mipmaps   Whether to encode the mip chain
+ *
+ * @return true if the pixels could be encoded and saved as a KTX file.
+ */
+static bool cook(const std::string& path, const std::vector<Uint8>& pixels, Uint32 width, Uint32 height,
+                 bool alpha, bool mipmaps) {
+    CompressedImage::Format format = alpha ? CompressedImage::Format::ETC2_RGBA : CompressedImage::Format::ETC2_RGB;
+    std::shared_ptr<CompressedImage> image = CompressedImage::allocWithPixels(pixels.data(), width, height,
+                                                                              format, mipmaps);
+    if (image == nullptr || !image->save(path)) {
+        std::cerr << "Could not write '" << path << "'" << std::endl;
+        return false;
+    }
+    std::cout << path << ": " << width << "x" << height << ", " << image->getLevelCount() << " levels, ";
+    std::cout << image->getByteSize() << " bytes" << std::endl;
+    return true;
+}
+
+/**
+ * Returns true if the sprite sheet could be encoded and saved as a filmstrip.
+ *
+ * The frames are laid out row by row, starting at the top left corner, as
+ * in an AnimationNode.  The number of rows is the smallest that can hold
+ * span frames.
+ *
+ * @param path      The path to the filmstrip file
+ * @param image     The sprite sheet
+ * @param cols      The number of columns in the sprite sheet
+ * @param span      The number of frames in the sprite sheet
+ * @param alpha     Whether to keep the alpha channel
+ * @param interval  The number of frames between key frames
+ * @param tolerance The largest per-channel difference to ignore
+ *
+ * @return true if the sprite sheet could be encoded and saved as a filmstrip.
+ */
+static bool film(const std::string& path, const Image& image, Uint32 cols, Uint32 span,
+                 bool alpha, Uint32 interval, Uint8 tolerance) {
+    Uint32 rows = (span+cols-1)/cols;
+    Uint32 width  = image.width/cols;
+    Uint32 height = image.height/rows;
+    if (width*cols != image.width || height*rows != image.height) {
+        std::cerr << "Warning: " << image.width << "x" << image.height << " does not divide evenly into ";
+        std::cerr << rows << "x" << cols << " frames" << std::endl;
+    }
+
+    std::shared_ptr<Filmstrip> strip = Filmstrip::alloc(width, height, alpha, interval, tolerance);
+    if (strip == nullptr) {
+        std::cerr << "Could not create a filmstrip for '" << path << "'" << std::endl;
+        return false;
+    }
+
+    std::vector<Uint8> frame(4*(size_t)width*height);
+    for(Uint32 ii = 0; ii < span; ii++) {
+        Uint32 left = (ii % cols)*width;
+        Uint32 top  = (ii / cols)*height;
+        for(Uint32 row = 0; row < height; row++) {
+            std::memcpy(frame.data()+4*(size_t)row*width,
+                        image.pixels.data()+4*((size_t)(top+row)*image.width+left), 4*(size_t)width);
+        }
+        strip->append(frame.data());
+    }
+
+    if (!strip->save(path)) {
+        std::cerr << "Could not write '" << path << "'" << std::endl;
+        return false;
+    }
+    std::cout << path << ": " << span << " frames of " << width << "x" << height << ", ";
+    std::cout << strip->getByteSize() << " bytes (" << strip->getFrameSize()*span << " decoded)" << std::endl;
+    return true;
+}
+
+/**
+ * Cooks the images given on the command line.
+ *
+ * @param argc  The number of arguments
+ * @param argv  The arguments
+ *
+ * @return 0 if all images were cooked successfully
+ */
+int main(int argc, char** argv) {
+    bool alpha = true;
+    bool mipmaps = false;
+    Uint32 padding = 2;
+    Uint32 cols = 0;
+    Uint32 span = 0;
+    Uint32 interval = 30;
+    Uint8 tolerance = 0;
+    std::string atlas;
+    std::vector<std::string> variants;
+    std::vector<std::string> paths;
+    for(int ii = 1; ii < argc; ii++) {
+        std::string arg = argv[ii];
+        if (arg == "--rgb") {
+            alpha = false;
+        } else if (arg == "--mipmaps") {
+            mipmaps = true;
+        } else if (arg == "--atlas" && ii+1 < argc) {
+            atlas = argv[++ii];
+        } else if (arg == "--padding" && ii+1 < argc) {
+            padding = (Uint32)std::max(0,atoi(argv[++ii]));
+        } else if (arg == "--variant" && ii+1 < argc) {
+            float scale = (float)atof(argv[++ii]);
+            if (scale <= 0 || scale >= 1) {
+                std::cerr << "Variant scale '" << argv[ii] << "' must be between 0 and 1" << std::endl;
+                return 1;
+            }
+            std::stringstream ss;
+            ss << scale;
+            variants.push_back(ss.str());
+        } else if (arg == "--filmstrip" && ii+2 < argc) {
+            cols = (Uint32)std::max(0,atoi(argv[++ii]));
+            span = (Uint32)std::max(0,atoi(argv[++ii]));
+            if (cols == 0 || span == 0) {
+                std::cerr << "A filmstrip must have at least one column and one frame" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--keyframes" && ii+1 < argc) {
+            interval = (Uint32)std::max(0,atoi(argv[++ii]));
+        } else if (arg == "--tolerance" && ii+1 < argc) {
+            tolerance = (Uint8)std::min(255,std::max(0,atoi(argv[++ii])));
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.size() < 2) {
+        std::cerr << "usage: " << argv[0] << " [--rgb] [--mipmaps] [--atlas <name>] [--padding <pixels>]";
+        std::cerr << " [--variant <scale>] [--filmstrip <cols> <span>] [--keyframes <frames>]";
+        std::cerr << " [--tolerance <value>]";
+        std::cerr << " <asset root> <image> [<image> ...]" << std::endl;
+        return 1;
+    }
+
+    std::string root = paths[0];
+    if (!root.empty() && root.back() != '/' && root.back() != '\\') {
+        root.push_back('/');
+    }
+
+    std::vector<Image> images;
+    for(size_t ii = 1; ii < paths.size(); ii++) {
+        Image image;
+        if (!readImage(root+paths[ii], image)) {
+            std::cerr << "Could not read the image '" << paths[ii] << "'. " << IMG_GetError() << std::endl;
+            return 1;
+        }
+        images.push_back(std::move(image));
+    }
+
+    if (span > 0) {
+        int result = 0;
+        for(size_t ii = 0; ii < images.size(); ii++) {
+            std::string output = filetool::set_suffix(root+paths[ii+1],"film");
+            if (!film(output, images[ii], cols, span, alpha, interval, tolerance)) {
+                result = 1;
+            }
+        }
+        return result;
+    }
+
+    if (atlas.empty()) {
+        int result = 0;
+        for(size_t ii = 0; ii < images.size(); ii++) {
+            std::string output = filetool::set_suffix(root+paths[ii+1],"ktx");
+            if (!cook(output, images[ii].pixels, images[ii].width, images[ii].height, alpha, mipmaps)) {
+                result = 1;
+            }
+            for(auto it = variants.begin(); it != variants.end(); ++it) {
+                Uint32 w = images[ii].width;
+                Uint32 h = images[ii].height;
+                std::vector<Uint8> reduced = resize(images[ii].pixels, w, h, (float)atof(it->c_str()));
+                std::string path = variant_path(root+paths[ii+1], *it);
+                if (!writeImage(path, reduced, w, h)) {
+                    std::cerr << "Could not write '" << path << "'. " << IMG_GetError() << std::endl;
+                    result = 1;
+                } else if (!cook(filetool::set_suffix(path,"ktx"), reduced, w, h, alpha, mipmaps)) {
+                    result = 1;
+                }
+            }
+        }
+        return result;
+    }
+
+    // Pack into the smallest power-of-two atlas
+    std::stable_sort(images.begin(), images.end(), [](const Image& a, const Image& b) {
+        return a.height > b.height;
+    });
+    Uint32 widest = 0;
+    for(auto it = images.begin(); it != images.end(); ++it) {
+        widest = std::max(widest,it->width+2*padding);
+    }
+
+    Uint32 width  = 0;
+    Uint32 height = 0;
+    size_t best = 0;
+    for(Uint32 w = next_pot(widest); w <= MAX_ATLAS_SIZE; w <<= 1) {
+        Uint32 h;
+        size_t area = pack(images, padding, w, h);
+        if (area > 0 && (best == 0 || area < best || (area == best && w < h))) {
+            best = area;
+            width  = w;
+            height = h;
+        }
+    }
+    if (best == 0) {
+        std::cerr << "The images do not fit in a " << MAX_ATLAS_SIZE << "x" << MAX_ATLAS_SIZE;
+        std::cerr << " atlas" << std::endl;
+        return 1;
+    }
+    pack(images, padding, width, height);
+
+    std::vector<Uint8> pixels(4*(size_t)width*height, 0);
+    std::shared_ptr<JsonValue> rects = JsonValue::allocObject();
+    for(auto it = images.begin(); it != images.end(); ++it) {
+        blit(*it, padding, pixels, width);
+        std::shared_ptr<JsonValue> rect = JsonValue::allocArray();
+        rect->appendValue((long)it->x);
+        rect->appendValue((long)it->y);
+        rect->appendValue((long)(it->x+it->width));
+        rect->appendValue((long)(it->y+it->height));
+        rects->appendChild(it->name, rect);
+    }
+
+    std::string image = atlas+".png";
+    if (!writeImage(root+image, pixels, width, height)) {
+        std::cerr << "Could not write '" << root+image << "'. " << IMG_GetError() << std::endl;
+        return 1;
+    } else if (!cook(root+atlas+".ktx", pixels, width, height, alpha, mipmaps)) {
+        return 1;
+    }
+
+    std::shared_ptr<JsonValue> scales = JsonValue::allocObject();
+    for(auto it = variants.begin(); it != variants.end(); ++it) {
+        Uint32 w = width;
+        Uint32 h = height;
+        std::vector<Uint8> reduced = resize(pixels, w, h, (float)atof(it->c_str()));
+        std::string path = variant_path(image, *it);
+        if (!writeImage(root+path, reduced, w, h)) {
+            std::cerr << "Could not write '" << root+path << "'. " << IMG_GetError() << std::endl;
+            return 1;
+        } else if (!cook(filetool::set_suffix(root+path,"ktx"), reduced, w, h, alpha, mipmaps)) {
+            return 1;
+        }
+        scales->appendValue(*it, path);
+    }
+
+    std::shared_ptr<JsonValue> entry = JsonValue::allocObject();
+    entry->appendValue("file", image);
+    entry->appendValue("mipmaps", mipmaps);
+    entry->appendChild("atlas", rects);
+    if (!variants.empty()) {
+        entry->appendChild("variants", scales);
+    }
+    std::shared_ptr<JsonValue> json = JsonValue::allocObject();
+    json->appendChild(filetool::base_prefix(atlas), entry);
+
+    std::ofstream file(root+atlas+".json", std::ios::out | std::ios::binary);
+    if (!file) {
+        std::cerr << "Could not write '" << root+atlas << ".json'" << std::endl;
+        return 1;
+    }
+    file << json->toString(true) << std::endl;
+    std::cout << root+atlas << ".json: " << images.size() << " images" << std::endl;
+    return 0;
+}
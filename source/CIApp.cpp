@@ -16,6 +16,11 @@ using namespace cugl;
 
 static std::shared_ptr<OrthographicCamera> cam = nullptr;
 
+/** The longest that suspension waits for the settings to save (in milliseconds) */
+#define SUSPEND_FLUSH_TIME 200
+/** The time to spend building scene graphs and scenes each frame (in microseconds) */
+#define SCENE_BUILD_BUDGET 4000
+
 #pragma mark -
 #pragma mark Gameplay Control
 
@@ -34,8 +39,17 @@ void CoreImpactApp::onStartup() {
     _batch  = SpriteBatch::alloc();
     cam = OrthographicCamera::alloc(getDisplaySize());
     
+    // Draw at the display refresh rate, but simulate at a fixed tick rate
+    int refresh = Display::get()->getRefreshRate();
+    if (refresh > 0) {
+        setFPS((float)refresh);
+    }
+    setFixedStep(1000000/CONSTANTS::TICKS_PER_SECOND);
+    setDeterministic(true);
+    
     _playerSettings = PlayerSettings::alloc();
     _gameSettings = GameSettings::alloc();
+    _settingsWriter = SaveWriter::alloc(Application::getSaveDirectory().append("playersettings.json"));
     
     // Start-up basic input
 #ifdef CU_MOBILE
@@ -48,10 +62,16 @@ void CoreImpactApp::onStartup() {
     Input::activate<TextInput>();
     
     _assets->attach<Font>(FontLoader::alloc()->getHook());
-    _assets->attach<Texture>(TextureLoader::alloc()->getHook());
+    // Full resolution textures are drawn for the locked scene width
+    std::shared_ptr<TextureLoader> textures = TextureLoader::alloc();
+    textures->setReferenceWidth(CONSTANTS::SCENE_WIDTH);
+    _assets->attach<Texture>(textures->getHook());
     _assets->attach<Sound>(SoundLoader::alloc()->getHook());
     _assets->attach<WidgetValue>(WidgetLoader::alloc()->getHook());
-    _assets->attach<scene2::SceneNode>(Scene2Loader::alloc()->getHook());
+    // Scenes are built on the main thread, a slice per frame behind the loading bar
+    std::shared_ptr<Scene2Loader> scenes = Scene2Loader::alloc();
+    scenes->setBuildBudget(SCENE_BUILD_BUDGET);
+    _assets->attach<scene2::SceneNode>(scenes->getHook());
 
     // Create a "loading" screen
     _loaded = false;
@@ -79,14 +99,11 @@ void CoreImpactApp::onStartup() {
  * causing the application to be deleted.
  */
 void CoreImpactApp::onShutdown() {
-    // save settings file
-    std::shared_ptr<cugl::JsonWriter> _writer = JsonWriter::alloc(Application::getSaveDirectory().append("playersettings.json"));
-    std::shared_ptr<cugl::JsonValue> _settings = JsonValue::allocObject();
-    _playerSettings->appendSettings(_settings);
-    _writer->writeJson(_settings);
+    // save settings file, waiting for the write to finish
+    saveSettings();
+    _settingsWriter->dispose();
+    _settingsWriter = nullptr;
 
-    CULog("Saving current player settings.");
-    
     if (_loading.isActive())
         _loading.dispose();
     if (_menu.isActive())
@@ -116,83 +133,96 @@ void CoreImpactApp::onShutdown() {
 
 /**
  * The method called when application is running out of memory.
+ *
+ * Rather than quitting, this evicts every asset that is not referenced by
+ * an active scene.  Evicted assets are reloaded when next requested.
  */
 void CoreImpactApp::onLowMemory() {
-    CULog("Low Memory. Quitting the application.");
-    AudioEngine::stop();
-    Application::quit();
+    if (_assets == nullptr) {
+        return;
+    }
+    // Release everything the active scene is not using; it reloads on demand
+    size_t freed = _assets->trim(0);
+    CULog("Low Memory. Evicted %zu KB of assets, %zu KB still resident.",
+          freed/1024, _assets->getFootprint()/1024);
 }
 
 /**
- * The method called to update the application data.
+ * The method called to prepare the application data for simulation.
  *
- * This is your core loop and should be replaced with your custom implementation.
- * This method should contain any code that is not an OpenGL call.
- *
- * When overriding this method, you do not need to call the parent method
- * at all. The default implmentation does nothing.
+ * This method is called once per frame, before any simulation ticks.  It
+ * handles loading, the menus, and the transitions between scenes, which
+ * all run at the frame rate.
  *
  * @param timestep  The amount of time (in seconds) since the last frame
  */
-void CoreImpactApp::update(float timestep) {
+void CoreImpactApp::preUpdate(float timestep) {
     if (!_loaded && _loading.isActive()) {
         _loading.update(0.01f);
     }
     else if (!_loaded) {
-        /** Transition to menu scene */
-        _loading.dispose();
-        
-        // Load in saved settings file
-        std::shared_ptr<cugl::JsonReader> _reader = JsonReader::alloc(Application::getSaveDirectory().append("playersettings.json"));
-        // prepare both settings 
-        std::shared_ptr<cugl::JsonValue> prevPlayerSettings = JsonValue::allocObject();
-        if (_reader == nullptr) {
-            // save file not found 
-            _playerSettings->setIsNew(true);
-        }
-        else {
-            _playerSettings->setIsNew(false);
-            if (_reader->ready()) {
-                prevPlayerSettings = _reader->readJson();
+        /** Transition to menu scene, building the menu a slice per frame */
+        if (!_menu.isActive()) {
+            _loading.dispose();
+            
+            // Load in saved settings file (after any save from a game reset)
+            _settingsWriter->flush();
+            std::shared_ptr<cugl::JsonReader> _reader = JsonReader::alloc(Application::getSaveDirectory().append("playersettings.json"));
+            // prepare both settings 
+            std::shared_ptr<cugl::JsonValue> prevPlayerSettings = JsonValue::allocObject();
+            if (_reader == nullptr) {
+                // save file not found 
+                _playerSettings->setIsNew(true);
+            }
+            else {
+                _playerSettings->setIsNew(false);
+                if (_reader->ready()) {
+                    prevPlayerSettings = _reader->readJson();
+                }
+                _playerSettings->setPlayerSettings(prevPlayerSettings); // does this reset playerSettings
             }
-            _playerSettings->setPlayerSettings(prevPlayerSettings); // does this reset playerSettings
+            _gameSettings->reset();
+            
+            // Network manager
+            if (_networkMessageManager == nullptr) {
+                _networkMessageManager = NetworkMessageManager::alloc(_gameSettings);
+            }
+            
+            _menu.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
         }
-        _gameSettings->reset();
-        
-        // Network manager
-        if (_networkMessageManager == nullptr) {
-            _networkMessageManager = NetworkMessageManager::alloc(_gameSettings);
+        if (_menu.build(SCENE_BUILD_BUDGET)) {
+            _loaded = true;
         }
-        
-        _menu.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
-        _loaded = true;
     }
     else if (!_startGame && _menu.isActive()) {
         /** Handle menu scene updates */
         _menu.update(timestep);
     }
     else if (!_startGame && (_menu.getState() == MenuState::LobbyToGame)) {
-        /** Transition from menu to game scene */
-        _menu.dispose(); // Disables the input listeners to this mode
-        _gameplay.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
-        _startGame = true;
+        /** Transition from menu to game scene, building the game a slice per frame */
+        if (!_gameplay.isActive()) {
+            _gameplay.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
+        }
+        if (_gameplay.build(SCENE_BUILD_BUDGET)) {
+            _menu.dispose(); // Disables the input listeners to this mode
+            _startGame = true;
+        }
     }
     else if (!_startGame && (_menu.getState() == MenuState::MainToTutorial)) {
-        /** Transition from menu to game scene */
-        _menu.dispose(); // Disables the input listeners to this mode
-        if (_networkMessageManager == nullptr) {
-            _networkMessageManager = NetworkMessageManager::alloc(_gameSettings);
+        /** Transition from menu to tutorial scene, building the tutorial a slice per frame */
+        if (!_tutorial.isActive()) {
+            if (_networkMessageManager == nullptr) {
+                _networkMessageManager = NetworkMessageManager::alloc(_gameSettings);
+            }
+            _tutorial.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
+        }
+        if (_tutorial.build(SCENE_BUILD_BUDGET)) {
+            _menu.dispose(); // Disables the input listeners to this mode
+            _startGame = true;
         }
-        _tutorial.init(_assets, _networkMessageManager, _gameSettings, _playerSettings);
-        _startGame = true;
-    }
-    else if (_gameplay.isActive()) {
-        /** Handle game play updates */
-        _gameplay.update(timestep, _playerSettings);
     }
-    else if (_tutorial.isActive()) {
-        /** Handle tutorial updates */
-        _tutorial.update(timestep, _playerSettings);
+    else if (_gameplay.isActive() || _tutorial.isActive()) {
+        /** Game play and tutorial updates are simulation ticks (fixedUpdate) */
     }
     else {
         // handle game reset
@@ -211,12 +241,52 @@ void CoreImpactApp::update(float timestep) {
         _startGame = false;
 
         // save settings file
-        std::shared_ptr<cugl::JsonWriter> _writer = JsonWriter::alloc(Application::getSaveDirectory().append("playersettings.json"));
+        saveSettings();
+    }
+}
+
+/**
+ * The method called to advance the game by a single simulation tick.
+ *
+ * This method is called {@link CONSTANTS::TICKS_PER_SECOND} times per
+ * second, no matter the frame rate.  It updates the active game or
+ * tutorial, so all gameplay timers are counted in ticks.
+ */
+void CoreImpactApp::fixedUpdate() {
+    if (!_loaded || !_startGame) {
+        return;
+    }
+    
+    if (_gameplay.isActive()) {
+        /** Handle game play updates */
+        _gameplay.update(CONSTANTS::TICK_SECONDS, _playerSettings);
+    }
+    else if (_tutorial.isActive()) {
+        /** Handle tutorial updates */
+        _tutorial.update(CONSTANTS::TICK_SECONDS, _playerSettings);
+    }
+}
 
-        std::shared_ptr<cugl::JsonValue> _settings = JsonValue::allocObject();
-        _playerSettings->appendSettings(_settings);
-        _writer->writeJson(_settings);
-        CULog("Saving current player settings.");
+/**
+ * The method called to finish the application data for drawing.
+ *
+ * This method is called once per frame, after all simulation ticks.  It
+ * interpolates the active game or tutorial for drawing part of the way
+ * to the next tick.
+ *
+ * @param timestep  The amount of time (in seconds) since the last frame
+ */
+void CoreImpactApp::postUpdate(float timestep) {
+    if (!_loaded || !_startGame) {
+        return;
+    }
+    
+    float alpha = (float)getFixedRemainder()/getFixedStep();
+    if (_gameplay.isActive()) {
+        _gameplay.interpolate(alpha);
+    }
+    else if (_tutorial.isActive()) {
+        _tutorial.interpolate(alpha);
     }
 }
 
@@ -232,13 +302,12 @@ void CoreImpactApp::update(float timestep) {
  * the background.
  */
 void CoreImpactApp::onSuspend() {
-    // save settings file
-    std::shared_ptr<cugl::JsonWriter> _writer = JsonWriter::alloc(Application::getSaveDirectory().append("playersettings.json"));
-    std::shared_ptr<cugl::JsonValue> _settings = JsonValue::allocObject();
-    _playerSettings->appendSettings(_settings);
-    _writer->writeJson(_settings);
-    CULog("Saving current player settings.");
-    
+    // save settings file, but never hold up the suspension for long
+    saveSettings();
+    if (!_settingsWriter->flush(SUSPEND_FLUSH_TIME)) {
+        CULogError("Player settings are still saving.");
+    }
+
     AudioEngine::get()->pause();
 }
 
@@ -256,6 +325,19 @@ void CoreImpactApp::onResume() {
     AudioEngine::get()->resume();
 }
 
+/**
+ * Saves the current player settings in the background.
+ *
+ * The settings are captured immediately, but are written to disk on the
+ * settings writer thread.  Saves in quick succession are merged.
+ */
+void CoreImpactApp::saveSettings() {
+    std::shared_ptr<cugl::JsonValue> settings = JsonValue::allocObject();
+    _playerSettings->appendSettings(settings);
+    _settingsWriter->save(settings);
+    CULog("Saving current player settings.");
+}
+
 /**
  * The method called to draw the application to the screen.
  *
@@ -266,9 +348,10 @@ void CoreImpactApp::onResume() {
  * at all. The default implmentation does nothing.
  */
 void CoreImpactApp::draw() {
-    if (!_loaded) {
+    if (!_loaded && _loading.isActive()) {
         _loading.render(_batch);
     } else if (!_startGame) {
+        /** The menu is drawn as it is built (only the backdrop is visible) */
         _menu.render(_batch);
     } else if (_gameplay.isActive()) {
         /** Handle game play drawing */
@@ -38,6 +38,8 @@ protected:
     std::shared_ptr<PlayerSettings> _playerSettings;
     /** The game settings for the current game */
     std::shared_ptr<GameSettings> _gameSettings;
+    /** The background writer for the player settings file */
+    std::shared_ptr<cugl::SaveWriter> _settingsWriter;
 
     // Player modes
     /** The primary controller for the game world */
@@ -115,6 +117,9 @@ public:
     
     /**
      * The method called when application is running out of memory.
+     *
+     * Rather than quitting, this evicts every asset that is not referenced by
+     * an active scene.  Evicted assets are reloaded when next requested.
      */
     virtual void onLowMemory() override;
 
@@ -131,17 +136,35 @@ public:
     virtual void onResume() override;
     
     /**
-     * The method called to update the application data.
+     * The method called to prepare the application data for simulation.
      *
-     * This is your core loop and should be replaced with your custom implementation.
-     * This method should contain any code that is not an OpenGL call.
+     * This method is called once per frame, before any simulation ticks.  It
+     * handles loading, the menus, and the transitions between scenes, which
+     * all run at the frame rate.
      *
-     * When overriding this method, you do not need to call the parent method
-     * at all. The default implmentation does nothing.
+     * @param timestep  The amount of time (in seconds) since the last frame
+     */
+    virtual void preUpdate(float timestep) override;
+    
+    /**
+     * The method called to advance the game by a single simulation tick.
+     *
+     * This method is called {@link CONSTANTS::TICKS_PER_SECOND} times per
+     * second, no matter the frame rate.  It updates the active game or
+     * tutorial, so all gameplay timers are counted in ticks.
+     */
+    virtual void fixedUpdate() override;
+    
+    /**
+     * The method called to finish the application data for drawing.
+     *
+     * This method is called once per frame, after all simulation ticks.  It
+     * interpolates the active game or tutorial for drawing part of the way
+     * to the next tick.
      *
      * @param timestep  The amount of time (in seconds) since the last frame
      */
-    virtual void update(float timestep) override;
+    virtual void postUpdate(float timestep) override;
     
     /**
      * The method called to draw the application to the screen.
@@ -153,6 +176,15 @@ public:
      * at all. The default implmentation does nothing.
      */
     virtual void draw() override;
+
+protected:
+    /**
+     * Saves the current player settings in the background.
+     *
+     * The settings are captured immediately, but are written to disk on the
+     * settings writer thread.  Saves in quick succession are merged.
+     */
+    void saveSettings();
 };
 
 #endif /* __CI_APP_H__ */
@@ -24,6 +24,7 @@
 #include <map>
 #include "CICollisionController.h"
 #include "CILocation.h"
+#include "CIGameConstants.h"
 
 /** Impulse for giving collisions a slight bounce. */
 #define COLLISION_COEFF     0.1f
@@ -35,11 +36,15 @@ using namespace cugl;
  *
  *  Increases or decreases layer planet size depending on the color of the stardust
  *
+ *  If impacts is not null, the position of each collision is appended to it.
+ *
  *  @param planet     The planet in the candidate collision
  *  @param queue       The stardust queue
+ *  @param impacts    The list to receive the collision positions (optional)
  *  @return true if any stardust collided with the planet
  */
-bool collisions::checkForCollision(const std::shared_ptr<PlanetModel>& planet, const std::shared_ptr<StardustQueue>& queue, float timestep) {
+bool collisions::checkForCollision(const std::shared_ptr<PlanetModel>& planet, const std::shared_ptr<StardustQueue>& queue, float timestep,
+                                   std::vector<cugl::Vec2>* impacts) {
     // Get the stardust size from the texture
     float sdRadius = queue->getStardustRadius();
     bool wasCollision = false;
@@ -82,10 +87,13 @@ bool collisions::checkForCollision(const std::shared_ptr<PlanetModel>& planet, c
                 Vec2 temp = 1.4 * norm * (impulse/stardust->getMass());
                 queue->createStardustParticleBlast(stardust->getPosition() + stardust->getVelocity(), (stardust->getVelocity()+temp) * 0.6, stardust->getColor(), planet->getColor());
                 wasCollision = true;
+                if (impacts != nullptr) {
+                    impacts->push_back(stardust->getPosition());
+                }
                 // Destroy the stardust
                 stardust->destroy();
             } else {
-                float force = timestep * 60 * 9.81f *
+                float force = timestep * CONSTANTS::TICKS_PER_SECOND * 9.81f *
                     (stardust->getMass() * stardust->getMass()) *
                     planet->getMass() / (distance * distance);
                 
@@ -106,10 +114,14 @@ bool collisions::checkForCollision(const std::shared_ptr<PlanetModel>& planet, c
  *  collidee. Therefore, you should only call this method for one of the
  *  stardusts, not both. Otherwise, you are processing the same collisions twice.
  *
+ *  If impacts is not null, the position of each collision outside of the
+ *  cooldown period is appended to it.
+ *
  *  @param queue    The stardust queue
+ *  @param impacts  The list to receive the collision positions (optional)
  *  @return true if there were any collisions outside of the cooldown period
  */
-bool collisions::checkForCollisions(const std::shared_ptr<StardustQueue>& queue) {
+bool collisions::checkForCollisions(const std::shared_ptr<StardustQueue>& queue, std::vector<cugl::Vec2>* impacts) {
     // Get the stardust size from the texture
     float sdRadius = queue->getStardustRadius();
     bool wasCollision = false;
@@ -130,8 +142,8 @@ bool collisions::checkForCollisions(const std::shared_ptr<StardustQueue>& queue)
                 if (distance < impactDistance) {
                     // "Roll back" time so that the stardusts are barely touching (e.g. point of impact).
                     Vec2 temp = norm * ((impactDistance - distance) / 2);
-                    stardust1->setPosition(stardust1->getPosition()+temp);
-                    stardust2->setPosition(stardust2->getPosition()-temp);
+                    stardust1->translate(temp);
+                    stardust2->translate(-temp);
 
                     // Now it is time for Newton's Law of Impact.
                     // Convert the two velocities into a single reference frame
@@ -150,6 +162,9 @@ bool collisions::checkForCollisions(const std::shared_ptr<StardustQueue>& queue)
                     if (stardust1->getHitCooldown() == 0 && stardust2->getHitCooldown() == 0) {
                         queue->createStardustParticleBlast(stardust1->getPosition().getMidpoint(stardust2->getPosition()), stardust1->getVelocity().getMidpoint(stardust2->getVelocity()), stardust1->getColor(), stardust2->getColor());
                         wasCollision = true;
+                        if (impacts != nullptr) {
+                            impacts->push_back(stardust1->getPosition().getMidpoint(stardust2->getPosition()));
+                        }
                         stardust1->triggerHit();
                         stardust2->triggerHit();
                     }
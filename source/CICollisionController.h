@@ -41,11 +41,15 @@ namespace collisions {
  *
  *  Increases or decreases layer planet size depending on the color of the stardust
  *
+ *  If impacts is not null, the position of each collision is appended to it.
+ *
  *  @param planet     The planet in the candidate collision
  *  @param queue       The stardust queue
+ *  @param impacts    The list to receive the collision positions (optional)
  *  @return true if any stardust collided with the planet
  */
-bool checkForCollision(const std::shared_ptr<PlanetModel>& planet, const std::shared_ptr<StardustQueue>& queue, float timestep);
+bool checkForCollision(const std::shared_ptr<PlanetModel>& planet, const std::shared_ptr<StardustQueue>& queue, float timestep,
+                       std::vector<cugl::Vec2>* impacts = nullptr);
 
 /**
  *  Handles collisions between stardusts, causing them to bounce off one another.
@@ -54,10 +58,14 @@ bool checkForCollision(const std::shared_ptr<PlanetModel>& planet, const std::sh
  *  collidee. Therefore, you should only call this method for one of the
  *  stardusts, not both. Otherwise, you are processing the same collisions twice.
  *
+ *  If impacts is not null, the position of each collision outside of the
+ *  cooldown period is appended to it.
+ *
  *  @param queue    The stardust queue
+ *  @param impacts  The list to receive the collision positions (optional)
  *  @return true if there were any collisions outside of the cooldown period
  */
-bool checkForCollisions(const std::shared_ptr<StardustQueue>& queue);
+bool checkForCollisions(const std::shared_ptr<StardustQueue>& queue, std::vector<cugl::Vec2>* impacts = nullptr);
 
 /**
  *  Checks for a collision between a planet and the input position
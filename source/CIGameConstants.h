@@ -19,6 +19,12 @@ namespace CONSTANTS {
     /** Scene height for all the scenes */
     inline constexpr int SCENE_HEIGHT = 576;
 
+#pragma mark Simulation
+    /** The number of fixed simulation ticks per second, at any frame rate */
+    inline constexpr int TICKS_PER_SECOND = 60;
+    /** The length of a simulation tick in seconds */
+    inline constexpr float TICK_SECONDS = 1.0f/TICKS_PER_SECOND;
+
 #pragma mark GameScene
     /** Max values for initializing stardusts and planet layers */
     inline constexpr int MAX_STARDUSTS = 512;
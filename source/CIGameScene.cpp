@@ -45,6 +45,9 @@ using namespace std;
 #define STARDUST_HIT_SOUND    "stardustHit"
 #define EXPLOSION_SOUND       "explosion"
 
+/** Maximum number of stardust hit sounds at once (extra hits are merged or culled) */
+#define STARDUST_HIT_VOICES   4
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -54,6 +57,9 @@ using namespace std;
  * us to have a non-pointer reference to this controller, reducing our
  * memory allocation.  Instead, allocation happens in this method.
  *
+ * This method only queues the construction of the scene graph and the
+ * models.  The scene is not complete until {@link build} returns true.
+ *
  * @param assets                The (loaded) assets for this game mode
  * @param networkMessageManager The reference to network message manager
  * @param gameSettings          The settings for the current game
@@ -85,56 +91,6 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets,
     _networkMessageManager = networkMessageManager;
     _networkMessageManager->setGameUpdateManager(_gameUpdateManager);
     
-    // Acquire the scene built by the asset loader and resize it the scene
-    auto scene = _assets->get<scene2::SceneNode>("game");
-    scene->setContentSize(dimen);
-    scene->doLayout(); // Repositions the HUD
-    
-    // Get the scene components.
-    _allSpace  = _assets->get<scene2::SceneNode>("game_field");
-    _farSpace = std::dynamic_pointer_cast<scene2::AnimationNode>(_assets->get<scene2::SceneNode>("game_field_far"));
-    _nearSpace = _assets->get<scene2::SceneNode>("game_field_near");
-    
-    // If height is exceeded by the screen size, fix the height by screen size
-    if ((dimen.height / _farSpace->getHeight()) > 1){
-        _farSpace->setScale(dimen.height / _farSpace->getContentHeight());
-    }
-    
-    // create the win scene
-    _winScene = WinScene::alloc(assets, dimen);
-
-    // create the pause menu
-    _pauseMenu = PauseMenu::alloc(_assets, networkMessageManager, playerSettings);
-    _pauseMenu->setDisplay(false);
-
-    _pauseBtn = std::dynamic_pointer_cast<scene2::Button>(assets->get<scene2::SceneNode>("game_pausebutton"));
-    _pauseBtn->setColor(Color4::GRAY);
-    _pauseBtn->setVisible(true);
-    _pauseBtn->activate();
-
-    _pauseBtn->addListener([&](const std::string& name, bool down) {
-        if (!down) {
-            _networkMessageManager->setGameState(GameState::GamePaused);
-        }
-        });
-
-    // Create the planet model
-    _planet = PlanetModel::alloc(dimen.width / 2, dimen.height / 2, CIColor::getNoneColor(), 
-        CONSTANTS::MAX_PLANET_LAYERS, gameSettings->getGravStrength(), gameSettings->getPlanetStardustPerLayer());
-    auto coreTexture = _assets->get<Texture>("core");
-    auto ringTexture = _assets->get<Texture>("innerRing");
-    auto unlockedTexture = _assets->get<Texture>("unlockedOuterRing");
-    auto lockedTexture = _assets->get<Texture>("lockedOuterRing");
-    auto planetProgressTexture = _assets->get<Texture>("playerProgress");
-    std::vector<std::shared_ptr<cugl::Texture>> powerupTextures;
-    powerupTextures.push_back(_assets->get<Texture>("greyscale_standalone"));
-    powerupTextures.push_back(_assets->get<Texture>("meteor_shower_standalone"));
-    powerupTextures.push_back(_assets->get<Texture>("shooting_star_standalone"));
-    powerupTextures.push_back(_assets->get<Texture>("fog_standalone"));
-    _planet->setTextures(coreTexture, ringTexture, unlockedTexture, lockedTexture, planetProgressTexture, powerupTextures);
-
-    _stardustContainer = StardustQueue::alloc(CONSTANTS::MAX_STARDUSTS, coreTexture);
-
     // Game settings
     _gameSettings = gameSettings;
     // Player settings
@@ -146,19 +102,57 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets,
     }
     CIColor::setNumColors(gameSettings->getColorCount());
     
-    std::shared_ptr<AudioQueue> musicQueue = AudioEngine::get()->getMusicQueue();
-    musicQueue->resume(); // needed to allow music to play after being paused
-    std::shared_ptr<Sound> source = _assets->get<Sound>(GAME_MUSIC);
-    musicQueue->play(source, true, _playerSettings->getVolume());
-    if (!_playerSettings->getMusicOn()) {
-        musicQueue->pause();
-    }
-
-    addChild(scene);
-    addChild(_planet->getPlanetNode());
-    addChild(_stardustContainer->getStardustNode());
-    addChild(_pauseMenu->getLayer(), 1);
-    addChild(_winScene->getLayer(), 1);
+    // The rest is too much for one frame, so it is built a step at a time
+    _builder.clear();
+    _builder.push([=] {
+        // Acquire the scene built by the asset loader and resize it the scene
+        auto scene = _assets->get<scene2::SceneNode>("game");
+        scene->setContentSize(dimen);
+        scene->doLayout(); // Repositions the HUD
+        
+        // Get the scene components.
+        _allSpace  = _assets->get<scene2::SceneNode>("game_field");
+        _farSpace = std::dynamic_pointer_cast<scene2::AnimationNode>(_assets->get<scene2::SceneNode>("game_field_far"));
+        _nearSpace = _assets->get<scene2::SceneNode>("game_field_near");
+        
+        // If height is exceeded by the screen size, fix the height by screen size
+        if ((dimen.height / _farSpace->getHeight()) > 1){
+            _farSpace->setScale(dimen.height / _farSpace->getContentHeight());
+        }
+        addChild(scene);
+    });
+    _builder.push([=] {
+        // Create the planet model
+        _planet = PlanetModel::alloc(dimen.width / 2, dimen.height / 2, CIColor::getNoneColor(),
+            CONSTANTS::MAX_PLANET_LAYERS, gameSettings->getGravStrength(), gameSettings->getPlanetStardustPerLayer());
+        auto coreTexture = _assets->get<Texture>("core");
+        auto ringTexture = _assets->get<Texture>("innerRing");
+        auto unlockedTexture = _assets->get<Texture>("unlockedOuterRing");
+        auto lockedTexture = _assets->get<Texture>("lockedOuterRing");
+        auto planetProgressTexture = _assets->get<Texture>("playerProgress");
+        std::vector<std::shared_ptr<cugl::Texture>> powerupTextures;
+        powerupTextures.push_back(_assets->get<Texture>("greyscale_standalone"));
+        powerupTextures.push_back(_assets->get<Texture>("meteor_shower_standalone"));
+        powerupTextures.push_back(_assets->get<Texture>("shooting_star_standalone"));
+        powerupTextures.push_back(_assets->get<Texture>("fog_standalone"));
+        _planet->setTextures(coreTexture, ringTexture, unlockedTexture, lockedTexture, planetProgressTexture, powerupTextures);
+        addChild(_planet->getPlanetNode());
+    });
+    _builder.push([=] {
+        _stardustContainer = StardustQueue::alloc(CONSTANTS::MAX_STARDUSTS, _assets->get<Texture>("core"));
+        addChild(_stardustContainer->getStardustNode());
+    });
+    _builder.push([=] {
+        // create the pause menu
+        _pauseMenu = PauseMenu::alloc(_assets, networkMessageManager, playerSettings);
+        _pauseMenu->setDisplay(false);
+        addChild(_pauseMenu->getLayer(), 1);
+    });
+    _builder.push([=] {
+        // create the win scene
+        _winScene = WinScene::alloc(_assets, dimen);
+        addChild(_winScene->getLayer(), 1);
+    });
     
     std::vector<string> opponentNames = networkMessageManager->getOtherNames();
     _opponentPlanets.resize((int) opponentNames.size());
@@ -166,24 +160,76 @@ bool GameScene::init(const std::shared_ptr<cugl::AssetManager>& assets,
         if (opponentNames[ii] == "") {
             continue;
         }
-        CILocation::Value location = CILocation::Value(ii+1);
-        cugl::Vec2 pos = CILocation::getPositionOfLocation(location, dimen);
-        std::shared_ptr<OpponentPlanet> opponent = OpponentPlanet::alloc(pos.x, pos.y, CIColor::getNoneColor(), CONSTANTS::MAX_PLANET_LAYERS, gameSettings->getGravStrength(), gameSettings->getPlanetStardustPerLayer(), location);
-        opponent->setTextures(_assets->get<Texture>("opponentProgress"), _assets->get<Texture>("fog"), dimen);
-        opponent->setName(opponentNames[ii], assets->get<Font>("saira20"));
-        addChild(opponent->getOpponentNode());
-        _opponentPlanets[ii] = opponent;
+        std::string name = opponentNames[ii];
+        _builder.push([=] {
+            CILocation::Value location = CILocation::Value(ii+1);
+            cugl::Vec2 pos = CILocation::getPositionOfLocation(location, dimen);
+            std::shared_ptr<OpponentPlanet> opponent = OpponentPlanet::alloc(pos.x, pos.y, CIColor::getNoneColor(), CONSTANTS::MAX_PLANET_LAYERS, gameSettings->getGravStrength(), gameSettings->getPlanetStardustPerLayer(), location);
+            opponent->setTextures(_assets->get<Texture>("opponentProgress"), _assets->get<Texture>("fog"), dimen);
+            opponent->setName(name, _assets->get<Font>("saira20"));
+            addChild(opponent->getOpponentNode());
+            _opponentPlanets[ii] = opponent;
+        });
     }
+    
+    _builder.push([=] {
+        // The pause button only works once the game is visible
+        _pauseBtn = std::dynamic_pointer_cast<scene2::Button>(_assets->get<scene2::SceneNode>("game_pausebutton"));
+        _pauseBtn->setColor(Color4::GRAY);
+        _pauseBtn->setVisible(true);
+        _pauseBtn->activate();
+        
+        _pauseBtn->addListener([&](const std::string& name, bool down) {
+            if (!down) {
+                _networkMessageManager->setGameState(GameState::GamePaused);
+            }
+            });
+        
+        std::shared_ptr<AudioQueue> musicQueue = AudioEngine::get()->getMusicQueue();
+        musicQueue->resume(); // needed to allow music to play after being paused
+        std::shared_ptr<Sound> source = _assets->get<Sound>(GAME_MUSIC);
+        musicQueue->play(source, true, _playerSettings->getVolume());
+        if (!_playerSettings->getMusicOn()) {
+            musicQueue->pause();
+        }
+        // Stardust hits pan across the screen and fade toward the corners
+        AudioEngine::get()->setSpatialListener(dimen/2, dimen.width/2, dimen.width+dimen.height);
+        AudioEngine::get()->setSpatialVoices(STARDUST_HIT_VOICES);
+        
+        // The field, planet, stardust, and menu layers are independent. Any
+        // cached subtree keeps its cache, but is redrawn a frame late when stale.
+        setParallel(true);
+    });
 
     return true;
 }
 
+/**
+ * Runs the construction steps queued by {@link init}, returning true when done.
+ *
+ * Building the game creates the win scene, the pause menu, the planet, the
+ * stardust pool and the opponent planets.  This is too much for a single
+ * frame, so init only queues these steps.  This method runs them in order
+ * until budget microseconds have passed, but always runs at least one.  A
+ * budget of 0 runs all of the remaining steps.  The scene should not be
+ * updated or drawn until this method returns true.
+ *
+ * @param budget    The time to spend building (in microseconds)
+ *
+ * @return true if the scene is completely built
+ */
+bool GameScene::build(Uint32 budget) {
+    return _builder.build(budget);
+}
+
 /**
  * Disposes of all (non-static) resources allocated to this mode.
  */
 void GameScene::dispose() {
+    _builder.clear();
     if (_active) {
         removeAllChildren();
+        setParallel(false);
         _input.dispose();
         _active = false;
     }
@@ -224,8 +270,10 @@ void GameScene::dispose() {
  * The method called to update the game mode.
  *
  * This method contains any gameplay code that is not an OpenGL call.
+ * It is called once per simulation tick, so any timer counted in calls
+ * to this method is measured in ticks.
  *
- * @param timestep  The amount of time (in seconds) since the last frame
+ * @param timestep  The length of a simulation tick (in seconds)
  * @param playerSettings    The player's saved settings value
  */
 void GameScene::update(float timestep, const std::shared_ptr<PlayerSettings>& playerSettings) {
@@ -266,7 +314,7 @@ void GameScene::update(float timestep, const std::shared_ptr<PlayerSettings>& pl
                     Vec2 particleVel = _planet->getPosition() - particlePos;
                     float distance = particleVel.length();
                     particleVel.normalize();
-                    float force = timestep * 60 * 98.1f * _planet->getMass() / distance;
+                    float force = timestep * CONSTANTS::TICKS_PER_SECOND * 98.1f * _planet->getMass() / distance;
                     // handle game settings
                     force *= _planet->getGravStrength();
                     particleVel *= (force * 1.0f);
@@ -314,12 +362,14 @@ void GameScene::update(float timestep, const std::shared_ptr<PlayerSettings>& pl
     std::map<Uint64, TouchInstance>* touchInstances = _input.getTouchInstances();
 
     collisions::checkInBounds(_stardustContainer, dimen);
-    std::shared_ptr<Sound> source = _assets->get<Sound>(STARDUST_HIT_SOUND);
-    if (collisions::checkForCollision(_planet, _stardustContainer, timestep) && _playerSettings->getMusicOn()) {
-        AudioEngine::get()->play(STARDUST_HIT_SOUND,source,false,_playerSettings->getVolume(), true);
-    }
-    if (collisions::checkForCollisions(_stardustContainer) && _playerSettings->getMusicOn()) {
-        AudioEngine::get()->play(STARDUST_HIT_SOUND,source,false,_playerSettings->getVolume(), true);
+    _impacts.clear();
+    collisions::checkForCollision(_planet, _stardustContainer, timestep, &_impacts);
+    collisions::checkForCollisions(_stardustContainer, &_impacts);
+    if (_playerSettings->getMusicOn()) {
+        std::shared_ptr<Sound> source = _assets->get<Sound>(STARDUST_HIT_SOUND);
+        for (auto it = _impacts.begin(); it != _impacts.end(); ++it) {
+            AudioEngine::get()->playAt(STARDUST_HIT_SOUND, source, *it, _playerSettings->getVolume());
+        }
     }
     updateDraggedStardust(touchInstances);
     
@@ -375,6 +425,20 @@ void GameScene::update(float timestep, const std::shared_ptr<PlayerSettings>& pl
     }
 }
 
+/**
+ * Prepares the game mode to be drawn part of the way to the next tick.
+ *
+ * Moving objects are drawn between their positions before and after
+ * the last simulation tick.
+ *
+ * @param alpha The fraction of the last simulation tick to draw at
+ */
+void GameScene::interpolate(float alpha) {
+    if (_stardustContainer != nullptr && _stardustContainer->getStardustNode() != nullptr) {
+        _stardustContainer->getStardustNode()->setInterpolation(alpha);
+    }
+}
+
 /**
  * This method updates the dragged stardust.
  *
@@ -31,6 +31,7 @@
 #include "CIPlayerSettings.h"
 #include "CIGameConstants.h"
 #include "CIPauseMenu.h"
+#include "CISceneBuilder.h"
 
 /** Base stardust spawn rate */
 #define BASE_PROBABILITY_SPACE 100
@@ -49,6 +50,7 @@ class GameScene : public cugl::Scene2 {
 private:
     /** Handles stardust color probability */
     int _stardustProb[6];
+    /** The countdown of the game end animation (in simulation ticks) */
     int _gameEndTimer;
 protected:
     /** The asset manager for this game mode. */
@@ -93,10 +95,15 @@ protected:
 
     /** Time since last animation frame update */
     float _timeElapsed;
+    /** The stardust collision positions this frame (for positional sound) */
+    std::vector<cugl::Vec2> _impacts;
     
     /** Pointer to the win scene */
     std::shared_ptr<WinScene> _winScene;
     
+    /** The construction steps left to run (see {@link build}) */
+    SceneBuilder _builder;
+    
 public:
 #pragma mark -
 #pragma mark Constructors
@@ -132,6 +139,9 @@ public:
      * us to have a non-pointer reference to this controller, reducing our
      * memory allocation.  Instead, allocation happens in this method.
      *
+     * This method only queues the construction of the scene graph and the
+     * models.  The scene is not complete until {@link build} returns true.
+     *
      * @param assets                The (loaded) assets for this game mode
      * @param networkMessageManager The reference to network message manager
      * @param gameSettings          The settings for the current game
@@ -144,19 +154,47 @@ public:
         const std::shared_ptr<GameSettings>& gameSettings, 
         const std::shared_ptr<PlayerSettings>& playerSettings);
     
+    /**
+     * Runs the construction steps queued by {@link init}, returning true when done.
+     *
+     * Building the game creates the win scene, the pause menu, the planet, the
+     * stardust pool and the opponent planets.  This is too much for a single
+     * frame, so init only queues these steps.  This method runs them in order
+     * until budget microseconds have passed, but always runs at least one.  A
+     * budget of 0 runs all of the remaining steps.  The scene should not be
+     * updated or drawn until this method returns true.
+     *
+     * @param budget    The time to spend building (in microseconds)
+     *
+     * @return true if the scene is completely built
+     */
+    bool build(Uint32 budget);
+    
 #pragma mark -
 #pragma mark Gameplay Handling
     /**
      * The method called to update the game mode.
      *
      * This method contains any gameplay code that is not an OpenGL call.
+     * It is called once per simulation tick, so any timer counted in calls
+     * to this method is measured in ticks.
      *
-     * @param timestep  The amount of time (in seconds) since the last frame
+     * @param timestep  The length of a simulation tick (in seconds)
      * @param playerSettings    The player's saved settings value
      * 
      */
     void update(float timestep, const std::shared_ptr<PlayerSettings>& playerSettings);
     
+    /**
+     * Prepares the game mode to be drawn part of the way to the next tick.
+     *
+     * Moving objects are drawn between their positions before and after
+     * the last simulation tick.
+     *
+     * @param alpha The fraction of the last simulation tick to draw at
+     */
+    void interpolate(float alpha);
+    
     /**
      * This method updates the dragged stardust.
      *
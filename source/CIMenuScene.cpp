@@ -21,6 +21,9 @@ using namespace cugl;
  * us to have a non-pointer reference to this controller, reducing our
  * memory allocation.  Instead, allocation happens in this method.
  *
+ * This method only queues the construction of the menu screens.  The scene
+ * is not complete until {@link build} returns true.
+ *
  * @param assets                The (loaded) assets for this game mode
  * @param networkMessageManager The network message manager for the game
  * @param gameSettings          The settings for the current game
@@ -43,40 +46,6 @@ bool MenuScene::init(const std::shared_ptr<cugl::AssetManager>& assets,
     }
 
     _assets = assets;
-    auto layer = assets->get<scene2::SceneNode>("menu");
-    layer->setContentSize(dimen);
-    layer->doLayout();
-
-    _teamLogo = assets->get<scene2::SceneNode>("menu_teamLogo");
-    _gameTitle = assets->get<scene2::SceneNode>("menu_title");
-    _gamePlanet = assets->get<scene2::SceneNode>("menu_world");
-
-    /** Back button to return to main menu */
-    _backBtn = std::dynamic_pointer_cast<scene2::Button>(assets->get<scene2::SceneNode>("menu_menubackbutton"));
-    _backBtn->addListener([&](const std::string& name, bool down) {
-        if (!down) {
-            switch (_state)
-            {
-                case MenuState::Setting:
-                    _state = MenuState::SettingToMain;
-                    break;
-                case MenuState::NameMenu:
-                    _state = MenuState::NameToMain;
-                    break;
-                case MenuState::JoinRoom:
-                    _state = MenuState::JoinToMain;
-                    break;
-                case MenuState::GameLobby:
-                    _state = MenuState::LobbyToMain;
-                    break;
-                case MenuState::GameSetting:
-                    _state = MenuState::GameSettingToLobby;
-                    break;
-                default:
-                    break;
-            }
-        }
-        });
 
     // game settings 
     _gameSettings = gameSettings;
@@ -88,36 +57,81 @@ bool MenuScene::init(const std::shared_ptr<cugl::AssetManager>& assets,
     _state = MenuState::LoadToMain;
 
     Application::get()->setClearColor(Color4(192, 192, 192, 255));
-    addChildWithName(layer, "menuScene");
-
-    _mainmenu = MainMenu::alloc(_assets);
-    _mainmenu->setDisplay(false);
-
-    _settings = SettingsMenu::alloc(_assets, playerSettings);
-    _settings->setDisplay(false);
-
-    _namemenu = NameMenu::alloc(_assets, playerSettings);
-    _namemenu->setDisplay(false);
 
-    _join = JoinMenu::alloc(_assets, gameSettings);
-    _join->setDisplay(false);
-
-    _lobby = LobbyMenu::alloc(_assets, networkMessageManager, gameSettings, playerSettings);
-    _lobby->setDisplay(false);
-
-    _gsettingsmenu = GameSettingsMenu::alloc(_assets, networkMessageManager, gameSettings);
-    _gsettingsmenu->setDisplay(false);
-
-    _popupMenu = PopupMenu::alloc(_assets, networkMessageManager, gameSettings, playerSettings);
-    _popupMenu->setDisplay(false);
-
-    addChild(_mainmenu->getLayer(), 0);
-    addChild(_settings->getLayer(), 1);
-    addChild(_namemenu->getLayer(), 1);
-    addChild(_join->getLayer(), 2);
-    addChild(_lobby->getLayer(), 3);
-    addChild(_gsettingsmenu->getLayer(), 4);
-    addChild(_popupMenu->getLayer(), 5);
+    // The menu screens are too much for one frame, so they are built a step at a time
+    _builder.clear();
+    _builder.push([=] {
+        auto layer = _assets->get<scene2::SceneNode>("menu");
+        layer->setContentSize(dimen);
+        layer->doLayout();
+
+        _teamLogo = _assets->get<scene2::SceneNode>("menu_teamLogo");
+        _gameTitle = _assets->get<scene2::SceneNode>("menu_backdrop_title");
+        _gamePlanet = _assets->get<scene2::SceneNode>("menu_backdrop_world");
+
+        /** Back button to return to main menu */
+        _backBtn = std::dynamic_pointer_cast<scene2::Button>(_assets->get<scene2::SceneNode>("menu_menubackbutton"));
+        _backBtn->addListener([&](const std::string& name, bool down) {
+            if (!down) {
+                switch (_state)
+                {
+                    case MenuState::Setting:
+                        _state = MenuState::SettingToMain;
+                        break;
+                    case MenuState::NameMenu:
+                        _state = MenuState::NameToMain;
+                        break;
+                    case MenuState::JoinRoom:
+                        _state = MenuState::JoinToMain;
+                        break;
+                    case MenuState::GameLobby:
+                        _state = MenuState::LobbyToMain;
+                        break;
+                    case MenuState::GameSetting:
+                        _state = MenuState::GameSettingToLobby;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            });
+        addChildWithName(layer, "menuScene");
+    });
+    _builder.push([=] {
+        _mainmenu = MainMenu::alloc(_assets);
+        _mainmenu->setDisplay(false);
+        addChild(_mainmenu->getLayer(), 0);
+    });
+    _builder.push([=] {
+        _settings = SettingsMenu::alloc(_assets, playerSettings);
+        _settings->setDisplay(false);
+        addChild(_settings->getLayer(), 1);
+    });
+    _builder.push([=] {
+        _namemenu = NameMenu::alloc(_assets, playerSettings);
+        _namemenu->setDisplay(false);
+        addChild(_namemenu->getLayer(), 1);
+    });
+    _builder.push([=] {
+        _join = JoinMenu::alloc(_assets, gameSettings);
+        _join->setDisplay(false);
+        addChild(_join->getLayer(), 2);
+    });
+    _builder.push([=] {
+        _lobby = LobbyMenu::alloc(_assets, networkMessageManager, gameSettings, playerSettings);
+        _lobby->setDisplay(false);
+        addChild(_lobby->getLayer(), 3);
+    });
+    _builder.push([=] {
+        _gsettingsmenu = GameSettingsMenu::alloc(_assets, networkMessageManager, gameSettings);
+        _gsettingsmenu->setDisplay(false);
+        addChild(_gsettingsmenu->getLayer(), 4);
+    });
+    _builder.push([=] {
+        _popupMenu = PopupMenu::alloc(_assets, networkMessageManager, gameSettings, playerSettings);
+        _popupMenu->setDisplay(false);
+        addChild(_popupMenu->getLayer(), 5);
+    });
 
     return true;
 }
@@ -131,10 +145,28 @@ bool MenuScene::init(const std::shared_ptr<cugl::AssetManager>& assets) {
     return init(assets, _networkMessageManager, _gameSettings, _playerSettings);
 }
 
+/**
+ * Runs the construction steps queued by {@link init}, returning true when done.
+ *
+ * Building the menu creates the backdrop and every menu screen.  This is
+ * too much for a single frame, so init only queues these steps.  This
+ * method runs them in order until budget microseconds have passed, but
+ * always runs at least one.  A budget of 0 runs all of the remaining steps.
+ * The scene should not be updated until this method returns true.
+ *
+ * @param budget    The time to spend building (in microseconds)
+ *
+ * @return true if the scene is completely built
+ */
+bool MenuScene::build(Uint32 budget) {
+    return _builder.build(budget);
+}
+
 /**
  * Disposes of all (non-static) resources allocated to this mode.
  */
 void MenuScene::dispose() {
+    _builder.clear();
     removeAllChildren();
     
     // Deactivate the button (platform dependent)
@@ -144,29 +176,42 @@ void MenuScene::dispose() {
         _backBtn->clearListeners();
     }
     
-    _mainmenu->setDisplay(false);
-    _settings->setDisplay(false);
-    _namemenu->setDisplay(false);
-    _join->setDisplay(false);
-    _lobby->setDisplay(false);
-    _gsettingsmenu->setDisplay(false);
-    _popupMenu->setDisplay(false);
-
-    _mainmenu->dispose();
-    _settings->dispose();
-    _namemenu->dispose();
-    _join->dispose();
-    _lobby->dispose();
-    _gsettingsmenu->dispose();
-    _popupMenu->dispose();
-
-    _mainmenu = nullptr;
-    _settings = nullptr;
-    _namemenu = nullptr;
-    _join = nullptr;
-    _lobby = nullptr;
-    _gsettingsmenu = nullptr;
-    _popupMenu = nullptr;
+    // A menu disposed in the middle of a build is missing some screens
+    if (_mainmenu != nullptr) {
+        _mainmenu->setDisplay(false);
+        _mainmenu->dispose();
+        _mainmenu = nullptr;
+    }
+    if (_settings != nullptr) {
+        _settings->setDisplay(false);
+        _settings->dispose();
+        _settings = nullptr;
+    }
+    if (_namemenu != nullptr) {
+        _namemenu->setDisplay(false);
+        _namemenu->dispose();
+        _namemenu = nullptr;
+    }
+    if (_join != nullptr) {
+        _join->setDisplay(false);
+        _join->dispose();
+        _join = nullptr;
+    }
+    if (_lobby != nullptr) {
+        _lobby->setDisplay(false);
+        _lobby->dispose();
+        _lobby = nullptr;
+    }
+    if (_gsettingsmenu != nullptr) {
+        _gsettingsmenu->setDisplay(false);
+        _gsettingsmenu->dispose();
+        _gsettingsmenu = nullptr;
+    }
+    if (_popupMenu != nullptr) {
+        _popupMenu->setDisplay(false);
+        _popupMenu->dispose();
+        _popupMenu = nullptr;
+    }
 
     _teamLogo = nullptr;
     _gameTitle = nullptr;
@@ -21,6 +21,7 @@
 #include "CIGameSettings.h"
 #include "CIPlayerSettings.h"
 #include "CIGameConstants.h"
+#include "CISceneBuilder.h"
 
 
 /**
@@ -72,6 +73,9 @@ protected:
     /** The network message manager for managing connections to other players */
     std::shared_ptr<NetworkMessageManager> _networkMessageManager;
 
+    /** The construction steps left to run (see {@link build}) */
+    SceneBuilder _builder;
+
 public:
 #pragma mark -
 #pragma mark Constructors
@@ -116,6 +120,9 @@ public:
      * us to have a non-pointer reference to this controller, reducing our
      * memory allocation.  Instead, allocation happens in this method.
      *
+     * This method only queues the construction of the menu screens.  The
+     * scene is not complete until {@link build} returns true.
+     *
      * @param assets                The (loaded) assets for this game mode
      * @param networkMessageManager The network message manager for the game
      * @param gameSettings          The settings for the current game
@@ -128,6 +135,21 @@ public:
         const std::shared_ptr<GameSettings>& gameSettings,
         const std::shared_ptr<PlayerSettings>& playerSettings);
 
+    /**
+     * Runs the construction steps queued by {@link init}, returning true when done.
+     *
+     * Building the menu creates the backdrop and every menu screen.  This is
+     * too much for a single frame, so init only queues these steps.  This
+     * method runs them in order until budget microseconds have passed, but
+     * always runs at least one.  A budget of 0 runs all of the remaining steps.
+     * The scene should not be updated until this method returns true.
+     *
+     * @param budget    The time to spend building (in microseconds)
+     *
+     * @return true if the scene is completely built
+     */
+    bool build(Uint32 budget);
+
 #pragma mark -
 #pragma mark Menu Monitoring
     /**
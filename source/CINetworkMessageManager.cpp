@@ -15,10 +15,12 @@
 #include "CIStardustModel.h"
 #include "CIOpponentPlanet.h"
 #include "CILocation.h"
+#include "CIGameConstants.h"
 
-#define  NO_MSG_RECV_FRAMES_UNTIL_TIMEOUT   360     // 6 seconds
-#define  FRAMES_UNTIL_TIMEOUT   600     // 10 seconds
-#define  FRAMES_UNTIL_PING      120     // 2 seconds
+// Counted in simulation ticks, as messages are processed once per tick in game
+#define  NO_MSG_RECV_TICKS_UNTIL_TIMEOUT   (6*CONSTANTS::TICKS_PER_SECOND)
+#define  TICKS_UNTIL_TIMEOUT   (10*CONSTANTS::TICKS_PER_SECOND)
+#define  TICKS_UNTIL_PING      (2*CONSTANTS::TICKS_PER_SECOND)
 
 /**
  * Disposes of all (non-static) resources allocated to this network message manager.
@@ -28,7 +30,7 @@ void NetworkMessageManager::dispose() {
     _gameUpdateManager = nullptr;
     _timestamp = 0;
     _winnerPlayerId = -1;
-    _framesSinceLastMessage.clear();
+    _ticksSinceLastMessage.clear();
 }
 
 /**
@@ -43,8 +45,8 @@ void NetworkMessageManager::dispose() {
 bool NetworkMessageManager::init(const shared_ptr<GameSettings>& gameSettings) {
     _gameSettings = gameSettings;
     reset();
-    _framesSinceLastMessage.resize(5);
-    _framesSinceLastMessageReceived = 0;
+    _ticksSinceLastMessage.resize(5);
+    _ticksSinceLastMessageReceived = 0;
     return true;
 }
 
@@ -61,10 +63,10 @@ void NetworkMessageManager::reset() {
     _roomId = "00000";
     _playerName = "N/A";
     _gameSettings->reset();
-    for (auto ii = 0; ii < _framesSinceLastMessage.size(); ii++) {
-        _framesSinceLastMessage[ii] = 0;
+    for (size_t ii = 0; ii < _ticksSinceLastMessage.size(); ii++) {
+        _ticksSinceLastMessage[ii] = 0;
     }
-    _framesSinceLastMessageReceived = 0;
+    _ticksSinceLastMessageReceived = 0;
 }
 
 /**
@@ -158,7 +160,7 @@ void NetworkMessageManager::sendMessages() {
 
             std::shared_ptr<GameUpdate> gameUpdate = _gameUpdateManager->getGameUpdateToSend();
             if (gameUpdate == nullptr) {
-                if (_framesSinceLastMessage[playerId] >= FRAMES_UNTIL_PING) {
+                if (_ticksSinceLastMessage[playerId] >= TICKS_UNTIL_PING) {
                     NetworkUtils::encodeInt(NetworkUtils::MessageType::Ping, data);
                     NetworkUtils::encodeInt(playerId, data);
                     NetworkUtils::encodeInt(_timestamp, data);
@@ -168,12 +170,12 @@ void NetworkMessageManager::sendMessages() {
                     data.clear();
                     CULog("SENT Ping> SRC[%i], TS[%i]", playerId, _timestamp);
                     
-                    _framesSinceLastMessage[playerId] = 0;
+                    _ticksSinceLastMessage[playerId] = 0;
                 }
                 return;
             }
             
-            _framesSinceLastMessage[getPlayerId()] = 0;
+            _ticksSinceLastMessage[getPlayerId()] = 0;
 
             for (auto const& [key, val] : gameUpdate->getStardustSent()) {
                 int dstPlayerId = key;
@@ -310,7 +312,7 @@ void NetworkMessageManager::receiveMessages() {
     }
     
     if (_gameState == GameState::GameInProgress) {
-        _framesSinceLastMessageReceived++;
+        _ticksSinceLastMessageReceived++;
     }
     
     _conn->receive([this](const std::vector<uint8_t>& recv) {
@@ -324,7 +326,7 @@ void NetworkMessageManager::receiveMessages() {
             return;
         }
         
-        _framesSinceLastMessageReceived = 0;
+        _ticksSinceLastMessageReceived = 0;
 
         switch (message_type)
         {
@@ -335,7 +337,7 @@ void NetworkMessageManager::receiveMessages() {
 
                 CULog("RCVD Ping> SRC[%i], TS[%i]", srcPlayer, timestamp);
                 
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
                 break;
             }
             case NetworkUtils::MessageType::DisconnectGame:
@@ -358,7 +360,7 @@ void NetworkMessageManager::receiveMessages() {
                 int timestamp = NetworkUtils::decodeInt(recv[24], recv[25], recv[26], recv[27]);
 
                 CULog("RCVD SU> SRC[%i], DST[%i], CLR[%i], VEL[%f,%f]", srcPlayer, dstPlayer, stardustColor, xVel, yVel);
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
 
                 std::shared_ptr<StardustModel> stardust = StardustModel::alloc(cugl::Vec2(0, 0), cugl::Vec2(xVel, yVel), static_cast<CIColor::Value>(stardustColor));
                 std::map<int, std::vector<std::shared_ptr<StardustModel>>> map = { { dstPlayer, std::vector<std::shared_ptr<StardustModel>> { stardust } } };
@@ -374,7 +376,7 @@ void NetworkMessageManager::receiveMessages() {
                 int timestamp = NetworkUtils::decodeInt(recv[16], recv[17], recv[18], recv[19]);
 
                 CULog("RCVD PU> SRC[%i], CLR[%i], SIZE[%f]", srcPlayer, planetColor, planetSize);
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
 
                 CILocation::Value corner = NetworkUtils::getLocation(getPlayerId(), srcPlayer);
                 std::shared_ptr<OpponentPlanet> planet = OpponentPlanet::alloc(0, 0, CIColor::Value(planetColor), CONSTANTS::MAX_PLANET_LAYERS, _gameSettings->getGravStrength(), _gameSettings->getPlanetStardustPerLayer(), corner);
@@ -392,7 +394,7 @@ void NetworkMessageManager::receiveMessages() {
                     int timestamp = NetworkUtils::decodeInt(recv[8], recv[9], recv[10], recv[11]);
 
                     CULog("RCVD Attempt To Win> SRC[%i], TS[%i]", srcPlayer, timestamp);
-                    _framesSinceLastMessage[srcPlayer] = 0;
+                    _ticksSinceLastMessage[srcPlayer] = 0;
 
                     if (_winnerPlayerId == -1) {
                         _winnerPlayerId = srcPlayer;
@@ -415,7 +417,7 @@ void NetworkMessageManager::receiveMessages() {
                 int timestamp = NetworkUtils::decodeInt(recv[8], recv[9], recv[10], recv[11]);
 
                 CULog("RCVD GAME WON> SRC[%i], TS[%i]", srcPlayer, timestamp);
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
 
                 if (_winnerPlayerId == -1) {
                     _winnerPlayerId = srcPlayer;
@@ -566,7 +568,7 @@ void NetworkMessageManager::receiveMessages() {
                 int timestamp = NetworkUtils::decodeInt(recv[12], recv[13], recv[14], recv[15]);
 
                 CULog("RCVD Stardust Hit> SRC[%i], DST[%i], TS[%i]", srcPlayer, dstPlayer, timestamp);
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
 
                 if (dstPlayer == getPlayerId()) {
                     // put a grey stardust on the queue to indicate it is a reward stardust
@@ -585,7 +587,7 @@ void NetworkMessageManager::receiveMessages() {
                 int timestamp = NetworkUtils::decodeInt(recv[16], recv[17], recv[18], recv[19]);
 
                 CULog("RCVD Powerup Applied> SRC[%i], POWERUP[%i], CLR[%i], TS[%i]", srcPlayer, powerup, stardustColor, timestamp);
-                _framesSinceLastMessage[srcPlayer] = 0;
+                _ticksSinceLastMessage[srcPlayer] = 0;
 
                 std::shared_ptr<StardustModel> stardust = StardustModel::alloc(cugl::Vec2(0, 0), cugl::Vec2(0, 0), CIColor::Value(stardustColor));
                 stardust->setStardustType(StardustModel::Type(powerup));
@@ -604,20 +606,20 @@ void NetworkMessageManager::receiveMessages() {
         });
     
     if (_gameState == GameState::GameInProgress) {
-        int minFrame = FRAMES_UNTIL_TIMEOUT;
-        for (auto ii = 0; ii < _framesSinceLastMessage.size(); ii++) {
-            _framesSinceLastMessage[ii]++;
+        int minTicks = TICKS_UNTIL_TIMEOUT;
+        for (int ii = 0; ii < (int)_ticksSinceLastMessage.size(); ii++) {
+            _ticksSinceLastMessage[ii]++;
             if (ii != getPlayerId())
-                minFrame = min(minFrame, _framesSinceLastMessage[ii]);
+                minTicks = min(minTicks, _ticksSinceLastMessage[ii]);
             
-            if (_framesSinceLastMessage[ii] == FRAMES_UNTIL_TIMEOUT) {
+            if (_ticksSinceLastMessage[ii] == TICKS_UNTIL_TIMEOUT) {
                 if (ii == 0) {
                     _winnerPlayerId = -2;
                 }
             }
         }
         
-        if (_conn->getNumPlayers() > 1 && _framesSinceLastMessageReceived >= NO_MSG_RECV_FRAMES_UNTIL_TIMEOUT) {
+        if (_conn->getNumPlayers() > 1 && _ticksSinceLastMessageReceived >= NO_MSG_RECV_TICKS_UNTIL_TIMEOUT) {
             _winnerPlayerId = -3;
         }
     }
@@ -47,10 +47,10 @@ private:
     /** map from player id to player name and whether player is ready */
     std::map<int, std::pair<string, bool>> _playerMap;
     
-    /** The number of frames that have gone by since the last message received from each player */
-    std::vector<int> _framesSinceLastMessage;
-    
-    int _framesSinceLastMessageReceived;
+    /** The number of simulation ticks that have gone by since the last message received from each player */
+    std::vector<int> _ticksSinceLastMessage;
+    /** The number of simulation ticks that have gone by since any message was received */
+    int _ticksSinceLastMessageReceived;
 
 public:
 #pragma mark -
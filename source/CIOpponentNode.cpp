@@ -14,7 +14,7 @@
 #define BAR_PROGRESS_DELTA  .003
 #define SPF                 .045 //seconds per frame
 #define FOG_SEC_ON_SCREEN     10
-#define FOG_FRAMES            60
+#define FOG_TICKS             60 //simulation ticks to fade the fog
 
 /**
  * Disposes the Stardust node, releasing all resources.
@@ -47,7 +47,7 @@ void OpponentNode::draw(const std::shared_ptr<cugl::SpriteBatch>& batch,
     AnimationNode::draw(batch, verticalBarTransform, tint);
     
     if (_fogAnimationProgress > 0) {
-        float fogProgress = _fogAnimationEasingFunction->evaluate((float) _fogAnimationProgress / FOG_FRAMES);
+        float fogProgress = _fogAnimationEasingFunction->evaluate((float) _fogAnimationProgress / FOG_TICKS);
         cugl::Vec2 fogOrigin = _fogTexture->getSize() / 2;
         cugl::Mat4 fogTransform;
         fogTransform.rotateZ(getFogRotationFromLocation(_location));
@@ -86,7 +86,7 @@ void OpponentNode::update(float timestep) {
     
     if (_fogOngoing) {
         // fog is fully on screen
-        if (_fogAnimationProgress == FOG_FRAMES) {
+        if (_fogAnimationProgress == FOG_TICKS) {
             if (_fogTimeOnScreen >= FOG_SEC_ON_SCREEN) {
                 _fogOngoing = false;
             } else {
@@ -55,7 +55,7 @@ private:
     
     /** The amount of time the full fog texture has be on the screen */
     float _fogTimeOnScreen;
-    /** How many frames the fog animation has been going for. */
+    /** How many simulation ticks the fog animation has been going for. */
     int _fogAnimationProgress;
     /** Whether or not the fog power up is still on going */
     bool _fogOngoing;
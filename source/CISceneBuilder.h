@@ -0,0 +1,99 @@
+//
+//  CISceneBuilder.h
+//  CoreImpact
+//
+//  This class builds a scene a step at a time.  Building a scene graph and
+//  its models can take longer than a frame, so the scenes queue their
+//  construction steps here and run them between frames, a slice at a time.
+//  This follows the time budget of the Scene2Loader in CUGL.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#ifndef __CI_SCENE_BUILDER_H__
+#define __CI_SCENE_BUILDER_H__
+#include <cugl/cugl.h>
+#include <deque>
+#include <functional>
+
+/**
+ * This class is a queue of construction steps for a scene.
+ *
+ * A scene adds its steps (as closures) in its init method, and then calls
+ * {@link build} once a frame until it returns true.  Each call runs the
+ * steps in order until the time budget is spent.  A step is never split,
+ * so no step should take longer than a frame on its own.
+ *
+ * The steps run on the main thread, so they may create scene graph nodes,
+ * textures and other OpenGL resources.
+ */
+class SceneBuilder {
+private:
+    /** The construction steps left to run */
+    std::deque<std::function<void()>> _stages;
+
+public:
+    /**
+     * Creates a builder with no construction steps.
+     */
+    SceneBuilder() {}
+
+    /**
+     * Adds a construction step to the end of this builder.
+     *
+     * @param stage The construction step
+     */
+    void push(const std::function<void()>& stage) {
+        _stages.push_back(stage);
+    }
+
+    /**
+     * Removes all of the construction steps that have not run.
+     *
+     * This should be called when a scene is disposed in the middle of a
+     * build, as the steps capture the scene.
+     */
+    void clear() {
+        _stages.clear();
+    }
+
+    /**
+     * Returns true if all of the construction steps have run.
+     *
+     * @return true if all of the construction steps have run.
+     */
+    bool isDone() const {
+        return _stages.empty();
+    }
+
+    /**
+     * Runs the construction steps in order, returning true when done.
+     *
+     * This method runs the steps until budget microseconds have passed, but
+     * always runs at least one.  A budget of 0 runs all of the remaining
+     * steps.
+     *
+     * @param budget    The time to spend building (in microseconds)
+     *
+     * @return true if all of the construction steps have run
+     */
+    bool build(Uint32 budget) {
+        cugl::Timestamp start;
+        cugl::Timestamp now;
+        while (!_stages.empty()) {
+            // Pop first, as the step may clear this builder
+            std::function<void()> stage = _stages.front();
+            _stages.pop_front();
+            stage();
+            if (budget > 0) {
+                now.mark();
+                if (cugl::Timestamp::ellapsedMicros(start,now) >= budget) {
+                    break;
+                }
+            }
+        }
+        return _stages.empty();
+    }
+};
+
+#endif /* __CI_SCENE_BUILDER_H__ */
@@ -36,6 +36,7 @@ void StardustModel::setVelocity(cugl::Vec2 value) {
  */
 StardustModel::StardustModel() {
     _position.set(0,0);
+    _lastPosition.set(0,0);
     _color = CIColor::blue;
 }
 
@@ -60,6 +61,7 @@ void StardustModel::dispose() {
  */
 bool StardustModel::init(cugl::Vec2 position, cugl::Vec2 velocity, CIColor::Value c) {
     _position = position;
+    _lastPosition = position;
     _color = c;
     _mass = 1;
     _radius = 1;
@@ -83,12 +85,13 @@ bool StardustModel::init(cugl::Vec2 position, cugl::Vec2 velocity, CIColor::Valu
  * @param velocity The initial velocity of the particle
  * @param c The color code of the particle
  * @param size The size of the particle
- * @param lifespan Time to live of the particle
+ * @param lifespan Time to live of the particle (in simulation ticks)
  *
  * @return true if the initialization was successful
  */
 bool StardustModel::initParticle(cugl::Vec2 position, cugl::Vec2 velocity, CIColor::Value c, float size, float lifespan) {
     _position = position;
+    _lastPosition = position;
     _color = c;
     _mass = lifespan;
     _radius = size;
@@ -118,11 +121,14 @@ void StardustModel::destroy() {
  * Updates the state of the model
  *
  * This method moves the stardust in accordance with the forces applied.
+ * The velocity is in pixels per simulation tick, so this method
+ * should be called once per tick.
  * It also steps the hit cooldown timer if it is active.
  *
  * @param timestep  Time elapsed since last called.
  */
 void StardustModel::update(float timestep) {
+    _lastPosition = _position;
     _position += _velocity;
     if (_hitCooldown > 0) {
         _hitCooldown -= timestep;
@@ -53,6 +53,8 @@ private:
 protected:
     /** Position of the stardust in world space */
     cugl::Vec2 _position;
+    /** Position of the stardust before the last call to update */
+    cugl::Vec2 _lastPosition;
     /** Current stardust velocity */
     cugl::Vec2 _velocity;
     /** Determines if this stardust is interactable */
@@ -79,6 +81,36 @@ public:
      */
     void setPosition(cugl::Vec2 value) {
         _position = value;
+        _lastPosition = value;
+    }
+
+    /**
+     * Moves this stardust by the given offset.
+     *
+     * Unlike {@link #setPosition}, this keeps the position before the last
+     * tick.  So a stardust pushed apart in a collision is drawn sliding to
+     * its new position, instead of jumping there.
+     *
+     * @param offset    the amount to move this stardust
+     */
+    void translate(const cugl::Vec2& offset) {
+        _position += offset;
+    }
+
+    /**
+     * Returns the position of this stardust for drawing.
+     *
+     * The simulation moves stardust once per tick, but a frame may be drawn
+     * part of the way to the next tick.  This position is interpolated from
+     * the position before the last tick to the current one.  A stardust that
+     * was just placed with {@link #setPosition} is drawn where it is.
+     *
+     * @param alpha The fraction of the last tick to interpolate by
+     *
+     * @return the position of this stardust for drawing
+     */
+    cugl::Vec2 getDrawPosition(float alpha) const {
+        return _lastPosition+(_position-_lastPosition)*alpha;
     }
 
     /**
@@ -296,7 +328,7 @@ public:
      * @param velocity The initial velocity of the particle
      * @param c The color code of the particle
      * @param size The size of the particle
-     * @param lifespan Time to live of the particle
+     * @param lifespan Time to live of the particle (in simulation ticks)
      *
      * @return true if the initialization was successful
      */
@@ -329,7 +361,7 @@ public:
      * @param velocity The initial velocity of the particle
      * @param c The color code of the particle
      * @param size The size of the particle
-     * @param lifespan Time to live of the particle
+     * @param lifespan Time to live of the particle (in simulation ticks)
      *
      * @return a newly allocated stardust at the given location with the given color.
      */
@@ -352,6 +384,8 @@ public:
      * Updates the state of the model
      *
      * This method moves the stardust in accordance with the forces applied.
+     * The velocity is in pixels per simulation tick, so this method
+     * should be called once per tick.
      *
      * @param timestep  Time elapsed since last called.
      */
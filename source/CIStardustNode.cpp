@@ -50,8 +50,8 @@ void StardustNode::draw(const std::shared_ptr<cugl::SpriteBatch>& batch,
             // this translation is what batch->draw does with the origin field
             stardustTransform.translate(-64,-64,0);
             stardustTransform.scale(_queue->at(idx).getRadius() / 3);
-            stardustTransform.translate(_queue->at(idx).getPosition().x,
-                                        _queue->at(idx).getPosition().y, 0);
+            cugl::Vec2 position = _queue->at(idx).getDrawPosition(_alpha);
+            stardustTransform.translate(position.x, position.y, 0);
             stardustTransform.multiply(transform);
             
             // draw stardust
@@ -38,12 +38,15 @@ private:
     
     /** The amount of time the stardust should be drawn gray. This will only be set if a power up has been used. */
     float _grayScaleTime;
+    
+    /** The fraction of the last simulation tick to draw the stardust at */
+    float _alpha;
 
 public:
     /** 
      * Creates a stardust node with default values.
      */
-    StardustNode() : AnimationNode(), _qhead(), _qtail(), _qsize() {}
+    StardustNode() : AnimationNode(), _qhead(), _qtail(), _qsize(), _alpha(1) {}
 
     /**
      * Disposes the stardust node, releasing all resources.
@@ -92,6 +95,7 @@ public:
 
         _timeElapsed = 0;
         _grayScaleTime = 0;
+        _alpha = 1;
         return true;
     }
     
@@ -118,6 +122,19 @@ public:
      */
     void applyGreyScale();
     
+    /**
+     * Sets the fraction of the last simulation tick to draw the stardust at.
+     *
+     * Each stardust is drawn between its position before the last tick (at
+     * 0) and its current position (at 1).  This keeps the stardust moving
+     * smoothly when the frame rate is higher than the tick rate.
+     *
+     * @param alpha The fraction of the last simulation tick
+     */
+    void setInterpolation(float alpha) {
+        _alpha = alpha;
+    }
+    
     /**
      * Updates the frame of the stardust animation
      */
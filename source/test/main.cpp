@@ -0,0 +1,277 @@
+//
+//  main.cpp
+//  CoreImpact
+//
+//  This is the scene test program.  It builds the game, menu and tutorial
+//  scenes from the real assets, draws them headless, and checks the draw
+//  calls of a frame against golden counts.  A change in batching (a new
+//  texture, a shader switch, an uncached subtree) is a failed test.
+//
+//  The golden counts are for the second frame.  The first frame also fills
+//  the caches of any CachedNode, so it is not representative of the game.
+//  Each scene is built a slice at a time (as in the game) and disposed by
+//  its destructor.
+//
+//  Author: Walker White
+//  Version: 10/18/26
+//
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cugl/cugl.h>
+#include "CIGameConstants.h"
+#include "CIGameSettings.h"
+#include "CIPlayerSettings.h"
+#include "CINetworkMessageManager.h"
+#include "CIGameScene.h"
+#include "CIMenuScene.h"
+#include "CITutorialScene.h"
+
+using namespace cugl;
+
+/** The golden draw calls of a game scene frame */
+#define GAME_DRAW_CALLS     5
+/** The golden draw calls of a menu scene frame */
+#define MENU_DRAW_CALLS     10
+/** The golden draw calls of a tutorial scene frame */
+#define TUTORIAL_DRAW_CALLS 6
+/** The time to spend building a scene each frame (as in CoreImpactApp) */
+#define SCENE_BUILD_BUDGET  4000
+
+#pragma mark -
+#pragma mark Test Fixture
+
+/** The assets shared by the scene tests */
+static std::shared_ptr<AssetManager> assets = nullptr;
+/** The sprite batch shared by the scene tests */
+static std::shared_ptr<SpriteBatch> batch = nullptr;
+
+/**
+ * Loads the game assets, as in CoreImpactApp::onStartup.
+ *
+ * The assets are loaded synchronously, and the audio engine is started on
+ * an offline output so that the scenes can queue music without a device.
+ */
+static void setupScenes() {
+    if (assets != nullptr) {
+        return;
+    }
+    Input::activate<Mouse>();
+    Input::activate<Keyboard>();
+    Input::activate<TextInput>();
+
+    AudioDevices::start();
+    std::shared_ptr<audio::AudioOfflineOutput> output = audio::AudioOfflineOutput::alloc(2,48000,512);
+    CUAssertLog(output != nullptr && AudioEngine::start(output,24), "Could not start the audio engine");
+
+    assets = AssetManager::alloc();
+    batch  = SpriteBatch::alloc();
+    assets->attach<Font>(FontLoader::alloc()->getHook());
+    std::shared_ptr<TextureLoader> textures = TextureLoader::alloc();
+    textures->setReferenceWidth(CONSTANTS::SCENE_WIDTH);
+    assets->attach<Texture>(textures->getHook());
+    assets->attach<Sound>(SoundLoader::alloc()->getHook());
+    assets->attach<WidgetValue>(WidgetLoader::alloc()->getHook());
+    assets->attach<scene2::SceneNode>(Scene2Loader::alloc()->getHook());
+    // The two directories share some widgets and fonts, so the second load
+    // reports those as failures (just as in the game)
+    assets->loadDirectory("json/menu.json");
+    assets->loadDirectory("json/assets.json");
+    CUAssertLog(assets->get<scene2::SceneNode>("menu") != nullptr, "Could not load the menu assets");
+    CUAssertLog(assets->get<scene2::SceneNode>("game") != nullptr, "Could not load the game assets");
+}
+
+/**
+ * Releases the assets shared by the scene tests.
+ */
+static void teardownScenes() {
+    if (assets == nullptr) {
+        return;
+    }
+    assets = nullptr;
+    batch = nullptr;
+    AudioEngine::stop();
+    AudioDevices::stop();
+    Input::deactivate<Mouse>();
+    Input::deactivate<Keyboard>();
+    Input::deactivate<TextInput>();
+}
+
+/**
+ * Draws two frames of a scene, checking the second against a golden count.
+ *
+ * The counts of both frames are logged, so that a golden count can be
+ * updated when a scene changes on purpose.
+ *
+ * @param name      The scene name (for logging)
+ * @param scene     The scene to draw
+ * @param golden    The expected draw calls of the second frame
+ */
+static void checkDrawCalls(const std::string& name, Scene2* scene, Uint64 golden) {
+    RenderRecorder::reset();
+    scene->render(batch);
+    RenderRecorder::Counts first = RenderRecorder::getCounts();
+
+    RenderRecorder::reset();
+    scene->render(batch);
+    RenderRecorder::Counts counts = RenderRecorder::getCounts();
+    CULog("%s first frame %s", name.c_str(), first.toString().c_str());
+    CULog("%s frame %s", name.c_str(), counts.toString().c_str());
+    CUAssertLog(counts.drawCalls == golden, "Expected %llu draw calls in the %s, got %llu",
+                (unsigned long long)golden, name.c_str(), (unsigned long long)counts.drawCalls);
+}
+
+/**
+ * Builds a scene a slice at a time, as CoreImpactApp does between frames.
+ *
+ * The number of slices and the longest slice are logged.  The slices are
+ * not checked against the budget, as the steps have no fixed cost, but the
+ * log shows whether any step is too large for a single frame.
+ *
+ * @param name      The scene name (for logging)
+ * @param scene     The scene to build
+ */
+template <typename T>
+static void buildScene(const std::string& name, T& scene) {
+    Uint32 slices = 0;
+    Uint64 longest = 0;
+    Uint64 total = 0;
+    bool done = false;
+    while (!done) {
+        Timestamp start;
+        done = scene.build(SCENE_BUILD_BUDGET);
+        Timestamp end;
+        Uint64 time = Timestamp::ellapsedMicros(start,end);
+        longest = std::max(longest,time);
+        total += time;
+        slices++;
+    }
+    CULog("%s built in %u slices (%llu us total, %llu us longest)", name.c_str(), slices,
+          (unsigned long long)total, (unsigned long long)longest);
+}
+
+#pragma mark -
+#pragma mark Scene Tests
+
+void testGameScene() {
+    setupScenes();
+    std::shared_ptr<GameSettings> gameSettings = GameSettings::alloc();
+    std::shared_ptr<PlayerSettings> playerSettings = PlayerSettings::alloc();
+    std::shared_ptr<NetworkMessageManager> network = NetworkMessageManager::alloc(gameSettings);
+
+    GameScene scene;
+    CUAssertLog(scene.init(assets, network, gameSettings, playerSettings), "Could not build the game scene");
+    buildScene("game scene", scene);
+
+    // The far background streams a filmstrip, or loads its own sprite sheet
+    auto far = std::dynamic_pointer_cast<scene2::StreamedAnimationNode>(assets->get<scene2::SceneNode>("game_field_far"));
+    CUAssertLog(far != nullptr, "The far background is not streamed");
+    CUAssertLog(far->getFilmstrip() != nullptr || far->getTexture() != Texture::getBlank(),
+                "The far background has no frames");
+    CUAssertLog(assets->get<Texture>("space") == nullptr, "The background sprite sheet is resident");
+    checkDrawCalls("game scene", &scene, GAME_DRAW_CALLS);
+}
+
+void testMenuScene() {
+    setupScenes();
+    std::shared_ptr<GameSettings> gameSettings = GameSettings::alloc();
+    std::shared_ptr<PlayerSettings> playerSettings = PlayerSettings::alloc();
+    std::shared_ptr<NetworkMessageManager> network = NetworkMessageManager::alloc(gameSettings);
+
+    MenuScene scene;
+    CUAssertLog(scene.init(assets, network, gameSettings, playerSettings), "Could not build the menu scene");
+    buildScene("menu scene", scene);
+    scene.update(0.0f); // Shows the main menu
+    checkDrawCalls("menu scene", &scene, MENU_DRAW_CALLS);
+}
+
+void testTutorialScene() {
+    setupScenes();
+    std::shared_ptr<GameSettings> gameSettings = GameSettings::alloc();
+    std::shared_ptr<PlayerSettings> playerSettings = PlayerSettings::alloc();
+    std::shared_ptr<NetworkMessageManager> network = NetworkMessageManager::alloc(gameSettings);
+
+    TutorialScene scene;
+    CUAssertLog(scene.init(assets, network, gameSettings, playerSettings), "Could not build the tutorial scene");
+    buildScene("tutorial scene", scene);
+    checkDrawCalls("tutorial scene", &scene, TUTORIAL_DRAW_CALLS);
+}
+
+#pragma mark -
+#pragma mark Test Runner
+
+/** A test that may be run by name */
+typedef struct {
+    /** The test name */
+    const char* name;
+    /** The test function */
+    void (*run)();
+} SceneTest;
+
+/** The scene tests that may be run by name */
+static const SceneTest SCENE_TESTS[] = {
+    { "testGameScene",     testGameScene },
+    { "testMenuScene",     testMenuScene },
+    { "testTutorialScene", testTutorialScene },
+};
+
+/**
+ * Runs the scene tests named on the command line.
+ *
+ * The usage is
+ *
+ *     scenetest [--headless] [<name> ...]
+ *
+ * where each name is a test in SCENE_TESTS.  Without any names, this runs
+ * all of the tests.  A failed test stops on an assert, so the process exits
+ * abnormally.  An unknown test name is an error.
+ */
+int main(int argc, char * argv[]) {
+    bool headless = false;
+    std::vector<std::string> names;
+    for(int ii = 1; ii < argc; ii++) {
+        std::string arg = argv[ii];
+        if (arg == "--headless") {
+            headless = true;
+        } else {
+            names.push_back(arg);
+        }
+    }
+
+    const size_t count = sizeof(SCENE_TESTS)/sizeof(SceneTest);
+    if (names.empty()) {
+        for(size_t ii = 0; ii < count; ii++) {
+            names.push_back(SCENE_TESTS[ii].name);
+        }
+    }
+
+    Application app;
+    app.setName("Core Impact");
+    app.setOrganization("Elipsis");
+    app.setSize(1024, 576);
+    app.setHeadless(headless);
+    if (!app.init()) {
+        return 1;
+    }
+    app.onStartup();
+
+    int result = 0;
+    for(auto it = names.begin(); it != names.end(); ++it) {
+        size_t pos = 0;
+        while (pos < count && *it != SCENE_TESTS[pos].name) {
+            pos++;
+        }
+        if (pos == count) {
+            CULogError("Unknown test '%s'", it->c_str());
+            result = 1;
+        } else {
+            CULog("Running %s", it->c_str());
+            SCENE_TESTS[pos].run();
+        }
+    }
+    teardownScenes();
+
+    app.quit();
+    app.onShutdown();
+    return result;
+}